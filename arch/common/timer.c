@@ -8,22 +8,10 @@
 
 #include "timer.h"
 
-static enum ZIP_CMP
-cmpDateTime(const UA_DateTime *a, const UA_DateTime *b) {
-    if(*a == *b)
-        return ZIP_CMP_EQ;
-    return (*a < *b) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
-}
-
-static enum ZIP_CMP
-cmpId(const UA_UInt64 *a, const UA_UInt64 *b) {
-    if(*a == *b)
-        return ZIP_CMP_EQ;
-    return (*a < *b) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
-}
-
-ZIP_FUNCTIONS(UA_TimerTree, UA_TimerEntry, treeEntry, UA_DateTime, nextTime, cmpDateTime)
-ZIP_FUNCTIONS(UA_TimerIdTree, UA_TimerEntry, idTreeEntry, UA_UInt64, id, cmpId)
+#define UA_TIMER_SLOTMASK (UA_TIMER_SLOTS - 1)
+#define UA_TIMER_OVERFLOW UA_TIMER_LEVELS
+#define UA_TIMER_PROCESSING (UA_TIMER_LEVELS + 1)
+#define UA_TIMER_FREE (UA_TIMER_LEVELS + 2)
 
 static UA_DateTime
 calculateNextTime(UA_DateTime currentTime, UA_DateTime baseTime,
@@ -43,50 +31,420 @@ calculateNextTime(UA_DateTime currentTime, UA_DateTime baseTime,
     return currentTime + interval - cycleDelay;
 }
 
-void
-UA_Timer_init(UA_Timer *t) {
-    memset(t, 0, sizeof(UA_Timer));
-    UA_LOCK_INIT(&t->timerMutex);
+/* Round down to the tick, also for negative times */
+static UA_Int64
+toTick(UA_DateTime time) {
+    if(time >= 0)
+        return time >> UA_TIMER_TICKSHIFT;
+    return -((-(time + 1)) >> UA_TIMER_TICKSHIFT) - 1;
 }
 
-/* Global variables, only used behind the mutex */
-static UA_DateTime earliest, latest, adjustedNextTime;
+/***********/
+/* Bitmaps */
+/***********/
+
+static unsigned
+ctz64(UA_UInt64 x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctzll(x);
+#else
+    unsigned n = 0;
+    while(!(x & 1)) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
 
-static void *
-findTimer2Batch(void *context, UA_TimerEntry *compare) {
-    UA_TimerEntry *te = (UA_TimerEntry*)context;
+/* Distance from the start slot to the next non-empty slot in circular order.
+ * Returns -1 if the level is empty. */
+static int
+findOccupied(const UA_TimerLevel *lvl, unsigned start) {
+    const unsigned words = (UA_TIMER_SLOTS + 63) / 64;
+    unsigned w = start / 64;
+    UA_UInt64 bits = lvl->occupied[w] & (~(UA_UInt64)0 << (start % 64));
+    for(unsigned i = 0; i <= words; i++) {
+        if(bits) {
+            unsigned slot = w * 64 + ctz64(bits);
+            return (int)((slot - start) & UA_TIMER_SLOTMASK);
+        }
+        w = (w + 1) % words;
+        bits = lvl->occupied[w];
+    }
+    return -1;
+}
 
-    /* NextTime deviation within interval? */
-    if(compare->nextTime < earliest || compare->nextTime > latest)
-        return NULL;
+/*********/
+/* Slots */
+/*********/
 
-    /* Check if one interval is a multiple of the other */
-    if(te->interval < compare->interval && compare->interval % te->interval != 0)
-        return NULL;
-    if(te->interval > compare->interval && te->interval % compare->interval != 0)
-        return NULL;
+static void
+slotInsert(UA_TimerSlot *s, UA_TimerEntry *te) {
+    if(LIST_EMPTY(&s->entries)) {
+        s->minTime = te->nextTime;
+        s->dirty = false;
+    } else if(te->nextTime < s->minTime) {
+        s->minTime = te->nextTime;
+    }
+    LIST_INSERT_HEAD(&s->entries, te, listEntry);
+}
+
+/* The minTime is recomputed lazily after the earliest entry was removed */
+static UA_DateTime
+slotMinTime(UA_TimerSlot *s) {
+    if(s->dirty) {
+        s->minTime = UA_INT64_MAX;
+        UA_TimerEntry *te;
+        LIST_FOREACH(te, &s->entries, listEntry) {
+            if(te->nextTime < s->minTime)
+                s->minTime = te->nextTime;
+        }
+        s->dirty = false;
+    }
+    return s->minTime;
+}
+
+static UA_TimerSlot *
+entrySlot(UA_Timer *t, UA_TimerEntry *te) {
+    if(te->level == UA_TIMER_OVERFLOW)
+        return &t->overflow;
+    return &t->levels[te->level].slots[te->slot];
+}
+
+/*********/
+/* Wheel */
+/*********/
+
+/* Insert relative to the current tick. Overdue entries are executed with the
+ * current tick. */
+static void
+addToWheel(UA_Timer *t, UA_TimerEntry *te) {
+    UA_Int64 tick = toTick(te->nextTime);
+    if(tick < t->current)
+        tick = t->current;
+    UA_Int64 delta = tick - t->current;
+    for(UA_Byte l = 0; l < UA_TIMER_LEVELS; l++) {
+        if(delta >= ((UA_Int64)1 << (UA_TIMER_SLOTBITS * (l + 1))))
+            continue;
+        unsigned slot = (unsigned)((tick >> (UA_TIMER_SLOTBITS * l)) & UA_TIMER_SLOTMASK);
+        te->level = l;
+        te->slot = (UA_Byte)slot;
+        slotInsert(&t->levels[l].slots[slot], te);
+        t->levels[l].occupied[slot / 64] |= (UA_UInt64)1 << (slot % 64);
+        return;
+    }
+    te->level = UA_TIMER_OVERFLOW;
+    slotInsert(&t->overflow, te);
+}
+
+static void
+removeFromWheel(UA_Timer *t, UA_TimerEntry *te) {
+    UA_TimerSlot *s = entrySlot(t, te);
+    LIST_REMOVE(te, listEntry);
+    if(LIST_EMPTY(&s->entries)) {
+        s->dirty = false;
+        if(te->level < UA_TIMER_LEVELS)
+            t->levels[te->level].occupied[te->slot / 64] &=
+                ~((UA_UInt64)1 << (te->slot % 64));
+    } else if(te->nextTime == s->minTime) {
+        s->dirty = true;
+    }
+}
+
+/* Re-add the entries of a slot relative to the current tick. This moves them
+ * to the lower levels. */
+static void
+cascadeSlot(UA_Timer *t, UA_TimerSlot *s) {
+    UA_TimerList tmp;
+    LIST_INIT(&tmp);
+    UA_TimerEntry *te;
+    while((te = LIST_FIRST(&s->entries))) {
+        removeFromWheel(t, te);
+        LIST_INSERT_HEAD(&tmp, te, listEntry);
+    }
+    while((te = LIST_FIRST(&tmp))) {
+        LIST_REMOVE(te, listEntry);
+        addToWheel(t, te);
+    }
+}
+
+/* The current tick has moved to the start of a level 1 slot. Cascade the slots
+ * of all levels that start with the current tick, beginning from the top. */
+static void
+cascade(UA_Timer *t) {
+    size_t top = 1;
+    while(top < UA_TIMER_LEVELS &&
+          ((t->current >> (UA_TIMER_SLOTBITS * top)) & UA_TIMER_SLOTMASK) == 0)
+        top++;
+    if(top == UA_TIMER_LEVELS) {
+        cascadeSlot(t, &t->overflow);
+        top--;
+    }
+    for(size_t l = top; l > 0; l--) {
+        unsigned slot = (unsigned)
+            ((t->current >> (UA_TIMER_SLOTBITS * l)) & UA_TIMER_SLOTMASK);
+        cascadeSlot(t, &t->levels[l].slots[slot]);
+    }
+}
+
+/* The next tick where a slot of the higher levels is cascaded */
+static UA_Int64
+nextCascade(const UA_Timer *t) {
+    UA_Int64 next = UA_INT64_MAX;
+    for(size_t l = 1; l < UA_TIMER_LEVELS; l++) {
+        UA_Int64 block = t->current >> (UA_TIMER_SLOTBITS * l);
+        int d = findOccupied(&t->levels[l],
+                             (unsigned)((block + 1) & UA_TIMER_SLOTMASK));
+        if(d < 0)
+            continue;
+        UA_Int64 start = (block + 1 + d) << (UA_TIMER_SLOTBITS * l);
+        if(start < next)
+            next = start;
+    }
+    if(!LIST_EMPTY(&t->overflow.entries)) {
+        UA_Int64 shift = UA_TIMER_SLOTBITS * UA_TIMER_LEVELS;
+        UA_Int64 start = ((t->current >> shift) + 1) << shift;
+        if(start < next)
+            next = start;
+    }
+    return next;
+}
+
+static UA_Boolean
+entryBefore(const UA_TimerEntry *a, const UA_TimerEntry *b) {
+    if(a->nextTime != b->nextTime)
+        return a->nextTime < b->nextTime;
+    return a->index < b->index;
+}
+
+static UA_TimerEntry *
+mergeEntries(UA_TimerEntry *a, UA_TimerEntry *b) {
+    UA_TimerEntry *head = NULL;
+    UA_TimerEntry **tail = &head;
+    while(a && b) {
+        if(entryBefore(b, a)) {
+            *tail = b;
+            b = b->processNext;
+        } else {
+            *tail = a;
+            a = a->processNext;
+        }
+        tail = &(*tail)->processNext;
+    }
+    *tail = (a) ? a : b;
+    return head;
+}
+
+/* Merge sort of the entries from one slot by their nextTime */
+static UA_TimerEntry *
+sortEntries(UA_TimerEntry *list) {
+    if(!list || !list->processNext)
+        return list;
+    UA_TimerEntry *slow = list;
+    UA_TimerEntry *fast = list->processNext;
+    while(fast && fast->processNext) {
+        slow = slow->processNext;
+        fast = fast->processNext->processNext;
+    }
+    UA_TimerEntry *second = slow->processNext;
+    slow->processNext = NULL;
+    return mergeEntries(sortEntries(list), sortEntries(second));
+}
+
+/* Move the due entries of a level 0 slot to the end of the process list. If
+ * the slot is for the tick of "now", then not all entries might be due. */
+static UA_TimerEntry **
+collectSlot(UA_Timer *t, unsigned slot, UA_DateTime now, UA_TimerEntry **tail) {
+    UA_TimerEntry *due = NULL;
+    UA_TimerEntry *te, *te_tmp;
+    LIST_FOREACH_SAFE(te, &t->levels[0].slots[slot].entries, listEntry, te_tmp) {
+        if(te->nextTime > now)
+            continue;
+        removeFromWheel(t, te);
+        te->level = UA_TIMER_PROCESSING;
+        te->processNext = due;
+        due = te;
+    }
+    *tail = sortEntries(due);
+    while(*tail)
+        tail = &(*tail)->processNext;
+    return tail;
+}
+
+/* Advance the wheel up to the tick of "now". Returns the list of due entries
+ * in the order of their nextTime. */
+static UA_TimerEntry *
+advance(UA_Timer *t, UA_DateTime now) {
+    UA_TimerEntry *process = NULL;
+    UA_TimerEntry **tail = &process;
+    UA_Int64 target = toTick(now);
+    if(target < t->current)
+        target = t->current;
+
+    while(true) {
+        /* Execute the level 0 slots up to the end of the revolution */
+        UA_Int64 revEnd = t->current | UA_TIMER_SLOTMASK;
+        UA_Int64 end = (target < revEnd) ? target : revEnd;
+        while(true) {
+            int d = findOccupied(&t->levels[0],
+                                 (unsigned)(t->current & UA_TIMER_SLOTMASK));
+            if(d < 0 || t->current + d > end)
+                break;
+            t->current += d;
+            tail = collectSlot(t, (unsigned)(t->current & UA_TIMER_SLOTMASK),
+                               now, tail);
+            if(t->current == end)
+                break;
+            t->current++;
+        }
+
+        if(end == target) {
+            t->current = target;
+            break;
+        }
+
+        /* Move to the next revolution of level 0. Skip ahead directly to the
+         * next cascade if level 0 is empty. */
+        UA_Int64 next = revEnd + 1;
+        if(findOccupied(&t->levels[0], 0) < 0)
+            next = nextCascade(t);
+        if(next > target) {
+            t->current = target;
+            break;
+        }
+        t->current = next;
+        cascade(t);
+    }
+    return process;
+}
+
+/* Earliest nextTime of all entries in the wheel. For every level, the first
+ * non-empty slot after the current tick contains its earliest entry. */
+static UA_DateTime
+earliestTime(UA_Timer *t) {
+    UA_DateTime next = UA_INT64_MAX;
+    for(size_t l = 0; l < UA_TIMER_LEVELS; l++) {
+        /* The level 0 slot of the current tick can contain entries. For the
+         * higher levels, the slot of the current tick is already cascaded. */
+        UA_Int64 block = t->current >> (UA_TIMER_SLOTBITS * l);
+        if(l > 0)
+            block++;
+        int d = findOccupied(&t->levels[l], (unsigned)(block & UA_TIMER_SLOTMASK));
+        if(d < 0)
+            continue;
+        unsigned slot = (unsigned)((block + d) & UA_TIMER_SLOTMASK);
+        UA_DateTime min = slotMinTime(&t->levels[l].slots[slot]);
+        if(min < next)
+            next = min;
+    }
+    if(!LIST_EMPTY(&t->overflow.entries)) {
+        UA_DateTime min = slotMinTime(&t->overflow);
+        if(min < next)
+            next = min;
+    }
+    return next;
+}
+
+/***********/
+/* Entries */
+/***********/
 
-    adjustedNextTime = compare->nextTime; /* Candidate found */
+static UA_TimerEntry *
+allocEntry(UA_Timer *t) {
+    UA_TimerEntry *te = LIST_FIRST(&t->freeEntries);
+    if(!te) {
+        /* Add a slab of entries */
+        if(t->slabsSize >= UA_UINT32_MAX / UA_TIMER_SLABSIZE)
+            return NULL;
+        UA_TimerEntry **slabs = (UA_TimerEntry**)
+            UA_realloc(t->slabs, sizeof(UA_TimerEntry*) * (t->slabsSize + 1));
+        if(!slabs)
+            return NULL;
+        t->slabs = slabs;
+        UA_TimerEntry *slab = (UA_TimerEntry*)
+            UA_calloc(UA_TIMER_SLABSIZE, sizeof(UA_TimerEntry));
+        if(!slab)
+            return NULL;
+        t->slabs[t->slabsSize] = slab;
+        for(size_t i = UA_TIMER_SLABSIZE; i > 0; i--) {
+            slab[i-1].index = (UA_UInt32)(t->slabsSize * UA_TIMER_SLABSIZE + i - 1);
+            slab[i-1].level = UA_TIMER_FREE;
+            LIST_INSERT_HEAD(&t->freeEntries, &slab[i-1], listEntry);
+        }
+        t->slabsSize++;
+        te = LIST_FIRST(&t->freeEntries);
+    }
+
+    LIST_REMOVE(te, listEntry);
+    te->generation++;
+    if(te->generation == 0)
+        te->generation = 1;
+    te->id = ((UA_UInt64)te->generation << 32) | te->index;
+    t->entriesSize++;
+    return te;
+}
+
+static void
+freeEntry(UA_Timer *t, UA_TimerEntry *te) {
+    te->id = 0;
+    te->cb = NULL;
+    te->level = UA_TIMER_FREE;
+    LIST_INSERT_HEAD(&t->freeEntries, te, listEntry);
+    t->entriesSize--;
+}
 
-    /* Abort when a perfect match is found */
-    return (te->interval == compare->interval) ? te : NULL;
+static UA_TimerEntry *
+findEntry(UA_Timer *t, UA_UInt64 id) {
+    UA_UInt32 index = (UA_UInt32)id;
+    size_t slab = index / UA_TIMER_SLABSIZE;
+    if(id == 0 || slab >= t->slabsSize)
+        return NULL;
+    UA_TimerEntry *te = &t->slabs[slab][index % UA_TIMER_SLABSIZE];
+    return (te->id == id) ? te : NULL;
 }
 
-/* Adjust the nextTime to batch cyclic callbacks. Look in an interval around the
- * original nextTime. Deviate from the original nextTime by at most 1/4 of the
- * interval and at most by 1s. */
+/* Adjust the nextTime to batch cyclic callbacks with the same interval. Align
+ * with the phase of the last entry added for the interval. Deviate from the
+ * original nextTime by at most 1/4 of the interval and at most by 1s. */
 static void
 batchTimerEntry(UA_Timer *t, UA_TimerEntry *te) {
-    if(te->timerPolicy != UA_TIMERPOLICY_CURRENTTIME)
+    if(te->timerPolicy != UA_TIMERPOLICY_CURRENTTIME || te->interval <= 0)
+        return;
+
+    /* Fibonacci hashing of the interval to the phases */
+    UA_TimerPhase *p = &t->phases[((UA_UInt64)te->interval * 11400714819323198485ull) >>
+                                  (64 - UA_TIMER_PHASEBITS)];
+    UA_DateTime offset = te->nextTime % te->interval;
+    if(offset < 0)
+        offset += te->interval;
+    if(p->interval != te->interval) {
+        p->interval = te->interval;
+        p->phase = offset;
         return;
+    }
+
+    /* Move to the closest time with the same phase */
+    UA_DateTime shift = p->phase - offset;
+    if(shift > te->interval / 2)
+        shift -= te->interval;
+    else if(shift < -(te->interval / 2))
+        shift += te->interval;
     UA_DateTime deviate = te->interval / 4;
     if(deviate > UA_DATETIME_SEC)
         deviate = UA_DATETIME_SEC;
-    earliest = te->nextTime - deviate;
-    latest = te->nextTime + deviate;
-    adjustedNextTime = te->nextTime;
-    ZIP_ITER(UA_TimerIdTree, &t->idTree, findTimer2Batch, te);
-    te->nextTime = adjustedNextTime;
+    if(shift >= -deviate && shift <= deviate)
+        te->nextTime += shift;
+}
+
+/**********/
+/* Timer */
+/**********/
+
+void
+UA_Timer_init(UA_Timer *t) {
+    memset(t, 0, sizeof(UA_Timer));
+    UA_LOCK_INIT(&t->timerMutex);
 }
 
 /* Adding repeated callbacks: Add an entry with the "nextTime" timestamp in the
@@ -119,10 +477,18 @@ UA_Timer_add(UA_Timer *t, UA_Callback callback,
     UA_DateTime nextTime = (baseTime == NULL) ?
         now + interval : calculateNextTime(now, *baseTime, interval);
 
+    UA_LOCK(&t->timerMutex);
+
+    /* An empty wheel can skip ahead to the current time */
+    if(t->entriesSize == 0 && toTick(now) > t->current)
+        t->current = toTick(now);
+
     /* Allocate the repeated callback structure */
-    UA_TimerEntry *te = (UA_TimerEntry*)UA_malloc(sizeof(UA_TimerEntry));
-    if(!te)
+    UA_TimerEntry *te = allocEntry(t);
+    if(!te) {
+        UA_UNLOCK(&t->timerMutex);
         return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
 
     /* Set the repeated callback */
     te->interval = interval;
@@ -136,12 +502,9 @@ UA_Timer_add(UA_Timer *t, UA_Callback callback,
     batchTimerEntry(t, te);
 
     /* Insert into the timer */
-    UA_LOCK(&t->timerMutex);
-    te->id = ++t->idCounter;
     if(callbackId)
         *callbackId = te->id;
-    ZIP_INSERT(UA_TimerTree, &t->tree, te);
-    ZIP_INSERT(UA_TimerIdTree, &t->idTree, te);
+    addToWheel(t, te);
     UA_UNLOCK(&t->timerMutex);
 
     return UA_STATUSCODE_GOOD;
@@ -168,17 +531,19 @@ UA_Timer_modify(UA_Timer *t, UA_UInt64 callbackId,
     UA_LOCK(&t->timerMutex);
 
     /* Find timer entry based on id */
-    UA_TimerEntry *te = ZIP_FIND(UA_TimerIdTree, &t->idTree, &callbackId);
+    UA_TimerEntry *te = findEntry(t, callbackId);
     if(!te) {
         UA_UNLOCK(&t->timerMutex);
         return UA_STATUSCODE_BADNOTFOUND;
     }
 
-    /* The entry is either in the timer tree or current processed. If
-     * in-process, the entry is re-added to the timer-tree right after. */
-    UA_Boolean processing = (ZIP_REMOVE(UA_TimerTree, &t->tree, te) == NULL);
+    /* The entry is either in the wheel or currently processed. If in-process,
+     * the entry is re-added to the wheel right after. */
+    UA_Boolean processing = (te->level == UA_TIMER_PROCESSING);
+    if(!processing)
+        removeFromWheel(t, te);
 
-    /* The nextTime must only be modified after ZIP_REMOVE. The logic is
+    /* The nextTime must only be modified after the removal. The logic is
      * identical to the creation of a new timer. */
     te->nextTime = (baseTime == NULL) ?
         now + interval : calculateNextTime(now, *baseTime, interval);
@@ -191,7 +556,7 @@ UA_Timer_modify(UA_Timer *t, UA_UInt64 callbackId,
     if(processing)
         te->nextTime -= interval; /* adjust for re-adding after processing */
     else
-        ZIP_INSERT(UA_TimerTree, &t->tree, te);
+        addToWheel(t, te);
 
     UA_UNLOCK(&t->timerMutex);
     return UA_STATUSCODE_GOOD;
@@ -200,19 +565,18 @@ UA_Timer_modify(UA_Timer *t, UA_UInt64 callbackId,
 void
 UA_Timer_remove(UA_Timer *t, UA_UInt64 callbackId) {
     UA_LOCK(&t->timerMutex);
-    UA_TimerEntry *te = ZIP_FIND(UA_TimerIdTree, &t->idTree, &callbackId);
+    UA_TimerEntry *te = findEntry(t, callbackId);
     if(!te) {
         UA_UNLOCK(&t->timerMutex);
         return;
     }
 
-    /* The entry is either in the timer tree or in the process tree. If in the
-     * process tree, leave a sentinel (callback == NULL) to delete it during
-     * processing. Do not edit the process tree while iterating over it. */
-    UA_Boolean processing = (ZIP_REMOVE(UA_TimerTree, &t->tree, te) == NULL);
-    if(!processing) {
-        ZIP_REMOVE(UA_TimerIdTree, &t->idTree, te);
-        UA_free(te);
+    /* The entry is either in the wheel or in the process list. If in the
+     * process list, leave a sentinel (callback == NULL) to delete it during
+     * processing. Do not edit the process list while iterating over it. */
+    if(te->level != UA_TIMER_PROCESSING) {
+        removeFromWheel(t, te);
+        freeEntry(t, te);
     } else {
         te->cb = NULL;
     }
@@ -220,76 +584,59 @@ UA_Timer_remove(UA_Timer *t, UA_UInt64 callbackId) {
     UA_UNLOCK(&t->timerMutex);
 }
 
-struct TimerProcessContext {
-    UA_Timer *t;
-    UA_DateTime now;
-};
+UA_DateTime
+UA_Timer_process(UA_Timer *t, UA_DateTime now) {
+    UA_LOCK(&t->timerMutex);
 
-static void *
-processEntryCallback(void *context, UA_TimerEntry *te) {
-    struct TimerProcessContext *tpc = (struct TimerProcessContext*)context;
-    UA_Timer *t = tpc->t;
+    /* Move all entries <= now to the process list */
+    UA_TimerEntry *process = advance(t, now);
 
-    /* Execute the callback */
-    if(te->cb) {
-        te->cb(te->application, te->data);
-    }
+    /* Consistency check. The earliest not-processed entry isn't ready. */
+    UA_assert(earliestTime(t) > now);
 
-    /* Remove the entry if marked for deletion or a "once" policy */
-    if(!te->cb || te->timerPolicy == UA_TIMERPOLICY_ONCE) {
-        ZIP_REMOVE(UA_TimerIdTree, &t->idTree, te);
-        UA_free(te);
-        return NULL;
-    }
-
-    /* Set the time for the next regular execution */
-    te->nextTime += te->interval;
-
-    /* Handle the case where the execution "window" was missed. E.g. due to
-     * congestion of the application or if the clock was shifted.
-     *
-     * If the timer policy is "CurrentTime", then there is at least the
-     * interval between executions. This is used for Monitoreditems, for
-     * which the spec says: The sampling interval indicates the fastest rate
-     * at which the Server should sample its underlying source for data
-     * changes. (Part 4, 5.12.1.2).
-     *
-     * Otherwise calculate the next execution time based on the original base
-     * time. */
-    if(te->nextTime < tpc->now) {
-        te->nextTime = (te->timerPolicy == UA_TIMERPOLICY_CURRENTTIME) ?
-            tpc->now + te->interval :
-            calculateNextTime(tpc->now, te->nextTime, te->interval);
-    }
+    /* Iterate over the entries that need processing in-order. This also
+     * moves them back to the wheel. */
+    while(process) {
+        UA_TimerEntry *te = process;
+        process = te->processNext;
+
+        /* Execute the callback */
+        if(te->cb) {
+            te->cb(te->application, te->data);
+        }
 
-    /* Insert back into the time-sorted tree */
-    ZIP_INSERT(UA_TimerTree, &t->tree, te);
-    return NULL;
-}
+        /* Remove the entry if marked for deletion or a "once" policy */
+        if(!te->cb || te->timerPolicy == UA_TIMERPOLICY_ONCE) {
+            freeEntry(t, te);
+            continue;
+        }
 
-UA_DateTime
-UA_Timer_process(UA_Timer *t, UA_DateTime now) {
-    UA_LOCK(&t->timerMutex);
+        /* Set the time for the next regular execution */
+        te->nextTime += te->interval;
+
+        /* Handle the case where the execution "window" was missed. E.g. due to
+         * congestion of the application or if the clock was shifted.
+         *
+         * If the timer policy is "CurrentTime", then there is at least the
+         * interval between executions. This is used for Monitoreditems, for
+         * which the spec says: The sampling interval indicates the fastest rate
+         * at which the Server should sample its underlying source for data
+         * changes. (Part 4, 5.12.1.2).
+         *
+         * Otherwise calculate the next execution time based on the original
+         * base time. */
+        if(te->nextTime < now) {
+            te->nextTime = (te->timerPolicy == UA_TIMERPOLICY_CURRENTTIME) ?
+                now + te->interval :
+                calculateNextTime(now, te->nextTime, te->interval);
+        }
 
-    /* Move all entries <= now to the processTree */
-    UA_TimerTree processTree;
-    ZIP_INIT(&processTree);
-    ZIP_UNZIP(UA_TimerTree, &t->tree, &now, &processTree, &t->tree);
+        /* Insert back into the wheel */
+        addToWheel(t, te);
+    }
 
-    /* Consistency check. The smallest not-processed entry isn't ready. */
-    UA_assert(!ZIP_MIN(UA_TimerTree, &t->tree) ||
-              ZIP_MIN(UA_TimerTree, &t->tree)->nextTime > now);
-        
-    /* Iterate over the entries that need processing in-order. This also
-     * moves them back to the regular time-ordered tree. */
-    struct TimerProcessContext ctx;
-    ctx.t = t;
-    ctx.now = now;
-    ZIP_ITER(UA_TimerTree, &processTree, processEntryCallback, &ctx);
-        
     /* Compute the timestamp of the earliest next callback */
-    UA_TimerEntry *first = ZIP_MIN(UA_TimerTree, &t->tree);
-    UA_DateTime next = (first) ? first->nextTime : UA_INT64_MAX;
+    UA_DateTime next = earliestTime(t);
     UA_UNLOCK(&t->timerMutex);
     return next;
 }
@@ -297,26 +644,26 @@ UA_Timer_process(UA_Timer *t, UA_DateTime now) {
 UA_DateTime
 UA_Timer_next(UA_Timer *t) {
     UA_LOCK(&t->timerMutex);
-    UA_TimerEntry *first = ZIP_MIN(UA_TimerTree, &t->tree);
-    UA_DateTime next = (first) ? first->nextTime : UA_INT64_MAX;
+    UA_DateTime next = earliestTime(t);
     UA_UNLOCK(&t->timerMutex);
     return next;
 }
 
-static void *
-freeEntryCallback(void *context, UA_TimerEntry *entry) {
-    UA_free(entry);
-    return NULL;
-}
-
 void
 UA_Timer_clear(UA_Timer *t) {
     UA_LOCK(&t->timerMutex);
 
-    ZIP_ITER(UA_TimerIdTree, &t->idTree, freeEntryCallback, NULL);
-    t->tree.root = NULL;
-    t->idTree.root = NULL;
-    t->idCounter = 0;
+    for(size_t i = 0; i < t->slabsSize; i++)
+        UA_free(t->slabs[i]);
+    UA_free(t->slabs);
+    t->slabs = NULL;
+    t->slabsSize = 0;
+    LIST_INIT(&t->freeEntries);
+    memset(t->levels, 0, sizeof(t->levels));
+    memset(&t->overflow, 0, sizeof(t->overflow));
+    memset(t->phases, 0, sizeof(t->phases));
+    t->current = 0;
+    t->entriesSize = 0;
 
     UA_UNLOCK(&t->timerMutex);
 
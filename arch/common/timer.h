@@ -11,7 +11,7 @@
 
 #include <open62541/types.h>
 #include <open62541/plugin/eventloop.h>
-#include "ziptree.h"
+#include "open62541_queue.h"
 
 _UA_BEGIN_DECLS
 
@@ -21,10 +21,67 @@ _UA_BEGIN_DECLS
  * mutex will be left without acquiring another mutex.
  *
  * Obviously, the timer must not be deleted from within one of its
- * callbacks. */
+ * callbacks.
+ *
+ * The timer is a hierarchical timing wheel. The time axis is divided into ticks
+ * of 2^UA_TIMER_TICKSHIFT * 100ns (~0.1ms). Every level of the wheel has
+ * UA_TIMER_SLOTS slots. A slot on level l spans UA_TIMER_SLOTS^l ticks. Entries
+ * are sorted into the level where their deadline falls within one revolution.
+ * When the wheel advances, the slots of the higher levels are "cascaded" into
+ * the lower levels. Only the slots of level 0 are executed. Adding and removing
+ * entries is O(1). The entries keep their exact deadline. The tick only
+ * determines the slot. Deadlines beyond the last level are kept in an overflow
+ * list.
+ *
+ * The entries are allocated from slabs and reused. The identifier of an entry
+ * encodes its position in the slabs, so that the lookup by identifier is
+ * O(1).
+ *
+ * The wheel is embedded in the EventLoop. With the default geometry of 4 levels
+ * with 256 slots, it takes about 25kB and covers ~5 days before entries go to
+ * the overflow list. On embedded targets (lwIP, Zephyr) the default is 4
+ * levels with 32 slots. That takes about 3kB and covers ~100s. The geometry
+ * can be overridden with compiler definitions. */
+
+#define UA_TIMER_TICKSHIFT 10
+#define UA_TIMER_SLABSIZE 256
+
+#if defined(UA_ARCHITECTURE_LWIP) || defined(UA_ARCHITECTURE_ZEPHYR)
+# ifndef UA_TIMER_SLOTBITS
+#  define UA_TIMER_SLOTBITS 5
+# endif
+# ifndef UA_TIMER_PHASEBITS
+#  define UA_TIMER_PHASEBITS 3
+# endif
+#endif
+
+#ifndef UA_TIMER_SLOTBITS
+# define UA_TIMER_SLOTBITS 8
+#endif
+#ifndef UA_TIMER_LEVELS
+# define UA_TIMER_LEVELS 4
+#endif
+#ifndef UA_TIMER_PHASEBITS
+# define UA_TIMER_PHASEBITS 6
+#endif
+
+#if UA_TIMER_SLOTBITS < 1 || UA_TIMER_SLOTBITS > 8
+# error UA_TIMER_SLOTBITS must be between 1 and 8
+#endif
+#if UA_TIMER_LEVELS < 1 || UA_TIMER_SLOTBITS * UA_TIMER_LEVELS > 48
+# error The timer wheel must have at least one level and at most 48 bits
+#endif
+#if UA_TIMER_PHASEBITS < 1 || UA_TIMER_PHASEBITS > 16
+# error UA_TIMER_PHASEBITS must be between 1 and 16
+#endif
+
+#define UA_TIMER_SLOTS (1 << UA_TIMER_SLOTBITS)
+#define UA_TIMER_PHASES (1 << UA_TIMER_PHASEBITS)
 
 typedef struct UA_TimerEntry {
-    ZIP_ENTRY(UA_TimerEntry) treeEntry;
+    LIST_ENTRY(UA_TimerEntry) listEntry; /* In a wheel slot, the overflow list
+                                          * or the list of free entries */
+    struct UA_TimerEntry *processNext;   /* List of entries being processed */
     UA_TimerPolicy timerPolicy; /* Timer policy to handle cycle misses */
     UA_DateTime nextTime;       /* The next time when the callback is to be
                                  * executed */
@@ -37,18 +94,51 @@ typedef struct UA_TimerEntry {
     void *application;
     void *data;
 
-    ZIP_ENTRY(UA_TimerEntry) idTreeEntry;
-    UA_UInt64 id;                            /* Id of the entry */
+    UA_UInt64 id;               /* Id of the entry. Zero if the entry is free.
+                                 * The lower 32bit are the position in the
+                                 * slabs, the upper 32bit count up when the
+                                 * entry is reused. */
+    UA_UInt32 index;            /* Position in the slabs */
+    UA_UInt32 generation;
+    UA_Byte level;              /* Wheel level, UA_TIMER_OVERFLOW or
+                                 * UA_TIMER_PROCESSING */
+    UA_Byte slot;
 } UA_TimerEntry;
 
-typedef ZIP_HEAD(UA_TimerTree, UA_TimerEntry) UA_TimerTree;
-typedef ZIP_HEAD(UA_TimerIdTree, UA_TimerEntry) UA_TimerIdTree;
+typedef LIST_HEAD(UA_TimerList, UA_TimerEntry) UA_TimerList;
+
+typedef struct {
+    UA_TimerList entries;
+    UA_DateTime minTime; /* Earliest nextTime of the entries */
+    UA_Boolean dirty;    /* The entry with the minTime was removed */
+} UA_TimerSlot;
+
+typedef struct {
+    UA_TimerSlot slots[UA_TIMER_SLOTS];
+    UA_UInt64 occupied[(UA_TIMER_SLOTS + 63) / 64]; /* Bitmap of non-empty slots */
+} UA_TimerLevel;
 
+/* The phase (nextTime modulo interval) of the last cyclic entry added for the
+ * interval. New entries with the same interval are aligned to the phase, so
+ * that they are executed in the same batch. */
 typedef struct {
-    UA_TimerTree tree;     /* The root of the time-sorted tree */
-    UA_TimerIdTree idTree; /* The root of the id-sorted tree */
-    UA_UInt64 idCounter;   /* Generate unique identifiers. Identifiers are
-                            * always above zero. */
+    UA_DateTime interval;
+    UA_DateTime phase;
+} UA_TimerPhase;
+
+typedef struct {
+    UA_TimerLevel levels[UA_TIMER_LEVELS];
+    UA_TimerSlot overflow;  /* Entries beyond the last level */
+    UA_Int64 current;       /* Tick up to which the wheel has advanced */
+    size_t entriesSize;     /* Number of entries in use */
+
+    /* Slab allocation of the entries */
+    UA_TimerEntry **slabs;
+    size_t slabsSize;
+    UA_TimerList freeEntries;
+
+    UA_TimerPhase phases[UA_TIMER_PHASES];
+
 #if UA_MULTITHREADING >= 100
     UA_Lock timerMutex;
 #endif
@@ -26,6 +26,7 @@
 #include <lwip/netif.h>
 
 #include "../../deps/mp_printf.h"
+#include "../../deps/ziptree.h"
 #include "../common/timer.h"
 
 #if !LWIP_NETIF_HOSTNAME
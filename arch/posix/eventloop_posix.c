@@ -153,6 +153,37 @@ processDelayed(UA_EventLoopPOSIX *el) {
 /* EventLoop Lifecycle */
 /***********************/
 
+#ifdef UA_HAVE_EPOLL
+static UA_StatusCode
+startEpoll(UA_EventLoopPOSIX *el) {
+    /* Create the epoll socket */
+    el->epollfd = epoll_create1(0);
+    if(el->epollfd == -1) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                          "Eventloop\t| Could not create the epoll socket (%s)",
+                          errno_str));
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* epoll always listens on the self-pipe. This is the only epoll_event that
+     * has a NULL data pointer. */
+    struct epoll_event event;
+    memset(&event, 0, sizeof(struct epoll_event));
+    event.events = EPOLLIN;
+    int err = epoll_ctl(el->epollfd, EPOLL_CTL_ADD, el->selfpipe[0], &event);
+    if(err != 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                          "Eventloop\t| Could not register the self-pipe for epoll (%s)",
+                          errno_str));
+        close(el->epollfd);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+#endif
+
 static UA_StatusCode
 UA_EventLoopPOSIX_start(UA_EventLoopPOSIX *el) {
     UA_LOCK(&el->elMutex);
@@ -179,7 +210,7 @@ UA_EventLoopPOSIX_start(UA_EventLoopPOSIX *el) {
                                  UA_QUALIFIEDNAME(0, "clock-source-monotonic"),
                                  &UA_TYPES[UA_TYPES_INT32]);
     if(csm) {
-        if(el->clockSourceMonotonic != *csm && el->timer.idTree.root) {
+        if(el->clockSourceMonotonic != *csm && el->timer.entriesSize > 0) {
             UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
                            "Eventloop\t| Setting a different monotonic clock, ",
                            "but existing timers have been registered with a "
@@ -207,41 +238,30 @@ UA_EventLoopPOSIX_start(UA_EventLoopPOSIX *el) {
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
-    /* Create the epoll socket */
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
 #ifdef UA_HAVE_EPOLL
-    el->epollfd = epoll_create1(0);
-    if(el->epollfd == -1) {
-        UA_LOG_SOCKET_ERRNO_WRAP(
-           UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
-                          "Eventloop\t| Could not create the epoll socket (%s)",
-                          errno_str));
-        UA_close(el->selfpipe[0]);
-        UA_close(el->selfpipe[1]);
-        UA_UNLOCK(&el->elMutex);
-        return UA_STATUSCODE_BADINTERNALERROR;
+# ifdef UA_HAVE_IO_URING
+    /* Set up io_uring. Fall back to epoll if this fails. */
+    if(el->useUring) {
+        res = UA_EventLoopPOSIX_uringStart(el);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                           "Eventloop\t| io_uring is not available, using epoll");
+            el->useUring = false;
+        }
     }
-
-    /* epoll always listens on the self-pipe. This is the only epoll_event that
-     * has a NULL data pointer. */
-    struct epoll_event event;
-    memset(&event, 0, sizeof(struct epoll_event));
-    event.events = EPOLLIN;
-    err = epoll_ctl(el->epollfd, EPOLL_CTL_ADD, el->selfpipe[0], &event);
-    if(err != 0) {
-        UA_LOG_SOCKET_ERRNO_WRAP(
-           UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
-                          "Eventloop\t| Could not register the self-pipe for epoll (%s)",
-                          errno_str));
+    if(!el->useUring)
+# endif
+    res = startEpoll(el);
+    if(res != UA_STATUSCODE_GOOD) {
         UA_close(el->selfpipe[0]);
         UA_close(el->selfpipe[1]);
-        close(el->epollfd);
         UA_UNLOCK(&el->elMutex);
-        return UA_STATUSCODE_BADINTERNALERROR;
+        return res;
     }
 #endif
 
     /* Start the EventSources */
-    UA_StatusCode res = UA_STATUSCODE_GOOD;
     UA_EventSource *es = el->eventLoop.eventSources;
     while(es) {
         res |= es->start(es);
@@ -281,6 +301,11 @@ checkClosed(UA_EventLoopPOSIX *el) {
 
     /* Close the epoll/IOCP socket once all EventSources have shut down */
 #ifdef UA_HAVE_EPOLL
+# ifdef UA_HAVE_IO_URING
+    if(el->useUring)
+        UA_EventLoopPOSIX_uringStop(el);
+    else
+# endif
     UA_close(el->epollfd);
 #endif
 
@@ -519,12 +544,13 @@ UA_EventLoopPOSIX_free(UA_EventLoopPOSIX *el) {
         es->free(es);
     }
 
+    /* Process remaining delayed callbacks. Before the timer is cleared, as
+     * they can remove timed callbacks. */
+    processDelayed(el);
+
     /* Remove the repeated timed callbacks */
     UA_Timer_clear(&el->timer);
 
-    /* Process remaining delayed callbacks */
-    processDelayed(el);
-
 #ifdef UA_ARCHITECTURE_WIN32
     /* Stop the Windows networking subsystem */
     WSACleanup();
@@ -614,6 +640,18 @@ UA_EventLoop_new_POSIX(const UA_Logger *logger) {
     return &el->eventLoop;
 }
 
+#ifdef __linux__
+UA_EventLoop *
+UA_EventLoop_new_POSIX_IOURING(const UA_Logger *logger) {
+    UA_EventLoop *el = UA_EventLoop_new_POSIX(logger);
+#ifdef UA_HAVE_IO_URING
+    if(el)
+        ((UA_EventLoopPOSIX*)el)->useUring = true;
+#endif
+    return el;
+}
+#endif
+
 /***************************/
 /* Network Buffer Handling */
 /***************************/
@@ -628,6 +666,11 @@ UA_EventLoopPOSIX_allocNetworkBuffer(UA_ConnectionManager *cm,
         return UA_ByteString_allocBuffer(buf, bufSize);
     if(pcm->txBuffer.length < bufSize)
         return UA_STATUSCODE_BADOUTOFMEMORY;
+#if UA_MULTITHREADING >= 100
+    /* The static buffer is used by another thread, fall back to the heap */
+    if(UA_atomic_cmpxchg(&pcm->txBufferUsed, NULL, pcm) != NULL)
+        return UA_ByteString_allocBuffer(buf, bufSize);
+#endif
     *buf = pcm->txBuffer;
     buf->length = bufSize;
     return UA_STATUSCODE_GOOD;
@@ -638,10 +681,14 @@ UA_EventLoopPOSIX_freeNetworkBuffer(UA_ConnectionManager *cm,
                                     uintptr_t connectionId,
                                     UA_ByteString *buf) {
     UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)cm;
-    if(pcm->txBuffer.data == buf->data)
-        UA_ByteString_init(buf);
-    else
+    if(pcm->txBuffer.data != buf->data) {
         UA_ByteString_clear(buf);
+        return;
+    }
+    UA_ByteString_init(buf);
+#if UA_MULTITHREADING >= 100
+    UA_atomic_xchg(&pcm->txBufferUsed, NULL);
+#endif
 }
 
 UA_StatusCode
@@ -915,6 +962,10 @@ UA_EventLoopPOSIX_pollFDs(UA_EventLoopPOSIX *el, UA_DateTime listenTimeout) {
 
 UA_StatusCode
 UA_EventLoopPOSIX_registerFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd) {
+#ifdef UA_HAVE_IO_URING
+    if(el->useUring)
+        return UA_EventLoopPOSIX_uringRegisterFD(el, rfd);
+#endif
     struct epoll_event event;
     memset(&event, 0, sizeof(struct epoll_event));
     event.data.ptr = rfd;
@@ -937,6 +988,10 @@ UA_EventLoopPOSIX_registerFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd) {
 
 UA_StatusCode
 UA_EventLoopPOSIX_modifyFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd) {
+#ifdef UA_HAVE_IO_URING
+    if(el->useUring)
+        return UA_EventLoopPOSIX_uringModifyFD(el, rfd);
+#endif
     struct epoll_event event;
     memset(&event, 0, sizeof(struct epoll_event));
     event.data.ptr = rfd;
@@ -959,6 +1014,12 @@ UA_EventLoopPOSIX_modifyFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd) {
 
 void
 UA_EventLoopPOSIX_deregisterFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd) {
+#ifdef UA_HAVE_IO_URING
+    if(el->useUring) {
+        UA_EventLoopPOSIX_uringDeregisterFD(el, rfd);
+        return;
+    }
+#endif
     int res = epoll_ctl(el->epollfd, EPOLL_CTL_DEL, rfd->fd, NULL);
     if(res != 0) {
         UA_LOG_SOCKET_ERRNO_WRAP(
@@ -970,6 +1031,10 @@ UA_EventLoopPOSIX_deregisterFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd) {
 
 UA_StatusCode
 UA_EventLoopPOSIX_pollFDs(UA_EventLoopPOSIX *el, UA_DateTime listenTimeout) {
+#ifdef UA_HAVE_IO_URING
+    if(el->useUring)
+        return UA_EventLoopPOSIX_uringPollFDs(el, listenTimeout);
+#endif
     UA_assert(listenTimeout >= 0);
 
     /* If there is a positive timeout, wait at least one millisecond, the
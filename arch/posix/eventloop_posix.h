@@ -17,6 +17,7 @@
 #include "../common/timer.h"
 #include "../common/eventloop_common.h"
 #include "../../deps/mp_printf.h"
+#include "../../deps/ziptree.h"
 
 #if !defined(__QNX__)
 # include "../deps/open62541_queue.h"
@@ -262,6 +263,21 @@ typedef int SOCKET;
 # include <sys/epoll.h>
 #endif
 
+/* io_uring can be selected at runtime instead of epoll. Requires the
+ * extended arguments for io_uring_enter (Linux 5.11). */
+#if defined(UA_HAVE_EPOLL) && defined(__has_include)
+# if __has_include(<linux/io_uring.h>)
+#  include <linux/io_uring.h>
+#  ifdef IORING_FEAT_EXT_ARG
+#   define UA_HAVE_IO_URING
+#  endif
+/* Multishot accept/recv into a ring of provided buffers (Linux 6.0) */
+#  ifdef IORING_RECV_MULTISHOT
+#   define UA_HAVE_IO_URING_MULTISHOT
+#  endif
+# endif
+#endif
+
 /*---------------------------*/
 /* File Handling Definitions */
 /*---------------------------*/
@@ -346,6 +362,19 @@ typedef struct UA_RegisteredFD UA_RegisteredFD;
 
 typedef void (*UA_FDCallback)(UA_EventSource *es, UA_RegisteredFD *rfd, short event);
 
+#ifdef UA_HAVE_IO_URING_MULTISHOT
+/* A new connection was accepted on a listen socket. The newfd is
+ * UA_INVALID_FD if accepting failed with the error in errno. */
+typedef void (*UA_FDAcceptCallback)(UA_EventSource *es, UA_RegisteredFD *rfd,
+                                    UA_FD newfd);
+
+/* Data was received on a connection socket. The buffer is only valid during
+ * the callback. An empty message signals that the remote side has shut down
+ * the connection. */
+typedef void (*UA_FDRecvCallback)(UA_EventSource *es, UA_RegisteredFD *rfd,
+                                  UA_ByteString msg);
+#endif
+
 struct UA_RegisteredFD {
     UA_DelayedCallback dc; /* Used for async closing. Must be the first member
                             * because the rfd is freed by the delayed callback
@@ -362,6 +391,14 @@ struct UA_RegisteredFD {
 
     UA_EventSource *es; /* Backpointer to the EventSource */
     UA_FDCallback eventSourceCB;
+
+#ifdef UA_HAVE_IO_URING_MULTISHOT
+    /* Optional. If set, the io_uring backend accepts (or receives) on behalf
+     * of the EventSource for an fd that listens for UA_FDEVENT_IN. Otherwise
+     * the eventSourceCB signals that the fd is ready. */
+    UA_FDAcceptCallback acceptCB;
+    UA_FDRecvCallback recvCB;
+#endif
 };
 
 enum ZIP_CMP cmpFD(const UA_FD *a, const UA_FD *b);
@@ -384,6 +421,10 @@ typedef struct {
     /* Statically allocated buffers */
     UA_ByteString rxBuffer;
     UA_ByteString txBuffer;
+#if UA_MULTITHREADING >= 100
+    void *txBufferUsed; /* Non-NULL while the txBuffer is handed out. Senders
+                         * can run in parallel without the EventLoop lock. */
+#endif
 
     /* Sorted tree of the FDs */
     size_t fdsSize;
@@ -393,6 +434,139 @@ typedef struct {
     UA_DeregisteredListenFDList listenFDs;
 } UA_POSIXConnectionManager;
 
+/* The UDP ConnectionManager receives and sends batches of datagrams with a
+ * single syscall where available (recvmmsg/sendmmsg). The rxBuffer is then
+ * split into recvBatchSize slots. */
+typedef struct {
+    UA_POSIXConnectionManager pcm;
+
+    size_t recvBatchSize;
+    size_t recvSlotSize;
+
+    /* Flushes the datagrams queued with the "more" send parameter */
+    UA_DelayedCallback flushCallback;
+    UA_Boolean flushPending;
+
+    /* Statistics for the datagrams per syscall */
+    size_t recvCalls;
+    size_t recvDatagrams;
+    size_t sendCalls;
+    size_t sendDatagrams;
+} UA_POSIXUDPConnectionManager;
+
+/* The Ethernet ConnectionManager can exchange frames through PACKET_MMAP rings
+ * shared with the kernel. Frames written to a TX ring with the "more" send
+ * parameter are handed to the kernel together. */
+typedef struct {
+    UA_POSIXConnectionManager pcm;
+
+    /* Flushes the TX rings filled with the "more" send parameter */
+    UA_DelayedCallback flushCallback;
+    UA_Boolean flushPending;
+} UA_POSIXETHConnectionManager;
+
+#ifdef UA_HAVE_IO_URING
+
+/* Buffers that are sent with a single IORING_OP_SENDMSG. Sends to the same
+ * fd are collected until the previous sendmsg has completed. */
+#define UA_IOURING_MAXIOV 64
+
+typedef struct UA_IOUringSend {
+    LIST_ENTRY(UA_IOUringSend) pointers;
+    UA_FD fd;
+    UA_Boolean more; /* Set MSG_MORE for the last buffer */
+
+    /* The fd was deregistered while the send was pending. Then the fd is a
+     * duplicate owned by the chain of sends that still go out. */
+    UA_Boolean detached;
+    UA_Boolean ownsFd;
+    UA_DateTime deadline; /* Abort the detached sends afterwards */
+    struct UA_IOUringSend *next;
+
+    size_t bufsSize;
+    size_t bufsCapacity;
+    UA_ByteString *bufs;
+    size_t current; /* Progress of partial sends */
+    size_t offset;
+    struct msghdr msg;
+    struct iovec iov[UA_IOURING_MAXIOV];
+} UA_IOUringSend;
+
+typedef LIST_HEAD(UA_IOUringSendList, UA_IOUringSend) UA_IOUringSendList;
+
+/* Registered fds are indexed by their fd number. The generation counter
+ * distinguishes a re-registered fd number from completions of earlier
+ * registrations that arrive late. */
+typedef struct {
+    UA_RegisteredFD *rfd;
+    UA_UInt32 gen;
+    UA_Byte op;       /* Type of the pending request (poll/accept/recv) */
+    UA_Boolean armed; /* A request is pending in the kernel */
+    UA_IOUringSend *sending; /* Submitted to the kernel */
+    UA_IOUringSend *queued;  /* Collects the buffers for the next sendmsg */
+} UA_IOUringSlot;
+
+typedef struct {
+    int fd;
+
+    /* Submission queue (shared with the kernel) */
+    unsigned *sqHead;
+    unsigned *sqTail;
+    unsigned sqMask;
+    unsigned *sqArray;
+    unsigned sqEntries;
+    unsigned sqLocalTail; /* Queued but not yet published to the kernel */
+    struct io_uring_sqe *sqes;
+
+    /* Completion queue (shared with the kernel) */
+    unsigned *cqHead;
+    unsigned *cqTail;
+    unsigned cqMask;
+    struct io_uring_cqe *cqes;
+
+    /* Mapped memory */
+    void *sqRing;
+    size_t sqRingSize;
+    void *cqRing; /* Can be the same as the sqRing */
+    size_t cqRingSize;
+    size_t sqesSize;
+
+    UA_IOUringSlot *slots;
+    size_t slotsSize;
+    UA_UInt32 gen;
+
+    /* Queued sends that are submitted before the next wait. And submitted
+     * sends whose fd was deregistered. They are freed when the cancelled
+     * request completes. */
+    UA_IOUringSendList pendingSends;
+    UA_IOUringSendList detachedSends;
+
+#ifdef UA_HAVE_IO_URING_MULTISHOT
+    /* Ring of provided buffers for the multishot receive. Not used if the
+     * kernel does not support it. */
+    struct io_uring_buf_ring *bufRing;
+    size_t bufRingSize;
+    UA_Byte *bufs;
+    UA_UInt16 bufTail;
+    UA_Boolean multishot;
+#endif
+
+    UA_Boolean selfpipeArmed;
+    UA_Boolean stopping;
+
+    /* Set while the EventLoop waits (unlocked) in io_uring_enter */
+    UA_Boolean waiting;
+
+#if UA_MULTITHREADING >= 100
+    /* Protects the submission queue and the slots. Senders use it without
+     * holding the EventLoop lock. Leaf lock, the EventLoop lock is taken
+     * first. */
+    UA_Lock ringMutex;
+#endif
+} UA_IOUring;
+
+#endif
+
 typedef struct {
     UA_EventLoop eventLoop;
 
@@ -427,6 +601,12 @@ typedef struct {
 
 #if defined(UA_HAVE_EPOLL)
     UA_FD epollfd;
+# if defined(UA_HAVE_IO_URING)
+    /* Use io_uring instead of epoll. Falls back to epoll during _start if
+     * io_uring is not available. */
+    UA_Boolean useUring;
+    UA_IOUring uring;
+# endif
 #else
     UA_RegisteredFD **fds;
     size_t fdsSize;
@@ -457,6 +637,46 @@ UA_EventLoopPOSIX_deregisterFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd);
 UA_StatusCode
 UA_EventLoopPOSIX_pollFDs(UA_EventLoopPOSIX *el, UA_DateTime listenTimeout);
 
+#ifdef UA_HAVE_IO_URING
+
+/* The io_uring variants of the above. Registration changes and the re-arming
+ * of (one-shot) poll requests are queued and submitted in a single
+ * io_uring_enter that also waits for the next events. */
+
+UA_StatusCode
+UA_EventLoopPOSIX_uringStart(UA_EventLoopPOSIX *el);
+
+void
+UA_EventLoopPOSIX_uringStop(UA_EventLoopPOSIX *el);
+
+UA_StatusCode
+UA_EventLoopPOSIX_uringRegisterFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd);
+
+UA_StatusCode
+UA_EventLoopPOSIX_uringModifyFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd);
+
+void
+UA_EventLoopPOSIX_uringDeregisterFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd);
+
+UA_StatusCode
+UA_EventLoopPOSIX_uringPollFDs(UA_EventLoopPOSIX *el, UA_DateTime listenTimeout);
+
+/* Queue the buffers for sending with the next io_uring_enter. Takes ownership
+ * of the (heap-allocated) buffers if the result is good. Can be called without
+ * holding the EventLoop lock. */
+UA_StatusCode
+UA_EventLoopPOSIX_uringSend(UA_EventLoopPOSIX *el, UA_FD fd, UA_Boolean more,
+                            UA_ByteString *bufs, size_t bufsSize);
+
+/* Shut down the socket. If sends are still queued, only the receiving side is
+ * shut down right away. The socket is closed after the sends went out, or
+ * aborted if that takes longer than the linger time. Then the EventLoop is
+ * woken up so that the EventSource can deregister the fd. */
+void
+UA_EventLoopPOSIX_uringShutdown(UA_EventLoopPOSIX *el, UA_FD fd);
+
+#endif
+
 /* Helper functions across EventSources */
 
 UA_StatusCode
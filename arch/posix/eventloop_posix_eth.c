@@ -17,6 +17,7 @@
 #include <net/ethernet.h> /* ETH_P_*/
 #include <linux/if_packet.h>
 #include <linux/net_tstamp.h> /* txtime */
+#include <sys/mman.h> /* PACKET_MMAP rings */
 
 /* Configuration parameters */
 
@@ -27,7 +28,7 @@ static UA_KeyValueRestriction ethManagerParams[ETH_MANAGERPARAMS] = {
     {{0, UA_STRING_STATIC("send-bufsize")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false}
 };
 
-#define ETH_PARAMETERSSIZE 15
+#define ETH_PARAMETERSSIZE 17
 #define ETH_PARAMINDEX_ADDR 0
 #define ETH_PARAMINDEX_LISTEN 1
 #define ETH_PARAMINDEX_IFACE 2
@@ -43,6 +44,8 @@ static UA_KeyValueRestriction ethManagerParams[ETH_MANAGERPARAMS] = {
 #define ETH_PARAMINDEX_TXTIME_PICO 12
 #define ETH_PARAMINDEX_TXTIME_DROP 13
 #define ETH_PARAMINDEX_VALIDATE 14
+#define ETH_PARAMINDEX_PACKETMMAP 15
+#define ETH_PARAMINDEX_PACKETMMAP_FRAMES 16
 
 static UA_KeyValueRestriction ethConnectionParams[ETH_PARAMETERSSIZE+1] = {
     {{0, UA_STRING_STATIC("address")}, &UA_TYPES[UA_TYPES_STRING], false, true, false},
@@ -60,12 +63,21 @@ static UA_KeyValueRestriction ethConnectionParams[ETH_PARAMETERSSIZE+1] = {
     {{0, UA_STRING_STATIC("txtime-pico")}, &UA_TYPES[UA_TYPES_UINT16], false, true, false},
     {{0, UA_STRING_STATIC("txtime-drop-late")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false},
     {{0, UA_STRING_STATIC("validate")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false},
+    {{0, UA_STRING_STATIC("packet-mmap")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false},
+    {{0, UA_STRING_STATIC("packet-mmap-frames")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false},
     /* Duplicated address parameter with a scalar value required. For the send-socket case. */
     {{0, UA_STRING_STATIC("address")}, &UA_TYPES[UA_TYPES_STRING], true, true, false},
 };
 
 #define UA_ETH_MAXHEADERLENGTH (2*ETHER_ADDR_LEN)+4+2+2
 
+/* Geometry of the PACKET_MMAP rings. A frame slot holds the tpacket2_hdr and a
+ * full-sized Ethernet frame. Two slots make up a page-sized ring block. */
+#define ETH_RING_FRAMESIZE 2048
+#define ETH_RING_BLOCKSIZE 4096
+#define ETH_RING_DEFAULTFRAMES 128
+#define ETH_RING_MAXFRAMES 4096
+
 typedef struct {
     UA_RegisteredFD rfd;
 
@@ -85,8 +97,25 @@ typedef struct {
     unsigned char lengthOffset; /* No length field if zero */
 
     UA_Boolean txtimeEnabled;
+
+    /* PACKET_MMAP ring shared with the kernel. An RX ring for listen sockets
+     * and a TX ring for send sockets. NULL if the frames are exchanged with
+     * recv/sendto. */
+    UA_Byte *ring;
+    size_t ringSize;
+    unsigned int frameCount;
+    unsigned int frameIdx; /* Next slot to consume (RX) or fill (TX) */
+    UA_Boolean txPending;  /* TX slots filled but the kernel was not kicked */
 } ETH_FD;
 
+/* Frame data in a TX ring slot starts after the tpacket2_hdr */
+#define ETH_RING_TXOFFSET (TPACKET2_HDRLEN - sizeof(struct sockaddr_ll))
+
+static struct tpacket2_hdr *
+ETH_ringSlot(ETH_FD *conn, unsigned int idx) {
+    return (struct tpacket2_hdr*)(conn->ring + (size_t)idx * ETH_RING_FRAMESIZE);
+}
+
 /* The format of a Ethernet address is six groups of hexadecimal digits,
  * separated by hyphens (e.g. 01-23-45-67-89-ab). */
 static UA_StatusCode
@@ -283,6 +312,16 @@ ETH_close(UA_POSIXConnectionManager *pcm, ETH_FD *conn) {
                         UA_CONNECTIONSTATE_CLOSING,
                         &UA_KEYVALUEMAP_NULL, UA_BYTESTRING_NULL);
 
+    /* Hand the remaining frames of the TX ring to the kernel (best effort) and
+     * unmap the ring */
+    if(conn->ring) {
+        if(conn->txPending)
+            UA_sendto(conn->rfd.fd, NULL, 0, MSG_NOSIGNAL | MSG_DONTWAIT,
+                      (struct sockaddr*)&conn->sll, sizeof(conn->sll));
+        munmap(conn->ring, conn->ringSize);
+        conn->ring = NULL;
+    }
+
     /* Close the socket */
     UA_RESET_ERRNO;
     int ret = UA_close(conn->rfd.fd);
@@ -318,6 +357,89 @@ ETH_delayedClose(void *application, void *context) {
     UA_free(conn);
 }
 
+/* Parse the Ethernet header of a received frame and forward the payload to the
+ * application */
+static void
+ETH_deliverFrame(UA_ConnectionManager *cm, ETH_FD *conn, UA_ByteString response) {
+    /* Parse the Ethernet header */
+    unsigned char destAddr[ETHER_ADDR_LEN];
+    unsigned char sourceAddr[ETHER_ADDR_LEN];
+    UA_UInt16 etherType = 0;
+    UA_UInt16 vid = 0;
+    UA_Byte pcp = 0;
+    UA_Boolean dei = 0;
+    size_t headerSize = parseETHHeader(&response, destAddr, sourceAddr,
+                                       &etherType, &vid, &pcp, &dei);
+    if(headerSize == 0)
+        return;
+
+    /* Set up the parameter arguments passed to the application */
+    unsigned char destAddrBytes[18];
+    unsigned char sourceAddrBytes[18];
+    setAddrString(destAddrBytes, destAddr);
+    setAddrString(sourceAddrBytes, sourceAddr);
+    UA_String destAddrStr = {17, destAddrBytes};
+    UA_String sourceAddrStr = {17, sourceAddrBytes};
+
+    size_t paramsSize = 2;
+    UA_KeyValuePair params[6];
+    params[0].key = UA_QUALIFIEDNAME(0, "destination-address");
+    UA_Variant_setScalar(&params[0].value, &destAddrStr, &UA_TYPES[UA_TYPES_STRING]);
+    params[1].key = UA_QUALIFIEDNAME(0, "source-address");
+    UA_Variant_setScalar(&params[1].value, &sourceAddrStr, &UA_TYPES[UA_TYPES_STRING]);
+
+    if(etherType > 0) {
+        params[2].key = UA_QUALIFIEDNAME(0, "ethertype");
+        UA_Variant_setScalar(&params[1].value, &etherType, &UA_TYPES[UA_TYPES_UINT16]);
+        paramsSize++;
+    }
+
+    if(vid > 0) {
+        params[paramsSize].key = UA_QUALIFIEDNAME(0, "vid");
+        UA_Variant_setScalar(&params[paramsSize].value, &vid, &UA_TYPES[UA_TYPES_UINT16]);
+        params[paramsSize+1].key = UA_QUALIFIEDNAME(0, "pcp");
+        UA_Variant_setScalar(&params[paramsSize+1].value, &pcp, &UA_TYPES[UA_TYPES_BYTE]);
+        params[paramsSize+2].key = UA_QUALIFIEDNAME(0, "dei");
+        UA_Variant_setScalar(&params[paramsSize+2].value, &dei, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        paramsSize += 3;
+    }
+
+    /* Callback to the application layer with the Ethernet header hidden */
+    UA_KeyValueMap map = {paramsSize, params};
+    response.data += headerSize;
+    response.length -= headerSize;
+    conn->applicationCB(cm, (uintptr_t)conn->rfd.fd, conn->application,
+                        &conn->context, UA_CONNECTIONSTATE_ESTABLISHED,
+                        &map, response);
+}
+
+/* Consume the frames the kernel has placed in the RX ring. At most one round
+ * through the ring, so that other sockets are not starved. Returns the number
+ * of frames consumed. */
+static size_t
+ETH_receiveRing(UA_ConnectionManager *cm, ETH_FD *conn) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
+    size_t received = 0;
+    for(; received < conn->frameCount; received++) {
+        struct tpacket2_hdr *hdr = ETH_ringSlot(conn, conn->frameIdx);
+        if(!(__atomic_load_n(&hdr->tp_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER))
+            break;
+
+        UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                     "ETH %u\t| Received message of size %u from the ring",
+                     (unsigned)conn->rfd.fd, (unsigned)hdr->tp_snaplen);
+
+        /* The frame is processed in place. The slot is returned to the kernel
+         * afterwards. */
+        UA_ByteString frame = {hdr->tp_snaplen, (UA_Byte*)hdr + hdr->tp_mac};
+        ETH_deliverFrame(cm, conn, frame);
+
+        __atomic_store_n(&hdr->tp_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+        conn->frameIdx = (conn->frameIdx + 1) % conn->frameCount;
+    }
+    return received;
+}
+
 /* Gets called when a socket receives data or closes */
 static void
 ETH_connectionSocketCallback(UA_ConnectionManager *cm, UA_RegisteredFD *rfd,
@@ -337,6 +459,11 @@ ETH_connectionSocketCallback(UA_ConnectionManager *cm, UA_RegisteredFD *rfd,
         return;
     }
 
+    /* Take the frames from the RX ring. Frames that were queued on the socket
+     * before the ring was set up are still received with recv below. */
+    if(conn->ring && ETH_receiveRing(cm, conn) > 0)
+        return;
+
     /* Use the already allocated receive-buffer */
     UA_ByteString response = pcm->rxBuffer;
 
@@ -355,6 +482,10 @@ ETH_connectionSocketCallback(UA_ConnectionManager *cm, UA_RegisteredFD *rfd,
         if(UA_ERRNO == UA_INTERRUPTED)
             return;
 
+        /* Spurious wakeup of a ring socket with an empty queue */
+        if(conn->ring && (UA_ERRNO == UA_WOULDBLOCK || UA_ERRNO == UA_AGAIN))
+            return;
+
         /* Orderly shutdown of the socket. We can immediately close as no method
          * "below" in the call stack will use the socket in this iteration of
          * the EventLoop. */
@@ -372,58 +503,7 @@ ETH_connectionSocketCallback(UA_ConnectionManager *cm, UA_RegisteredFD *rfd,
                  (unsigned)rfd->fd, (unsigned)ret);
 
     response.length = (size_t)ret;
-
-    /* Parse the Ethernet header */
-    unsigned char destAddr[ETHER_ADDR_LEN];
-    unsigned char sourceAddr[ETHER_ADDR_LEN];
-    UA_UInt16 etherType = 0;
-    UA_UInt16 vid = 0;
-    UA_Byte pcp = 0;
-    UA_Boolean dei = 0;
-    size_t headerSize = parseETHHeader(&response, destAddr, sourceAddr,
-                                       &etherType, &vid, &pcp, &dei);
-    if(headerSize == 0)
-        return;
-
-    /* Set up the parameter arguments passed to the application */
-    unsigned char destAddrBytes[18];
-    unsigned char sourceAddrBytes[18];
-    setAddrString(destAddrBytes, destAddr);
-    setAddrString(sourceAddrBytes, sourceAddr);
-    UA_String destAddrStr = {17, destAddrBytes};
-    UA_String sourceAddrStr = {17, sourceAddrBytes};
-
-    size_t paramsSize = 2;
-    UA_KeyValuePair params[6];
-    params[0].key = UA_QUALIFIEDNAME(0, "destination-address");
-    UA_Variant_setScalar(&params[0].value, &destAddrStr, &UA_TYPES[UA_TYPES_STRING]);
-    params[1].key = UA_QUALIFIEDNAME(0, "source-address");
-    UA_Variant_setScalar(&params[1].value, &sourceAddrStr, &UA_TYPES[UA_TYPES_STRING]);
-
-    if(etherType > 0) {
-        params[2].key = UA_QUALIFIEDNAME(0, "ethertype");
-        UA_Variant_setScalar(&params[1].value, &etherType, &UA_TYPES[UA_TYPES_UINT16]);
-        paramsSize++;
-    }
-
-    if(vid > 0) {
-        params[paramsSize].key = UA_QUALIFIEDNAME(0, "vid");
-        UA_Variant_setScalar(&params[paramsSize].value, &vid, &UA_TYPES[UA_TYPES_UINT16]);
-        params[paramsSize+1].key = UA_QUALIFIEDNAME(0, "pcp");
-        UA_Variant_setScalar(&params[paramsSize+1].value, &pcp, &UA_TYPES[UA_TYPES_BYTE]);
-        params[paramsSize+2].key = UA_QUALIFIEDNAME(0, "dei");
-        UA_Variant_setScalar(&params[paramsSize+2].value, &dei, &UA_TYPES[UA_TYPES_BOOLEAN]);
-        paramsSize += 3;
-    }
-
-    /* Callback to the application layer with the Ethernet header hidden */
-    UA_KeyValueMap map = {paramsSize, params};
-    response.data += headerSize;
-    response.length -= headerSize;
-    conn->applicationCB(cm, (uintptr_t)rfd->fd, conn->application, &conn->context,
-                        UA_CONNECTIONSTATE_ESTABLISHED, &map, response);
-    response.data -= headerSize;
-    response.length += headerSize;
+    ETH_deliverFrame(cm, conn, response);
 }
 
 static UA_StatusCode
@@ -623,6 +703,94 @@ ETH_openSendConnection(UA_EventLoopPOSIX *el, ETH_FD *conn, const UA_KeyValueMap
     return UA_STATUSCODE_GOOD;
 }
 
+/* Map a PACKET_MMAP ring for the socket if the "packet-mmap" parameter is set.
+ * Listen sockets get an RX ring and send sockets a TX ring. If the ring cannot
+ * be set up, the frames are exchanged with recv/sendto instead. */
+static void
+ETH_setupRing(UA_EventLoopPOSIX *el, ETH_FD *conn, const UA_KeyValueMap *params,
+              UA_Boolean listen) {
+    UA_LOCK_ASSERT(&el->elMutex);
+
+    const UA_Boolean *packetMmap = (const UA_Boolean*)
+        UA_KeyValueMap_getScalar(params, ethConnectionParams[ETH_PARAMINDEX_PACKETMMAP].name,
+                                 &UA_TYPES[UA_TYPES_BOOLEAN]);
+    if(!packetMmap || !*packetMmap)
+        return;
+
+    /* Frames with a txtime need a control message per frame. This is not
+     * possible with the TX ring. */
+    if(conn->txtimeEnabled) {
+        UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                       "ETH %u\t| PACKET_MMAP cannot be combined with txtime. "
+                       "Using sendto instead.", (unsigned)conn->rfd.fd);
+        return;
+    }
+
+    /* Number of frame slots. Rounded up to fill the last block. */
+    const unsigned int framesPerBlock = ETH_RING_BLOCKSIZE / ETH_RING_FRAMESIZE;
+    unsigned int frames = ETH_RING_DEFAULTFRAMES;
+    const UA_UInt32 *framesParam = (const UA_UInt32*)
+        UA_KeyValueMap_getScalar(params,
+                                 ethConnectionParams[ETH_PARAMINDEX_PACKETMMAP_FRAMES].name,
+                                 &UA_TYPES[UA_TYPES_UINT32]);
+    if(framesParam)
+        frames = *framesParam;
+    if(frames > ETH_RING_MAXFRAMES)
+        frames = ETH_RING_MAXFRAMES;
+    frames = ((frames + framesPerBlock - 1) / framesPerBlock) * framesPerBlock;
+    if(frames == 0)
+        frames = framesPerBlock;
+
+    UA_RESET_ERRNO;
+    int version = TPACKET_V2;
+    if(UA_setsockopt(conn->rfd.fd, SOL_PACKET, PACKET_VERSION,
+                     &version, sizeof(version)) < 0)
+        goto error;
+
+    /* Skip malformed frames in the TX ring instead of stalling */
+    int loss = 1;
+    if(!listen && UA_setsockopt(conn->rfd.fd, SOL_PACKET, PACKET_LOSS,
+                                &loss, sizeof(loss)) < 0)
+        goto error;
+
+    struct tpacket_req req;
+    memset(&req, 0, sizeof(struct tpacket_req));
+    req.tp_block_size = ETH_RING_BLOCKSIZE;
+    req.tp_block_nr = frames / framesPerBlock;
+    req.tp_frame_size = ETH_RING_FRAMESIZE;
+    req.tp_frame_nr = frames;
+    int ringOpt = (listen) ? PACKET_RX_RING : PACKET_TX_RING;
+    if(UA_setsockopt(conn->rfd.fd, SOL_PACKET, ringOpt, &req, sizeof(req)) < 0)
+        goto error;
+
+    size_t ringSize = (size_t)req.tp_block_size * req.tp_block_nr;
+    void *ring = mmap(NULL, ringSize, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, conn->rfd.fd, 0);
+    if(ring == MAP_FAILED) {
+        /* Remove the ring from the socket again */
+        memset(&req, 0, sizeof(struct tpacket_req));
+        UA_setsockopt(conn->rfd.fd, SOL_PACKET, ringOpt, &req, sizeof(req));
+        goto error;
+    }
+
+    conn->ring = (UA_Byte*)ring;
+    conn->ringSize = ringSize;
+    conn->frameCount = frames;
+    conn->frameIdx = 0;
+
+    UA_LOG_INFO(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                "ETH %u\t| Mapped a PACKET_MMAP %s ring with %u frames",
+                (unsigned)conn->rfd.fd, (listen) ? "RX" : "TX", frames);
+    return;
+
+ error:
+    UA_LOG_SOCKET_ERRNO_WRAP(
+       UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                      "ETH %u\t| Could not set up the PACKET_MMAP ring (%s). "
+                      "Using recv/sendto instead.",
+                      (unsigned)conn->rfd.fd, errno_str));
+}
+
 static UA_StatusCode
 ETH_openConnection(UA_ConnectionManager *cm, const UA_KeyValueMap *params,
                    void *application, void *context,
@@ -750,6 +918,9 @@ ETH_openConnection(UA_ConnectionManager *cm, const UA_KeyValueMap *params,
     if(validate || res != UA_STATUSCODE_GOOD)
         goto cleanup;
 
+    /* Exchange the frames through a PACKET_MMAP ring */
+    ETH_setupRing(el, conn, params, (listen && *listen));
+
     /* Register in the EventLoop */
     res = UA_EventLoopPOSIX_registerFD(el, &conn->rfd);
     if(res != UA_STATUSCODE_GOOD)
@@ -759,10 +930,15 @@ ETH_openConnection(UA_ConnectionManager *cm, const UA_KeyValueMap *params,
     ZIP_INSERT(UA_FDTree, &pcm->fds, &conn->rfd);
     pcm->fdsSize++;
 
-    /* Register the listen socket in the application */
+    /* Register the socket in the application. Report whether the frames are
+     * exchanged through a PACKET_MMAP ring. */
+    UA_Boolean mapped = (conn->ring != NULL);
+    UA_KeyValuePair kvp;
+    kvp.key = UA_QUALIFIEDNAME(0, "packet-mmap");
+    UA_Variant_setScalar(&kvp.value, &mapped, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    UA_KeyValueMap kvm = {1, &kvp};
     connectionCallback(cm, (uintptr_t)sockfd, application, &conn->context,
-                       UA_CONNECTIONSTATE_ESTABLISHED, &UA_KEYVALUEMAP_NULL,
-                       UA_BYTESTRING_NULL);
+                       UA_CONNECTIONSTATE_ESTABLISHED, &kvm, UA_BYTESTRING_NULL);
     UA_UNLOCK(&el->elMutex);
     return UA_STATUSCODE_GOOD;
 
@@ -890,6 +1066,127 @@ send_txtime(UA_EventLoopPOSIX *el, ETH_FD *conn, const UA_KeyValueMap *params,
 }
 #endif
 
+/* Hand the frames written to the TX ring to the kernel. The kernel sends all
+ * slots marked with TP_STATUS_SEND_REQUEST in a single syscall. */
+static UA_StatusCode
+ETH_flushRing(UA_POSIXConnectionManager *pcm, ETH_FD *conn) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
+    UA_LOCK_ASSERT(&el->elMutex);
+
+    conn->txPending = false;
+    UA_RESET_ERRNO;
+    ssize_t n = UA_sendto(conn->rfd.fd, NULL, 0, MSG_NOSIGNAL,
+                          (struct sockaddr*)&conn->sll, sizeof(conn->sll));
+    if(n >= 0)
+        return UA_STATUSCODE_GOOD;
+
+    /* The socket buffer is full. The frames remain in the ring and are picked
+     * up by the next kick. */
+    if(UA_ERRNO == UA_INTERRUPTED || UA_ERRNO == UA_WOULDBLOCK ||
+       UA_ERRNO == UA_AGAIN || UA_ERRNO == UA_NOBUFS) {
+        conn->txPending = true;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    UA_LOG_SOCKET_ERRNO_WRAP(
+       UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                    "ETH %u\t| Send failed with error %s",
+                    (unsigned)conn->rfd.fd, errno_str));
+    ETH_shutdown(pcm, conn);
+    return UA_STATUSCODE_BADCONNECTIONCLOSED;
+}
+
+static void *
+ETH_flushCB(void *application, UA_RegisteredFD *rfd) {
+    ETH_FD *conn = (ETH_FD*)rfd;
+    if(conn->txPending && !rfd->dc.callback)
+        ETH_flushRing((UA_POSIXConnectionManager*)application, conn);
+    return NULL;
+}
+
+/* Kick the TX rings that still have frames in the next EventLoop iteration. In
+ * case the application never sends without the "more" parameter. */
+static void
+ETH_delayedFlush(void *application, void *context) {
+    UA_POSIXETHConnectionManager *ecm = (UA_POSIXETHConnectionManager*)application;
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)ecm->pcm.cm.eventSource.eventLoop;
+    (void)el;
+    UA_LOCK(&el->elMutex);
+    ecm->flushPending = false;
+    ZIP_ITER(UA_FDTree, &ecm->pcm.fds, ETH_flushCB, &ecm->pcm);
+    UA_UNLOCK(&el->elMutex);
+}
+
+/* Copy the frame into the next slot of the TX ring. Blocks (with a poll) until
+ * the kernel has released a slot if the ring is full. */
+static UA_StatusCode
+ETH_sendRing(UA_POSIXETHConnectionManager *ecm, ETH_FD *conn,
+             const UA_ByteString *buf, UA_Boolean more) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)ecm->pcm.cm.eventSource.eventLoop;
+    UA_LOCK_ASSERT(&el->elMutex);
+
+    if(buf->length > ETH_RING_FRAMESIZE - ETH_RING_TXOFFSET) {
+        UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                     "ETH %u\t| Frame of size %u exceeds the TX ring slot",
+                     (unsigned)conn->rfd.fd, (unsigned)buf->length);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    struct pollfd tmp_poll_fd;
+    tmp_poll_fd.fd = conn->rfd.fd;
+    tmp_poll_fd.events = UA_POLLOUT;
+
+    /* Wait for the slot to become available */
+    struct tpacket2_hdr *hdr = ETH_ringSlot(conn, conn->frameIdx);
+    UA_UInt32 status;
+    while((status = __atomic_load_n(&hdr->tp_status, __ATOMIC_ACQUIRE)) !=
+          TP_STATUS_AVAILABLE) {
+        if(status == TP_STATUS_WRONG_FORMAT) {
+            UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                           "ETH %u\t| The kernel rejected a frame of the TX ring",
+                           (unsigned)conn->rfd.fd);
+            break;
+        }
+
+        /* The ring is full of frames that were not handed over yet */
+        if(status == TP_STATUS_SEND_REQUEST) {
+            UA_StatusCode res = ETH_flushRing(&ecm->pcm, conn);
+            if(res != UA_STATUSCODE_GOOD)
+                return res;
+        }
+
+        UA_RESET_ERRNO;
+        int poll_ret = UA_poll(&tmp_poll_fd, 1, 100);
+        if(poll_ret < 0 && UA_ERRNO != UA_INTERRUPTED) {
+            UA_LOG_SOCKET_ERRNO_WRAP(
+               UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                            "ETH %u\t| Send failed with error %s",
+                            (unsigned)conn->rfd.fd, errno_str));
+            ETH_shutdown(&ecm->pcm, conn);
+            return UA_STATUSCODE_BADCONNECTIONCLOSED;
+        }
+    }
+
+    /* Fill the slot and pass ownership to the kernel */
+    memcpy((UA_Byte*)hdr + ETH_RING_TXOFFSET, buf->data, buf->length);
+    hdr->tp_len = (__u32)buf->length;
+    __atomic_store_n(&hdr->tp_status, TP_STATUS_SEND_REQUEST, __ATOMIC_RELEASE);
+    conn->frameIdx = (conn->frameIdx + 1) % conn->frameCount;
+    conn->txPending = true;
+
+    /* Send now or together with the following frames */
+    if(!more)
+        return ETH_flushRing(&ecm->pcm, conn);
+    if(!ecm->flushPending) {
+        ecm->flushPending = true;
+        ecm->flushCallback.callback = ETH_delayedFlush;
+        ecm->flushCallback.application = ecm;
+        ecm->flushCallback.context = NULL;
+        UA_EventLoopPOSIX_addDelayedCallback((UA_EventLoop*)el, &ecm->flushCallback);
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
 static UA_StatusCode
 ETH_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
                        const UA_KeyValueMap *params, UA_ByteString *buf) {
@@ -929,6 +1226,19 @@ ETH_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
+    /* Write into the TX ring. Frames sent with the "more" parameter are handed
+     * to the kernel together. */
+    if(conn->ring) {
+        const UA_Boolean *more = (const UA_Boolean*)
+            UA_KeyValueMap_getScalar(params, UA_QUALIFIEDNAME(0, "more"),
+                                     &UA_TYPES[UA_TYPES_BOOLEAN]);
+        UA_StatusCode res = ETH_sendRing((UA_POSIXETHConnectionManager*)pcm, conn,
+                                         buf, (more && *more));
+        UA_UNLOCK(&el->elMutex);
+        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+        return res;
+    }
+
     /* Prevent OS signals when sending to a closed socket */
     int flags = MSG_NOSIGNAL;
 
@@ -1073,6 +1383,14 @@ ETH_eventSourceDelete(UA_ConnectionManager *cm) {
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
+    /* Remove the pending flush before the ConnectionManager is freed */
+    UA_POSIXETHConnectionManager *ecm = (UA_POSIXETHConnectionManager*)cm;
+    if(ecm->flushPending) {
+        UA_EventLoop *el = cm->eventSource.eventLoop;
+        el->removeDelayedCallback(el, &ecm->flushCallback);
+        ecm->flushPending = false;
+    }
+
     UA_KeyValueMap_clear(&cm->eventSource.params);
     UA_ByteString_clear(&pcm->rxBuffer);
     UA_ByteString_clear(&pcm->txBuffer);
@@ -1085,11 +1403,12 @@ static const char *ethName = "eth";
 
 UA_ConnectionManager *
 UA_ConnectionManager_new_POSIX_Ethernet(const UA_String eventSourceName) {
-    UA_POSIXConnectionManager *cm = (UA_POSIXConnectionManager*)
-        UA_calloc(1, sizeof(UA_POSIXConnectionManager));
-    if(!cm)
+    UA_POSIXETHConnectionManager *ecm = (UA_POSIXETHConnectionManager*)
+        UA_calloc(1, sizeof(UA_POSIXETHConnectionManager));
+    if(!ecm)
         return NULL;
 
+    UA_POSIXConnectionManager *cm = &ecm->pcm;
     cm->cm.eventSource.eventSourceType = UA_EVENTSOURCETYPE_CONNECTIONMANAGER;
     UA_String_copy(&eventSourceName, &cm->cm.eventSource.name);
     cm->cm.eventSource.start = (UA_StatusCode (*)(UA_EventSource *))ETH_eventSourceStart;
@@ -309,6 +309,34 @@ TCP_connectionSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn,
                         &UA_KEYVALUEMAP_NULL, response);
 }
 
+#ifdef UA_HAVE_IO_URING_MULTISHOT
+/* The io_uring EventLoop has received on the connection socket */
+static void
+TCP_connectionRecvCallback(UA_ConnectionManager *cm, TCP_FD *conn,
+                           UA_ByteString msg) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
+    UA_LOCK_ASSERT(&el->elMutex);
+
+    /* Orderly shutdown of the socket */
+    if(msg.length == 0) {
+        UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                     "TCP %u\t| recv signaled the socket was shutdown",
+                     (unsigned)conn->rfd.fd);
+        TCP_shutdown(cm, conn);
+        return;
+    }
+
+    UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                 "TCP %u\t| Received message of size %u",
+                 (unsigned)conn->rfd.fd, (unsigned)msg.length);
+
+    conn->applicationCB(cm, (uintptr_t)conn->rfd.fd,
+                        conn->application, &conn->context,
+                        UA_CONNECTIONSTATE_ESTABLISHED,
+                        &UA_KEYVALUEMAP_NULL, msg);
+}
+#endif
+
 static void *
 removeListenSockets(void *application, UA_RegisteredFD *rfd) {
     UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)application;
@@ -373,43 +401,17 @@ removeListenSockets(void *application, UA_RegisteredFD *rfd) {
     return NULL;
 }
 
-/* Gets called when a new connection opens or if the listenSocket is closed */
+/* Set up a connection that was accepted on the listen socket */
 static void
-TCP_listenSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn, short event) {
+TCP_setupAcceptedConnection(UA_ConnectionManager *cm, TCP_FD *conn,
+                            UA_FD newsockfd, struct sockaddr_storage *remote) {
     UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)cm;
     UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
-    UA_LOCK_ASSERT(&el->elMutex);
-
-    UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
-                 "TCP %u\t| Callback on server socket",
-                 (unsigned)conn->rfd.fd);
-
-    /* Try to accept a new connection */
-    UA_RESET_ERRNO;
-    struct sockaddr_storage remote;
-    socklen_t remote_size = sizeof(remote);
-    UA_FD newsockfd = UA_accept(conn->rfd.fd, (struct sockaddr*)&remote, &remote_size);
-    if(newsockfd == UA_INVALID_FD) {
-        /* Temporary error -- retry */
-        if(UA_IS_TEMPORARY_ACCEPT_ERROR(UA_ERRNO))
-            return;
-
-        /* Close the listen socket */
-        if(cm->eventSource.state != UA_EVENTSOURCESTATE_STOPPING) {
-            UA_LOG_SOCKET_ERRNO_WRAP(
-                UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
-                               "TCP %u\t| Error %s, closing the server socket",
-                               (unsigned)conn->rfd.fd, errno_str));
-        }
-
-        TCP_shutdown(cm, conn);
-        return;
-    }
 
     /* Log the name of the remote host */
     UA_RESET_ERRNO;
     char hoststr[UA_MAXHOSTNAME_LENGTH];
-    int get_res = UA_getnameinfo((struct sockaddr *)&remote, sizeof(remote),
+    int get_res = UA_getnameinfo((struct sockaddr *)remote, sizeof(*remote),
                                  hoststr, sizeof(hoststr),
                                  NULL, 0, NI_NUMERICHOST);
     if(get_res != 0) {
@@ -452,6 +454,9 @@ TCP_listenSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn, short event) {
     newConn->rfd.listenEvents = UA_FDEVENT_IN;
     newConn->rfd.es = &cm->eventSource;
     newConn->rfd.eventSourceCB = (UA_FDCallback)TCP_connectionSocketCallback;
+#ifdef UA_HAVE_IO_URING_MULTISHOT
+    newConn->rfd.recvCB = (UA_FDRecvCallback)TCP_connectionRecvCallback;
+#endif
     newConn->applicationCB = conn->applicationCB;
     newConn->application = conn->application;
     newConn->context = conn->context;
@@ -499,6 +504,78 @@ TCP_listenSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn, short event) {
                            &kvm, UA_BYTESTRING_NULL);
 }
 
+/* Gets called when a new connection opens or if the listenSocket is closed */
+static void
+TCP_listenSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn, short event) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
+    UA_LOCK_ASSERT(&el->elMutex);
+
+    UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                 "TCP %u\t| Callback on server socket",
+                 (unsigned)conn->rfd.fd);
+
+    /* Try to accept a new connection */
+    UA_RESET_ERRNO;
+    struct sockaddr_storage remote;
+    socklen_t remote_size = sizeof(remote);
+    UA_FD newsockfd = UA_accept(conn->rfd.fd, (struct sockaddr*)&remote, &remote_size);
+    if(newsockfd == UA_INVALID_FD) {
+        /* Temporary error -- retry */
+        if(UA_IS_TEMPORARY_ACCEPT_ERROR(UA_ERRNO))
+            return;
+
+        /* Close the listen socket */
+        if(cm->eventSource.state != UA_EVENTSOURCESTATE_STOPPING) {
+            UA_LOG_SOCKET_ERRNO_WRAP(
+                UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                               "TCP %u\t| Error %s, closing the server socket",
+                               (unsigned)conn->rfd.fd, errno_str));
+        }
+
+        TCP_shutdown(cm, conn);
+        return;
+    }
+
+    TCP_setupAcceptedConnection(cm, conn, newsockfd, &remote);
+}
+
+#ifdef UA_HAVE_IO_URING_MULTISHOT
+/* The io_uring EventLoop has accepted a new connection */
+static void
+TCP_listenAcceptCallback(UA_ConnectionManager *cm, TCP_FD *conn,
+                         UA_FD newsockfd) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
+    UA_LOCK_ASSERT(&el->elMutex);
+
+    /* Close the listen socket */
+    if(newsockfd == UA_INVALID_FD) {
+        if(cm->eventSource.state != UA_EVENTSOURCESTATE_STOPPING) {
+            UA_LOG_SOCKET_ERRNO_WRAP(
+                UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                               "TCP %u\t| Error %s, closing the server socket",
+                               (unsigned)conn->rfd.fd, errno_str));
+        }
+        TCP_shutdown(cm, conn);
+        return;
+    }
+
+    /* The remote address is not reported by the multishot accept */
+    struct sockaddr_storage remote;
+    socklen_t remote_size = sizeof(remote);
+    UA_RESET_ERRNO;
+    if(getpeername(newsockfd, (struct sockaddr*)&remote, &remote_size) != 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+            UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                           "TCP %u\t| The accepted connection has closed (%s)",
+                           (unsigned)newsockfd, errno_str));
+        UA_close(newsockfd);
+        return;
+    }
+
+    TCP_setupAcceptedConnection(cm, conn, newsockfd, &remote);
+}
+#endif
+
 static UA_StatusCode
 TCP_registerListenSocket(UA_POSIXConnectionManager *pcm, struct addrinfo *ai,
                          const char *hostname, UA_UInt16 port,
@@ -663,6 +740,9 @@ TCP_registerListenSocket(UA_POSIXConnectionManager *pcm, struct addrinfo *ai,
     newConn->rfd.listenEvents = UA_FDEVENT_IN;
     newConn->rfd.es = &pcm->cm.eventSource;
     newConn->rfd.eventSourceCB = (UA_FDCallback)TCP_listenSocketCallback;
+#ifdef UA_HAVE_IO_URING_MULTISHOT
+    newConn->rfd.acceptCB = (UA_FDAcceptCallback)TCP_listenAcceptCallback;
+#endif
     newConn->applicationCB = connectionCallback;
     newConn->application = application;
     newConn->context = context;
@@ -776,7 +856,13 @@ TCP_shutdown(UA_ConnectionManager *cm, TCP_FD *conn) {
         return;
     }
 
-    /* Shutdown the socket to cancel the current select/epoll */
+    /* Shutdown the socket to cancel the current select/epoll. With io_uring,
+     * the sends that are still queued go out first (within a linger time). */
+#ifdef UA_HAVE_IO_URING
+    if(el->useUring)
+        UA_EventLoopPOSIX_uringShutdown(el, conn->rfd.fd);
+    else
+#endif
     UA_shutdown(conn->rfd.fd, UA_SHUT_RDWR);
 
     UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
@@ -816,66 +902,174 @@ TCP_shutdownConnection(UA_ConnectionManager *cm, uintptr_t connectionId) {
     return UA_STATUSCODE_GOOD;
 }
 
+/* Maximum number of buffers that are passed to a single sendmsg call */
+#define TCP_MAXIOV 64
+
+#ifdef UA_HAVE_IO_URING
+/* Queue the buffers in the io_uring. They are sent with the next
+ * io_uring_enter of the EventLoop. */
 static UA_StatusCode
-TCP_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
-                       const UA_KeyValueMap *params, UA_ByteString *buf) {
+TCP_sendWithConnectionUring(UA_ConnectionManager *cm, uintptr_t connectionId,
+                            UA_Boolean more, UA_ByteString *bufs,
+                            size_t bufsSize) {
+    UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)cm;
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
+
+    /* The kernel reads from the buffers after this function has returned.
+     * Copy out of the static send buffer so that it can be reused. */
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < bufsSize && res == UA_STATUSCODE_GOOD; i++) {
+        if(pcm->txBuffer.length == 0 || bufs[i].data != pcm->txBuffer.data)
+            continue;
+        UA_ByteString copy;
+        res = UA_ByteString_copy(&bufs[i], &copy);
+        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, &bufs[i]);
+        if(res == UA_STATUSCODE_GOOD)
+            bufs[i] = copy;
+    }
+
+    if(res == UA_STATUSCODE_GOOD)
+        res = UA_EventLoopPOSIX_uringSend(el, (UA_FD)connectionId, more,
+                                          bufs, bufsSize);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(cm->eventSource.eventLoop->logger, UA_LOGCATEGORY_NETWORK,
+                     "TCP %u\t| Could not queue the message for sending (%s)",
+                     (unsigned)connectionId, UA_StatusCode_name(res));
+        for(size_t i = 0; i < bufsSize; i++)
+            UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, &bufs[i]);
+    }
+    return res;
+}
+#endif
+
+static UA_StatusCode
+TCP_sendWithConnectionVec(UA_ConnectionManager *cm, uintptr_t connectionId,
+                          const UA_KeyValueMap *params, UA_ByteString *bufs,
+                          size_t bufsSize) {
     /* We may not have a lock. But we need not take it. As the connectionId is
      * the fd, no need to do a lookup and access internal data strucures. */
 
     /* Prevent OS signals when sending to a closed socket */
     int flags = MSG_NOSIGNAL;
 
+    /* Hold back partial segments if more data follows right away */
+#ifdef MSG_MORE
+    const UA_Boolean *more = (const UA_Boolean*)
+        UA_KeyValueMap_getScalar(params, UA_QUALIFIEDNAME(0, "more"),
+                                 &UA_TYPES[UA_TYPES_BOOLEAN]);
+    if(more && *more)
+        flags |= MSG_MORE;
+#endif
+
+#ifdef UA_HAVE_IO_URING
+    if(((UA_EventLoopPOSIX*)cm->eventSource.eventLoop)->useUring)
+        return TCP_sendWithConnectionUring(cm, connectionId,
+                                           (flags & MSG_MORE) != 0,
+                                           bufs, bufsSize);
+#endif
+
     struct pollfd tmp_poll_fd;
     tmp_poll_fd.fd = (UA_FD)connectionId;
     tmp_poll_fd.events = UA_POLLOUT;
 
-    /* Send the full buffer. This may require several calls to send */
-    size_t nWritten = 0;
-    do {
-        ssize_t n = 0;
+    /* Send all buffers. The current buffer may have been sent partially up to
+     * the offset. This may require several calls to send. */
+    size_t current = 0;
+    size_t offset = 0;
+    while(current < bufsSize) {
+        /* Skip (the remainder of) fully sent buffers */
+        if(offset >= bufs[current].length) {
+            current++;
+            offset = 0;
+            continue;
+        }
+
+        UA_RESET_ERRNO;
+        UA_LOG_DEBUG(cm->eventSource.eventLoop->logger, UA_LOGCATEGORY_NETWORK,
+                     "TCP %u\t| Attempting to send", (unsigned)connectionId);
+#ifndef UA_ARCHITECTURE_WIN32
+        /* Gather the buffers for a single sendmsg call */
+        struct iovec iov[TCP_MAXIOV];
+        size_t iovlen = 0;
+        for(size_t i = current; i < bufsSize && iovlen < TCP_MAXIOV; i++) {
+            size_t skip = (i == current) ? offset : 0;
+            iov[iovlen].iov_base = bufs[i].data + skip;
+            iov[iovlen].iov_len = bufs[i].length - skip;
+            iovlen++;
+        }
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(struct msghdr));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iovlen;
+        int sendFlags = flags;
+#ifdef MSG_MORE
+        if(current + iovlen < bufsSize)
+            sendFlags |= MSG_MORE; /* More buffers beyond the iov limit */
+#endif
+        ssize_t n = sendmsg((UA_FD)connectionId, &msg, sendFlags);
+#else
+        ssize_t n = UA_send((UA_FD)connectionId,
+                            (const char*)bufs[current].data + offset,
+                            bufs[current].length - offset, flags);
+#endif
+        if(n >= 0) {
+            /* Advance over the sent bytes */
+            size_t written = (size_t)n;
+            while(written > 0) {
+                size_t left = bufs[current].length - offset;
+                if(written < left) {
+                    offset += written;
+                    break;
+                }
+                written -= left;
+                current++;
+                offset = 0;
+            }
+            continue;
+        }
+
+        /* An error we cannot recover from? */
+        if(UA_ERRNO != UA_INTERRUPTED && UA_ERRNO != UA_WOULDBLOCK &&
+           UA_ERRNO != UA_AGAIN)
+            goto shutdown;
+
+        /* Poll for the socket resources to become available and retry
+         * (blocking) */
+        int poll_ret;
         do {
             UA_RESET_ERRNO;
-            UA_LOG_DEBUG(cm->eventSource.eventLoop->logger, UA_LOGCATEGORY_NETWORK,
-                         "TCP %u\t| Attempting to send", (unsigned)connectionId);
-            size_t bytes_to_send = buf->length - nWritten;
-            n = UA_send((UA_FD)connectionId,
-                        (const char*)buf->data + nWritten,
-                        bytes_to_send, flags);
-            if(n < 0) {
-                /* An error we cannot recover from? */
-                if(UA_ERRNO != UA_INTERRUPTED && UA_ERRNO != UA_WOULDBLOCK &&
-                   UA_ERRNO != UA_AGAIN)
-                    goto shutdown;
-
-                /* Poll for the socket resources to become available and retry
-                 * (blocking) */
-                int poll_ret;
-                do {
-                    UA_RESET_ERRNO;
-                    poll_ret = UA_poll(&tmp_poll_fd, 1, 100);
-                    if(poll_ret < 0 && UA_ERRNO != UA_INTERRUPTED)
-                        goto shutdown;
-                } while(poll_ret <= 0);
-            }
-        } while(n < 0);
-        nWritten += (size_t)n;
-    } while(nWritten < buf->length);
+            poll_ret = UA_poll(&tmp_poll_fd, 1, 100);
+            if(poll_ret < 0 && UA_ERRNO != UA_INTERRUPTED)
+                goto shutdown;
+        } while(poll_ret <= 0);
+    }
 
     /* Clean up and return */
-    UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+    for(size_t i = 0; i < bufsSize; i++)
+        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, &bufs[i]);
     return UA_STATUSCODE_GOOD;
 
  shutdown:
-    /* Error -> shutdown the connection  */
+    /* Error -> shutdown the socket. Don't take the EventLoop lock, the sender
+     * might hold other locks (e.g. a service worker of the server) that the
+     * EventLoop thread waits for. The EventLoop detects the shut down socket
+     * and closes the connection. */
     UA_LOG_SOCKET_ERRNO_WRAP(
        UA_LOG_ERROR(cm->eventSource.eventLoop->logger, UA_LOGCATEGORY_NETWORK,
                     "TCP %u\t| Send failed with error %s",
                     (unsigned)connectionId, errno_str));
-    TCP_shutdownConnection(cm, connectionId);
-    UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+    UA_shutdown((UA_FD)connectionId, UA_SHUT_RDWR);
+    for(size_t i = 0; i < bufsSize; i++)
+        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, &bufs[i]);
     return UA_STATUSCODE_BADCONNECTIONCLOSED;
 }
 
+static UA_StatusCode
+TCP_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
+                       const UA_KeyValueMap *params, UA_ByteString *buf) {
+    return TCP_sendWithConnectionVec(cm, connectionId, params, buf, 1);
+}
+
 /* Create a listen-socket that waits for incoming connections */
 static UA_StatusCode
 TCP_openPassiveConnection(UA_POSIXConnectionManager *pcm, const UA_KeyValueMap *params,
@@ -1065,6 +1259,9 @@ TCP_openActiveConnection(UA_POSIXConnectionManager *pcm, const UA_KeyValueMap *p
     newConn->rfd.fd = newSock;
     newConn->rfd.es = &pcm->cm.eventSource;
     newConn->rfd.eventSourceCB = (UA_FDCallback)TCP_connectionSocketCallback;
+#ifdef UA_HAVE_IO_URING_MULTISHOT
+    newConn->rfd.recvCB = (UA_FDRecvCallback)TCP_connectionRecvCallback;
+#endif
     newConn->rfd.listenEvents = UA_FDEVENT_OUT; /* Switched to _IN once the
                                                  * connection is open */
     newConn->applicationCB = connectionCallback;
@@ -1260,6 +1457,7 @@ UA_ConnectionManager_new_POSIX_TCP(const UA_String eventSourceName) {
     cm->cm.allocNetworkBuffer = UA_EventLoopPOSIX_allocNetworkBuffer;
     cm->cm.freeNetworkBuffer = UA_EventLoopPOSIX_freeNetworkBuffer;
     cm->cm.sendWithConnection = TCP_sendWithConnection;
+    cm->cm.sendWithConnectionVec = TCP_sendWithConnectionVec;
     cm->cm.closeConnection = TCP_shutdownConnection;
     return &cm->cm;
 }
@@ -19,13 +19,23 @@
 
 /* Configuration parameters */
 
-#define UDP_MANAGERPARAMS 2
+#define UDP_MANAGERPARAMS 3
 
 static UA_KeyValueRestriction udpManagerParams[UDP_MANAGERPARAMS] = {
     {{0, UA_STRING_STATIC("recv-bufsize")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false},
-    {{0, UA_STRING_STATIC("send-bufsize")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false}
+    {{0, UA_STRING_STATIC("send-bufsize")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false},
+    {{0, UA_STRING_STATIC("recv-batchsize")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false}
 };
 
+/* Batched sending and receiving with a single syscall */
+#if defined(__linux__)
+# define UDP_HAVE_MMSG
+#endif
+
+#define UDP_MAXBATCH 32
+#define UDP_DEFAULTRECVBATCH 8
+#define UDP_MAXDATAGRAMSIZE 65535
+
 #define UDP_PARAMETERSSIZE 9
 #define UDP_PARAMINDEX_LISTEN 0
 #define UDP_PARAMINDEX_ADDR 1
@@ -63,6 +73,10 @@ typedef struct {
 #else
     socklen_t sendAddrLength;
 #endif
+
+    /* Datagrams queued with the "more" send parameter */
+    size_t txQueueSize;
+    UA_ByteString txQueue[UDP_MAXBATCH];
 } UDP_FD;
 
 typedef enum {
@@ -622,6 +636,11 @@ UDP_close(UA_POSIXConnectionManager *pcm, UDP_FD *conn) {
                         UA_CONNECTIONSTATE_CLOSING,
                         &UA_KEYVALUEMAP_NULL, UA_BYTESTRING_NULL);
 
+    /* Drop queued datagrams that were not sent out */
+    for(size_t i = 0; i < conn->txQueueSize; i++)
+        UA_EventLoopPOSIX_freeNetworkBuffer(&pcm->cm, (uintptr_t)conn->rfd.fd,
+                                            &conn->txQueue[i]);
+
     /* Close the socket */
     UA_RESET_ERRNO;
     int ret = UA_close(conn->rfd.fd);
@@ -654,6 +673,101 @@ UDP_delayedClose(void *application, void *context) {
     UA_UNLOCK(&el->elMutex);
 }
 
+/* Forward a received datagram to the application */
+static void
+UDP_deliver(UA_POSIXConnectionManager *pcm, UDP_FD *conn,
+            struct sockaddr_storage *source, UA_ByteString msg) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
+
+    /* Extract message source and port */
+    char sourceAddr[64];
+    UA_UInt16 sourcePort;
+    switch(source->ss_family) {
+        case AF_INET:
+            UA_inet_ntop(AF_INET, &((struct sockaddr_in *)source)->sin_addr,
+                    sourceAddr, 64);
+            sourcePort = htons(((struct sockaddr_in *)source)->sin_port);
+            break;
+        case AF_INET6:
+            UA_inet_ntop(AF_INET6, &(((struct sockaddr_in6 *)source)->sin6_addr),
+                    sourceAddr, 64);
+            sourcePort = htons(((struct sockaddr_in6 *)source)->sin6_port);
+            break;
+        default:
+            sourceAddr[0] = 0;
+            sourcePort = 0;
+    }
+
+    UA_String sourceAddrStr = UA_STRING(sourceAddr);
+    UA_KeyValuePair kvp[2];
+    kvp[0].key = UA_QUALIFIEDNAME(0, "remote-address");
+    UA_Variant_setScalar(&kvp[0].value, &sourceAddrStr, &UA_TYPES[UA_TYPES_STRING]);
+    kvp[1].key = UA_QUALIFIEDNAME(0, "remote-port");
+    UA_Variant_setScalar(&kvp[1].value, &sourcePort, &UA_TYPES[UA_TYPES_UINT16]);
+    UA_KeyValueMap kvm = {2, kvp};
+
+    UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                 "UDP %u\t| Received message of size %u from %s on port %u",
+                 (unsigned)conn->rfd.fd, (unsigned)msg.length,
+                 sourceAddr, sourcePort);
+
+    /* Callback to the application layer */
+    conn->applicationCB(&pcm->cm, (uintptr_t)conn->rfd.fd,
+                        conn->application, &conn->context,
+                        UA_CONNECTIONSTATE_ESTABLISHED,
+                        &kvm, msg);
+}
+
+#ifdef UDP_HAVE_MMSG
+/* Receive up to recvBatchSize datagrams with a single syscall. Each datagram
+ * is received into its own slot of the rxBuffer. */
+static void
+UDP_receiveBatch(UA_POSIXUDPConnectionManager *ucm, UDP_FD *conn) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)ucm->pcm.cm.eventSource.eventLoop;
+
+    struct mmsghdr msgs[UDP_MAXBATCH];
+    struct iovec iovs[UDP_MAXBATCH];
+    struct sockaddr_storage sources[UDP_MAXBATCH];
+    memset(msgs, 0, sizeof(struct mmsghdr) * ucm->recvBatchSize);
+    for(size_t i = 0; i < ucm->recvBatchSize; i++) {
+        iovs[i].iov_base = ucm->pcm.rxBuffer.data + (i * ucm->recvSlotSize);
+        iovs[i].iov_len = ucm->recvSlotSize;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &sources[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+    }
+
+    UA_RESET_ERRNO;
+    int ret = recvmmsg(conn->rfd.fd, msgs, (unsigned)ucm->recvBatchSize,
+                       MSG_DONTWAIT, NULL);
+    if(ret <= 0) {
+        if(UA_ERRNO == UA_INTERRUPTED || UA_ERRNO == UA_AGAIN ||
+           UA_ERRNO == UA_WOULDBLOCK)
+            return;
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                        "UDP %u\t| recv signaled the socket was shutdown (%s)",
+                        (unsigned)conn->rfd.fd, errno_str));
+        UDP_close(&ucm->pcm, conn);
+        return;
+    }
+
+    ucm->recvCalls++;
+    ucm->recvDatagrams += (size_t)ret;
+
+    for(int i = 0; i < ret; i++) {
+        /* Stop if the connection was closed from the callback */
+        if(conn->rfd.dc.callback)
+            break;
+        if(msgs[i].msg_len == 0)
+            continue;
+        UA_ByteString msg = {msgs[i].msg_len, (UA_Byte*)iovs[i].iov_base};
+        UDP_deliver(&ucm->pcm, conn, &sources[i], msg);
+    }
+}
+#endif
+
 /* Gets called when a socket receives data or closes */
 static void
 UDP_connectionSocketCallback(UA_POSIXConnectionManager *pcm, UDP_FD *conn,
@@ -674,6 +788,14 @@ UDP_connectionSocketCallback(UA_POSIXConnectionManager *pcm, UDP_FD *conn,
         return;
     }
 
+#ifdef UDP_HAVE_MMSG
+    UA_POSIXUDPConnectionManager *ucm = (UA_POSIXUDPConnectionManager*)pcm;
+    if(ucm->recvBatchSize > 1) {
+        UDP_receiveBatch(ucm, conn);
+        return;
+    }
+#endif
+
     UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
                  "UDP %u\t| Allocate receive buffer", (unsigned)conn->rfd.fd);
 
@@ -710,44 +832,9 @@ UDP_connectionSocketCallback(UA_POSIXConnectionManager *pcm, UDP_FD *conn,
     }
 
     response.length = (size_t)ret; /* Set the length of the received buffer */
-
-    /* Extract message source and port */
-    char sourceAddr[64];
-    UA_UInt16 sourcePort;
-    switch(source.ss_family) {
-        case AF_INET:
-            UA_inet_ntop(AF_INET, &((struct sockaddr_in *)&source)->sin_addr,
-                    sourceAddr, 64);
-            sourcePort = htons(((struct sockaddr_in *)&source)->sin_port);
-            break;
-        case AF_INET6:
-            UA_inet_ntop(AF_INET6, &(((struct sockaddr_in6 *)&source)->sin6_addr),
-                    sourceAddr, 64);
-            sourcePort = htons(((struct sockaddr_in6 *)&source)->sin6_port);
-            break;
-        default:
-            sourceAddr[0] = 0;
-            sourcePort = 0;
-    }
-
-    UA_String sourceAddrStr = UA_STRING(sourceAddr);
-    UA_KeyValuePair kvp[2];
-    kvp[0].key = UA_QUALIFIEDNAME(0, "remote-address");
-    UA_Variant_setScalar(&kvp[0].value, &sourceAddrStr, &UA_TYPES[UA_TYPES_STRING]);
-    kvp[1].key = UA_QUALIFIEDNAME(0, "remote-port");
-    UA_Variant_setScalar(&kvp[1].value, &sourcePort, &UA_TYPES[UA_TYPES_UINT16]);
-    UA_KeyValueMap kvm = {2, kvp};
-
-    UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
-                 "UDP %u\t| Received message of size %u from %s on port %u",
-                 (unsigned)conn->rfd.fd, (unsigned)ret,
-                 sourceAddr, sourcePort);
-
-    /* Callback to the application layer */
-    conn->applicationCB(&pcm->cm, (uintptr_t)conn->rfd.fd,
-                        conn->application, &conn->context,
-                        UA_CONNECTIONSTATE_ESTABLISHED,
-                        &kvm, response);
+    ((UA_POSIXUDPConnectionManager*)pcm)->recvCalls++;
+    ((UA_POSIXUDPConnectionManager*)pcm)->recvDatagrams++;
+    UDP_deliver(pcm, conn, &source, response);
 }
 
 static UA_StatusCode
@@ -1026,84 +1113,175 @@ UDP_shutdownConnection(UA_ConnectionManager *cm, uintptr_t connectionId) {
     return UA_STATUSCODE_GOOD;
 }
 
+/* Send out all queued datagrams. With sendmmsg this takes a single syscall
+ * unless the socket buffer runs full. */
+static UA_StatusCode
+UDP_flushQueue(UA_POSIXUDPConnectionManager *ucm, UDP_FD *conn) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)ucm->pcm.cm.eventSource.eventLoop;
+    UA_LOCK_ASSERT(&el->elMutex);
+
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    UA_FD fd = conn->rfd.fd;
+    size_t sent = 0;
+    while(sent < conn->txQueueSize) {
+        UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                     "UDP %u\t| Attempting to send %u datagrams", (unsigned)fd,
+                     (unsigned)(conn->txQueueSize - sent));
+
+        /* Prevent OS signals when sending to a closed socket */
+        UA_RESET_ERRNO;
+#ifdef UDP_HAVE_MMSG
+        struct mmsghdr msgs[UDP_MAXBATCH];
+        struct iovec iovs[UDP_MAXBATCH];
+        size_t n = conn->txQueueSize - sent;
+        memset(msgs, 0, sizeof(struct mmsghdr) * n);
+        for(size_t i = 0; i < n; i++) {
+            iovs[i].iov_base = conn->txQueue[sent + i].data;
+            iovs[i].iov_len = conn->txQueue[sent + i].length;
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &conn->sendAddr;
+            msgs[i].msg_hdr.msg_namelen = conn->sendAddrLength;
+        }
+        int ret = sendmmsg(fd, msgs, (unsigned)n, MSG_NOSIGNAL);
+        if(ret > 0) {
+            ucm->sendCalls++;
+            ucm->sendDatagrams += (size_t)ret;
+            sent += (size_t)ret;
+            continue;
+        }
+#else
+        UA_ByteString *buf = &conn->txQueue[sent];
+        ssize_t ret = UA_sendto(fd, (const char*)buf->data, buf->length,
+                                MSG_NOSIGNAL, (struct sockaddr*)&conn->sendAddr,
+                                conn->sendAddrLength);
+        if(ret >= 0) {
+            ucm->sendCalls++;
+            ucm->sendDatagrams++;
+            sent++;
+            continue;
+        }
+#endif
+
+        /* An error we cannot recover from? */
+        if(UA_ERRNO != UA_INTERRUPTED &&
+           UA_ERRNO != UA_WOULDBLOCK &&
+           UA_ERRNO != UA_AGAIN) {
+            UA_LOG_SOCKET_ERRNO_WRAP(
+               UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                            "UDP %u\t| Send failed with error %s",
+                            (unsigned)fd, errno_str));
+            UDP_shutdown(&ucm->pcm.cm, &conn->rfd);
+            res = UA_STATUSCODE_BADCONNECTIONCLOSED;
+            break;
+        }
+
+        /* Poll for the socket resources to become available and retry
+         * (blocking) */
+        int poll_ret;
+        struct pollfd tmp_poll_fd;
+        tmp_poll_fd.fd = fd;
+        tmp_poll_fd.events = UA_POLLOUT;
+        do {
+            UA_RESET_ERRNO;
+            poll_ret = UA_poll(&tmp_poll_fd, 1, 100);
+            if(poll_ret < 0 && UA_ERRNO != UA_INTERRUPTED) {
+                UA_LOG_SOCKET_ERRNO_WRAP(
+                   UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                                "UDP %u\t| Send failed with error %s",
+                                (unsigned)fd, errno_str));
+                UDP_shutdown(&ucm->pcm.cm, &conn->rfd);
+                res = UA_STATUSCODE_BADCONNECTIONCLOSED;
+                goto cleanup;
+            }
+        } while(poll_ret <= 0);
+    }
+
+ cleanup:
+    for(size_t i = 0; i < conn->txQueueSize; i++)
+        UA_EventLoopPOSIX_freeNetworkBuffer(&ucm->pcm.cm, (uintptr_t)fd,
+                                            &conn->txQueue[i]);
+    conn->txQueueSize = 0;
+    return res;
+}
+
+static void *
+UDP_flushCB(void *application, UA_RegisteredFD *rfd) {
+    UDP_FD *conn = (UDP_FD*)rfd;
+    if(conn->txQueueSize > 0 && !rfd->dc.callback)
+        UDP_flushQueue((UA_POSIXUDPConnectionManager*)application, conn);
+    return NULL;
+}
+
+/* Send datagrams that are still queued in the next EventLoop iteration. In
+ * case the application never sends without the "more" parameter. */
+static void
+UDP_delayedFlush(void *application, void *context) {
+    UA_POSIXUDPConnectionManager *ucm = (UA_POSIXUDPConnectionManager*)application;
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)ucm->pcm.cm.eventSource.eventLoop;
+    (void)el;
+    UA_LOCK(&el->elMutex);
+    ucm->flushPending = false;
+    ZIP_ITER(UA_FDTree, &ucm->pcm.fds, UDP_flushCB, ucm);
+    UA_UNLOCK(&el->elMutex);
+}
+
 static UA_StatusCode
 UDP_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
                        const UA_KeyValueMap *params,
                        UA_ByteString *buf) {
-    UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)cm;
+    UA_POSIXUDPConnectionManager *ucm = (UA_POSIXUDPConnectionManager*)cm;
     UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
 
     UA_LOCK(&el->elMutex);
 
     /* Look up the registered UDP socket */
     UA_FD fd = (UA_FD)connectionId;
-    UDP_FD *conn = (UDP_FD*)ZIP_FIND(UA_FDTree, &pcm->fds, &fd);
+    UDP_FD *conn = (UDP_FD*)ZIP_FIND(UA_FDTree, &ucm->pcm.fds, &fd);
     if(!conn) {
         UA_UNLOCK(&el->elMutex);
         UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
-    /* Send the full buffer. This may require several calls to send */
-    size_t nWritten = 0;
-    do {
-        ssize_t n = 0;
-        do {
-            UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
-                         "UDP %u\t| Attempting to send", (unsigned)connectionId);
+    /* More datagrams follow? Then queue and send them together. The static
+     * send buffer cannot be queued as it is reused for the next message. */
+    const UA_Boolean *more = (const UA_Boolean*)
+        UA_KeyValueMap_getScalar(params, UA_QUALIFIEDNAME(0, "more"),
+                                 &UA_TYPES[UA_TYPES_BOOLEAN]);
+    UA_Boolean queue = (more && *more && buf->data != ucm->pcm.txBuffer.data);
 
-            /* Prevent OS signals when sending to a closed socket */
-            UA_RESET_ERRNO;
-            int flags = MSG_NOSIGNAL;
-            size_t bytes_to_send = buf->length - nWritten;
-            n = UA_sendto((UA_FD)connectionId, (const char*)buf->data + nWritten,
-                          bytes_to_send, flags, (struct sockaddr*)&conn->sendAddr,
-                          conn->sendAddrLength);
-            if(n < 0) {
-                /* An error we cannot recover from? */
-                if(UA_ERRNO != UA_INTERRUPTED &&
-                   UA_ERRNO != UA_WOULDBLOCK &&
-                   UA_ERRNO != UA_AGAIN) {
-                    UA_LOG_SOCKET_ERRNO_WRAP(
-                       UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
-                                    "UDP %u\t| Send failed with error %s",
-                                    (unsigned)connectionId, errno_str));
-                    UA_UNLOCK(&el->elMutex);
-                    UDP_shutdownConnection(cm, connectionId);
-                    UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
-                    return UA_STATUSCODE_BADCONNECTIONCLOSED;
-                }
-
-                /* Poll for the socket resources to become available and retry
-                 * (blocking) */
-                int poll_ret;
-                struct pollfd tmp_poll_fd;
-                tmp_poll_fd.fd = (UA_FD)connectionId;
-                tmp_poll_fd.events = UA_POLLOUT;
-                do {
-                    UA_RESET_ERRNO;
-                    poll_ret = UA_poll(&tmp_poll_fd, 1, 100);
-                    if(poll_ret < 0 && UA_ERRNO != UA_INTERRUPTED) {
-                        UA_LOG_SOCKET_ERRNO_WRAP(
-                           UA_LOG_ERROR(el->eventLoop.logger,
-                                        UA_LOGCATEGORY_NETWORK,
-                                        "UDP %u\t| Send failed with error %s",
-                                        (unsigned)connectionId, errno_str));
-                        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
-                        UDP_shutdown(cm, &conn->rfd);
-                        UA_UNLOCK(&el->elMutex);
-                        return UA_STATUSCODE_BADCONNECTIONCLOSED;
-                    }
-                } while(poll_ret <= 0);
-            }
-        } while(n < 0);
-        nWritten += (size_t)n;
-    } while(nWritten < buf->length);
+    /* Make room in the queue */
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    if(conn->txQueueSize == UDP_MAXBATCH) {
+        res = UDP_flushQueue(ucm, conn);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_UNLOCK(&el->elMutex);
+            UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+            return res;
+        }
+    }
+
+    /* Take ownership of the buffer */
+    conn->txQueue[conn->txQueueSize] = *buf;
+    conn->txQueueSize++;
+    UA_ByteString_init(buf);
+
+    if(queue) {
+        if(!ucm->flushPending) {
+            ucm->flushPending = true;
+            ucm->flushCallback.callback = UDP_delayedFlush;
+            ucm->flushCallback.application = ucm;
+            ucm->flushCallback.context = NULL;
+            UA_EventLoopPOSIX_addDelayedCallback((UA_EventLoop*)el,
+                                                 &ucm->flushCallback);
+        }
+    } else {
+        res = UDP_flushQueue(ucm, conn);
+    }
 
-    /* Free the buffer */
     UA_UNLOCK(&el->elMutex);
-    UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
-    return UA_STATUSCODE_GOOD;
+    return res;
 }
 
 static UA_StatusCode
@@ -1378,6 +1556,31 @@ UDP_eventSourceStart(UA_ConnectionManager *cm) {
     if(res != UA_STATUSCODE_GOOD)
         goto finish;
 
+#ifdef UDP_HAVE_MMSG
+    /* Split the rx buffer into slots for batched receiving. Each slot can
+     * hold the largest possible datagram. */
+    UA_POSIXUDPConnectionManager *ucm = (UA_POSIXUDPConnectionManager*)cm;
+    ucm->recvBatchSize = UDP_DEFAULTRECVBATCH;
+    const UA_UInt32 *batchSize = (const UA_UInt32*)
+        UA_KeyValueMap_getScalar(&cm->eventSource.params,
+                                 UA_QUALIFIEDNAME(0, "recv-batchsize"),
+                                 &UA_TYPES[UA_TYPES_UINT32]);
+    if(batchSize)
+        ucm->recvBatchSize = *batchSize;
+    if(ucm->recvBatchSize > UDP_MAXBATCH)
+        ucm->recvBatchSize = UDP_MAXBATCH;
+    if(ucm->recvBatchSize > 1) {
+        ucm->recvSlotSize = pcm->rxBuffer.length;
+        if(ucm->recvSlotSize > UDP_MAXDATAGRAMSIZE)
+            ucm->recvSlotSize = UDP_MAXDATAGRAMSIZE;
+        UA_ByteString_clear(&pcm->rxBuffer);
+        res = UA_ByteString_allocBuffer(&pcm->rxBuffer,
+                                        ucm->recvSlotSize * ucm->recvBatchSize);
+        if(res != UA_STATUSCODE_GOOD)
+            goto finish;
+    }
+#endif
+
     /* Set the EventSource to the started state */
     cm->eventSource.state = UA_EVENTSOURCESTATE_STARTED;
 
@@ -1425,6 +1628,14 @@ UDP_eventSourceDelete(UA_ConnectionManager *cm) {
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
+    /* Remove the pending flush before the ConnectionManager is freed */
+    UA_POSIXUDPConnectionManager *ucm = (UA_POSIXUDPConnectionManager*)cm;
+    if(ucm->flushPending) {
+        UA_EventLoop *el = cm->eventSource.eventLoop;
+        el->removeDelayedCallback(el, &ucm->flushCallback);
+        ucm->flushPending = false;
+    }
+
     UA_ByteString_clear(&pcm->rxBuffer);
     UA_ByteString_clear(&pcm->txBuffer);
     UA_KeyValueMap_clear(&cm->eventSource.params);
@@ -1439,7 +1650,7 @@ static const char *udpName = "udp";
 UA_ConnectionManager *
 UA_ConnectionManager_new_POSIX_UDP(const UA_String eventSourceName) {
     UA_POSIXConnectionManager *cm = (UA_POSIXConnectionManager*)
-        UA_calloc(1, sizeof(UA_POSIXConnectionManager));
+        UA_calloc(1, sizeof(UA_POSIXUDPConnectionManager));
     if(!cm)
         return NULL;
 
@@ -0,0 +1,1147 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "eventloop_posix.h"
+
+#if defined(UA_HAVE_IO_URING)
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+/* By default, fds are watched with one-shot IORING_OP_POLL_ADD requests. They
+ * are re-armed after the event was dispatched. This keeps the level-triggered
+ * semantics of epoll that the ConnectionManagers rely on.
+ *
+ * If the kernel supports it and the EventSource has set the respective
+ * callback, listen sockets use a multishot accept and connection sockets a
+ * multishot receive into a ring of provided buffers. Then a single request
+ * delivers all further connections (or received messages) without more
+ * syscalls.
+ *
+ * Sends are collected per fd and submitted as a single IORING_OP_SENDMSG. The
+ * next sendmsg for the same fd is submitted once the previous one has
+ * completed. This keeps the order within the stream.
+ *
+ * The re-arming, all registration changes and the queued sends are submitted
+ * with the same io_uring_enter syscall that waits for the next completions. */
+
+#define UA_URING_ENTRIES 256
+
+/* Provided buffers for the multishot receive. The count is a power of two. */
+#define UA_URING_BUFGROUP 0
+#define UA_URING_BUFCOUNT 128
+#define UA_URING_BUFSIZE 16384
+
+/* The lowest two bits of the user_data contain the request type. For sends
+ * the user_data is the pointer to the UA_IOUringSend. Otherwise it is the fd
+ * (shifted by two bits) and the slot generation in the upper 32bit. Slots
+ * never use the generation zero. That is left for the special values. */
+#define UA_URING_OP_POLL 0
+#define UA_URING_OP_ACCEPT 1
+#define UA_URING_OP_RECV 2
+#define UA_URING_OP_SEND 3
+#define UA_URING_OPMASK 3
+
+#define UA_URING_SELFPIPE ((UA_UInt64)0)
+#define UA_URING_IGNORE ((UA_UInt64)4)
+
+/* The sends for a closed connection go out for at most this long. Then the
+ * connection is aborted, e.g. if the peer no longer reads. */
+#define UA_URING_LINGER (5 * UA_DATETIME_SEC)
+
+/* The fd has to fit into the user_data */
+#define UA_URING_MAXFD (1 << 30)
+
+static int
+uringSetup(unsigned entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int
+uringEnter(int fd, unsigned toSubmit, unsigned minComplete,
+           unsigned flags, void *arg, size_t argSize) {
+    return (int)syscall(__NR_io_uring_enter, fd, toSubmit, minComplete,
+                        flags, arg, argSize);
+}
+
+#ifdef UA_HAVE_IO_URING_MULTISHOT
+static int
+uringRegister(int fd, unsigned opcode, void *arg, unsigned nrArgs) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs);
+}
+#endif
+
+static UA_UInt64
+slotUserData(UA_FD fd, UA_UInt32 gen, UA_Byte op) {
+    return (UA_UInt64)((UA_UInt32)fd << 2) | op | ((UA_UInt64)gen << 32);
+}
+
+static UA_UInt64
+sendUserData(UA_IOUringSend *s) {
+    return (UA_UInt64)(uintptr_t)s | UA_URING_OP_SEND;
+}
+
+static UA_UInt32
+nextGen(UA_IOUring *ring) {
+    if(++ring->gen == 0)
+        ring->gen = 1;
+    return ring->gen;
+}
+
+/* Publish the queued SQEs to the kernel. Returns the number of SQEs that are
+ * not yet submitted. */
+static unsigned
+uringPublish(UA_IOUring *ring) {
+    __atomic_store_n(ring->sqTail, ring->sqLocalTail, __ATOMIC_RELEASE);
+    return ring->sqLocalTail - __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+}
+
+/* Submit the queued SQEs without waiting for completions */
+static int
+uringSubmit(UA_IOUring *ring) {
+    unsigned toSubmit = uringPublish(ring);
+    if(toSubmit == 0)
+        return 0;
+    return uringEnter(ring->fd, toSubmit, 0, 0, NULL, 0);
+}
+
+static struct io_uring_sqe *
+uringGetSQE(UA_IOUring *ring) {
+    unsigned head = __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+    if(ring->sqLocalTail - head >= ring->sqEntries) {
+        /* The SQ is full. Flush without waiting. */
+        uringSubmit(ring);
+        head = __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+        if(ring->sqLocalTail - head >= ring->sqEntries)
+            return NULL;
+    }
+    struct io_uring_sqe *sqe = &ring->sqes[ring->sqLocalTail & ring->sqMask];
+    ring->sqLocalTail++;
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    return sqe;
+}
+
+/* Queued requests are submitted with the next wait. If the EventLoop currently
+ * waits (in a different thread), submit them right away. The completions are
+ * then processed in the context of the thread that runs the EventLoop. */
+static void
+uringKick(UA_IOUring *ring) {
+    if(ring->waiting)
+        uringSubmit(ring);
+}
+
+static UA_StatusCode
+uringPollAdd(UA_IOUring *ring, UA_FD fd, short events, UA_UInt64 userData,
+             UA_Byte sqeFlags) {
+    struct io_uring_sqe *sqe = uringGetSQE(ring);
+    if(!sqe)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->flags = sqeFlags;
+    sqe->poll32_events = (UA_UInt32)(UA_UInt16)events;
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    /* The kernel swaps the half-words on big-endian machines */
+    sqe->poll32_events = (sqe->poll32_events << 16) | (sqe->poll32_events >> 16);
+#endif
+    sqe->user_data = userData;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+uringCancel(UA_IOUring *ring, UA_UInt64 target) {
+    struct io_uring_sqe *sqe = uringGetSQE(ring);
+    if(!sqe)
+        return; /* The late completion is ignored due to the generation */
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = target;
+    sqe->user_data = UA_URING_IGNORE;
+}
+
+static UA_StatusCode
+uringArmSelfpipe(UA_EventLoopPOSIX *el) {
+    UA_IOUring *ring = &el->uring;
+    UA_StatusCode res = uringPollAdd(ring, el->selfpipe[0], POLLIN,
+                                     UA_URING_SELFPIPE, 0);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                       "Eventloop\t| Could not arm the self-pipe in the io_uring, "
+                       "retrying before the next wait");
+        return res;
+    }
+    ring->selfpipeArmed = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* The request type that watches the rfd */
+static UA_Byte
+uringOp(UA_IOUring *ring, UA_RegisteredFD *rfd) {
+#ifdef UA_HAVE_IO_URING_MULTISHOT
+    if(ring->multishot && rfd->listenEvents == UA_FDEVENT_IN) {
+        if(rfd->acceptCB)
+            return UA_URING_OP_ACCEPT;
+        if(rfd->recvCB)
+            return UA_URING_OP_RECV;
+    }
+#else
+    (void)ring;
+    (void)rfd;
+#endif
+    return UA_URING_OP_POLL;
+}
+
+static UA_StatusCode
+uringArm(UA_IOUring *ring, UA_RegisteredFD *rfd) {
+    UA_IOUringSlot *slot = &ring->slots[rfd->fd];
+    UA_Byte op = uringOp(ring, rfd);
+    UA_UInt64 userData = slotUserData(rfd->fd, slot->gen, op);
+
+    if(op == UA_URING_OP_POLL) {
+        short events = 0;
+        if(rfd->listenEvents & UA_FDEVENT_IN)
+            events |= POLLIN;
+        if(rfd->listenEvents & UA_FDEVENT_OUT)
+            events |= POLLOUT;
+        UA_StatusCode res = uringPollAdd(ring, rfd->fd, events, userData, 0);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    } else {
+#ifdef UA_HAVE_IO_URING_MULTISHOT
+        struct io_uring_sqe *sqe = uringGetSQE(ring);
+        if(!sqe)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        sqe->fd = rfd->fd;
+        sqe->user_data = userData;
+        if(op == UA_URING_OP_ACCEPT) {
+            sqe->opcode = IORING_OP_ACCEPT;
+            sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        } else {
+            sqe->opcode = IORING_OP_RECV;
+            sqe->ioprio = IORING_RECV_MULTISHOT;
+            sqe->flags = IOSQE_BUFFER_SELECT;
+            sqe->buf_group = UA_URING_BUFGROUP;
+        }
+#endif
+    }
+
+    slot->op = op;
+    slot->armed = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+/****************/
+/* Recv Buffers */
+/****************/
+
+#ifdef UA_HAVE_IO_URING_MULTISHOT
+
+static void
+uringRecycleBuffer(UA_IOUring *ring, UA_UInt16 bid) {
+    struct io_uring_buf *buf =
+        &ring->bufRing->bufs[ring->bufTail & (UA_URING_BUFCOUNT - 1)];
+    buf->addr = (UA_UInt64)(uintptr_t)&ring->bufs[(size_t)bid * UA_URING_BUFSIZE];
+    buf->len = UA_URING_BUFSIZE;
+    buf->bid = bid;
+    ring->bufTail++;
+    __atomic_store_n(&ring->bufRing->tail, ring->bufTail, __ATOMIC_RELEASE);
+}
+
+/* Register the ring of provided buffers. The multishot requests are not used
+ * if this fails. */
+static void
+uringSetupBuffers(UA_EventLoopPOSIX *el) {
+    UA_IOUring *ring = &el->uring;
+    size_t bufRingSize = UA_URING_BUFCOUNT * sizeof(struct io_uring_buf);
+    void *bufRing = mmap(NULL, bufRingSize, PROT_READ | PROT_WRITE,
+                         MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if(bufRing == MAP_FAILED)
+        return;
+    UA_Byte *bufs = (UA_Byte*)UA_malloc(UA_URING_BUFCOUNT * UA_URING_BUFSIZE);
+    if(!bufs) {
+        munmap(bufRing, bufRingSize);
+        return;
+    }
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(struct io_uring_buf_reg));
+    reg.ring_addr = (UA_UInt64)(uintptr_t)bufRing;
+    reg.ring_entries = UA_URING_BUFCOUNT;
+    reg.bgid = UA_URING_BUFGROUP;
+    if(uringRegister(ring->fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                     "Eventloop\t| The kernel does not support provided buffer "
+                     "rings, polling the sockets instead");
+        UA_free(bufs);
+        munmap(bufRing, bufRingSize);
+        return;
+    }
+
+    ring->bufRing = (struct io_uring_buf_ring*)bufRing;
+    ring->bufRingSize = bufRingSize;
+    ring->bufs = bufs;
+    for(UA_UInt16 i = 0; i < UA_URING_BUFCOUNT; i++)
+        uringRecycleBuffer(ring, i);
+    ring->multishot = true;
+}
+
+static void
+uringClearBuffers(UA_IOUring *ring) {
+    if(!ring->bufRing)
+        return;
+    /* Unregistering waits until the kernel no longer writes into the
+     * buffers */
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(struct io_uring_buf_reg));
+    reg.bgid = UA_URING_BUFGROUP;
+    uringRegister(ring->fd, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+    munmap(ring->bufRing, ring->bufRingSize);
+    UA_free(ring->bufs);
+    ring->bufRing = NULL;
+    ring->bufs = NULL;
+    ring->multishot = false;
+}
+
+#endif /* UA_HAVE_IO_URING_MULTISHOT */
+
+/*********/
+/* Sends */
+/*********/
+
+static void
+uringFreeSend(UA_IOUringSend *s) {
+    for(size_t i = 0; i < s->bufsSize; i++)
+        UA_ByteString_clear(&s->bufs[i]);
+    UA_free(s->bufs);
+    UA_free(s);
+}
+
+/* Free a detached send and those that are chained after it */
+static void
+uringFreeDetached(UA_IOUringSend *s) {
+    UA_FD fd = s->fd;
+    UA_Boolean ownsFd = s->ownsFd;
+    while(s) {
+        UA_IOUringSend *next = s->next;
+        uringFreeSend(s);
+        s = next;
+    }
+    if(ownsFd)
+        UA_close(fd);
+}
+
+/* Prepare the sendmsg for the remaining buffers */
+static UA_StatusCode
+uringSubmitSend(UA_IOUring *ring, UA_IOUringSend *s, UA_Boolean pollFirst) {
+    /* Wait until the socket becomes writable. The sendmsg is linked to the
+     * poll and runs only once the poll has completed. */
+    if(pollFirst) {
+        UA_StatusCode res = uringPollAdd(ring, s->fd, POLLOUT, UA_URING_IGNORE,
+                                         IOSQE_IO_LINK);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    }
+
+    struct io_uring_sqe *sqe = uringGetSQE(ring);
+    if(!sqe)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    size_t iovlen = 0;
+    for(size_t i = s->current; i < s->bufsSize && iovlen < UA_IOURING_MAXIOV; i++) {
+        size_t skip = (i == s->current) ? s->offset : 0;
+        s->iov[iovlen].iov_base = s->bufs[i].data + skip;
+        s->iov[iovlen].iov_len = s->bufs[i].length - skip;
+        iovlen++;
+    }
+    memset(&s->msg, 0, sizeof(struct msghdr));
+    s->msg.msg_iov = s->iov;
+    s->msg.msg_iovlen = iovlen;
+
+    int flags = MSG_NOSIGNAL;
+    if(s->more || s->current + iovlen < s->bufsSize)
+        flags |= MSG_MORE;
+
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = s->fd;
+    sqe->addr = (UA_UInt64)(uintptr_t)&s->msg;
+    sqe->len = 1;
+    sqe->msg_flags = (UA_UInt32)flags;
+    sqe->user_data = sendUserData(s);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Submit the collected sends of the fds without a pending sendmsg */
+static void
+uringFlushSends(UA_IOUring *ring) {
+    UA_IOUringSend *s, *s_tmp;
+    LIST_FOREACH_SAFE(s, &ring->pendingSends, pointers, s_tmp) {
+        UA_IOUringSlot *slot = &ring->slots[s->fd];
+        if(slot->sending)
+            continue; /* Wait until the previous sendmsg has completed */
+        if(uringSubmitSend(ring, s, false) != UA_STATUSCODE_GOOD)
+            return; /* The SQ is full, retry with the next flush */
+        LIST_REMOVE(s, pointers);
+        slot->queued = NULL;
+        slot->sending = s;
+    }
+}
+
+/* The sends for a deregistered fd still go out. They use a duplicate of the
+ * fd, as the EventSource closes the fd right after the deregistration. The
+ * socket is then closed once the last send has completed or when the linger
+ * time has run out. */
+static void
+uringDetachSends(UA_EventLoopPOSIX *el, UA_IOUringSlot *slot, UA_FD fd) {
+    UA_IOUring *ring = &el->uring;
+    UA_IOUringSend *first = (slot->sending) ? slot->sending : slot->queued;
+    if(!first)
+        return;
+    first->deadline = el->eventLoop.dateTime_nowMonotonic(&el->eventLoop) +
+        UA_URING_LINGER;
+    if(slot->queued) {
+        LIST_REMOVE(slot->queued, pointers);
+        if(slot->sending)
+            slot->sending->next = slot->queued;
+    }
+    slot->sending = NULL;
+    slot->queued = NULL;
+
+    /* Only submitted sends have the msghdr set up */
+    UA_Boolean submitted = (first->msg.msg_iov != NULL);
+
+    UA_FD dupfd = dup(fd);
+    if(dupfd < 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                          "Eventloop\t| Dropping the queued sends for fd %u (%s)",
+                          (unsigned)fd, errno_str));
+        if(first->next) {
+            uringFreeSend(first->next);
+            first->next = NULL;
+        }
+        if(!submitted) {
+            uringFreeSend(first);
+            return;
+        }
+        /* Freed when the cancelled sendmsg completes */
+        uringCancel(ring, sendUserData(first));
+        first->detached = true;
+        LIST_INSERT_HEAD(&ring->detachedSends, first, pointers);
+        return;
+    }
+
+    for(UA_IOUringSend *s = first; s; s = s->next) {
+        s->fd = dupfd;
+        s->detached = true;
+        s->ownsFd = true;
+    }
+    if(!submitted && uringSubmitSend(ring, first, false) != UA_STATUSCODE_GOOD) {
+        uringFreeDetached(first);
+        return;
+    }
+    LIST_INSERT_HEAD(&ring->detachedSends, first, pointers);
+}
+
+static void
+uringSendCompleted(UA_EventLoopPOSIX *el, UA_IOUringSend *s, int res) {
+    UA_IOUring *ring = &el->uring;
+    UA_IOUringSlot *slot = NULL;
+    if(!s->detached) {
+        UA_assert((size_t)s->fd < ring->slotsSize);
+        slot = &ring->slots[s->fd];
+        UA_assert(slot->sending == s);
+    }
+
+    /* Cancelled during shutdown of the EventLoop */
+    if(s->detached && (ring->stopping || !s->ownsFd)) {
+        LIST_REMOVE(s, pointers);
+        uringFreeDetached(s);
+        return;
+    }
+
+    /* The socket was not writable (if opened non-blocking), or the request
+     * was cancelled by the kernel. Retry. */
+    if(res == -EAGAIN || res == -EINTR || res == -ECANCELED) {
+        if(uringSubmitSend(ring, s, res == -EAGAIN) == UA_STATUSCODE_GOOD)
+            return;
+        res = -ENOMEM;
+    }
+
+    /* Advance over the sent bytes */
+    if(res >= 0) {
+        size_t written = (size_t)res;
+        while(s->current < s->bufsSize) {
+            size_t left = s->bufs[s->current].length - s->offset;
+            if(written < left) {
+                s->offset += written;
+                break;
+            }
+            written -= left;
+            s->current++;
+            s->offset = 0;
+        }
+
+        /* Send the remainder */
+        if(s->current < s->bufsSize) {
+            if(uringSubmitSend(ring, s, false) == UA_STATUSCODE_GOOD)
+                return;
+            res = -ENOMEM;
+        }
+    }
+
+    if(res < 0) {
+        errno = -res;
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                        "Eventloop\t| Send on fd %u failed with error %s",
+                        (unsigned)s->fd, errno_str));
+    }
+
+    /* Detached: continue with the next send in the chain or close the
+     * duplicate fd */
+    if(s->detached) {
+        LIST_REMOVE(s, pointers);
+        UA_IOUringSend *next = s->next;
+        s->next = NULL;
+        if(res < 0 || !next) {
+            s->next = next;
+            uringFreeDetached(s);
+            return;
+        }
+        s->ownsFd = false;
+        next->deadline = s->deadline;
+        uringFreeSend(s);
+        if(uringSubmitSend(ring, next, false) != UA_STATUSCODE_GOOD) {
+            uringFreeDetached(next);
+            return;
+        }
+        LIST_INSERT_HEAD(&ring->detachedSends, next, pointers);
+        return;
+    }
+
+    slot->sending = NULL;
+    uringFreeSend(s);
+
+    /* Shut down the socket. The EventSource detects this and closes the
+     * connection. Drop the sends that are queued behind. */
+    if(res < 0) {
+        UA_shutdown(slot->rfd->fd, UA_SHUT_RDWR);
+        if(slot->queued) {
+            LIST_REMOVE(slot->queued, pointers);
+            uringFreeSend(slot->queued);
+            slot->queued = NULL;
+        }
+    }
+
+    /* The queued sends are submitted with the next flush */
+}
+
+UA_StatusCode
+UA_EventLoopPOSIX_uringSend(UA_EventLoopPOSIX *el, UA_FD fd, UA_Boolean more,
+                            UA_ByteString *bufs, size_t bufsSize) {
+    UA_IOUring *ring = &el->uring;
+    UA_LOCK(&ring->ringMutex);
+
+    if(fd < 0 || (size_t)fd >= ring->slotsSize || !ring->slots[fd].rfd) {
+        UA_UNLOCK(&ring->ringMutex);
+        return UA_STATUSCODE_BADCONNECTIONCLOSED;
+    }
+
+    /* Append to the sends that are collected for the next sendmsg */
+    UA_IOUringSlot *slot = &ring->slots[fd];
+    UA_IOUringSend *s = slot->queued;
+    if(!s) {
+        s = (UA_IOUringSend*)UA_calloc(1, sizeof(UA_IOUringSend));
+        if(!s) {
+            UA_UNLOCK(&ring->ringMutex);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        s->fd = fd;
+    }
+    if(s->bufsSize + bufsSize > s->bufsCapacity) {
+        size_t newCapacity = (s->bufsCapacity > 0) ? s->bufsCapacity : 8;
+        while(newCapacity < s->bufsSize + bufsSize)
+            newCapacity *= 2;
+        UA_ByteString *newBufs = (UA_ByteString*)
+            UA_realloc(s->bufs, newCapacity * sizeof(UA_ByteString));
+        if(!newBufs) {
+            if(!slot->queued)
+                UA_free(s);
+            UA_UNLOCK(&ring->ringMutex);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        s->bufs = newBufs;
+        s->bufsCapacity = newCapacity;
+    }
+
+    /* Take ownership of the buffers */
+    for(size_t i = 0; i < bufsSize; i++) {
+        if(bufs[i].length == 0) {
+            UA_ByteString_clear(&bufs[i]);
+            continue;
+        }
+        s->bufs[s->bufsSize++] = bufs[i];
+        UA_ByteString_init(&bufs[i]);
+    }
+    s->more = more;
+
+    if(!slot->queued) {
+        if(s->bufsSize == 0) {
+            uringFreeSend(s);
+            UA_UNLOCK(&ring->ringMutex);
+            return UA_STATUSCODE_GOOD;
+        }
+        slot->queued = s;
+        LIST_INSERT_HEAD(&ring->pendingSends, s, pointers);
+    }
+
+    /* The EventLoop waits in io_uring_enter. Submit right away. */
+    if(ring->waiting) {
+        uringFlushSends(ring);
+        uringSubmit(ring);
+    }
+
+    UA_UNLOCK(&ring->ringMutex);
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_EventLoopPOSIX_uringShutdown(UA_EventLoopPOSIX *el, UA_FD fd) {
+    UA_IOUring *ring = &el->uring;
+    UA_LOCK(&ring->ringMutex);
+    UA_Boolean pending = false;
+    if(fd >= 0 && (size_t)fd < ring->slotsSize)
+        pending = (ring->slots[fd].sending || ring->slots[fd].queued);
+    if(pending && ring->waiting)
+        UA_EventLoopPOSIX_cancel(el);
+    UA_UNLOCK(&ring->ringMutex);
+    UA_shutdown(fd, (pending) ? SHUT_RD : UA_SHUT_RDWR);
+}
+
+/* Abort the detached sends whose linger time has run out. The shutdown lets
+ * the pending sendmsg fail. Then the duplicate fd is closed and the peer gets
+ * a reset instead of the remaining data. Returns the next deadline. */
+static UA_DateTime
+uringExpireSends(UA_EventLoopPOSIX *el, UA_DateTime now) {
+    UA_IOUring *ring = &el->uring;
+    UA_DateTime next = UA_INT64_MAX;
+    UA_IOUringSend *s;
+    LIST_FOREACH(s, &ring->detachedSends, pointers) {
+        if(!s->ownsFd || s->deadline == UA_INT64_MAX)
+            continue; /* Already cancelled */
+        if(s->deadline > now) {
+            if(s->deadline < next)
+                next = s->deadline;
+            continue;
+        }
+        UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                       "Eventloop\t| Aborting the connection on fd %u. The "
+                       "remaining data could not be sent.", (unsigned)s->fd);
+        struct linger l;
+        l.l_onoff = 1;
+        l.l_linger = 0;
+        setsockopt(s->fd, SOL_SOCKET, SO_LINGER, &l, sizeof(struct linger));
+        UA_shutdown(s->fd, UA_SHUT_RDWR);
+        uringCancel(ring, sendUserData(s));
+        s->deadline = UA_INT64_MAX;
+    }
+    return next;
+}
+
+/* Cancel the sends that are still pending for deregistered fds and wait for
+ * their completion. Afterwards the kernel no longer reads from the buffers. */
+static void
+uringDrainSends(UA_EventLoopPOSIX *el) {
+    UA_IOUring *ring = &el->uring;
+    if(LIST_EMPTY(&ring->detachedSends))
+        return;
+    ring->stopping = true;
+    UA_IOUringSend *s;
+    LIST_FOREACH(s, &ring->detachedSends, pointers)
+        uringCancel(ring, sendUserData(s));
+
+    for(size_t i = 0; i < 10 && !LIST_EMPTY(&ring->detachedSends); i++) {
+        struct __kernel_timespec ts;
+        ts.tv_sec = 0;
+        ts.tv_nsec = 100 * 1000 * 1000;
+        struct io_uring_getevents_arg arg;
+        memset(&arg, 0, sizeof(struct io_uring_getevents_arg));
+        arg.ts = (UA_UInt64)(uintptr_t)&ts;
+        uringEnter(ring->fd, uringPublish(ring), 1,
+                   IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                   &arg, sizeof(struct io_uring_getevents_arg));
+
+        unsigned head = *ring->cqHead;
+        unsigned tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+        for(; head != tail; head++) {
+            struct io_uring_cqe cqe = ring->cqes[head & ring->cqMask];
+            __atomic_store_n(ring->cqHead, head + 1, __ATOMIC_RELEASE);
+            if(cqe.user_data != UA_URING_IGNORE &&
+               (cqe.user_data & UA_URING_OPMASK) == UA_URING_OP_SEND)
+                uringSendCompleted(el, (UA_IOUringSend*)(uintptr_t)
+                                   (cqe.user_data & ~(UA_UInt64)UA_URING_OPMASK),
+                                   cqe.res);
+        }
+    }
+
+    /* Don't free the buffers the kernel might still read from */
+    if(!LIST_EMPTY(&ring->detachedSends))
+        UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                       "Eventloop\t| Sends are still pending in the io_uring "
+                       "after it was stopped");
+}
+
+/*****************/
+/* Start / Stop */
+/*****************/
+
+UA_StatusCode
+UA_EventLoopPOSIX_uringStart(UA_EventLoopPOSIX *el) {
+    UA_IOUring *ring = &el->uring;
+    memset(ring, 0, sizeof(UA_IOUring));
+    ring->fd = -1;
+    UA_LOCK_INIT(&ring->ringMutex);
+
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(struct io_uring_params));
+    ring->fd = uringSetup(UA_URING_ENTRIES, &p);
+    if(ring->fd < 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                          "Eventloop\t| Could not set up io_uring (%s)",
+                          errno_str));
+        goto error;
+    }
+
+    /* The timeout is passed as an extended argument */
+    if(!(p.features & IORING_FEAT_EXT_ARG)) {
+        UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                       "Eventloop\t| The kernel does not support io_uring "
+                       "wait timeouts");
+        goto error;
+    }
+
+    /* Map the rings */
+    ring->sqRingSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    ring->cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if(p.features & IORING_FEAT_SINGLE_MMAP) {
+        if(ring->cqRingSize > ring->sqRingSize)
+            ring->sqRingSize = ring->cqRingSize;
+        ring->cqRingSize = ring->sqRingSize;
+    }
+    ring->sqRing = mmap(NULL, ring->sqRingSize, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if(ring->sqRing == MAP_FAILED) {
+        ring->sqRing = NULL;
+        goto error;
+    }
+    if(p.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cqRing = ring->sqRing;
+    } else {
+        ring->cqRing = mmap(NULL, ring->cqRingSize, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if(ring->cqRing == MAP_FAILED) {
+            ring->cqRing = NULL;
+            goto error;
+        }
+    }
+    ring->sqesSize = p.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = (struct io_uring_sqe*)
+        mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if(ring->sqes == MAP_FAILED) {
+        ring->sqes = NULL;
+        goto error;
+    }
+
+    char *sq = (char*)ring->sqRing;
+    ring->sqHead = (unsigned*)(sq + p.sq_off.head);
+    ring->sqTail = (unsigned*)(sq + p.sq_off.tail);
+    ring->sqMask = *(unsigned*)(sq + p.sq_off.ring_mask);
+    ring->sqEntries = p.sq_entries;
+    ring->sqArray = (unsigned*)(sq + p.sq_off.array);
+    ring->sqLocalTail = *ring->sqTail;
+    char *cq = (char*)ring->cqRing;
+    ring->cqHead = (unsigned*)(cq + p.cq_off.head);
+    ring->cqTail = (unsigned*)(cq + p.cq_off.tail);
+    ring->cqMask = *(unsigned*)(cq + p.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+
+    /* SQE i is always at position i in the index array */
+    for(unsigned i = 0; i < p.sq_entries; i++)
+        ring->sqArray[i] = i;
+
+#ifdef UA_HAVE_IO_URING_MULTISHOT
+    uringSetupBuffers(el);
+#endif
+
+    /* Always listen on the self-pipe */
+    if(uringArmSelfpipe(el) != UA_STATUSCODE_GOOD)
+        goto error;
+
+    UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                 "Eventloop\t| Using io_uring with %u entries", p.sq_entries);
+    return UA_STATUSCODE_GOOD;
+
+ error:
+    UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                   "Eventloop\t| Could not initialize the io_uring");
+    UA_EventLoopPOSIX_uringStop(el);
+    return UA_STATUSCODE_BADNOTSUPPORTED;
+}
+
+void
+UA_EventLoopPOSIX_uringStop(UA_EventLoopPOSIX *el) {
+    UA_IOUring *ring = &el->uring;
+    if(ring->sqes)
+        uringDrainSends(el);
+#ifdef UA_HAVE_IO_URING_MULTISHOT
+    uringClearBuffers(ring);
+#endif
+    if(ring->sqes)
+        munmap(ring->sqes, ring->sqesSize);
+    if(ring->cqRing && ring->cqRing != ring->sqRing)
+        munmap(ring->cqRing, ring->cqRingSize);
+    if(ring->sqRing)
+        munmap(ring->sqRing, ring->sqRingSize);
+
+    /* Pending requests are cancelled when the ring is closed */
+    if(ring->fd >= 0)
+        close(ring->fd);
+
+    /* All fds should be deregistered. Free what is left over. */
+    for(size_t i = 0; i < ring->slotsSize; i++) {
+        if(ring->slots[i].sending)
+            uringFreeSend(ring->slots[i].sending);
+    }
+    UA_IOUringSend *s, *s_tmp;
+    LIST_FOREACH_SAFE(s, &ring->pendingSends, pointers, s_tmp) {
+        LIST_REMOVE(s, pointers);
+        uringFreeSend(s);
+    }
+    UA_free(ring->slots);
+
+    UA_LOCK_DESTROY(&ring->ringMutex);
+    memset(ring, 0, sizeof(UA_IOUring));
+    ring->fd = -1;
+}
+
+/****************/
+/* Registration */
+/****************/
+
+UA_StatusCode
+UA_EventLoopPOSIX_uringRegisterFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd) {
+    UA_IOUring *ring = &el->uring;
+    if(rfd->fd < 0 || rfd->fd >= UA_URING_MAXFD)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    UA_LOCK(&ring->ringMutex);
+
+    /* Grow the slots array */
+    size_t fd = (size_t)rfd->fd;
+    if(fd >= ring->slotsSize) {
+        size_t newSize = (ring->slotsSize > 0) ? ring->slotsSize : 64;
+        while(newSize <= fd)
+            newSize *= 2;
+        UA_IOUringSlot *slots = (UA_IOUringSlot*)
+            UA_realloc(ring->slots, newSize * sizeof(UA_IOUringSlot));
+        if(!slots) {
+            UA_UNLOCK(&ring->ringMutex);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        memset(&slots[ring->slotsSize], 0,
+               (newSize - ring->slotsSize) * sizeof(UA_IOUringSlot));
+        ring->slots = slots;
+        ring->slotsSize = newSize;
+    }
+
+    UA_IOUringSlot *slot = &ring->slots[fd];
+    UA_assert(!slot->rfd);
+    UA_assert(!slot->sending && !slot->queued);
+    slot->rfd = rfd;
+    slot->gen = nextGen(ring);
+    slot->armed = false;
+    UA_StatusCode res = uringArm(ring, rfd);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                       "Eventloop\t| Could not register fd %u for io_uring",
+                       (unsigned)rfd->fd);
+        slot->rfd = NULL;
+        UA_UNLOCK(&ring->ringMutex);
+        return res;
+    }
+    uringKick(ring);
+    UA_UNLOCK(&ring->ringMutex);
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_EventLoopPOSIX_uringModifyFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd) {
+    UA_IOUring *ring = &el->uring;
+    UA_LOCK(&ring->ringMutex);
+    UA_IOUringSlot *slot = &ring->slots[rfd->fd];
+    UA_assert(slot->rfd == rfd);
+
+    /* A multishot request continues unchanged. Switching away from a multishot
+     * receive would drop messages that are already received. */
+    UA_Byte op = uringOp(ring, rfd);
+    if(slot->armed && slot->op == op && op != UA_URING_OP_POLL) {
+        UA_UNLOCK(&ring->ringMutex);
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* Replace the pending request. Its completion is ignored because of the
+     * new generation. */
+    if(slot->armed)
+        uringCancel(ring, slotUserData(rfd->fd, slot->gen, slot->op));
+    slot->gen = nextGen(ring);
+    slot->armed = false;
+    UA_StatusCode res = uringArm(ring, rfd);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                       "Eventloop\t| Could not modify fd %u for io_uring",
+                       (unsigned)rfd->fd);
+        UA_UNLOCK(&ring->ringMutex);
+        return res;
+    }
+    uringKick(ring);
+    UA_UNLOCK(&ring->ringMutex);
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_EventLoopPOSIX_uringDeregisterFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd) {
+    UA_IOUring *ring = &el->uring;
+    UA_LOCK(&ring->ringMutex);
+    if(rfd->fd < 0 || (size_t)rfd->fd >= ring->slotsSize ||
+       ring->slots[rfd->fd].rfd != rfd) {
+        UA_UNLOCK(&ring->ringMutex);
+        return;
+    }
+
+    UA_IOUringSlot *slot = &ring->slots[rfd->fd];
+    if(slot->armed)
+        uringCancel(ring, slotUserData(rfd->fd, slot->gen, slot->op));
+    uringDetachSends(el, slot, rfd->fd);
+    slot->rfd = NULL;
+    slot->armed = false;
+    slot->gen = nextGen(ring);
+
+    /* Submit right away. The queued requests must reach the kernel before the
+     * fd is closed (and its number possibly reused). */
+    uringSubmit(ring);
+    UA_UNLOCK(&ring->ringMutex);
+}
+
+/***********/
+/* Polling */
+/***********/
+
+static void
+uringProcessCompletion(UA_EventLoopPOSIX *el, const struct io_uring_cqe *cqe) {
+    UA_IOUring *ring = &el->uring;
+    UA_UInt64 userData = cqe->user_data;
+    UA_Byte op = (UA_Byte)(userData & UA_URING_OPMASK);
+    UA_FD fd = (UA_FD)((UA_UInt32)userData >> 2);
+    UA_UInt32 gen = (UA_UInt32)(userData >> 32);
+    UA_IOUringSlot *slot = NULL;
+    UA_RegisteredFD *rfd = NULL;
+    short revent = 0;
+
+    UA_LOCK(&ring->ringMutex);
+
+#ifdef UA_HAVE_IO_URING_MULTISHOT
+    UA_ByteString msg = UA_BYTESTRING_NULL;
+
+    /* The kernel has received into a provided buffer. It is returned to the
+     * ring after processing. */
+    UA_Boolean hasBuf = ((cqe->flags & IORING_CQE_F_BUFFER) != 0);
+    UA_UInt16 bid = (UA_UInt16)(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+    if(hasBuf && cqe->res > 0) {
+        msg.data = &ring->bufs[(size_t)bid * UA_URING_BUFSIZE];
+        msg.length = (size_t)cqe->res;
+    }
+#endif
+
+    if(userData == UA_URING_IGNORE)
+        goto done;
+
+    /* The self-pipe has received */
+    if(userData == UA_URING_SELFPIPE) {
+        char buf[128];
+        while(read(el->selfpipe[0], buf, 128) > 0) {}
+        ring->selfpipeArmed = false;
+        uringArmSelfpipe(el);
+        goto done;
+    }
+
+    if(op == UA_URING_OP_SEND) {
+        uringSendCompleted(el, (UA_IOUringSend*)(uintptr_t)
+                           (userData & ~(UA_UInt64)UA_URING_OPMASK), cqe->res);
+        goto done;
+    }
+
+    /* Stale completion from an earlier registration */
+    if((size_t)fd >= ring->slotsSize)
+        goto stale;
+    slot = &ring->slots[fd];
+    if(slot->gen != gen || !slot->rfd)
+        goto stale;
+    rfd = slot->rfd;
+
+    /* Multishot requests continue while IORING_CQE_F_MORE is set */
+    if(!(cqe->flags & IORING_CQE_F_MORE))
+        slot->armed = false;
+
+    /* The request was cancelled by the kernel. For example when the thread
+     * that submitted it has exited. Re-arm from this thread. */
+    if(cqe->res == -ECANCELED)
+        goto rearm;
+
+    /* The multishot request ran out of provided buffers (they are returned
+     * after each completion) or is not supported by the kernel. Then fall
+     * back to polling. */
+    if(op != UA_URING_OP_POLL && (cqe->res == -ENOBUFS || cqe->res == -EINVAL)) {
+#ifdef UA_HAVE_IO_URING_MULTISHOT
+        if(cqe->res == -EINVAL && ring->multishot) {
+            UA_LOG_INFO(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                        "Eventloop\t| The kernel does not support multishot "
+                        "accept/recv, polling the sockets instead");
+            ring->multishot = false;
+        }
+#endif
+        goto rearm;
+    }
+
+    /* The rfd is already registered for removal. Don't process incoming
+     * events any longer. */
+    if(rfd->dc.callback) {
+        if(op == UA_URING_OP_ACCEPT && cqe->res >= 0)
+            UA_close((UA_FD)cqe->res);
+        goto done;
+    }
+
+    /* Call the EventSource callback without holding the ringMutex */
+    UA_UNLOCK(&ring->ringMutex);
+    switch(op) {
+#ifdef UA_HAVE_IO_URING_MULTISHOT
+    case UA_URING_OP_ACCEPT:
+        if(cqe->res >= 0) {
+            rfd->acceptCB(rfd->es, rfd, (UA_FD)cqe->res);
+        } else if(!UA_IS_TEMPORARY_ACCEPT_ERROR(-cqe->res)) {
+            errno = -cqe->res;
+            rfd->acceptCB(rfd->es, rfd, UA_INVALID_FD);
+        }
+        break;
+    case UA_URING_OP_RECV:
+        if(cqe->res >= 0)
+            rfd->recvCB(rfd->es, rfd, msg); /* Empty if the remote shut down */
+        else
+            rfd->eventSourceCB(rfd->es, rfd, UA_FDEVENT_ERR);
+        break;
+#endif
+    default:
+        if(cqe->res < 0)
+            revent = UA_FDEVENT_ERR;
+        else if(cqe->res & POLLIN)
+            revent = UA_FDEVENT_IN;
+        else if(cqe->res & POLLOUT)
+            revent = UA_FDEVENT_OUT;
+        else
+            revent = UA_FDEVENT_ERR;
+        rfd->eventSourceCB(rfd->es, rfd, revent);
+        break;
+    }
+    UA_LOCK(&ring->ringMutex);
+
+    /* The slots array can be reallocated in the callback */
+    slot = &ring->slots[fd];
+
+ rearm:
+    /* Re-arm if the rfd is still registered (and was not modified) */
+    if(slot->gen == gen && slot->rfd == rfd && !slot->armed && !rfd->dc.callback)
+        uringArm(ring, rfd);
+    goto done;
+
+ stale:
+    /* Close connections accepted for a listen socket that is gone */
+    if(op == UA_URING_OP_ACCEPT && cqe->res >= 0)
+        UA_close((UA_FD)cqe->res);
+
+ done:
+#ifdef UA_HAVE_IO_URING_MULTISHOT
+    if(hasBuf)
+        uringRecycleBuffer(ring, bid);
+#endif
+    UA_UNLOCK(&ring->ringMutex);
+}
+
+UA_StatusCode
+UA_EventLoopPOSIX_uringPollFDs(UA_EventLoopPOSIX *el, UA_DateTime listenTimeout) {
+    UA_assert(listenTimeout >= 0);
+    UA_IOUring *ring = &el->uring;
+
+    /* Queue the sends and publish all queued requests to the kernel. They are
+     * submitted with the wait for the next completions. Wake up in time to
+     * abort the detached sends that linger too long. */
+    UA_LOCK(&ring->ringMutex);
+    if(!ring->selfpipeArmed)
+        uringArmSelfpipe(el);
+    if(!LIST_EMPTY(&ring->detachedSends)) {
+        UA_DateTime now = el->eventLoop.dateTime_nowMonotonic(&el->eventLoop);
+        UA_DateTime next = uringExpireSends(el, now);
+        if(next - now < listenTimeout)
+            listenTimeout = next - now;
+    }
+    uringFlushSends(ring);
+    unsigned toSubmit = uringPublish(ring);
+    ring->waiting = true;
+    UA_UNLOCK(&ring->ringMutex);
+
+    /* io_uring takes a nanosecond timeout */
+    struct __kernel_timespec ts;
+    ts.tv_sec = listenTimeout / UA_DATETIME_SEC;
+    ts.tv_nsec = (listenTimeout % UA_DATETIME_SEC) * 100;
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(struct io_uring_getevents_arg));
+    arg.ts = (UA_UInt64)(uintptr_t)&ts;
+
+    unsigned minComplete = (listenTimeout > 0) ? 1 : 0;
+    UA_UNLOCK(&el->elMutex);
+    int res = uringEnter(ring->fd, toSubmit, minComplete,
+                         IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                         &arg, sizeof(struct io_uring_getevents_arg));
+    UA_LOCK(&el->elMutex);
+
+    UA_LOCK(&ring->ringMutex);
+    ring->waiting = false;
+    UA_UNLOCK(&ring->ringMutex);
+
+    /* Handle error conditions. ETIME is the timeout. EBUSY/EAGAIN signal that
+     * the completions need to be processed first. */
+    if(res < 0 && errno != ETIME && errno != EINTR &&
+       errno != EBUSY && errno != EAGAIN) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                          "Eventloop\t| Error %s during io_uring_enter",
+                          errno_str));
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* Process all completions */
+    unsigned head = *ring->cqHead;
+    unsigned tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+    for(; head != tail; head++) {
+        struct io_uring_cqe cqe = ring->cqes[head & ring->cqMask];
+        __atomic_store_n(ring->cqHead, head + 1, __ATOMIC_RELEASE);
+        uringProcessCompletion(el, &cqe);
+    }
+
+    return UA_STATUSCODE_GOOD;
+}
+
+#endif /* defined(UA_HAVE_IO_URING) */
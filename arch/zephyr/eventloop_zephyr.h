@@ -21,6 +21,7 @@
 
 #include "../../deps/mp_printf.h"
 #include "../../deps/open62541_queue.h"
+#include "../../deps/ziptree.h"
 #include "../common/eventloop_common.h"
 #include "../common/timer.h"
 
@@ -55,6 +55,12 @@ struct UA_AccessControl {
     void (*closeSession)(UA_Server *server, UA_AccessControl *ac,
                          const UA_NodeId *sessionId, void *sessionContext);
 
+    /* The node-based callbacks (getUserRightsMask, getUserAccessLevel,
+     * getUserExecutable and allowBrowseNode) can be called from several
+     * threads at once and don't call the public server API. The server then
+     * executes read-only services in parallel in its service workers. */
+    UA_Boolean concurrentAccess;
+
     /* Access control for all nodes*/
     UA_UInt32 (*getUserRightsMask)(UA_Server *server, UA_AccessControl *ac,
                                    const UA_NodeId *sessionId, void *sessionContext,
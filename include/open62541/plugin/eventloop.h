@@ -403,6 +403,18 @@ struct UA_ConnectionManager {
     void
     (*freeNetworkBuffer)(UA_ConnectionManager *cm, uintptr_t connectionId,
                          UA_ByteString *buf);
+
+    /* Vectored Send
+     * ~~~~~~~~~~~~~
+     * Send several buffers over a Connection as one contiguous stream (e.g.
+     * with a single writev/sendmsg syscall). The same rules as for
+     * sendWithConnection apply. All buffers are released internally (also if
+     * sending fails). This is optional and can be NULL. Then the buffers are
+     * sent individually with sendWithConnection. */
+    UA_StatusCode
+    (*sendWithConnectionVec)(UA_ConnectionManager *cm, uintptr_t connectionId,
+                             const UA_KeyValueMap *params, UA_ByteString *bufs,
+                             size_t bufsSize);
 };
 
 /**
@@ -477,6 +489,15 @@ struct UA_InterruptManager {
 UA_EXPORT UA_EventLoop *
 UA_EventLoop_new_POSIX(const UA_Logger *logger);
 
+#ifdef __linux__
+/* Same as the POSIX EventLoop, but uses io_uring (Linux 5.11 and later) instead
+ * of epoll to wait for socket events. Changes to the set of watched sockets are
+ * submitted in one batch with the system call that waits for the next events.
+ * Falls back to epoll if io_uring is not available at runtime. */
+UA_EXPORT UA_EventLoop *
+UA_EventLoop_new_POSIX_IOURING(const UA_Logger *logger);
+#endif
+
 /**
  * TCP Connection Manager
  * ~~~~~~~~~~~~~~~~~~~~~~
@@ -543,8 +564,12 @@ UA_EventLoop_new_POSIX(const UA_Logger *logger);
  *
  * **Send Parameters:**
  *
- * No additional parameters for sending over an established TCP socket
- * defined. */
+ * 0:more [boolean]
+ *    More data for the connection follows right away. The kernel holds back
+ *    partial segments until the next send without this parameter (MSG_MORE on
+ *    Linux, ignored where not available). The buffers passed to
+ *    `sendWithConnectionVec` are written with a single sendmsg syscall
+ *    unless the socket buffer runs full (default: false). */
 UA_EXPORT UA_ConnectionManager *
 UA_ConnectionManager_new_POSIX_TCP(const UA_String eventSourceName);
 
@@ -565,6 +590,11 @@ UA_ConnectionManager_new_POSIX_TCP(const UA_String eventSourceName);
  *    becomes an upper bound for the message size. If undefined a fresh buffer
  *    is allocated for every `allocNetworkBuffer` (default: no buffer).
  *
+ * 0:recv-batchsize [uint32]
+ *    Maximum number of datagrams received with a single syscall (recvmmsg, on
+ *    Linux only). The receive buffer is split into as many slots, each
+ *    holding at most one maximum-size datagram (default: 8, max: 32).
+ *
  * **Open Connection Parameters:**
  *
  * 0:listen [boolean]
@@ -616,7 +646,12 @@ UA_ConnectionManager_new_POSIX_TCP(const UA_String eventSourceName);
  *
  * **Send Parameters:**
  *
- * No additional parameters for sending over an UDP connection defined. */
+ * 0:more [boolean]
+ *    More datagrams for the connection follow right away. The buffer is
+ *    queued and sent together with the next datagram that is sent without
+ *    this parameter (with a single sendmmsg syscall on Linux). Queued
+ *    datagrams are sent out in the next EventLoop iteration at the latest
+ *    (default: false). */
 UA_EXPORT UA_ConnectionManager *
 UA_ConnectionManager_new_POSIX_UDP(const UA_String eventSourceName);
 
@@ -679,6 +714,18 @@ UA_ConnectionManager_new_POSIX_UDP(const UA_String eventSourceName);
  *    creating any connection but solely validating the provided parameters
  *    (default: false)
  *
+ * 0:packet-mmap [bool]
+ *    Exchange the frames through a PACKET_MMAP ring shared with the kernel
+ *    (an RX ring for listening and a TX ring for sending connections). This
+ *    saves the syscall per frame. Frames passed to `sendWithConnection` with
+ *    the "more" parameter stay in the TX ring and are handed to the kernel
+ *    together with the next frame sent without it, or in the next EventLoop
+ *    iteration. Cannot be combined with txtime. Falls back to regular sockets
+ *    if the ring cannot be set up (default: false).
+ *
+ * 0:packet-mmap-frames [uint32]
+ *    Number of frame slots in the ring (default: 128).
+ *
  * Sending with a txtime (for Time-Sensitive Networking) is possible on recent
  * Linux kernels, If enabled for the socket, then a txtime parameters can be
  * passed to `sendWithConnection`. Note that the clock source for txtime sending
@@ -692,6 +739,12 @@ UA_ConnectionManager_new_POSIX_UDP(const UA_String eventSourceName);
  * 0:txtime-flags [uint32]
  *    txtime flags set for the socket (default: SOF_TXTIME_REPORT_ERRORS).
  *
+ * **Connection Callback Parameters (first callback only):**
+ *
+ * 0:packet-mmap [bool]
+ *    True if the frames are exchanged through a PACKET_MMAP ring. False if
+ *    the ring was not requested or could not be set up.
+ *
  * **Send Parameters (only with txtime enabled for the connection)**
  *
  * 0:txtime [datetime]
@@ -498,6 +498,13 @@ struct UA_Nodestore {
      * visible in all newly retrieved node-pointers for the given NodeId after
      * calling _releaseNode.
      *
+     * Nodestores that edit a copy and publish it in _releaseNode (e.g. the RCU
+     * Nodestore) block other modifying calls from other threads until the
+     * release. A nested _getEditNode for the same node from the same thread
+     * returns the same pointer. The changes are then published with the
+     * outermost release. If the node is removed while it is edited, the edit
+     * is lost. The node must not be replaced while it is edited.
+     *
      * The attribute-mask and reference-description indicate if only a subset of
      * the attributes and referencs are to be modified. Other attributes and
      * references shall not be changed. */
@@ -547,6 +554,11 @@ struct UA_Nodestore {
     /* Execute a callback for every node in the nodestore. */
     void (*iterate)(UA_Nodestore *ns, UA_NodestoreVisitor visitor,
                     void *visitorCtx);
+
+    /* The Nodestore can be used from several threads at once. Lookups can run
+     * in parallel with each other and with modifications. The server then
+     * executes read-only services in parallel in its service workers. */
+    UA_Boolean concurrentAccess;
 };
 
 /* Attributes must be of a matching type (VariableAttributes, ObjectAttributes,
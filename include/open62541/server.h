@@ -143,6 +143,21 @@ UA_Server_run_iterate(UA_Server *server, UA_Boolean waitInternal);
 UA_EXPORT UA_StatusCode
 UA_Server_run_shutdown(UA_Server *server);
 
+#if UA_MULTITHREADING >= 100
+/* Executes the requests dispatched to the service worker with the given index
+ * (see ``serviceWorkers`` in the server configuration). Every worker must be
+ * run by its own thread. The method blocks until UA_Server_run_shutdown is
+ * called. Join the worker threads before deleting the server.
+ *
+ * @param server The server object.
+ * @param workerIndex Index of the worker, smaller than ``serviceWorkers``.
+ * @return Returns UA_STATUSCODE_BADINVALIDARGUMENT if the index is out of
+ *         range and UA_STATUSCODE_BADINVALIDSTATE if the worker is already
+ *         running in a different thread. */
+UA_EXPORT UA_StatusCode
+UA_Server_runServiceWorker(UA_Server *server, size_t workerIndex);
+#endif
+
 /**
  * Timed Callbacks
  * ---------------
@@ -1863,9 +1878,20 @@ UA_Server_setExpirationDate(UA_Server *server, const UA_NodeId conditionId,
  * Statistic counters keeping track of the current state of the stack. Counters
  * are structured per OPC UA communication layer. */
 
+/* Statistics for the decoding of requests into the per-SecureChannel arena.
+ * See the requestArenaSize in the server configuration. */
+typedef struct {
+   size_t requestCount;    /* Requests decoded into an arena */
+   size_t allocCount;      /* Allocations served from the arenas */
+   size_t allocBytes;      /* Bytes served from the arenas */
+   size_t blockAllocCount; /* Arena blocks allocated from the heap */
+   size_t maxRequestBytes; /* Largest arena use for a single request */
+} UA_RequestArenaStatistics;
+
 typedef struct {
    UA_SecureChannelStatistics scs;
    UA_SessionStatistics ss;
+   UA_RequestArenaStatistics ras;
 } UA_ServerStatistics;
 
 UA_ServerStatistics UA_EXPORT UA_THREADSAFE
@@ -2161,6 +2187,13 @@ struct UA_ServerConfig {
     UA_UInt16 maxSecureChannels;
     UA_UInt32 maxSecurityTokenLifetime; /* in ms */
 
+    /* Requests are decoded into a per-SecureChannel arena that is reset after
+     * the request was processed. This avoids individual heap allocations for
+     * every decoded field. The value is the initial size of the arena (in
+     * bytes). The arena grows up to 16 times the initial size if larger
+     * requests are received. Zero disables the arena. */
+    size_t requestArenaSize;
+
     /* Limits for Sessions */
     UA_UInt16 maxSessions;
     UA_Double maxSessionTimeout; /* in ms */
@@ -2195,6 +2228,28 @@ struct UA_ServerConfig {
      * not be touched afterwards. */
     void (*asyncOperationCancelCallback)(UA_Server *server, const void *out);
 
+#if UA_MULTITHREADING >= 100
+    /* Service Workers
+     * ~~~~~~~~~~~~~~~
+     * Number of service workers (0 => disabled). The requests received on a
+     * SecureChannel are dispatched to the worker with the index ``channelId %
+     * serviceWorkers``. The application runs the workers in its own threads
+     * with UA_Server_runServiceWorker. Requests for a worker that is not
+     * running are processed in the server main loop.
+     *
+     * The workers execute Read, Browse, BrowseNext and
+     * TranslateBrowsePathsToNodeIds with a shared server lock in parallel, if
+     * the Nodestore and the AccessControl support concurrent access (see
+     * ``concurrentAccess`` in the plugin APIs) and the Session is activated.
+     * A Read takes the exclusive lock if one of the values comes from a
+     * callback or has an onRead notification. All services take the exclusive
+     * lock if a service or global notification callback is configured. So
+     * application callbacks that can call the public server API are never
+     * executed with the shared lock. All other services take the exclusive
+     * server lock. */
+    size_t serviceWorkers;
+#endif
+
     /* Discovery
      * ~~~~~~~~~ */
 #ifdef UA_ENABLE_DISCOVERY
@@ -279,6 +279,14 @@ typedef struct {
 
     UA_Boolean enableDeltaFrames;
 
+    /* Received UADP NetworkMessages are decoded into a per-PubSubConnection
+     * arena that is reset after the message was processed. This avoids heap
+     * allocations for the decoded DataSetMessages and fields. The value is the
+     * initial size of the arena (in bytes). The arena grows up to 16 times the
+     * initial size if larger messages are received. Zero disables the arena.
+     * The size is taken over when the PubSubConnection is created. */
+    size_t decodeArenaSize;
+
 #ifdef UA_ENABLE_PUBSUB_INFORMATIONMODEL
     UA_Boolean enableInformationModelMethods;
 #endif
@@ -578,6 +586,15 @@ typedef struct {
     UA_MessageSecurityMode securityMode; /* via the UA_WriterGroupDataType */
     UA_PubSubSecurityPolicy *securityPolicy;
     UA_String securityGroupId;
+
+    /* Non-std. config parameter. EventLoop for the publish timer (default:
+     * the server EventLoop). Run the EventLoop in a dedicated thread to
+     * decouple the publish cycle from the server and from other WriterGroups.
+     * Only the sampling of the values takes the server lock. The signing,
+     * encryption and sending is done without it. Requires UA_MULTITHREADING
+     * >= 100, otherwise the config is rejected. The EventLoop is not owned and
+     * must outlive the WriterGroup. */
+    UA_EventLoop *eventLoop;
 } UA_WriterGroupConfig;
 
 void UA_EXPORT
@@ -611,6 +628,38 @@ UA_Server_getWriterGroupLastPublishTimestamp(UA_Server *server,
                                              const UA_NodeId wgId,
                                              UA_DateTime *timestamp);
 
+/* Histogram of durations in microseconds. Bucket 0 counts durations below
+ * 1us. Bucket i counts durations in [2^(i-1), 2^i) us. The last bucket also
+ * counts all longer durations. */
+#define UA_PUBSUB_TIMINGBUCKETS 20
+
+typedef struct {
+    UA_UInt64 count;
+    UA_UInt64 sum; /* Sum of all durations (us) */
+    UA_UInt64 min; /* Shortest duration (us) */
+    UA_UInt64 max; /* Longest duration (us) */
+    UA_UInt64 buckets[UA_PUBSUB_TIMINGBUCKETS];
+} UA_PubSubTimingHistogram;
+
+/* Cycle timing of the WriterGroup since the publish callback was last
+ * registered (when the WriterGroup became operational) */
+typedef struct {
+    /* Delay of the publish callback after the intended cycle time */
+    UA_PubSubTimingHistogram wakeupLatency;
+    /* Waiting for the server lock, sampling the values and encoding */
+    UA_PubSubTimingHistogram encodeTime;
+    /* Signing and encryption of all NetworkMessages of a cycle */
+    UA_PubSubTimingHistogram signTime;
+    /* Handing the NetworkMessages to the ConnectionManager */
+    UA_PubSubTimingHistogram sendTime;
+    /* Publish cycles that were skipped because the callback was late */
+    UA_UInt64 missedCycles;
+} UA_WriterGroupTiming;
+
+UA_EXPORT UA_StatusCode UA_THREADSAFE
+UA_Server_getWriterGroupTiming(UA_Server *server, const UA_NodeId wgId,
+                               UA_WriterGroupTiming *timing);
+
 UA_EXPORT UA_StatusCode UA_THREADSAFE
 UA_Server_removeWriterGroup(UA_Server *server, const UA_NodeId wgId);
 
@@ -783,6 +832,22 @@ typedef struct {
     } subscribedDataSet;
     /* non std. fields */
     UA_String linkedStandaloneSubscribedDataSetName;
+
+    /* Resolve and type-check the TargetVariables once when the reader is
+     * enabled. The received fields are then written directly into the bound
+     * variables instead of going through the Write service. This requires a
+     * VariableNode with an internal or external value source, the Value
+     * attribute without an IndexRange and the exact DataType from the
+     * DataSetMetaData. Other TargetVariables use the Write service. */
+    UA_Boolean bindTargetVariables;
+
+    /* KeyFrameCount of the DataSetWriter. DeltaFrames are only applied after
+     * a KeyFrame was received. If more than keyFrameCount-1 DeltaFrames follow
+     * each other, a KeyFrame was lost and the DeltaFrames are discarded until
+     * the next KeyFrame. A gap in the DataSetMessage SequenceNumber also
+     * discards DeltaFrames until the next KeyFrame. With 0 the number of
+     * DeltaFrames is not checked. */
+    UA_UInt32 keyFrameCount;
 } UA_DataSetReaderConfig;
 
 UA_EXPORT UA_StatusCode
@@ -821,6 +886,24 @@ UA_Server_enableDataSetReader(UA_Server *server, const UA_NodeId dsrId);
 UA_EXPORT UA_StatusCode UA_THREADSAFE
 UA_Server_disableDataSetReader(UA_Server *server, const UA_NodeId dsrId);
 
+/* Counters for the fields applied to the TargetVariables since the
+ * DataSetReader was last enabled */
+typedef struct {
+    size_t boundTargets;        /* TargetVariables resolved at enable */
+    UA_UInt64 fieldsBound;      /* Fields written to a bound variable */
+    UA_UInt64 fieldsWritten;    /* Fields written via the Write service */
+    UA_UInt64 fieldsFailed;     /* Fields that could not be written */
+    UA_UInt64 deltaFramesApplied; /* DeltaFrames written to the targets */
+    UA_UInt64 deltaFramesDropped; /* DeltaFrames discarded before a KeyFrame */
+    UA_UInt64 sequenceGaps;     /* Missing DataSetMessage SequenceNumbers */
+    UA_Double fieldsPerSecond;  /* Applied fields per second since enabled */
+} UA_DataSetReaderTargetStatistics;
+
+UA_EXPORT UA_StatusCode UA_THREADSAFE
+UA_Server_getDataSetReaderTargetStatistics(UA_Server *server,
+                                           const UA_NodeId dsrId,
+                                           UA_DataSetReaderTargetStatistics *stats);
+
 UA_EXPORT UA_StatusCode UA_THREADSAFE
 UA_Server_setDataSetReaderTargetVariables(
     UA_Server *server, const UA_NodeId dsrId,
@@ -904,6 +987,20 @@ UA_Server_setReaderGroupEncryptionKeys(UA_Server *server,
                                        const UA_ByteString encryptingKey,
                                        const UA_ByteString keyNonce);
 
+/* Timing of the received NetworkMessages since the ReaderGroup was last
+ * enabled. Measured from the moment the buffer is received from the
+ * ConnectionManager. */
+typedef struct {
+    /* Decoding of the NetworkMessages decoded by this ReaderGroup */
+    UA_PubSubTimingHistogram decodeTime;
+    /* Until the DataSetMessages are applied by the DataSetReaders */
+    UA_PubSubTimingHistogram receiveToApply;
+} UA_ReaderGroupTiming;
+
+UA_EXPORT UA_StatusCode UA_THREADSAFE
+UA_Server_getReaderGroupTiming(UA_Server *server, const UA_NodeId rgId,
+                               UA_ReaderGroupTiming *timing);
+
 #ifdef UA_ENABLE_PUBSUB_FILE_CONFIG
 
 /* Decodes the information from the ByteString. If the decoded content is a
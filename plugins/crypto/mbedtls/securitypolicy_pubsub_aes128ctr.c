@@ -52,8 +52,24 @@ typedef struct {
     UA_Byte encryptingKey[UA_AES128CTR_KEY_LENGTH];
     UA_Byte keyNonce[UA_AES128CTR_KEYNONCE_LENGTH];
     UA_Byte messageNonce[UA_AES128CTR_MESSAGENONCE_LENGTH];
+
+    /* Expanded once when the keys are set (per security token) and reused for
+     * all NetworkMessages. The HMAC context holds the precomputed inner and
+     * outer pads of the signing key. */
+    mbedtls_aes_context aesContext;
+    mbedtls_md_context_t hmacContext;
 } PUBSUB_AES128CTR_ChannelContext;
 
+static UA_StatusCode
+hmac_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc,
+                         const UA_ByteString *message, unsigned char *out) {
+    if(mbedtls_md_hmac_reset(&cc->hmacContext) != 0 ||
+       mbedtls_md_hmac_update(&cc->hmacContext, message->data, message->length) != 0 ||
+       mbedtls_md_hmac_finish(&cc->hmacContext, out) != 0)
+        return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+    return UA_STATUSCODE_GOOD;
+}
+
 /*******************/
 /* SymmetricModule */
 /*******************/
@@ -70,13 +86,8 @@ verify_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc,
     if(signature->length != UA_SHA256_LENGTH)
         return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
 
-    PUBSUB_AES128CTR_PolicyContext *pc =
-        (PUBSUB_AES128CTR_PolicyContext *)cc->policyContext;
-
     unsigned char mac[UA_SHA256_LENGTH];
-    UA_ByteString signingKey =
-        {UA_AES128CTR_SIGNING_KEY_LENGTH, cc->signingKey};
-    if(mbedtls_hmac(&pc->sha256MdContext, &signingKey, message, mac) != UA_STATUSCODE_GOOD)
+    if(hmac_sp_pubsub_aes128ctr(cc, message, mac) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
 
     /* Compare with Signature */
@@ -91,10 +102,7 @@ sign_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc,
     if(signature->length != UA_SHA256_LENGTH)
         return UA_STATUSCODE_BADINTERNALERROR;
 
-    UA_ByteString signingKey =
-        {UA_AES128CTR_SIGNING_KEY_LENGTH, cc->signingKey};
-    if(mbedtls_hmac(&cc->policyContext->sha256MdContext, &signingKey, 
-                    message, signature->data) != UA_STATUSCODE_GOOD)
+    if(hmac_sp_pubsub_aes128ctr(cc, message, signature->data) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
 
     return UA_STATUSCODE_GOOD;
@@ -126,22 +134,13 @@ getPlainTextBlockSize_sp_pubsub_aes128ctr(const void *channelContext) {
 }
 
 static UA_StatusCode
-encrypt_sp_pubsub_aes128ctr(const PUBSUB_AES128CTR_ChannelContext *cc,
+encrypt_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc,
                             UA_ByteString *data) {
     if(cc == NULL || data == NULL)
         return UA_STATUSCODE_BADINTERNALERROR;
 
     /* CTR mode does not need padding */
 
-    /* Decode the header to Extract the message nonce */
-
-    /* Keylength in bits */
-    unsigned int keylength = (unsigned int)(UA_AES128CTR_KEY_LENGTH * 8);
-    mbedtls_aes_context aesContext;
-    int mbedErr = mbedtls_aes_setkey_enc(&aesContext, cc->encryptingKey, keylength);
-    if(mbedErr)
-        return UA_STATUSCODE_BADINTERNALERROR;
-
     /* Prepare the counterBlock required for encryption/decryption 
      * Block counter starts at 1 according to part 14 (7.2.2.4.3.2)*/
     UA_Byte counterBlockCopy[UA_AES128CTR_ENCRYPTION_BLOCK_SIZE];
@@ -154,8 +153,8 @@ encrypt_sp_pubsub_aes128ctr(const PUBSUB_AES128CTR_ChannelContext *cc,
 
     size_t counterblockoffset = 0;
     UA_Byte aesBuffer[UA_AES128CTR_ENCRYPTION_BLOCK_SIZE];
-    mbedErr = mbedtls_aes_crypt_ctr(&aesContext, data->length, &counterblockoffset,
-                                    counterBlockCopy, aesBuffer, data->data, data->data);
+    int mbedErr = mbedtls_aes_crypt_ctr(&cc->aesContext, data->length, &counterblockoffset,
+                                        counterBlockCopy, aesBuffer, data->data, data->data);
     if(mbedErr)
         return UA_STATUSCODE_BADINTERNALERROR;
     return UA_STATUSCODE_GOOD;
@@ -164,7 +163,7 @@ encrypt_sp_pubsub_aes128ctr(const PUBSUB_AES128CTR_ChannelContext *cc,
 /* a decryption function is exactly the same as an encryption one, since they all do XOR
  * operations*/
 static UA_StatusCode
-decrypt_sp_pubsub_aes128ctr(const PUBSUB_AES128CTR_ChannelContext *cc,
+decrypt_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc,
                             UA_ByteString *data) {
     return encrypt_sp_pubsub_aes128ctr(cc, data);
 }
@@ -196,9 +195,23 @@ generateNonce_sp_pubsub_aes128ctr(void *policyContext, UA_ByteString *out) {
 
 static void
 channelContext_deleteContext_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc) {
+    mbedtls_aes_free(&cc->aesContext);
+    mbedtls_md_free(&cc->hmacContext);
     UA_free(cc);
 }
 
+/* Expand the AES key schedule and the HMAC pads for the current keys */
+static UA_StatusCode
+channelContext_expandKeys_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc) {
+    unsigned int keylength = (unsigned int)(UA_AES128CTR_KEY_LENGTH * 8); /* In bits */
+    if(mbedtls_aes_setkey_enc(&cc->aesContext, cc->encryptingKey, keylength) != 0)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    if(mbedtls_md_hmac_starts(&cc->hmacContext, cc->signingKey,
+                              UA_AES128CTR_SIGNING_KEY_LENGTH) != 0)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
 static UA_StatusCode
 channelContext_newContext_sp_pubsub_aes128ctr(void *policyContext,
                                               const UA_ByteString *signingKey,
@@ -218,12 +231,24 @@ channelContext_newContext_sp_pubsub_aes128ctr(void *policyContext,
 
     /* Initialize the channel context */
     cc->policyContext = (PUBSUB_AES128CTR_PolicyContext *)policyContext;
+    mbedtls_aes_init(&cc->aesContext);
+    mbedtls_md_init(&cc->hmacContext);
+    const mbedtls_md_info_t *mdInfo = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+    if(mbedtls_md_setup(&cc->hmacContext, mdInfo, 1) != 0) {
+        channelContext_deleteContext_sp_pubsub_aes128ctr(cc);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
     if(signingKey)
         memcpy(cc->signingKey, signingKey->data, signingKey->length);
     if(encryptingKey)
         memcpy(cc->encryptingKey, encryptingKey->data, encryptingKey->length);
     if(keyNonce)
         memcpy(cc->keyNonce, keyNonce->data, keyNonce->length);
+    UA_StatusCode res = channelContext_expandKeys_sp_pubsub_aes128ctr(cc);
+    if(res != UA_STATUSCODE_GOOD) {
+        channelContext_deleteContext_sp_pubsub_aes128ctr(cc);
+        return res;
+    }
     *wgContext = cc;
     return UA_STATUSCODE_GOOD;
 }
@@ -242,7 +267,7 @@ channelContext_setKeys_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc,
     memcpy(cc->signingKey, signingKey->data, signingKey->length);
     memcpy(cc->encryptingKey, encryptingKey->data, encryptingKey->length);
     memcpy(cc->keyNonce, keyNonce->data, keyNonce->length);
-    return UA_STATUSCODE_GOOD;
+    return channelContext_expandKeys_sp_pubsub_aes128ctr(cc);
 }
 
 static UA_StatusCode
@@ -0,0 +1,1269 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/historydata/history_data_backend_file.h>
+
+#if defined(UA_ARCHITECTURE_POSIX)
+
+#include "mp_printf.h"
+#include "open62541_queue.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+/* On-disk layout
+ * --------------
+ *
+ * <directory>/nodes       Catalog of the historized NodeIds. Every entry is
+ *                         [UInt32 number][UInt32 length][binary NodeId].
+ * <directory>/n<number>/  One subdirectory per NodeId
+ *     <segment>.seg       Segment files, numbered in ascending time order
+ *
+ * A segment starts with the UA_HistoryFileHeader. It is followed by the records
+ * [DateTime timestamp][UInt32 length][binary DataValue]. The header fields
+ * "used" and "count" are updated after a record was written. So an interrupted
+ * write leaves only unreferenced bytes at the end of the segment.
+ *
+ * The segments of a node are scanned when the node is first accessed. This
+ * builds a sparse index with the offset and timestamp of every
+ * UA_HISTORYFILE_STRIDE-th record. A record is found by first selecting the
+ * segment, then the sparse index entry and then walking at most
+ * UA_HISTORYFILE_STRIDE records.
+ *
+ * Only the active (last) segment of a node stays mapped writable. Full
+ * segments are synced and unmapped. They are mapped read-only on demand. At
+ * most UA_HISTORYFILE_MAXMAPPED of them remain mapped, the least recently used
+ * mapping is dropped first.
+ *
+ * Written records are synced to disk (msync/fsync) when the syncInterval has
+ * elapsed since the last sync, in UA_HistoryDataBackend_File_sync and when the
+ * backend is cleared. New files and directories are made durable together with
+ * the records. */
+
+#define UA_HISTORYFILE_MAGIC 0x53485541 /* "UAHS" */
+#define UA_HISTORYFILE_VERSION 1
+#define UA_HISTORYFILE_STRIDE 64
+#define UA_HISTORYFILE_MAXMAPPED 16
+#define UA_HISTORYFILE_RECORDHEADER (sizeof(UA_DateTime) + sizeof(UA_UInt32))
+
+typedef struct {
+    UA_UInt32 magic;
+    UA_UInt32 version;
+    UA_UInt64 used;  /* Committed bytes including the header */
+    UA_UInt64 count; /* Committed records */
+    UA_DateTime first;
+    UA_DateTime last;
+} UA_HistoryFileHeader;
+
+typedef struct UA_HistoryFileSegment {
+    UA_UInt32 number;
+    UA_Byte *data;      /* The mapping starts with the header. NULL if the
+                         * segment is currently not mapped. */
+    size_t mapSize;
+    UA_Boolean writable;
+
+    /* Committed header fields. Kept in memory to select the segment without
+     * mapping it. */
+    size_t used;
+    size_t count;
+    UA_DateTime last;
+
+    size_t firstIndex;  /* Node-wide index of the first record */
+    size_t *strideOffsets;
+    UA_DateTime *strideTimestamps;
+    size_t strideSize;
+
+    /* Read-only mappings, most recently used first */
+    TAILQ_ENTRY(UA_HistoryFileSegment) mapEntry;
+} UA_HistoryFileSegment;
+
+typedef TAILQ_HEAD(UA_HistoryFileSegmentQueue, UA_HistoryFileSegment)
+    UA_HistoryFileSegmentQueue;
+
+typedef struct UA_HistoryFileNode {
+    UA_NodeId nodeId;
+    UA_UInt32 hash;
+    UA_UInt32 number;
+    UA_Boolean loaded;
+    UA_HistoryFileSegment **segments;
+    size_t segmentsSize;
+    size_t count;
+
+    /* Records or segment files not yet synced to disk */
+    UA_Boolean dirty;
+    UA_Boolean dirtyDirectory;
+    LIST_ENTRY(UA_HistoryFileNode) dirtyEntry;
+} UA_HistoryFileNode;
+
+typedef struct {
+    char *directory;
+    size_t segmentSize;
+    int catalogFd;
+    UA_UInt32 nextNumber;
+    UA_HistoryFileNode **nodes; /* Hash table, size is a power of two */
+    size_t nodesSize;
+    size_t nodesCount;
+    UA_HistoryFileNode empty;   /* Returned for unknown nodes during reads */
+    UA_DataValue cache;         /* Backing memory for getDataValue */
+
+    /* Read-only mappings of full segments */
+    UA_HistoryFileSegmentQueue mapped;
+    size_t mappedSize;
+
+    /* Sync */
+    UA_DateTime syncInterval;
+    UA_DateTime lastSync; /* Monotonic clock */
+    UA_Boolean dirtyCatalog;
+    LIST_HEAD(, UA_HistoryFileNode) dirtyNodes;
+} UA_HistoryFileContext;
+
+static UA_HistoryFileHeader *
+segmentHeader(const UA_HistoryFileSegment *seg) {
+    return (UA_HistoryFileHeader*)(uintptr_t)seg->data;
+}
+
+static UA_DateTime
+recordTimestamp(const UA_HistoryFileSegment *seg, size_t offset) {
+    UA_DateTime timestamp;
+    memcpy(&timestamp, &seg->data[offset], sizeof(UA_DateTime));
+    return timestamp;
+}
+
+static UA_ByteString
+recordData(const UA_HistoryFileSegment *seg, size_t offset) {
+    UA_UInt32 length;
+    memcpy(&length, &seg->data[offset + sizeof(UA_DateTime)], sizeof(UA_UInt32));
+    UA_ByteString data;
+    data.length = length;
+    data.data = &seg->data[offset + UA_HISTORYFILE_RECORDHEADER];
+    return data;
+}
+
+static size_t
+nextRecord(const UA_HistoryFileSegment *seg, size_t offset) {
+    return offset + UA_HISTORYFILE_RECORDHEADER + recordData(seg, offset).length;
+}
+
+static void
+nodePath(const UA_HistoryFileContext *ctx, const UA_HistoryFileNode *node,
+         char *path) {
+    mp_snprintf(path, PATH_MAX, "%s/n%u", ctx->directory, node->number);
+}
+
+static void
+segmentPath(const UA_HistoryFileContext *ctx, const UA_HistoryFileNode *node,
+            UA_UInt32 number, char *path) {
+    mp_snprintf(path, PATH_MAX, "%s/n%u/%08u.seg",
+                ctx->directory, node->number, number);
+}
+
+/* Make the directory entries (new files and subdirectories) durable */
+static UA_StatusCode
+syncDirectory(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    int ret = fsync(fd);
+    close(fd);
+    return (ret == 0) ? UA_STATUSCODE_GOOD : UA_STATUSCODE_BADINTERNALERROR;
+}
+
+static void
+unmapSegment(UA_HistoryFileContext *ctx, UA_HistoryFileSegment *seg) {
+    if(!seg->data)
+        return;
+    if(!seg->writable) {
+        TAILQ_REMOVE(&ctx->mapped, seg, mapEntry);
+        ctx->mappedSize--;
+    }
+    munmap(seg->data, seg->mapSize);
+    seg->data = NULL;
+    seg->mapSize = 0;
+}
+
+static void
+UA_HistoryFileSegment_delete(UA_HistoryFileContext *ctx,
+                             UA_HistoryFileSegment *seg) {
+    unmapSegment(ctx, seg);
+    UA_free(seg->strideOffsets);
+    UA_free(seg->strideTimestamps);
+    UA_free(seg);
+}
+
+static void
+UA_HistoryFileNode_delete(UA_HistoryFileContext *ctx, UA_HistoryFileNode *node) {
+    if(node->dirty)
+        LIST_REMOVE(node, dirtyEntry);
+    for(size_t i = 0; i < node->segmentsSize; i++)
+        UA_HistoryFileSegment_delete(ctx, node->segments[i]);
+    UA_free(node->segments);
+    UA_NodeId_clear(&node->nodeId);
+    UA_free(node);
+}
+
+/********/
+/* Sync */
+/********/
+
+static void
+markDirty(UA_HistoryFileContext *ctx, UA_HistoryFileNode *node) {
+    if(node->dirty)
+        return;
+    node->dirty = true;
+    LIST_INSERT_HEAD(&ctx->dirtyNodes, node, dirtyEntry);
+}
+
+/* Sync the committed records of the active segment and new segment files. The
+ * node stays in the dirty list if that fails. */
+static UA_StatusCode
+syncNode(UA_HistoryFileContext *ctx, UA_HistoryFileNode *node) {
+    if(node->dirtyDirectory) {
+        char path[PATH_MAX];
+        nodePath(ctx, node, path);
+        if(syncDirectory(path) != UA_STATUSCODE_GOOD)
+            return UA_STATUSCODE_BADINTERNALERROR;
+        node->dirtyDirectory = false;
+    }
+    if(node->segmentsSize > 0) {
+        UA_HistoryFileSegment *seg = node->segments[node->segmentsSize - 1];
+        if(seg->writable && msync(seg->data, seg->used, MS_SYNC) != 0)
+            return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    LIST_REMOVE(node, dirtyEntry);
+    node->dirty = false;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+syncStore(UA_HistoryFileContext *ctx) {
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+
+    /* Catalog entries and node directories first. So the records synced
+     * below can be found after a restart. */
+    if(ctx->dirtyCatalog) {
+        if(fsync(ctx->catalogFd) == 0 &&
+           syncDirectory(ctx->directory) == UA_STATUSCODE_GOOD)
+            ctx->dirtyCatalog = false;
+        else
+            res = UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    UA_HistoryFileNode *node, *next;
+    for(node = LIST_FIRST(&ctx->dirtyNodes); node; node = next) {
+        next = LIST_NEXT(node, dirtyEntry);
+        res |= syncNode(ctx, node);
+    }
+
+    ctx->lastSync = UA_DateTime_nowMonotonic();
+    return res;
+}
+
+/* Sync if the interval has elapsed since the last sync */
+static void
+checkSync(UA_HistoryFileContext *ctx) {
+    if(UA_DateTime_nowMonotonic() - ctx->lastSync >= ctx->syncInterval)
+        syncStore(ctx);
+}
+
+static void
+UA_HistoryFileContext_delete(UA_HistoryFileContext *ctx) {
+    if(ctx->catalogFd >= 0)
+        syncStore(ctx);
+    for(size_t i = 0; i < ctx->nodesSize; i++) {
+        if(ctx->nodes[i])
+            UA_HistoryFileNode_delete(ctx, ctx->nodes[i]);
+    }
+    UA_free(ctx->nodes);
+    if(ctx->catalogFd >= 0)
+        close(ctx->catalogFd);
+    UA_DataValue_clear(&ctx->cache);
+    UA_free(ctx->directory);
+    UA_free(ctx);
+}
+
+/****************/
+/* NodeId Index */
+/****************/
+
+static UA_HistoryFileNode *
+findNode(const UA_HistoryFileContext *ctx, const UA_NodeId *nodeId,
+         UA_UInt32 hash) {
+    size_t mask = ctx->nodesSize - 1;
+    for(size_t i = hash & mask; ctx->nodes[i]; i = (i + 1) & mask) {
+        UA_HistoryFileNode *node = ctx->nodes[i];
+        if(node->hash == hash && UA_NodeId_equal(&node->nodeId, nodeId))
+            return node;
+    }
+    return NULL;
+}
+
+static UA_StatusCode
+addNodeEntry(UA_HistoryFileContext *ctx, UA_HistoryFileNode *node) {
+    /* Keep the load factor below 3/4 */
+    if((ctx->nodesCount + 1) * 4 > ctx->nodesSize * 3) {
+        size_t newSize = ctx->nodesSize * 2;
+        UA_HistoryFileNode **nodes = (UA_HistoryFileNode**)
+            UA_calloc(newSize, sizeof(UA_HistoryFileNode*));
+        if(!nodes)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        for(size_t i = 0; i < ctx->nodesSize; i++) {
+            UA_HistoryFileNode *n = ctx->nodes[i];
+            if(!n)
+                continue;
+            size_t j = n->hash & (newSize - 1);
+            while(nodes[j])
+                j = (j + 1) & (newSize - 1);
+            nodes[j] = n;
+        }
+        UA_free(ctx->nodes);
+        ctx->nodes = nodes;
+        ctx->nodesSize = newSize;
+    }
+
+    size_t mask = ctx->nodesSize - 1;
+    size_t i = node->hash & mask;
+    while(ctx->nodes[i])
+        i = (i + 1) & mask;
+    ctx->nodes[i] = node;
+    ctx->nodesCount++;
+    if(node->number >= ctx->nextNumber)
+        ctx->nextNumber = node->number + 1;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_HistoryFileNode *
+newNode(const UA_NodeId *nodeId, UA_UInt32 number) {
+    UA_HistoryFileNode *node = (UA_HistoryFileNode*)
+        UA_calloc(1, sizeof(UA_HistoryFileNode));
+    if(!node)
+        return NULL;
+    if(UA_NodeId_copy(nodeId, &node->nodeId) != UA_STATUSCODE_GOOD) {
+        UA_free(node);
+        return NULL;
+    }
+    node->hash = UA_NodeId_hash(nodeId);
+    node->number = number;
+    return node;
+}
+
+/* Read the catalog of known NodeIds. The segments are loaded on demand. */
+static UA_StatusCode
+readCatalog(UA_HistoryFileContext *ctx) {
+    struct stat st;
+    if(fstat(ctx->catalogFd, &st) != 0)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    if(st.st_size == 0)
+        return UA_STATUSCODE_GOOD;
+
+    UA_ByteString buf;
+    UA_StatusCode res = UA_ByteString_allocBuffer(&buf, (size_t)st.st_size);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    ssize_t got = pread(ctx->catalogFd, buf.data, buf.length, 0);
+    if(got != (ssize_t)buf.length) {
+        UA_ByteString_clear(&buf);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* A damaged entry at the end (from an interrupted write) is cut off */
+    size_t pos = 0;
+    while(pos + 2 * sizeof(UA_UInt32) <= buf.length) {
+        UA_UInt32 number, length;
+        memcpy(&number, &buf.data[pos], sizeof(UA_UInt32));
+        memcpy(&length, &buf.data[pos + sizeof(UA_UInt32)], sizeof(UA_UInt32));
+        size_t entryEnd = pos + 2 * sizeof(UA_UInt32) + length;
+        if(entryEnd > buf.length)
+            break;
+        UA_ByteString encoded = {length, &buf.data[pos + 2 * sizeof(UA_UInt32)]};
+        UA_NodeId nodeId;
+        if(UA_decodeBinary(&encoded, &nodeId, &UA_TYPES[UA_TYPES_NODEID],
+                           NULL) != UA_STATUSCODE_GOOD)
+            break;
+        UA_HistoryFileNode *node = newNode(&nodeId, number);
+        UA_NodeId_clear(&nodeId);
+        if(!node) {
+            res = UA_STATUSCODE_BADOUTOFMEMORY;
+            break;
+        }
+        res = addNodeEntry(ctx, node);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_HistoryFileNode_delete(ctx, node);
+            break;
+        }
+        pos = entryEnd;
+    }
+    UA_ByteString_clear(&buf);
+    if(res == UA_STATUSCODE_GOOD && pos < (size_t)st.st_size &&
+       ftruncate(ctx->catalogFd, (off_t)pos) != 0)
+        res = UA_STATUSCODE_BADINTERNALERROR;
+    return res;
+}
+
+static UA_StatusCode
+writeCatalogEntry(UA_HistoryFileContext *ctx, const UA_HistoryFileNode *node) {
+    UA_UInt32 length = (UA_UInt32)
+        UA_calcSizeBinary(&node->nodeId, &UA_TYPES[UA_TYPES_NODEID], NULL);
+    UA_ByteString entry;
+    UA_StatusCode res =
+        UA_ByteString_allocBuffer(&entry, length + 2 * sizeof(UA_UInt32));
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    memcpy(entry.data, &node->number, sizeof(UA_UInt32));
+    memcpy(&entry.data[sizeof(UA_UInt32)], &length, sizeof(UA_UInt32));
+    UA_ByteString encoded = {length, &entry.data[2 * sizeof(UA_UInt32)]};
+    res = UA_encodeBinary(&node->nodeId, &UA_TYPES[UA_TYPES_NODEID], &encoded, NULL);
+    if(res == UA_STATUSCODE_GOOD &&
+       write(ctx->catalogFd, entry.data, entry.length) != (ssize_t)entry.length)
+        res = UA_STATUSCODE_BADINTERNALERROR;
+    UA_ByteString_clear(&entry);
+    return res;
+}
+
+/* Add a NodeId to the catalog and create its directory. Both are synced with
+ * the first records. */
+static UA_HistoryFileNode *
+createNode(UA_HistoryFileContext *ctx, const UA_NodeId *nodeId) {
+    UA_HistoryFileNode *node = newNode(nodeId, ctx->nextNumber);
+    if(!node)
+        return NULL;
+    char path[PATH_MAX];
+    nodePath(ctx, node, path);
+    if((mkdir(path, 0755) != 0 && errno != EEXIST) ||
+       writeCatalogEntry(ctx, node) != UA_STATUSCODE_GOOD ||
+       addNodeEntry(ctx, node) != UA_STATUSCODE_GOOD) {
+        UA_HistoryFileNode_delete(ctx, node);
+        return NULL;
+    }
+    ctx->dirtyCatalog = true;
+    node->loaded = true;
+    return node;
+}
+
+/************/
+/* Segments */
+/************/
+
+static UA_StatusCode
+addStride(UA_HistoryFileSegment *seg, size_t offset, UA_DateTime timestamp) {
+    size_t *offsets = (size_t*)
+        UA_realloc(seg->strideOffsets, (seg->strideSize + 1) * sizeof(size_t));
+    if(!offsets)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    seg->strideOffsets = offsets;
+    UA_DateTime *timestamps = (UA_DateTime*)
+        UA_realloc(seg->strideTimestamps, (seg->strideSize + 1) * sizeof(UA_DateTime));
+    if(!timestamps)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    seg->strideTimestamps = timestamps;
+    seg->strideOffsets[seg->strideSize] = offset;
+    seg->strideTimestamps[seg->strideSize] = timestamp;
+    seg->strideSize++;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Validate the records, build the sparse index and take over the header
+ * fields */
+static UA_StatusCode
+scanSegment(UA_HistoryFileSegment *seg) {
+    const UA_HistoryFileHeader *hdr = segmentHeader(seg);
+    size_t offset = sizeof(UA_HistoryFileHeader);
+    for(size_t i = 0; i < hdr->count; i++) {
+        if(offset + UA_HISTORYFILE_RECORDHEADER > hdr->used ||
+           nextRecord(seg, offset) > hdr->used)
+            return UA_STATUSCODE_BADDECODINGERROR;
+        if(i % UA_HISTORYFILE_STRIDE == 0) {
+            UA_StatusCode res = addStride(seg, offset, recordTimestamp(seg, offset));
+            if(res != UA_STATUSCODE_GOOD)
+                return res;
+        }
+        offset = nextRecord(seg, offset);
+    }
+    seg->used = (size_t)hdr->used;
+    seg->count = (size_t)hdr->count;
+    seg->last = hdr->last;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+mapSegment(const UA_HistoryFileContext *ctx, const UA_HistoryFileNode *node,
+           UA_HistoryFileSegment *seg, UA_Boolean writable) {
+    char path[PATH_MAX];
+    segmentPath(ctx, node, seg->number, path);
+    int fd = open(path, writable ? O_RDWR : O_RDONLY);
+    if(fd < 0)
+        return UA_STATUSCODE_BADNOTFOUND;
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(UA_HistoryFileHeader)) {
+        close(fd);
+        return UA_STATUSCODE_BADDECODINGERROR;
+    }
+    void *data = mmap(NULL, (size_t)st.st_size,
+                      writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                      MAP_SHARED, fd, 0);
+    close(fd); /* The mapping remains valid */
+    if(data == MAP_FAILED)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    seg->data = (UA_Byte*)data;
+    seg->mapSize = (size_t)st.st_size;
+    seg->writable = writable;
+
+    const UA_HistoryFileHeader *hdr = segmentHeader(seg);
+    if(hdr->magic != UA_HISTORYFILE_MAGIC || hdr->version != UA_HISTORYFILE_VERSION ||
+       hdr->used > seg->mapSize)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Ensure that the segment is mapped before its records are accessed. Full
+ * segments are mapped read-only. The least recently used read-only mapping is
+ * dropped if there are too many. */
+static UA_StatusCode
+useSegment(UA_HistoryFileContext *ctx, const UA_HistoryFileNode *node,
+           UA_HistoryFileSegment *seg) {
+    if(seg->writable)
+        return UA_STATUSCODE_GOOD;
+    if(seg->data) {
+        TAILQ_REMOVE(&ctx->mapped, seg, mapEntry);
+        TAILQ_INSERT_HEAD(&ctx->mapped, seg, mapEntry);
+        return UA_STATUSCODE_GOOD;
+    }
+
+    if(ctx->mappedSize >= UA_HISTORYFILE_MAXMAPPED)
+        unmapSegment(ctx, TAILQ_LAST(&ctx->mapped, UA_HistoryFileSegmentQueue));
+
+    UA_StatusCode res = mapSegment(ctx, node, seg, false);
+    if(res != UA_STATUSCODE_GOOD) {
+        if(seg->data)
+            munmap(seg->data, seg->mapSize);
+        seg->data = NULL;
+        seg->mapSize = 0;
+        return res;
+    }
+    TAILQ_INSERT_HEAD(&ctx->mapped, seg, mapEntry);
+    ctx->mappedSize++;
+    return UA_STATUSCODE_GOOD;
+}
+
+static int
+compareNumbers(const void *a, const void *b) {
+    UA_UInt32 na = *(const UA_UInt32*)a;
+    UA_UInt32 nb = *(const UA_UInt32*)b;
+    return (na < nb) ? -1 : (na > nb);
+}
+
+/* Scan the segments of a node. Only the last segment remains mapped (writable).
+ * Empty and damaged segments are skipped. */
+static UA_StatusCode
+loadNode(UA_HistoryFileContext *ctx, UA_HistoryFileNode *node) {
+    char path[PATH_MAX];
+    nodePath(ctx, node, path);
+    DIR *dir = opendir(path);
+    if(!dir)
+        return UA_STATUSCODE_BADNOTFOUND;
+
+    UA_UInt32 *numbers = NULL;
+    size_t numbersSize = 0;
+    struct dirent *dirent;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    while((dirent = readdir(dir)) != NULL) {
+        char *end = NULL;
+        unsigned long number = strtoul(dirent->d_name, &end, 10);
+        if(end == dirent->d_name || strcmp(end, ".seg") != 0)
+            continue;
+        UA_UInt32 *n = (UA_UInt32*)
+            UA_realloc(numbers, (numbersSize + 1) * sizeof(UA_UInt32));
+        if(!n) {
+            res = UA_STATUSCODE_BADOUTOFMEMORY;
+            break;
+        }
+        numbers = n;
+        numbers[numbersSize++] = (UA_UInt32)number;
+    }
+    closedir(dir);
+    if(res != UA_STATUSCODE_GOOD)
+        goto cleanup;
+    qsort(numbers, numbersSize, sizeof(UA_UInt32), compareNumbers);
+
+    if(numbersSize > 0) {
+        node->segments = (UA_HistoryFileSegment**)
+            UA_calloc(numbersSize, sizeof(UA_HistoryFileSegment*));
+        if(!node->segments) {
+            res = UA_STATUSCODE_BADOUTOFMEMORY;
+            goto cleanup;
+        }
+    }
+
+    for(size_t i = 0; i < numbersSize; i++) {
+        UA_HistoryFileSegment *seg = (UA_HistoryFileSegment*)
+            UA_calloc(1, sizeof(UA_HistoryFileSegment));
+        if(!seg) {
+            res = UA_STATUSCODE_BADOUTOFMEMORY;
+            break;
+        }
+        seg->number = numbers[i];
+        UA_Boolean last = (i + 1 == numbersSize);
+        if(mapSegment(ctx, node, seg, last) != UA_STATUSCODE_GOOD ||
+           scanSegment(seg) != UA_STATUSCODE_GOOD ||
+           (!last && seg->count == 0)) {
+            if(seg->data)
+                munmap(seg->data, seg->mapSize);
+            UA_free(seg->strideOffsets);
+            UA_free(seg->strideTimestamps);
+            UA_free(seg);
+            continue;
+        }
+        if(!last) {
+            munmap(seg->data, seg->mapSize);
+            seg->data = NULL;
+            seg->mapSize = 0;
+            seg->writable = false;
+        }
+        seg->firstIndex = node->count;
+        node->count += seg->count;
+        node->segments[node->segmentsSize++] = seg;
+    }
+
+ cleanup:
+    UA_free(numbers);
+    node->loaded = true;
+    return res;
+}
+
+/* Create a new writable segment with room for at least minSize bytes. The file
+ * is sparse, the blocks are allocated as the records are written. */
+static UA_StatusCode
+openSegment(UA_HistoryFileContext *ctx, UA_HistoryFileNode *node, size_t minSize) {
+    UA_HistoryFileSegment **segments = (UA_HistoryFileSegment**)
+        UA_realloc(node->segments, (node->segmentsSize + 1) * sizeof(UA_HistoryFileSegment*));
+    if(!segments)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    node->segments = segments;
+
+    UA_HistoryFileSegment *seg = (UA_HistoryFileSegment*)
+        UA_calloc(1, sizeof(UA_HistoryFileSegment));
+    if(!seg)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    seg->number = (node->segmentsSize > 0) ?
+        node->segments[node->segmentsSize - 1]->number + 1 : 0;
+    seg->firstIndex = node->count;
+    size_t size = sizeof(UA_HistoryFileHeader) + minSize;
+    if(size < ctx->segmentSize)
+        size = ctx->segmentSize;
+
+    char path[PATH_MAX];
+    segmentPath(ctx, node, seg->number, path);
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0)
+        goto error;
+    if(ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        goto error;
+    }
+    void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED)
+        goto error;
+    seg->data = (UA_Byte*)data;
+    seg->mapSize = size;
+    seg->writable = true;
+    seg->used = sizeof(UA_HistoryFileHeader);
+
+    UA_HistoryFileHeader *hdr = segmentHeader(seg);
+    hdr->magic = UA_HISTORYFILE_MAGIC;
+    hdr->version = UA_HISTORYFILE_VERSION;
+    hdr->used = sizeof(UA_HistoryFileHeader);
+    hdr->count = 0;
+    hdr->first = 0;
+    hdr->last = 0;
+    node->segments[node->segmentsSize++] = seg;
+
+    /* The new directory entry is synced with the records */
+    node->dirtyDirectory = true;
+    markDirty(ctx, node);
+    return UA_STATUSCODE_GOOD;
+
+ error:
+    UA_free(seg);
+    return UA_STATUSCODE_BADINTERNALERROR;
+}
+
+/* Sync and unmap a full segment. It is mapped read-only again when it is
+ * read. */
+static void
+closeSegment(UA_HistoryFileSegment *seg) {
+    msync(seg->data, seg->used, MS_SYNC);
+    munmap(seg->data, seg->mapSize);
+    seg->data = NULL;
+    seg->mapSize = 0;
+    seg->writable = false;
+}
+
+static UA_DateTime
+lastTimestamp(const UA_HistoryFileNode *node) {
+    return node->segments[node->segmentsSize - 1]->last;
+}
+
+/* Append a record. The value is encoded directly into the mapped segment. */
+static UA_StatusCode
+appendRecord(UA_HistoryFileContext *ctx, UA_HistoryFileNode *node,
+             UA_DateTime timestamp, const UA_DataValue *value) {
+    if(node->count > 0 && timestamp < lastTimestamp(node))
+        return UA_STATUSCODE_BADHISTORYOPERATIONUNSUPPORTED;
+
+    size_t length = UA_calcSizeBinary(value, &UA_TYPES[UA_TYPES_DATAVALUE], NULL);
+    if(length == 0 || length > UA_UINT32_MAX)
+        return UA_STATUSCODE_BADENCODINGERROR;
+    size_t recordSize = UA_HISTORYFILE_RECORDHEADER + length;
+
+    /* Switch to a new segment if the record does not fit */
+    UA_HistoryFileSegment *seg = (node->segmentsSize > 0) ?
+        node->segments[node->segmentsSize - 1] : NULL;
+    if(seg && seg->writable && seg->used + recordSize > seg->mapSize)
+        closeSegment(seg);
+    if(!seg || !seg->writable) {
+        UA_StatusCode res = openSegment(ctx, node, recordSize);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        seg = node->segments[node->segmentsSize - 1];
+    }
+
+    /* Write the record */
+    UA_HistoryFileHeader *hdr = segmentHeader(seg);
+    size_t offset = seg->used;
+    UA_UInt32 length32 = (UA_UInt32)length;
+    memcpy(&seg->data[offset], &timestamp, sizeof(UA_DateTime));
+    memcpy(&seg->data[offset + sizeof(UA_DateTime)], &length32, sizeof(UA_UInt32));
+    UA_ByteString out = {length, &seg->data[offset + UA_HISTORYFILE_RECORDHEADER]};
+    UA_StatusCode res = UA_encodeBinary(value, &UA_TYPES[UA_TYPES_DATAVALUE], &out, NULL);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    if(seg->count % UA_HISTORYFILE_STRIDE == 0) {
+        res = addStride(seg, offset, timestamp);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    }
+
+    /* Commit */
+    if(seg->count == 0)
+        hdr->first = timestamp;
+    hdr->last = timestamp;
+    hdr->used = offset + recordSize;
+    hdr->count = seg->count + 1;
+    seg->last = timestamp;
+    seg->used = offset + recordSize;
+    seg->count++;
+    node->count++;
+    markDirty(ctx, node);
+    return UA_STATUSCODE_GOOD;
+}
+
+/**********/
+/* Lookup */
+/**********/
+
+/* Returns the empty node if the NodeId has no history */
+static UA_HistoryFileNode *
+lookupNode(void *context, const UA_NodeId *nodeId) {
+    UA_HistoryFileContext *ctx = (UA_HistoryFileContext*)context;
+    UA_HistoryFileNode *node = findNode(ctx, nodeId, UA_NodeId_hash(nodeId));
+    if(!node)
+        return &ctx->empty;
+    if(!node->loaded)
+        loadNode(ctx, node);
+    return node;
+}
+
+static UA_HistoryFileNode *
+getOrCreateNode(UA_HistoryFileContext *ctx, const UA_NodeId *nodeId) {
+    UA_HistoryFileNode *node = lookupNode(ctx, nodeId);
+    if(node != &ctx->empty)
+        return node;
+    return createNode(ctx, nodeId);
+}
+
+/* Position of a record in the node */
+typedef struct {
+    size_t segment;
+    size_t record; /* Record in the segment */
+    size_t offset;
+} UA_HistoryFileCursor;
+
+static UA_StatusCode
+seekIndex(UA_HistoryFileContext *ctx, const UA_HistoryFileNode *node,
+          size_t index, UA_HistoryFileCursor *c) {
+    /* Last segment starting at or before the index */
+    size_t lo = 0, hi = node->segmentsSize;
+    while(hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if(node->segments[mid]->firstIndex <= index)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    /* Walk from the sparse index entry */
+    UA_HistoryFileSegment *seg = node->segments[lo];
+    UA_StatusCode res = useSegment(ctx, node, seg);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    c->segment = lo;
+    c->record = index - seg->firstIndex;
+    c->offset = seg->strideOffsets[c->record / UA_HISTORYFILE_STRIDE];
+    for(size_t i = c->record % UA_HISTORYFILE_STRIDE; i > 0; i--)
+        c->offset = nextRecord(seg, c->offset);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* The segment of the cursor is mapped. The next segment is mapped only when
+ * its first record is decoded. */
+static void
+advanceCursor(const UA_HistoryFileNode *node, UA_HistoryFileCursor *c) {
+    const UA_HistoryFileSegment *seg = node->segments[c->segment];
+    c->record++;
+    if(c->record < seg->count) {
+        c->offset = nextRecord(seg, c->offset);
+        return;
+    }
+    c->segment++;
+    c->record = 0;
+    c->offset = sizeof(UA_HistoryFileHeader);
+}
+
+static size_t
+lowerBound(const UA_DateTime *timestamps, size_t size, UA_DateTime timestamp) {
+    size_t lo = 0;
+    while(size > 0) {
+        size_t half = size / 2;
+        if(timestamps[lo + half] < timestamp) {
+            lo += half + 1;
+            size -= half + 1;
+        } else {
+            size = half;
+        }
+    }
+    return lo;
+}
+
+/* Index of the first record that is not earlier than the timestamp */
+static size_t
+findIndex(UA_HistoryFileContext *ctx, const UA_HistoryFileNode *node,
+          UA_DateTime timestamp) {
+    /* First segment whose last record is not earlier */
+    size_t lo = 0, hi = node->segmentsSize;
+    while(lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        const UA_HistoryFileSegment *seg = node->segments[mid];
+        if(seg->count == 0 || seg->last < timestamp)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if(lo == node->segmentsSize)
+        return node->count;
+
+    /* Start at the last sparse index entry before the timestamp */
+    UA_HistoryFileSegment *seg = node->segments[lo];
+    if(useSegment(ctx, node, seg) != UA_STATUSCODE_GOOD)
+        return node->count;
+    size_t s = lowerBound(seg->strideTimestamps, seg->strideSize, timestamp);
+    if(s > 0)
+        s--;
+    size_t record = s * UA_HISTORYFILE_STRIDE;
+    size_t offset = seg->strideOffsets[s];
+    while(recordTimestamp(seg, offset) < timestamp) {
+        offset = nextRecord(seg, offset);
+        record++;
+    }
+    return seg->firstIndex + record;
+}
+
+static size_t
+findIndexAfter(UA_HistoryFileContext *ctx, const UA_HistoryFileNode *node,
+               UA_DateTime timestamp) {
+    if(timestamp == UA_INT64_MAX)
+        return node->count;
+    return findIndex(ctx, node, timestamp + 1);
+}
+
+/* Returns UA_INT64_MIN if the segment cannot be mapped */
+static UA_DateTime
+indexTimestamp(UA_HistoryFileContext *ctx, const UA_HistoryFileNode *node,
+               size_t index) {
+    UA_HistoryFileCursor c;
+    if(seekIndex(ctx, node, index, &c) != UA_STATUSCODE_GOOD)
+        return UA_INT64_MIN;
+    return recordTimestamp(node->segments[c.segment], c.offset);
+}
+
+/* Decode a DataValue from the mapped segment */
+static UA_StatusCode
+decodeRecord(UA_HistoryFileContext *ctx, const UA_HistoryFileNode *node,
+             const UA_HistoryFileCursor *c, UA_DataValue *value) {
+    UA_HistoryFileSegment *seg = node->segments[c->segment];
+    UA_StatusCode res = useSegment(ctx, node, seg);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    UA_ByteString data = recordData(seg, c->offset);
+    return UA_decodeBinary(&data, value, &UA_TYPES[UA_TYPES_DATAVALUE], NULL);
+}
+
+/*********************/
+/* Backend Interface */
+/*********************/
+
+static UA_DateTime
+sampleTimestamp(const UA_DataValue *value) {
+    if(value->hasSourceTimestamp)
+        return value->sourceTimestamp;
+    if(value->hasServerTimestamp)
+        return value->serverTimestamp;
+    return UA_DateTime_now();
+}
+
+static UA_StatusCode
+storeValue(UA_HistoryFileContext *ctx, const UA_NodeId *nodeId,
+           UA_DateTime timestamp, const UA_DataValue *value) {
+    UA_HistoryFileNode *node = getOrCreateNode(ctx, nodeId);
+    if(!node)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* Add the server timestamp if missing. A shallow copy suffices. */
+    UA_DataValue stored = *value;
+    if(!stored.hasServerTimestamp) {
+        stored.serverTimestamp = timestamp;
+        stored.hasServerTimestamp = true;
+    }
+    UA_StatusCode res = appendRecord(ctx, node, timestamp, &stored);
+    if(res == UA_STATUSCODE_GOOD)
+        checkSync(ctx);
+    return res;
+}
+
+static UA_StatusCode
+serverSetHistoryData_backend_file(UA_Server *server,
+                                  void *context,
+                                  const UA_NodeId *sessionId,
+                                  void *sessionContext,
+                                  const UA_NodeId *nodeId,
+                                  UA_Boolean historizing,
+                                  const UA_DataValue *value) {
+    return storeValue((UA_HistoryFileContext*)context, nodeId,
+                      sampleTimestamp(value), value);
+}
+
+static size_t
+getDateTimeMatch_backend_file(UA_Server *server,
+                              void *context,
+                              const UA_NodeId *sessionId,
+                              void *sessionContext,
+                              const UA_NodeId *nodeId,
+                              const UA_DateTime timestamp,
+                              const MatchStrategy strategy) {
+    UA_HistoryFileContext *ctx = (UA_HistoryFileContext*)context;
+    const UA_HistoryFileNode *node = lookupNode(context, nodeId);
+    size_t index;
+    switch(strategy) {
+    case MATCH_EQUAL:
+        index = findIndex(ctx, node, timestamp);
+        if(index < node->count && indexTimestamp(ctx, node, index) == timestamp)
+            return index;
+        return node->count;
+    case MATCH_EQUAL_OR_AFTER:
+        return findIndex(ctx, node, timestamp);
+    case MATCH_AFTER:
+        return findIndexAfter(ctx, node, timestamp);
+    case MATCH_EQUAL_OR_BEFORE:
+        index = findIndexAfter(ctx, node, timestamp);
+        return (index > 0) ? index - 1 : node->count;
+    case MATCH_BEFORE:
+        index = findIndex(ctx, node, timestamp);
+        return (index > 0) ? index - 1 : node->count;
+    default:
+        return node->count;
+    }
+}
+
+static size_t
+resultSize_backend_file(UA_Server *server,
+                        void *context,
+                        const UA_NodeId *sessionId,
+                        void *sessionContext,
+                        const UA_NodeId *nodeId,
+                        size_t startIndex,
+                        size_t endIndex) {
+    const UA_HistoryFileNode *node = lookupNode(context, nodeId);
+    if(node->count == 0 || startIndex == node->count || endIndex == node->count)
+        return 0;
+    return endIndex - startIndex + 1;
+}
+
+static size_t
+getEnd_backend_file(UA_Server *server,
+                    void *context,
+                    const UA_NodeId *sessionId,
+                    void *sessionContext,
+                    const UA_NodeId *nodeId) {
+    return lookupNode(context, nodeId)->count;
+}
+
+static size_t
+lastIndex_backend_file(UA_Server *server,
+                       void *context,
+                       const UA_NodeId *sessionId,
+                       void *sessionContext,
+                       const UA_NodeId *nodeId) {
+    const UA_HistoryFileNode *node = lookupNode(context, nodeId);
+    if(node->count == 0)
+        return 0;
+    return node->count - 1;
+}
+
+static size_t
+firstIndex_backend_file(UA_Server *server,
+                        void *context,
+                        const UA_NodeId *sessionId,
+                        void *sessionContext,
+                        const UA_NodeId *nodeId) {
+    return 0;
+}
+
+static UA_Boolean
+boundSupported_backend_file(UA_Server *server,
+                            void *context,
+                            const UA_NodeId *sessionId,
+                            void *sessionContext,
+                            const UA_NodeId *nodeId) {
+    return true;
+}
+
+/* The returned value is valid until the next call */
+static const UA_DataValue *
+getDataValue_backend_file(UA_Server *server,
+                          void *context,
+                          const UA_NodeId *sessionId,
+                          void *sessionContext,
+                          const UA_NodeId *nodeId,
+                          size_t index) {
+    UA_HistoryFileContext *ctx = (UA_HistoryFileContext*)context;
+    const UA_HistoryFileNode *node = lookupNode(context, nodeId);
+    UA_DataValue_clear(&ctx->cache);
+    if(index >= node->count)
+        return &ctx->cache;
+    UA_HistoryFileCursor c;
+    if(seekIndex(ctx, node, index, &c) == UA_STATUSCODE_GOOD)
+        decodeRecord(ctx, node, &c, &ctx->cache);
+    return &ctx->cache;
+}
+
+static UA_Boolean
+timestampsToReturnSupported_backend_file(UA_Server *server,
+                                         void *context,
+                                         const UA_NodeId *sessionId,
+                                         void *sessionContext,
+                                         const UA_NodeId *nodeId,
+                                         const UA_TimestampsToReturn timestampsToReturn) {
+    const UA_HistoryFileNode *node = lookupNode(context, nodeId);
+    if(node->count == 0)
+        return true;
+    const UA_DataValue *first =
+        getDataValue_backend_file(server, context, sessionId, sessionContext, nodeId, 0);
+    if(timestampsToReturn == UA_TIMESTAMPSTORETURN_NEITHER ||
+       timestampsToReturn == UA_TIMESTAMPSTORETURN_INVALID ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_SERVER &&
+        !first->hasServerTimestamp) ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_SOURCE &&
+        !first->hasSourceTimestamp) ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_BOTH &&
+        !(first->hasSourceTimestamp && first->hasServerTimestamp)))
+        return false;
+    return true;
+}
+
+static UA_StatusCode
+copyDataValues_backend_file(UA_Server *server,
+                            void *context,
+                            const UA_NodeId *sessionId,
+                            void *sessionContext,
+                            const UA_NodeId *nodeId,
+                            size_t startIndex,
+                            size_t endIndex,
+                            UA_Boolean reverse,
+                            size_t maxValues,
+                            UA_NumericRange range,
+                            UA_Boolean releaseContinuationPoints,
+                            const UA_ByteString *continuationPoint,
+                            UA_ByteString *outContinuationPoint,
+                            size_t *providedValues,
+                            UA_DataValue *values) {
+    size_t skip = 0;
+    if(continuationPoint->length > 0) {
+        if(continuationPoint->length != sizeof(size_t))
+            return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+        memcpy(&skip, continuationPoint->data, sizeof(size_t));
+    }
+
+    UA_HistoryFileContext *ctx = (UA_HistoryFileContext*)context;
+    const UA_HistoryFileNode *node = lookupNode(context, nodeId);
+    size_t available = reverse ? startIndex - endIndex + 1 : endIndex - startIndex + 1;
+    size_t counter = 0;
+    if(skip < available) {
+        counter = available - skip;
+        if(counter > maxValues)
+            counter = maxValues;
+    }
+
+    /* The requested records are contiguous. Seek once and decode them in
+     * ascending order from the mapping. In reverse mode, the output array is
+     * filled from the back. */
+    if(counter > 0) {
+        size_t first = reverse ? startIndex - skip - counter + 1 : startIndex + skip;
+        UA_HistoryFileCursor c;
+        UA_StatusCode res = seekIndex(ctx, node, first, &c);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        for(size_t i = 0; i < counter; i++) {
+            UA_DataValue *out = &values[reverse ? counter - 1 - i : i];
+            if(range.dimensionsSize == 0) {
+                res = decodeRecord(ctx, node, &c, out);
+            } else {
+                UA_DataValue tmp;
+                res = decodeRecord(ctx, node, &c, &tmp);
+                if(res == UA_STATUSCODE_GOOD) {
+                    *out = tmp;
+                    UA_Variant_init(&out->value);
+                    if(tmp.hasValue)
+                        UA_Variant_copyRange(&tmp.value, &out->value, range);
+                    UA_Variant_clear(&tmp.value);
+                }
+            }
+            if(res != UA_STATUSCODE_GOOD)
+                return res;
+            advanceCursor(node, &c);
+        }
+    }
+
+    if(providedValues)
+        *providedValues = counter;
+
+    if(skip + counter < available) {
+        UA_StatusCode res = UA_ByteString_allocBuffer(outContinuationPoint, sizeof(size_t));
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        size_t next = skip + counter;
+        memcpy(outContinuationPoint->data, &next, sizeof(size_t));
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Only appending is possible. Earlier values cannot be inserted. */
+static UA_StatusCode
+insertDataValue_backend_file(UA_Server *server,
+                             void *hdbContext,
+                             const UA_NodeId *sessionId,
+                             void *sessionContext,
+                             const UA_NodeId *nodeId,
+                             const UA_DataValue *value) {
+    if(!value->hasSourceTimestamp && !value->hasServerTimestamp)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMP;
+    UA_HistoryFileContext *ctx = (UA_HistoryFileContext*)hdbContext;
+    const UA_DateTime timestamp = sampleTimestamp(value);
+    const UA_HistoryFileNode *node = lookupNode(ctx, nodeId);
+    if(node->count > 0 && lastTimestamp(node) == timestamp)
+        return UA_STATUSCODE_BADENTRYEXISTS;
+    return storeValue(ctx, nodeId, timestamp, value);
+}
+
+static void
+deleteMembers_backend_file(UA_HistoryDataBackend *backend) {
+    if(backend == NULL || backend->context == NULL)
+        return;
+    UA_HistoryFileContext_delete((UA_HistoryFileContext*)backend->context);
+    backend->context = NULL;
+}
+
+UA_HistoryDataBackend
+UA_HistoryDataBackend_File(const char *directory, size_t segmentSize,
+                           UA_UInt32 syncInterval) {
+    UA_HistoryDataBackend result;
+    memset(&result, 0, sizeof(UA_HistoryDataBackend));
+    if(!directory)
+        return result;
+    if(segmentSize == 0)
+        segmentSize = UA_HISTORYDATABACKEND_FILE_SEGMENTSIZE;
+
+    UA_HistoryFileContext *ctx = (UA_HistoryFileContext*)
+        UA_calloc(1, sizeof(UA_HistoryFileContext));
+    if(!ctx)
+        return result;
+    TAILQ_INIT(&ctx->mapped);
+    ctx->catalogFd = -1;
+    ctx->segmentSize = segmentSize;
+    ctx->syncInterval = (UA_DateTime)syncInterval * UA_DATETIME_MSEC;
+    ctx->lastSync = UA_DateTime_nowMonotonic();
+    size_t len = strlen(directory);
+    ctx->directory = (char*)UA_malloc(len + 1);
+    ctx->nodesSize = 64;
+    ctx->nodes = (UA_HistoryFileNode**)
+        UA_calloc(ctx->nodesSize, sizeof(UA_HistoryFileNode*));
+    if(!ctx->directory || !ctx->nodes)
+        goto error;
+    memcpy(ctx->directory, directory, len + 1);
+
+    /* Open the store */
+    if(mkdir(directory, 0755) != 0 && errno != EEXIST)
+        goto error;
+    char path[PATH_MAX];
+    mp_snprintf(path, PATH_MAX, "%s/nodes", directory);
+    ctx->catalogFd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if(ctx->catalogFd < 0 || readCatalog(ctx) != UA_STATUSCODE_GOOD)
+        goto error;
+    ctx->dirtyCatalog = true; /* The catalog file may be new */
+
+    result.serverSetHistoryData = &serverSetHistoryData_backend_file;
+    result.resultSize = &resultSize_backend_file;
+    result.getEnd = &getEnd_backend_file;
+    result.lastIndex = &lastIndex_backend_file;
+    result.firstIndex = &firstIndex_backend_file;
+    result.getDateTimeMatch = &getDateTimeMatch_backend_file;
+    result.copyDataValues = &copyDataValues_backend_file;
+    result.getDataValue = &getDataValue_backend_file;
+    result.boundSupported = &boundSupported_backend_file;
+    result.timestampsToReturnSupported = &timestampsToReturnSupported_backend_file;
+    result.insertDataValue = &insertDataValue_backend_file;
+    result.updateDataValue = NULL;
+    result.replaceDataValue = NULL;
+    result.removeDataValue = NULL;
+    result.deleteMembers = &deleteMembers_backend_file;
+    result.getHistoryData = NULL;
+    result.context = ctx;
+    return result;
+
+ error:
+    UA_HistoryFileContext_delete(ctx);
+    return result;
+}
+
+UA_StatusCode
+UA_HistoryDataBackend_File_sync(UA_HistoryDataBackend *backend) {
+    if(!backend || !backend->context)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return syncStore((UA_HistoryFileContext*)backend->context);
+}
+
+void
+UA_HistoryDataBackend_File_clear(UA_HistoryDataBackend *backend) {
+    deleteMembers_backend_file(backend);
+    memset(backend, 0, sizeof(UA_HistoryDataBackend));
+}
+
+#endif /* UA_ARCHITECTURE_POSIX */
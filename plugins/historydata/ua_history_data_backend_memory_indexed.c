@@ -0,0 +1,732 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/historydata/history_data_backend_memory.h>
+
+#include <string.h>
+
+/* In-memory history backend for many historized nodes.
+ *
+ * - The nodes are found with an open-addressing hash table over the NodeId
+ *   hash. The node entries are allocated individually so that pointers to them
+ *   remain stable when the table grows.
+ * - The samples of a node are kept sorted by timestamp in two contiguous
+ *   columns. The timestamp column is the search key and is scanned without
+ *   touching the DataValues. The columns are used as a ring buffer. The oldest
+ *   sample is dropped when a bounded store is full.
+ * - Samples arriving in order are appended in O(1). Out-of-order samples are
+ *   shifted into place.
+ *
+ * The indices of the low-level backend API are logical positions in the ring,
+ * counted from the oldest sample. */
+
+typedef struct {
+    UA_NodeId nodeId;
+    UA_UInt32 hash;
+    size_t head;     /* Physical position of the oldest sample */
+    size_t count;    /* Number of stored samples */
+    size_t capacity; /* Allocated length of the columns */
+    UA_DateTime *timestamps;
+    UA_DataValue *values;
+} UA_MemoryIndexedNode;
+
+typedef struct {
+    UA_MemoryIndexedNode **nodes; /* Hash table, size is a power of two */
+    size_t nodesSize;
+    size_t nodesCount;
+    size_t initialStoreSize;
+    size_t maxStoreSize; /* 0 for unbounded */
+    UA_MemoryIndexedNode empty; /* Returned for unknown nodes during reads */
+} UA_MemoryIndexedContext;
+
+static size_t
+physIndex(const UA_MemoryIndexedNode *node, size_t index) {
+    size_t pos = node->head + index;
+    if(pos >= node->capacity)
+        pos -= node->capacity;
+    return pos;
+}
+
+static void
+UA_MemoryIndexedNode_delete(UA_MemoryIndexedNode *node) {
+    for(size_t i = 0; i < node->count; i++)
+        UA_DataValue_clear(&node->values[physIndex(node, i)]);
+    UA_free(node->timestamps);
+    UA_free(node->values);
+    UA_NodeId_clear(&node->nodeId);
+    UA_free(node);
+}
+
+static void
+UA_MemoryIndexedContext_delete(UA_MemoryIndexedContext *ctx) {
+    for(size_t i = 0; i < ctx->nodesSize; i++) {
+        if(ctx->nodes[i])
+            UA_MemoryIndexedNode_delete(ctx->nodes[i]);
+    }
+    UA_free(ctx->nodes);
+    UA_free(ctx);
+}
+
+/****************/
+/* NodeId Index */
+/****************/
+
+static UA_MemoryIndexedNode *
+findNode(const UA_MemoryIndexedContext *ctx, const UA_NodeId *nodeId,
+         UA_UInt32 hash) {
+    size_t mask = ctx->nodesSize - 1;
+    for(size_t i = hash & mask; ctx->nodes[i]; i = (i + 1) & mask) {
+        UA_MemoryIndexedNode *node = ctx->nodes[i];
+        if(node->hash == hash && UA_NodeId_equal(&node->nodeId, nodeId))
+            return node;
+    }
+    return NULL;
+}
+
+static void
+insertNodeEntry(UA_MemoryIndexedNode **nodes, size_t nodesSize,
+                UA_MemoryIndexedNode *node) {
+    size_t mask = nodesSize - 1;
+    size_t i = node->hash & mask;
+    while(nodes[i])
+        i = (i + 1) & mask;
+    nodes[i] = node;
+}
+
+static UA_StatusCode
+growIndex(UA_MemoryIndexedContext *ctx) {
+    size_t newSize = ctx->nodesSize * 2;
+    UA_MemoryIndexedNode **nodes = (UA_MemoryIndexedNode**)
+        UA_calloc(newSize, sizeof(UA_MemoryIndexedNode*));
+    if(!nodes)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    for(size_t i = 0; i < ctx->nodesSize; i++) {
+        if(ctx->nodes[i])
+            insertNodeEntry(nodes, newSize, ctx->nodes[i]);
+    }
+    UA_free(ctx->nodes);
+    ctx->nodes = nodes;
+    ctx->nodesSize = newSize;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Returns the empty node if the NodeId has no history yet */
+static const UA_MemoryIndexedNode *
+lookupNode(void *context, const UA_NodeId *nodeId) {
+    UA_MemoryIndexedContext *ctx = (UA_MemoryIndexedContext*)context;
+    UA_MemoryIndexedNode *node = findNode(ctx, nodeId, UA_NodeId_hash(nodeId));
+    return (node) ? node : &ctx->empty;
+}
+
+static UA_MemoryIndexedNode *
+getOrAddNode(UA_MemoryIndexedContext *ctx, const UA_NodeId *nodeId) {
+    UA_UInt32 hash = UA_NodeId_hash(nodeId);
+    UA_MemoryIndexedNode *node = findNode(ctx, nodeId, hash);
+    if(node)
+        return node;
+
+    /* Keep the load factor below 3/4 */
+    if((ctx->nodesCount + 1) * 4 > ctx->nodesSize * 3 &&
+       growIndex(ctx) != UA_STATUSCODE_GOOD)
+        return NULL;
+
+    node = (UA_MemoryIndexedNode*)UA_calloc(1, sizeof(UA_MemoryIndexedNode));
+    if(!node)
+        return NULL;
+    node->timestamps = (UA_DateTime*)
+        UA_malloc(ctx->initialStoreSize * sizeof(UA_DateTime));
+    node->values = (UA_DataValue*)
+        UA_malloc(ctx->initialStoreSize * sizeof(UA_DataValue));
+    if(!node->timestamps || !node->values ||
+       UA_NodeId_copy(nodeId, &node->nodeId) != UA_STATUSCODE_GOOD) {
+        UA_free(node->timestamps);
+        UA_free(node->values);
+        UA_free(node);
+        return NULL;
+    }
+    node->hash = hash;
+    node->capacity = ctx->initialStoreSize;
+    insertNodeEntry(ctx->nodes, ctx->nodesSize, node);
+    ctx->nodesCount++;
+    return node;
+}
+
+/****************/
+/* Sample Store */
+/****************/
+
+/* Reallocate the columns. The samples are moved to the front. */
+static UA_StatusCode
+resizeNode(UA_MemoryIndexedNode *node, size_t newCapacity) {
+    UA_assert(newCapacity >= node->count);
+    UA_DateTime *timestamps = (UA_DateTime*)
+        UA_malloc(newCapacity * sizeof(UA_DateTime));
+    UA_DataValue *values = (UA_DataValue*)
+        UA_malloc(newCapacity * sizeof(UA_DataValue));
+    if(!timestamps || !values) {
+        UA_free(timestamps);
+        UA_free(values);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    /* Copy the (up to) two segments of the ring */
+    if(node->count > 0) {
+        size_t first = node->capacity - node->head;
+        if(first > node->count)
+            first = node->count;
+        memcpy(timestamps, &node->timestamps[node->head], first * sizeof(UA_DateTime));
+        memcpy(&timestamps[first], node->timestamps,
+               (node->count - first) * sizeof(UA_DateTime));
+        memcpy(values, &node->values[node->head], first * sizeof(UA_DataValue));
+        memcpy(&values[first], node->values,
+               (node->count - first) * sizeof(UA_DataValue));
+    }
+
+    UA_free(node->timestamps);
+    UA_free(node->values);
+    node->timestamps = timestamps;
+    node->values = values;
+    node->capacity = newCapacity;
+    node->head = 0;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Ensure the capacity for minCapacity samples. Bounded stores don't grow beyond
+ * their maximum size. */
+static UA_StatusCode
+reserveNode(const UA_MemoryIndexedContext *ctx, UA_MemoryIndexedNode *node,
+            size_t minCapacity) {
+    if(ctx->maxStoreSize > 0 && minCapacity > ctx->maxStoreSize)
+        minCapacity = ctx->maxStoreSize;
+    if(node->capacity >= minCapacity)
+        return UA_STATUSCODE_GOOD;
+    size_t newCapacity = node->capacity * 2;
+    if(newCapacity < minCapacity)
+        newCapacity = minCapacity;
+    if(ctx->maxStoreSize > 0 && newCapacity > ctx->maxStoreSize)
+        newCapacity = ctx->maxStoreSize;
+    return resizeNode(node, newCapacity);
+}
+
+/* Branchless lower bound in a contiguous timestamp column. Returns the index of
+ * the first timestamp that is not earlier than the searched timestamp. */
+static size_t
+lowerBound(const UA_DateTime *timestamps, size_t size, UA_DateTime timestamp) {
+    if(size == 0)
+        return 0;
+    const UA_DateTime *base = timestamps;
+    while(size > 1) {
+        size_t half = size / 2;
+        base = (base[half] < timestamp) ? base + half : base;
+        size -= half;
+    }
+    return (size_t)(base - timestamps) + (*base < timestamp);
+}
+
+/* Lower bound across the (up to) two segments of the ring */
+static size_t
+findIndex(const UA_MemoryIndexedNode *node, UA_DateTime timestamp) {
+    if(node->count == 0)
+        return 0;
+    size_t first = node->capacity - node->head;
+    if(first >= node->count)
+        return lowerBound(&node->timestamps[node->head], node->count, timestamp);
+    if(timestamp <= node->timestamps[node->capacity - 1])
+        return lowerBound(&node->timestamps[node->head], first, timestamp);
+    return first + lowerBound(node->timestamps, node->count - first, timestamp);
+}
+
+/* Index of the first sample later than the timestamp */
+static size_t
+findIndexAfter(const UA_MemoryIndexedNode *node, UA_DateTime timestamp) {
+    if(timestamp == UA_INT64_MAX)
+        return node->count;
+    return findIndex(node, timestamp + 1);
+}
+
+static UA_DateTime
+getTimestamp(const UA_MemoryIndexedNode *node, size_t index) {
+    return node->timestamps[physIndex(node, index)];
+}
+
+static void
+dropOldest(UA_MemoryIndexedNode *node) {
+    UA_DataValue_clear(&node->values[node->head]);
+    node->head = physIndex(node, 1);
+    node->count--;
+}
+
+/* Takes ownership of the DataValue content. If a bounded store is full, the
+ * oldest sample is dropped. A sample older than everything in a full store is
+ * discarded. */
+static UA_StatusCode
+storeSample(const UA_MemoryIndexedContext *ctx, UA_MemoryIndexedNode *node,
+            UA_DateTime timestamp, UA_DataValue *value) {
+    if(ctx->maxStoreSize > 0 && node->count >= ctx->maxStoreSize) {
+        if(timestamp < getTimestamp(node, 0)) {
+            UA_DataValue_clear(value);
+            return UA_STATUSCODE_GOOD;
+        }
+        dropOldest(node);
+    } else {
+        UA_StatusCode res = reserveNode(ctx, node, node->count + 1);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_DataValue_clear(value);
+            return res;
+        }
+    }
+
+    /* Shift later samples up by one if the sample arrived out of order */
+    size_t index = node->count;
+    if(node->count > 0 && timestamp < getTimestamp(node, node->count - 1)) {
+        index = findIndexAfter(node, timestamp);
+        for(size_t i = node->count; i > index; i--) {
+            size_t dst = physIndex(node, i);
+            size_t src = physIndex(node, i - 1);
+            node->timestamps[dst] = node->timestamps[src];
+            node->values[dst] = node->values[src];
+        }
+    }
+
+    size_t pos = physIndex(node, index);
+    node->timestamps[pos] = timestamp;
+    node->values[pos] = *value;
+    node->count++;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Copy the value and add the server timestamp if missing */
+static UA_StatusCode
+prepareSample(const UA_DataValue *value, UA_DateTime timestamp,
+              UA_DataValue *out) {
+    UA_StatusCode res = UA_DataValue_copy(value, out);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    if(!out->hasServerTimestamp) {
+        out->serverTimestamp = timestamp;
+        out->hasServerTimestamp = true;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_DateTime
+sampleTimestamp(const UA_DataValue *value) {
+    if(value->hasSourceTimestamp)
+        return value->sourceTimestamp;
+    if(value->hasServerTimestamp)
+        return value->serverTimestamp;
+    return UA_DateTime_now();
+}
+
+/*********************/
+/* Backend Interface */
+/*********************/
+
+static UA_StatusCode
+serverSetHistoryData_backend_memory_indexed(UA_Server *server,
+                                            void *context,
+                                            const UA_NodeId *sessionId,
+                                            void *sessionContext,
+                                            const UA_NodeId *nodeId,
+                                            UA_Boolean historizing,
+                                            const UA_DataValue *value) {
+    UA_MemoryIndexedContext *ctx = (UA_MemoryIndexedContext*)context;
+    UA_MemoryIndexedNode *node = getOrAddNode(ctx, nodeId);
+    if(!node)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_DateTime timestamp = sampleTimestamp(value);
+    UA_DataValue sample;
+    UA_StatusCode res = prepareSample(value, timestamp, &sample);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    return storeSample(ctx, node, timestamp, &sample);
+}
+
+static size_t
+getDateTimeMatch_backend_memory_indexed(UA_Server *server,
+                                        void *context,
+                                        const UA_NodeId *sessionId,
+                                        void *sessionContext,
+                                        const UA_NodeId *nodeId,
+                                        const UA_DateTime timestamp,
+                                        const MatchStrategy strategy) {
+    const UA_MemoryIndexedNode *node = lookupNode(context, nodeId);
+    size_t index;
+    switch(strategy) {
+    case MATCH_EQUAL:
+        index = findIndex(node, timestamp);
+        if(index < node->count && getTimestamp(node, index) == timestamp)
+            return index;
+        return node->count;
+    case MATCH_EQUAL_OR_AFTER:
+        return findIndex(node, timestamp);
+    case MATCH_AFTER:
+        return findIndexAfter(node, timestamp);
+    case MATCH_EQUAL_OR_BEFORE:
+        index = findIndexAfter(node, timestamp);
+        return (index > 0) ? index - 1 : node->count;
+    case MATCH_BEFORE:
+        index = findIndex(node, timestamp);
+        return (index > 0) ? index - 1 : node->count;
+    default:
+        return node->count;
+    }
+}
+
+static size_t
+resultSize_backend_memory_indexed(UA_Server *server,
+                                  void *context,
+                                  const UA_NodeId *sessionId,
+                                  void *sessionContext,
+                                  const UA_NodeId *nodeId,
+                                  size_t startIndex,
+                                  size_t endIndex) {
+    const UA_MemoryIndexedNode *node = lookupNode(context, nodeId);
+    if(node->count == 0 || startIndex == node->count || endIndex == node->count)
+        return 0;
+    return endIndex - startIndex + 1;
+}
+
+static size_t
+getEnd_backend_memory_indexed(UA_Server *server,
+                              void *context,
+                              const UA_NodeId *sessionId,
+                              void *sessionContext,
+                              const UA_NodeId *nodeId) {
+    return lookupNode(context, nodeId)->count;
+}
+
+static size_t
+lastIndex_backend_memory_indexed(UA_Server *server,
+                                 void *context,
+                                 const UA_NodeId *sessionId,
+                                 void *sessionContext,
+                                 const UA_NodeId *nodeId) {
+    const UA_MemoryIndexedNode *node = lookupNode(context, nodeId);
+    if(node->count == 0)
+        return 0;
+    return node->count - 1;
+}
+
+static size_t
+firstIndex_backend_memory_indexed(UA_Server *server,
+                                  void *context,
+                                  const UA_NodeId *sessionId,
+                                  void *sessionContext,
+                                  const UA_NodeId *nodeId) {
+    return 0;
+}
+
+static UA_Boolean
+boundSupported_backend_memory_indexed(UA_Server *server,
+                                      void *context,
+                                      const UA_NodeId *sessionId,
+                                      void *sessionContext,
+                                      const UA_NodeId *nodeId) {
+    return true;
+}
+
+static UA_Boolean
+timestampsToReturnSupported_backend_memory_indexed(UA_Server *server,
+                                                   void *context,
+                                                   const UA_NodeId *sessionId,
+                                                   void *sessionContext,
+                                                   const UA_NodeId *nodeId,
+                                                   const UA_TimestampsToReturn timestampsToReturn) {
+    const UA_MemoryIndexedNode *node = lookupNode(context, nodeId);
+    if(node->count == 0)
+        return true;
+    const UA_DataValue *first = &node->values[node->head];
+    if(timestampsToReturn == UA_TIMESTAMPSTORETURN_NEITHER ||
+       timestampsToReturn == UA_TIMESTAMPSTORETURN_INVALID ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_SERVER &&
+        !first->hasServerTimestamp) ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_SOURCE &&
+        !first->hasSourceTimestamp) ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_BOTH &&
+        !(first->hasSourceTimestamp && first->hasServerTimestamp)))
+        return false;
+    return true;
+}
+
+static const UA_DataValue*
+getDataValue_backend_memory_indexed(UA_Server *server,
+                                    void *context,
+                                    const UA_NodeId *sessionId,
+                                    void *sessionContext,
+                                    const UA_NodeId *nodeId,
+                                    size_t index) {
+    const UA_MemoryIndexedNode *node = lookupNode(context, nodeId);
+    return &node->values[physIndex(node, index)];
+}
+
+static void
+copySample(const UA_DataValue *src, UA_DataValue *dst,
+           const UA_NumericRange range) {
+    if(range.dimensionsSize == 0) {
+        UA_DataValue_copy(src, dst);
+        return;
+    }
+    memcpy(dst, src, sizeof(UA_DataValue));
+    if(src->hasValue)
+        UA_Variant_copyRange(&src->value, &dst->value, range);
+}
+
+static UA_StatusCode
+copyDataValues_backend_memory_indexed(UA_Server *server,
+                                      void *context,
+                                      const UA_NodeId *sessionId,
+                                      void *sessionContext,
+                                      const UA_NodeId *nodeId,
+                                      size_t startIndex,
+                                      size_t endIndex,
+                                      UA_Boolean reverse,
+                                      size_t maxValues,
+                                      UA_NumericRange range,
+                                      UA_Boolean releaseContinuationPoints,
+                                      const UA_ByteString *continuationPoint,
+                                      UA_ByteString *outContinuationPoint,
+                                      size_t *providedValues,
+                                      UA_DataValue *values) {
+    size_t skip = 0;
+    if(continuationPoint->length > 0) {
+        if(continuationPoint->length != sizeof(size_t))
+            return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+        memcpy(&skip, continuationPoint->data, sizeof(size_t));
+    }
+
+    /* The indices are continuous. Skip directly to the first value. */
+    const UA_MemoryIndexedNode *node = lookupNode(context, nodeId);
+    size_t available = reverse ? startIndex - endIndex + 1 : endIndex - startIndex + 1;
+    size_t counter = 0;
+    if(skip < available) {
+        counter = available - skip;
+        if(counter > maxValues)
+            counter = maxValues;
+        for(size_t i = 0; i < counter; i++) {
+            size_t index = reverse ? startIndex - skip - i : startIndex + skip + i;
+            copySample(&node->values[physIndex(node, index)], &values[i], range);
+        }
+    }
+
+    if(providedValues)
+        *providedValues = counter;
+
+    if(skip + counter < available) {
+        UA_StatusCode res = UA_ByteString_allocBuffer(outContinuationPoint, sizeof(size_t));
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        size_t next = skip + counter;
+        memcpy(outContinuationPoint->data, &next, sizeof(size_t));
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+insertDataValue_backend_memory_indexed(UA_Server *server,
+                                       void *hdbContext,
+                                       const UA_NodeId *sessionId,
+                                       void *sessionContext,
+                                       const UA_NodeId *nodeId,
+                                       const UA_DataValue *value) {
+    if(!value->hasSourceTimestamp && !value->hasServerTimestamp)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMP;
+    const UA_DateTime timestamp = sampleTimestamp(value);
+    UA_MemoryIndexedContext *ctx = (UA_MemoryIndexedContext*)hdbContext;
+    UA_MemoryIndexedNode *node = getOrAddNode(ctx, nodeId);
+    if(!node)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    size_t index = findIndex(node, timestamp);
+    if(index < node->count && getTimestamp(node, index) == timestamp)
+        return UA_STATUSCODE_BADENTRYEXISTS;
+    UA_DataValue sample;
+    UA_StatusCode res = prepareSample(value, timestamp, &sample);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    return storeSample(ctx, node, timestamp, &sample);
+}
+
+static UA_StatusCode
+replaceDataValue_backend_memory_indexed(UA_Server *server,
+                                        void *hdbContext,
+                                        const UA_NodeId *sessionId,
+                                        void *sessionContext,
+                                        const UA_NodeId *nodeId,
+                                        const UA_DataValue *value) {
+    if(!value->hasSourceTimestamp && !value->hasServerTimestamp)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMP;
+    const UA_DateTime timestamp = sampleTimestamp(value);
+    UA_MemoryIndexedContext *ctx = (UA_MemoryIndexedContext*)hdbContext;
+    UA_MemoryIndexedNode *node = findNode(ctx, nodeId, UA_NodeId_hash(nodeId));
+    if(!node)
+        return UA_STATUSCODE_BADNOENTRYEXISTS;
+    size_t index = findIndex(node, timestamp);
+    if(index == node->count || getTimestamp(node, index) != timestamp)
+        return UA_STATUSCODE_BADNOENTRYEXISTS;
+    UA_DataValue sample;
+    UA_StatusCode res = prepareSample(value, timestamp, &sample);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    size_t pos = physIndex(node, index);
+    UA_DataValue_clear(&node->values[pos]);
+    node->values[pos] = sample;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+updateDataValue_backend_memory_indexed(UA_Server *server,
+                                       void *hdbContext,
+                                       const UA_NodeId *sessionId,
+                                       void *sessionContext,
+                                       const UA_NodeId *nodeId,
+                                       const UA_DataValue *value) {
+    UA_StatusCode res =
+        replaceDataValue_backend_memory_indexed(server, hdbContext, sessionId,
+                                                sessionContext, nodeId, value);
+    if(res == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOODENTRYREPLACED;
+    res = insertDataValue_backend_memory_indexed(server, hdbContext, sessionId,
+                                                 sessionContext, nodeId, value);
+    if(res == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOODENTRYINSERTED;
+    return res;
+}
+
+static UA_StatusCode
+removeDataValue_backend_memory_indexed(UA_Server *server,
+                                       void *hdbContext,
+                                       const UA_NodeId *sessionId,
+                                       void *sessionContext,
+                                       const UA_NodeId *nodeId,
+                                       UA_DateTime startTimestamp,
+                                       UA_DateTime endTimestamp) {
+    if(startTimestamp > endTimestamp)
+        return UA_STATUSCODE_BADTIMESTAMPNOTSUPPORTED;
+    UA_MemoryIndexedContext *ctx = (UA_MemoryIndexedContext*)hdbContext;
+    UA_MemoryIndexedNode *node = findNode(ctx, nodeId, UA_NodeId_hash(nodeId));
+    if(!node)
+        return UA_STATUSCODE_BADNODATA;
+
+    /* The samples [first, last) are removed. The end timestamp is exclusive
+     * unless a single timestamp is given. */
+    size_t first = findIndex(node, startTimestamp);
+    size_t last = (startTimestamp == endTimestamp) ?
+        findIndexAfter(node, endTimestamp) : findIndex(node, endTimestamp);
+    if(first >= last)
+        return UA_STATUSCODE_BADNODATA;
+
+    for(size_t i = first; i < last; i++)
+        UA_DataValue_clear(&node->values[physIndex(node, i)]);
+
+    /* Removing from the front only moves the head */
+    size_t removed = last - first;
+    if(first == 0) {
+        node->head = physIndex(node, removed);
+    } else {
+        for(size_t i = last; i < node->count; i++) {
+            size_t dst = physIndex(node, i - removed);
+            size_t src = physIndex(node, i);
+            node->timestamps[dst] = node->timestamps[src];
+            node->values[dst] = node->values[src];
+        }
+    }
+    node->count -= removed;
+    if(node->count == 0)
+        node->head = 0;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+deleteMembers_backend_memory_indexed(UA_HistoryDataBackend *backend) {
+    if(backend == NULL || backend->context == NULL)
+        return;
+    UA_MemoryIndexedContext_delete((UA_MemoryIndexedContext*)backend->context);
+    backend->context = NULL;
+}
+
+UA_HistoryDataBackend
+UA_HistoryDataBackend_Memory_Indexed(size_t initialNodeIdStoreSize,
+                                     size_t initialDataStoreSize,
+                                     size_t maxDataStoreSize) {
+    UA_HistoryDataBackend result;
+    memset(&result, 0, sizeof(UA_HistoryDataBackend));
+    if(initialDataStoreSize == 0)
+        initialDataStoreSize = 1;
+    if(maxDataStoreSize > 0 && initialDataStoreSize > maxDataStoreSize)
+        initialDataStoreSize = maxDataStoreSize;
+
+    /* Size the hash table for the expected number of nodes */
+    size_t nodesSize = 8;
+    while(nodesSize * 3 < initialNodeIdStoreSize * 4)
+        nodesSize *= 2;
+
+    UA_MemoryIndexedContext *ctx = (UA_MemoryIndexedContext*)
+        UA_calloc(1, sizeof(UA_MemoryIndexedContext));
+    if(!ctx)
+        return result;
+    ctx->nodes = (UA_MemoryIndexedNode**)
+        UA_calloc(nodesSize, sizeof(UA_MemoryIndexedNode*));
+    if(!ctx->nodes) {
+        UA_free(ctx);
+        return result;
+    }
+    ctx->nodesSize = nodesSize;
+    ctx->initialStoreSize = initialDataStoreSize;
+    ctx->maxStoreSize = maxDataStoreSize;
+
+    result.serverSetHistoryData = &serverSetHistoryData_backend_memory_indexed;
+    result.resultSize = &resultSize_backend_memory_indexed;
+    result.getEnd = &getEnd_backend_memory_indexed;
+    result.lastIndex = &lastIndex_backend_memory_indexed;
+    result.firstIndex = &firstIndex_backend_memory_indexed;
+    result.getDateTimeMatch = &getDateTimeMatch_backend_memory_indexed;
+    result.copyDataValues = &copyDataValues_backend_memory_indexed;
+    result.getDataValue = &getDataValue_backend_memory_indexed;
+    result.boundSupported = &boundSupported_backend_memory_indexed;
+    result.timestampsToReturnSupported =
+        &timestampsToReturnSupported_backend_memory_indexed;
+    result.insertDataValue = &insertDataValue_backend_memory_indexed;
+    result.updateDataValue = &updateDataValue_backend_memory_indexed;
+    result.replaceDataValue = &replaceDataValue_backend_memory_indexed;
+    result.removeDataValue = &removeDataValue_backend_memory_indexed;
+    result.deleteMembers = &deleteMembers_backend_memory_indexed;
+    result.getHistoryData = NULL;
+    result.context = ctx;
+    return result;
+}
+
+UA_StatusCode
+UA_HistoryDataBackend_Memory_Indexed_insertValues(UA_HistoryDataBackend *backend,
+                                                  const UA_NodeId *nodeId,
+                                                  size_t valuesSize,
+                                                  const UA_DataValue *values) {
+    UA_MemoryIndexedContext *ctx = (UA_MemoryIndexedContext*)backend->context;
+    UA_MemoryIndexedNode *node = getOrAddNode(ctx, nodeId);
+    if(!node)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* Grow the columns once for the entire batch */
+    UA_StatusCode res = reserveNode(ctx, node, node->count + valuesSize);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    for(size_t i = 0; i < valuesSize; i++) {
+        UA_DateTime timestamp = sampleTimestamp(&values[i]);
+        UA_DataValue sample;
+        res = prepareSample(&values[i], timestamp, &sample);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        res = storeSample(ctx, node, timestamp, &sample);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_HistoryDataBackend_Memory_Indexed_clear(UA_HistoryDataBackend *backend) {
+    deleteMembers_backend_memory_indexed(backend);
+    memset(backend, 0, sizeof(UA_HistoryDataBackend));
+}
@@ -0,0 +1,55 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UA_HISTORYDATABACKEND_FILE_H_
+#define UA_HISTORYDATABACKEND_FILE_H_
+
+#include "history_data_backend.h"
+
+_UA_BEGIN_DECLS
+
+#if defined(UA_ARCHITECTURE_POSIX)
+
+#define UA_HISTORYDATABACKEND_FILE_SEGMENTSIZE (4 * 1024 * 1024)
+
+/* This function constructs a UA_HistoryDataBackend that persists the history
+ * in the file system. The history survives a restart of the server if the
+ * backend is opened again on the same directory.
+ *
+ * Every NodeId gets a subdirectory with append-only segment files. The active
+ * segment is memory-mapped and written in-place. Full segments are unmapped.
+ * HistoryRead maps them read-only on demand (a bounded number of them stays
+ * mapped) and decodes the values directly from the mapping.
+ *
+ * Values have to be added in the order of their timestamps. Replacing and
+ * removing values is not supported.
+ *
+ * directory is the root directory of the store. It is created if required.
+ * segmentSize is the size of a segment file in bytes. Use 0 for the default
+ *             UA_HISTORYDATABACKEND_FILE_SEGMENTSIZE.
+ * syncInterval is the time in milliseconds after which written values are
+ *             synced to disk. The check is done when a value is added. Use 0
+ *             to sync after every value.
+ *
+ * If the store cannot be opened, a backend with a NULL context is returned. */
+UA_HistoryDataBackend UA_EXPORT
+UA_HistoryDataBackend_File(const char *directory, size_t segmentSize,
+                           UA_UInt32 syncInterval);
+
+/* Sync all written values to disk. Call this (e.g. from a repeated callback)
+ * to bound the time until values are persisted when no further values are
+ * added after the syncInterval. */
+UA_StatusCode UA_EXPORT
+UA_HistoryDataBackend_File_sync(UA_HistoryDataBackend *backend);
+
+/* Syncs and unmaps all segments. The files remain on disk. */
+void UA_EXPORT
+UA_HistoryDataBackend_File_clear(UA_HistoryDataBackend *backend);
+
+#endif /* UA_ARCHITECTURE_POSIX */
+
+_UA_END_DECLS
+
+#endif /* UA_HISTORYDATABACKEND_FILE_H_ */
@@ -30,6 +30,35 @@ UA_HistoryDataBackend_Memory_Circular(size_t initialNodeIdStoreSize, size_t init
 void UA_EXPORT
 UA_HistoryDataBackend_Memory_clear(UA_HistoryDataBackend *backend);
 
+/* This function constructs a UA_HistoryDataBackend for a large number of
+ * historized nodes. The nodes are looked up in a hash table. The values of each
+ * node are stored sorted by timestamp in contiguous arrays that are searched
+ * with a binary search.
+ *
+ * initialNodeIdStoreSize is the expected number of NodeIds. The index grows
+ *                        beyond that if required.
+ * initialDataStoreSize is the initial number of values allocated per NodeId.
+ * maxDataStoreSize is the maximum number of values stored per NodeId. If the
+ *                  limit is reached, the oldest value is dropped. Use 0 for an
+ *                  unbounded store. */
+UA_HistoryDataBackend UA_EXPORT
+UA_HistoryDataBackend_Memory_Indexed(size_t initialNodeIdStoreSize,
+                                     size_t initialDataStoreSize,
+                                     size_t maxDataStoreSize);
+
+/* Bulk insertion into a backend created with
+ * UA_HistoryDataBackend_Memory_Indexed. The storage is grown once for all
+ * values. Values that are sorted by timestamp and later than the stored values
+ * are appended without moving the existing values. */
+UA_StatusCode UA_EXPORT
+UA_HistoryDataBackend_Memory_Indexed_insertValues(UA_HistoryDataBackend *backend,
+                                                  const UA_NodeId *nodeId,
+                                                  size_t valuesSize,
+                                                  const UA_DataValue *values);
+
+void UA_EXPORT
+UA_HistoryDataBackend_Memory_Indexed_clear(UA_HistoryDataBackend *backend);
+
 _UA_END_DECLS
 
 #endif /* UA_HISTORYDATABACKEND_MEMORY_H_ */
@@ -19,6 +19,21 @@ _UA_BEGIN_DECLS
  */
 UA_EXPORT UA_Nodestore * UA_Nodestore_ZipTree(void);
 
+/* The HashMap Nodestore holds all nodes in RAM in an open-addressing hash
+ * table. The lookup time is O(1) on average. The table is resized (without
+ * moving the nodes) when it becomes too full. The nodes are allocated from
+ * slabs per NodeClass. Memory of removed nodes is reused for new nodes of the
+ * same NodeClass and only returned when the Nodestore is deleted. */
+UA_EXPORT UA_Nodestore * UA_Nodestore_HashMap(void);
+
+/* The RCU Nodestore is optimized for concurrent readers. Looking up and
+ * releasing nodes is lock-free. Nodes are never modified in-situ. Edits are
+ * made on a copy that is published atomically when the edited node is
+ * released (read-copy-update). Old node versions are reclaimed once no reader
+ * can access them anymore. This makes edits more expensive than in the other
+ * Nodestores. Modifying operations are serialized internally. */
+UA_EXPORT UA_Nodestore * UA_Nodestore_RCU(void);
+
 _UA_END_DECLS
 
 #endif /* UA_NODESTORE_DEFAULT_H_ */
@@ -313,6 +313,7 @@ UA_AccessControl_default(UA_ServerConfig *config,
     ac->allowAddNode = allowAddNode_default;
     ac->allowAddReference = allowAddReference_default;
     ac->allowBrowseNode = allowBrowseNode_default;
+    ac->concurrentAccess = true;
 
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     ac->allowTransferSubscription = allowTransferSubscription_default;
@@ -468,6 +468,7 @@ setDefaultConfig(UA_ServerConfig *conf, UA_UInt16 portNumber) {
     /* Limits for SecureChannels */
     conf->maxSecureChannels = 100;
     conf->maxSecurityTokenLifetime = 10 * 60 * 1000; /* 10 minutes */
+    conf->requestArenaSize = 16 * 1024; /* 16kB */
 
     /* Limits for Sessions */
     conf->maxSessions = 100;
@@ -524,6 +525,7 @@ setDefaultConfig(UA_ServerConfig *conf, UA_UInt16 portNumber) {
 #ifdef UA_ENABLE_PUBSUB
     conf->pubsubEnabled = true;
     conf->pubSubConfig.enableDeltaFrames = true;
+    conf->pubSubConfig.decodeArenaSize = 4096;
 #ifdef UA_ENABLE_PUBSUB_INFORMATIONMODEL
     conf->pubSubConfig.enableInformationModelMethods = true;
 #endif
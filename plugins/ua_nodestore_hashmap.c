@@ -0,0 +1,666 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/server.h>
+#include <open62541/plugin/nodestore.h>
+#include <open62541/plugin/nodestore_default.h>
+#include "pcg_basic.h"
+
+#ifndef container_of
+#define container_of(ptr, type, member) \
+    (type *)((uintptr_t)ptr - offsetof(type,member))
+#endif
+
+/* The HashMap Nodestore uses open addressing in the style of a "Swiss table".
+ * Every slot has a control byte with the state of the slot. For occupied slots
+ * the control byte contains the lower seven bits of the NodeId hash. The
+ * control bytes are probed in groups of eight with word-wide bit operations
+ * (SWAR). Only slots with a matching control byte are looked at in detail.
+ *
+ * The NodeEntries are allocated from slabs with one free-list per NodeClass.
+ * Freed entries are reused for new nodes of the same NodeClass. The slab memory
+ * is returned when the Nodestore is deleted. */
+
+struct NodeEntry;
+typedef struct NodeEntry NodeEntry;
+
+struct NodeEntry {
+    UA_UInt32 nodeIdHash;
+    UA_UInt16 refCount; /* How many consumers have a reference to the node? */
+    UA_Boolean deleted; /* Node was marked as deleted and can be deleted when refCount == 0 */
+    NodeEntry *orig;    /* If a copy is made to replace a node, track that we
+                         * replace only the node from which the copy was made.
+                         * Important for concurrent operations. Used as the
+                         * free-list pointer while the entry is unused. */
+    UA_NodeId nodeId; /* This is actually a UA_Node that also starts with a NodeId */
+};
+
+/* Control bytes */
+#define CTRL_EMPTY 0x80
+#define CTRL_DELETED 0xFE
+#define GROUP_WIDTH 8
+#define GROUP_LSBS 0x0101010101010101ull
+#define GROUP_MSBS 0x8080808080808080ull
+
+#define INITIAL_CAPACITY 64 /* Multiple of GROUP_WIDTH and a power of two */
+#define SLAB_ENTRIES 64
+#define NODECLASSES 8 /* Number of NodeClasses (bits in the enum) */
+
+typedef struct Slab {
+    struct Slab *next;
+    size_t used;
+    /* Entries follow after the (padded) header */
+} Slab;
+
+#define SLAB_HEADER_SIZE ((sizeof(Slab) + 15) & ~(size_t)15)
+
+typedef struct {
+    size_t entrySize;
+    NodeEntry *freeList;
+    Slab *slabs; /* The first slab is the one currently being filled */
+} SlabClass;
+
+typedef struct {
+    UA_Nodestore ns;
+
+    UA_Byte *ctrl;       /* Control bytes for each slot */
+    NodeEntry **slots;
+    size_t capacity;     /* Number of slots */
+    size_t size;         /* Occupied slots */
+    size_t deletedSlots; /* Tombstones */
+
+    SlabClass slabClasses[NODECLASSES];
+
+    /* Maps ReferenceTypeIndex to the NodeId of the ReferenceType */
+    UA_NodeId referenceTypeIds[UA_REFERENCETYPESET_MAX];
+    UA_Byte referenceTypeCounter;
+} HashMapNodestore;
+
+/****************/
+/* Group Probes */
+/****************/
+
+static UA_UInt64
+loadGroup(const UA_Byte *ctrl) {
+    /* Assemble the word bytewise. So the lowest byte is always the first slot,
+     * regardless of the endianness. Compilers reduce this to a single load. */
+    UA_UInt64 g = 0;
+    for(size_t i = 0; i < GROUP_WIDTH; i++)
+        g |= ((UA_UInt64)ctrl[i]) << (i * 8);
+    return g;
+}
+
+/* Bit mask with the MSB set for every byte that matches h2. Can have false
+ * positives for bytes next to a true match. The entries are compared in detail
+ * anyway. */
+static UA_UInt64
+groupMatch(UA_UInt64 g, UA_Byte h2) {
+    UA_UInt64 x = g ^ (GROUP_LSBS * h2);
+    return (x - GROUP_LSBS) & ~x & GROUP_MSBS;
+}
+
+static UA_UInt64
+groupMatchEmpty(UA_UInt64 g) {
+    /* Empty (0x80) has the MSB set and bit 1 unset. Deleted (0xFE) has both
+     * set. Occupied slots have the MSB unset. */
+    return g & ~(g << 6) & GROUP_MSBS;
+}
+
+static UA_UInt64
+groupMatchEmptyOrDeleted(UA_UInt64 g) {
+    return g & GROUP_MSBS;
+}
+
+/* Index of the lowest byte with the MSB set */
+static size_t
+lowestMatch(UA_UInt64 mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_ctzll(mask) >> 3;
+#else
+    size_t i = 0;
+    while(!(mask & 0x80)) {
+        mask >>= 8;
+        i++;
+    }
+    return i;
+#endif
+}
+
+static UA_Byte
+hashH2(UA_UInt32 hash) {
+    return (UA_Byte)(hash & 0x7F);
+}
+
+static size_t
+hashH1(UA_UInt32 hash) {
+    return (size_t)(hash >> 7);
+}
+
+/* Returns the slot index of the entry or SIZE_MAX if not found. The groups are
+ * probed with triangular numbers. This visits every group exactly once for
+ * power-of-two group counts. */
+static size_t
+findSlot(const HashMapNodestore *hns, const UA_NodeId *nodeId, UA_UInt32 hash) {
+    size_t groupMask = (hns->capacity / GROUP_WIDTH) - 1;
+    size_t group = hashH1(hash) & groupMask;
+    UA_Byte h2 = hashH2(hash);
+    for(size_t step = 1; step <= groupMask + 1; step++) {
+        const UA_Byte *ctrl = &hns->ctrl[group * GROUP_WIDTH];
+        UA_UInt64 g = loadGroup(ctrl);
+        UA_UInt64 m = groupMatch(g, h2);
+        while(m) {
+            size_t slot = group * GROUP_WIDTH + lowestMatch(m);
+            const NodeEntry *entry = hns->slots[slot];
+            if(ctrl[slot % GROUP_WIDTH] == h2 && entry->nodeIdHash == hash &&
+               UA_NodeId_equal(&entry->nodeId, nodeId))
+                return slot;
+            m &= m - 1; /* Clear the lowest match */
+        }
+        /* An empty slot ends the probe sequence */
+        if(groupMatchEmpty(g))
+            return SIZE_MAX;
+        group = (group + step) & groupMask;
+    }
+    return SIZE_MAX;
+}
+
+static NodeEntry *
+findEntry(const HashMapNodestore *hns, const UA_NodeId *nodeId) {
+    UA_UInt32 hash = UA_NodeId_hash(nodeId);
+    size_t slot = findSlot(hns, nodeId, hash);
+    return (slot != SIZE_MAX) ? hns->slots[slot] : NULL;
+}
+
+/* Find a free (empty or deleted) slot in the probe sequence */
+static size_t
+findFreeSlot(const UA_Byte *ctrl, size_t capacity, UA_UInt32 hash) {
+    size_t groupMask = (capacity / GROUP_WIDTH) - 1;
+    size_t group = hashH1(hash) & groupMask;
+    for(size_t step = 1; ; step++) {
+        UA_UInt64 m = groupMatchEmptyOrDeleted(loadGroup(&ctrl[group * GROUP_WIDTH]));
+        if(m)
+            return group * GROUP_WIDTH + lowestMatch(m);
+        group = (group + step) & groupMask;
+    }
+}
+
+/* Rehash into a new table. The NodeEntries are not moved. */
+static UA_StatusCode
+resize(HashMapNodestore *hns, size_t newCapacity) {
+    UA_Byte *ctrl = (UA_Byte*)UA_malloc(newCapacity);
+    NodeEntry **slots = (NodeEntry**)UA_calloc(newCapacity, sizeof(NodeEntry*));
+    if(!ctrl || !slots) {
+        UA_free(ctrl);
+        UA_free(slots);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    memset(ctrl, CTRL_EMPTY, newCapacity);
+
+    for(size_t i = 0; i < hns->capacity; i++) {
+        if(hns->ctrl[i] & 0x80)
+            continue; /* Empty or deleted */
+        NodeEntry *entry = hns->slots[i];
+        size_t slot = findFreeSlot(ctrl, newCapacity, entry->nodeIdHash);
+        ctrl[slot] = hashH2(entry->nodeIdHash);
+        slots[slot] = entry;
+    }
+
+    UA_free(hns->ctrl);
+    UA_free(hns->slots);
+    hns->ctrl = ctrl;
+    hns->slots = slots;
+    hns->capacity = newCapacity;
+    hns->deletedSlots = 0;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Keep the load factor (including tombstones) below 7/8 */
+static UA_StatusCode
+ensureFreeSlot(HashMapNodestore *hns) {
+    if((hns->size + hns->deletedSlots + 1) * 8 <= hns->capacity * 7)
+        return UA_STATUSCODE_GOOD;
+    /* Only clean up the tombstones if the table is less than half full */
+    size_t newCapacity = hns->capacity;
+    if(hns->size * 2 >= hns->capacity)
+        newCapacity *= 2;
+    return resize(hns, newCapacity);
+}
+
+static void
+insertEntry(HashMapNodestore *hns, NodeEntry *entry) {
+    size_t slot = findFreeSlot(hns->ctrl, hns->capacity, entry->nodeIdHash);
+    if(hns->ctrl[slot] == CTRL_DELETED)
+        hns->deletedSlots--;
+    hns->ctrl[slot] = hashH2(entry->nodeIdHash);
+    hns->slots[slot] = entry;
+    hns->size++;
+}
+
+/*********/
+/* Slabs */
+/*********/
+
+static size_t
+slabClassIndex(UA_NodeClass nodeClass) {
+    size_t i = 0;
+    while(i < NODECLASSES && !(nodeClass & (1 << i)))
+        i++;
+    return i;
+}
+
+static NodeEntry *
+newEntry(HashMapNodestore *hns, UA_NodeClass nodeClass) {
+    size_t ci = slabClassIndex(nodeClass);
+    if(ci >= NODECLASSES || (UA_UInt32)nodeClass != (1u << ci))
+        return NULL;
+    SlabClass *sc = &hns->slabClasses[ci];
+
+    /* Take from the free-list or the current slab */
+    NodeEntry *entry = sc->freeList;
+    if(entry) {
+        sc->freeList = entry->orig;
+    } else {
+        Slab *slab = sc->slabs;
+        if(!slab || slab->used == SLAB_ENTRIES) {
+            slab = (Slab*)UA_malloc(SLAB_HEADER_SIZE + SLAB_ENTRIES * sc->entrySize);
+            if(!slab)
+                return NULL;
+            slab->used = 0;
+            slab->next = sc->slabs;
+            sc->slabs = slab;
+        }
+        entry = (NodeEntry*)((uintptr_t)slab + SLAB_HEADER_SIZE +
+                             slab->used * sc->entrySize);
+        slab->used++;
+    }
+
+    memset(entry, 0, sc->entrySize);
+    UA_Node *node = (UA_Node*)&entry->nodeId;
+    node->head.nodeClass = nodeClass;
+    return entry;
+}
+
+static void
+deleteEntry(HashMapNodestore *hns, NodeEntry *entry) {
+    UA_Node *node = (UA_Node*)&entry->nodeId;
+    SlabClass *sc = &hns->slabClasses[slabClassIndex(node->head.nodeClass)];
+    UA_Node_clear(node);
+    entry->orig = sc->freeList;
+    sc->freeList = entry;
+}
+
+static void
+cleanupEntry(HashMapNodestore *hns, NodeEntry *entry) {
+    if(entry->refCount > 0)
+        return;
+    if(entry->deleted) {
+        deleteEntry(hns, entry);
+        return;
+    }
+    UA_NodeHead *head = (UA_NodeHead*)&entry->nodeId;
+    for(size_t i = 0; i < head->referencesSize; i++) {
+        UA_NodeReferenceKind *rk = &head->references[i];
+        if(rk->targetsSize > 16 && !rk->hasRefTree)
+            UA_NodeReferenceKind_switch(rk);
+    }
+}
+
+/***********************/
+/* Interface functions */
+/***********************/
+
+/* Not yet inserted into the HashMap */
+static UA_Node *
+hashMapNsNewNode(UA_Nodestore *ns, UA_NodeClass nodeClass) {
+    NodeEntry *entry = newEntry((HashMapNodestore*)ns, nodeClass);
+    if(!entry)
+        return NULL;
+    return (UA_Node*)&entry->nodeId;
+}
+
+/* Not yet inserted into the HashMap */
+static void
+hashMapNsDeleteNode(UA_Nodestore *ns, UA_Node *node) {
+    deleteEntry((HashMapNodestore*)ns, container_of(node, NodeEntry, nodeId));
+}
+
+static const UA_Node *
+hashMapNsGetNode(UA_Nodestore *ns, const UA_NodeId *nodeId,
+                 UA_UInt32 attributeMask,
+                 UA_ReferenceTypeSet references,
+                 UA_BrowseDirection referenceDirections) {
+    NodeEntry *entry = findEntry((HashMapNodestore*)ns, nodeId);
+    if(!entry)
+        return NULL;
+    ++entry->refCount;
+    return (const UA_Node*)&entry->nodeId;
+}
+
+static const UA_Node *
+hashMapNsGetNodeFromPtr(UA_Nodestore *ns, UA_NodePointer ptr,
+                        UA_UInt32 attributeMask,
+                        UA_ReferenceTypeSet references,
+                        UA_BrowseDirection referenceDirections) {
+    if(!UA_NodePointer_isLocal(ptr))
+        return NULL;
+    UA_NodeId id = UA_NodePointer_toNodeId(ptr);
+    return hashMapNsGetNode(ns, &id, attributeMask,
+                            references, referenceDirections);
+}
+
+static void
+hashMapNsReleaseNode(UA_Nodestore *ns, const UA_Node *node) {
+    if(!node)
+        return;
+    NodeEntry *entry = container_of(node, NodeEntry, nodeId);
+    UA_assert(entry->refCount > 0);
+    --entry->refCount;
+    cleanupEntry((HashMapNodestore*)ns, entry);
+}
+
+static UA_StatusCode
+hashMapNsGetNodeCopy(UA_Nodestore *ns, const UA_NodeId *nodeId,
+                     UA_Node **outNode) {
+    HashMapNodestore *hns = (HashMapNodestore*)ns;
+    NodeEntry *entry = findEntry(hns, nodeId);
+    if(!entry)
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+
+    /* Create the new entry */
+    const UA_Node *node = (const UA_Node*)&entry->nodeId;
+    NodeEntry *ne = newEntry(hns, node->head.nodeClass);
+    if(!ne)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* Copy the node content */
+    UA_Node *nnode = (UA_Node*)&ne->nodeId;
+    UA_StatusCode retval = UA_Node_copy(node, nnode);
+    if(retval != UA_STATUSCODE_GOOD) {
+        deleteEntry(hns, ne);
+        return retval;
+    }
+
+    ne->orig = entry;
+    *outNode = nnode;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+hashMapNsInsertNode(UA_Nodestore *ns, UA_Node *node, UA_NodeId *addedNodeId) {
+    NodeEntry *entry = container_of(node, NodeEntry, nodeId);
+    HashMapNodestore *hns = (HashMapNodestore*)ns;
+
+    /* Make room for the new node. Resizing never moves the entries. */
+    UA_StatusCode retval = ensureFreeSlot(hns);
+    if(retval != UA_STATUSCODE_GOOD) {
+        deleteEntry(hns, entry);
+        return retval;
+    }
+
+    /* Ensure that the NodeId is unique by testing their presence. If the NodeId
+     * is ns=xx;i=0, then the numeric identifier is replaced with a random
+     * unused int32. It is ensured that the created identifiers are stable after
+     * a server restart (assuming that Nodes are created in the same order and
+     * with the same BrowseName). */
+    UA_UInt32 hash;
+    if(node->head.nodeId.identifierType == UA_NODEIDTYPE_NUMERIC &&
+       node->head.nodeId.identifier.numeric == 0) {
+        NodeEntry *found;
+        UA_UInt32 mask = 0x2F;
+        pcg32_random_t rng;
+        pcg32_srandom_r(&rng, hns->size, 0);
+        do {
+            /* Generate a random NodeId. Favor "easy" NodeIds.
+             * Always above 50000. */
+            UA_UInt32 numId = (pcg32_random_r(&rng) & mask) + 50000;
+
+#if SIZE_MAX <= UA_UINT32_MAX
+            /* The compressed "immediate" representation of nodes does not
+             * support the full range on 32bit systems. Generate smaller
+             * identifiers as they can be stored more compactly. */
+            if(numId >= (0x01 << 24))
+                numId = numId % (0x01 << 24);
+#endif
+            node->head.nodeId.identifier.numeric = numId;
+
+            /* Look up the current NodeId */
+            hash = UA_NodeId_hash(&node->head.nodeId);
+            size_t slot = findSlot(hns, &node->head.nodeId, hash);
+            found = (slot != SIZE_MAX) ? hns->slots[slot] : NULL;
+
+            if(found) {
+                /* Reseed the rng using the browseName of the existing node.
+                 * This ensures that different information models end up with
+                 * different NodeId sequences, but still stable after a
+                 * restart. */
+                UA_NodeHead *nh = (UA_NodeHead*)&found->nodeId;
+                pcg32_srandom_r(&rng, rng.state, UA_QualifiedName_hash(&nh->browseName));
+
+                /* Make the mask less strict when the NodeId already exists */
+                mask = (mask << 1) | 0x01;
+            }
+        } while(found);
+    } else {
+        hash = UA_NodeId_hash(&node->head.nodeId);
+        if(findSlot(hns, &node->head.nodeId, hash) != SIZE_MAX) {
+            /* The nodeid exists */
+            deleteEntry(hns, entry);
+            return UA_STATUSCODE_BADNODEIDEXISTS;
+        }
+    }
+
+    /* Copy the NodeId */
+    if(addedNodeId) {
+        retval = UA_NodeId_copy(&node->head.nodeId, addedNodeId);
+        if(retval != UA_STATUSCODE_GOOD) {
+            deleteEntry(hns, entry);
+            return retval;
+        }
+    }
+
+    /* For new ReferencetypeNodes add to the index map */
+    if(node->head.nodeClass == UA_NODECLASS_REFERENCETYPE) {
+        UA_ReferenceTypeNode *refNode = &node->referenceTypeNode;
+        if(hns->referenceTypeCounter >= UA_REFERENCETYPESET_MAX) {
+            deleteEntry(hns, entry);
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+
+        retval = UA_NodeId_copy(&node->head.nodeId,
+                                &hns->referenceTypeIds[hns->referenceTypeCounter]);
+        if(retval != UA_STATUSCODE_GOOD) {
+            deleteEntry(hns, entry);
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+
+        /* Assign the ReferenceTypeIndex to the new ReferenceTypeNode */
+        refNode->referenceTypeIndex = hns->referenceTypeCounter;
+        refNode->subTypes = UA_REFTYPESET(hns->referenceTypeCounter);
+        hns->referenceTypeCounter++;
+    }
+
+    /* Insert the node */
+    entry->nodeIdHash = hash;
+    insertEntry(hns, entry);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+hashMapNsReplaceNode(UA_Nodestore *ns, UA_Node *node) {
+    HashMapNodestore *hns = (HashMapNodestore*)ns;
+    NodeEntry *entry = container_of(node, NodeEntry, nodeId);
+
+    /* Find the node */
+    UA_UInt32 hash = UA_NodeId_hash(&node->head.nodeId);
+    size_t slot = findSlot(hns, &node->head.nodeId, hash);
+    if(slot == SIZE_MAX) {
+        deleteEntry(hns, entry);
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    }
+
+    /* Test if the copy is current */
+    NodeEntry *oldEntry = hns->slots[slot];
+    if(oldEntry != entry->orig) {
+        /* The node was already updated since the copy was made */
+        deleteEntry(hns, entry);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* Replace in the same slot */
+    entry->nodeIdHash = hash;
+    entry->orig = NULL;
+    hns->slots[slot] = entry;
+    oldEntry->deleted = true;
+    cleanupEntry(hns, oldEntry);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+hashMapNsRemoveNode(UA_Nodestore *ns, const UA_NodeId *nodeId) {
+    HashMapNodestore *hns = (HashMapNodestore*)ns;
+    size_t slot = findSlot(hns, nodeId, UA_NodeId_hash(nodeId));
+    if(slot == SIZE_MAX)
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+
+    /* Leave a tombstone. Otherwise the probe sequence of other entries could
+     * be interrupted. */
+    NodeEntry *entry = hns->slots[slot];
+    hns->ctrl[slot] = CTRL_DELETED;
+    hns->slots[slot] = NULL;
+    hns->size--;
+    hns->deletedSlots++;
+
+    entry->deleted = true;
+    cleanupEntry(hns, entry);
+    return UA_STATUSCODE_GOOD;
+}
+
+static const UA_NodeId *
+hashMapNsGetReferenceTypeId(UA_Nodestore *ns, UA_Byte refTypeIndex) {
+    HashMapNodestore *hns = (HashMapNodestore*)ns;
+    if(refTypeIndex >= hns->referenceTypeCounter)
+        return NULL;
+    return &hns->referenceTypeIds[refTypeIndex];
+}
+
+static void
+hashMapNsIterate(UA_Nodestore *ns, UA_NodestoreVisitor visitor,
+                 void *visitorCtx) {
+    HashMapNodestore *hns = (HashMapNodestore*)ns;
+    for(size_t i = 0; i < hns->capacity; i++) {
+        if(hns->ctrl[i] & 0x80)
+            continue; /* Empty or deleted */
+        NodeEntry *entry = hns->slots[i];
+        /* Pin the entry. The visitor might remove the node. */
+        entry->refCount++;
+        visitor(visitorCtx, (UA_Node*)&entry->nodeId);
+        entry->refCount--;
+        cleanupEntry(hns, entry);
+    }
+}
+
+/***********************/
+/* Nodestore Lifecycle */
+/***********************/
+
+static void
+hashMapNsFree(UA_Nodestore *ns) {
+    HashMapNodestore *hns = (HashMapNodestore*)ns;
+
+    /* Clear the nodes. The entry memory is freed with the slabs. */
+    for(size_t i = 0; i < hns->capacity; i++) {
+        if(!(hns->ctrl[i] & 0x80))
+            UA_Node_clear((UA_Node*)&hns->slots[i]->nodeId);
+    }
+    UA_free(hns->ctrl);
+    UA_free(hns->slots);
+
+    for(size_t i = 0; i < NODECLASSES; i++) {
+        Slab *slab = hns->slabClasses[i].slabs;
+        while(slab) {
+            Slab *next = slab->next;
+            UA_free(slab);
+            slab = next;
+        }
+    }
+
+    /* Clean up the ReferenceTypes index array */
+    for(size_t i = 0; i < hns->referenceTypeCounter; i++)
+        UA_NodeId_clear(&hns->referenceTypeIds[i]);
+
+    UA_free(hns);
+}
+
+static size_t
+nodeClassSize(UA_NodeClass nodeClass) {
+    switch(nodeClass) {
+    case UA_NODECLASS_OBJECT: return sizeof(UA_ObjectNode);
+    case UA_NODECLASS_VARIABLE: return sizeof(UA_VariableNode);
+    case UA_NODECLASS_METHOD: return sizeof(UA_MethodNode);
+    case UA_NODECLASS_OBJECTTYPE: return sizeof(UA_ObjectTypeNode);
+    case UA_NODECLASS_VARIABLETYPE: return sizeof(UA_VariableTypeNode);
+    case UA_NODECLASS_REFERENCETYPE: return sizeof(UA_ReferenceTypeNode);
+    case UA_NODECLASS_DATATYPE: return sizeof(UA_DataTypeNode);
+    case UA_NODECLASS_VIEW: return sizeof(UA_ViewNode);
+    default: return 0;
+    }
+}
+
+UA_Nodestore *
+UA_Nodestore_HashMap(void) {
+    /* Allocate and initialize the context */
+    HashMapNodestore *hns = (HashMapNodestore*)
+        UA_calloc(1, sizeof(HashMapNodestore));
+    if(!hns)
+        return NULL;
+
+    hns->ctrl = (UA_Byte*)UA_malloc(INITIAL_CAPACITY);
+    hns->slots = (NodeEntry**)UA_calloc(INITIAL_CAPACITY, sizeof(NodeEntry*));
+    if(!hns->ctrl || !hns->slots) {
+        UA_free(hns->ctrl);
+        UA_free(hns->slots);
+        UA_free(hns);
+        return NULL;
+    }
+    memset(hns->ctrl, CTRL_EMPTY, INITIAL_CAPACITY);
+    hns->capacity = INITIAL_CAPACITY;
+
+    /* Entry sizes per NodeClass. Padded to keep the entries in the slabs
+     * aligned. */
+    for(size_t i = 0; i < NODECLASSES; i++) {
+        size_t size = sizeof(NodeEntry) - sizeof(UA_NodeId) +
+            nodeClassSize((UA_NodeClass)(1 << i));
+        hns->slabClasses[i].entrySize = (size + 15) & ~(size_t)15;
+    }
+
+    /* Populate the nodestore */
+    hns->ns.free = hashMapNsFree;
+    hns->ns.newNode = hashMapNsNewNode;
+    hns->ns.deleteNode = hashMapNsDeleteNode;
+    hns->ns.getNode = hashMapNsGetNode;
+    hns->ns.getNodeFromPtr = hashMapNsGetNodeFromPtr;
+    hns->ns.releaseNode = hashMapNsReleaseNode;
+    hns->ns.getNodeCopy = hashMapNsGetNodeCopy;
+    hns->ns.insertNode = hashMapNsInsertNode;
+    hns->ns.replaceNode = hashMapNsReplaceNode;
+    hns->ns.removeNode = hashMapNsRemoveNode;
+    hns->ns.getReferenceTypeId = hashMapNsGetReferenceTypeId;
+    hns->ns.iterate = hashMapNsIterate;
+
+    /* All nodes are stored in RAM. Changes are made in-situ. GetEditNode is
+     * identical to GetNode -- but the Node pointer is non-const. */
+    hns->ns.getEditNode =
+        (UA_Node * (*)(UA_Nodestore *ns, const UA_NodeId *nodeId,
+                       UA_UInt32 attributeMask,
+                       UA_ReferenceTypeSet references,
+                       UA_BrowseDirection referenceDirections))hashMapNsGetNode;
+    hns->ns.getEditNodeFromPtr =
+        (UA_Node * (*)(UA_Nodestore *ns, UA_NodePointer ptr,
+                       UA_UInt32 attributeMask,
+                       UA_ReferenceTypeSet references,
+                       UA_BrowseDirection referenceDirections))hashMapNsGetNodeFromPtr;
+
+    return &hns->ns;
+}
@@ -0,0 +1,826 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/server.h>
+#include <open62541/plugin/nodestore.h>
+#include <open62541/plugin/nodestore_default.h>
+#include "pcg_basic.h"
+
+#ifndef container_of
+#define container_of(ptr, type, member) \
+    (type *)((uintptr_t)ptr - offsetof(type,member))
+#endif
+
+/* The RCU Nodestore is optimized for concurrent readers. Lookups never take a
+ * lock and never write to shared memory except for the reference counter of
+ * the node that is returned.
+ *
+ * The nodes are kept in a hash table with chained buckets. Every pointer in
+ * the table (the table itself, the bucket heads, the links of the chains and
+ * the links' pointer to the current node version) is published atomically.
+ * Nodes are never edited in-situ. Instead, a new version of the node is
+ * prepared as a copy and then published by exchanging the pointer in the link
+ * (read-copy-update). So readers see either the old or the new version, but
+ * never a partial change.
+ *
+ * Memory that was unlinked from the table (old node versions, links, tables
+ * after a resize) is retired. It is reclaimed once all readers that could still
+ * see it have left. For this the readers announce themselves in one of two
+ * counters, depending on the parity of the current epoch. When the readers of
+ * the previous epoch have drained, the memory retired before the current epoch
+ * is freed and the epoch advances.
+ *
+ * Node versions can outlive their reclamation if a reader still holds a
+ * reference (from getNode). Every published node has one reference held by
+ * the Nodestore. This reference is released on reclamation. Whoever drops the
+ * last reference frees the node.
+ *
+ * Writers (insert, replace, remove and the release of an edited node) are
+ * serialized with a lock. An edit holds the lock from getEditNode until the
+ * edited copy is published in releaseNode. So no other writer can replace or
+ * remove the node in between and the edit is never discarded. */
+
+#define NODE_NEW 0       /* Allocated with newNode, not published */
+#define NODE_COPY 1      /* From getNodeCopy, waiting for replaceNode */
+#define NODE_EDIT 2      /* From getEditNode, published in releaseNode */
+#define NODE_PUBLISHED 3 /* Published in the table. The state no longer
+                          * changes, also when the node is replaced or
+                          * removed. Readers can still look at the state. */
+
+struct NodeEntry;
+typedef struct NodeEntry NodeEntry;
+
+struct NodeEntry {
+    void *refCount;     /* Atomic counter (uintptr_t). Published nodes have one
+                         * reference held by the Nodestore. */
+    UA_Byte state;
+    UA_UInt32 editDepth; /* For edits: nesting of getEditNode for the node */
+    NodeEntry *orig;    /* For copies and edits: the version from which the copy
+                         * was made. The copy is only published if the version
+                         * is still current. */
+    UA_NodeId nodeId; /* This is actually a UA_Node that also starts with a NodeId */
+};
+
+typedef struct Link {
+    struct Link *next;
+    UA_UInt32 nodeIdHash;
+    NodeEntry *entry; /* Current version of the node */
+} Link;
+
+typedef struct {
+    size_t bucketsSize; /* Power of two */
+    Link *buckets[];
+} Table;
+
+#define INITIAL_BUCKETS 64
+
+#define RETIRED_ENTRY 0
+#define RETIRED_LINK 1
+#define RETIRED_TABLE 2
+
+typedef struct Retired {
+    struct Retired *next;
+    UA_Byte type;
+    void *ptr;
+} Retired;
+
+typedef struct {
+    UA_Nodestore ns;
+
+    Table *table; /* Published atomically */
+    size_t size;
+
+    /* Epoch-based reclamation */
+    void *epoch;      /* Atomic counter */
+    void *readers[2]; /* Active readers per epoch parity (atomic counters) */
+    Retired *retiredCurrent;  /* Retired during the current epoch */
+    Retired *retiredPrevious; /* Retired before the current epoch */
+
+#if UA_MULTITHREADING >= 100
+    UA_Lock writeLock;
+#endif
+
+    /* Edits that are not yet released. Only accessed with the write lock,
+     * which is held as long as an edit is open. */
+    NodeEntry **edits;
+    size_t editsSize;
+    size_t editsCapacity;
+
+    /* Maps ReferenceTypeIndex to the NodeId of the ReferenceType */
+    UA_NodeId referenceTypeIds[UA_REFERENCETYPESET_MAX];
+    UA_Byte referenceTypeCounter;
+} RCUNodestore;
+
+/*********************/
+/* Atomic Operations */
+/*********************/
+
+/* Counters are stored as pointer-sized integers to reuse the atomic pointer
+ * operations of the architecture layer. */
+static uintptr_t
+atomicAdd(void **addr, intptr_t delta) {
+    void *old;
+    void *cur = UA_atomic_load(addr);
+    do {
+        old = cur;
+        cur = UA_atomic_cmpxchg(addr, old, (void*)((uintptr_t)old + (uintptr_t)delta));
+    } while(cur != old);
+    return (uintptr_t)old + (uintptr_t)delta;
+}
+
+static uintptr_t
+atomicLoadCounter(void **addr) {
+    return (uintptr_t)UA_atomic_load(addr);
+}
+
+static Link *
+loadLink(Link **addr) {
+    return (Link*)UA_atomic_load((void**)addr);
+}
+
+static void
+storeLink(Link **addr, Link *link) {
+    UA_atomic_xchg((void**)addr, link);
+}
+
+static void
+writeLock(RCUNodestore *rns) {
+#if UA_MULTITHREADING >= 100
+    UA_LOCK(&rns->writeLock);
+#endif
+}
+
+static void
+writeUnlock(RCUNodestore *rns) {
+#if UA_MULTITHREADING >= 100
+    UA_UNLOCK(&rns->writeLock);
+#endif
+}
+
+/****************/
+/* Node Entries */
+/****************/
+
+static NodeEntry *
+newEntry(UA_NodeClass nodeClass) {
+    size_t size = sizeof(NodeEntry) - sizeof(UA_NodeId);
+    switch(nodeClass) {
+    case UA_NODECLASS_OBJECT:
+        size += sizeof(UA_ObjectNode);
+        break;
+    case UA_NODECLASS_VARIABLE:
+        size += sizeof(UA_VariableNode);
+        break;
+    case UA_NODECLASS_METHOD:
+        size += sizeof(UA_MethodNode);
+        break;
+    case UA_NODECLASS_OBJECTTYPE:
+        size += sizeof(UA_ObjectTypeNode);
+        break;
+    case UA_NODECLASS_VARIABLETYPE:
+        size += sizeof(UA_VariableTypeNode);
+        break;
+    case UA_NODECLASS_REFERENCETYPE:
+        size += sizeof(UA_ReferenceTypeNode);
+        break;
+    case UA_NODECLASS_DATATYPE:
+        size += sizeof(UA_DataTypeNode);
+        break;
+    case UA_NODECLASS_VIEW:
+        size += sizeof(UA_ViewNode);
+        break;
+    default:
+        return NULL;
+    }
+    NodeEntry *entry = (NodeEntry*)UA_calloc(1, size);
+    if(!entry)
+        return NULL;
+    UA_Node *node = (UA_Node*)&entry->nodeId;
+    node->head.nodeClass = nodeClass;
+    return entry;
+}
+
+static void
+deleteEntry(NodeEntry *entry) {
+    UA_Node_clear((UA_Node*)&entry->nodeId);
+    UA_free(entry);
+}
+
+static void
+releaseEntry(NodeEntry *entry) {
+    if(atomicAdd(&entry->refCount, -1) == 0)
+        deleteEntry(entry);
+}
+
+/* Make a private copy of the current version */
+static NodeEntry *
+copyEntry(NodeEntry *entry) {
+    const UA_Node *node = (const UA_Node*)&entry->nodeId;
+    NodeEntry *ne = newEntry(node->head.nodeClass);
+    if(!ne)
+        return NULL;
+    if(UA_Node_copy(node, (UA_Node*)&ne->nodeId) != UA_STATUSCODE_GOOD) {
+        deleteEntry(ne);
+        return NULL;
+    }
+    ne->orig = entry;
+    return ne;
+}
+
+/* Prepare the entry for publication. Published nodes are no longer modified. */
+static void
+prepareEntry(NodeEntry *entry) {
+    UA_NodeHead *head = (UA_NodeHead*)&entry->nodeId;
+    for(size_t i = 0; i < head->referencesSize; i++) {
+        UA_NodeReferenceKind *rk = &head->references[i];
+        if(rk->targetsSize > 16 && !rk->hasRefTree)
+            UA_NodeReferenceKind_switch(rk);
+    }
+    entry->orig = NULL;
+    entry->refCount = (void*)(uintptr_t)1; /* Reference held by the Nodestore */
+    entry->state = NODE_PUBLISHED;
+}
+
+/***************/
+/* Reclamation */
+/***************/
+
+static uintptr_t
+readerEnter(RCUNodestore *rns) {
+    while(true) {
+        uintptr_t e = atomicLoadCounter(&rns->epoch);
+        atomicAdd(&rns->readers[e & 1], 1);
+        /* The epoch has advanced in between. Try again. Otherwise the reader
+         * could be counted for an epoch whose memory is already reclaimed. */
+        if(atomicLoadCounter(&rns->epoch) == e)
+            return e;
+        atomicAdd(&rns->readers[e & 1], -1);
+    }
+}
+
+static void
+readerLeave(RCUNodestore *rns, uintptr_t e) {
+    atomicAdd(&rns->readers[e & 1], -1);
+}
+
+static void
+freeRetired(Retired *r) {
+    while(r) {
+        Retired *next = r->next;
+        switch(r->type) {
+        case RETIRED_ENTRY:
+            releaseEntry((NodeEntry*)r->ptr);
+            break;
+        case RETIRED_LINK:
+            UA_free(r->ptr);
+            break;
+        case RETIRED_TABLE: {
+            /* The links of the old table were replaced with new links in the
+             * new table. The entries are still referenced from there. */
+            Table *t = (Table*)r->ptr;
+            for(size_t i = 0; i < t->bucketsSize; i++) {
+                Link *link = t->buckets[i];
+                while(link) {
+                    Link *nextLink = link->next;
+                    UA_free(link);
+                    link = nextLink;
+                }
+            }
+            UA_free(t);
+            break;
+        }
+        default:
+            break;
+        }
+        UA_free(r);
+        r = next;
+    }
+}
+
+/* Free the memory retired before the current epoch if all readers from the
+ * previous epoch have left. Then move to the next epoch. Called by writers. */
+static void
+tryReclaim(RCUNodestore *rns) {
+    uintptr_t e = atomicLoadCounter(&rns->epoch);
+    if(atomicLoadCounter(&rns->readers[(e + 1) & 1]) > 0)
+        return;
+    freeRetired(rns->retiredPrevious);
+    rns->retiredPrevious = rns->retiredCurrent;
+    rns->retiredCurrent = NULL;
+    if(rns->retiredPrevious)
+        atomicAdd(&rns->epoch, 1);
+}
+
+/* If the allocation of the retire record fails, the memory is leaked. It is
+ * not safe to free it immediately. */
+static void
+retire(RCUNodestore *rns, UA_Byte type, void *ptr) {
+    Retired *r = (Retired*)UA_malloc(sizeof(Retired));
+    if(!r)
+        return;
+    r->type = type;
+    r->ptr = ptr;
+    r->next = rns->retiredCurrent;
+    rns->retiredCurrent = r;
+}
+
+/**************/
+/* Hash Table */
+/**************/
+
+static Table *
+newTable(size_t bucketsSize) {
+    Table *t = (Table*)UA_calloc(1, sizeof(Table) + bucketsSize * sizeof(Link*));
+    if(!t)
+        return NULL;
+    t->bucketsSize = bucketsSize;
+    return t;
+}
+
+/* Lock-free lookup. Must be called between readerEnter and readerLeave (or by
+ * the writer). Returns the link to the current version. */
+static Link *
+findLink(RCUNodestore *rns, const UA_NodeId *nodeId, UA_UInt32 hash) {
+    Table *t = (Table*)UA_atomic_load((void**)&rns->table);
+    Link *link = loadLink(&t->buckets[hash & (t->bucketsSize - 1)]);
+    for(; link; link = loadLink(&link->next)) {
+        if(link->nodeIdHash != hash)
+            continue;
+        NodeEntry *entry = (NodeEntry*)UA_atomic_load((void**)&link->entry);
+        if(UA_NodeId_equal(&entry->nodeId, nodeId))
+            return link;
+    }
+    return NULL;
+}
+
+/* Rebuild the table with twice the buckets and new links. Then publish the new
+ * table. Readers in the old table continue to see consistent chains. */
+static void
+growTable(RCUNodestore *rns) {
+    Table *old = rns->table;
+    Table *t = newTable(old->bucketsSize * 2);
+    if(!t)
+        return; /* Continue with longer chains */
+    for(size_t i = 0; i < old->bucketsSize; i++) {
+        for(Link *link = old->buckets[i]; link; link = link->next) {
+            Link *nl = (Link*)UA_malloc(sizeof(Link));
+            if(!nl) {
+                for(size_t j = 0; j < t->bucketsSize; j++) {
+                    Link *l = t->buckets[j];
+                    while(l) {
+                        Link *next = l->next;
+                        UA_free(l);
+                        l = next;
+                    }
+                }
+                UA_free(t);
+                return;
+            }
+            nl->nodeIdHash = link->nodeIdHash;
+            nl->entry = link->entry;
+            size_t b = nl->nodeIdHash & (t->bucketsSize - 1);
+            nl->next = t->buckets[b];
+            t->buckets[b] = nl;
+        }
+    }
+    UA_atomic_xchg((void**)&rns->table, t);
+    retire(rns, RETIRED_TABLE, old);
+}
+
+/***********************/
+/* Interface functions */
+/***********************/
+
+/* Not yet inserted into the Nodestore */
+static UA_Node *
+rcuNsNewNode(UA_Nodestore *_, UA_NodeClass nodeClass) {
+    NodeEntry *entry = newEntry(nodeClass);
+    if(!entry)
+        return NULL;
+    return (UA_Node*)&entry->nodeId;
+}
+
+/* Not yet inserted into the Nodestore */
+static void
+rcuNsDeleteNode(UA_Nodestore *_, UA_Node *node) {
+    deleteEntry(container_of(node, NodeEntry, nodeId));
+}
+
+static const UA_Node *
+rcuNsGetNode(UA_Nodestore *ns, const UA_NodeId *nodeId,
+             UA_UInt32 attributeMask,
+             UA_ReferenceTypeSet references,
+             UA_BrowseDirection referenceDirections) {
+    RCUNodestore *rns = (RCUNodestore*)ns;
+    UA_UInt32 hash = UA_NodeId_hash(nodeId);
+    uintptr_t e = readerEnter(rns);
+    Link *link = findLink(rns, nodeId, hash);
+    NodeEntry *entry = NULL;
+    if(link) {
+        /* The entry cannot be reclaimed before we leave the epoch */
+        entry = (NodeEntry*)UA_atomic_load((void**)&link->entry);
+        atomicAdd(&entry->refCount, 1);
+    }
+    readerLeave(rns, e);
+    return (entry) ? (const UA_Node*)&entry->nodeId : NULL;
+}
+
+static const UA_Node *
+rcuNsGetNodeFromPtr(UA_Nodestore *ns, UA_NodePointer ptr,
+                    UA_UInt32 attributeMask,
+                    UA_ReferenceTypeSet references,
+                    UA_BrowseDirection referenceDirections) {
+    if(!UA_NodePointer_isLocal(ptr))
+        return NULL;
+    UA_NodeId id = UA_NodePointer_toNodeId(ptr);
+    return rcuNsGetNode(ns, &id, attributeMask,
+                        references, referenceDirections);
+}
+
+/* Publish the copy in place of the original version. Must hold the lock. */
+static UA_StatusCode
+publishCopy(RCUNodestore *rns, NodeEntry *entry) {
+    UA_Node *node = (UA_Node*)&entry->nodeId;
+    UA_UInt32 hash = UA_NodeId_hash(&node->head.nodeId);
+    Link *link = findLink(rns, &node->head.nodeId, hash);
+    if(!link) {
+        deleteEntry(entry);
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    }
+
+    /* Test if the copy is current */
+    NodeEntry *oldEntry = link->entry;
+    if(oldEntry != entry->orig) {
+        /* The node was already updated since the copy was made */
+        deleteEntry(entry);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* Replace */
+    prepareEntry(entry);
+    UA_atomic_xchg((void**)&link->entry, entry);
+    retire(rns, RETIRED_ENTRY, oldEntry);
+    tryReclaim(rns);
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+rcuNsReleaseNode(UA_Nodestore *ns, const UA_Node *node) {
+    if(!node)
+        return;
+    NodeEntry *entry = container_of(node, NodeEntry, nodeId);
+
+    /* Publish the edited copy after the outermost release and release the
+     * lock taken in getEditNode */
+    if(entry->state == NODE_EDIT) {
+        RCUNodestore *rns = (RCUNodestore*)ns;
+        entry->editDepth--;
+        if(entry->editDepth == 0) {
+            for(size_t i = 0; i < rns->editsSize; i++) {
+                if(rns->edits[i] != entry)
+                    continue;
+                rns->edits[i] = rns->edits[--rns->editsSize];
+                break;
+            }
+            /* The edit is dropped if the node was removed in the meantime by
+             * the thread holding the edit. Replacing a node with an open edit
+             * is not allowed. */
+            UA_StatusCode res = publishCopy(rns, entry);
+            UA_assert(res != UA_STATUSCODE_BADINTERNALERROR);
+            (void)res;
+        }
+        writeUnlock(rns);
+        return;
+    }
+
+    releaseEntry(entry);
+}
+
+static UA_StatusCode
+rcuNsGetNodeCopy(UA_Nodestore *ns, const UA_NodeId *nodeId,
+                 UA_Node **outNode) {
+    /* The lock prevents that the current version is reclaimed during the
+     * copy */
+    RCUNodestore *rns = (RCUNodestore*)ns;
+    writeLock(rns);
+    Link *link = findLink(rns, nodeId, UA_NodeId_hash(nodeId));
+    if(!link) {
+        writeUnlock(rns);
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    }
+    NodeEntry *ne = copyEntry(link->entry);
+    writeUnlock(rns);
+    if(!ne)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    ne->state = NODE_COPY;
+    *outNode = (UA_Node*)&ne->nodeId;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Editing is done on a private copy that is published in releaseNode. Changes
+ * become visible for all new lookups after the release. The write lock is held
+ * until then, so other writers cannot make the copy outdated. Readers are not
+ * blocked. */
+static UA_Node *
+rcuNsGetEditNode(UA_Nodestore *ns, const UA_NodeId *nodeId,
+                 UA_UInt32 attributeMask,
+                 UA_ReferenceTypeSet references,
+                 UA_BrowseDirection referenceDirections) {
+    RCUNodestore *rns = (RCUNodestore*)ns;
+    writeLock(rns);
+
+    /* Nested edit of the same node (e.g. from an onWrite callback). Return the
+     * open edit. So the changes are published together. */
+    for(size_t i = 0; i < rns->editsSize; i++) {
+        NodeEntry *edit = rns->edits[i];
+        if(UA_NodeId_equal(&edit->nodeId, nodeId)) {
+            edit->editDepth++;
+            return (UA_Node*)&edit->nodeId;
+        }
+    }
+
+    /* Make room to track the edit */
+    if(rns->editsSize == rns->editsCapacity) {
+        size_t cap = (rns->editsCapacity > 0) ? rns->editsCapacity * 2 : 4;
+        NodeEntry **edits = (NodeEntry**)
+            UA_realloc(rns->edits, cap * sizeof(NodeEntry*));
+        if(!edits) {
+            writeUnlock(rns);
+            return NULL;
+        }
+        rns->edits = edits;
+        rns->editsCapacity = cap;
+    }
+
+    Link *link = findLink(rns, nodeId, UA_NodeId_hash(nodeId));
+    NodeEntry *entry = (link) ? copyEntry(link->entry) : NULL;
+    if(!entry) {
+        writeUnlock(rns);
+        return NULL;
+    }
+    entry->state = NODE_EDIT;
+    entry->editDepth = 1;
+    rns->edits[rns->editsSize++] = entry;
+    return (UA_Node*)&entry->nodeId;
+}
+
+static UA_Node *
+rcuNsGetEditNodeFromPtr(UA_Nodestore *ns, UA_NodePointer ptr,
+                        UA_UInt32 attributeMask,
+                        UA_ReferenceTypeSet references,
+                        UA_BrowseDirection referenceDirections) {
+    if(!UA_NodePointer_isLocal(ptr))
+        return NULL;
+    UA_NodeId id = UA_NodePointer_toNodeId(ptr);
+    return rcuNsGetEditNode(ns, &id, attributeMask,
+                            references, referenceDirections);
+}
+
+static UA_StatusCode
+rcuNsInsertNode(UA_Nodestore *ns, UA_Node *node, UA_NodeId *addedNodeId) {
+    NodeEntry *entry = container_of(node, NodeEntry, nodeId);
+    RCUNodestore *rns = (RCUNodestore*)ns;
+    writeLock(rns);
+
+    /* Ensure that the NodeId is unique by testing their presence. If the NodeId
+     * is ns=xx;i=0, then the numeric identifier is replaced with a random
+     * unused int32. It is ensured that the created identifiers are stable after
+     * a server restart (assuming that Nodes are created in the same order and
+     * with the same BrowseName). */
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    UA_UInt32 hash;
+    if(node->head.nodeId.identifierType == UA_NODEIDTYPE_NUMERIC &&
+       node->head.nodeId.identifier.numeric == 0) {
+        Link *found;
+        UA_UInt32 mask = 0x2F;
+        pcg32_random_t rng;
+        pcg32_srandom_r(&rng, rns->size, 0);
+        do {
+            /* Generate a random NodeId. Favor "easy" NodeIds.
+             * Always above 50000. */
+            UA_UInt32 numId = (pcg32_random_r(&rng) & mask) + 50000;
+
+#if SIZE_MAX <= UA_UINT32_MAX
+            /* The compressed "immediate" representation of nodes does not
+             * support the full range on 32bit systems. Generate smaller
+             * identifiers as they can be stored more compactly. */
+            if(numId >= (0x01 << 24))
+                numId = numId % (0x01 << 24);
+#endif
+            node->head.nodeId.identifier.numeric = numId;
+
+            /* Look up the current NodeId */
+            hash = UA_NodeId_hash(&node->head.nodeId);
+            found = findLink(rns, &node->head.nodeId, hash);
+
+            if(found) {
+                /* Reseed the rng using the browseName of the existing node.
+                 * This ensures that different information models end up with
+                 * different NodeId sequences, but still stable after a
+                 * restart. */
+                UA_NodeHead *nh = (UA_NodeHead*)&found->entry->nodeId;
+                pcg32_srandom_r(&rng, rng.state, UA_QualifiedName_hash(&nh->browseName));
+
+                /* Make the mask less strict when the NodeId already exists */
+                mask = (mask << 1) | 0x01;
+            }
+        } while(found);
+    } else {
+        hash = UA_NodeId_hash(&node->head.nodeId);
+        if(findLink(rns, &node->head.nodeId, hash)) { /* The nodeid exists */
+            retval = UA_STATUSCODE_BADNODEIDEXISTS;
+            goto cleanup;
+        }
+    }
+
+    /* Copy the NodeId */
+    if(addedNodeId) {
+        retval = UA_NodeId_copy(&node->head.nodeId, addedNodeId);
+        if(retval != UA_STATUSCODE_GOOD)
+            goto cleanup;
+    }
+
+    /* For new ReferencetypeNodes add to the index map */
+    if(node->head.nodeClass == UA_NODECLASS_REFERENCETYPE) {
+        UA_ReferenceTypeNode *refNode = &node->referenceTypeNode;
+        if(rns->referenceTypeCounter >= UA_REFERENCETYPESET_MAX) {
+            retval = UA_STATUSCODE_BADINTERNALERROR;
+            goto cleanup;
+        }
+
+        retval = UA_NodeId_copy(&node->head.nodeId,
+                                &rns->referenceTypeIds[rns->referenceTypeCounter]);
+        if(retval != UA_STATUSCODE_GOOD) {
+            retval = UA_STATUSCODE_BADINTERNALERROR;
+            goto cleanup;
+        }
+
+        /* Assign the ReferenceTypeIndex to the new ReferenceTypeNode */
+        refNode->referenceTypeIndex = rns->referenceTypeCounter;
+        refNode->subTypes = UA_REFTYPESET(rns->referenceTypeCounter);
+        rns->referenceTypeCounter++;
+    }
+
+    /* Create the link */
+    Link *link = (Link*)UA_malloc(sizeof(Link));
+    if(!link) {
+        retval = UA_STATUSCODE_BADOUTOFMEMORY;
+        goto cleanup;
+    }
+    prepareEntry(entry);
+    link->nodeIdHash = hash;
+    link->entry = entry;
+
+    /* Publish at the head of the bucket. The link is complete before it
+     * becomes visible. */
+    Table *t = rns->table;
+    Link **bucket = &t->buckets[hash & (t->bucketsSize - 1)];
+    link->next = *bucket;
+    storeLink(bucket, link);
+    rns->size++;
+
+    /* Grow the table to keep the chains short */
+    if(rns->size > t->bucketsSize)
+        growTable(rns);
+    tryReclaim(rns);
+    writeUnlock(rns);
+    return UA_STATUSCODE_GOOD;
+
+ cleanup:
+    writeUnlock(rns);
+    deleteEntry(entry);
+    return retval;
+}
+
+static UA_StatusCode
+rcuNsReplaceNode(UA_Nodestore *ns, UA_Node *node) {
+    RCUNodestore *rns = (RCUNodestore*)ns;
+    writeLock(rns);
+    UA_StatusCode res = publishCopy(rns, container_of(node, NodeEntry, nodeId));
+    writeUnlock(rns);
+    return res;
+}
+
+static UA_StatusCode
+rcuNsRemoveNode(UA_Nodestore *ns, const UA_NodeId *nodeId) {
+    RCUNodestore *rns = (RCUNodestore*)ns;
+    writeLock(rns);
+
+    /* Find the link and its predecessor */
+    UA_UInt32 hash = UA_NodeId_hash(nodeId);
+    Table *t = rns->table;
+    Link **prev = &t->buckets[hash & (t->bucketsSize - 1)];
+    Link *link = *prev;
+    for(; link; prev = &link->next, link = link->next) {
+        if(link->nodeIdHash == hash && UA_NodeId_equal(&link->entry->nodeId, nodeId))
+            break;
+    }
+    if(!link) {
+        writeUnlock(rns);
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    }
+
+    /* Unlink. Readers currently on the link can still continue to the next
+     * link. */
+    storeLink(prev, link->next);
+    rns->size--;
+    retire(rns, RETIRED_ENTRY, link->entry);
+    retire(rns, RETIRED_LINK, link);
+    tryReclaim(rns);
+    writeUnlock(rns);
+    return UA_STATUSCODE_GOOD;
+}
+
+static const UA_NodeId *
+rcuNsGetReferenceTypeId(UA_Nodestore *ns, UA_Byte refTypeIndex) {
+    RCUNodestore *rns = (RCUNodestore*)ns;
+    if(refTypeIndex >= rns->referenceTypeCounter)
+        return NULL;
+    return &rns->referenceTypeIds[refTypeIndex];
+}
+
+static void
+rcuNsIterate(UA_Nodestore *ns, UA_NodestoreVisitor visitor,
+             void *visitorCtx) {
+    RCUNodestore *rns = (RCUNodestore*)ns;
+    uintptr_t e = readerEnter(rns);
+    Table *t = (Table*)UA_atomic_load((void**)&rns->table);
+    for(size_t i = 0; i < t->bucketsSize; i++) {
+        Link *link = loadLink(&t->buckets[i]);
+        for(; link; link = loadLink(&link->next)) {
+            NodeEntry *entry = (NodeEntry*)UA_atomic_load((void**)&link->entry);
+            visitor(visitorCtx, (UA_Node*)&entry->nodeId);
+        }
+    }
+    readerLeave(rns, e);
+}
+
+/***********************/
+/* Nodestore Lifecycle */
+/***********************/
+
+static void
+rcuNsFree(UA_Nodestore *ns) {
+    RCUNodestore *rns = (RCUNodestore*)ns;
+
+    /* No more readers. Reclaim everything. */
+    freeRetired(rns->retiredPrevious);
+    freeRetired(rns->retiredCurrent);
+    Table *t = rns->table;
+    for(size_t i = 0; i < t->bucketsSize; i++) {
+        Link *link = t->buckets[i];
+        while(link) {
+            Link *next = link->next;
+            releaseEntry(link->entry);
+            UA_free(link);
+            link = next;
+        }
+    }
+    UA_free(t);
+    UA_free(rns->edits);
+
+    /* Clean up the ReferenceTypes index array */
+    for(size_t i = 0; i < rns->referenceTypeCounter; i++)
+        UA_NodeId_clear(&rns->referenceTypeIds[i]);
+
+#if UA_MULTITHREADING >= 100
+    UA_LOCK_DESTROY(&rns->writeLock);
+#endif
+    UA_free(rns);
+}
+
+UA_Nodestore *
+UA_Nodestore_RCU(void) {
+    /* Allocate and initialize the context */
+    RCUNodestore *rns = (RCUNodestore*)UA_calloc(1, sizeof(RCUNodestore));
+    if(!rns)
+        return NULL;
+    rns->table = newTable(INITIAL_BUCKETS);
+    if(!rns->table) {
+        UA_free(rns);
+        return NULL;
+    }
+#if UA_MULTITHREADING >= 100
+    UA_LOCK_INIT(&rns->writeLock);
+#endif
+
+    /* Populate the nodestore */
+    rns->ns.free = rcuNsFree;
+    rns->ns.newNode = rcuNsNewNode;
+    rns->ns.deleteNode = rcuNsDeleteNode;
+    rns->ns.getNode = rcuNsGetNode;
+    rns->ns.getNodeFromPtr = rcuNsGetNodeFromPtr;
+    rns->ns.getEditNode = rcuNsGetEditNode;
+    rns->ns.getEditNodeFromPtr = rcuNsGetEditNodeFromPtr;
+    rns->ns.releaseNode = rcuNsReleaseNode;
+    rns->ns.getNodeCopy = rcuNsGetNodeCopy;
+    rns->ns.insertNode = rcuNsInsertNode;
+    rns->ns.replaceNode = rcuNsReplaceNode;
+    rns->ns.removeNode = rcuNsRemoveNode;
+    rns->ns.getReferenceTypeId = rcuNsGetReferenceTypeId;
+    rns->ns.iterate = rcuNsIterate;
+    rns->ns.concurrentAccess = true;
+    return &rns->ns;
+}
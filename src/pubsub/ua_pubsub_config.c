@@ -531,6 +531,7 @@ createDataSetReader(UA_PubSubManager *psm, const UA_DataSetReaderDataType *dsrPa
     config.dataSetMetaData = dsrParams->dataSetMetaData;
     config.dataSetFieldContentMask = dsrParams->dataSetFieldContentMask;
     config.messageReceiveTimeout =  dsrParams->messageReceiveTimeout;
+    config.keyFrameCount = dsrParams->keyFrameCount;
     config.messageSettings = dsrParams->messageSettings;
     config.enabled = false;  /* Always create disabled, enabling during the last stage of updatePubSubConfig */
     UA_StatusCode res = UA_PublisherId_fromVariant(&config.publisherId,
@@ -919,6 +920,7 @@ generateDataSetReaderDataType(const UA_DataSetReader *src,
     dst->dataSetWriterId = src->config.dataSetWriterId;
     dst->dataSetFieldContentMask = src->config.dataSetFieldContentMask;
     dst->messageReceiveTimeout = src->config.messageReceiveTimeout;
+    dst->keyFrameCount = src->config.keyFrameCount;
     res |= UA_String_copy(&src->config.name, &dst->name);
     res |= UA_DataSetMetaDataType_copy(&src->config.dataSetMetaData,
                                        &dst->dataSetMetaData);
@@ -78,6 +78,8 @@ UA_PubSubConnection_create(UA_PubSubManager *psm, const UA_PubSubConnectionConfi
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
     c->head.componentType = UA_PUBSUBCOMPONENT_CONNECTION;
+    size_t arenaSize = psm->sc.server->config.pubSubConfig.decodeArenaSize;
+    UA_Arena_init(&c->decodeArena, arenaSize, arenaSize * 16);
 
     /* Copy the connection config */
     UA_StatusCode ret = UA_PubSubConnectionConfig_copy(cc, &c->config);
@@ -221,6 +223,7 @@ UA_PubSubConnection_delete(UA_PubSubManager *psm, UA_PubSubConnection *c) {
 
     UA_PubSubConnectionConfig_clear(&c->config);
     UA_PubSubComponentHead_clear(&c->head);
+    UA_Arena_clear(&c->decodeArena);
     UA_free(c);
 
     return UA_STATUSCODE_GOOD;
@@ -235,20 +238,26 @@ UA_PubSubConnection_process(UA_PubSubManager *psm, UA_PubSubConnection *c,
     UA_dump_hex_pkg(msg.data, msg.length);
 #endif
 
+    UA_EventLoop *el = psm->sc.server->config.eventLoop;
+    UA_DateTime received = el->dateTime_nowMonotonic(el);
     UA_Boolean processed = false;
     UA_NetworkMessage nm;
     memset(&nm, 0, sizeof(UA_NetworkMessage));
 
-    /* Decode the NetworkMessage with the first matching ReaderGroup */
+    /* Decode the NetworkMessage with the first matching ReaderGroup. UADP is
+     * decoded into the arena of the connection. */
     UA_ReaderGroup *rg;
+    UA_Arena *arena = NULL;
     UA_StatusCode res = UA_STATUSCODE_BADNOTFOUND;
     LIST_FOREACH(rg, &c->readerGroups, listEntry) {
         if(rg->head.state != UA_PUBSUBSTATE_OPERATIONAL &&
            rg->head.state != UA_PUBSUBSTATE_PREOPERATIONAL)
             continue;
         if(rg->config.encodingMimeType == UA_PUBSUB_ENCODING_UADP) {
-            res = UA_ReaderGroup_decodeNetworkMessage(psm, rg, msg, &nm);
+            arena = (c->decodeArena.blockSize > 0) ? &c->decodeArena : NULL;
+            res = UA_ReaderGroup_decodeNetworkMessage(psm, rg, msg, &nm, arena);
         } else {
+            arena = NULL;
 #ifdef UA_ENABLE_JSON_ENCODING
             res = UA_ReaderGroup_decodeNetworkMessageJSON(psm, rg, msg, &nm);
 #else
@@ -262,15 +271,21 @@ UA_PubSubConnection_process(UA_PubSubManager *psm, UA_PubSubConnection *c,
 
     if(res != UA_STATUSCODE_GOOD)
         goto finish;
+    UA_PubSubTimingHistogram_add(&rg->timing.decodeTime,
+                                 el->dateTime_nowMonotonic(el) - received);
 
     /* Process the received message for all ReaderGroups */
     LIST_FOREACH(rg, &c->readerGroups, listEntry) {
         if(rg->head.state != UA_PUBSUBSTATE_OPERATIONAL &&
            rg->head.state != UA_PUBSUBSTATE_PREOPERATIONAL)
             continue;
-        processed |= UA_ReaderGroup_process(psm, rg, &nm);
+        if(!UA_ReaderGroup_process(psm, rg, &nm))
+            continue;
+        UA_PubSubTimingHistogram_add(&rg->timing.receiveToApply,
+                                     el->dateTime_nowMonotonic(el) - received);
+        processed = true;
     }
-    UA_NetworkMessage_clear(&nm);
+    UA_ReaderGroup_releaseNetworkMessage(&nm, arena);
 
  finish:
     if(!processed) {
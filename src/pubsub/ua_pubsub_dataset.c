@@ -444,6 +444,56 @@ UA_PubSubDataSetField_sampleValue(UA_PubSubManager *psm, UA_DataSetField *field,
                              &rvid, UA_TIMESTAMPSTORETURN_BOTH);
 }
 
+const UA_Node *
+UA_PubSubDataSetField_peekValue(UA_PubSubManager *psm, UA_DataSetField *field,
+                                UA_DataValue *value) {
+    UA_Server *server = psm->sc.server;
+    UA_PublishedVariableDataType *params = &field->config.field.variable.publishParameters;
+
+    /* Get the node if the value attribute is published without an IndexRange */
+    const UA_Node *node = NULL;
+    if(params->attributeId == UA_ATTRIBUTEID_VALUE && params->indexRange.length == 0)
+        node = UA_NODESTORE_GET_SELECTIVE(server, &params->publishedVariable,
+                                          UA_NODEATTRIBUTESMASK_VALUE,
+                                          UA_REFERENCETYPESET_NONE,
+                                          UA_BROWSEDIRECTION_INVALID);
+
+    /* The value is stored in the node and no onRead callback has to be
+     * notified. The admin session has all access rights. */
+    const UA_DataValue *dv = NULL;
+    if(node && node->head.nodeClass == UA_NODECLASS_VARIABLE) {
+        const UA_VariableNode *vn = &node->variableNode;
+        if(vn->valueSourceType == UA_VALUESOURCETYPE_INTERNAL &&
+           !vn->valueSource.internal.notifications.onRead)
+            dv = &vn->valueSource.internal.value;
+        else if(vn->valueSourceType == UA_VALUESOURCETYPE_EXTERNAL &&
+                !vn->valueSource.external.notifications.onRead)
+            dv = (const UA_DataValue*)
+                UA_atomic_load((void**)vn->valueSource.external.value);
+    }
+
+    /* Fall back to the read service */
+    if(!dv) {
+        if(node)
+            UA_NODESTORE_RELEASE(server, node);
+        UA_PubSubDataSetField_sampleValue(psm, field, value);
+        return NULL;
+    }
+
+    /* Shallow copy with the timestamps set as in the read service */
+    UA_EventLoop *el = server->config.eventLoop;
+    *value = *dv;
+    value->hasValue = true;
+    value->serverTimestamp = el->dateTime_now(el);
+    value->hasServerTimestamp = true;
+    value->hasServerPicoseconds = false;
+    if(!value->hasSourceTimestamp) {
+        value->sourceTimestamp = value->serverTimestamp;
+        value->hasSourceTimestamp = true;
+    }
+    return node;
+}
+
 UA_AddPublishedDataSetResult
 UA_PublishedDataSet_create(UA_PubSubManager *psm,
                            const UA_PublishedDataSetConfig *publishedDataSetConfig,
@@ -93,6 +93,9 @@ _UA_BEGIN_DECLS
 struct UA_WriterGroup;
 typedef struct UA_WriterGroup UA_WriterGroup;
 
+struct UA_WriterGroupPublishTimer;
+typedef struct UA_WriterGroupPublishTimer UA_WriterGroupPublishTimer;
+
 struct UA_ReaderGroup;
 typedef struct UA_ReaderGroup UA_ReaderGroup;
 
@@ -156,6 +159,10 @@ typedef struct {
 void
 UA_PubSubComponentHead_clear(UA_PubSubComponentHead *psch);
 
+/* Add a duration (in UA_DateTime ticks) to the histogram */
+void
+UA_PubSubTimingHistogram_add(UA_PubSubTimingHistogram *h, UA_DateTime duration);
+
 /**********************************************/
 /*            PublishedDataSet                */
 /**********************************************/
@@ -249,6 +256,10 @@ typedef struct UA_PubSubConnection {
 
     UA_DateTime silenceErrorUntil; /* Avoid generating too many logs */
 
+    /* Received UADP NetworkMessages are decoded into the arena. It is reset
+     * after the message was processed by all ReaderGroups. */
+    UA_Arena decodeArena;
+
     UA_Boolean deleteFlag; /* To be deleted - in addition to the PubSubState */
     UA_DelayedCallback dc; /* For delayed freeing */
 } UA_PubSubConnection;
@@ -335,14 +346,21 @@ struct UA_WriterGroup {
     UA_UInt32 writersCount;
 
     UA_UInt64 publishCallbackId; /* registered if != 0 */
+    UA_WriterGroupPublishTimer *publishTimer; /* In a dedicated EventLoop */
     UA_UInt16 sequenceNumber; /* Increased after every sent message */
     UA_DateTime lastPublishTimeStamp;
 
+    /* Reset when the publish callback is registered. Protected by the
+     * publishLock, as the sign and send times are recorded without the server
+     * lock. */
+    UA_WriterGroupTiming timing;
+    UA_DateTime lastWakeup; /* Monotonic time of the last publish callback */
+
     /* The ConnectionManager pointer is stored in the Connection. The channels
      * are either stored here or in the Connection, but never both. */
     UA_PubSubConnection *linkedConnection;
     uintptr_t sendChannel;
-    UA_Boolean deleteFlag;
+    UA_Boolean deleteFlag; /* Also set under the publishLock */
 
     UA_UInt32 securityTokenId;
     UA_UInt32 nonceSequenceNumber; /* To be part of the MessageNonce */
@@ -350,6 +368,26 @@ struct UA_WriterGroup {
 #ifdef UA_ENABLE_PUBSUB_SKS
     UA_PubSubKeyStorage *keyStorage; /* non-owning pointer to keyStorage*/
 #endif
+
+    /* Frozen layout. If the encoded layout of the NetworkMessage does not
+     * change, the encoded message is kept with its offset table. Then every
+     * publish cycle only patches the sequence numbers, timestamps and field
+     * values in place. */
+    UA_PubSubOffsetTable frozen;
+    size_t *frozenEnds;    /* End of the content for every offset */
+    UA_UInt16 frozenRetry; /* Publish cycles until the next attempt to freeze */
+
+#if UA_MULTITHREADING >= 100
+    /* Protects the timing statistics and the publishing flag. Can be taken
+     * after the server lock. No other lock is taken while it is held. */
+    UA_Lock publishLock;
+#endif
+
+    /* Set while a publish cycle signs, encrypts and sends without the server
+     * lock. In the meantime the WriterGroup is not freed and the security
+     * context used by the cycle is not modified. */
+    UA_Boolean publishing;
+    void *publishingSecurityContext;
 };
 
 UA_StatusCode
@@ -367,6 +405,11 @@ UA_WriterGroup_addPublishCallback(UA_PubSubManager *psm, UA_WriterGroup *wg);
 void
 UA_WriterGroup_removePublishCallback(UA_PubSubManager *psm, UA_WriterGroup *wg);
 
+/* Drop the frozen NetworkMessage. Called whenever the WriterGroup or one of
+ * its DataSetWriters changes. */
+void
+UA_WriterGroup_clearFrozenMessage(UA_WriterGroup *wg);
+
 UA_StatusCode
 UA_WriterGroup_setEncryptionKeys(UA_PubSubManager *psm, UA_WriterGroup *wg,
                                  UA_UInt32 securityTokenId,
@@ -422,10 +465,25 @@ UA_PubSubDataSetField_sampleValue(UA_PubSubManager *psm,
                                   UA_DataSetField *field,
                                   UA_DataValue *value);
 
+/* Sample the value without a deep copy if it is stored in the node. Then the
+ * node is returned and has to be released after the (shallow) value was used.
+ * Otherwise NULL is returned and the sampled value has to be cleared. */
+const UA_Node *
+UA_PubSubDataSetField_peekValue(UA_PubSubManager *psm,
+                                UA_DataSetField *field,
+                                UA_DataValue *value);
+
 /**********************************************/
 /*               DataSetReader                */
 /**********************************************/
 
+/* TargetVariable that was resolved when the DataSetReader was enabled */
+typedef struct {
+    const UA_DataType *type; /* NULL if the target is not bound */
+    UA_Boolean scalar;       /* Scalar values can be written */
+    UA_Boolean array;        /* One-dimensional arrays can be written */
+} UA_BoundTargetVariable;
+
 struct UA_DataSetReader {
     UA_PubSubComponentHead head;
     LIST_ENTRY(UA_DataSetReader) listEntry;
@@ -435,6 +493,24 @@ struct UA_DataSetReader {
 
     /* MessageReceiveTimeout handling */
     UA_UInt64 msgRcvTimeoutTimerId;
+
+    /* Resolved TargetVariables if config.bindTargetVariables is set */
+    UA_BoundTargetVariable *boundTargets;
+    size_t boundTargetsSize;
+    UA_DataSetReaderTargetStatistics targetStats;
+    UA_DateTime targetStatsStart;
+
+    /* DeltaFrame state. The TargetVariables hold the last value of every
+     * field. DeltaFrames are only applied while the reader is in sync with the
+     * writer, i.e. after a KeyFrame without a lost message since. */
+    UA_Boolean deltaSynced;
+    UA_Boolean lastSequenceNrValid;
+    UA_UInt16 lastSequenceNr;
+    UA_UInt32 deltaFramesSinceKeyFrame;
+
+    /* Entry in the dispatch index of the ReaderGroup */
+    UA_UInt32 dispatchHash;
+    UA_DataSetReader *dispatchNext; /* Next reader with the same key */
 };
 
 UA_DataSetReader *
@@ -485,6 +561,13 @@ struct UA_ReaderGroup {
     LIST_HEAD(, UA_DataSetReader) readers;
     UA_UInt32 readersCount;
 
+    /* Index of the readers by (PublisherId, WriterGroupId, DataSetWriterId).
+     * Open addressing with linear probing, the size is a power of two. Each
+     * slot points to the first reader of a chain with the same key. The index
+     * is dropped when the readers change and rebuilt on the next lookup. */
+    UA_DataSetReader **dispatch;
+    size_t dispatchSize;
+
     UA_Boolean hasReceived; /* Received a message since the last _connect */
 
     /* The ConnectionManager pointer is stored in the Connection. The channels 
@@ -500,6 +583,8 @@ struct UA_ReaderGroup {
 #ifdef UA_ENABLE_PUBSUB_SKS
     UA_PubSubKeyStorage *keyStorage;
 #endif
+
+    UA_ReaderGroupTiming timing; /* Reset when the ReaderGroup is enabled */
 };
 
 UA_StatusCode
@@ -517,6 +602,10 @@ UA_ReaderGroup_connect(UA_PubSubManager *psm, UA_ReaderGroup *rg,
 UA_Boolean
 UA_ReaderGroup_canConnect(UA_ReaderGroup *rg);
 
+/* Drop the dispatch index after the readers or their config have changed */
+void
+UA_ReaderGroup_clearDispatchIndex(UA_ReaderGroup *rg);
+
 void
 UA_ReaderGroup_disconnect(UA_ReaderGroup *rg);
 
@@ -549,11 +638,20 @@ verifyAndDecryptNetworkMessage(const UA_Logger *logger, UA_ByteString buffer,
                                Ctx *ctx, UA_NetworkMessage *nm,
                                UA_ReaderGroup *rg);
 
+/* If the arena is non-NULL, the NetworkMessage is decoded into the arena and
+ * must not be cleared. Use UA_ReaderGroup_releaseNetworkMessage with the same
+ * arena after processing. The message is released internally if decoding
+ * fails. */
 UA_StatusCode
 UA_ReaderGroup_decodeNetworkMessage(UA_PubSubManager *psm,
                                     UA_ReaderGroup *rg,
                                     UA_ByteString buffer,
-                                    UA_NetworkMessage *nm);
+                                    UA_NetworkMessage *nm,
+                                    UA_Arena *arena);
+
+/* Clear the NetworkMessage or reset the arena it was decoded into */
+void
+UA_ReaderGroup_releaseNetworkMessage(UA_NetworkMessage *nm, UA_Arena *arena);
 
 #ifdef UA_ENABLE_JSON_ENCODING
 UA_StatusCode
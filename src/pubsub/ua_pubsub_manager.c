@@ -45,6 +45,23 @@ UA_PubSubComponentHead_clear(UA_PubSubComponentHead *psch) {
     memset(psch, 0, sizeof(UA_PubSubComponentHead));
 }
 
+void
+UA_PubSubTimingHistogram_add(UA_PubSubTimingHistogram *h, UA_DateTime duration) {
+    UA_UInt64 us = (duration > 0) ? (UA_UInt64)duration / UA_DATETIME_USEC : 0;
+    if(h->count == 0 || us < h->min)
+        h->min = us;
+    if(us > h->max)
+        h->max = us;
+    h->count++;
+    h->sum += us;
+
+    /* Bucket i counts [2^(i-1), 2^i) */
+    size_t bucket = 0;
+    for(; us > 0 && bucket < UA_PUBSUB_TIMINGBUCKETS - 1; us >>= 1)
+        bucket++;
+    h->buckets[bucket]++;
+}
+
 UA_StatusCode
 UA_PublisherId_copy(const UA_PublisherId *src,
                     UA_PublisherId *dst) {
@@ -289,7 +289,7 @@ getFieldMetaData(const UA_DataSetMessage_EncodingMetaData *emd,
                  size_t index) {
     if(!emd)
         return NULL;
-    if(index > emd->fieldsSize)
+    if(index >= emd->fieldsSize)
         return NULL;
     return &emd->fields[index];
 }
@@ -747,10 +747,12 @@ UA_NetworkMessage_decodeFooters(PubSubDecodeCtx *ctx,
        nm->securityHeader.securityFooterSize == 0)
         return UA_STATUSCODE_GOOD;
     
-    UA_StatusCode rv = UA_ByteString_allocBuffer(&nm->securityFooter,
-                                                 nm->securityHeader.securityFooterSize);
-    UA_CHECK_STATUS(rv, return rv);
-    
+    nm->securityFooter.data = (UA_Byte*)
+        ctxCalloc(&ctx->ctx, nm->securityHeader.securityFooterSize, sizeof(UA_Byte));
+    UA_CHECK_MEM(nm->securityFooter.data, return UA_STATUSCODE_BADOUTOFMEMORY);
+    nm->securityFooter.length = nm->securityHeader.securityFooterSize;
+
+    UA_StatusCode rv = UA_STATUSCODE_GOOD;
     for(UA_UInt16 i = 0; i < nm->securityHeader.securityFooterSize; i++) {
         rv |= _DECODE_BINARY(&nm->securityFooter.data[i], BYTE);
     }
@@ -1582,6 +1584,10 @@ UA_DataSetMessage_deltaFrame_decodeBinary(PubSubDecodeCtx *ctx,
     UA_StatusCode rv = _DECODE_BINARY(&dsm->fieldCount, UINT16);
     UA_CHECK_STATUS(rv, return rv);
 
+    /* No field has changed */
+    if(dsm->fieldCount == 0)
+        return UA_STATUSCODE_GOOD;
+
     dsm->data.deltaFrameFields = (UA_DataSetMessage_DeltaFrameField *)
         ctxCalloc(&ctx->ctx, dsm->fieldCount, sizeof(UA_DataSetMessage_DeltaFrameField));
     if(!dsm->data.deltaFrameFields)
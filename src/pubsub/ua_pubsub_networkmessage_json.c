@@ -92,47 +92,48 @@ UA_DataSetMessage_encodeJson_internal(CtxJson *ctx,
     }
 
     /* MessageType */
+    UA_String s;
     if(src->header.dataSetMessageType == UA_DATASETMESSAGE_DATAKEYFRAME) {
-        UA_String s = UA_STRING("ua-keyframe");
-        rv |= writeJsonObjElm(ctx, UA_DECODEKEY_MESSAGETYPE,
-                              &s, &UA_TYPES[UA_TYPES_STRING]);
+        s = UA_STRING("ua-keyframe");
+    } else if(src->header.dataSetMessageType == UA_DATASETMESSAGE_DATADELTAFRAME) {
+        s = UA_STRING("ua-deltaframe");
     } else {
         /* TODO: Support other message types */
         return UA_STATUSCODE_BADNOTSUPPORTED;
     }
+    rv |= writeJsonObjElm(ctx, UA_DECODEKEY_MESSAGETYPE,
+                          &s, &UA_TYPES[UA_TYPES_STRING]);
+
+    /* RawData */
+    if(src->header.fieldEncoding != UA_FIELDENCODING_VARIANT &&
+       src->header.fieldEncoding != UA_FIELDENCODING_DATAVALUE)
+        return UA_STATUSCODE_BADNOTIMPLEMENTED;
 
     rv |= writeJsonKey(ctx, UA_DECODEKEY_PAYLOAD);
     rv |= writeJsonObjStart(ctx);
 
-    if(src->header.fieldEncoding == UA_FIELDENCODING_VARIANT) {
-        /* Variant */
-        for(UA_UInt16 i = 0; i < src->fieldCount; i++) {
-            const UA_FieldMetaData *fmd = getFieldMetaData(emd, i);
-            if(fmd)
-                rv |= writeJsonKey_UA_String(ctx, &fmd->name);
-            else
-                rv |= writeJsonKey(ctx, "");
+    /* The fields of a DeltaFrame are identified by the name of the field at
+     * their index in the DataSet */
+    UA_Boolean delta =
+        (src->header.dataSetMessageType == UA_DATASETMESSAGE_DATADELTAFRAME);
+    for(UA_UInt16 i = 0; i < src->fieldCount; i++) {
+        const UA_DataValue *field = (delta) ?
+            &src->data.deltaFrameFields[i].value : &src->data.keyFrameFields[i];
+        const UA_FieldMetaData *fmd = (delta) ?
+            getFieldMetaData(emd, src->data.deltaFrameFields[i].index) :
+            getFieldMetaData(emd, i);
+        if(fmd)
+            rv |= writeJsonKey_UA_String(ctx, &fmd->name);
+        else
+            rv |= writeJsonKey(ctx, "");
+        if(src->header.fieldEncoding == UA_FIELDENCODING_VARIANT)
             rv |= encodeJsonJumpTable[UA_DATATYPEKIND_VARIANT]
-                (ctx, &src->data.keyFrameFields[i].value, NULL);
-            if(rv != UA_STATUSCODE_GOOD)
-                return rv;
-        }
-    } else if(src->header.fieldEncoding == UA_FIELDENCODING_DATAVALUE) {
-        /* DataValue */
-        for(UA_UInt16 i = 0; i < src->fieldCount; i++) {
-            const UA_FieldMetaData *fmd = getFieldMetaData(emd, i);
-            if(fmd)
-                rv |= writeJsonKey_UA_String(ctx, &fmd->name);
-            else
-                rv |= writeJsonKey(ctx, "");
+                (ctx, &field->value, NULL);
+        else
             rv |= encodeJsonJumpTable[UA_DATATYPEKIND_DATAVALUE]
-                (ctx, &src->data.keyFrameFields[i], NULL);
-            if(rv != UA_STATUSCODE_GOOD)
-                return rv;
-        }
-    } else {
-        /* RawData */
-        return UA_STATUSCODE_BADNOTIMPLEMENTED;
+                (ctx, field, NULL);
+        if(rv != UA_STATUSCODE_GOOD)
+            return rv;
     }
     rv |= writeJsonObjEnd(ctx); /* Payload */
     rv |= writeJsonObjEnd(ctx); /* DataSetMessage */
@@ -327,10 +328,23 @@ DataSetPayload_decodeJsonInternal(PubSubDecodeJsonCtx *ctx, void *data, const UA
     UA_assert(ctx->ctx.tokens[ctx->ctx.index].size % 2 == 0);
     size_t length = (size_t)(ctx->ctx.tokens[ctx->ctx.index].size) / 2;
 
-    dsm->data.keyFrameFields = (UA_DataValue *)
-        UA_Array_new(length, &UA_TYPES[UA_TYPES_DATAVALUE]);
-    if(!dsm->data.keyFrameFields)
-        return UA_STATUSCODE_BADOUTOFMEMORY;
+    /* The fields of a DeltaFrame are stored in the order of the message. The
+     * index is looked up from the field name. */
+    UA_Boolean delta =
+        (dsm->header.dataSetMessageType == UA_DATASETMESSAGE_DATADELTAFRAME);
+    if(delta) {
+        if(length > 0) {
+            dsm->data.deltaFrameFields = (UA_DataSetMessage_DeltaFrameField *)
+                UA_calloc(length, sizeof(UA_DataSetMessage_DeltaFrameField));
+            if(!dsm->data.deltaFrameFields)
+                return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+    } else {
+        dsm->data.keyFrameFields = (UA_DataValue *)
+            UA_Array_new(length, &UA_TYPES[UA_TYPES_DATAVALUE]);
+        if(!dsm->data.keyFrameFields)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
     dsm->fieldCount = (UA_UInt16)length;
 
     dsm->header.fieldEncoding = UA_FIELDENCODING_DATAVALUE;
@@ -348,10 +362,20 @@ DataSetPayload_decodeJsonInternal(PubSubDecodeJsonCtx *ctx, void *data, const UA
         UA_CHECK_STATUS(ret, return ret);
 
         size_t index = decodingFieldIndex(emd, fieldName, i);
-        UA_DataValue_clear(&dsm->data.keyFrameFields[index]);
         UA_String_clear(&fieldName);
-        ret = decodeJsonJumpTable[UA_DATATYPEKIND_DATAVALUE]
-            (&ctx->ctx, &dsm->data.keyFrameFields[index], NULL);
+        if(delta) {
+            if(index > UA_UINT16_MAX)
+                return UA_STATUSCODE_BADDECODINGERROR;
+            dsm->data.deltaFrameFields[i].index = (UA_UInt16)index;
+            ret = decodeJsonJumpTable[UA_DATATYPEKIND_DATAVALUE]
+                (&ctx->ctx, &dsm->data.deltaFrameFields[i].value, NULL);
+        } else {
+            if(index >= length)
+                return UA_STATUSCODE_BADDECODINGERROR;
+            UA_DataValue_clear(&dsm->data.keyFrameFields[index]);
+            ret = decodeJsonJumpTable[UA_DATATYPEKIND_DATAVALUE]
+                (&ctx->ctx, &dsm->data.keyFrameFields[index], NULL);
+        }
         UA_CHECK_STATUS(ret, return ret);
     }
 
@@ -376,6 +400,21 @@ DatasetMessage_Payload_decodeJsonInternal(PubSubDecodeJsonCtx *ctx, UA_NetworkMe
         {UA_DECODEKEY_MESSAGETYPE, NULL, NULL, false, NULL},
         {UA_DECODEKEY_PAYLOAD, &pd, (decodeJsonSignature)DataSetPayload_decodeJsonInternal, false, NULL}
     };
+
+    /* The MessageType determines how the payload is decoded. Look it up before
+     * the payload. Unknown message types are decoded as KeyFrames. */
+    dsm->header.dataSetMessageType = UA_DATASETMESSAGE_DATAKEYFRAME;
+    size_t searchResultMessageType = 0;
+    if(currentTokenType(&ctx->ctx) == CJ5_TOKEN_OBJECT &&
+       lookAheadForKey(&ctx->ctx, UA_DECODEKEY_MESSAGETYPE,
+                       &searchResultMessageType) == UA_STATUSCODE_GOOD) {
+        size_t size = getTokenLength(&ctx->ctx.tokens[searchResultMessageType]);
+        const char *msgType =
+            &ctx->ctx.json5[ctx->ctx.tokens[searchResultMessageType].start];
+        if(size == 13 && strncmp(msgType, "ua-deltaframe", size) == 0)
+            dsm->header.dataSetMessageType = UA_DATASETMESSAGE_DATADELTAFRAME;
+    }
+
     status ret = decodeFields(&ctx->ctx, entries, 7);
 
     /* Error or no DatasetWriterId found or no payload found */
@@ -392,7 +431,6 @@ DatasetMessage_Payload_decodeJsonInternal(PubSubDecodeJsonCtx *ctx, UA_NetworkMe
     dsm->header.timestampEnabled = entries[3].found;
     dsm->header.statusEnabled = entries[4].found;
 
-    dsm->header.dataSetMessageType = UA_DATASETMESSAGE_DATAKEYFRAME;
     dsm->header.picoSecondsIncluded = false;
     dsm->header.dataSetMessageValid = true;
     dsm->header.fieldEncoding = UA_FIELDENCODING_VARIANT;
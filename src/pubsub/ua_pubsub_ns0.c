@@ -20,6 +20,39 @@ typedef struct {
     UA_UInt32 elementClassiefier;
 } UA_NodePropertyContext;
 
+/* Element classifiers for the vendor-specific timing variables. Chosen outside
+ * of the range of the NS0 identifiers. */
+#define UA_PUBSUB_TIMING_WAKEUPLATENCY  0x80000001
+#define UA_PUBSUB_TIMING_ENCODETIME     0x80000002
+#define UA_PUBSUB_TIMING_SIGNTIME       0x80000003
+#define UA_PUBSUB_TIMING_SENDTIME       0x80000004
+#define UA_PUBSUB_TIMING_MISSEDCYCLES   0x80000005
+#define UA_PUBSUB_TIMING_DECODETIME     0x80000006
+#define UA_PUBSUB_TIMING_RECEIVETOAPPLY 0x80000007
+
+typedef struct {
+    const char *name;
+    UA_UInt32 classifier;
+} TimingVariable;
+
+static const TimingVariable writerGroupTimingVariables[] = {
+    {"WakeupLatency", UA_PUBSUB_TIMING_WAKEUPLATENCY},
+    {"EncodeTime", UA_PUBSUB_TIMING_ENCODETIME},
+    {"SignTime", UA_PUBSUB_TIMING_SIGNTIME},
+    {"SendTime", UA_PUBSUB_TIMING_SENDTIME},
+    {"MissedCycles", UA_PUBSUB_TIMING_MISSEDCYCLES}
+};
+
+static const TimingVariable readerGroupTimingVariables[] = {
+    {"DecodeTime", UA_PUBSUB_TIMING_DECODETIME},
+    {"ReceiveToApply", UA_PUBSUB_TIMING_RECEIVETOAPPLY}
+};
+
+static UA_StatusCode
+addTimingRepresentation(UA_Server *server, const UA_NodeId groupId,
+                        UA_UInt32 groupClassifier, const TimingVariable *vars,
+                        size_t varsSize);
+
 static UA_StatusCode
 writePubSubNs0VariableArray(UA_Server *server, const UA_NodeId id, void *v,
                             size_t length, const UA_DataType *type) {
@@ -359,6 +392,44 @@ disablePubSubObjectAction(UA_Server *server, const UA_NodeId *sessionId, void *s
     return retVal;
 }
 
+/* The histograms are exposed as the array of bucket counts */
+static UA_StatusCode
+readTimingHistogram(const UA_PubSubTimingHistogram *h, UA_DataValue *value) {
+    value->hasValue = true;
+    return UA_Variant_setArrayCopy(&value->value, h->buckets, UA_PUBSUB_TIMINGBUCKETS,
+                                   &UA_TYPES[UA_TYPES_UINT64]);
+}
+
+static UA_StatusCode
+readWriterGroupTiming(UA_WriterGroup *wg, UA_UInt32 classifier, UA_DataValue *value) {
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    UA_LOCK(&wg->publishLock);
+    switch(classifier) {
+    case UA_PUBSUB_TIMING_WAKEUPLATENCY:
+        res = readTimingHistogram(&wg->timing.wakeupLatency, value);
+        break;
+    case UA_PUBSUB_TIMING_ENCODETIME:
+        res = readTimingHistogram(&wg->timing.encodeTime, value);
+        break;
+    case UA_PUBSUB_TIMING_SIGNTIME:
+        res = readTimingHistogram(&wg->timing.signTime, value);
+        break;
+    case UA_PUBSUB_TIMING_SENDTIME:
+        res = readTimingHistogram(&wg->timing.sendTime, value);
+        break;
+    case UA_PUBSUB_TIMING_MISSEDCYCLES:
+        value->hasValue = true;
+        res = UA_Variant_setScalarCopy(&value->value, &wg->timing.missedCycles,
+                                       &UA_TYPES[UA_TYPES_UINT64]);
+        break;
+    default:
+        res = UA_STATUSCODE_BADINTERNALERROR;
+        break;
+    }
+    UA_UNLOCK(&wg->publishLock);
+    return res;
+}
+
 static UA_StatusCode
 ReadCallback(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
              const UA_NodeId *nodeid, void *context, UA_Boolean includeSourceTimeStamp,
@@ -389,10 +460,16 @@ ReadCallback(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext
         UA_ReaderGroup *readerGroup = UA_ReaderGroup_find(psm, *myNodeId);
         if(!readerGroup)
             return UA_STATUSCODE_BADNOTFOUND;
-        if(nodeContext->elementClassiefier == UA_NS0ID_PUBSUBGROUPTYPE_STATUS_STATE) {
+        switch(nodeContext->elementClassiefier) {
+        case UA_NS0ID_PUBSUBGROUPTYPE_STATUS_STATE:
             value->hasValue = true;
             return UA_Variant_setScalarCopy(&value->value, &readerGroup->head.state,
                                             &UA_TYPES[UA_TYPES_PUBSUBSTATE]);
+        case UA_PUBSUB_TIMING_DECODETIME:
+            return readTimingHistogram(&readerGroup->timing.decodeTime, value);
+        case UA_PUBSUB_TIMING_RECEIVETOAPPLY:
+            return readTimingHistogram(&readerGroup->timing.receiveToApply, value);
+        default: break;
         }
         break;
     }
@@ -431,6 +508,13 @@ ReadCallback(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext
             return UA_Variant_setScalarCopy(&value->value, &writerGroup->head.state,
                                             &UA_TYPES[UA_TYPES_PUBSUBSTATE]);
             break;
+        case UA_PUBSUB_TIMING_WAKEUPLATENCY:
+        case UA_PUBSUB_TIMING_ENCODETIME:
+        case UA_PUBSUB_TIMING_SIGNTIME:
+        case UA_PUBSUB_TIMING_SENDTIME:
+        case UA_PUBSUB_TIMING_MISSEDCYCLES:
+            return readWriterGroupTiming(writerGroup, nodeContext->elementClassiefier,
+                                         value);
         default: break;
         }
         break;
@@ -1748,6 +1832,12 @@ addWriterGroupRepresentation(UA_Server *server, UA_WriterGroup *writerGroup) {
 
     }
 
+    retVal |= addTimingRepresentation(server, writerGroup->head.identifier,
+                                      UA_NS0ID_WRITERGROUPTYPE,
+                                      writerGroupTimingVariables,
+                                      sizeof(writerGroupTimingVariables) /
+                                      sizeof(TimingVariable));
+
     /* Add reference to methods */
     if(server->config.pubSubConfig.enableInformationModelMethods) {
         retVal |= addRef(server, writerGroup->head.identifier,
@@ -1806,6 +1896,100 @@ removeGroupAction(UA_Server *server,
     }
 }
 
+/**********************************************/
+/*               Group Timing                 */
+/**********************************************/
+
+/* Add the vendor-specific Timing object with read-only variables below a
+ * WriterGroup or ReaderGroup. The MissedCycles counter is a scalar, all other
+ * variables are the bucket counts of a UA_PubSubTimingHistogram. */
+static UA_StatusCode
+addTimingRepresentation(UA_Server *server, const UA_NodeId groupId,
+                        UA_UInt32 groupClassifier, const TimingVariable *vars,
+                        size_t varsSize) {
+    UA_LOCK_ASSERT(&server->serviceMutex);
+
+    UA_NodeId timingId;
+    UA_ObjectAttributes object_attr = UA_ObjectAttributes_default;
+    object_attr.displayName = UA_LOCALIZEDTEXT("", "Timing");
+    UA_StatusCode retVal =
+        addNode(server, UA_NODECLASS_OBJECT, UA_NODEID_NUMERIC(1, 0), groupId,
+                UA_NS0ID(HASCOMPONENT), UA_QUALIFIEDNAME(1, "Timing"),
+                UA_NS0ID(BASEOBJECTTYPE), &object_attr,
+                &UA_TYPES[UA_TYPES_OBJECTATTRIBUTES], NULL, &timingId);
+    if(retVal != UA_STATUSCODE_GOOD)
+        return retVal;
+
+    UA_UInt32 bucketsDimension = UA_PUBSUB_TIMINGBUCKETS;
+    UA_CallbackValueSource valueCallback;
+    valueCallback.read = ReadCallback;
+    valueCallback.write = NULL;
+    for(size_t i = 0; i < varsSize; i++) {
+        UA_VariableAttributes attr = UA_VariableAttributes_default;
+        attr.displayName = UA_LOCALIZEDTEXT("", (char*)(uintptr_t)vars[i].name);
+        attr.dataType = UA_TYPES[UA_TYPES_UINT64].typeId;
+        attr.accessLevel = UA_ACCESSLEVELMASK_READ;
+        if(vars[i].classifier != UA_PUBSUB_TIMING_MISSEDCYCLES) {
+            attr.valueRank = UA_VALUERANK_ONE_DIMENSION;
+            attr.arrayDimensionsSize = 1;
+            attr.arrayDimensions = &bucketsDimension;
+        } else {
+            attr.valueRank = UA_VALUERANK_SCALAR;
+        }
+
+        UA_NodeId varId;
+        retVal = addNode(server, UA_NODECLASS_VARIABLE, UA_NODEID_NUMERIC(1, 0),
+                         timingId, UA_NS0ID(HASCOMPONENT),
+                         UA_QUALIFIEDNAME(1, (char*)(uintptr_t)vars[i].name),
+                         UA_NS0ID(BASEDATAVARIABLETYPE), &attr,
+                         &UA_TYPES[UA_TYPES_VARIABLEATTRIBUTES], NULL, &varId);
+        if(retVal != UA_STATUSCODE_GOOD)
+            break;
+
+        UA_NodePropertyContext *ctx = (UA_NodePropertyContext *)
+            UA_malloc(sizeof(UA_NodePropertyContext));
+        if(!ctx) {
+            UA_NodeId_clear(&varId);
+            retVal = UA_STATUSCODE_BADOUTOFMEMORY;
+            break;
+        }
+        ctx->parentNodeId = groupId;
+        ctx->parentClassifier = groupClassifier;
+        ctx->elementClassiefier = vars[i].classifier;
+        retVal = setVariableValueSource(server, valueCallback, varId, ctx);
+        UA_NodeId_clear(&varId);
+        if(retVal != UA_STATUSCODE_GOOD)
+            break;
+    }
+    UA_NodeId_clear(&timingId);
+    return retVal;
+}
+
+/* Free the node contexts of the timing variables */
+static void
+removeTimingRepresentation(UA_Server *server, const UA_NodeId groupId,
+                           const TimingVariable *vars, size_t varsSize) {
+    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_NodeId timingId =
+        findSingleChildNode(server, UA_QUALIFIEDNAME(1, "Timing"),
+                            UA_NS0ID(HASCOMPONENT), groupId);
+    if(UA_NodeId_isNull(&timingId))
+        return;
+    for(size_t i = 0; i < varsSize; i++) {
+        UA_NodeId varId =
+            findSingleChildNode(server, UA_QUALIFIEDNAME(1, (char*)(uintptr_t)vars[i].name),
+                                UA_NS0ID(HASCOMPONENT), timingId);
+        if(UA_NodeId_isNull(&varId))
+            continue;
+        void *ctx = NULL;
+        getNodeContext(server, varId, &ctx);
+        setNodeContext(server, varId, NULL);
+        UA_free(ctx);
+        UA_NodeId_clear(&varId);
+    }
+    UA_NodeId_clear(&timingId);
+}
+
 /**********************************************/
 /*               ReserveIds                   */
 /**********************************************/
@@ -1905,6 +2089,12 @@ addReaderGroupRepresentation(UA_Server *server, UA_ReaderGroup *readerGroup) {
     stateDataSource.write = NULL;
     retVal |= UA_Server_setVariableNode_dataSource(server, stateIdNode, stateDataSource);
 
+    retVal |= addTimingRepresentation(server, readerGroup->head.identifier,
+                                      UA_NS0ID_READERGROUPTYPE,
+                                      readerGroupTimingVariables,
+                                      sizeof(readerGroupTimingVariables) /
+                                      sizeof(TimingVariable));
+
     if(server->config.pubSubConfig.enableInformationModelMethods) {
         retVal |= addRef(server, readerGroup->head.identifier, UA_NS0ID(HASCOMPONENT),
                          UA_NS0ID(READERGROUPTYPE_ADDDATASETREADER), true);
@@ -2123,6 +2313,10 @@ writerGroupTypeDestructor(UA_Server *server,
     getNodeContext(server, intervalNode, (void **)&ctx);
     if(!UA_NodeId_isNull(&intervalNode))
         UA_free(ctx);
+
+    removeTimingRepresentation(server, *nodeId, writerGroupTimingVariables,
+                               sizeof(writerGroupTimingVariables) /
+                               sizeof(TimingVariable));
 }
 
 static void
@@ -2131,6 +2325,9 @@ readerGroupTypeDestructor(UA_Server *server,
                           const UA_NodeId *typeId, void *typeContext,
                           const UA_NodeId *nodeId, void **nodeContext) {
     UA_LOCK_ASSERT(&server->serviceMutex);
+    removeTimingRepresentation(server, *nodeId, readerGroupTimingVariables,
+                               sizeof(readerGroupTimingVariables) /
+                               sizeof(TimingVariable));
 }
 
 static void
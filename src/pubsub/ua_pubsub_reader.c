@@ -117,6 +117,115 @@ UA_DataSetReader_find(UA_PubSubManager *psm, const UA_NodeId id) {
     return NULL;
 }
 
+/*************************/
+/* Bound TargetVariables */
+/*************************/
+
+static void
+unbindTargetVariables(UA_DataSetReader *dsr) {
+    UA_free(dsr->boundTargets);
+    dsr->boundTargets = NULL;
+    dsr->boundTargetsSize = 0;
+    dsr->targetStats.boundTargets = 0;
+}
+
+static UA_Boolean
+bindTargetVariable(UA_Server *server, UA_BoundTargetVariable *bt,
+                   const UA_FieldTargetDataType *tv, const UA_FieldMetaData *fmd) {
+    if(tv->attributeId != UA_ATTRIBUTEID_VALUE || tv->receiverIndexRange.length > 0)
+        return false;
+    const UA_DataType *type =
+        UA_findDataTypeWithCustom(&fmd->dataType, server->config.customDataTypes);
+    if(!type)
+        return false;
+    const UA_Node *node = UA_NODESTORE_GET(server, &tv->targetNodeId);
+    if(!node)
+        return false;
+
+    /* Only the exact DataType and ValueRanks without fixed ArrayDimensions.
+     * Then the type check at runtime is a pointer comparison. */
+    const UA_VariableNode *vn = &node->variableNode;
+    if(node->head.nodeClass == UA_NODECLASS_VARIABLE &&
+       (vn->valueSourceType == UA_VALUESOURCETYPE_INTERNAL ||
+        vn->valueSourceType == UA_VALUESOURCETYPE_EXTERNAL) &&
+       vn->arrayDimensionsSize == 0 &&
+       UA_NodeId_equal(&vn->dataType, &type->typeId)) {
+        switch(vn->valueRank) {
+        case UA_VALUERANK_SCALAR:
+            bt->scalar = true; break;
+        case UA_VALUERANK_ONE_DIMENSION:
+            bt->array = true; break;
+        case UA_VALUERANK_SCALAR_OR_ONE_DIMENSION:
+        case UA_VALUERANK_ANY:
+            bt->scalar = true; bt->array = true; break;
+        default: break;
+        }
+    }
+    if(bt->scalar || bt->array)
+        bt->type = type;
+    UA_NODESTORE_RELEASE(server, node);
+    return (bt->type != NULL);
+}
+
+/* Resolve the TargetVariables once when the reader is enabled. The fields for
+ * targets that cannot be bound are written via the Write service. */
+static void
+bindTargetVariables(UA_PubSubManager *psm, UA_DataSetReader *dsr) {
+    unbindTargetVariables(dsr);
+    if(!dsr->config.bindTargetVariables ||
+       dsr->config.subscribedDataSetType != UA_PUBSUB_SDS_TARGET)
+        return;
+
+    UA_TargetVariablesDataType *tvs = &dsr->config.subscribedDataSet.target;
+    UA_DataSetMetaDataType *metaData = &dsr->config.dataSetMetaData;
+    if(tvs->targetVariablesSize == 0 ||
+       tvs->targetVariablesSize != metaData->fieldsSize) {
+        UA_LOG_WARNING_PUBSUB(psm->logging, dsr, "Cannot bind the TargetVariables. "
+                              "The DataSetMetaData does not match.");
+        return;
+    }
+
+    dsr->boundTargets = (UA_BoundTargetVariable*)
+        UA_calloc(tvs->targetVariablesSize, sizeof(UA_BoundTargetVariable));
+    if(!dsr->boundTargets)
+        return;
+    dsr->boundTargetsSize = tvs->targetVariablesSize;
+
+    for(size_t i = 0; i < tvs->targetVariablesSize; i++) {
+        if(bindTargetVariable(psm->sc.server, &dsr->boundTargets[i],
+                              &tvs->targetVariables[i], &metaData->fields[i]))
+            dsr->targetStats.boundTargets++;
+    }
+
+    UA_LOG_DEBUG_PUBSUB(psm->logging, dsr, "%u of %u TargetVariables bound",
+                        (unsigned)dsr->targetStats.boundTargets,
+                        (unsigned)tvs->targetVariablesSize);
+}
+
+/* Returns an error if the field cannot be written via the binding. Then
+ * nothing was changed and the Write service is used instead. */
+static UA_StatusCode
+writeBoundTargetVariable(UA_Server *server, const UA_BoundTargetVariable *bt,
+                         const UA_FieldTargetDataType *tv,
+                         const UA_DataValue *field) {
+    const UA_Variant *v = &field->value;
+    if(!bt->type || v->type != bt->type)
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+    if(UA_Variant_isScalar(v) ? !bt->scalar : (!bt->array || v->arrayDimensionsSize > 1))
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+
+    UA_Node *node = UA_NODESTORE_GET_EDIT(server, &tv->targetNodeId);
+    if(!node)
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    UA_StatusCode res = UA_STATUSCODE_BADTYPEMISMATCH;
+    if(node->head.nodeClass == UA_NODECLASS_VARIABLE &&
+       UA_NodeId_equal(&node->variableNode.dataType, &bt->type->typeId))
+        res = writeValueAttributeUnchecked(server, &server->adminSession,
+                                           &node->variableNode, field);
+    UA_NODESTORE_RELEASE(server, node);
+    return res;
+}
+
 static UA_StatusCode
 validateDSRConfig(UA_PubSubManager *psm, UA_DataSetReader *dsr) {
     /* Check if used dataSet metaData is valid in context of the rest of the config */
@@ -262,6 +371,7 @@ UA_DataSetReader_create(UA_PubSubManager *psm, UA_NodeId readerGroupIdentifier,
         LIST_INSERT_AFTER(after, dsr, listEntry);
     }
     rg->readersCount++;
+    UA_ReaderGroup_clearDispatchIndex(rg);
 
     /* Copy the config into the new dataSetReader */
     UA_StatusCode retVal =
@@ -377,9 +487,11 @@ UA_DataSetReader_remove(UA_PubSubManager *psm, UA_DataSetReader *dsr) {
     /* Remove DataSetReader from group */
     LIST_REMOVE(dsr, listEntry);
     rg->readersCount--;
+    UA_ReaderGroup_clearDispatchIndex(rg);
 
     UA_LOG_INFO_PUBSUB(psm->logging, dsr, "DataSetReader deleted");
 
+    unbindTargetVariables(dsr);
     UA_DataSetReaderConfig_clear(&dsr->config);
     UA_PubSubComponentHead_clear(&dsr->head);
     UA_free(dsr);
@@ -497,6 +609,18 @@ UA_DataSetReader_setPubSubState(UA_PubSubManager *psm, UA_DataSetReader *dsr,
     if(dsr->head.state == oldState)
         return res;
 
+    /* Resolve the TargetVariables when the reader gets enabled */
+    if(!UA_PubSubState_isEnabled(dsr->head.state)) {
+        unbindTargetVariables(dsr);
+    } else if(!UA_PubSubState_isEnabled(oldState)) {
+        memset(&dsr->targetStats, 0, sizeof(UA_DataSetReaderTargetStatistics));
+        dsr->targetStatsStart = UA_DateTime_nowMonotonic();
+        dsr->deltaSynced = false;
+        dsr->lastSequenceNrValid = false;
+        dsr->deltaFramesSinceKeyFrame = 0;
+        bindTargetVariables(psm, dsr);
+    }
+
     UA_LOG_INFO_PUBSUB(psm->logging, dsr, "%s -> %s",
                        UA_PubSubState_name(oldState),
                        UA_PubSubState_name(dsr->head.state));
@@ -554,6 +678,78 @@ UA_DataSetReader_handleMessageReceiveTimeout(UA_PubSubManager *psm,
     unlockServer(psm->sc.server);
 }
 
+/* Write a received field into the TargetVariable at the index */
+static void
+writeTargetVariable(UA_PubSubManager *psm, UA_DataSetReader *dsr,
+                    size_t index, const UA_DataValue *field) {
+    if(!field->hasValue)
+        return;
+
+    /* Write directly into the bound variable */
+    UA_Server *server = psm->sc.server;
+    UA_FieldTargetDataType *tv =
+        &dsr->config.subscribedDataSet.target.targetVariables[index];
+    if(index < dsr->boundTargetsSize &&
+       writeBoundTargetVariable(server, &dsr->boundTargets[index], tv,
+                                field) == UA_STATUSCODE_GOOD) {
+        dsr->targetStats.fieldsBound++;
+        return;
+    }
+
+    /* Write via the Write-Service */
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    UA_WriteValue writeVal;
+    UA_WriteValue_init(&writeVal);
+    writeVal.attributeId = tv->attributeId;
+    writeVal.indexRange = tv->receiverIndexRange;
+    writeVal.nodeId = tv->targetNodeId;
+    writeVal.value = *field;
+    Operation_Write(server, &server->adminSession, &writeVal, &res);
+    if(res != UA_STATUSCODE_GOOD) {
+        dsr->targetStats.fieldsFailed++;
+        UA_LOG_INFO_PUBSUB(psm->logging, dsr,
+                           "Error writing field %u: %s",
+                           (unsigned)index, UA_StatusCode_name(res));
+    } else {
+        dsr->targetStats.fieldsWritten++;
+    }
+}
+
+/* Apply the changed fields of a DeltaFrame. The unchanged fields keep their
+ * last value in the TargetVariables. */
+static void
+processDeltaFrame(UA_PubSubManager *psm, UA_DataSetReader *dsr,
+                  UA_DataSetMessage *msg) {
+    /* At most keyFrameCount-1 DeltaFrames follow a KeyFrame. Otherwise the
+     * KeyFrame was lost. */
+    dsr->deltaFramesSinceKeyFrame++;
+    if(dsr->config.keyFrameCount > 0 &&
+       dsr->deltaFramesSinceKeyFrame >= dsr->config.keyFrameCount)
+        dsr->deltaSynced = false;
+
+    /* Wait for the next KeyFrame */
+    if(!dsr->deltaSynced) {
+        dsr->targetStats.deltaFramesDropped++;
+        UA_LOG_DEBUG_PUBSUB(psm->logging, dsr, "DeltaFrame is discarded: "
+                            "Waiting for the next KeyFrame");
+        return;
+    }
+
+    UA_TargetVariablesDataType *tvs = &dsr->config.subscribedDataSet.target;
+    for(size_t i = 0; i < msg->fieldCount; i++) {
+        UA_DataSetMessage_DeltaFrameField *dff = &msg->data.deltaFrameFields[i];
+        if(dff->index >= tvs->targetVariablesSize) {
+            UA_LOG_WARNING_PUBSUB(psm->logging, dsr,
+                                  "DeltaFrame field index %u is not in the "
+                                  "TargetVariables configuration",
+                                  (unsigned)dff->index);
+            continue;
+        }
+        writeTargetVariable(psm, dsr, dff->index, &dff->value);
+    }
+    dsr->targetStats.deltaFramesApplied++;
+}
+
 void
 UA_DataSetReader_process(UA_PubSubManager *psm, UA_DataSetReader *dsr,
                          UA_DataSetMessage *msg) {
@@ -591,9 +787,11 @@ UA_DataSetReader_process(UA_PubSubManager *psm, UA_DataSetReader *dsr,
      *     }
      * } */
 
-    if(msg->header.dataSetMessageType != UA_DATASETMESSAGE_DATAKEYFRAME) {
+    if(msg->header.dataSetMessageType != UA_DATASETMESSAGE_DATAKEYFRAME &&
+       msg->header.dataSetMessageType != UA_DATASETMESSAGE_DATADELTAFRAME) {
         UA_LOG_WARNING_PUBSUB(psm->logging, dsr,
-                              "DataSetMessage is discarded: Only keyframes are supported");
+                              "DataSetMessage is discarded: Only keyframes "
+                              "and deltaframes are supported");
         return;
     }
 
@@ -612,6 +810,24 @@ UA_DataSetReader_process(UA_PubSubManager *psm, UA_DataSetReader *dsr,
         }
     }
 
+    /* A gap in the sequence numbers means that messages were lost. The
+     * following DeltaFrames cannot be applied until the next KeyFrame. */
+    if(msg->header.dataSetMessageSequenceNrEnabled) {
+        if(dsr->lastSequenceNrValid &&
+           msg->header.dataSetMessageSequenceNr !=
+           (UA_UInt16)(dsr->lastSequenceNr + 1)) {
+            dsr->targetStats.sequenceGaps++;
+            dsr->deltaSynced = false;
+        }
+        dsr->lastSequenceNr = msg->header.dataSetMessageSequenceNr;
+        dsr->lastSequenceNrValid = true;
+    }
+
+    if(msg->header.dataSetMessageType == UA_DATASETMESSAGE_DATADELTAFRAME) {
+        processDeltaFrame(psm, dsr, msg);
+        return;
+    }
+
     /* Received a heartbeat with no fields */
     if(msg->fieldCount == 0)
         return;
@@ -626,26 +842,12 @@ UA_DataSetReader_process(UA_PubSubManager *psm, UA_DataSetReader *dsr,
     }
 
     /* Write the message fields. RT has the external data value configured. */
-    UA_StatusCode res = UA_STATUSCODE_GOOD;
-    for(size_t i = 0; i < msg->fieldCount; i++) {
-        UA_FieldTargetDataType *tv = &tvs->targetVariables[i];
-        UA_DataValue *field = &msg->data.keyFrameFields[i];
-        if(!field->hasValue)
-            continue;
+    for(size_t i = 0; i < msg->fieldCount; i++)
+        writeTargetVariable(psm, dsr, i, &msg->data.keyFrameFields[i]);
 
-        /* Write via the Write-Service */
-        UA_WriteValue writeVal;
-        UA_WriteValue_init(&writeVal);
-        writeVal.attributeId = tv->attributeId;
-        writeVal.indexRange = tv->receiverIndexRange;
-        writeVal.nodeId = tv->targetNodeId;
-        writeVal.value = *field;
-        Operation_Write(psm->sc.server, &psm->sc.server->adminSession, &writeVal, &res);
-        if(res != UA_STATUSCODE_GOOD)
-            UA_LOG_INFO_PUBSUB(psm->logging, dsr,
-                               "Error writing KeyFrame field %u: %s",
-                               (unsigned)i, UA_StatusCode_name(res));
-    }
+    /* The KeyFrame (re)synchronizes the DeltaFrames */
+    dsr->deltaSynced = true;
+    dsr->deltaFramesSinceKeyFrame = 0;
 }
 
 /**************/
@@ -742,6 +944,27 @@ UA_Server_disableDataSetReader(UA_Server *server, const UA_NodeId dsrId) {
     return ret;
 }
 
+UA_StatusCode
+UA_Server_getDataSetReaderTargetStatistics(UA_Server *server, const UA_NodeId dsrId,
+                                           UA_DataSetReaderTargetStatistics *stats) {
+    if(!server || !stats)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    lockServer(server);
+    UA_DataSetReader *dsr = UA_DataSetReader_find(getPSM(server), dsrId);
+    if(!dsr) {
+        unlockServer(server);
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+    *stats = dsr->targetStats;
+    stats->fieldsPerSecond = 0.0;
+    UA_DateTime elapsed = UA_DateTime_nowMonotonic() - dsr->targetStatsStart;
+    if(UA_PubSubState_isEnabled(dsr->head.state) && elapsed > 0)
+        stats->fieldsPerSecond = (UA_Double)(stats->fieldsBound + stats->fieldsWritten) /
+            ((UA_Double)elapsed / (UA_Double)UA_DATETIME_SEC);
+    unlockServer(server);
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_StatusCode
 UA_Server_setDataSetReaderTargetVariables(UA_Server *server, const UA_NodeId dsrId,
                                           size_t targetVariablesSize,
@@ -782,6 +1005,9 @@ UA_Server_updateDataSetReaderConfig(UA_Server *server, const UA_NodeId dsrId,
     /* Store the old config */
     UA_DataSetReaderConfig oldConfig = dsr->config;
 
+    /* The identifiers might change */
+    UA_ReaderGroup_clearDispatchIndex(dsr->linkedReaderGroup);
+
     /* Copy the config into the new dataSetReader */
     UA_StatusCode retVal = UA_DataSetReaderConfig_copy(config, &dsr->config);
     if(retVal != UA_STATUSCODE_GOOD)
@@ -254,6 +254,7 @@ UA_ReaderGroup_remove(UA_PubSubManager *psm, UA_ReaderGroup *rg) {
 
         UA_LOG_INFO_PUBSUB(psm->logging, rg, "ReaderGroup deleted");
 
+        UA_ReaderGroup_clearDispatchIndex(rg);
         UA_ReaderGroupConfig_clear(&rg->config);
         UA_PubSubComponentHead_clear(&rg->head);
         UA_free(rg);
@@ -313,6 +314,10 @@ UA_ReaderGroup_setPubSubState(UA_PubSubManager *psm, UA_ReaderGroup *rg,
     case UA_PUBSUBSTATE_PAUSED:
     case UA_PUBSUBSTATE_PREOPERATIONAL:
     case UA_PUBSUBSTATE_OPERATIONAL:
+        /* Restart the timing statistics */
+        if(!UA_PubSubState_isEnabled(oldState))
+            memset(&rg->timing, 0, sizeof(UA_ReaderGroupTiming));
+
         if(psm->sc.state != UA_LIFECYCLESTATE_STARTED) {
             /* Avoid repeat warnings */
             if(oldState != UA_PUBSUBSTATE_PAUSED) {
@@ -430,6 +435,133 @@ UA_ReaderGroup_setEncryptionKeys(UA_PubSubManager *psm, UA_ReaderGroup *rg,
                         &encryptingKey, &keyNonce);
 }
 
+/******************/
+/* Dispatch Index */
+/******************/
+
+static UA_UInt32
+dispatchHash(const UA_PublisherId *publisherId, UA_UInt16 writerGroupId,
+             UA_UInt16 dataSetWriterId) {
+    UA_UInt32 h = (UA_UInt32)publisherId->idType;
+    switch(publisherId->idType) {
+    case UA_PUBLISHERIDTYPE_BYTE:
+        h = UA_ByteString_hash(h, &publisherId->id.byte, 1); break;
+    case UA_PUBLISHERIDTYPE_UINT16:
+        h = UA_ByteString_hash(h, (const UA_Byte*)&publisherId->id.uint16, 2); break;
+    case UA_PUBLISHERIDTYPE_UINT32:
+        h = UA_ByteString_hash(h, (const UA_Byte*)&publisherId->id.uint32, 4); break;
+    case UA_PUBLISHERIDTYPE_UINT64:
+        h = UA_ByteString_hash(h, (const UA_Byte*)&publisherId->id.uint64, 8); break;
+    case UA_PUBLISHERIDTYPE_STRING:
+        h = UA_ByteString_hash(h, publisherId->id.string.data,
+                               publisherId->id.string.length);
+        break;
+    default: break;
+    }
+    UA_UInt16 ids[2] = {writerGroupId, dataSetWriterId};
+    return UA_ByteString_hash(h, (const UA_Byte*)ids, sizeof(ids));
+}
+
+static UA_Boolean
+dispatchKeyEqual(const UA_DataSetReader *dsr, const UA_PublisherId *publisherId,
+                 UA_UInt16 writerGroupId, UA_UInt16 dataSetWriterId) {
+    if(dsr->config.writerGroupId != writerGroupId ||
+       dsr->config.dataSetWriterId != dataSetWriterId)
+        return false;
+    const UA_PublisherId *idA = &dsr->config.publisherId;
+    if(idA->idType != publisherId->idType)
+        return false;
+    switch(idA->idType) {
+    case UA_PUBLISHERIDTYPE_BYTE:   return idA->id.byte == publisherId->id.byte;
+    case UA_PUBLISHERIDTYPE_UINT16: return idA->id.uint16 == publisherId->id.uint16;
+    case UA_PUBLISHERIDTYPE_UINT32: return idA->id.uint32 == publisherId->id.uint32;
+    case UA_PUBLISHERIDTYPE_UINT64: return idA->id.uint64 == publisherId->id.uint64;
+    case UA_PUBLISHERIDTYPE_STRING:
+        return UA_String_equal(&idA->id.string, &publisherId->id.string);
+    default: break;
+    }
+    return false;
+}
+
+void
+UA_ReaderGroup_clearDispatchIndex(UA_ReaderGroup *rg) {
+    UA_free(rg->dispatch);
+    rg->dispatch = NULL;
+    rg->dispatchSize = 0;
+}
+
+static UA_StatusCode
+buildDispatchIndex(UA_ReaderGroup *rg) {
+    /* Keep the load factor below 1/2 */
+    size_t size = 16;
+    while(size < 2 * (size_t)rg->readersCount)
+        size <<= 1;
+    UA_DataSetReader **table = (UA_DataSetReader**)
+        UA_calloc(size, sizeof(UA_DataSetReader*));
+    if(!table)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* Readers with the same key are chained in the order of the list */
+    size_t mask = size - 1;
+    UA_DataSetReader *dsr;
+    LIST_FOREACH(dsr, &rg->readers, listEntry) {
+        const UA_DataSetReaderConfig *c = &dsr->config;
+        dsr->dispatchHash = dispatchHash(&c->publisherId, c->writerGroupId,
+                                         c->dataSetWriterId);
+        dsr->dispatchNext = NULL;
+        size_t i = dsr->dispatchHash & mask;
+        for(; table[i]; i = (i + 1) & mask) {
+            if(table[i]->dispatchHash == dsr->dispatchHash &&
+               dispatchKeyEqual(table[i], &c->publisherId, c->writerGroupId,
+                                c->dataSetWriterId))
+                break;
+        }
+        if(!table[i]) {
+            table[i] = dsr;
+            continue;
+        }
+        UA_DataSetReader *last = table[i];
+        while(last->dispatchNext)
+            last = last->dispatchNext;
+        last->dispatchNext = dsr;
+    }
+
+    UA_free(rg->dispatch);
+    rg->dispatch = table;
+    rg->dispatchSize = size;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* The index can only be used if the NetworkMessage contains the full key.
+ * Otherwise the readers are matched one by one with
+ * UA_DataSetReader_checkIdentifier. */
+static UA_Boolean
+useDispatchIndex(UA_ReaderGroup *rg, const UA_NetworkMessage *nm) {
+    if(rg->config.encodingMimeType != UA_PUBSUB_ENCODING_UADP ||
+       !nm->publisherIdEnabled || !nm->payloadHeaderEnabled ||
+       !nm->groupHeaderEnabled || !nm->groupHeader.writerGroupIdEnabled)
+        return false;
+    if(!rg->dispatch && rg->readersCount > 0)
+        buildDispatchIndex(rg);
+    return (rg->dispatch != NULL);
+}
+
+/* Returns the first reader in the chain for the i-th DataSetMessage */
+static UA_DataSetReader *
+lookupDispatchIndex(UA_ReaderGroup *rg, const UA_NetworkMessage *nm, size_t i) {
+    UA_UInt16 writerGroupId = nm->groupHeader.writerGroupId;
+    UA_UInt16 dataSetWriterId = nm->dataSetWriterIds[i];
+    UA_UInt32 h = dispatchHash(&nm->publisherId, writerGroupId, dataSetWriterId);
+    size_t mask = rg->dispatchSize - 1;
+    for(size_t j = h & mask; rg->dispatch[j]; j = (j + 1) & mask) {
+        UA_DataSetReader *dsr = rg->dispatch[j];
+        if(dsr->dispatchHash == h &&
+           dispatchKeyEqual(dsr, &nm->publisherId, writerGroupId, dataSetWriterId))
+            return dsr;
+    }
+    return NULL;
+}
+
 UA_Boolean
 UA_ReaderGroup_process(UA_PubSubManager *psm, UA_ReaderGroup *rg,
                        UA_NetworkMessage *nm) {
@@ -442,10 +574,30 @@ UA_ReaderGroup_process(UA_PubSubManager *psm, UA_ReaderGroup *rg,
     rg->hasReceived = true;
     UA_ReaderGroup_setPubSubState(psm, rg, rg->head.state);
 
-    /* Safe iteration. The current Reader might be deleted in the ReaderGroup
-     * _setPubSubState callback. */
+    /* Route every DataSetMessage directly to the matching readers */
     UA_Boolean processed = false;
     UA_DataSetReader *reader, *reader_tmp;
+    if(useDispatchIndex(rg, nm)) {
+        UA_LOG_TRACE_PUBSUB(psm->logging, rg, "Processing a NetworkMessage");
+        for(size_t i = 0; i < nm->messageCount; i++) {
+            reader = lookupDispatchIndex(rg, nm, i);
+            for(; reader; reader = reader->dispatchNext) {
+                if(reader->head.state != UA_PUBSUBSTATE_OPERATIONAL &&
+                   reader->head.state != UA_PUBSUBSTATE_PREOPERATIONAL)
+                    continue;
+                processed = true;
+                UA_DataSetReader_process(psm, reader,
+                                         &nm->payload.dataSetMessages[i]);
+                /* The readers were changed in a callback */
+                if(!rg->dispatch)
+                    return processed;
+            }
+        }
+        return processed;
+    }
+
+    /* Safe iteration. The current Reader might be deleted in the ReaderGroup
+     * _setPubSubState callback. */
     LIST_FOREACH_SAFE(reader, &rg->readers, listEntry, reader_tmp) {
         /* Check if the reader is enabled */
         if(reader->head.state != UA_PUBSUBSTATE_OPERATIONAL &&
@@ -488,13 +640,18 @@ UA_StatusCode
 UA_ReaderGroup_decodeNetworkMessage(UA_PubSubManager *psm,
                                     UA_ReaderGroup *rg,
                                     UA_ByteString buffer,
-                                    UA_NetworkMessage *nm) {
+                                    UA_NetworkMessage *nm,
+                                    UA_Arena *arena) {
     /* Set up the decoding context */
     PubSubDecodeCtx ctx;
     memset(&ctx, 0, sizeof(PubSubDecodeCtx));
     ctx.ctx.pos = buffer.data;
     ctx.ctx.end = buffer.data + buffer.length;
     ctx.ctx.opts.customTypes = psm->sc.server->config.customDataTypes;
+    if(arena) {
+        ctx.ctx.opts.callocContext = arena;
+        ctx.ctx.opts.calloc = UA_Arena_calloc;
+    }
 
     /* Decode the headers. This sets the number of DataSetMessages and retrieves
      * the DataSetWriterIds. Those get matched to the readers below. */
@@ -502,27 +659,33 @@ UA_ReaderGroup_decodeNetworkMessage(UA_PubSubManager *psm,
     if(rv != UA_STATUSCODE_GOOD) {
         UA_LOG_WARNING_PUBSUB(psm->logging, rg,
                               "PubSub receive. decoding headers failed");
-        UA_NetworkMessage_clear(nm);
+        UA_ReaderGroup_releaseNetworkMessage(nm, arena);
         return rv;
     }
 
     /* Find a matching reader. Otherwise skip for this ReaderGroup */
-    UA_DataSetReader *dsr;
-    LIST_FOREACH(dsr, &rg->readers, listEntry) {
-        rv = UA_DataSetReader_checkIdentifier(psm, dsr, nm);
-        if(rv == UA_STATUSCODE_GOOD)
-            break;
+    UA_DataSetReader *dsr = NULL;
+    UA_Boolean indexed = useDispatchIndex(rg, nm);
+    if(indexed) {
+        for(size_t i = 0; i < nm->messageCount && !dsr; i++)
+            dsr = lookupDispatchIndex(rg, nm, i);
+    } else {
+        LIST_FOREACH(dsr, &rg->readers, listEntry) {
+            rv = UA_DataSetReader_checkIdentifier(psm, dsr, nm);
+            if(rv == UA_STATUSCODE_GOOD)
+                break;
+        }
     }
 
     if(!dsr) {
-        UA_NetworkMessage_clear(nm);
+        UA_ReaderGroup_releaseNetworkMessage(nm, arena);
         return UA_STATUSCODE_BADNOTFOUND;
     }
 
     /* Decrypt */
     rv = verifyAndDecryptNetworkMessage(psm->logging, buffer, &ctx.ctx, nm, rg);
     if(rv != UA_STATUSCODE_GOOD) {
-        UA_NetworkMessage_clear(nm);
+        UA_ReaderGroup_releaseNetworkMessage(nm, arena);
         return rv;
     }
 
@@ -532,30 +695,53 @@ UA_ReaderGroup_decodeNetworkMessage(UA_PubSubManager *psm,
     UA_STACKARRAY(UA_DataSetMessage_EncodingMetaData, emd, rg->readersCount);
     memset(emd, 0, sizeof(UA_DataSetMessage_EncodingMetaData) * rg->readersCount);
     ctx.eo.metaData = emd;
-    ctx.eo.metaDataSize = rg->readersCount;
-    LIST_FOREACH(dsr, &rg->readers, listEntry) {
-        emd[i].dataSetWriterId = dsr->config.dataSetWriterId;
-        emd[i].fields = dsr->config.dataSetMetaData.fields;
-        emd[i].fieldsSize = dsr->config.dataSetMetaData.fieldsSize;
-        i++;
+    if(indexed) {
+        /* Only the metadata of the readers addressed in the message */
+        for(size_t j = 0; j < nm->messageCount && i < rg->readersCount; j++) {
+            dsr = lookupDispatchIndex(rg, nm, j);
+            if(!dsr)
+                continue;
+            emd[i].dataSetWriterId = dsr->config.dataSetWriterId;
+            emd[i].fields = dsr->config.dataSetMetaData.fields;
+            emd[i].fieldsSize = dsr->config.dataSetMetaData.fieldsSize;
+            i++;
+        }
+    } else {
+        LIST_FOREACH(dsr, &rg->readers, listEntry) {
+            emd[i].dataSetWriterId = dsr->config.dataSetWriterId;
+            emd[i].fields = dsr->config.dataSetMetaData.fields;
+            emd[i].fieldsSize = dsr->config.dataSetMetaData.fieldsSize;
+            i++;
+        }
     }
+    ctx.eo.metaDataSize = i;
 
     /* Decode the payload */
     rv = UA_NetworkMessage_decodePayload(&ctx, nm);
     if(rv != UA_STATUSCODE_GOOD) {
-        UA_NetworkMessage_clear(nm);
+        UA_ReaderGroup_releaseNetworkMessage(nm, arena);
         return rv;
     }
 
     rv = UA_NetworkMessage_decodeFooters(&ctx, nm);
     if(rv != UA_STATUSCODE_GOOD) {
-        UA_NetworkMessage_clear(nm);
+        UA_ReaderGroup_releaseNetworkMessage(nm, arena);
         return rv;
     }
 
     return UA_STATUSCODE_GOOD;
 }
 
+void
+UA_ReaderGroup_releaseNetworkMessage(UA_NetworkMessage *nm, UA_Arena *arena) {
+    if(!arena) {
+        UA_NetworkMessage_clear(nm);
+        return;
+    }
+    memset(nm, 0, sizeof(UA_NetworkMessage));
+    UA_Arena_reset(arena);
+}
+
 #ifdef UA_ENABLE_JSON_ENCODING
 UA_StatusCode
 UA_ReaderGroup_decodeNetworkMessageJSON(UA_PubSubManager *psm,
@@ -848,10 +1034,17 @@ ReaderGroupChannelCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
     }
 
     /* Decode message */
+    UA_EventLoop *el = server->config.eventLoop;
+    UA_DateTime received = el->dateTime_nowMonotonic(el);
     UA_NetworkMessage nm;
     memset(&nm, 0, sizeof(UA_NetworkMessage));
+    UA_Arena *arena = NULL;
     if(rg->config.encodingMimeType == UA_PUBSUB_ENCODING_UADP) {
-        res = UA_ReaderGroup_decodeNetworkMessage(psm, rg, msg, &nm);
+        /* Decode into the arena of the PubSubConnection */
+        UA_PubSubConnection *c = rg->linkedConnection;
+        if(c && c->decodeArena.blockSize > 0)
+            arena = &c->decodeArena;
+        res = UA_ReaderGroup_decodeNetworkMessage(psm, rg, msg, &nm, arena);
     } else { /* if(writerGroup->config.encodingMimeType == UA_PUBSUB_ENCODING_JSON) */
 #ifdef UA_ENABLE_JSON_ENCODING
         res = UA_ReaderGroup_decodeNetworkMessageJSON(psm, rg, msg, &nm);
@@ -866,9 +1059,14 @@ ReaderGroupChannelCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
         return;
     }
 
+    UA_PubSubTimingHistogram_add(&rg->timing.decodeTime,
+                                 el->dateTime_nowMonotonic(el) - received);
+
     /* Process the decoded message */
-    UA_ReaderGroup_process(psm, rg, &nm);
-    UA_NetworkMessage_clear(&nm);
+    if(UA_ReaderGroup_process(psm, rg, &nm))
+        UA_PubSubTimingHistogram_add(&rg->timing.receiveToApply,
+                                     el->dateTime_nowMonotonic(el) - received);
+    UA_ReaderGroup_releaseNetworkMessage(&nm, arena);
     unlockServer(server);
 }
 
@@ -1104,6 +1302,19 @@ UA_Server_disableReaderGroup(UA_Server *server, const UA_NodeId readerGroupId){
     return ret;
 }
 
+UA_StatusCode
+UA_Server_getReaderGroupTiming(UA_Server *server, const UA_NodeId rgId,
+                               UA_ReaderGroupTiming *timing) {
+    if(!server || !timing)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    lockServer(server);
+    UA_ReaderGroup *rg = UA_ReaderGroup_find(getPSM(server), rgId);
+    if(rg)
+        *timing = rg->timing;
+    unlockServer(server);
+    return (rg) ? UA_STATUSCODE_GOOD : UA_STATUSCODE_BADNOTFOUND;
+}
+
 UA_StatusCode
 UA_Server_setReaderGroupEncryptionKeys(UA_Server *server,
                                        const UA_NodeId readerGroup,
@@ -143,6 +143,9 @@ UA_DataSetWriter_setPubSubState(UA_PubSubManager *psm, UA_DataSetWriter *dsw,
     if(dsw->head.state == oldState)
         return res;
 
+    /* The WriterGroup freezes the NetworkMessage layout again */
+    UA_WriterGroup_clearFrozenMessage(wg);
+
     UA_LOG_INFO_PUBSUB(psm->logging, dsw, "%s -> %s",
                        UA_PubSubState_name(oldState),
                        UA_PubSubState_name(dsw->head.state));
@@ -250,6 +253,7 @@ UA_DataSetWriter_create(UA_PubSubManager *psm,
     else
         LIST_INSERT_HEAD(&wg->writers, dsw, listEntry);
     wg->writersCount++;
+    UA_WriterGroup_clearFrozenMessage(wg);
 
     /* Add to the information model */
 #ifdef UA_ENABLE_PUBSUB_INFORMATIONMODEL
@@ -328,6 +332,7 @@ UA_DataSetWriter_remove(UA_PubSubManager *psm, UA_DataSetWriter *dsw) {
     /* Remove DataSetWriter from group */
     LIST_REMOVE(dsw, listEntry);
     wg->writersCount--;
+    UA_WriterGroup_clearFrozenMessage(wg);
 
     UA_LOG_INFO_PUBSUB(psm->logging, dsw, "Writer deleted");
 
@@ -406,7 +411,27 @@ UA_PubSubDataSetWriter_generateKeyFrameMessage(UA_PubSubManager *psm,
     return UA_STATUSCODE_GOOD;
 }
 
-/* the input message is already initialized and that the method 
+/* Returns whether the sampled value differs significantly from the value that
+ * was last sent. Numeric fields with an absolute deadband only count as changed
+ * if the deadband is exceeded. The percent deadband requires the EURange and is
+ * not supported for DataSetFields (every change is sent). */
+static UA_Boolean
+deltaFrameValueChanged(UA_DataSetField *dsf, const UA_DataValue *value,
+                       const UA_DataValue *lastValue) {
+    if(value->status != lastValue->status)
+        return true;
+    if(dsf->config.dataSetFieldType == UA_PUBSUB_DATASETFIELD_VARIABLE) {
+        const UA_PublishedVariableDataType *pp =
+            &dsf->config.field.variable.publishParameters;
+        if(pp->deadbandType == UA_DEADBANDTYPE_ABSOLUTE &&
+           value->value.type && UA_DataType_isNumeric(value->value.type))
+            return detectVariantDeadband(&value->value, &lastValue->value,
+                                         pp->deadbandValue);
+    }
+    return !UA_Variant_equal(&value->value, &lastValue->value);
+}
+
+/* the input message is already initialized and that the method
  * must not be called twice for the same message */
 static UA_StatusCode
 UA_PubSubDataSetWriter_generateDeltaFrameMessage(UA_PubSubManager *psm,
@@ -422,8 +447,12 @@ UA_PubSubDataSetWriter_generateDeltaFrameMessage(UA_PubSubManager *psm,
     if(pds->fieldSize == 0)
         return UA_STATUSCODE_GOOD;
 
+    /* Sample the fields and update the last sent value if it changed
+     * significantly. Values within the deadband are not stored. So small
+     * changes add up until they exceed the deadband. */
     UA_DataSetField *dsf;
     UA_UInt16 counter = 0;
+    UA_UInt16 changed = 0;
     TAILQ_FOREACH(dsf, &pds->fields, listEntry) {
         /* Sample the value */
         UA_DataValue value;
@@ -432,9 +461,8 @@ UA_PubSubDataSetWriter_generateDeltaFrameMessage(UA_PubSubManager *psm,
 
         /* Check if the value has changed */
         UA_DataSetWriterSample *ls = &dsw->lastSamples[counter];
-        if(!UA_Variant_equal(&ls->value.value, &value.value)) {
-            /* increase fieldCount for current delta message */
-            dsm->fieldCount++;
+        if(deltaFrameValueChanged(dsf, &value, &ls->value)) {
+            changed++;
             ls->valueChanged = true;
 
             /* Update last stored sample */
@@ -448,13 +476,18 @@ UA_PubSubDataSetWriter_generateDeltaFrameMessage(UA_PubSubManager *psm,
         counter++;
     }
 
+    /* Nothing has changed. Send an empty DeltaFrame. */
+    dsm->fieldCount = changed;
+    if(changed == 0)
+        return UA_STATUSCODE_GOOD;
+
     /* Allocate DeltaFrameFields */
     UA_DataSetMessage_DeltaFrameField *deltaFields = (UA_DataSetMessage_DeltaFrameField *)
-        UA_calloc(counter, sizeof(UA_DataSetMessage_DeltaFrameField));
-    if(!deltaFields)
+        UA_calloc(changed, sizeof(UA_DataSetMessage_DeltaFrameField));
+    if(!deltaFields) {
+        dsm->fieldCount = 0;
         return UA_STATUSCODE_BADOUTOFMEMORY;
-
-    dsm->fieldCount = counter;
+    }
     dsm->data.deltaFrameFields = deltaFields;
 
     size_t currentDeltaField = 0;
@@ -481,7 +514,7 @@ UA_PubSubDataSetWriter_generateDeltaFrameMessage(UA_PubSubManager *psm,
             dff->value.hasSourceTimestamp = false;
         if(((u64)dsw->config.dataSetFieldContentMask &
             (u64)UA_DATASETFIELDCONTENTMASK_SOURCEPICOSECONDS) == 0)
-            dff->value.hasServerPicoseconds = false;
+            dff->value.hasSourcePicoseconds = false;
         if(((u64)dsw->config.dataSetFieldContentMask &
             (u64)UA_DATASETFIELDCONTENTMASK_SERVERTIMESTAMP) == 0)
             dff->value.hasServerTimestamp = false;
@@ -650,9 +683,11 @@ UA_DataSetWriter_generateDataSetMessage(UA_PubSubManager *psm,
         return UA_STATUSCODE_GOOD;
     }
 
-    /* JSON does not differ between deltaframes and keyframes, only keyframes
-     * are currently used. */
-    if(dsm && psm->sc.server->config.pubSubConfig.enableDeltaFrames) {
+    /* DeltaFrames are generated for UADP and JSON. RawData field encoding has
+     * no field indices and only uses KeyFrames. */
+    if((dsm || jsonDsm) &&
+       dataSetMessage->header.fieldEncoding != UA_FIELDENCODING_RAWDATA &&
+       psm->sc.server->config.pubSubConfig.enableDeltaFrames) {
         /* Check if the PublishedDataSet version has changed -> if yes flush the
          * lastValue store and send a KeyFrame */
         if(dsw->connectedDataSetVersion.majorVersion !=
@@ -683,9 +718,10 @@ UA_DataSetWriter_generateDataSetMessage(UA_PubSubManager *psm,
 
         /* The standard defines: if a PDS contains only one fields no delta messages
          * should be generated because they need more memory than a keyframe with 1
-         * field. */
+         * field. Every keyFrameCount-th message is a KeyFrame. With a
+         * keyFrameCount of one, only KeyFrames are sent. */
         if(pds->fieldSize > 1 && dsw->deltaFrameCounter > 0 &&
-           dsw->deltaFrameCounter <= dsw->config.keyFrameCount) {
+           dsw->deltaFrameCounter < dsw->config.keyFrameCount) {
             UA_PubSubDataSetWriter_generateDeltaFrameMessage(psm, dataSetMessage, dsw);
             dsw->deltaFrameCounter++;
             return UA_STATUSCODE_GOOD;
@@ -21,11 +21,6 @@
 #include "ua_pubsub_keystorage.h"
 #endif
 
-static UA_StatusCode
-encryptAndSign(UA_WriterGroup *wg, const UA_NetworkMessage *nm,
-               UA_Byte *signStart, UA_Byte *encryptStart,
-               UA_Byte *msgEnd);
-
 static UA_StatusCode
 generateNetworkMessage(UA_PubSubConnection *connection, UA_WriterGroup *wg,
                        UA_DataSetMessage *dsm, UA_UInt16 *writerIds, UA_Byte dsmCount,
@@ -33,6 +28,10 @@ generateNetworkMessage(UA_PubSubConnection *connection, UA_WriterGroup *wg,
                        UA_ExtensionObject *transportSettings,
                        UA_NetworkMessage *networkMessage);
 
+static UA_StatusCode
+computeOffsetTable(UA_PubSubManager *psm, UA_WriterGroup *wg,
+                   UA_PubSubOffsetTable *ot, size_t **ends);
+
 static void
 UA_WriterGroup_disconnect(UA_WriterGroup *wg);
 
@@ -54,6 +53,29 @@ UA_WriterGroup_canConnect(UA_WriterGroup *wg) {
     return true;
 }
 
+/* Publish timer in a dedicated EventLoop (config.eventLoop). The timer callback
+ * waits for the server lock while the EventLoop holds its timer mutex. So the
+ * timer cannot be removed with the server lock held. Instead the WriterGroup is
+ * detached (under the server lock) and the timer is removed from within the
+ * EventLoop in a delayed callback. The detached timer is never reused for
+ * another WriterGroup. */
+struct UA_WriterGroupPublishTimer {
+    UA_DelayedCallback dc;
+    UA_EventLoop *el;
+    UA_WriterGroup *wg; /* NULL if detached. Protected by the server lock. */
+    UA_UInt64 timerId;
+};
+
+static void
+publishTimerCallback(UA_PubSubManager *psm, UA_WriterGroupPublishTimer *pt);
+
+static void
+removePublishTimer(void *application, void *context) {
+    UA_WriterGroupPublishTimer *pt = (UA_WriterGroupPublishTimer*)context;
+    pt->el->removeTimer(pt->el, pt->timerId);
+    UA_free(pt);
+}
+
 UA_StatusCode
 UA_WriterGroup_addPublishCallback(UA_PubSubManager *psm, UA_WriterGroup *wg) {
     UA_LOCK_ASSERT(&psm->sc.server->serviceMutex);
@@ -62,19 +84,60 @@ UA_WriterGroup_addPublishCallback(UA_PubSubManager *psm, UA_WriterGroup *wg) {
     if(wg->publishCallbackId != 0)
         return UA_STATUSCODE_GOOD;
 
-    /* Use EventLoop for cyclic callbacks */
-    UA_EventLoop *el = psm->sc.server->config.eventLoop;
-    return el->addTimer(el, (UA_Callback)UA_WriterGroup_publishCallback,
-                        psm, wg, wg->config.publishingInterval,
-                        NULL /* TODO: use basetime */,
-                        UA_TIMERPOLICY_CURRENTTIME,
-                        &wg->publishCallbackId);
+    /* Restart the timing statistics */
+    UA_LOCK(&wg->publishLock);
+    memset(&wg->timing, 0, sizeof(UA_WriterGroupTiming));
+    wg->lastWakeup = 0;
+    UA_UNLOCK(&wg->publishLock);
+
+    /* Use the server EventLoop for cyclic callbacks */
+    if(!wg->config.eventLoop) {
+        UA_EventLoop *el = psm->sc.server->config.eventLoop;
+        return el->addTimer(el, (UA_Callback)UA_WriterGroup_publishCallback,
+                            psm, wg, wg->config.publishingInterval,
+                            NULL /* TODO: use basetime */,
+                            UA_TIMERPOLICY_CURRENTTIME,
+                            &wg->publishCallbackId);
+    }
+
+    /* Use the dedicated EventLoop */
+    UA_WriterGroupPublishTimer *pt = (UA_WriterGroupPublishTimer*)
+        UA_calloc(1, sizeof(UA_WriterGroupPublishTimer));
+    if(!pt)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    pt->el = wg->config.eventLoop;
+    pt->wg = wg;
+    UA_StatusCode res =
+        pt->el->addTimer(pt->el, (UA_Callback)publishTimerCallback,
+                         psm, pt, wg->config.publishingInterval,
+                         NULL /* TODO: use basetime */,
+                         UA_TIMERPOLICY_CURRENTTIME, &pt->timerId);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_free(pt);
+        return res;
+    }
+    wg->publishTimer = pt;
+    wg->publishCallbackId = pt->timerId;
+    return UA_STATUSCODE_GOOD;
 }
 
 void
 UA_WriterGroup_removePublishCallback(UA_PubSubManager *psm, UA_WriterGroup *wg) {
     if(wg->publishCallbackId == 0)
         return;
+
+    /* Detach from the dedicated EventLoop */
+    UA_WriterGroupPublishTimer *pt = wg->publishTimer;
+    if(pt) {
+        pt->wg = NULL;
+        pt->dc.callback = removePublishTimer;
+        pt->dc.context = pt;
+        pt->el->addDelayedCallback(pt->el, &pt->dc);
+        wg->publishTimer = NULL;
+        wg->publishCallbackId = 0;
+        return;
+    }
+
     UA_EventLoop *el = psm->sc.server->config.eventLoop;
     if(UA_LIKELY(el != NULL))
         el->removeTimer(el, wg->publishCallbackId);
@@ -122,6 +185,16 @@ writerGroupAttachSKSKeystorage(UA_PubSubManager *psm, UA_WriterGroup *wg) {
 static UA_StatusCode
 validateWriterGroupConfig(UA_PubSubManager *psm, UA_PubSubComponentHead *logHead,
                           const UA_WriterGroupConfig *config) {
+#if UA_MULTITHREADING < 100
+    /* The dedicated EventLoop runs in another thread */
+    if(config->eventLoop) {
+        UA_LOG_WARNING_PUBSUB(psm->logging, (UA_PubSubConnection*)logHead,
+                              "A dedicated EventLoop for the WriterGroup "
+                              "requires UA_MULTITHREADING >= 100");
+        return UA_STATUSCODE_BADCONFIGURATIONERROR;
+    }
+#endif
+
     const UA_ExtensionObject *ms = &config->messageSettings;
     if(ms->encoding == UA_EXTENSIONOBJECT_ENCODED_NOBODY)
         return UA_STATUSCODE_GOOD;
@@ -177,10 +250,12 @@ UA_WriterGroup_create(UA_PubSubManager *psm, const UA_NodeId connection,
 
     wg->head.componentType = UA_PUBSUBCOMPONENT_WRITERGROUP;
     wg->linkedConnection = c;
+    UA_LOCK_INIT(&wg->publishLock);
 
     /* Deep copy of the config */
     res = UA_WriterGroupConfig_copy(config, &wg->config);
     if(res != UA_STATUSCODE_GOOD) {
+        UA_LOCK_DESTROY(&wg->publishLock);
         UA_free(wg);
         return res;
     }
@@ -279,7 +354,9 @@ UA_WriterGroup_remove(UA_PubSubManager *psm, UA_WriterGroup *wg) {
     /* Disable (and disconnect) and set the deleteFlag. This prevents a
      * reconnect and triggers the deletion when the last open socket is
      * closed. */
+    UA_LOCK(&wg->publishLock);
     wg->deleteFlag = true;
+    UA_UNLOCK(&wg->publishLock);
     UA_WriterGroup_setPubSubState(psm, wg, UA_PUBSUBSTATE_DISABLED);
 
     UA_DataSetWriter *dsw, *dsw_tmp;
@@ -287,10 +364,17 @@ UA_WriterGroup_remove(UA_PubSubManager *psm, UA_WriterGroup *wg) {
         UA_DataSetWriter_remove(psm, dsw);
     }
 
-    if(wg->config.securityPolicy && wg->securityPolicyContext) {
-        wg->config.securityPolicy->deleteContext(wg->securityPolicyContext);
-        wg->securityPolicyContext = NULL;
-    }
+    /* A publish cycle outside the server lock deletes the security context
+     * when it is done. And then calls _remove again to free the WriterGroup. */
+    UA_LOCK(&wg->publishLock);
+    UA_Boolean publishing = wg->publishing;
+    void *securityContext = wg->securityPolicyContext;
+    if(publishing && securityContext == wg->publishingSecurityContext)
+        securityContext = NULL;
+    wg->securityPolicyContext = NULL;
+    UA_UNLOCK(&wg->publishLock);
+    if(wg->config.securityPolicy && securityContext)
+        wg->config.securityPolicy->deleteContext(securityContext);
 
 #ifdef UA_ENABLE_PUBSUB_SKS
     if(wg->keyStorage) {
@@ -299,7 +383,7 @@ UA_WriterGroup_remove(UA_PubSubManager *psm, UA_WriterGroup *wg) {
     }
 #endif
 
-    if(wg->sendChannel == 0) {
+    if(wg->sendChannel == 0 && !publishing) {
         /* Unlink from the connection */
         LIST_REMOVE(wg, listEntry);
         connection->writerGroupsSize--;
@@ -312,8 +396,10 @@ UA_WriterGroup_remove(UA_PubSubManager *psm, UA_WriterGroup *wg) {
 
         UA_LOG_INFO_PUBSUB(psm->logging, wg, "WriterGroup deleted");
 
+        UA_WriterGroup_clearFrozenMessage(wg);
         UA_WriterGroupConfig_clear(&wg->config);
         UA_PubSubComponentHead_clear(&wg->head);
+        UA_LOCK_DESTROY(&wg->publishLock);
         UA_free(wg);
     }
 
@@ -377,13 +463,27 @@ UA_WriterGroup_setEncryptionKeys(UA_PubSubManager *psm, UA_WriterGroup *wg,
         wg->nonceSequenceNumber = 1;
     }
 
+    /* Don't modify the context while a publish cycle outside the server lock
+     * uses it. Replace it instead. The publish cycle deletes the old context
+     * when it is done. */
+    UA_LOCK(&wg->publishLock);
+    UA_Boolean inUse = (wg->publishing &&
+                        wg->securityPolicyContext == wg->publishingSecurityContext);
+    UA_UNLOCK(&wg->publishLock);
+
     UA_StatusCode res = UA_STATUSCODE_BAD;
-    if(!wg->securityPolicyContext) {
+    if(!wg->securityPolicyContext || inUse) {
         /* Create a new context */
+        void *securityContext = NULL;
         res = wg->config.securityPolicy->
             newContext(wg->config.securityPolicy->policyContext,
                        &signingKey, &encryptingKey, &keyNonce,
-                       &wg->securityPolicyContext);
+                       &securityContext);
+        if(res == UA_STATUSCODE_GOOD) {
+            UA_LOCK(&wg->publishLock);
+            wg->securityPolicyContext = securityContext;
+            UA_UNLOCK(&wg->publishLock);
+        }
     } else {
         /* Update the context */
         res = wg->config.securityPolicy->
@@ -508,6 +608,10 @@ UA_WriterGroup_setPubSubState(UA_PubSubManager *psm, UA_WriterGroup *wg,
 
  finalize_state_machine:
 
+    /* Freeze the NetworkMessage layout again after a state change */
+    if(wg->head.state != oldState)
+        UA_WriterGroup_clearFrozenMessage(wg);
+
     /* Only the top-level state update (if recursive calls are happening)
      * notifies the application and updates Reader and WriterGroups */
     wg->head.transientState = isTransient;
@@ -545,89 +649,128 @@ UA_WriterGroup_setPubSubState(UA_PubSubManager *psm, UA_WriterGroup *wg,
     return ret;
 }
 
+/* A NetworkMessage that is encoded during the publish cycle. Signing,
+ * encryption and sending happen afterwards without the server lock. */
+typedef struct {
+    UA_ByteString buf;
+    uintptr_t sendChannel;
+    UA_Boolean sign;
+    UA_Boolean encrypt;
+    size_t encryptStart; /* Offset of the payload */
+    size_t msgEnd;       /* Offset of the signature */
+    size_t nonceSize;
+    UA_Byte nonce[UA_NETWORKMESSAGE_MAX_NONCE_LENGTH];
+} PendingMessage;
+
 static UA_StatusCode
-encryptAndSign(UA_WriterGroup *wg, const UA_NetworkMessage *nm,
-               UA_Byte *signStart, UA_Byte *encryptStart,
-               UA_Byte *msgEnd) {
+encryptAndSign(UA_PubSubSecurityPolicy *sp, void *channelContext,
+               PendingMessage *pm) {
     UA_StatusCode rv;
-    void *channelContext = wg->securityPolicyContext;
+    UA_Byte *msgEnd = &pm->buf.data[pm->msgEnd];
 
-    if(nm->securityHeader.networkMessageEncrypted) {
+    if(pm->encrypt) {
         /* Set the temporary MessageNonce in the SecurityPolicy */
-        const UA_ByteString nonce = {
-            (size_t)nm->securityHeader.messageNonceSize,
-            (UA_Byte*)(uintptr_t)nm->securityHeader.messageNonce
-        };
-        rv = wg->config.securityPolicy->setMessageNonce(channelContext, &nonce);
+        const UA_ByteString nonce = {pm->nonceSize, pm->nonce};
+        rv = sp->setMessageNonce(channelContext, &nonce);
         UA_CHECK_STATUS(rv, return rv);
 
         /* The encryption is done in-place, no need to encode again */
         UA_ByteString toBeEncrypted =
-            {(uintptr_t)msgEnd - (uintptr_t)encryptStart, encryptStart};
-        rv = wg->config.securityPolicy->symmetricModule.cryptoModule.encryptionAlgorithm.
+            {pm->msgEnd - pm->encryptStart, &pm->buf.data[pm->encryptStart]};
+        rv = sp->symmetricModule.cryptoModule.encryptionAlgorithm.
             encrypt(channelContext, &toBeEncrypted);
         UA_CHECK_STATUS(rv, return rv);
     }
 
-    if(nm->securityHeader.networkMessageSigned) {
-        UA_ByteString toBeSigned = {(uintptr_t)msgEnd - (uintptr_t)signStart,
-                                    signStart};
+    if(pm->sign) {
+        UA_ByteString toBeSigned = {pm->msgEnd, pm->buf.data};
 
-        size_t sigSize = wg->config.securityPolicy->symmetricModule.cryptoModule.
+        size_t sigSize = sp->symmetricModule.cryptoModule.
                      signatureAlgorithm.getLocalSignatureSize(channelContext);
         UA_ByteString signature = {sigSize, msgEnd};
 
-        rv = wg->config.securityPolicy->symmetricModule.cryptoModule.
+        rv = sp->symmetricModule.cryptoModule.
             signatureAlgorithm.sign(channelContext, &toBeSigned, &signature);
         UA_CHECK_STATUS(rv, return rv);
     }
     return UA_STATUSCODE_GOOD;
 }
 
+/* Encode the message. Remember the offsets for the signing and encryption. */
 static UA_StatusCode
-encodeNetworkMessage(UA_WriterGroup *wg, PubSubEncodeCtx *ctx,
-                     UA_NetworkMessage *nm, UA_ByteString *buf) {
-    UA_Byte *networkMessageStart = buf->data;
+encodeNetworkMessage(PubSubEncodeCtx *ctx, UA_NetworkMessage *nm,
+                     UA_ByteString *buf, PendingMessage *pm) {
     UA_StatusCode rv = UA_NetworkMessage_encodeHeaders(ctx, nm);
     UA_CHECK_STATUS(rv, return rv);
 
-    UA_Byte *payloadStart = ctx->ctx.pos;
+    pm->encryptStart = (uintptr_t)ctx->ctx.pos - (uintptr_t)buf->data;
     rv = UA_NetworkMessage_encodePayload(ctx, nm);
     UA_CHECK_STATUS(rv, return rv);
 
     rv = UA_NetworkMessage_encodeFooters(ctx, nm);
     UA_CHECK_STATUS(rv, return rv);
 
-    /* Encrypt and Sign the message */
-    UA_Byte *footerEnd = ctx->ctx.pos;
-    return encryptAndSign(wg, nm, networkMessageStart, payloadStart, footerEnd);
+    pm->msgEnd = (uintptr_t)ctx->ctx.pos - (uintptr_t)buf->data;
+    pm->sign = nm->securityHeader.networkMessageSigned;
+    pm->encrypt = nm->securityHeader.networkMessageEncrypted;
+    pm->nonceSize = nm->securityHeader.messageNonceSize;
+    memcpy(pm->nonce, nm->securityHeader.messageNonce, pm->nonceSize);
+    return UA_STATUSCODE_GOOD;
 }
 
-static void
-sendNetworkMessageBuffer(UA_PubSubManager *psm, UA_WriterGroup *wg, 
-                         UA_PubSubConnection *connection, uintptr_t connectionId,
-                         UA_ByteString *buffer) {
-    UA_StatusCode res = connection->cm->
-        sendWithConnection(connection->cm, connectionId,
-                           &UA_KEYVALUEMAP_NULL, buffer);
-
-    /* Failure, set the WriterGroup into an error mode */
-    if(res != UA_STATUSCODE_GOOD) {
-        UA_LOG_ERROR_PUBSUB(psm->logging, wg,
-                            "Sending NetworkMessage failed");
-        UA_WriterGroup_setPubSubState(psm, wg, UA_PUBSUBSTATE_ERROR);
-        UA_PubSubConnection_setPubSubState(psm, connection, UA_PUBSUBSTATE_ERROR);
-        return;
+/* Sign, encrypt and send the NetworkMessages of the publish cycle. This is
+ * called without any lock held. The buffers are always released. All but the
+ * last NetworkMessage are sent with the "more" flag so that the
+ * ConnectionManager can queue the buffers and send them all together. The
+ * signTime is negative if no message was secured. */
+static UA_StatusCode
+sendPendingMessages(UA_EventLoop *el, UA_ConnectionManager *cm,
+                    UA_PubSubSecurityPolicy *sp, void *channelContext,
+                    PendingMessage *pending, size_t pendingSize,
+                    UA_Boolean *sendFailed, UA_DateTime *signTimeOut,
+                    UA_DateTime *sendTimeOut) {
+    UA_KeyValuePair kvp;
+    UA_KeyValueMap kvm = {0, &kvp};
+    UA_Boolean more = true;
+    kvp.key = UA_QUALIFIEDNAME(0, "more");
+    UA_Variant_setScalar(&kvp.value, &more, &UA_TYPES[UA_TYPES_BOOLEAN]);
+
+    UA_Boolean secured = false;
+    UA_DateTime signTime = 0;
+    UA_DateTime sendTime = 0;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < pendingSize; i++) {
+        PendingMessage *pm = &pending[i];
+        UA_DateTime start = el->dateTime_nowMonotonic(el);
+        if(res == UA_STATUSCODE_GOOD && (pm->sign || pm->encrypt)) {
+            res = encryptAndSign(sp, channelContext, pm);
+            UA_DateTime signed_ = el->dateTime_nowMonotonic(el);
+            signTime += signed_ - start;
+            start = signed_;
+            secured = true;
+        }
+        if(res != UA_STATUSCODE_GOOD) {
+            cm->freeNetworkBuffer(cm, pm->sendChannel, &pm->buf);
+            continue;
+        }
+        kvm.mapSize = (i + 1 < pendingSize) ? 1 : 0;
+        res = cm->sendWithConnection(cm, pm->sendChannel, &kvm, &pm->buf);
+        sendTime += el->dateTime_nowMonotonic(el) - start;
+        if(res != UA_STATUSCODE_GOOD)
+            *sendFailed = true;
     }
 
-    /* Sending successful - increase the sequence number */
-    wg->sequenceNumber++;
+    *signTimeOut = (secured) ? signTime : -1;
+    *sendTimeOut = sendTime;
+    return res;
 }
 
 #ifdef UA_ENABLE_JSON_ENCODING
 static UA_StatusCode
-sendNetworkMessageJson(UA_PubSubManager *psm, UA_PubSubConnection *connection, UA_WriterGroup *wg,
-                       UA_DataSetMessage *dsm, UA_UInt16 *writerIds, UA_Byte dsmCount) {
+prepareNetworkMessageJson(UA_PubSubManager *psm, UA_PubSubConnection *connection,
+                          UA_WriterGroup *wg, UA_DataSetMessage *dsm,
+                          UA_UInt16 *writerIds, UA_Byte dsmCount,
+                          PendingMessage *pm) {
     /* Prepare the NetworkMessage */
     UA_NetworkMessage nm;
     memset(&nm, 0, sizeof(UA_NetworkMessage));
@@ -693,8 +836,10 @@ sendNetworkMessageJson(UA_PubSubManager *psm, UA_PubSubConnection *connection, U
     }
     UA_assert(ctx.ctx.pos == ctx.ctx.end);
 
-    /* Send the prepared messages */
-    sendNetworkMessageBuffer(psm, wg, connection, sendChannel, &buf);
+    /* The message is sent after the server lock is released */
+    pm->buf = buf;
+    pm->sendChannel = sendChannel;
+    wg->sequenceNumber++;
     return UA_STATUSCODE_GOOD;
 }
 #endif
@@ -797,9 +942,10 @@ generateNetworkMessage(UA_PubSubConnection *connection, UA_WriterGroup *wg,
 }
 
 static UA_StatusCode
-sendNetworkMessageBinary(UA_PubSubManager *psm, UA_PubSubConnection *connection,
-                         UA_WriterGroup *wg, UA_DataSetMessage *dsm, UA_UInt16 *writerIds,
-                         UA_Byte dsmCount) {
+prepareNetworkMessageBinary(UA_PubSubManager *psm, UA_PubSubConnection *connection,
+                            UA_WriterGroup *wg, UA_DataSetMessage *dsm,
+                            UA_UInt16 *writerIds, UA_Byte dsmCount,
+                            PendingMessage *pm) {
     UA_NetworkMessage nm;
     memset(&nm, 0, sizeof(UA_NetworkMessage));
 
@@ -863,39 +1009,48 @@ sendNetworkMessageBinary(UA_PubSubManager *psm, UA_PubSubConnection *connection,
     rv = cm->allocNetworkBuffer(cm, sendChannel, &buf, msgSize);
     UA_CHECK_STATUS(rv, return rv);
 
-    /* Encode and encrypt the message */
+    /* Encode the message */
     ctx.ctx.pos = buf.data;
     ctx.ctx.end = &buf.data[buf.length];
-    rv = encodeNetworkMessage(wg, &ctx, &nm, &buf);
+    rv = encodeNetworkMessage(&ctx, &nm, &buf, pm);
     if(rv != UA_STATUSCODE_GOOD) {
         cm->freeNetworkBuffer(cm, sendChannel, &buf);
         return rv;
     }
 
-    /* Send out the message */
-    sendNetworkMessageBuffer(psm, wg, connection, sendChannel, &buf);
+    /* The message is signed, encrypted and sent after the server lock is
+     * released */
+    pm->buf = buf;
+    pm->sendChannel = sendChannel;
+    wg->sequenceNumber++;
     return UA_STATUSCODE_GOOD;
 }
 
-static void
-sendNetworkMessage(UA_PubSubManager *psm, UA_WriterGroup *wg, UA_PubSubConnection *connection,
-                   UA_DataSetMessage *dsm, UA_UInt16 *writerIds, UA_Byte dsmCount) {
+/* Encode a NetworkMessage into a network buffer. Sets the WriterGroup into an
+ * error state if this fails. */
+static UA_StatusCode
+prepareNetworkMessage(UA_PubSubManager *psm, UA_WriterGroup *wg,
+                      UA_PubSubConnection *connection, UA_DataSetMessage *dsm,
+                      UA_UInt16 *writerIds, UA_Byte dsmCount, PendingMessage *pm) {
     if(dsmCount >= UA_NETWORKMESSAGE_MAXMESSAGECOUNT) {
         UA_LOG_ERROR_PUBSUB(psm->logging, wg,
                             "More DataSetMessages than allowed in "
                             "UA_NETWORKMESSAGE_MAXMESSAGECOUNT");
         UA_WriterGroup_setPubSubState(psm, wg, UA_PUBSUBSTATE_ERROR);
-        return;
+        return UA_STATUSCODE_BADINTERNALERROR;
     }
 
     UA_StatusCode res = UA_STATUSCODE_GOOD;
+    memset(pm, 0, sizeof(PendingMessage));
     switch(wg->config.encodingMimeType) {
     case UA_PUBSUB_ENCODING_UADP:
-        res = sendNetworkMessageBinary(psm, connection, wg, dsm, writerIds, dsmCount);
+        res = prepareNetworkMessageBinary(psm, connection, wg, dsm, writerIds,
+                                          dsmCount, pm);
         break;
 #ifdef UA_ENABLE_JSON_ENCODING
     case UA_PUBSUB_ENCODING_JSON:
-        res = sendNetworkMessageJson(psm, connection, wg, dsm, writerIds, dsmCount);
+        res = prepareNetworkMessageJson(psm, connection, wg, dsm, writerIds,
+                                        dsmCount, pm);
         break;
 #endif
     default:
@@ -903,47 +1058,254 @@ sendNetworkMessage(UA_PubSubManager *psm, UA_WriterGroup *wg, UA_PubSubConnectio
         break;
     }
 
-    /* If sending failed, disable all writer of the writergroup */
+    /* If encoding failed, disable all writer of the writergroup */
     if(res != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR_PUBSUB(psm->logging, wg,
-                            "PubSub Publish: Could not send a NetworkMessage "
+                            "PubSub Publish: Could not encode a NetworkMessage "
                             "with status code %s", UA_StatusCode_name(res));
         UA_WriterGroup_setPubSubState(psm, wg, UA_PUBSUBSTATE_ERROR);
     }
+    return res;
 }
 
-/* This callback triggers the collection and publish of NetworkMessages and the
- * contained DataSetMessages. */
+/*****************/
+/* Frozen Layout */
+/*****************/
+
+/* Publish cycles to wait after the layout has changed or could not be frozen */
+#define UA_WRITERGROUP_FROZENRETRY 64
+
 void
-UA_WriterGroup_publishCallback(UA_PubSubManager *psm, UA_WriterGroup *wg) {
-    UA_assert(wg != NULL);
-    UA_assert(psm != NULL);
+UA_WriterGroup_clearFrozenMessage(UA_WriterGroup *wg) {
+    UA_PubSubOffsetTable_clear(&wg->frozen);
+    UA_free(wg->frozenEnds);
+    wg->frozenEnds = NULL;
+    wg->frozenRetry = 0;
+}
 
-    UA_LOG_DEBUG_PUBSUB(psm->logging, wg, "Publish Callback");
+/* The layout can be frozen if all DataSetMessages are KeyFrames in a single
+ * unsecured UADP NetworkMessage */
+static UA_Boolean
+canFreezeLayout(UA_PubSubManager *psm, UA_WriterGroup *wg, UA_Byte maxDSM) {
+    if(wg->config.encodingMimeType != UA_PUBSUB_ENCODING_UADP ||
+       wg->config.securityMode > UA_MESSAGESECURITYMODE_NONE ||
+       wg->writersCount == 0 || wg->writersCount > maxDSM ||
+       wg->writersCount >= UA_NETWORKMESSAGE_MAXMESSAGECOUNT)
+        return false;
 
-    lockServer(psm->sc.server);
+    UA_Boolean deltaFrames = psm->sc.server->config.pubSubConfig.enableDeltaFrames;
+    UA_DataSetWriter *dsw;
+    LIST_FOREACH(dsw, &wg->writers, listEntry) {
+        if(dsw->head.state != UA_PUBSUBSTATE_OPERATIONAL)
+            return false;
+        UA_PublishedDataSet *pds = dsw->connectedDataSet;
+        if(!pds)
+            continue; /* Heartbeat */
+        if(pds->promotedFieldsCount > 0)
+            return false;
+        /* DeltaFrames are only sent for more than one field */
+        if(deltaFrames && pds->fieldSize > 1 && dsw->config.keyFrameCount > 1)
+            return false;
+    }
+    return true;
+}
 
-    /* Find the connection associated with the writer */
-    UA_PubSubConnection *connection = wg->linkedConnection;
-    if(!connection) {
+/* Encode the current field value into its slot in the frozen message. Fails if
+ * the encoding does not fit the slot exactly. */
+static UA_StatusCode
+patchFrozenField(UA_PubSubManager *psm, UA_DataSetWriter *dsw, UA_DataSetField *dsf,
+                 UA_PubSubOffsetType offsetType, UA_Byte *pos, const UA_Byte *end) {
+    UA_DataValue v;
+    const UA_Node *node = UA_PubSubDataSetField_peekValue(psm, dsf, &v);
+
+    /* Apply the content mask (the same as for the KeyFrame generation) */
+    u64 mask = (u64)dsw->config.dataSetFieldContentMask;
+    if((mask & (u64)UA_DATASETFIELDCONTENTMASK_STATUSCODE) == 0)
+        v.hasStatus = false;
+    if((mask & (u64)UA_DATASETFIELDCONTENTMASK_SOURCETIMESTAMP) == 0)
+        v.hasSourceTimestamp = false;
+    if((mask & (u64)UA_DATASETFIELDCONTENTMASK_SOURCEPICOSECONDS) == 0)
+        v.hasSourcePicoseconds = false;
+    if((mask & (u64)UA_DATASETFIELDCONTENTMASK_SERVERTIMESTAMP) == 0)
+        v.hasServerTimestamp = false;
+    if((mask & (u64)UA_DATASETFIELDCONTENTMASK_SERVERPICOSECONDS) == 0)
+        v.hasServerPicoseconds = false;
+
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    const UA_DataType *type = v.value.type;
+    switch(offsetType) {
+    case UA_PUBSUBOFFSETTYPE_DATASETFIELD_DATAVALUE:
+        res = UA_encodeBinaryInternal(&v, &UA_TYPES[UA_TYPES_DATAVALUE],
+                                      &pos, &end, NULL, NULL, NULL);
+        break;
+    case UA_PUBSUBOFFSETTYPE_DATASETFIELD_VARIANT:
+        res = UA_encodeBinaryInternal(&v.value, &UA_TYPES[UA_TYPES_VARIANT],
+                                      &pos, &end, NULL, NULL, NULL);
+        break;
+    default:
+        /* The ArrayDimensions before the offset are unchanged if the
+         * one-dimensional array has the same size */
+        if(!type || !type->pointerFree || v.value.arrayDimensionsSize > 1) {
+            res = UA_STATUSCODE_BADENCODINGERROR;
+            break;
+        }
+        if(UA_Variant_isScalar(&v.value)) {
+            res = UA_encodeBinaryInternal(v.value.data, type, &pos, &end,
+                                          NULL, NULL, NULL);
+            break;
+        }
+        for(size_t i = 0; i < v.value.arrayLength && res == UA_STATUSCODE_GOOD; i++)
+            res = UA_encodeBinaryInternal((void*)((uintptr_t)v.value.data +
+                                                  i * type->memSize),
+                                          type, &pos, &end, NULL, NULL, NULL);
+        break;
+    }
+    if(res == UA_STATUSCODE_GOOD && pos != end)
+        res = UA_STATUSCODE_BADENCODINGERROR;
+
+    if(node)
+        UA_NODESTORE_RELEASE(psm->sc.server, node);
+    else
+        UA_DataValue_clear(&v);
+    return res;
+}
+
+/* Patch the frozen message for the current publish cycle. The sequence numbers
+ * of the DataSetWriters are increased only if the patching succeeds. */
+static UA_StatusCode
+patchFrozenMessage(UA_PubSubManager *psm, UA_WriterGroup *wg) {
+    UA_EventLoop *el = psm->sc.server->config.eventLoop;
+    UA_DateTime now = el->dateTime_now(el);
+    UA_PubSubOffsetTable *ot = &wg->frozen;
+    UA_Byte *data = ot->networkMessage.data;
+    UA_DataSetWriter *dsw = NULL;
+    UA_DataSetField *dsf = NULL;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < ot->offsetsSize && res == UA_STATUSCODE_GOOD; i++) {
+        UA_PubSubOffset *o = &ot->offsets[i];
+        UA_Byte *pos = &data[o->offset];
+        const UA_Byte *end = &data[wg->frozenEnds[i]];
+        switch(o->offsetType) {
+        case UA_PUBSUBOFFSETTYPE_NETWORKMESSAGE_SEQUENCENUMBER:
+            res = UA_UInt16_encodeBinary(&wg->sequenceNumber, &pos, end);
+            break;
+        case UA_PUBSUBOFFSETTYPE_DATASETMESSAGE:
+            dsw = (dsw == NULL) ? LIST_FIRST(&wg->writers) : LIST_NEXT(dsw, listEntry);
+            dsf = NULL;
+            break;
+        case UA_PUBSUBOFFSETTYPE_DATASETMESSAGE_SEQUENCENUMBER:
+            res = UA_UInt16_encodeBinary(&dsw->actualDataSetMessageSequenceCount,
+                                         &pos, end);
+            break;
+        case UA_PUBSUBOFFSETTYPE_DATASETMESSAGE_TIMESTAMP:
+            res = UA_DateTime_encodeBinary(&now, &pos, end);
+            break;
+        case UA_PUBSUBOFFSETTYPE_DATASETFIELD_DATAVALUE:
+        case UA_PUBSUBOFFSETTYPE_DATASETFIELD_VARIANT:
+        case UA_PUBSUBOFFSETTYPE_DATASETFIELD_RAW:
+            dsf = (dsf == NULL) ?
+                TAILQ_FIRST(&dsw->connectedDataSet->fields) : TAILQ_NEXT(dsf, listEntry);
+            res = patchFrozenField(psm, dsw, dsf, o->offsetType, pos, end);
+            break;
+        default:
+            break; /* Constant content */
+        }
+    }
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    /* Automatically rolls over to zero */
+    LIST_FOREACH(dsw, &wg->writers, listEntry) {
+        dsw->actualDataSetMessageSequenceCount++;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Publish from the frozen NetworkMessage. The message is frozen in the first
+ * publish cycle where this is possible. Afterwards only the changing parts are
+ * patched in place. Returns false if the regular publish path has to be
+ * taken. */
+static UA_Boolean
+publishFrozen(UA_PubSubManager *psm, UA_WriterGroup *wg,
+              UA_PubSubConnection *connection, UA_Byte maxDSM,
+              PendingMessage *pending, size_t *pendingSize) {
+    if(!canFreezeLayout(psm, wg, maxDSM)) {
+        if(wg->frozen.networkMessage.length > 0)
+            UA_WriterGroup_clearFrozenMessage(wg);
+        return false;
+    }
+
+    /* Wait before the next attempt */
+    if(wg->frozenRetry > 0) {
+        wg->frozenRetry--;
+        return false;
+    }
+
+    if(wg->frozen.networkMessage.length == 0) {
+        /* Freeze. The encoded message contains the values sampled right now.
+         * It is sent without patching. */
+        UA_StatusCode res = computeOffsetTable(psm, wg, &wg->frozen, &wg->frozenEnds);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_LOG_DEBUG_PUBSUB(psm->logging, wg,
+                                "The NetworkMessage layout cannot be frozen");
+            wg->frozenRetry = UA_WRITERGROUP_FROZENRETRY;
+            return false;
+        }
+    } else if(patchFrozenMessage(psm, wg) != UA_STATUSCODE_GOOD) {
+        /* The layout has changed */
+        UA_LOG_DEBUG_PUBSUB(psm->logging, wg,
+                            "The NetworkMessage layout has changed, unfreeze");
+        UA_WriterGroup_clearFrozenMessage(wg);
+        wg->frozenRetry = UA_WRITERGROUP_FROZENRETRY;
+        return false;
+    }
+
+    /* Select the wg sendchannel if configured */
+    UA_ConnectionManager *cm = connection->cm;
+    uintptr_t sendChannel = connection->sendChannel;
+    if(wg->sendChannel != 0)
+        sendChannel = wg->sendChannel;
+    if(!cm || sendChannel == 0) {
+        UA_LOG_ERROR_PUBSUB(psm->logging, wg, "Cannot send, no open connection");
+        UA_WriterGroup_setPubSubState(psm, wg, UA_PUBSUBSTATE_ERROR);
+        return true;
+    }
+
+    /* Copy into the network buffer. No allocation if the ConnectionManager
+     * has a preallocated transmit buffer. */
+    UA_ByteString buf = UA_BYTESTRING_NULL;
+    UA_StatusCode res = cm->allocNetworkBuffer(cm, sendChannel, &buf,
+                                               wg->frozen.networkMessage.length);
+    if(res != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR_PUBSUB(psm->logging, wg,
-                            "Publish failed. PubSubConnection invalid");
+                            "PubSub Publish: Could not allocate the network buffer");
         UA_WriterGroup_setPubSubState(psm, wg, UA_PUBSUBSTATE_ERROR);
-        unlockServer(psm->sc.server);
-        return;
+        return true;
     }
+    memcpy(buf.data, wg->frozen.networkMessage.data, wg->frozen.networkMessage.length);
 
-    /* How many DSM can be sent in one NM? */
-    UA_Byte maxDSM = (UA_Byte)wg->config.maxEncapsulatedDataSetMessageCount;
-    if(wg->config.maxEncapsulatedDataSetMessageCount > UA_BYTE_MAX)
-        maxDSM = UA_BYTE_MAX;
-    if(maxDSM == 0)
-        maxDSM = 1; /* Send at least one dsm */
+    UA_EventLoop *el = psm->sc.server->config.eventLoop;
+    wg->lastPublishTimeStamp = el->dateTime_nowMonotonic(el);
+    wg->sequenceNumber++;
+
+    /* Sent after the server lock is released */
+    memset(pending, 0, sizeof(PendingMessage));
+    pending->buf = buf;
+    pending->sendChannel = sendChannel;
+    *pendingSize = 1;
+    return true;
+}
 
-    /* It is possible to put several DataSetMessages into one NetworkMessage.
-     * But only if they do not contain promoted fields. NM with promoted fields
-     * are sent out right away. The others are kept in a buffer for
-     * "batching". */
+/* Encode the DataSetMessages of all enabled DataSetWriters into
+ * NetworkMessages. It is possible to put several DataSetMessages into one
+ * NetworkMessage. But only if they do not contain promoted fields. NM with
+ * promoted fields are prepared right away. The others are kept in a buffer for
+ * "batching". */
+static size_t
+prepareNetworkMessages(UA_PubSubManager *psm, UA_WriterGroup *wg,
+                       UA_PubSubConnection *connection, UA_Byte maxDSM,
+                       PendingMessage *pending) {
+    size_t pendingSize = 0;
     size_t dsmCount = 0;
     UA_STACKARRAY(UA_UInt16, dsWriterIds, wg->writersCount);
     UA_STACKARRAY(UA_DataSetMessage, dsmStore, wg->writersCount);
@@ -975,8 +1337,11 @@ UA_WriterGroup_publishCallback(UA_PubSubManager *psm, UA_WriterGroup *wg) {
         /* There is no promoted field -> send right away */
         if(pds && pds->promotedFieldsCount > 0) {
             wg->lastPublishTimeStamp = el->dateTime_nowMonotonic(el);
-            sendNetworkMessage(psm, wg, connection, &dsmStore[dsmCount],
-                               &dsWriterIds[dsmCount], 1);
+            res = prepareNetworkMessage(psm, wg, connection, &dsmStore[dsmCount],
+                                        &dsWriterIds[dsmCount], 1,
+                                        &pending[pendingSize]);
+            if(res == UA_STATUSCODE_GOOD)
+                pendingSize++;
 
             UA_DataSetMessage_clear(&dsmStore[dsmCount]);
             continue; /* Don't increase the dsmCount, reuse the slot */
@@ -989,19 +1354,20 @@ UA_WriterGroup_publishCallback(UA_PubSubManager *psm, UA_WriterGroup *wg) {
     if(enabledWriters == 0) {
         UA_LOG_WARNING_PUBSUB(psm->logging, wg,
                               "Cannot publish -- No Writers are enabled");
-        unlockServer(psm->sc.server);
-        return;
+        return 0;
     }
 
-    /* Send the NetworkMessages with batched DataSetMessages */
+    /* Prepare the NetworkMessages with batched DataSetMessages */
     UA_Byte nmDsmCount = 0;
     for(size_t i = 0; i < dsmCount; i += nmDsmCount) {
         /* How many dsm are batched in this iteration? */
         nmDsmCount = (i + maxDSM > dsmCount) ? (UA_Byte)(dsmCount - i) : maxDSM;
         wg->lastPublishTimeStamp = el->dateTime_nowMonotonic(el);
-        /* Send the batched messages */
-        sendNetworkMessage(psm, wg, connection, &dsmStore[i],
-                           &dsWriterIds[i], nmDsmCount);
+        UA_StatusCode res =
+            prepareNetworkMessage(psm, wg, connection, &dsmStore[i], &dsWriterIds[i],
+                                  nmDsmCount, &pending[pendingSize]);
+        if(res == UA_STATUSCODE_GOOD)
+            pendingSize++;
     }
 
     /* Clean up DSM */
@@ -1009,7 +1375,198 @@ UA_WriterGroup_publishCallback(UA_PubSubManager *psm, UA_WriterGroup *wg) {
         UA_DataSetMessage_clear(&dsmStore[i]);
     }
 
-    unlockServer(psm->sc.server);
+    return pendingSize;
+}
+
+/* Record the delay of the publish callback relative to the intended cycle time
+ * (derived from the last callback) and the time until the encoding is done */
+static void
+recordWakeup(UA_WriterGroup *wg, UA_DateTime wakeup, UA_DateTime encoded) {
+    UA_DateTime interval = (UA_DateTime)
+        (wg->config.publishingInterval * (UA_Double)UA_DATETIME_MSEC);
+    if(wg->lastWakeup != 0 && interval > 0) {
+        UA_DateTime late = wakeup - (wg->lastWakeup + interval);
+        if(late < 0)
+            late = 0;
+        UA_PubSubTimingHistogram_add(&wg->timing.wakeupLatency, late);
+        wg->timing.missedCycles += (UA_UInt64)(late / interval);
+    }
+    wg->lastWakeup = wakeup;
+    UA_PubSubTimingHistogram_add(&wg->timing.encodeTime, encoded - wakeup);
+}
+
+/* Leave the publishing state. The security context used by the publish cycle
+ * is returned in retired if it was replaced in the meantime and has to be
+ * deleted. Without the server lock (serverLocked == false), the publishing
+ * state is kept if the WriterGroup was removed in the meantime. The deferred
+ * removal then has to be completed with the server lock. The deleteFlag is
+ * read in the same critical section, so a concurrent _remove either sees the
+ * publishing flag or the cycle sees the deleteFlag. Returns the deleteFlag. */
+static UA_Boolean
+finishPublishing(UA_WriterGroup *wg, UA_Boolean serverLocked, void **retired) {
+    UA_LOCK(&wg->publishLock);
+    UA_Boolean deleted = wg->deleteFlag;
+    *retired = NULL;
+    if(deleted && !serverLocked) {
+        UA_UNLOCK(&wg->publishLock);
+        return true;
+    }
+    if(wg->publishingSecurityContext != wg->securityPolicyContext)
+        *retired = wg->publishingSecurityContext;
+    wg->publishing = false;
+    wg->publishingSecurityContext = NULL;
+    UA_UNLOCK(&wg->publishLock);
+    return deleted;
+}
+
+/* Collect and publish the NetworkMessages and the contained DataSetMessages.
+ * The values are sampled and encoded with the server lock held. Signing,
+ * encryption and sending happen afterwards without any lock held. So slow
+ * (encrypted) WriterGroups do not block the server and other WriterGroups that
+ * publish in other threads. Called with the server lock. Returns without. */
+static void
+publishWriterGroup(UA_PubSubManager *psm, UA_WriterGroup *wg, UA_DateTime wakeup) {
+    UA_Server *server = psm->sc.server;
+    UA_EventLoop *el = server->config.eventLoop;
+
+    UA_LOG_DEBUG_PUBSUB(psm->logging, wg, "Publish Callback");
+
+    /* The previous cycle is still sending. Can only happen if the EventLoop of
+     * the WriterGroup was changed in the meantime. */
+    UA_LOCK(&wg->publishLock);
+    UA_Boolean publishing = wg->publishing;
+    UA_UNLOCK(&wg->publishLock);
+    if(publishing) {
+        unlockServer(server);
+        return;
+    }
+
+    /* Find the connection associated with the writer */
+    UA_PubSubConnection *connection = wg->linkedConnection;
+    if(!connection) {
+        UA_LOG_ERROR_PUBSUB(psm->logging, wg,
+                            "Publish failed. PubSubConnection invalid");
+        UA_WriterGroup_setPubSubState(psm, wg, UA_PUBSUBSTATE_ERROR);
+        unlockServer(server);
+        return;
+    }
+
+    /* How many DSM can be sent in one NM? */
+    UA_Byte maxDSM = (UA_Byte)wg->config.maxEncapsulatedDataSetMessageCount;
+    if(wg->config.maxEncapsulatedDataSetMessageCount > UA_BYTE_MAX)
+        maxDSM = UA_BYTE_MAX;
+    if(maxDSM == 0)
+        maxDSM = 1; /* Send at least one dsm */
+
+    /* Publish by patching the frozen NetworkMessage if the layout is fixed.
+     * Otherwise generate and encode the NetworkMessages. There is at most one
+     * NetworkMessage per DataSetWriter. */
+    size_t pendingSize = 0;
+    UA_STACKARRAY(PendingMessage, pending, wg->writersCount + 1);
+    if(!publishFrozen(psm, wg, connection, maxDSM, pending, &pendingSize))
+        pendingSize = prepareNetworkMessages(psm, wg, connection, maxDSM, pending);
+
+    /* Sign, encrypt and send without the server lock. The publishing flag
+     * prevents that the WriterGroup is freed and that its security context is
+     * modified in the meantime. */
+    UA_ConnectionManager *cm = connection->cm;
+    UA_PubSubSecurityPolicy *sp = wg->config.securityPolicy;
+    UA_LOCK(&wg->publishLock);
+    recordWakeup(wg, wakeup, el->dateTime_nowMonotonic(el));
+    if(pendingSize == 0) {
+        UA_UNLOCK(&wg->publishLock);
+        unlockServer(server);
+        return;
+    }
+    void *channelContext = wg->securityPolicyContext;
+    wg->publishing = true;
+    wg->publishingSecurityContext = channelContext;
+    UA_UNLOCK(&wg->publishLock);
+    uintptr_t sendChannel = pending[0].sendChannel;
+    unlockServer(server);
+
+    UA_Boolean sendFailed = false;
+    UA_DateTime signTime = 0, sendTime = 0;
+    UA_StatusCode res =
+        sendPendingMessages(el, cm, sp, channelContext, pending, pendingSize,
+                            &sendFailed, &signTime, &sendTime);
+
+    /* Record the timing. The WriterGroup is not freed while publishing. */
+    UA_LOCK(&wg->publishLock);
+    if(signTime >= 0)
+        UA_PubSubTimingHistogram_add(&wg->timing.signTime, signTime);
+    UA_PubSubTimingHistogram_add(&wg->timing.sendTime, sendTime);
+    UA_UNLOCK(&wg->publishLock);
+
+    /* Done if the WriterGroup was not removed in the meantime */
+    void *retired = NULL;
+    if(res == UA_STATUSCODE_GOOD) {
+        UA_Boolean deleted = finishPublishing(wg, false, &retired);
+        if(retired)
+            sp->deleteContext(retired);
+        if(!deleted)
+            return;
+    }
+
+    /* Retake the server lock before leaving the publishing state. Otherwise
+     * the WriterGroup could be freed in between. */
+    lockServer(server);
+    UA_Boolean deleted = finishPublishing(wg, true, &retired);
+    if(retired)
+        sp->deleteContext(retired);
+
+    /* Complete the removal that was deferred until the end of the cycle */
+    if(deleted) {
+        UA_WriterGroup_remove(psm, wg);
+        unlockServer(server);
+        return;
+    }
+
+    /* Failure, set the WriterGroup into an error mode. Unless it was disabled
+     * or reconnected in the meantime. */
+    uintptr_t currentChannel = (wg->sendChannel != 0) ?
+        wg->sendChannel : connection->sendChannel;
+    if(wg->head.state == UA_PUBSUBSTATE_OPERATIONAL && sendChannel == currentChannel) {
+        UA_LOG_ERROR_PUBSUB(psm->logging, wg,
+                            "PubSub Publish: Could not send a NetworkMessage "
+                            "with status code %s", UA_StatusCode_name(res));
+        UA_WriterGroup_setPubSubState(psm, wg, UA_PUBSUBSTATE_ERROR);
+        if(sendFailed && !connection->deleteFlag)
+            UA_PubSubConnection_setPubSubState(psm, connection,
+                                               UA_PUBSUBSTATE_ERROR);
+    }
+    unlockServer(server);
+}
+
+/* This callback triggers the collection and publish of NetworkMessages in the
+ * server EventLoop */
+void
+UA_WriterGroup_publishCallback(UA_PubSubManager *psm, UA_WriterGroup *wg) {
+    UA_assert(wg != NULL);
+    UA_assert(psm != NULL);
+
+    /* Take the time before waiting for the server lock */
+    UA_Server *server = psm->sc.server;
+    UA_EventLoop *el = server->config.eventLoop;
+    UA_DateTime wakeup = el->dateTime_nowMonotonic(el);
+    lockServer(server);
+    publishWriterGroup(psm, wg, wakeup);
+}
+
+/* The publish callback in a dedicated EventLoop can race with the removal of
+ * the WriterGroup. Check that the timer is still attached once the server lock
+ * is taken. */
+static void
+publishTimerCallback(UA_PubSubManager *psm, UA_WriterGroupPublishTimer *pt) {
+    UA_Server *server = psm->sc.server;
+    UA_EventLoop *el = server->config.eventLoop;
+    UA_DateTime wakeup = el->dateTime_nowMonotonic(el);
+    lockServer(server);
+    if(!pt->wg) {
+        unlockServer(server);
+        return;
+    }
+    publishWriterGroup(psm, pt->wg, wakeup);
 }
 
 /***********************/
@@ -1452,6 +2009,24 @@ UA_Server_getWriterGroupLastPublishTimestamp(UA_Server *server,
     return UA_STATUSCODE_GOOD;
 }
 
+UA_StatusCode
+UA_Server_getWriterGroupTiming(UA_Server *server, const UA_NodeId wgId,
+                               UA_WriterGroupTiming *timing) {
+    if(!server || !timing)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    lockServer(server);
+    UA_WriterGroup *wg = UA_WriterGroup_find(getPSM(server), wgId);
+    if(!wg) {
+        unlockServer(server);
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+    UA_LOCK(&wg->publishLock);
+    *timing = wg->timing;
+    UA_UNLOCK(&wg->publishLock);
+    unlockServer(server);
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_StatusCode
 UA_Server_setWriterGroupEncryptionKeys(UA_Server *server, const UA_NodeId writerGroup,
                                        UA_UInt32 securityTokenId,
@@ -1548,28 +2123,22 @@ UA_Server_updateWriterGroupConfig(UA_Server *server, const UA_NodeId wgId,
     return res;
 }
 
-UA_StatusCode
-UA_Server_computeWriterGroupOffsetTable(UA_Server *server,
-                                        const UA_NodeId writerGroupId,
-                                        UA_PubSubOffsetTable *ot) {
-    if(!server || !ot)
-        return UA_STATUSCODE_BADINVALIDARGUMENT;
-
-    lockServer(server);
-
-    /* Get the Writer Group */
-    UA_PubSubManager *psm = getPSM(server);
-    UA_WriterGroup *wg = (psm) ? UA_WriterGroup_find(psm, writerGroupId) : NULL;
-    if(!wg) {
-        unlockServer(server);
-        return UA_STATUSCODE_BADNOTFOUND;
-    }
+/* Compute the offset table and the encoded NetworkMessage. If ends is
+ * non-NULL, an array with the end of the content at each offset is returned
+ * in addition. This is used for patching the content in place. */
+static UA_StatusCode
+computeOffsetTable(UA_PubSubManager *psm, UA_WriterGroup *wg,
+                   UA_PubSubOffsetTable *ot, size_t **ends) {
+    UA_LOCK_ASSERT(&psm->sc.server->serviceMutex);
 
     /* Initialize variables so we can goto cleanup below */
     UA_DataSetField *field = NULL;
     UA_NetworkMessage networkMessage;
     memset(&networkMessage, 0, sizeof(networkMessage));
     memset(ot, 0, sizeof(UA_PubSubOffsetTable));
+    size_t *contentEnds = NULL;
+    size_t dsmIndex = 0;
+    size_t fieldIndex = 0;
 
     /* Prepare the metadata encode the DataSetMessages */
     PubSubEncodeCtx ctx;
@@ -1627,25 +2196,52 @@ UA_Server_computeWriterGroupOffsetTable(UA_Server *server,
     if(res != UA_STATUSCODE_GOOD)
         goto cleanup;
 
+    if(ends) {
+        contentEnds = (size_t*)UA_calloc(ot->offsetsSize, sizeof(size_t));
+        if(!contentEnds) {
+            res = UA_STATUSCODE_BADOUTOFMEMORY;
+            goto cleanup;
+        }
+    }
+
     /* Pick up the component NodeIds */
     dsw = NULL;
     for(size_t i = 0; i < ot->offsetsSize; i++) {
         UA_PubSubOffset *o = &ot->offsets[i];
+        size_t contentSize = 0;
+        const UA_DataValue *v = NULL;
         switch(o->offsetType) {
         case UA_PUBSUBOFFSETTYPE_NETWORKMESSAGE_SEQUENCENUMBER:
-        case UA_PUBSUBOFFSETTYPE_NETWORKMESSAGE_TIMESTAMP:
         case UA_PUBSUBOFFSETTYPE_NETWORKMESSAGE_PICOSECONDS:
+            contentSize = 2;
+            res |= UA_NodeId_copy(&wg->head.identifier, &o->component);
+            break;
+        case UA_PUBSUBOFFSETTYPE_NETWORKMESSAGE_TIMESTAMP:
+            contentSize = 8;
+            res |= UA_NodeId_copy(&wg->head.identifier, &o->component);
+            break;
         case UA_PUBSUBOFFSETTYPE_NETWORKMESSAGE_GROUPVERSION:
+            contentSize = 4;
             res |= UA_NodeId_copy(&wg->head.identifier, &o->component);
             break;
         case UA_PUBSUBOFFSETTYPE_DATASETMESSAGE:
+            if(dsw)
+                dsmIndex++;
             dsw = (dsw == NULL) ? LIST_FIRST(&wg->writers) : LIST_NEXT(dsw, listEntry);
             field = NULL;
-            /* fall through */
+            fieldIndex = 0;
+            UA_assert(dsw);
+            res |= UA_NodeId_copy(&dsw->head.identifier, &o->component);
+            break;
         case UA_PUBSUBOFFSETTYPE_DATASETMESSAGE_SEQUENCENUMBER:
         case UA_PUBSUBOFFSETTYPE_DATASETMESSAGE_STATUS:
-        case UA_PUBSUBOFFSETTYPE_DATASETMESSAGE_TIMESTAMP:
         case UA_PUBSUBOFFSETTYPE_DATASETMESSAGE_PICOSECONDS:
+            contentSize = 2;
+            UA_assert(dsw);
+            res |= UA_NodeId_copy(&dsw->head.identifier, &o->component);
+            break;
+        case UA_PUBSUBOFFSETTYPE_DATASETMESSAGE_TIMESTAMP:
+            contentSize = 8;
             UA_assert(dsw);
             res |= UA_NodeId_copy(&dsw->head.identifier, &o->component);
             break;
@@ -1654,35 +2250,72 @@ UA_Server_computeWriterGroupOffsetTable(UA_Server *server,
             field = (field == NULL) ?
                 TAILQ_FIRST(&dsw->connectedDataSet->fields) : TAILQ_NEXT(field, listEntry);
             res |= UA_NodeId_copy(&field->identifier, &o->component);
+            v = &dsmStore[dsmIndex].data.keyFrameFields[fieldIndex++];
+            contentSize = UA_calcSizeBinary(v, &UA_TYPES[UA_TYPES_DATAVALUE], NULL);
             break;
         case UA_PUBSUBOFFSETTYPE_DATASETFIELD_VARIANT:
             UA_assert(dsw && dsw->connectedDataSet);
             field = (field == NULL) ?
                 TAILQ_FIRST(&dsw->connectedDataSet->fields) : TAILQ_NEXT(field, listEntry);
             res |= UA_NodeId_copy(&field->identifier, &o->component);
+            v = &dsmStore[dsmIndex].data.keyFrameFields[fieldIndex++];
+            contentSize = UA_calcSizeBinary(&v->value, &UA_TYPES[UA_TYPES_VARIANT], NULL);
             break;
         case UA_PUBSUBOFFSETTYPE_DATASETFIELD_RAW:
             UA_assert(dsw && dsw->connectedDataSet);
             field = (field == NULL) ?
                 TAILQ_FIRST(&dsw->connectedDataSet->fields) : TAILQ_NEXT(field, listEntry);
             res |= UA_NodeId_copy(&field->identifier, &o->component);
+            /* The offset is behind the ArrayDimensions. The values have a
+             * fixed size (checked in calcSizeBinary). */
+            v = &dsmStore[dsmIndex].data.keyFrameFields[fieldIndex++];
+            contentSize = UA_calcSizeBinary(v->value.data, v->value.type, NULL);
+            if(!UA_Variant_isScalar(&v->value))
+                contentSize *= v->value.arrayLength;
             break;
         default:
             break;
         }
+        if(contentEnds)
+            contentEnds[i] = o->offset + contentSize;
     }
 
     /* Clean up */
  cleanup:
-    if(res != UA_STATUSCODE_GOOD)
+    if(res != UA_STATUSCODE_GOOD) {
         UA_PubSubOffsetTable_clear(ot);
+        UA_free(contentEnds);
+        contentEnds = NULL;
+    }
+    if(ends)
+        *ends = contentEnds;
 
     for(size_t i = 0; i < dsmCount; i++) {
         UA_DataSetMessage_clear(&dsmStore[i]);
     }
 
-    unlockServer(server);
+    return res;
+}
+
+UA_StatusCode
+UA_Server_computeWriterGroupOffsetTable(UA_Server *server,
+                                        const UA_NodeId writerGroupId,
+                                        UA_PubSubOffsetTable *ot) {
+    if(!server || !ot)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+
+    lockServer(server);
 
+    /* Get the Writer Group */
+    UA_PubSubManager *psm = getPSM(server);
+    UA_WriterGroup *wg = (psm) ? UA_WriterGroup_find(psm, writerGroupId) : NULL;
+    if(!wg) {
+        unlockServer(server);
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+
+    UA_StatusCode res = computeOffsetTable(psm, wg, ot, NULL);
+    unlockServer(server);
     return res;
 }
 
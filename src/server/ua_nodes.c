@@ -515,6 +515,26 @@ UA_DataTypeNode_copy(const UA_DataTypeNode *src, UA_DataTypeNode *dst) {
     return UA_STATUSCODE_GOOD;
 }
 
+/* Keep the order of the localized texts. The first entry is the default for
+ * sessions without a matching locale. */
+static UA_StatusCode
+copyLocalizedTextList(const UA_LocalizedTextListEntry *src,
+                      UA_LocalizedTextListEntry **dst) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    for(; src != NULL; src = src->next) {
+        UA_LocalizedTextListEntry *newEntry = (UA_LocalizedTextListEntry *)
+            UA_calloc(1, sizeof(UA_LocalizedTextListEntry));
+        if(!newEntry)
+            return retval | UA_STATUSCODE_BADOUTOFMEMORY;
+        retval |= UA_LocalizedText_copy(&src->localizedText, &newEntry->localizedText);
+
+        /* Append to the end of the list */
+        *dst = newEntry;
+        dst = &newEntry->next;
+    }
+    return retval;
+}
+
 static UA_StatusCode
 UA_ViewNode_copy(const UA_ViewNode *src, UA_ViewNode *dst) {
     dst->containsNoLoops = src->containsNoLoops;
@@ -542,35 +562,9 @@ UA_Node_copy(const UA_Node *src, UA_Node *dst) {
     UA_StatusCode retval = UA_NodeId_copy(&srchead->nodeId, &dsthead->nodeId);
     retval |= UA_QualifiedName_copy(&srchead->browseName, &dsthead->browseName);
 
-    /* Copy the display name in several languages */
-    for(UA_LocalizedTextListEntry *lt = srchead->displayName; lt != NULL; lt = lt->next) {
-        UA_LocalizedTextListEntry *newEntry = (UA_LocalizedTextListEntry *)
-            UA_calloc(1, sizeof(UA_LocalizedTextListEntry));
-        if(!newEntry) {
-            retval |= UA_STATUSCODE_BADOUTOFMEMORY;
-            break;
-        }
-        retval |= UA_LocalizedText_copy(&lt->localizedText, &newEntry->localizedText);
-
-        /* Add to the linked list possibly in reverse order */
-        newEntry->next = dsthead->displayName;
-        dsthead->displayName = newEntry;
-    }
-
-    /* Copy the description in several languages */
-    for(UA_LocalizedTextListEntry *lt = srchead->description; lt != NULL; lt = lt->next) {
-        UA_LocalizedTextListEntry *newEntry = (UA_LocalizedTextListEntry *)
-            UA_calloc(1, sizeof(UA_LocalizedTextListEntry));
-        if(!newEntry) {
-            retval |= UA_STATUSCODE_BADOUTOFMEMORY;
-            break;
-        }
-        retval |= UA_LocalizedText_copy(&lt->localizedText, &newEntry->localizedText);
-
-        /* Add to the linked list possibly in reverse order */
-        newEntry->next = dsthead->description;
-        dsthead->description= newEntry;
-    }
+    /* Copy the display name and description in several languages */
+    retval |= copyLocalizedTextList(srchead->displayName, &dsthead->displayName);
+    retval |= copyLocalizedTextList(srchead->description, &dsthead->description);
 
     dsthead->writeMask = srchead->writeMask;
     dsthead->context = srchead->context;
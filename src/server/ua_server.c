@@ -436,6 +436,7 @@ UA_Server_delete(UA_Server *server) {
     LIST_FOREACH_SAFE(current, &server->sessions, pointers, temp) {
         UA_Session_remove(server, &current->session, UA_SHUTDOWNREASON_CLOSE);
     }
+    clearSessionIndex(server);
     UA_Array_delete(server->namespaces, server->namespacesSize, &UA_TYPES[UA_TYPES_STRING]);
 
 #ifdef UA_ENABLE_SUBSCRIPTIONS
@@ -461,6 +462,10 @@ UA_Server_delete(UA_Server *server) {
     server->adminSubscription = NULL;
     UA_assert(server->monitoredItemsSize == 0);
     UA_assert(server->subscriptionsSize == 0);
+    UA_assert(LIST_EMPTY(&server->samplingGroups));
+# ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    UA_assert(LIST_EMPTY(&server->eventFilterPrograms));
+# endif
 #endif
 
     /* Remove all server components (all stopped by now) */
@@ -478,6 +483,9 @@ UA_Server_delete(UA_Server *server) {
     UA_ServerConfig_clear(&server->config);
 
 #if UA_MULTITHREADING >= 100
+    if(server->serviceWorkers)
+        UA_ServiceWorkers_delete(server->serviceWorkers);
+    UA_LOCK_DESTROY(&server->sharedMutex);
     UA_LOCK_DESTROY(&server->serviceMutex);
 #endif
 
@@ -524,9 +532,24 @@ UA_Server_init(UA_Server *server) {
     UA_random_seed((UA_UInt64)UA_DateTime_now());
 #endif
 
-    UA_LOCK_INIT(&server->serviceMutex);
+#if UA_MULTITHREADING >= 100
+    /* The service mutex can be held in a shared mode by the service workers */
+    if(server->config.serviceWorkers > 0)
+        UA_LOCK_INIT_SHAREABLE(&server->serviceMutex);
+    else
+        UA_LOCK_INIT(&server->serviceMutex);
+    UA_LOCK_INIT(&server->sharedMutex);
+#endif
     lockServer(server);
 
+#if UA_MULTITHREADING >= 100
+    /* Initialize the service workers */
+    if(server->config.serviceWorkers > 0) {
+        server->serviceWorkers = UA_ServiceWorkers_new(server->config.serviceWorkers);
+        UA_CHECK_MEM(server->serviceWorkers, goto cleanup);
+    }
+#endif
+
     /* Initialize the adminSession */
     UA_Session_init(&server->adminSession);
     server->adminSession.sessionId.identifierType = UA_NODEIDTYPE_GUID;
@@ -552,8 +575,17 @@ UA_Server_init(UA_Server *server) {
 
     /* Initialize Session Management */
     LIST_INIT(&server->sessions);
+    ZIP_INIT(&server->sessionTimeouts);
     server->sessionCount = 0;
 
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+    /* Initialize the SamplingGroups for cyclic MonitoredItems */
+    LIST_INIT(&server->samplingGroups);
+# ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    LIST_INIT(&server->eventFilterPrograms);
+# endif
+#endif
+
     /* Initialize SecureChannel */
     TAILQ_INIT(&server->channels);
     /* TODO: use an ID that is likely to be unique after a restart */
@@ -1121,6 +1153,7 @@ UA_Server_getStatistics(UA_Server *server) {
     stat.ss.rejectedSessionCount = sds->rejectedSessionCount;
     stat.ss.sessionTimeoutCount = sds->sessionTimeoutCount;
     stat.ss.sessionAbortCount = sds->sessionAbortCount;
+    stat.ras = server->requestArenaStatistics;
     unlockServer(server);
     return stat;
 }
@@ -1232,6 +1265,10 @@ UA_Server_run_startup(UA_Server *server) {
 #if UA_MULTITHREADING >= 100
     /* Add regulare callback for async operation processing */
     UA_AsyncManager_start(&server->asyncManager, server);
+
+    /* Allow the service workers to run */
+    if(server->serviceWorkers)
+        UA_ServiceWorkers_start(server->serviceWorkers);
 #endif
 
     /* Are there enough SecureChannels possible for the max number of sessions? */
@@ -1366,6 +1403,10 @@ UA_Server_run_shutdown(UA_Server *server) {
 #if UA_MULTITHREADING >= 100
     /* Stop regular callback for async operation processing */
     UA_AsyncManager_stop(&server->asyncManager, server);
+
+    /* The service workers return. Requests are processed in the main loop. */
+    if(server->serviceWorkers)
+        UA_ServiceWorkers_stop(server->serviceWorkers);
 #endif
 
     /* Stop the regular housekeeping tasks */
@@ -1434,6 +1475,7 @@ UA_Server_run(UA_Server *server, const volatile UA_Boolean *running) {
 }
 
 void lockServer(UA_Server *server) {
+    UA_assert(!UA_LOCK_ISSHARED(&server->serviceMutex));
     if(UA_LIKELY(server->config.eventLoop && server->config.eventLoop->lock))
         server->config.eventLoop->lock(server->config.eventLoop);
     UA_LOCK(&server->serviceMutex);
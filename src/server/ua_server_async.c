@@ -8,6 +8,9 @@
 
 #include "ua_server_internal.h"
 
+UA_THREAD_LOCAL UA_UInt32 currentRequestId;
+UA_THREAD_LOCAL UA_UInt32 currentRequestHandle;
+
 /* Cancel the operation, but don't _clear it here */
 static void
 UA_AsyncOperation_cancel(UA_Server *server, UA_AsyncOperation *op,
@@ -387,8 +390,8 @@ persistAsyncResponse(UA_Server *server, UA_Session *session,
 
     /* Pending results, attach the AsyncResponse to the AsyncManager. RequestId
      * and -Handle are set in the AsyncManager before processing the request. */
-    ar->requestId = am->currentRequestId;
-    ar->requestHandle = am->currentRequestHandle;
+    ar->requestId = currentRequestId;
+    ar->requestHandle = currentRequestHandle;
     ar->sessionId = session->sessionId;
     ar->timeout = UA_INT64_MAX;
 
@@ -519,7 +522,7 @@ UA_Boolean
 Service_Read(UA_Server *server, UA_Session *session, const UA_ReadRequest *request,
              UA_ReadResponse *response) {
     UA_LOG_DEBUG_SESSION(server->config.logging, session, "Processing ReadRequest");
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_LOCK_ASSERT_SHARED_OR_EXCLUSIVE(&server->serviceMutex);
 
     /* Check if the timestampstoreturn is valid */
     if(request->timestampsToReturn > UA_TIMESTAMPSTORETURN_NEITHER) {
@@ -559,7 +562,9 @@ Service_Read(UA_Server *server, UA_Session *session, const UA_ReadRequest *reque
     }
     response->resultsSize = request->nodesToReadSize;
 
-    /* Execute the operations */
+    /* Execute the operations. Async operations only come from callback value
+     * sources. Those are never read by the service workers with the shared
+     * server lock. */
     UA_AsyncResponse *ar = (UA_AsyncResponse*)&response->results[response->resultsSize];
     UA_AsyncOperation *aopArray = (UA_AsyncOperation*)&ar[1];
     for(size_t i = 0; i < request->nodesToReadSize; i++) {
@@ -94,12 +94,13 @@ struct UA_AsyncResponse {
     } response;
 };
 
-typedef struct {
-    /* Forward the request id here as the "UA_Service" method signature does not
-     * contain it */
-    UA_UInt32 currentRequestId;
-    UA_UInt32 currentRequestHandle;
+/* Forward the request id here as the "UA_Service" method signature does not
+ * contain it. Thread-local as the service workers process requests in
+ * parallel. */
+extern UA_THREAD_LOCAL UA_UInt32 currentRequestId;
+extern UA_THREAD_LOCAL UA_UInt32 currentRequestHandle;
 
+typedef struct {
     /* Async responses */
     TAILQ_HEAD(, UA_AsyncResponse) waitingResponses;
     TAILQ_HEAD(, UA_AsyncResponse) readyResponses;
@@ -119,6 +119,12 @@ deleteServerSecureChannel(UA_BinaryProtocolManager *bpm,
     while(channel->sessions)
         UA_Session_detachFromSecureChannel(server, channel->sessions);
 
+#if UA_MULTITHREADING >= 100
+    /* Drop the requests that wait for a service worker */
+    if(server->serviceWorkers)
+        UA_ServiceWorkers_removeChannel(server->serviceWorkers, channel);
+#endif
+
     /* Detach the channel from the server list */
     TAILQ_REMOVE(&server->channels, channel, serverEntry);
     TAILQ_REMOVE(&bpm->channels, channel, componentEntry);
@@ -398,7 +404,7 @@ sendResponse(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 requestId,
 UA_StatusCode
 getBoundSession(UA_Server *server, const UA_SecureChannel *channel,
                 const UA_NodeId *token, UA_Session **session) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_LOCK_ASSERT_SHARED_OR_EXCLUSIVE(&server->serviceMutex);
     UA_EventLoop *el = server->config.eventLoop;
     UA_DateTime nowMonotonic = el->dateTime_nowMonotonic(el);
 
@@ -429,6 +435,20 @@ getBoundSession(UA_Server *server, const UA_SecureChannel *channel,
     return UA_STATUSCODE_BADSESSIONIDINVALID;
 }
 
+/* Reset the arena after the decoded request is no longer used */
+static void
+resetRequestArena(UA_Server *server, UA_SecureChannel *channel) {
+    UA_Arena *arena = &channel->requestArena;
+    UA_RequestArenaStatistics *ras = &server->requestArenaStatistics;
+    ras->requestCount++;
+    ras->allocCount += arena->allocCount;
+    ras->allocBytes += arena->used;
+    ras->blockAllocCount += arena->blockCount;
+    if(arena->used > ras->maxRequestBytes)
+        ras->maxRequestBytes = arena->used;
+    UA_Arena_reset(arena);
+}
+
 static UA_StatusCode
 processMSG(UA_Server *server, UA_SecureChannel *channel,
            UA_UInt32 requestId, const UA_ByteString *msg) {
@@ -470,8 +490,29 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
     UA_DecodeBinaryOptions opt;
     memset(&opt, 0, sizeof(UA_DecodeBinaryOptions));
     opt.customTypes = server->config.customDataTypes;
+
+    /* Decode into the arena of the SecureChannel. The fuzzing build replaces
+     * the AuthenticationToken of decoded requests. This requires the request
+     * to be allocated on the heap. */
+    UA_Boolean useArena = (server->config.requestArenaSize > 0);
+#ifdef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
+    useArena = false;
+#endif
+
+    /* Requests handed over to a service worker outlive the arena */
+#if UA_MULTITHREADING >= 100
+    if(server->serviceWorkers)
+        useArena = false;
+#endif
+    if(useArena) {
+        opt.callocContext = &channel->requestArena;
+        opt.calloc = UA_Arena_calloc;
+    }
+
     retval = UA_decodeBinaryInternal(msg, &offset, &request, sd->requestType, &opt);
     if(retval != UA_STATUSCODE_GOOD) {
+        if(useArena)
+            resetRequestArena(server, channel);
         UA_LOG_DEBUG_CHANNEL(server->config.logging, channel,
                              "Could not decode the request with StatusCode %s",
                              UA_StatusCode_name(retval));
@@ -479,6 +520,13 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
                                             sd->responseType, requestId, retval);
     }
 
+#if UA_MULTITHREADING >= 100
+    /* Process in the service worker of the SecureChannel */
+    if(server->serviceWorkers &&
+       UA_ServiceWorkers_dispatch(server, channel, requestId, sd, &request))
+        return UA_STATUSCODE_GOOD;
+#endif
+
     /* Initialize the response */
     UA_Response response;
     UA_init(&response, sd->responseType);
@@ -495,8 +543,11 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
 
     unlockServer(server);
 
-    /* Clean up */
-    UA_clear(&request, sd->requestType);
+    /* Clean up. Services must not keep pointers into the request. */
+    if(useArena)
+        resetRequestArena(server, channel);
+    else
+        UA_clear(&request, sd->requestType);
     UA_clear(&response, sd->responseType);
     return retval;
 }
@@ -665,6 +716,8 @@ createServerSecureChannel(UA_BinaryProtocolManager *bpm, UA_ConnectionManager *c
     channel->processOPNHeaderApplication = server;
     channel->connectionManager = cm;
     channel->connectionId = connectionId;
+    UA_Arena_init(&channel->requestArena, config->requestArenaSize,
+                  config->requestArenaSize * 16);
 
     /* The remote addresss is given in the very first callback from the
      * ConnectionManager. */
@@ -187,9 +187,27 @@ getServerComponentByName(UA_Server *server, UA_String name);
 typedef struct session_list_entry {
     UA_DelayedCallback cleanupCallback;
     LIST_ENTRY(session_list_entry) pointers;
+
+    /* Hash chains in the AuthenticationToken and SessionId indexes */
+    struct session_list_entry *tokenNext;
+    struct session_list_entry *idNext;
+
+    /* Entry in the timeout tree. The timeout key is not updated for every
+     * request. It is a lower bound for session.validTill and gets refreshed
+     * when the housekeeping finds the stale key expired. */
+    ZIP_ENTRY(session_list_entry) timeoutEntry;
+    UA_DateTime timeoutKey;
+
     UA_Session session;
 } session_list_entry;
 
+typedef ZIP_HEAD(UA_SessionTimeoutTree, session_list_entry) UA_SessionTimeoutTree;
+
+#if UA_MULTITHREADING >= 100
+struct UA_ServiceWorkers;
+typedef struct UA_ServiceWorkers UA_ServiceWorkers;
+#endif
+
 struct UA_Server {
     /* Config */
     UA_ServerConfig config;
@@ -212,6 +230,16 @@ struct UA_Server {
     UA_UInt32 sessionCount;
     UA_UInt32 activeSessionCount;
 
+    /* Hash indexes for the lookup by AuthenticationToken and SessionId. Both
+     * tables have the same power-of-two size and grow with the number of
+     * sessions. */
+    session_list_entry **sessionsByToken;
+    session_list_entry **sessionsById;
+    size_t sessionsIndexSize;
+
+    /* Sessions ordered by their timeout key for the housekeeping */
+    UA_SessionTimeoutTree sessionTimeouts;
+
     /* Session for local access to the services for upkeep and the C API. Comes
      * equipped with all possible access rights (Session Id: 1). */
     UA_Session adminSession;
@@ -243,6 +271,17 @@ struct UA_Server {
                                                  * from a session. */
     UA_UInt32 lastSubscriptionId; /* To generate unique SubscriptionIds */
 
+    /* MonitoredItems with a cyclic sampling interval are sampled in groups with
+     * a shared repeated callback. See ua_subscription.h. */
+    LIST_HEAD(, UA_SamplingGroup) samplingGroups;
+
+# ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    /* EventFilters are compiled once and shared between the MonitoredItems
+     * with an identical filter. See ua_subscription.h. */
+    LIST_HEAD(, UA_EventFilterProgram) eventFilterPrograms;
+    UA_UInt64 eventEpoch; /* Incremented for every emitted event */
+# endif
+
 # ifdef UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
     LIST_HEAD(, UA_ConditionSource) conditionSources;
     UA_NodeId refreshEvents[2];
@@ -250,11 +289,16 @@ struct UA_Server {
 #endif
 
 #if UA_MULTITHREADING >= 100
-    UA_Lock serviceMutex;
+    UA_Lock serviceMutex; /* Shareable if service workers are configured */
+    UA_Lock sharedMutex;  /* Serializes the SecurityPolicies between the
+                           * service workers that hold the service mutex in
+                           * the shared mode */
+    UA_ServiceWorkers *serviceWorkers; /* NULL if not configured */
 #endif
 
     /* Statistics */
     UA_SecureChannelStatistics secureChannelStatistics;
+    UA_RequestArenaStatistics requestArenaStatistics;
     UA_ServerDiagnosticsSummaryDataType serverDiagnosticsSummary;
 
     /* GDS Manager for certificate management */
@@ -333,6 +377,10 @@ UA_Session_remove(UA_Server *server, UA_Session *session,
 void
 cleanupSessions(UA_Server *server, UA_DateTime nowMonotonic);
 
+/* Free the session index after all sessions are removed */
+void
+clearSessionIndex(UA_Server *server);
+
 UA_Session *
 getSessionByToken(UA_Server *server, const UA_NodeId *token);
 
@@ -354,6 +402,13 @@ editNode(UA_Server *server, UA_Session *session, const UA_NodeId *nodeId,
          UA_BrowseDirection referenceDirections,
          UA_EditNodeCallback callback, void *data);
 
+/* Returns true if an element of the numerical value differs from the old
+ * value by more than the absolute deadband. Values with a different type or
+ * length always exceed the deadband. */
+UA_Boolean
+detectVariantDeadband(const UA_Variant *value, const UA_Variant *oldValue,
+                      const UA_Double deadbandValue);
+
 /* Search for a child with a given browseNamee. Returns the first match. Does
  * not touch outChildNodeId if no child is found. */
 UA_StatusCode
@@ -466,11 +521,48 @@ allocProcessServiceOperations(UA_Server *server, UA_Session *session,
 /*********************/
 
 /* In order to prevent deadlocks between the EventLoop mutex and the
- * server-mutex, we always take the EventLoop mutex first. */
+ * server-mutex, we always take the EventLoop mutex first.
+ *
+ * Service workers that hold the server-mutex in the shared mode must not take
+ * any lock of the EventLoop. The EventLoop thread could be waiting for the
+ * exclusive server-mutex. So the shared services don't call lockServer and
+ * don't execute application callbacks that could call the public API. */
 
 void lockServer(UA_Server *server);
 void unlockServer(UA_Server *server);
 
+/*******************/
+/* Service Workers */
+/*******************/
+
+#if UA_MULTITHREADING >= 100
+
+UA_ServiceWorkers *
+UA_ServiceWorkers_new(size_t workersSize);
+
+void
+UA_ServiceWorkers_delete(UA_ServiceWorkers *sw);
+
+void
+UA_ServiceWorkers_start(UA_ServiceWorkers *sw);
+
+/* Running workers return */
+void
+UA_ServiceWorkers_stop(UA_ServiceWorkers *sw);
+
+/* Returns false if the worker of the SecureChannel is not running. Otherwise
+ * the (heap-allocated) request is moved into the queue of the worker. */
+UA_Boolean
+UA_ServiceWorkers_dispatch(UA_Server *server, UA_SecureChannel *channel,
+                           UA_UInt32 requestId, UA_ServiceDescription *sd,
+                           UA_Request *request);
+
+/* Remove the queued requests of a SecureChannel before it is deleted */
+void
+UA_ServiceWorkers_removeChannel(UA_ServiceWorkers *sw, UA_SecureChannel *channel);
+
+#endif
+
 /******************************************/
 /* Internal function calls, without locks */
 /******************************************/
@@ -516,6 +608,14 @@ writeAttribute(UA_Server *server, UA_Session *session,
                const UA_NodeId *nodeId, const UA_AttributeId attributeId,
                const void *attr, const UA_DataType *attr_type);
 
+/* Write the value attribute of a VariableNode with an internal or external
+ * value source. Unlike the Write service, the type of the value and the access
+ * rights are not checked. The caller has to ensure that the value matches the
+ * DataType, ValueRank and ArrayDimensions of the node. */
+UA_StatusCode
+writeValueAttributeUnchecked(UA_Server *server, UA_Session *session,
+                             UA_VariableNode *node, const UA_DataValue *value);
+
 #define UA_WRITEATTRIBUTEFUNCS(ATTR, ATTRID, TYPE, TYPENAME)            \
     static UA_INLINE UA_StatusCode                                      \
     write##ATTR##Attribute(UA_Server *server, const UA_NodeId nodeId,   \
@@ -548,6 +648,21 @@ readWithSession(UA_Server *server, UA_Session *session,
                 const UA_ReadValueId *item,
                 UA_TimestampsToReturn timestampsToReturn);
 
+/* Get the node for a ReadValueId. Only the attribute to be read is guaranteed
+ * to be present if the Nodestore supports selective loading. Release with
+ * UA_NODESTORE_RELEASE. */
+const UA_Node *
+getNodeForRead(UA_Server *server, const UA_ReadValueId *rvi);
+
+/* Read from a node that was already resolved with getNodeForRead. Returns false
+ * without reading if the value comes from a callback value source. These can
+ * complete asynchronously and have to go through Operation_Read (with a stable
+ * DataValue pointer) instead. */
+UA_Boolean
+readWithNodeSync(UA_Server *server, UA_Session *session, const UA_Node *node,
+                 UA_TimestampsToReturn ttr, const UA_ReadValueId *rvi,
+                 UA_DataValue *dv);
+
 UA_StatusCode
 readWithReadValue(UA_Server *server, const UA_NodeId *nodeId,
                   const UA_AttributeId attributeId, void *v);
@@ -815,6 +930,13 @@ readSubscriptionDiagnosticsArray(UA_Server *server,
                                  UA_Boolean sourceTimestamp,
                                  const UA_NumericRange *range, UA_DataValue *value);
 
+UA_StatusCode
+readSamplingIntervalDiagnosticsArray(UA_Server *server,
+                                     const UA_NodeId *sessionId, void *sessionContext,
+                                     const UA_NodeId *nodeId, void *nodeContext,
+                                     UA_Boolean sourceTimestamp,
+                                     const UA_NumericRange *range, UA_DataValue *value);
+
 UA_StatusCode
 readSessionDiagnosticsArray(UA_Server *server,
                             const UA_NodeId *sessionId, void *sessionContext,
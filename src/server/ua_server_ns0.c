@@ -1186,6 +1186,13 @@ initNS0(UA_Server *server) {
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     UA_CallbackValueSource serverSubDiagSummary = {readSubscriptionDiagnosticsArray, NULL};
     retVal |= setVariableNode_callbackValueSource(server, UA_NS0ID(SERVER_SERVERDIAGNOSTICS_SUBSCRIPTIONDIAGNOSTICSARRAY), serverSubDiagSummary);
+
+    /* ServerDiagnostics - SamplingIntervalDiagnosticsArray */
+    UA_CallbackValueSource samplingDiag = {readSamplingIntervalDiagnosticsArray, NULL};
+    retVal |= setVariableNode_callbackValueSource(server, UA_NS0ID(SERVER_SERVERDIAGNOSTICS_SAMPLINGINTERVALDIAGNOSTICSARRAY), samplingDiag);
+#else
+    /* The sampling diagnostics array is optional */
+    deleteNode(server, UA_NS0ID(SERVER_SERVERDIAGNOSTICS_SAMPLINGINTERVALDIAGNOSTICSARRAY), true);
 #endif
 
     /* ServerDiagnostics - SessionDiagnosticsSummary - SessionDiagnosticsArray */
@@ -1204,11 +1211,8 @@ initNS0(UA_Server *server) {
     deleteNode(server, UA_NS0ID(SERVER_SERVERDIAGNOSTICS_SESSIONSDIAGNOSTICSSUMMARY), true);
     deleteNode(server, UA_NS0ID(SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY), true);
     deleteNode(server, UA_NS0ID(SERVER_SERVERDIAGNOSTICS_SUBSCRIPTIONDIAGNOSTICSARRAY), true);
-#endif
-
-    /* The sampling diagnostics array is optional
-     * TODO: Add support for this diagnostics */
     deleteNode(server, UA_NS0ID(SERVER_SERVERDIAGNOSTICS_SAMPLINGINTERVALDIAGNOSTICSARRAY), true);
+#endif
 
 #ifndef UA_ENABLE_PUBSUB
     deleteNode(server, UA_NS0ID(PUBLISHSUBSCRIBE), true);
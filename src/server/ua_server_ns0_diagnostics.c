@@ -161,6 +161,65 @@ readSubscriptionDiagnosticsArray(UA_Server *server,
     return UA_STATUSCODE_GOOD;
 }
 
+/* Return the SamplingGroups of the cyclic MonitoredItems */
+UA_StatusCode
+readSamplingIntervalDiagnosticsArray(UA_Server *server,
+                                     const UA_NodeId *sessionId, void *sessionContext,
+                                     const UA_NodeId *nodeId, void *nodeContext,
+                                     UA_Boolean sourceTimestamp,
+                                     const UA_NumericRange *range, UA_DataValue *value) {
+    lockServer(server);
+
+    /* Count the SamplingGroups */
+    size_t sdSize = 0;
+    UA_SamplingGroup *sg;
+    LIST_FOREACH(sg, &server->samplingGroups, listEntry) {
+        sdSize++;
+    }
+
+    /* Allocate the output array */
+    UA_SamplingIntervalDiagnosticsDataType *sd = (UA_SamplingIntervalDiagnosticsDataType*)
+        UA_Array_new(sdSize, &UA_TYPES[UA_TYPES_SAMPLINGINTERVALDIAGNOSTICSDATATYPE]);
+    if(!sd) {
+        unlockServer(server);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    /* Collect the statistics */
+    size_t i = 0;
+    LIST_FOREACH(sg, &server->samplingGroups, listEntry) {
+        sd[i].samplingInterval = sg->samplingInterval;
+        sd[i].monitoredItemCount = sg->monitoredItemsSize;
+        sd[i].maxMonitoredItemCount = sg->maxMonitoredItemsSize;
+        i++;
+    }
+
+    /* Disabled MonitoredItems are not registered in a SamplingGroup. Count them
+     * for the group with the matching sampling interval. */
+    UA_Subscription *sub;
+    UA_MonitoredItem *mon;
+    LIST_FOREACH(sub, &server->subscriptions, serverListEntry) {
+        LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
+            if(mon->monitoringMode != UA_MONITORINGMODE_DISABLED)
+                continue;
+            for(i = 0; i < sdSize; i++) {
+                if(sd[i].samplingInterval == mon->parameters.samplingInterval) {
+                    sd[i].disabledMonitoredItemCount++;
+                    break;
+                }
+            }
+        }
+    }
+
+    /* Set the output */
+    value->hasValue = true;
+    UA_Variant_setArray(&value->value, sd, sdSize,
+                        &UA_TYPES[UA_TYPES_SAMPLINGINTERVALDIAGNOSTICSDATATYPE]);
+
+    unlockServer(server);
+    return UA_STATUSCODE_GOOD;
+}
+
 void
 createSubscriptionObject(UA_Server *server, UA_Session *session,
                          UA_Subscription *sub) {
@@ -221,6 +221,69 @@ editNode(UA_Server *server, UA_Session *session, const UA_NodeId *nodeId,
     return retval;
 }
 
+/************/
+/* Deadband */
+/************/
+
+/* Detect value changes outside the deadband */
+#define UA_DETECT_DEADBAND(TYPE) do {                           \
+    TYPE v1 = *(const TYPE*)data1;                              \
+    TYPE v2 = *(const TYPE*)data2;                              \
+    TYPE diff = (v1 > v2) ? (TYPE)(v1 - v2) : (TYPE)(v2 - v1);  \
+    return ((UA_Double)diff > deadband);                        \
+} while(false)
+
+static UA_Boolean
+detectScalarDeadBand(const void *data1, const void *data2,
+                     const UA_DataType *type, const UA_Double deadband) {
+    if(type->typeKind == UA_DATATYPEKIND_SBYTE) {
+        UA_DETECT_DEADBAND(UA_SByte);
+    } else if(type->typeKind == UA_DATATYPEKIND_BYTE) {
+        UA_DETECT_DEADBAND(UA_Byte);
+    } else if(type->typeKind == UA_DATATYPEKIND_INT16) {
+        UA_DETECT_DEADBAND(UA_Int16);
+    } else if(type->typeKind == UA_DATATYPEKIND_UINT16) {
+        UA_DETECT_DEADBAND(UA_UInt16);
+    } else if(type->typeKind == UA_DATATYPEKIND_INT32) {
+        UA_DETECT_DEADBAND(UA_Int32);
+    } else if(type->typeKind == UA_DATATYPEKIND_UINT32) {
+        UA_DETECT_DEADBAND(UA_UInt32);
+    } else if(type->typeKind == UA_DATATYPEKIND_INT64) {
+        UA_DETECT_DEADBAND(UA_Int64);
+    } else if(type->typeKind == UA_DATATYPEKIND_UINT64) {
+        UA_DETECT_DEADBAND(UA_UInt64);
+    } else if(type->typeKind == UA_DATATYPEKIND_FLOAT) {
+        UA_DETECT_DEADBAND(UA_Float);
+    } else if(type->typeKind == UA_DATATYPEKIND_DOUBLE) {
+        UA_DETECT_DEADBAND(UA_Double);
+    } else {
+        return false; /* Not a known numerical type */
+    }
+}
+
+UA_Boolean
+detectVariantDeadband(const UA_Variant *value, const UA_Variant *oldValue,
+                      const UA_Double deadbandValue) {
+    if(value->arrayLength != oldValue->arrayLength)
+        return true;
+    if(value->type != oldValue->type)
+        return true;
+    size_t length = 1;
+    if(!UA_Variant_isScalar(value))
+        length = value->arrayLength;
+    uintptr_t data = (uintptr_t)value->data;
+    uintptr_t oldData = (uintptr_t)oldValue->data;
+    UA_UInt32 memSize = value->type->memSize;
+    for(size_t i = 0; i < length; ++i) {
+        if(detectScalarDeadBand((const void*)data, (const void*)oldData,
+                                value->type, deadbandValue))
+            return true;
+        data += memSize;
+        oldData += memSize;
+    }
+    return false;
+}
+
 /*********************************/
 /* Default attribute definitions */
 /*********************************/
@@ -0,0 +1,354 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "ua_server_internal.h"
+
+#if UA_MULTITHREADING >= 100
+
+/* The service workers process the requests of the SecureChannels assigned to
+ * them. The receiving, decryption and decoding of the requests remains in the
+ * EventLoop thread. The decoded requests are appended to the job queue of the
+ * worker with the index channelId % workersSize. So the requests of a
+ * SecureChannel are processed in order.
+ *
+ * The worker takes the service lock in the shared mode for the read-only
+ * services. Otherwise exclusively. The queues and the condition variables are
+ * protected by the mutex of the UA_ServiceWorkers. When a SecureChannel is
+ * deleted (with the exclusive service lock), its queued jobs are removed. The
+ * job that is currently processed has its channel pointer reset. The worker
+ * only looks at the channel pointer while holding the service lock. */
+
+#if defined(UA_ARCHITECTURE_WIN32)
+
+typedef CRITICAL_SECTION UA_WorkersMutex;
+typedef CONDITION_VARIABLE UA_WorkersCond;
+# define WORKERS_MUTEX_INIT(m) InitializeCriticalSection(m)
+# define WORKERS_MUTEX_DESTROY(m) DeleteCriticalSection(m)
+# define WORKERS_MUTEX_LOCK(m) EnterCriticalSection(m)
+# define WORKERS_MUTEX_UNLOCK(m) LeaveCriticalSection(m)
+# define WORKERS_COND_INIT(c) InitializeConditionVariable(c)
+# define WORKERS_COND_DESTROY(c)
+# define WORKERS_COND_WAIT(c, m) SleepConditionVariableCS(c, m, INFINITE)
+# define WORKERS_COND_SIGNAL(c) WakeConditionVariable(c)
+
+#else
+
+typedef pthread_mutex_t UA_WorkersMutex;
+typedef pthread_cond_t UA_WorkersCond;
+# define WORKERS_MUTEX_INIT(m) pthread_mutex_init(m, NULL)
+# define WORKERS_MUTEX_DESTROY(m) pthread_mutex_destroy(m)
+# define WORKERS_MUTEX_LOCK(m) pthread_mutex_lock(m)
+# define WORKERS_MUTEX_UNLOCK(m) pthread_mutex_unlock(m)
+# define WORKERS_COND_INIT(c) pthread_cond_init(c, NULL)
+# define WORKERS_COND_DESTROY(c) pthread_cond_destroy(c)
+# define WORKERS_COND_WAIT(c, m) pthread_cond_wait(c, m)
+# define WORKERS_COND_SIGNAL(c) pthread_cond_signal(c)
+
+#endif
+
+typedef struct UA_ServiceJob {
+    TAILQ_ENTRY(UA_ServiceJob) pointers;
+    UA_SecureChannel *channel; /* NULL if the SecureChannel was deleted */
+    UA_UInt32 requestId;
+    UA_Boolean shared;         /* Process with the shared service lock */
+    UA_ServiceDescription *sd;
+    UA_Request request;        /* Decoded on the heap */
+} UA_ServiceJob;
+
+typedef struct {
+    TAILQ_HEAD(, UA_ServiceJob) jobs;
+    UA_ServiceJob *current; /* Job currently processed by the worker */
+    UA_Boolean running;     /* A thread runs the worker */
+    UA_WorkersCond cond;
+} UA_ServiceWorker;
+
+struct UA_ServiceWorkers {
+    UA_WorkersMutex mutex;
+    UA_Boolean stopping;
+    size_t workersSize;
+    UA_ServiceWorker workers[];
+};
+
+UA_ServiceWorkers *
+UA_ServiceWorkers_new(size_t workersSize) {
+    UA_ServiceWorkers *sw = (UA_ServiceWorkers*)
+        UA_calloc(1, sizeof(UA_ServiceWorkers) +
+                  (sizeof(UA_ServiceWorker) * workersSize));
+    if(!sw)
+        return NULL;
+    WORKERS_MUTEX_INIT(&sw->mutex);
+    sw->workersSize = workersSize;
+    for(size_t i = 0; i < workersSize; i++) {
+        TAILQ_INIT(&sw->workers[i].jobs);
+        WORKERS_COND_INIT(&sw->workers[i].cond);
+    }
+    return sw;
+}
+
+static void
+UA_ServiceJob_delete(UA_ServiceJob *job) {
+    UA_clear(&job->request, job->sd->requestType);
+    UA_free(job);
+}
+
+void
+UA_ServiceWorkers_delete(UA_ServiceWorkers *sw) {
+    for(size_t i = 0; i < sw->workersSize; i++) {
+        UA_ServiceWorker *w = &sw->workers[i];
+        UA_assert(!w->running);
+        UA_ServiceJob *job, *job_tmp;
+        TAILQ_FOREACH_SAFE(job, &w->jobs, pointers, job_tmp) {
+            TAILQ_REMOVE(&w->jobs, job, pointers);
+            UA_ServiceJob_delete(job);
+        }
+        WORKERS_COND_DESTROY(&w->cond);
+    }
+    WORKERS_MUTEX_DESTROY(&sw->mutex);
+    UA_free(sw);
+}
+
+void
+UA_ServiceWorkers_start(UA_ServiceWorkers *sw) {
+    WORKERS_MUTEX_LOCK(&sw->mutex);
+    sw->stopping = false;
+    WORKERS_MUTEX_UNLOCK(&sw->mutex);
+}
+
+void
+UA_ServiceWorkers_stop(UA_ServiceWorkers *sw) {
+    WORKERS_MUTEX_LOCK(&sw->mutex);
+    sw->stopping = true;
+    for(size_t i = 0; i < sw->workersSize; i++)
+        WORKERS_COND_SIGNAL(&sw->workers[i].cond);
+    WORKERS_MUTEX_UNLOCK(&sw->mutex);
+}
+
+static UA_ServiceWorker *
+getChannelWorker(UA_ServiceWorkers *sw, const UA_SecureChannel *channel) {
+    return &sw->workers[channel->securityToken.channelId % sw->workersSize];
+}
+
+/* Services that only read from the Nodestore and the Session of the request.
+ * HistoryRead is not included. The history backends can modify their state
+ * during the lookup. The service notification callbacks are application code
+ * that runs around every service. So they prevent the shared lock. */
+static UA_Boolean
+isSharedService(UA_Server *server, const UA_ServiceDescription *sd) {
+    if(!server->config.nodestore->concurrentAccess ||
+       !server->config.accessControl.concurrentAccess)
+        return false;
+    if(server->config.serviceNotificationCallback ||
+       server->config.globalNotificationCallback)
+        return false;
+    return (sd->requestType == &UA_TYPES[UA_TYPES_READREQUEST] ||
+            sd->requestType == &UA_TYPES[UA_TYPES_BROWSEREQUEST] ||
+            sd->requestType == &UA_TYPES[UA_TYPES_BROWSENEXTREQUEST] ||
+            sd->requestType == &UA_TYPES[UA_TYPES_TRANSLATEBROWSEPATHSTONODEIDSREQUEST]);
+}
+
+UA_Boolean
+UA_ServiceWorkers_dispatch(UA_Server *server, UA_SecureChannel *channel,
+                           UA_UInt32 requestId, UA_ServiceDescription *sd,
+                           UA_Request *request) {
+    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_ServiceWorkers *sw = server->serviceWorkers;
+    UA_ServiceWorker *w = getChannelWorker(sw, channel);
+
+    /* Prepare the job */
+    UA_ServiceJob *job = (UA_ServiceJob*)UA_malloc(sizeof(UA_ServiceJob));
+    if(!job)
+        return false;
+    job->channel = channel;
+    job->requestId = requestId;
+    job->shared = isSharedService(server, sd);
+    job->sd = sd;
+
+    /* Enqueue if the worker is running */
+    WORKERS_MUTEX_LOCK(&sw->mutex);
+    if(!w->running || sw->stopping) {
+        WORKERS_MUTEX_UNLOCK(&sw->mutex);
+        UA_free(job);
+        return false;
+    }
+    memcpy(&job->request, request, sd->requestType->memSize);
+    TAILQ_INSERT_TAIL(&w->jobs, job, pointers);
+    WORKERS_COND_SIGNAL(&w->cond);
+    WORKERS_MUTEX_UNLOCK(&sw->mutex);
+    return true;
+}
+
+void
+UA_ServiceWorkers_removeChannel(UA_ServiceWorkers *sw, UA_SecureChannel *channel) {
+    UA_ServiceWorker *w = getChannelWorker(sw, channel);
+    WORKERS_MUTEX_LOCK(&sw->mutex);
+    UA_ServiceJob *job, *job_tmp;
+    TAILQ_FOREACH_SAFE(job, &w->jobs, pointers, job_tmp) {
+        if(job->channel != channel)
+            continue;
+        TAILQ_REMOVE(&w->jobs, job, pointers);
+        UA_ServiceJob_delete(job);
+    }
+    if(w->current && w->current->channel == channel)
+        w->current->channel = NULL;
+    WORKERS_MUTEX_UNLOCK(&sw->mutex);
+}
+
+/* Rejecting a request (no Session, not activated, timed out) updates the
+ * statistics and can remove the Session. That is done with the exclusive
+ * lock. */
+static UA_Boolean
+hasActivatedSession(UA_Server *server, const UA_SecureChannel *channel,
+                    const UA_NodeId *token) {
+    UA_EventLoop *el = server->config.eventLoop;
+    UA_DateTime nowMonotonic = el->dateTime_nowMonotonic(el);
+    for(UA_Session *s = channel->sessions; s; s = s->next) {
+        if(UA_NodeId_equal(token, &s->authenticationToken))
+            return (s->activated && s->validTill >= nowMonotonic);
+    }
+    return false;
+}
+
+/* Application callbacks must not run with the shared lock. They can call the
+ * public server API which takes locks of the EventLoop (e.g. for the timers).
+ * The EventLoop thread holds those while it waits for the exclusive lock. So a
+ * Read is processed with the exclusive lock if a value comes from a callback or
+ * has an onRead notification. The Nodes cannot change before the request is
+ * processed, as the shared lock is held in between. */
+static UA_Boolean
+hasReadCallbacks(UA_Server *server, const UA_ReadRequest *request) {
+    for(size_t i = 0; i < request->nodesToReadSize; i++) {
+        const UA_ReadValueId *rvi = &request->nodesToRead[i];
+        if(rvi->attributeId != UA_ATTRIBUTEID_VALUE)
+            continue;
+        const UA_Node *node =
+            UA_NODESTORE_GET_SELECTIVE(server, &rvi->nodeId,
+                                       UA_NODEATTRIBUTESMASK_VALUE,
+                                       UA_REFERENCETYPESET_NONE,
+                                       UA_BROWSEDIRECTION_INVALID);
+        if(!node)
+            continue;
+        UA_Boolean callback = false;
+        if(node->head.nodeClass == UA_NODECLASS_VARIABLE ||
+           node->head.nodeClass == UA_NODECLASS_VARIABLETYPE) {
+            const UA_VariableNode *vn = &node->variableNode;
+            switch(vn->valueSourceType) {
+            case UA_VALUESOURCETYPE_INTERNAL:
+                callback = (vn->valueSource.internal.notifications.onRead != NULL);
+                break;
+            case UA_VALUESOURCETYPE_EXTERNAL:
+                callback = (vn->valueSource.external.notifications.onRead != NULL);
+                break;
+            default:
+                callback = true;
+                break;
+            }
+        }
+        UA_NODESTORE_RELEASE(server, node);
+        if(callback)
+            return true;
+    }
+    return false;
+}
+
+static void
+processServiceJob(UA_Server *server, UA_ServiceJob *job) {
+    UA_Boolean shared = job->shared;
+    if(shared) {
+        UA_LOCK_SHARED(&server->serviceMutex);
+        if(!job->channel ||
+           !hasActivatedSession(server, job->channel,
+                                &job->request.requestHeader.authenticationToken) ||
+           (job->sd->requestType == &UA_TYPES[UA_TYPES_READREQUEST] &&
+            hasReadCallbacks(server, &job->request.readRequest))) {
+            UA_UNLOCK_SHARED(&server->serviceMutex);
+            shared = false;
+        }
+    }
+    if(!shared)
+        lockServer(server);
+
+    /* Process the request and send the response (if not async) */
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    UA_SecureChannel *channel = job->channel;
+    if(channel && channel->state == UA_SECURECHANNELSTATE_OPEN) {
+        UA_Response response;
+        UA_init(&response, job->sd->responseType);
+        response.responseHeader.requestHandle = job->request.requestHeader.requestHandle;
+        UA_Boolean done = processRequest(server, channel, job->requestId,
+                                         job->sd, &job->request, &response);
+        if(done) {
+            /* The SecurityPolicies share state between the SecureChannels
+             * (e.g. for the HMAC computation). Serialize signing and
+             * encryption between the workers. */
+            UA_Boolean secure =
+                (shared && channel->securityMode != UA_MESSAGESECURITYMODE_NONE);
+            if(secure)
+                UA_LOCK(&server->sharedMutex);
+            res = sendResponse(server, channel, job->requestId,
+                               &response, job->sd->responseType);
+            if(secure)
+                UA_UNLOCK(&server->sharedMutex);
+        }
+        UA_clear(&response, job->sd->responseType);
+    }
+
+    if(shared)
+        UA_UNLOCK_SHARED(&server->serviceMutex);
+    else
+        unlockServer(server);
+
+    if(res == UA_STATUSCODE_GOOD)
+        return;
+
+    /* Sending failed. Close the SecureChannel with the exclusive lock. */
+    lockServer(server);
+    if(job->channel) {
+        UA_LOG_INFO_CHANNEL(server->config.logging, job->channel,
+                            "Sending the response failed with StatusCode %s. "
+                            "Closing the channel.", UA_StatusCode_name(res));
+        UA_SecureChannel_shutdown(job->channel, UA_SHUTDOWNREASON_ABORT);
+    }
+    unlockServer(server);
+}
+
+UA_StatusCode
+UA_Server_runServiceWorker(UA_Server *server, size_t workerIndex) {
+    UA_ServiceWorkers *sw = server->serviceWorkers;
+    if(!sw || workerIndex >= sw->workersSize)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+
+    UA_ServiceWorker *w = &sw->workers[workerIndex];
+    WORKERS_MUTEX_LOCK(&sw->mutex);
+    if(w->running) {
+        WORKERS_MUTEX_UNLOCK(&sw->mutex);
+        return UA_STATUSCODE_BADINVALIDSTATE;
+    }
+    w->running = true;
+
+    while(!sw->stopping) {
+        /* Wait for the next job */
+        UA_ServiceJob *job = TAILQ_FIRST(&w->jobs);
+        if(!job) {
+            WORKERS_COND_WAIT(&w->cond, &sw->mutex);
+            continue;
+        }
+        TAILQ_REMOVE(&w->jobs, job, pointers);
+        w->current = job;
+        WORKERS_MUTEX_UNLOCK(&sw->mutex);
+
+        processServiceJob(server, job);
+
+        WORKERS_MUTEX_LOCK(&sw->mutex);
+        w->current = NULL;
+        UA_ServiceJob_delete(job);
+    }
+
+    /* Remaining jobs are removed with their SecureChannel */
+    w->running = false;
+    WORKERS_MUTEX_UNLOCK(&sw->mutex);
+    return UA_STATUSCODE_GOOD;
+}
+
+#endif /* UA_MULTITHREADING >= 100 */
@@ -286,8 +286,8 @@ processServiceInternal(UA_Server *server, UA_SecureChannel *channel, UA_Session
     UA_Session_updateLifetime(session, now, nowMonotonic);
 
     /* Store the request id -- will be used to create async responses */
-    server->asyncManager.currentRequestId = requestId;
-    server->asyncManager.currentRequestHandle = request->requestHeader.requestHandle;
+    currentRequestId = requestId;
+    currentRequestHandle = request->requestHeader.requestHandle;
 
     /* Execute the service */
     return sd->serviceCallback(server, session, request, response);
@@ -297,7 +297,7 @@ UA_Boolean
 processRequest(UA_Server *server, UA_SecureChannel *channel,
                UA_UInt32 requestId, UA_ServiceDescription *sd,
                const UA_Request *request, UA_Response *response) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_LOCK_ASSERT_SHARED_OR_EXCLUSIVE(&server->serviceMutex);
 
     /* Set the authenticationToken from the create session request to help
      * fuzzing cover more lines */
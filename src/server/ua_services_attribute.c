@@ -74,7 +74,7 @@ attributeId2AttributeMask(UA_AttributeId id) {
 static UA_UInt32
 getUserWriteMask(UA_Server *server, const UA_Session *session,
                  const UA_NodeHead *head) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_LOCK_ASSERT_SHARED_OR_EXCLUSIVE(&server->serviceMutex);
     if(session == &server->adminSession)
         return 0xFFFFFFFF; /* the local admin user has all rights */
     return head->writeMask & server->config.accessControl.
@@ -87,7 +87,7 @@ getUserWriteMask(UA_Server *server, const UA_Session *session,
 static UA_Byte
 getUserAccessLevel(UA_Server *server, const UA_Session *session,
                    const UA_VariableNode *node) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_LOCK_ASSERT_SHARED_OR_EXCLUSIVE(&server->serviceMutex);
     if(session == &server->adminSession)
         return 0xFF; /* the local admin user has all rights */
     return node->accessLevel & server->config.accessControl.
@@ -100,7 +100,7 @@ getUserAccessLevel(UA_Server *server, const UA_Session *session,
 static UA_Boolean
 getUserExecutable(UA_Server *server, const UA_Session *session,
                   const UA_MethodNode *node) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_LOCK_ASSERT_SHARED_OR_EXCLUSIVE(&server->serviceMutex);
     if(session == &server->adminSession)
         return true; /* the local admin user has all rights */
     return node->executable & server->config.accessControl.
@@ -141,7 +141,7 @@ static UA_StatusCode
 readInternalValueAttribute(UA_Server *server, UA_Session *session,
                            const UA_VariableNode *vn, UA_DataValue *v,
                            UA_NumericRange *rangeptr) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_LOCK_ASSERT_SHARED_OR_EXCLUSIVE(&server->serviceMutex);
 
     /* Update the value by the user callback */
     if(vn->valueSource.internal.notifications.onRead) {
@@ -173,7 +173,7 @@ static UA_StatusCode
 readExternalValueAttribute(UA_Server *server, UA_Session *session,
                            const UA_VariableNode *vn, UA_DataValue *v,
                            UA_NumericRange *rangeptr) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_LOCK_ASSERT_SHARED_OR_EXCLUSIVE(&server->serviceMutex);
 
     /* Update the value by the user callback */
     if(vn->valueSource.internal.notifications.onRead)
@@ -537,15 +537,40 @@ ReadWithNodeMaybeAsync(const UA_Node *node, UA_Server *server, UA_Session *sessi
     return (retval != UA_STATUSCODE_GOODCOMPLETESASYNCHRONOUSLY);
 }
 
+const UA_Node *
+getNodeForRead(UA_Server *server, const UA_ReadValueId *rvi) {
+    /* Get the node (with only the selected attribute if the NodeStore supports that) */
+    UA_UInt32 attrMask = attributeId2AttributeMask((UA_AttributeId)rvi->attributeId);
+    return UA_NODESTORE_GET_SELECTIVE(server, &rvi->nodeId, attrMask,
+                                      UA_REFERENCETYPESET_NONE,
+                                      UA_BROWSEDIRECTION_INVALID);
+}
+
+UA_Boolean
+readWithNodeSync(UA_Server *server, UA_Session *session, const UA_Node *node,
+                 UA_TimestampsToReturn ttr, const UA_ReadValueId *rvi,
+                 UA_DataValue *dv) {
+    UA_LOCK_ASSERT(&server->serviceMutex);
+
+    /* Callback value sources can return GOODCOMPLETESASYNCHRONOUSLY. Then the
+     * DataValue needs a stable memory location until the result is set. Leave
+     * these reads to the async-capable path. */
+    if(rvi->attributeId == UA_ATTRIBUTEID_VALUE &&
+       (node->head.nodeClass & (UA_NODECLASS_VARIABLE | UA_NODECLASS_VARIABLETYPE)) &&
+       node->variableNode.valueSourceType == UA_VALUESOURCETYPE_CALLBACK)
+        return false;
+
+    UA_Boolean done = ReadWithNodeMaybeAsync(node, server, session, ttr, rvi, dv);
+    UA_assert(done);
+    (void)done;
+    return true;
+}
+
 UA_Boolean
 Operation_Read(UA_Server *server, UA_Session *session,
                UA_TimestampsToReturn ttr,
                const UA_ReadValueId *rvi, UA_DataValue *dv) {
-    /* Get the node (with only the selected attribute if the NodeStore supports that) */
-    UA_UInt32 attrMask = attributeId2AttributeMask((UA_AttributeId)rvi->attributeId);
-    const UA_Node *node =
-        UA_NODESTORE_GET_SELECTIVE(server, &rvi->nodeId, attrMask,
-                                   UA_REFERENCETYPESET_NONE, UA_BROWSEDIRECTION_INVALID);
+    const UA_Node *node = getNodeForRead(server, rvi);
     if(!node) {
         dv->hasStatus = true;
         dv->status = UA_STATUSCODE_BADNODEIDUNKNOWN;
@@ -1784,6 +1809,54 @@ Operation_Write(UA_Server *server, UA_Session *session,
     return (*result != UA_STATUSCODE_GOODCOMPLETESASYNCHRONOUSLY);
 }
 
+UA_StatusCode
+writeValueAttributeUnchecked(UA_Server *server, UA_Session *session,
+                             UA_VariableNode *node, const UA_DataValue *value) {
+    UA_LOCK_ASSERT(&server->serviceMutex);
+    if(node->head.nodeClass != UA_NODECLASS_VARIABLE ||
+       (node->valueSourceType != UA_VALUESOURCETYPE_INTERNAL &&
+        node->valueSourceType != UA_VALUESOURCETYPE_EXTERNAL))
+        return UA_STATUSCODE_BADWRITENOTSUPPORTED;
+
+    UA_DataValue adjustedValue = *value;
+    if(!node->isDynamic) {
+        adjustedValue.hasSourceTimestamp = false;
+        adjustedValue.hasSourcePicoseconds = false;
+    }
+
+    /* Write into the value source backend */
+    UA_DataValue *oldValue = (node->valueSourceType == UA_VALUESOURCETYPE_INTERNAL) ?
+        &node->valueSource.internal.value :
+        (UA_DataValue*)UA_atomic_load((void**)node->valueSource.external.value);
+    UA_StatusCode retval = writeInternalValueAttribute(oldValue, &adjustedValue, NULL);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    if(node->valueSource.internal.notifications.onWrite)
+        node->valueSource.internal.notifications.
+            onWrite(server, &session->sessionId, session->context,
+                    &node->head.nodeId, node->head.context, NULL, &adjustedValue);
+
+#ifdef UA_ENABLE_HISTORIZING
+    if(server->config.historyDatabase.setValue)
+        server->config.historyDatabase.
+            setValue(server, server->config.historyDatabase.context,
+                     &session->sessionId, session->context,
+                     &node->head.nodeId, node->historizing, &adjustedValue);
+#endif
+
+    /* Trigger MonitoredItems with no SamplingInterval */
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+    UA_WriteValue wv;
+    UA_WriteValue_init(&wv);
+    wv.nodeId = node->head.nodeId;
+    wv.attributeId = UA_ATTRIBUTEID_VALUE;
+    wv.value = *value;
+    triggerImmediateDataChange(server, session, (UA_Node*)node, &wv);
+#endif
+
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_StatusCode
 UA_Server_write(UA_Server *server, const UA_WriteValue *value) {
     UA_StatusCode res = UA_STATUSCODE_GOOD;
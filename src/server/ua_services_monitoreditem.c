@@ -532,6 +532,17 @@ Operation_CreateMonitoredItem(UA_Server *server, UA_Session *session,
                                                          valueType, &newMon->parameters,
                                                          &result->filterResult);
 
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    /* Compile the EventFilter (or share the program of an identical filter) */
+    if(result->statusCode == UA_STATUSCODE_GOOD &&
+       newMon->itemToMonitor.attributeId == UA_ATTRIBUTEID_EVENTNOTIFIER) {
+        const UA_EventFilter *ef = (const UA_EventFilter*)
+            newMon->parameters.filter.content.decoded.data;
+        result->statusCode =
+            UA_EventFilterProgram_acquire(server, ef, &newMon->eventProgram);
+    }
+#endif
+
     if(result->statusCode != UA_STATUSCODE_GOOD) {
         UA_LOG_INFO_SUBSCRIPTION(server->config.logging, cmc->sub,
                                  "Could not create a MonitoredItem "
@@ -808,6 +819,23 @@ Operation_ModifyMonitoredItem(UA_Server *server, UA_Session *session, UA_Subscri
         return;
     }
 
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    /* Compile the new EventFilter before the old program is released */
+    if(mon->itemToMonitor.attributeId == UA_ATTRIBUTEID_EVENTNOTIFIER) {
+        UA_EventFilterProgram *program = NULL;
+        result->statusCode = UA_EventFilterProgram_acquire(server, (const UA_EventFilter*)
+                                                           params.filter.content.decoded.data,
+                                                           &program);
+        if(result->statusCode != UA_STATUSCODE_GOOD) {
+            UA_MonitoringParameters_clear(&params);
+            return;
+        }
+        if(mon->eventProgram)
+            UA_EventFilterProgram_release(server, mon->eventProgram);
+        mon->eventProgram = program;
+    }
+#endif
+
     /* Store the old sampling interval */
     UA_Double oldSamplingInterval = mon->parameters.samplingInterval;
 
@@ -17,6 +17,94 @@
 #include "ua_server_internal.h"
 #include "ua_services.h"
 
+/*****************/
+/* Session Index */
+/*****************/
+
+#define UA_SESSIONINDEX_INITIALSIZE 16
+
+static enum ZIP_CMP
+cmpSessionTimeout(const UA_DateTime *a, const UA_DateTime *b) {
+    if(*a == *b)
+        return ZIP_CMP_EQ;
+    return (*a < *b) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+}
+
+ZIP_FUNCTIONS(UA_SessionTimeoutTree, session_list_entry, timeoutEntry,
+              UA_DateTime, timeoutKey, cmpSessionTimeout)
+
+static UA_INLINE size_t
+sessionIndexSlot(const UA_Server *server, const UA_NodeId *id) {
+    return UA_NodeId_hash(id) & (server->sessionsIndexSize - 1);
+}
+
+static void
+indexSession(UA_Server *server, session_list_entry *sentry) {
+    size_t slot = sessionIndexSlot(server, &sentry->session.authenticationToken);
+    sentry->tokenNext = server->sessionsByToken[slot];
+    server->sessionsByToken[slot] = sentry;
+    slot = sessionIndexSlot(server, &sentry->session.sessionId);
+    sentry->idNext = server->sessionsById[slot];
+    server->sessionsById[slot] = sentry;
+}
+
+static void
+unindexSession(UA_Server *server, session_list_entry *sentry) {
+    session_list_entry **prev = &server->sessionsByToken[
+        sessionIndexSlot(server, &sentry->session.authenticationToken)];
+    while(*prev != sentry)
+        prev = &(*prev)->tokenNext;
+    *prev = sentry->tokenNext;
+
+    prev = &server->sessionsById[sessionIndexSlot(server, &sentry->session.sessionId)];
+    while(*prev != sentry)
+        prev = &(*prev)->idNext;
+    *prev = sentry->idNext;
+}
+
+/* Ensure capacity for one more session. The index is rebuilt with twice the
+ * size when the load factor would exceed one. If growing fails, the existing
+ * (smaller) index remains usable. */
+static UA_StatusCode
+growSessionIndex(UA_Server *server) {
+    if(server->sessionCount < server->sessionsIndexSize)
+        return UA_STATUSCODE_GOOD;
+
+    size_t newSize = (server->sessionsIndexSize > 0) ?
+        server->sessionsIndexSize << 1 : UA_SESSIONINDEX_INITIALSIZE;
+    session_list_entry **byToken = (session_list_entry**)
+        UA_calloc(newSize, sizeof(session_list_entry*));
+    session_list_entry **byId = (session_list_entry**)
+        UA_calloc(newSize, sizeof(session_list_entry*));
+    if(!byToken || !byId) {
+        UA_free(byToken);
+        UA_free(byId);
+        return (server->sessionsIndexSize > 0) ?
+            UA_STATUSCODE_GOOD : UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    UA_free(server->sessionsByToken);
+    UA_free(server->sessionsById);
+    server->sessionsByToken = byToken;
+    server->sessionsById = byId;
+    server->sessionsIndexSize = newSize;
+
+    session_list_entry *sentry;
+    LIST_FOREACH(sentry, &server->sessions, pointers) {
+        indexSession(server, sentry);
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+clearSessionIndex(UA_Server *server) {
+    UA_free(server->sessionsByToken);
+    UA_free(server->sessionsById);
+    server->sessionsByToken = NULL;
+    server->sessionsById = NULL;
+    server->sessionsIndexSize = 0;
+}
+
 void
 notifySession(UA_Server *server, UA_Session *session,
               UA_ApplicationNotificationType type) {
@@ -109,6 +197,8 @@ UA_Session_remove(UA_Server *server, UA_Session *session,
      * available */
     session_list_entry *sentry = container_of(session, session_list_entry, session);
     LIST_REMOVE(sentry, pointers);
+    unindexSession(server, sentry);
+    ZIP_REMOVE(UA_SessionTimeoutTree, &server->sessionTimeouts, sentry);
     server->sessionCount--;
 
     switch(shutdownReason) {
@@ -147,11 +237,22 @@ UA_Session_remove(UA_Server *server, UA_Session *session,
 void
 cleanupSessions(UA_Server *server, UA_DateTime nowMonotonic) {
     UA_LOCK_ASSERT(&server->serviceMutex);
-    session_list_entry *sentry, *temp;
-    LIST_FOREACH_SAFE(sentry, &server->sessions, pointers, temp) {
-        /* Session has timed out? */
-        if(sentry->session.validTill >= nowMonotonic)
+    session_list_entry *sentry;
+    while((sentry = ZIP_MIN(UA_SessionTimeoutTree, &server->sessionTimeouts))) {
+        /* The timeout keys are lower bounds for validTill. So all remaining
+         * sessions are still valid. */
+        if(sentry->timeoutKey >= nowMonotonic)
+            break;
+
+        /* The lifetime was extended since the key was set. Update the key. */
+        if(sentry->session.validTill >= nowMonotonic) {
+            ZIP_REMOVE(UA_SessionTimeoutTree, &server->sessionTimeouts, sentry);
+            sentry->timeoutKey = sentry->session.validTill;
+            ZIP_INSERT(UA_SessionTimeoutTree, &server->sessionTimeouts, sentry);
             continue;
+        }
+
+        /* Session has timed out */
         UA_LOG_INFO_SESSION(server->config.logging, &sentry->session,
                             "Session has timed out");
         UA_Session_remove(server, &sentry->session, UA_SHUTDOWNREASON_TIMEOUT);
@@ -162,51 +263,43 @@ cleanupSessions(UA_Server *server, UA_DateTime nowMonotonic) {
 /* Services */
 /************/
 
+/* Returns NULL if the session has timed out */
+static UA_Session *
+checkSessionLifetime(UA_Server *server, session_list_entry *sentry) {
+    UA_EventLoop *el = server->config.eventLoop;
+    UA_DateTime now = el->dateTime_nowMonotonic(el);
+    if(now > sentry->session.validTill) {
+        UA_LOG_INFO_SESSION(server->config.logging, &sentry->session,
+                            "Client tries to use a session that has timed out");
+        return NULL;
+    }
+    return &sentry->session;
+}
+
 UA_Session *
 getSessionByToken(UA_Server *server, const UA_NodeId *token) {
     UA_LOCK_ASSERT(&server->serviceMutex);
+    if(server->sessionsIndexSize == 0)
+        return NULL;
 
-    session_list_entry *current = NULL;
-    LIST_FOREACH(current, &server->sessions, pointers) {
-        /* Token does not match */
-        if(!UA_NodeId_equal(&current->session.authenticationToken, token))
-            continue;
-
-        /* Session has timed out */
-        UA_EventLoop *el = server->config.eventLoop;
-        UA_DateTime now = el->dateTime_nowMonotonic(el);
-        if(now > current->session.validTill) {
-            UA_LOG_INFO_SESSION(server->config.logging, &current->session,
-                                "Client tries to use a session that has timed out");
-            return NULL;
-        }
-
-        return &current->session;
+    session_list_entry *current = server->sessionsByToken[sessionIndexSlot(server, token)];
+    for(; current; current = current->tokenNext) {
+        if(UA_NodeId_equal(&current->session.authenticationToken, token))
+            return checkSessionLifetime(server, current);
     }
-
     return NULL;
 }
 
 UA_Session *
 getSessionById(UA_Server *server, const UA_NodeId *sessionId) {
     UA_LOCK_ASSERT(&server->serviceMutex);
-
-    session_list_entry *current = NULL;
-    LIST_FOREACH(current, &server->sessions, pointers) {
-        /* Token does not match */
-        if(!UA_NodeId_equal(&current->session.sessionId, sessionId))
-            continue;
-
-        /* Session has timed out */
-        UA_EventLoop *el = server->config.eventLoop;
-        UA_DateTime now = el->dateTime_nowMonotonic(el);
-        if(now > current->session.validTill) {
-            UA_LOG_INFO_SESSION(server->config.logging, &current->session,
-                                "Client tries to use a session that has timed out");
-            return NULL;
+    if(server->sessionsIndexSize > 0) {
+        session_list_entry *current =
+            server->sessionsById[sessionIndexSlot(server, sessionId)];
+        for(; current; current = current->idNext) {
+            if(UA_NodeId_equal(&current->session.sessionId, sessionId))
+                return checkSessionLifetime(server, current);
         }
-
-        return &current->session;
     }
 
     if(UA_NodeId_equal(sessionId, &server->adminSession.sessionId))
@@ -331,6 +424,10 @@ UA_Session_create(UA_Server *server, UA_SecureChannel *channel,
         return UA_STATUSCODE_BADTOOMANYSESSIONS;
     }
 
+    UA_StatusCode res = growSessionIndex(server);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
     session_list_entry *newentry = (session_list_entry*)
         UA_malloc(sizeof(session_list_entry));
     if(!newentry)
@@ -357,6 +454,9 @@ UA_Session_create(UA_Server *server, UA_SecureChannel *channel,
 
     /* Add to the server */
     LIST_INSERT_HEAD(&server->sessions, newentry, pointers);
+    indexSession(server, newentry);
+    newentry->timeoutKey = newentry->session.validTill;
+    ZIP_INSERT(UA_SessionTimeoutTree, &server->sessionTimeouts, newentry);
     server->sessionCount++;
 
     /* Notify the application */
@@ -1110,6 +1210,8 @@ Service_Cancel(UA_Server *server, UA_Session *session,
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     UA_PublishResponseEntry *pre, *pre_tmp;
     UA_PublishResponseEntry *prev = NULL;
+    UA_SecureChannel *channel = session->channel;
+    UA_SecureChannel_cork(channel);
     SIMPLEQ_FOREACH_SAFE(pre, &session->responseQueue, listEntry, pre_tmp) {
         /* Skip entry and set as the previous entry that is kept in the list */
         if(pre->response.responseHeader.requestHandle != request->requestHandle) {
@@ -1134,6 +1236,7 @@ Service_Cancel(UA_Server *server, UA_Session *session,
         /* Increase the CancelCount */
         response->cancelCount++;
     }
+    UA_SecureChannel_uncork(channel);
 #endif
 
     return true;
@@ -299,7 +299,7 @@ Service_Publish(UA_Server *server, UA_Session *session,
                 UA_PublishResponse *response) {
     UA_LOG_DEBUG_SESSION(server->config.logging, session,
                          "Processing PublishRequest with RequestId %u",
-                         server->asyncManager.currentRequestId);
+                         currentRequestId);
     UA_LOCK_ASSERT(&server->serviceMutex);
 
     /* Return an error if the session has no subscription */
@@ -340,7 +340,7 @@ Service_Publish(UA_Server *server, UA_Session *session,
 
     /* <--- Async response from here on ---> */
 
-    entry->requestId = server->asyncManager.currentRequestId;
+    entry->requestId = currentRequestId;
     entry_response->responseHeader.requestHandle = request->requestHeader.requestHandle;
 
     /* Delete Acknowledged Subscription Messages */
@@ -379,6 +379,8 @@ Service_Publish(UA_Server *server, UA_Session *session,
      * notifications must not "starve" other late subscriptions. Hence we move
      * it to the end of the queue for the subscriptions of that priority. */
     UA_Subscription *late, *late_tmp;
+    UA_SecureChannel *channel = session->channel;
+    UA_SecureChannel_cork(channel);
     TAILQ_FOREACH_SAFE(late, &session->subscriptions, sessionListEntry, late_tmp) {
         /* Skip non-late subscriptions */
         if(!late->late)
@@ -408,6 +410,7 @@ Service_Publish(UA_Server *server, UA_Session *session,
         if(session->responseQueueSize == 0)
             break;
     }
+    UA_SecureChannel_uncork(channel);
 
     return false;
 }
@@ -820,7 +820,7 @@ browse(struct BrowseContext *bc) {
 
     /* Check AccessControl rights */
     if(bc->session != &bc->server->adminSession) {
-        UA_LOCK_ASSERT(&bc->server->serviceMutex);
+        UA_LOCK_ASSERT_SHARED_OR_EXCLUSIVE(&bc->server->serviceMutex);
         if(!bc->server->config.accessControl.
            allowBrowseNode(bc->server, &bc->server->config.accessControl,
                            &bc->session->sessionId, bc->session->context,
@@ -993,7 +993,7 @@ UA_Boolean
 Service_Browse(UA_Server *server, UA_Session *session,
                const UA_BrowseRequest *request, UA_BrowseResponse *response) {
     UA_LOG_DEBUG_SESSION(server->config.logging, session, "Processing BrowseRequest");
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_LOCK_ASSERT_SHARED_OR_EXCLUSIVE(&server->serviceMutex);
 
     /* Test the number of operations in the request */
     if(server->config.maxNodesPerBrowse != 0 &&
@@ -1113,7 +1113,7 @@ Service_BrowseNext(UA_Server *server, UA_Session *session,
                    UA_BrowseNextResponse *response) {
     UA_LOG_DEBUG_SESSION(server->config.logging, session,
                          "Processing BrowseNextRequest");
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_LOCK_ASSERT_SHARED_OR_EXCLUSIVE(&server->serviceMutex);
 
     UA_Boolean releaseContinuationPoints =
         request->releaseContinuationPoints; /* request is const */
@@ -1270,7 +1270,7 @@ Operation_TranslateBrowsePathToNodeIds(UA_Server *server, UA_Session *session,
                                        const UA_UInt32 *nodeClassMask,
                                        const UA_BrowsePath *path,
                                        UA_BrowsePathResult *result) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_LOCK_ASSERT_SHARED_OR_EXCLUSIVE(&server->serviceMutex);
 
     if(path->relativePath.elementsSize == 0) {
         result->statusCode = UA_STATUSCODE_BADNOTHINGTODO;
@@ -1421,7 +1421,7 @@ Service_TranslateBrowsePathsToNodeIds(UA_Server *server, UA_Session *session,
                                       UA_TranslateBrowsePathsToNodeIdsResponse *response) {
     UA_LOG_DEBUG_SESSION(server->config.logging, session,
                          "Processing TranslateBrowsePathsToNodeIdsRequest");
-    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_LOCK_ASSERT_SHARED_OR_EXCLUSIVE(&server->serviceMutex);
 
     /* Test the number of operations in the request */
     if(server->config.maxNodesPerTranslateBrowsePathsToNodeIds != 0 &&
@@ -189,6 +189,8 @@ UA_Session_detachSubscription(UA_Server *server, UA_Session *session,
     if(!releasePublishResponses || !TAILQ_EMPTY(&session->subscriptions))
         return;
     UA_PublishResponseEntry *pre;
+    UA_SecureChannel *channel = session->channel;
+    UA_SecureChannel_cork(channel);
     while((pre = UA_Session_dequeuePublishReq(session))) {
         UA_PublishResponse *response = &pre->response;
         response->responseHeader.serviceResult = UA_STATUSCODE_BADNOSUBSCRIPTION;
@@ -197,6 +199,7 @@ UA_Session_detachSubscription(UA_Server *server, UA_Session *session,
         UA_PublishResponse_clear(response);
         UA_free(pre);
     }
+    UA_SecureChannel_uncork(channel);
 }
 
 UA_Subscription *
@@ -715,8 +715,8 @@ delayedPublishNotifications(UA_Server *server, UA_Subscription *sub) {
 
 /* Try to publish now. Enqueue a "next publish" as a delayed callback if not
  * done. */
-void
-UA_Subscription_publish(UA_Server *server, UA_Subscription *sub) {
+static void
+publishSubscription(UA_Server *server, UA_Subscription *sub) {
     UA_EventLoop *el = server->config.eventLoop;
 
     /* Get a response */
@@ -938,6 +938,17 @@ UA_Subscription_publish(UA_Server *server, UA_Subscription *sub) {
     }
 }
 
+void
+UA_Subscription_publish(UA_Server *server, UA_Subscription *sub) {
+    /* Cork the SecureChannel. The responses for timed-out publish requests and
+     * the PublishResponse are then sent out together. The channel remains
+     * valid if the Subscription is deleted during _publish. */
+    UA_SecureChannel *channel = (sub->session) ? sub->session->channel : NULL;
+    UA_SecureChannel_cork(channel);
+    publishSubscription(server, sub);
+    UA_SecureChannel_uncork(channel);
+}
+
 void
 UA_Subscription_resendData(UA_Server *server, UA_Subscription *sub) {
     UA_LOCK_ASSERT(&server->serviceMutex);
@@ -975,6 +986,8 @@ UA_Session_ensurePublishQueueSpace(UA_Server* server, UA_Session* session) {
     if(server->config.maxPublishReqPerSession == 0)
         return;
 
+    UA_SecureChannel *channel = session->channel;
+    UA_SecureChannel_cork(channel);
     while(session->responseQueueSize >= server->config.maxPublishReqPerSession) {
         /* Dequeue a response */
         UA_PublishResponseEntry *pre = UA_Session_dequeuePublishReq(session);
@@ -993,6 +1006,7 @@ UA_Session_ensurePublishQueueSpace(UA_Server* server, UA_Session* session) {
         UA_PublishResponse_clear(response);
         UA_free(pre);
     }
+    UA_SecureChannel_uncork(channel);
 }
 
 static void
@@ -1114,6 +1128,7 @@ createEventOverflowNotification(UA_Server *server, UA_Subscription *sub,
     ctx.server = server;
     ctx.session = session;
     ctx.filter = *ef;
+    ctx.program = mon->eventProgram;
     ctx.ed.sourceNode = UA_NS0ID(SERVER);
     ctx.ed.eventType = UA_NS0ID(EVENTQUEUEOVERFLOWEVENTTYPE);
     ctx.ed.severity = 201; /* TODO: Can this be configured? */
@@ -1432,6 +1447,12 @@ UA_MonitoredItem_delete(UA_Server *server, UA_MonitoredItem *mon) {
     /* Remove the settings */
     UA_ReadValueId_clear(&mon->itemToMonitor);
     UA_MonitoringParameters_clear(&mon->parameters);
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    if(mon->eventProgram) {
+        UA_EventFilterProgram_release(server, mon->eventProgram);
+        mon->eventProgram = NULL;
+    }
+#endif
 
     /* Remove the last samples */
     UA_DataValue_clear(&mon->lastValue);
@@ -1566,13 +1587,142 @@ UA_MonitoredItem_ensureQueueSpace(UA_Server *server, UA_MonitoredItem *mon) {
     }
 }
 
+/******************/
+/* SamplingGroups */
+/******************/
+
 static void
-UA_MonitoredItem_lockAndSample(UA_Server *server, UA_MonitoredItem *mon) {
+UA_SamplingGroup_delete(UA_Server *server, UA_SamplingGroup *sg) {
+    UA_assert(LIST_EMPTY(&sg->monitoredItems));
+    removeCallback(server, sg->callbackId);
+    LIST_REMOVE(sg, listEntry);
+    UA_free(sg);
+}
+
+static UA_Boolean
+sameSamplingTarget(const UA_ReadValueId *a, const UA_ReadValueId *b) {
+    return (a->attributeId == b->attributeId &&
+            UA_NodeId_equal(&a->nodeId, &b->nodeId));
+}
+
+/* Sample all MonitoredItems of the group with a single lock acquisition */
+static void
+UA_SamplingGroup_sample(UA_Server *server, UA_SamplingGroup *sg) {
     lockServer(server);
-    UA_MonitoredItem_sample(server, mon);
+    sg->sampling = true;
+    sg->samplingCycles++;
+
+    /* The node of the previous MonitoredItem. Reused for the following
+     * MonitoredItems that sample the same node and attribute. The refcount
+     * keeps the node alive if the previous MonitoredItem was removed. */
+    const UA_Node *node = NULL;
+    UA_ReadValueId nodeTarget;
+    UA_ReadValueId_init(&nodeTarget);
+
+    UA_MonitoredItem *mon = LIST_FIRST(&sg->monitoredItems);
+    while(mon) {
+        sg->nextSample = LIST_NEXT(mon, sampling.cyclic.groupEntry);
+
+        /* Resolve the node if not already done for the previous item */
+        if(node && !sameSamplingTarget(&nodeTarget, &mon->itemToMonitor)) {
+            UA_NODESTORE_RELEASE(server, node);
+            node = NULL;
+        }
+        if(!node) {
+            node = getNodeForRead(server, &mon->itemToMonitor);
+            sg->nodeLookups++;
+            /* Shallow copy. Points into the node that is kept alive. */
+            if(node) {
+                nodeTarget.nodeId = node->head.nodeId;
+                nodeTarget.attributeId = mon->itemToMonitor.attributeId;
+            }
+        }
+
+        /* The callback of a local MonitoredItem can modify the node. Resolve
+         * the node again for the next MonitoredItem. */
+        UA_Boolean local = (mon->subscription == NULL);
+        UA_MonitoredItem_sampleWithNode(server, mon, node);
+        sg->samplesCount++;
+        if(local && node) {
+            UA_NODESTORE_RELEASE(server, node);
+            node = NULL;
+        }
+
+        mon = sg->nextSample;
+    }
+    if(node)
+        UA_NODESTORE_RELEASE(server, node);
+    sg->nextSample = NULL;
+    sg->sampling = false;
+
+    /* The last MonitoredItem was removed during sampling */
+    if(LIST_EMPTY(&sg->monitoredItems))
+        UA_SamplingGroup_delete(server, sg);
     unlockServer(server);
 }
 
+static UA_StatusCode
+UA_SamplingGroup_addMonitoredItem(UA_Server *server, UA_MonitoredItem *mon) {
+    /* Find an existing group with the same sampling interval */
+    UA_SamplingGroup *sg;
+    LIST_FOREACH(sg, &server->samplingGroups, listEntry) {
+        if(sg->samplingInterval == mon->parameters.samplingInterval)
+            break;
+    }
+
+    /* Create a new group */
+    if(!sg) {
+        sg = (UA_SamplingGroup*)UA_calloc(1, sizeof(UA_SamplingGroup));
+        if(!sg)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        sg->samplingInterval = mon->parameters.samplingInterval;
+        UA_StatusCode res =
+            addRepeatedCallback(server, (UA_ServerCallback)UA_SamplingGroup_sample,
+                                sg, sg->samplingInterval, &sg->callbackId);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_free(sg);
+            return res;
+        }
+        LIST_INSERT_HEAD(&server->samplingGroups, sg, listEntry);
+    }
+
+    /* Add the MonitoredItem. Place it next to a MonitoredItem that samples the
+     * same node and attribute. Then the node is resolved only once. */
+    UA_MonitoredItem *neighbor;
+    LIST_FOREACH(neighbor, &sg->monitoredItems, sampling.cyclic.groupEntry) {
+        if(sameSamplingTarget(&neighbor->itemToMonitor, &mon->itemToMonitor))
+            break;
+    }
+    if(neighbor)
+        LIST_INSERT_AFTER(neighbor, mon, sampling.cyclic.groupEntry);
+    else
+        LIST_INSERT_HEAD(&sg->monitoredItems, mon, sampling.cyclic.groupEntry);
+    mon->sampling.cyclic.group = sg;
+    sg->monitoredItemsSize++;
+    if(sg->monitoredItemsSize > sg->maxMonitoredItemsSize)
+        sg->maxMonitoredItemsSize = sg->monitoredItemsSize;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+UA_SamplingGroup_removeMonitoredItem(UA_Server *server, UA_MonitoredItem *mon) {
+    UA_SamplingGroup *sg = mon->sampling.cyclic.group;
+    UA_assert(sg);
+
+    /* Move the iterator forward if the group is currently sampled */
+    if(sg->nextSample == mon)
+        sg->nextSample = LIST_NEXT(mon, sampling.cyclic.groupEntry);
+
+    LIST_REMOVE(mon, sampling.cyclic.groupEntry);
+    mon->sampling.cyclic.group = NULL;
+    sg->monitoredItemsSize--;
+
+    /* Remove the empty group. If the group is currently sampled, it is removed
+     * at the end of the sampling callback. */
+    if(LIST_EMPTY(&sg->monitoredItems) && !sg->sampling)
+        UA_SamplingGroup_delete(server, sg);
+}
+
 UA_StatusCode
 UA_MonitoredItem_registerSampling(UA_Server *server, UA_MonitoredItem *mon) {
     UA_LOCK_ASSERT(&server->serviceMutex);
@@ -1601,13 +1751,10 @@ UA_MonitoredItem_registerSampling(UA_Server *server, UA_MonitoredItem *mon) {
                          sampling.subscriptionSampling);
         mon->samplingType = UA_MONITOREDITEMSAMPLINGTYPE_PUBLISH;
     } else {
-        /* DataChange MonitoredItems with a positive sampling interval have a
-         * repeated callback. Other MonitoredItems are attached to the Node in a
-         * linked list of backpointers. */
-        res = addRepeatedCallback(server,
-                                  (UA_ServerCallback)UA_MonitoredItem_lockAndSample,
-                                  mon, mon->parameters.samplingInterval,
-                                  &mon->sampling.callbackId);
+        /* DataChange MonitoredItems with a positive sampling interval are
+         * added to the SamplingGroup for their interval. The group has a shared
+         * repeated callback. */
+        res = UA_SamplingGroup_addMonitoredItem(server, mon);
         if(res == UA_STATUSCODE_GOOD)
             mon->samplingType = UA_MONITOREDITEMSAMPLINGTYPE_CYCLIC;
     }
@@ -1621,8 +1768,8 @@ UA_MonitoredItem_unregisterSampling(UA_Server *server, UA_MonitoredItem *mon) {
 
     switch(mon->samplingType) {
     case UA_MONITOREDITEMSAMPLINGTYPE_CYCLIC:
-        /* Remove repeated callback */
-        removeCallback(server, mon->sampling.callbackId);
+        /* Remove from the SamplingGroup */
+        UA_SamplingGroup_removeMonitoredItem(server, mon);
         break;
 
     case UA_MONITOREDITEMSAMPLINGTYPE_EVENT: {
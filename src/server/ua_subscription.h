@@ -155,7 +155,10 @@ struct UA_MonitoredItem {
     /* Sampling */
     UA_MonitoredItemSamplingType samplingType;
     union {
-        UA_UInt64 callbackId;
+        struct {
+            struct UA_SamplingGroup *group;
+            LIST_ENTRY(UA_MonitoredItem) groupEntry;
+        } cyclic; /* Cyclic: Member of a SamplingGroup */
         UA_MonitoredItem *nodeListNext; /* Event-Based: Attached to Node */
         LIST_ENTRY(UA_MonitoredItem) subscriptionSampling; /* Linked to publish
                                                             * interval */
@@ -173,6 +176,12 @@ struct UA_MonitoredItem {
                        * (maximum) queueSize in the parameters. */
     size_t eventOverflows; /* Separate counter for the queue. Can at most double
                             * the queue size */
+
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    /* Compiled EventFilter, shared with the MonitoredItems that have an
+     * identical filter. Set for Event-MonitoredItems only. */
+    struct UA_EventFilterProgram *eventProgram;
+#endif
 };
 
 void UA_MonitoredItem_init(UA_MonitoredItem *mon);
@@ -195,6 +204,13 @@ UA_MonitoredItem_setMonitoringMode(UA_Server *server, UA_MonitoredItem *mon,
 void
 UA_MonitoredItem_sample(UA_Server *server, UA_MonitoredItem *mon);
 
+/* Sample with a node that was already resolved by the caller (can be NULL if
+ * the node does not exist). Values from callback value sources are still read
+ * with the (possibly async) read of the node. */
+void
+UA_MonitoredItem_sampleWithNode(UA_Server *server, UA_MonitoredItem *mon,
+                                const UA_Node *node);
+
 /* Do not use the value after calling this. It will be moved to mon or freed. */
 void
 UA_MonitoredItem_processSampledValue(UA_Server *server, UA_MonitoredItem *mon,
@@ -216,6 +232,42 @@ UA_MonitoredItem_createDataChangeNotification(UA_Server *server, UA_MonitoredIte
  * data if required. */
 void UA_MonitoredItem_ensureQueueSpace(UA_Server *server, UA_MonitoredItem *mon);
 
+/******************/
+/* SamplingGroups */
+/******************/
+
+/* MonitoredItems with a cyclic sampling interval are grouped server-wide
+ * according to their (revised) sampling interval. Each SamplingGroup registers
+ * a single repeated callback. In the callback the server lock is taken once and
+ * all MonitoredItems of the group are sampled in one go. So all MonitoredItems
+ * of a group are sampled in the same phase. The group is removed with its last
+ * MonitoredItem.
+ *
+ * MonitoredItems for the same node and attribute are kept adjacent in the
+ * group. During sampling, the node is then resolved once from the Nodestore and
+ * the node pointer is shared by the neighboring MonitoredItems. The node is not
+ * kept beyond the sampling cycle, as the Nodestore can replace it at any time. */
+typedef struct UA_SamplingGroup {
+    LIST_ENTRY(UA_SamplingGroup) listEntry;
+    UA_Double samplingInterval;
+    UA_UInt64 callbackId;
+
+    LIST_HEAD(, UA_MonitoredItem) monitoredItems;
+    UA_UInt32 monitoredItemsSize;
+
+    /* The next MonitoredItem to be sampled. MonitoredItems can be removed from
+     * the group while it is being sampled (e.g. from the callback of a local
+     * MonitoredItem). Then the iterator is moved forward. */
+    UA_MonitoredItem *nextSample;
+    UA_Boolean sampling;
+
+    /* Statistics */
+    UA_UInt32 maxMonitoredItemsSize;
+    UA_UInt64 samplingCycles;
+    UA_UInt64 samplesCount;
+    UA_UInt64 nodeLookups;
+} UA_SamplingGroup;
+
 /****************/
 /* Subscription */
 /****************/
@@ -372,12 +424,48 @@ UA_StatusCode
 createEvent(UA_Server *server, const UA_EventDescription *ed,
             UA_ByteString *outEventId);
 
+/* Compiled EventFilter
+ * --------------------
+ * EventFilters are compiled when an Event-MonitoredItem is created (or its
+ * filter is modified). The where-clause becomes a flat list of instructions in
+ * evaluation order. The SimpleAttributeOperands are printed to the keys for the
+ * event field lookup and their IndexRange is parsed in advance. So no
+ * ContentFilter tree is walked and no operand is printed during the evaluation.
+ *
+ * MonitoredItems with an identical EventFilter share the same program. The
+ * programs are reference-counted and registered server-wide. When an event is
+ * emitted, every distinct program is evaluated once and the result is fanned
+ * out to the MonitoredItems. Unless the evaluation has read from the
+ * information model with the access rights of the Session. Then the result is
+ * only shared between the MonitoredItems of the same Session. */
+
+struct UA_EventFilterProgram;
+typedef struct UA_EventFilterProgram UA_EventFilterProgram;
+
+/* Get the program for an identical EventFilter from the server or compile and
+ * register a new one. The reference count is increased. */
+UA_StatusCode
+UA_EventFilterProgram_acquire(UA_Server *server, const UA_EventFilter *filter,
+                              UA_EventFilterProgram **program);
+
+/* Decrease the reference count. Removed with the last reference. */
+void
+UA_EventFilterProgram_release(UA_Server *server, UA_EventFilterProgram *program);
+
 typedef struct {
     UA_Server *server;
     UA_Session *session;
     UA_EventDescription ed; /* shallow copy */
     UA_EventFilter filter;  /* shallow copy */
 
+    /* The compiled filter. If NULL, the filter is compiled from the above
+     * (shallow copy) for each evaluation. */
+    const UA_EventFilterProgram *program;
+
+    /* Set during the evaluation if a value was read with the access rights of
+     * the session. Then the result cannot be shared with other sessions. */
+    UA_Boolean sessionDependent;
+
     /* Don't reread or regenerate values that have already been gotten during
      * the same filter evaluation */
     UA_KeyValueMap fieldCache;
@@ -15,65 +15,6 @@
 
 #ifdef UA_ENABLE_SUBSCRIPTIONS /* conditional compilation */
 
-/* Detect value changes outside the deadband */
-#define UA_DETECT_DEADBAND(TYPE) do {                           \
-    TYPE v1 = *(const TYPE*)data1;                              \
-    TYPE v2 = *(const TYPE*)data2;                              \
-    TYPE diff = (v1 > v2) ? (TYPE)(v1 - v2) : (TYPE)(v2 - v1);  \
-    return ((UA_Double)diff > deadband);                        \
-} while(false)
-
-static UA_Boolean
-detectScalarDeadBand(const void *data1, const void *data2,
-                     const UA_DataType *type, const UA_Double deadband) {
-    if(type->typeKind == UA_DATATYPEKIND_SBYTE) {
-        UA_DETECT_DEADBAND(UA_SByte);
-    } else if(type->typeKind == UA_DATATYPEKIND_BYTE) {
-        UA_DETECT_DEADBAND(UA_Byte);
-    } else if(type->typeKind == UA_DATATYPEKIND_INT16) {
-        UA_DETECT_DEADBAND(UA_Int16);
-    } else if(type->typeKind == UA_DATATYPEKIND_UINT16) {
-        UA_DETECT_DEADBAND(UA_UInt16);
-    } else if(type->typeKind == UA_DATATYPEKIND_INT32) {
-        UA_DETECT_DEADBAND(UA_Int32);
-    } else if(type->typeKind == UA_DATATYPEKIND_UINT32) {
-        UA_DETECT_DEADBAND(UA_UInt32);
-    } else if(type->typeKind == UA_DATATYPEKIND_INT64) {
-        UA_DETECT_DEADBAND(UA_Int64);
-    } else if(type->typeKind == UA_DATATYPEKIND_UINT64) {
-        UA_DETECT_DEADBAND(UA_UInt64);
-    } else if(type->typeKind == UA_DATATYPEKIND_FLOAT) {
-        UA_DETECT_DEADBAND(UA_Float);
-    } else if(type->typeKind == UA_DATATYPEKIND_DOUBLE) {
-        UA_DETECT_DEADBAND(UA_Double);
-    } else {
-        return false; /* Not a known numerical type */
-    }
-}
-
-static UA_Boolean
-detectVariantDeadband(const UA_Variant *value, const UA_Variant *oldValue,
-                      const UA_Double deadbandValue) {
-    if(value->arrayLength != oldValue->arrayLength)
-        return true;
-    if(value->type != oldValue->type)
-        return true;
-    size_t length = 1;
-    if(!UA_Variant_isScalar(value))
-        length = value->arrayLength;
-    uintptr_t data = (uintptr_t)value->data;
-    uintptr_t oldData = (uintptr_t)oldValue->data;
-    UA_UInt32 memSize = value->type->memSize;
-    for(size_t i = 0; i < length; ++i) {
-        if(detectScalarDeadBand((const void*)data, (const void*)oldData,
-                                value->type, deadbandValue))
-            return true;
-        data += memSize;
-        oldData += memSize;
-    }
-    return false;
-}
-
 static UA_Boolean
 detectValueChange(UA_Server *server, UA_MonitoredItem *mon, const UA_DataValue *dv) {
     UA_LOCK_ASSERT(&server->serviceMutex);
@@ -208,7 +149,8 @@ processMonitoredItemAsyncRead(UA_Server *server, UA_MonitoredItem *mon,
 }
 
 void
-UA_MonitoredItem_sample(UA_Server *server, UA_MonitoredItem *mon) {
+UA_MonitoredItem_sampleWithNode(UA_Server *server, UA_MonitoredItem *mon,
+                                const UA_Node *node) {
     UA_LOCK_ASSERT(&server->serviceMutex);
     UA_assert(mon->itemToMonitor.attributeId != UA_ATTRIBUTEID_EVENTNOTIFIER);
 
@@ -221,6 +163,21 @@ UA_MonitoredItem_sample(UA_Server *server, UA_MonitoredItem *mon) {
      * readWithSession returns the error-code BADUSERACCESSDENIED. */
     UA_Session *session = (sub) ? sub->session : &server->adminSession;
 
+    /* Fast path: Read synchronously into a DataValue on the stack */
+    UA_DataValue dv;
+    UA_DataValue_init(&dv);
+    if(!node) {
+        dv.hasStatus = true;
+        dv.status = UA_STATUSCODE_BADNODEIDUNKNOWN;
+        UA_MonitoredItem_processSampledValue(server, mon, &dv);
+        return;
+    }
+    if(readWithNodeSync(server, session, node, mon->timestampsToReturn,
+                        &mon->itemToMonitor, &dv)) {
+        UA_MonitoredItem_processSampledValue(server, mon, &dv);
+        return;
+    }
+
     /* Read the value possibly asynchronous */
     UA_StatusCode res = UA_STATUSCODE_BADTOOMANYOPERATIONS;
     if(UA_LIKELY(mon->outstandingAsyncReads < UA_MONITOREDITEM_ASYNC_MAX)) {
@@ -231,12 +188,19 @@ UA_MonitoredItem_sample(UA_Server *server, UA_MonitoredItem *mon) {
         mon->outstandingAsyncReads++;
     } else {
         /* Reading failed, process with the StatusCode */
-        UA_DataValue dv;
-        UA_DataValue_init(&dv);
         dv.hasStatus = true;
         dv.status = res;
         UA_MonitoredItem_processSampledValue(server, mon, &dv);
     }
 }
 
+void
+UA_MonitoredItem_sample(UA_Server *server, UA_MonitoredItem *mon) {
+    UA_LOCK_ASSERT(&server->serviceMutex);
+    const UA_Node *node = getNodeForRead(server, &mon->itemToMonitor);
+    UA_MonitoredItem_sampleWithNode(server, mon, node);
+    if(node)
+        UA_NODESTORE_RELEASE(server, node);
+}
+
 #endif /* UA_ENABLE_SUBSCRIPTIONS */
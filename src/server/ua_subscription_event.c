@@ -23,6 +23,9 @@ readSAOfromEventInstance(UA_FilterEvalContext *ctx,
     if(!ei)
         return UA_STATUSCODE_BADINVALIDARGUMENT;
 
+    /* The value is read with the access rights of the session */
+    ctx->sessionDependent = true;
+
     /* Prepare the ReadValueId */
     UA_ReadValueId rvi;
     UA_ReadValueId_init(&rvi);
@@ -114,6 +117,8 @@ UA_FilterEvalContext_reset(UA_FilterEvalContext *ctx) {
      * the random-id bytes for the next evaluation. */
     if(ctx->eventId.data != ctx->eventIdBuf)
         UA_ByteString_init(&ctx->eventId);
+
+    ctx->sessionDependent = false;
 }
 
 UA_StatusCode
@@ -175,85 +180,199 @@ cacheEventId(UA_FilterEvalContext *ctx) {
     return UA_STATUSCODE_GOOD;
 }
 
-/* Can return an in-situ value. Check for UA_VARIANT_DATA_NODELETE. */
-UA_StatusCode
-resolveSAO(UA_FilterEvalContext *ctx, const UA_SimpleAttributeOperand *sao,
-           UA_Variant *out) {
-    /* Print the SAO as a human-readable string. We are using the
-     * TypeDefinitionId initially to disambiguate properties with the same
-     * BrowseName but from different EventTypes. The we try again wtih the
-     * TypeDefinitionId disabled. */
-    UA_StatusCode res = UA_STATUSCODE_GOOD;
-    const UA_EventDescription *ed = &ctx->ed;
-    const UA_Variant *found;
-    UA_Byte pathBuf[512];
-    UA_QualifiedName pathString = {0, {512, pathBuf}};
-    UA_SimpleAttributeOperand tmp_sao = *sao;
+/*********************/
+/* Compiled Operands */
+/*********************/
+
+/* SimpleAttributeOperand with the keys for the event field lookup printed in
+ * advance */
+typedef struct {
+    const UA_SimpleAttributeOperand *sao;
+    UA_QualifiedName path;     /* Printed with the TypeDefinitionId */
+    UA_QualifiedName basePath; /* Printed with the BaseEventType as the
+                                * TypeDefinitionId (if different) */
+    UA_Boolean hasBasePath;
+    UA_Boolean pathIsEventId;
+    size_t mandatory;          /* Index of the last printed path in the
+                                * mandatoryEventProperties. Or
+                                * MANDATORY_EVENT_PROPERTIES_COUNT. */
+    UA_StatusCode rangeStatus; /* Result of parsing the IndexRange */
+    UA_NumericRange range;
+} UA_CompiledSAO;
+
+typedef enum {
+    UA_FILTEROPERANDKIND_INVALID = 0,
+    UA_FILTEROPERANDKIND_ELEMENT, /* Result of a prior operator */
+    UA_FILTEROPERANDKIND_LITERAL,
+    UA_FILTEROPERANDKIND_SAO
+} UA_FilterOperandKind;
+
+typedef struct {
+    UA_FilterOperandKind kind;
+    union {
+        size_t element;
+        const UA_Variant *literal;
+        const UA_CompiledSAO *sao;
+    } content;
+} UA_FilterOperand;
+
+struct UA_FilterInstruction;
+typedef UA_StatusCode
+(*UA_FilterOperatorMethod)(UA_FilterEvalContext *ctx,
+                           const struct UA_FilterInstruction *ins);
+
+typedef struct UA_FilterInstruction {
+    UA_FilterOperatorMethod method;
+    size_t element; /* Index of the ContentFilterElement and its result */
+    size_t operandsSize;
+    const UA_FilterOperand *operands;
+} UA_FilterInstruction;
+
+struct UA_EventFilterProgram {
+    LIST_ENTRY(UA_EventFilterProgram) listEntry;
+    size_t refCount;
+    UA_UInt32 hash;        /* Of the binary-encoded filter */
+    UA_EventFilter filter; /* The compiled operands point into the filter */
+
+    /* The where-clause in evaluation order */
+    size_t instructionsSize;
+    UA_FilterInstruction *instructions;
+    UA_FilterOperand *operands; /* Operands of all instructions */
+
+    /* The select-clauses first, then the operands of the where-clause */
+    size_t selectSize;
+    size_t saosSize;
+    UA_CompiledSAO *saos;
+
+    /* Position of the shared result for the event that is currently emitted.
+     * See createEvent. */
+    UA_UInt64 eventEpoch;
+    size_t eventSlot;
+};
+
+static void
+UA_CompiledSAO_clear(UA_CompiledSAO *csao) {
+    UA_QualifiedName_clear(&csao->path);
+    UA_QualifiedName_clear(&csao->basePath);
+    UA_free(csao->range.dimensions);
+    memset(csao, 0, sizeof(UA_CompiledSAO));
+}
+
+static size_t
+mandatoryEventPropertyIndex(const UA_String *path) {
+    size_t i = 0;
+    for(; i < MANDATORY_EVENT_PROPERTIES_COUNT; i++) {
+        if(UA_String_equal(path, &mandatoryEventProperties[i]))
+            break;
+    }
+    return i;
+}
+
+/* Print the SAO as a human-readable string. We are using the TypeDefinitionId
+ * initially to disambiguate properties with the same BrowseName but from
+ * different EventTypes. The second string is printed with the TypeDefinitionId
+ * disabled for the fallback lookup. */
+static UA_StatusCode
+UA_CompiledSAO_compile(UA_CompiledSAO *csao, const UA_SimpleAttributeOperand *sao) {
     static UA_NodeId baseEventTypeId = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_BASEEVENTTYPE}};
+    memset(csao, 0, sizeof(UA_CompiledSAO));
+    csao->sao = sao;
 
+    UA_SimpleAttributeOperand tmp_sao = *sao;
     if(UA_NodeId_isNull(&tmp_sao.typeDefinitionId))
         tmp_sao.typeDefinitionId = baseEventTypeId;
-
- search_again:
-    res = UA_SimpleAttributeOperand_print(&tmp_sao, &pathString.name);
+    UA_StatusCode res = UA_SimpleAttributeOperand_print(&tmp_sao, &csao->path.name);
     if(res != UA_STATUSCODE_GOOD)
         return res;
+    const UA_String *last = &csao->path.name;
 
-    /* Special Case: EventId (generated only once per Event, ignores the IndexRange) */
-    if(UA_String_equal(&pathString.name, &mandatoryEventProperties[0])) {
-        res = cacheEventId(ctx);
-        if(res != UA_STATUSCODE_GOOD)
+    if(!UA_NodeId_equal(&tmp_sao.typeDefinitionId, &baseEventTypeId)) {
+        tmp_sao.typeDefinitionId = baseEventTypeId;
+        res = UA_SimpleAttributeOperand_print(&tmp_sao, &csao->basePath.name);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_CompiledSAO_clear(csao);
             return res;
-        UA_Variant_setScalar(out, &ctx->eventId, &UA_TYPES[UA_TYPES_BYTESTRING]);
-        out->storageType = UA_VARIANT_DATA_NODELETE;
-        return UA_STATUSCODE_GOOD;
+        }
+        csao->hasBasePath = true;
+        last = &csao->basePath.name;
     }
 
-    /* Source 1: Use the SAO-string to look up from the user-defined key-value
-     * map (and from the cache) */
-    found = UA_KeyValueMap_get(ed->eventFields, pathString);
+    csao->pathIsEventId = UA_String_equal(&csao->path.name, &mandatoryEventProperties[0]);
+    csao->mandatory = mandatoryEventPropertyIndex(last);
+
+    /* A malformed IndexRange is reported during the evaluation */
+    if(sao->indexRange.length > 0) {
+        csao->rangeStatus = UA_NumericRange_parse(&csao->range, sao->indexRange);
+        if(csao->rangeStatus != UA_STATUSCODE_GOOD)
+            memset(&csao->range, 0, sizeof(UA_NumericRange));
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+resolveEventId(UA_FilterEvalContext *ctx, UA_Variant *out) {
+    UA_StatusCode res = cacheEventId(ctx);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    UA_Variant_setScalar(out, &ctx->eventId, &UA_TYPES[UA_TYPES_BYTESTRING]);
+    out->storageType = UA_VARIANT_DATA_NODELETE;
+    return UA_STATUSCODE_GOOD;
+}
+
+static const UA_Variant *
+lookupEventField(UA_FilterEvalContext *ctx, const UA_QualifiedName path) {
+    const UA_Variant *found = UA_KeyValueMap_get(ctx->ed.eventFields, path);
     if(!found)
-        found = UA_KeyValueMap_get(&ctx->fieldCache, pathString);
+        found = UA_KeyValueMap_get(&ctx->fieldCache, path);
+    return found;
+}
+
+/* Can return an in-situ value. Check for UA_VARIANT_DATA_NODELETE. */
+static UA_StatusCode
+resolveCompiledSAO(UA_FilterEvalContext *ctx, const UA_CompiledSAO *csao,
+                   UA_Variant *out) {
+    const UA_EventDescription *ed = &ctx->ed;
+
+    /* Special Case: EventId (generated only once per Event, ignores the IndexRange) */
+    if(csao->pathIsEventId)
+        return resolveEventId(ctx, out);
+
+    /* Source 1: Use the SAO-string to look up from the user-defined key-value
+     * map (and from the cache). If not found, try again with the SAO-string
+     * without the TypeDefinitionId prefix. */
+    const UA_Variant *found = lookupEventField(ctx, csao->path);
+    if(!found && csao->hasBasePath) {
+        if(csao->mandatory == 0)
+            return resolveEventId(ctx, out);
+        found = lookupEventField(ctx, csao->basePath);
+    }
     if(found) {
-        if(sao->indexRange.length == 0) {
+        if(csao->sao->indexRange.length == 0) {
             *out = *found;
             out->storageType = UA_VARIANT_DATA_NODELETE;
-        } else {
-            UA_NumericRange range;
-            res = UA_NumericRange_parse(&range, sao->indexRange);
-            if(res != UA_STATUSCODE_GOOD)
-               return res;
-            res = UA_Variant_copyRange(found, out, range);
-            UA_free(range.dimensions);
+            return UA_STATUSCODE_GOOD;
         }
-        return res;
-    }
-
-    /* Not found. Print the SAO again with BaseEventTypeId as the
-     * TypeDefinitionId and try again. This removes any TypeDefinitionId prefix
-     * from the printed SAO-string. */
-    if(!UA_NodeId_equal(&tmp_sao.typeDefinitionId, &baseEventTypeId)) {
-        tmp_sao.typeDefinitionId = baseEventTypeId;
-        goto search_again;
+        if(csao->rangeStatus != UA_STATUSCODE_GOOD)
+            return csao->rangeStatus;
+        return UA_Variant_copyRange(found, out, csao->range);
     }
 
     /* Source 2: Read from the information model */
-    res = readSAOfromEventInstance(ctx, sao, out);
+    UA_StatusCode res = readSAOfromEventInstance(ctx, csao->sao, out);
     if(res == UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_GOOD;
 
     /* Source 3: Use a default for the mandatory fields of the BaseEventType.
      * Here we ignore the IndexRange. */
-    UA_String_init(&tmp_sao.indexRange); /* No index range allowed */
-    if(UA_String_equal(&pathString.name, &mandatoryEventProperties[1])) {
-        /* EventType */
+    switch(csao->mandatory) {
+    case 1: /* EventType */
         return UA_Variant_setScalarCopy(out, &ed->eventType, &UA_TYPES[UA_TYPES_NODEID]);
-    } else if(UA_String_equal(&pathString.name, &mandatoryEventProperties[2])) {
-        /* SourceNode */
+    case 2: /* SourceNode */
         return UA_Variant_setScalarCopy(out, &ed->sourceNode, &UA_TYPES[UA_TYPES_NODEID]);
-    } else if(UA_String_equal(&pathString.name, &mandatoryEventProperties[3])) {
-        /* SourceName. Read the DisplayName from the information model. This
-         * uses the locale of the session. */
+    case 3: { /* SourceName */
+        /* Read the DisplayName from the information model. This uses the
+         * locale of the session. */
+        ctx->sessionDependent = true;
         UA_ReadValueId rvi;
         UA_ReadValueId_init(&rvi);
         rvi.nodeId = ed->sourceNode;
@@ -273,24 +392,38 @@ resolveSAO(UA_FilterEvalContext *ctx, const UA_SimpleAttributeOperand *sao,
         res = UA_Variant_setScalarCopy(out, &displayName->text, &UA_TYPES[UA_TYPES_STRING]);
         UA_DataValue_clear(&dv);
         return res;
-    } else if(UA_String_equal(&pathString.name, &mandatoryEventProperties[4]) ||
-              UA_String_equal(&pathString.name, &mandatoryEventProperties[5])) {
-        /* Time / ReceiveTime */
+    }
+    case 4: /* Time */
+    case 5: { /* ReceiveTime */
         UA_EventLoop *el = ctx->server->config.eventLoop;
         UA_DateTime rcvTime = el->dateTime_now(el);
         return UA_Variant_setScalarCopy(out, &rcvTime, &UA_TYPES[UA_TYPES_DATETIME]);
-    } else if(UA_String_equal(&pathString.name, &mandatoryEventProperties[6])) {
-        /* Message */
+    }
+    case 6: /* Message */
         return UA_Variant_setScalarCopy(out, &ed->message, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
-    } else if(UA_String_equal(&pathString.name, &mandatoryEventProperties[7])) {
-        /* Severity */
+    case 7: /* Severity */
         return UA_Variant_setScalarCopy(out, &ed->severity, &UA_TYPES[UA_TYPES_UINT16]);
+    default:
+        break;
     }
 
     /* Not found, return an empty Variant */
     return UA_STATUSCODE_GOOD;
 }
 
+/* Can return an in-situ value. Check for UA_VARIANT_DATA_NODELETE. */
+UA_StatusCode
+resolveSAO(UA_FilterEvalContext *ctx, const UA_SimpleAttributeOperand *sao,
+           UA_Variant *out) {
+    UA_CompiledSAO csao;
+    UA_StatusCode res = UA_CompiledSAO_compile(&csao, sao);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    res = resolveCompiledSAO(ctx, &csao, out);
+    UA_CompiledSAO_clear(&csao);
+    return res;
+}
+
 /***************************/
 /* Where-Clause Evaluation */
 /***************************/
@@ -734,59 +867,48 @@ castImplicit(const UA_Variant *in, const UA_DataType *outType, UA_Variant *out)
  * ----------------- */
 
 static UA_StatusCode
-resolveOperand(UA_FilterEvalContext *ctx, UA_ExtensionObject *op, UA_Variant *out) {
-    if(op->encoding != UA_EXTENSIONOBJECT_DECODED &&
-       op->encoding != UA_EXTENSIONOBJECT_DECODED_NODELETE)
-        return UA_STATUSCODE_BADFILTEROPERATORUNSUPPORTED;
-
-    /* Result of an operator that was evaluated prior */
-    if(op->content.decoded.type == &UA_TYPES[UA_TYPES_ELEMENTOPERAND]) {
-        UA_ElementOperand *eo = (UA_ElementOperand*)op->content.decoded.data;
-        *out = ctx->operatorResults[eo->index];
+resolveOperand(UA_FilterEvalContext *ctx, const UA_FilterOperand *op, UA_Variant *out) {
+    switch(op->kind) {
+    case UA_FILTEROPERANDKIND_ELEMENT:
+        /* Result of an operator that was evaluated prior */
+        *out = ctx->operatorResults[op->content.element];
         out->storageType = UA_VARIANT_DATA_NODELETE;
         return UA_STATUSCODE_GOOD;
-    }
-
-    /* Literal value */
-    if(op->content.decoded.type == &UA_TYPES[UA_TYPES_LITERALOPERAND]) {
-        UA_LiteralOperand *lo = (UA_LiteralOperand*)op->content.decoded.data;
-        *out = lo->value;
+    case UA_FILTEROPERANDKIND_LITERAL:
+        *out = *op->content.literal;
         out->storageType = UA_VARIANT_DATA_NODELETE;
         return UA_STATUSCODE_GOOD;
+    case UA_FILTEROPERANDKIND_SAO:
+        return resolveCompiledSAO(ctx, op->content.sao, out);
+    default:
+        return UA_STATUSCODE_BADFILTEROPERATORUNSUPPORTED;
     }
-
-    /* SimpleAttributeOperand with a BrowsePath */
-    if(op->content.decoded.type == &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]) {
-        UA_SimpleAttributeOperand *sao =
-            (UA_SimpleAttributeOperand*)op->content.decoded.data;
-        return resolveSAO(ctx, sao, out);
-    }
-
-    return UA_STATUSCODE_BADFILTEROPERATORUNSUPPORTED;
 }
 
+/* The /EventType field for the OfType operator */
+static UA_QualifiedName eventTypeName = {0, UA_STRING_STATIC("EventType")};
+static const UA_SimpleAttributeOperand eventTypeSAO =
+    {{0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_BASEEVENTTYPE}}, 1, &eventTypeName,
+     UA_ATTRIBUTEID_VALUE, {0, NULL}};
+static const UA_CompiledSAO eventTypeOperand =
+    {&eventTypeSAO, {0, UA_STRING_STATIC("/EventType")}, {0, {0, NULL}},
+     false, false, 1, UA_STATUSCODE_GOOD, {0, NULL}};
+
 static UA_StatusCode
-ofTypeOperator(UA_FilterEvalContext *ctx, size_t index) {
-    const UA_ContentFilterElement *elm = &ctx->filter.whereClause.elements[index];
-    UA_assert(elm->filterOperandsSize == 1);
+ofTypeOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *ins) {
+    UA_assert(ins->operandsSize == 1);
 
     /* Get the operand. Must be a literal NodeId */
     UA_Variant *op0 = &ctx->operandStack[ctx->top++];
-    UA_StatusCode res = resolveOperand(ctx, &elm->filterOperands[0], op0);
+    UA_StatusCode res = resolveOperand(ctx, &ins->operands[0], op0);
     if(res != UA_STATUSCODE_GOOD || !UA_Variant_hasScalarType(op0, &UA_TYPES[UA_TYPES_NODEID]))
         return UA_STATUSCODE_BADFILTEROPERANDINVALID;
     const UA_NodeId *operandTypeId = (const UA_NodeId *)op0->data;
 
     /* Read the /EventType event field */
-    static UA_QualifiedName eventTypeName = {0, UA_STRING_STATIC("EventType")};
-    UA_SimpleAttributeOperand sao;
-    UA_SimpleAttributeOperand_init(&sao);
-    sao.attributeId = UA_ATTRIBUTEID_VALUE;
-    sao.browsePath = &eventTypeName;
-    sao.browsePathSize = 1;
     UA_Variant eventType;
     UA_Variant_init(&eventType);
-    res = resolveSAO(ctx, &sao, &eventType);
+    res = resolveCompiledSAO(ctx, &eventTypeOperand, &eventType);
     if(res != UA_STATUSCODE_GOOD)
         return res;
     if(!UA_Variant_hasScalarType(&eventType, &UA_TYPES[UA_TYPES_NODEID])) {
@@ -798,64 +920,61 @@ ofTypeOperator(UA_FilterEvalContext *ctx, size_t index) {
     UA_Boolean ofType =
         isNodeInTree_singleRef(ctx->server, (UA_NodeId*)eventType.data, operandTypeId,
                                UA_REFERENCETYPEINDEX_HASSUBTYPE);
-    ctx->operatorResults[index] = t2v(ofType ? UA_TERNARY_TRUE : UA_TERNARY_FALSE);
+    ctx->operatorResults[ins->element] = t2v(ofType ? UA_TERNARY_TRUE : UA_TERNARY_FALSE);
     UA_Variant_clear(&eventType);
     return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
-andOperator(UA_FilterEvalContext *ctx, size_t index) {
-    const UA_ContentFilterElement *elm = &ctx->filter.whereClause.elements[index];
-    UA_assert(elm->filterOperandsSize == 2);
+andOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *ins) {
+    UA_assert(ins->operandsSize == 2);
     UA_Variant *op0 = &ctx->operandStack[ctx->top++];
-    UA_StatusCode res = resolveOperand(ctx, &elm->filterOperands[0], op0);
+    UA_StatusCode res = resolveOperand(ctx, &ins->operands[0], op0);
     UA_CHECK_STATUS(res, return res);
     UA_Variant *op1 = &ctx->operandStack[ctx->top++];
-    res = resolveOperand(ctx, &elm->filterOperands[1], op1);
+    res = resolveOperand(ctx, &ins->operands[1], op1);
     UA_CHECK_STATUS(res, return res);
-    ctx->operatorResults[index] = t2v(UA_Ternary_and(v2t(op0), v2t(op1)));
+    ctx->operatorResults[ins->element] = t2v(UA_Ternary_and(v2t(op0), v2t(op1)));
     return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
-orOperator(UA_FilterEvalContext *ctx, size_t index) {
-    const UA_ContentFilterElement *elm = &ctx->filter.whereClause.elements[index];
-    UA_assert(elm->filterOperandsSize == 2);
+orOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *ins) {
+    UA_assert(ins->operandsSize == 2);
     UA_Variant *op0 = &ctx->operandStack[ctx->top++];
-    UA_StatusCode res = resolveOperand(ctx, &elm->filterOperands[0], op0);
+    UA_StatusCode res = resolveOperand(ctx, &ins->operands[0], op0);
     UA_CHECK_STATUS(res, return res);
     UA_Variant *op1 = &ctx->operandStack[ctx->top++];
-    res = resolveOperand(ctx, &elm->filterOperands[1], op1);
+    res = resolveOperand(ctx, &ins->operands[1], op1);
     UA_CHECK_STATUS(res, return res);
-    ctx->operatorResults[index] = t2v(UA_Ternary_or(v2t(op0), v2t(op1)));
+    ctx->operatorResults[ins->element] = t2v(UA_Ternary_or(v2t(op0), v2t(op1)));
     return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
-notOperator(UA_FilterEvalContext *ctx, size_t index) {
-    const UA_ContentFilterElement *elm = &ctx->filter.whereClause.elements[index];
-    UA_assert(elm->filterOperandsSize == 1);
+notOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *ins) {
+    UA_assert(ins->operandsSize == 1);
     UA_Variant *op0 = &ctx->operandStack[ctx->top++];
-    UA_StatusCode res = resolveOperand(ctx, &elm->filterOperands[0], op0);
+    UA_StatusCode res = resolveOperand(ctx, &ins->operands[0], op0);
     UA_CHECK_STATUS(res, return res);
-    ctx->operatorResults[index] = t2v(UA_Ternary_not(v2t(op0)));
+    ctx->operatorResults[ins->element] = t2v(UA_Ternary_not(v2t(op0)));
     return UA_STATUSCODE_GOOD;
 }
 
 /* Resolves the operands and casts them implicitly to the same type. The result
  * is set at &ctx->operandStack[ctx->top] (for the initial value of top). */
 static UA_StatusCode
-castResolveOperands(UA_FilterEvalContext *ctx, size_t index, UA_Boolean setError) {
+castResolveOperands(UA_FilterEvalContext *ctx, const UA_FilterInstruction *ins,
+                    UA_Boolean setError) {
     /* Enough space on the operand stack left? */
-    const UA_ContentFilterElement *elm = &ctx->filter.whereClause.elements[index];
-    if(ctx->top + elm->filterOperandsSize > UA_EVENTFILTER_MAXOPERANDS)
+    if(ctx->top + ins->operandsSize > UA_EVENTFILTER_MAXOPERANDS)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
     /* Resolve all operands */
     UA_assert(ctx->top == 0); /* Assume the operand stack is empty */
     UA_StatusCode res = UA_STATUSCODE_GOOD;
-    for(size_t i = 0; i < elm->filterOperandsSize; i++) {
-        res = resolveOperand(ctx, &elm->filterOperands[i], &ctx->operandStack[ctx->top++]);
+    for(size_t i = 0; i < ins->operandsSize; i++) {
+        res = resolveOperand(ctx, &ins->operands[i], &ctx->operandStack[ctx->top++]);
         UA_CHECK_STATUS(res, return res);
     }
     UA_assert(ctx->top > 0); /* Assume the operand stack is no longer empty */
@@ -888,16 +1007,17 @@ castResolveOperands(UA_FilterEvalContext *ctx, size_t index, UA_Boolean setError
 }
 
 static UA_StatusCode
-compareOperator(UA_FilterEvalContext *ctx, size_t index, UA_FilterOperator op) {
-    UA_assert(ctx->filter.whereClause.elements[index].filterOperandsSize == 2);
+compareOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *ins,
+                UA_FilterOperator op) {
+    UA_assert(ins->operandsSize == 2);
 
     /* Resolve and cast the operands. A failed casting results in FALSE. Note
      * that operands could cast to NULL. */
     UA_assert(ctx->top == 0); /* Assume the operand stack is empty */
-    UA_StatusCode res = castResolveOperands(ctx, index, false);
+    UA_StatusCode res = castResolveOperands(ctx, ins, false);
     if(res != UA_STATUSCODE_GOOD || !ctx->operandStack[0].type ||
        ctx->operandStack[0].type != ctx->operandStack[1].type) {
-        ctx->operatorResults[index] = t2v(UA_TERNARY_FALSE);
+        ctx->operatorResults[ins->element] = t2v(UA_TERNARY_FALSE);
         return UA_STATUSCODE_GOOD;
     }
     UA_assert(ctx->top == 2); /* Assume the operand stack is no longer empty */
@@ -939,42 +1059,43 @@ compareOperator(UA_FilterEvalContext *ctx, size_t index, UA_FilterOperator op) {
     }
 
     /* Set result as a literal value */
-    ctx->operatorResults[index] = t2v(operatorResult);
+    ctx->operatorResults[ins->element] = t2v(operatorResult);
     return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
-equalsOperator(UA_FilterEvalContext *ctx, size_t index) {
-    return compareOperator(ctx, index, UA_FILTEROPERATOR_EQUALS);
+equalsOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *ins) {
+    return compareOperator(ctx, ins, UA_FILTEROPERATOR_EQUALS);
 }
 
 static UA_StatusCode
-gtOperator(UA_FilterEvalContext *ctx, size_t index) {
-    return compareOperator(ctx, index, UA_FILTEROPERATOR_GREATERTHAN);
+gtOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *ins) {
+    return compareOperator(ctx, ins, UA_FILTEROPERATOR_GREATERTHAN);
 }
 
 static UA_StatusCode
-ltOperator(UA_FilterEvalContext *ctx, size_t index) {
-    return compareOperator(ctx, index, UA_FILTEROPERATOR_LESSTHAN);
+ltOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *ins) {
+    return compareOperator(ctx, ins, UA_FILTEROPERATOR_LESSTHAN);
 }
 
 static UA_StatusCode
-gteOperator(UA_FilterEvalContext *ctx, size_t index) {
-    return compareOperator(ctx, index, UA_FILTEROPERATOR_GREATERTHANOREQUAL);
+gteOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *ins) {
+    return compareOperator(ctx, ins, UA_FILTEROPERATOR_GREATERTHANOREQUAL);
 }
 
 static UA_StatusCode
-lteOperator(UA_FilterEvalContext *ctx, size_t index) {
-    return compareOperator(ctx, index, UA_FILTEROPERATOR_LESSTHANOREQUAL);
+lteOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *ins) {
+    return compareOperator(ctx, ins, UA_FILTEROPERATOR_LESSTHANOREQUAL);
 }
 
 static UA_StatusCode
-bitwiseOperator(UA_FilterEvalContext *ctx, size_t index, UA_FilterOperator op) {
-    UA_assert(ctx->filter.whereClause.elements[index].filterOperandsSize == 2);
+bitwiseOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *ins,
+                UA_FilterOperator op) {
+    UA_assert(ins->operandsSize == 2);
 
     /* Resolve and cast the operands. Note that operands could cast to NULL. */
     UA_assert(ctx->top == 0); /* Assume the operand stack is empty */
-    UA_StatusCode res = castResolveOperands(ctx, index, true);
+    UA_StatusCode res = castResolveOperands(ctx, ins, true);
     UA_CHECK_STATUS(res, return res);
     UA_assert(ctx->top == 2); /* Assume we have two elements */
 
@@ -985,11 +1106,11 @@ bitwiseOperator(UA_FilterEvalContext *ctx, size_t index, UA_FilterOperator op) {
         return UA_STATUSCODE_BADTYPEMISMATCH;
 
     /* Copy the casted literal to the result */
-    res = UA_Variant_copy(&ctx->operandStack[0], &ctx->operatorResults[index]);
+    res = UA_Variant_copy(&ctx->operandStack[0], &ctx->operatorResults[ins->element]);
     UA_CHECK_STATUS(res, return res);
 
     /* Do the bitwise operation on the result data */
-    UA_Byte *bytesOut = (UA_Byte*)ctx->operatorResults[index].data;
+    UA_Byte *bytesOut = (UA_Byte*)ctx->operatorResults[ins->element].data;
     const UA_Byte *bytes2 = (const UA_Byte*)ctx->operandStack[1].data;
     for(size_t i = 0; i < type->memSize; i++) {
         if(op == UA_FILTEROPERATOR_BITWISEAND)
@@ -1001,25 +1122,25 @@ bitwiseOperator(UA_FilterEvalContext *ctx, size_t index, UA_FilterOperator op) {
 }
 
 static UA_StatusCode
-bitwiseAndOperator(UA_FilterEvalContext *ctx, size_t index) {
-    return bitwiseOperator(ctx, index, UA_FILTEROPERATOR_BITWISEAND);
+bitwiseAndOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *ins) {
+    return bitwiseOperator(ctx, ins, UA_FILTEROPERATOR_BITWISEAND);
 }
 
 static UA_StatusCode
-bitwiseOrOperator(UA_FilterEvalContext *ctx, size_t index) {
-    return bitwiseOperator(ctx, index, UA_FILTEROPERATOR_BITWISEOR);
+bitwiseOrOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *ins) {
+    return bitwiseOperator(ctx, ins, UA_FILTEROPERATOR_BITWISEOR);
 }
 
 static UA_StatusCode
-betweenOperator(UA_FilterEvalContext *ctx, size_t index) {
-    UA_assert(ctx->filter.whereClause.elements[index].filterOperandsSize == 3);
+betweenOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *ins) {
+    UA_assert(ins->operandsSize == 3);
 
     /* If no implicit conversion is available and the operands are of different
      * types, the particular result is FALSE. */
     UA_assert(ctx->top == 0); /* Assume the operand stack is empty */
-    UA_StatusCode res = castResolveOperands(ctx, index, false);
+    UA_StatusCode res = castResolveOperands(ctx, ins, false);
     if(res != UA_STATUSCODE_GOOD) {
-        ctx->operatorResults[index] = t2v(UA_TERNARY_FALSE);
+        ctx->operatorResults[ins->element] = t2v(UA_TERNARY_FALSE);
         return UA_STATUSCODE_GOOD;
     }
     UA_assert(ctx->top == 3); /* Assume we have three elements */
@@ -1036,50 +1157,48 @@ betweenOperator(UA_FilterEvalContext *ctx, size_t index) {
                        (o2 == UA_ORDER_LESS || o2 == UA_ORDER_EQ)) ?
         UA_TERNARY_TRUE : UA_TERNARY_FALSE;
 
-    ctx->operatorResults[index] = t2v(comp);
+    ctx->operatorResults[ins->element] = t2v(comp);
     return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
-inListOperator(UA_FilterEvalContext *ctx, size_t index) {
-    const UA_ContentFilterElement *elm = &ctx->filter.whereClause.elements[index];
-    UA_assert(elm->filterOperandsSize >= 2);
+inListOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *ins) {
+    UA_assert(ins->operandsSize >= 2);
     UA_Boolean found = false;
     UA_Variant *op0 = &ctx->operandStack[ctx->top++];
     UA_Variant *op1 = &ctx->operandStack[ctx->top++];
-    UA_StatusCode res = resolveOperand(ctx, &elm->filterOperands[0], op0);
+    UA_StatusCode res = resolveOperand(ctx, &ins->operands[0], op0);
     UA_CHECK_STATUS(res, return res);
-    for(size_t i = 1; i < elm->filterOperandsSize && !found; i++) {
-        res = resolveOperand(ctx, &elm->filterOperands[i], op1);
+    for(size_t i = 1; i < ins->operandsSize && !found; i++) {
+        res = resolveOperand(ctx, &ins->operands[i], op1);
         if(res != UA_STATUSCODE_GOOD)
             continue;
         if(op0->type == op1->type && UA_equal(op0->data, op1->data, op0->type))
             found = true;
         UA_Variant_clear(op1);
     }
-    ctx->operatorResults[index] = t2v((found) ? UA_TERNARY_TRUE: UA_TERNARY_FALSE);
+    ctx->operatorResults[ins->element] = t2v((found) ? UA_TERNARY_TRUE: UA_TERNARY_FALSE);
     return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
-isNullOperator(UA_FilterEvalContext *ctx, size_t index) {
-    const UA_ContentFilterElement *elm = &ctx->filter.whereClause.elements[index];
-    UA_assert(elm->filterOperandsSize == 1);
+isNullOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *ins) {
+    UA_assert(ins->operandsSize == 1);
     UA_Variant *op0 = &ctx->operandStack[ctx->top++];
-    UA_StatusCode res = resolveOperand(ctx, &elm->filterOperands[0], op0);
+    UA_StatusCode res = resolveOperand(ctx, &ins->operands[0], op0);
     UA_CHECK_STATUS(res, return res);
-    ctx->operatorResults[index] =
+    ctx->operatorResults[ins->element] =
         t2v(UA_Variant_isEmpty(op0) ? UA_TERNARY_TRUE : UA_TERNARY_FALSE);
     return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
-notImplementedOperator(UA_FilterEvalContext *ctx, size_t index) {
+notImplementedOperator(UA_FilterEvalContext *ctx, const UA_FilterInstruction *ins) {
     return UA_STATUSCODE_BADFILTEROPERATORUNSUPPORTED;
 }
 
 typedef struct {
-    UA_StatusCode (*operatorMethod)(UA_FilterEvalContext *ctx, size_t index);
+    UA_FilterOperatorMethod operatorMethod;
     UA_Byte minOperatorCount;
     UA_Byte maxOperatorCount;
 } UA_FilterOperatorJumptableElement;
@@ -1105,27 +1224,230 @@ static const UA_FilterOperatorJumptableElement operatorJumptable[18] = {
     {bitwiseOrOperator, 2, 2}
 };
 
-/* Evaluate content filter, exported only for unit testing */
+/**********************/
+/* Filter Compilation */
+/**********************/
+
+static void
+UA_EventFilterProgram_clear(UA_EventFilterProgram *p) {
+    for(size_t i = 0; i < p->saosSize; i++)
+        UA_CompiledSAO_clear(&p->saos[i]);
+    UA_free(p->saos);
+    UA_free(p->operands);
+    UA_free(p->instructions);
+    p->saos = NULL;
+    p->saosSize = 0;
+    p->selectSize = 0;
+    p->operands = NULL;
+    p->instructions = NULL;
+    p->instructionsSize = 0;
+}
+
+static UA_StatusCode
+compileOperand(UA_EventFilterProgram *p, const UA_ContentFilter *cf,
+               size_t index, const UA_ExtensionObject *op,
+               UA_FilterOperand *out) {
+    out->kind = UA_FILTEROPERANDKIND_INVALID;
+    if(op->encoding != UA_EXTENSIONOBJECT_DECODED &&
+       op->encoding != UA_EXTENSIONOBJECT_DECODED_NODELETE)
+        return UA_STATUSCODE_GOOD;
+
+    const UA_DataType *type = op->content.decoded.type;
+    if(type == &UA_TYPES[UA_TYPES_ELEMENTOPERAND]) {
+        /* Only forward references to an element that was evaluated prior */
+        const UA_ElementOperand *eo = (const UA_ElementOperand*)op->content.decoded.data;
+        if(eo->index <= index || eo->index >= cf->elementsSize)
+            return UA_STATUSCODE_GOOD;
+        out->kind = UA_FILTEROPERANDKIND_ELEMENT;
+        out->content.element = eo->index;
+    } else if(type == &UA_TYPES[UA_TYPES_LITERALOPERAND]) {
+        const UA_LiteralOperand *lo = (const UA_LiteralOperand*)op->content.decoded.data;
+        out->kind = UA_FILTEROPERANDKIND_LITERAL;
+        out->content.literal = &lo->value;
+    } else if(type == &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]) {
+        UA_CompiledSAO *csao = &p->saos[p->saosSize];
+        UA_StatusCode res = UA_CompiledSAO_compile(csao, (const UA_SimpleAttributeOperand*)
+                                                   op->content.decoded.data);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        p->saosSize++;
+        out->kind = UA_FILTEROPERANDKIND_SAO;
+        out->content.sao = csao;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Compile the EventFilter. The program points into the filter, which must not
+ * be modified while the program is in use. Malformed operands and operators are
+ * compiled to return an error during the evaluation. */
+static UA_StatusCode
+UA_EventFilterProgram_compile(UA_EventFilterProgram *p, const UA_EventFilter *filter) {
+    const UA_ContentFilter *cf = &filter->whereClause;
+    if(cf->elementsSize > UA_EVENTFILTER_MAXELEMENTS)
+        return UA_STATUSCODE_BADEVENTFILTERINVALID;
+
+    /* Count the operands */
+    size_t operandsSize = 0;
+    size_t saosSize = filter->selectClausesSize;
+    for(size_t i = 0; i < cf->elementsSize; i++) {
+        const UA_ContentFilterElement *elm = &cf->elements[i];
+        operandsSize += elm->filterOperandsSize;
+        for(size_t j = 0; j < elm->filterOperandsSize; j++) {
+            if(UA_ExtensionObject_hasDecodedType(&elm->filterOperands[j],
+                                                 &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]))
+                saosSize++;
+        }
+    }
+
+    /* Allocate */
+    UA_StatusCode res = UA_STATUSCODE_BADOUTOFMEMORY;
+    if(cf->elementsSize > 0) {
+        p->instructions = (UA_FilterInstruction*)
+            UA_calloc(cf->elementsSize, sizeof(UA_FilterInstruction));
+        if(!p->instructions)
+            goto errout;
+    }
+    if(operandsSize > 0) {
+        p->operands = (UA_FilterOperand*)UA_calloc(operandsSize, sizeof(UA_FilterOperand));
+        if(!p->operands)
+            goto errout;
+    }
+    if(saosSize > 0) {
+        p->saos = (UA_CompiledSAO*)UA_calloc(saosSize, sizeof(UA_CompiledSAO));
+        if(!p->saos)
+            goto errout;
+    }
+
+    /* Compile the select-clauses */
+    for(size_t i = 0; i < filter->selectClausesSize; i++) {
+        res = UA_CompiledSAO_compile(&p->saos[i], &filter->selectClauses[i]);
+        if(res != UA_STATUSCODE_GOOD)
+            goto errout;
+        p->saosSize++;
+    }
+    p->selectSize = filter->selectClausesSize;
+
+    /* Compile the where-clause in evaluation order. Iterate backwards over the
+     * filter elements. This ensures that all element-index operands point to
+     * an evaluated element. */
+    UA_FilterOperand *operand = p->operands;
+    for(size_t i = 0; i < cf->elementsSize; i++) {
+        size_t index = cf->elementsSize - 1 - i;
+        const UA_ContentFilterElement *elm = &cf->elements[index];
+        UA_FilterInstruction *ins = &p->instructions[i];
+        ins->element = index;
+        ins->operandsSize = elm->filterOperandsSize;
+        ins->operands = operand;
+
+        /* Use the jumptable during the compilation. Also check the operand
+         * count, for filters that were not validated before. */
+        ins->method = notImplementedOperator;
+        if(elm->filterOperator >= 0 && elm->filterOperator <= UA_FILTEROPERATOR_BITWISEOR) {
+            const UA_FilterOperatorJumptableElement *je =
+                &operatorJumptable[elm->filterOperator];
+            if(elm->filterOperandsSize >= je->minOperatorCount &&
+               elm->filterOperandsSize <= je->maxOperatorCount)
+                ins->method = je->operatorMethod;
+        }
+
+        for(size_t j = 0; j < elm->filterOperandsSize; j++, operand++) {
+            res = compileOperand(p, cf, index, &elm->filterOperands[j], operand);
+            if(res != UA_STATUSCODE_GOOD)
+                goto errout;
+        }
+    }
+    p->instructionsSize = cf->elementsSize;
+    return UA_STATUSCODE_GOOD;
+
+ errout:
+    UA_EventFilterProgram_clear(p);
+    return res;
+}
+
+static UA_UInt32
+hashEventFilter(const UA_EventFilter *filter) {
+    UA_ByteString buf = UA_BYTESTRING_NULL;
+    UA_StatusCode res = UA_encodeBinary(filter, &UA_TYPES[UA_TYPES_EVENTFILTER],
+                                        &buf, NULL);
+    if(res != UA_STATUSCODE_GOOD)
+        return 0; /* Still found with the full comparison */
+    UA_UInt32 hash = UA_ByteString_hash(0, buf.data, buf.length);
+    UA_ByteString_clear(&buf);
+    return hash;
+}
+
 UA_StatusCode
-evaluateWhereClause(UA_FilterEvalContext *ctx) {
-    UA_LOCK_ASSERT(&ctx->server->serviceMutex);
+UA_EventFilterProgram_acquire(UA_Server *server, const UA_EventFilter *filter,
+                              UA_EventFilterProgram **program) {
+    UA_LOCK_ASSERT(&server->serviceMutex);
+
+    /* Find a program for an identical filter */
+    UA_EventFilterProgram *p;
+    UA_UInt32 hash = hashEventFilter(filter);
+    LIST_FOREACH(p, &server->eventFilterPrograms, listEntry) {
+        if(p->hash == hash &&
+           UA_equal(&p->filter, filter, &UA_TYPES[UA_TYPES_EVENTFILTER])) {
+            p->refCount++;
+            *program = p;
+            return UA_STATUSCODE_GOOD;
+        }
+    }
+
+    /* Compile a new program for a copy of the filter */
+    p = (UA_EventFilterProgram*)UA_calloc(1, sizeof(UA_EventFilterProgram));
+    if(!p)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_StatusCode res = UA_EventFilter_copy(filter, &p->filter);
+    if(res == UA_STATUSCODE_GOOD)
+        res = UA_EventFilterProgram_compile(p, &p->filter);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_EventFilter_clear(&p->filter);
+        UA_free(p);
+        return res;
+    }
+
+    /* Register in the server */
+    p->hash = hash;
+    p->refCount = 1;
+    LIST_INSERT_HEAD(&server->eventFilterPrograms, p, listEntry);
+    *program = p;
+    return UA_STATUSCODE_GOOD;
+}
 
+void
+UA_EventFilterProgram_release(UA_Server *server, UA_EventFilterProgram *p) {
+    UA_LOCK_ASSERT(&server->serviceMutex);
+    UA_assert(p->refCount > 0);
+    p->refCount--;
+    if(p->refCount > 0)
+        return;
+    LIST_REMOVE(p, listEntry);
+    UA_EventFilterProgram_clear(p);
+    UA_EventFilter_clear(&p->filter);
+    UA_free(p);
+}
+
+/*********************/
+/* Program Execution */
+/*********************/
+
+static UA_StatusCode
+executeWhereClause(UA_FilterEvalContext *ctx, const UA_EventFilterProgram *p) {
     /* An empty filter always succeeds */
-    if(ctx->filter.whereClause.elementsSize == 0)
+    if(p->instructionsSize == 0)
         return UA_STATUSCODE_GOOD;
 
-    /* Pacify some compilers by initializing the first result */
+    /* Initialize the results. Elements can remain unevaluated if an operator
+     * fails. */
     UA_assert(ctx->top == 0);
-    UA_Variant_init(&ctx->operatorResults[0]);
+    for(size_t i = 0; i < p->instructionsSize; i++)
+        UA_Variant_init(&ctx->operatorResults[i]);
 
-    /* Evaluate the filter. Iterate backwards over the filter elements and
-     * resolve each. This ensures that all element-index operands point to an
-     * evaluated element. */
+    /* Evaluate the instructions */
     UA_StatusCode res = UA_STATUSCODE_GOOD;
-    const UA_ContentFilter *cf = &ctx->filter.whereClause;
-    for(size_t i = cf->elementsSize - 1; i < cf->elementsSize; i--) {
-        UA_ContentFilterElement *cfe = &cf->elements[i];
-        res = operatorJumptable[cfe->filterOperator].operatorMethod(ctx, i);
+    for(size_t i = 0; i < p->instructionsSize; i++) {
+        const UA_FilterInstruction *ins = &p->instructions[i];
+        res = ins->method(ctx, ins);
         /* Clean up the operand stack */
         for(size_t j = 0; j < ctx->top; j++)
             UA_Variant_clear(&ctx->operandStack[j]);
@@ -1139,11 +1461,67 @@ evaluateWhereClause(UA_FilterEvalContext *ctx) {
         res = UA_STATUSCODE_BADNOMATCH;
 
     /* Clean up the results stack */
-    for(size_t i = 0; i < cf->elementsSize; i++)
+    for(size_t i = 0; i < p->instructionsSize; i++)
         UA_Variant_clear(&ctx->operatorResults[i]);
     return res;
 }
 
+static UA_StatusCode
+executeSelectClause(UA_FilterEvalContext *ctx, const UA_EventFilterProgram *p,
+                    UA_EventFieldList *efl) {
+    /* Nothing to do */
+    if(p->selectSize == 0)
+        return UA_STATUSCODE_GOOD;
+
+    /* Allocate the event fields list */
+    efl->eventFields = (UA_Variant*)UA_calloc(p->selectSize, sizeof(UA_Variant));
+    if(!efl->eventFields)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    efl->eventFieldsSize = p->selectSize;
+
+    /* Resolve the select clauses */
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < p->selectSize; i++) {
+        UA_Variant *field = &efl->eventFields[i];
+        res |= resolveCompiledSAO(ctx, &p->saos[i], field);
+
+        /* Ensure a deep copy */
+        if(field->storageType == UA_VARIANT_DATA_NODELETE) {
+            UA_Variant tmp_val;
+            UA_StatusCode res = UA_Variant_copy(field, &tmp_val);
+            (void)res; /* Ignore the result - returns an empty variant if copying fails */
+            *field = tmp_val;
+        }
+    }
+
+    return res;
+}
+
+/* Evaluate content filter, exported only for unit testing */
+UA_StatusCode
+evaluateWhereClause(UA_FilterEvalContext *ctx) {
+    UA_LOCK_ASSERT(&ctx->server->serviceMutex);
+
+    if(ctx->program)
+        return executeWhereClause(ctx, ctx->program);
+
+    /* An empty filter always succeeds */
+    if(ctx->filter.whereClause.elementsSize == 0)
+        return UA_STATUSCODE_GOOD;
+
+    /* Compile the where-clause for a single evaluation */
+    UA_EventFilter where = ctx->filter;
+    where.selectClausesSize = 0;
+    UA_EventFilterProgram p;
+    memset(&p, 0, sizeof(UA_EventFilterProgram));
+    UA_StatusCode res = UA_EventFilterProgram_compile(&p, &where);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    res = executeWhereClause(ctx, &p);
+    UA_EventFilterProgram_clear(&p);
+    return res;
+}
+
 /*****************************************/
 /* Validation of Filters during Creation */
 /*****************************************/
@@ -1358,43 +1736,133 @@ UA_ContentFilterElementValidation(UA_Server *server, size_t operatorIndex,
 
 UA_StatusCode
 evaluateSelectClause(UA_FilterEvalContext *ctx, UA_EventFieldList *efl) {
+    if(ctx->program)
+        return executeSelectClause(ctx, ctx->program, efl);
+
     /* Nothing to do */
     if(ctx->filter.selectClausesSize == 0)
         return UA_STATUSCODE_GOOD;
 
-    /* Allocate the event fields list */
-    efl->eventFields = (UA_Variant*)
-        UA_calloc(ctx->filter.selectClausesSize, sizeof(UA_Variant));
-    if(!efl->eventFields)
-        return UA_STATUSCODE_BADOUTOFMEMORY;
-    efl->eventFieldsSize = ctx->filter.selectClausesSize;
+    /* Compile the select-clause for a single evaluation */
+    UA_EventFilter select;
+    UA_EventFilter_init(&select);
+    select.selectClausesSize = ctx->filter.selectClausesSize;
+    select.selectClauses = ctx->filter.selectClauses;
+    UA_EventFilterProgram p;
+    memset(&p, 0, sizeof(UA_EventFilterProgram));
+    UA_StatusCode res = UA_EventFilterProgram_compile(&p, &select);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    res = executeSelectClause(ctx, &p, efl);
+    UA_EventFilterProgram_clear(&p);
+    return res;
+}
 
-    /* Resolve the select clauses */
-    UA_StatusCode res = UA_STATUSCODE_GOOD;
-    for(size_t i = 0; i < ctx->filter.selectClausesSize; i++) {
-        const UA_SimpleAttributeOperand *sao = &ctx->filter.selectClauses[i];
-        UA_Variant *field = &efl->eventFields[i];
-        res |= resolveSAO(ctx, sao, field);
+/* Result of a program evaluation for the event that is currently emitted.
+ * Shared between the MonitoredItems with the same program. */
+typedef struct {
+    const UA_EventFilterProgram *program;
+    const UA_Session *session; /* NULL if not session-dependent */
+    UA_StatusCode res;
+    UA_EventFieldList fields;
+} UA_SharedEventResult;
 
-        /* Ensure a deep copy */
-        if(field->storageType == UA_VARIANT_DATA_NODELETE) {
-            UA_Variant tmp_val;
-            UA_StatusCode res = UA_Variant_copy(field, &tmp_val);
-            (void)res; /* Ignore the result - returns an empty variant if copying fails */
-            *field = tmp_val;
-        }
+typedef struct {
+    UA_UInt64 epoch;
+    size_t resultsSize;
+    size_t resultsCapacity;
+    UA_SharedEventResult *results;
+} UA_SharedEventResults;
+
+static UA_SharedEventResult *
+getSharedResult(UA_SharedEventResults *sr, const UA_EventFilterProgram *p,
+                const UA_Session *session) {
+    if(p->eventEpoch != sr->epoch || p->eventSlot >= sr->resultsSize)
+        return NULL;
+
+    /* Try the last result of the program */
+    UA_SharedEventResult *r = &sr->results[p->eventSlot];
+    if(r->program == p && (!r->session || r->session == session))
+        return r;
+
+    /* Search for the result with the same session */
+    for(size_t i = 0; i < sr->resultsSize; i++) {
+        r = &sr->results[i];
+        if(r->program == p && r->session == session)
+            return r;
     }
+    return NULL;
+}
 
-    return res;
+static void
+addSharedResult(UA_SharedEventResults *sr, UA_EventFilterProgram *p,
+                const UA_FilterEvalContext *ctx, UA_StatusCode res,
+                const UA_EventFieldList *fields) {
+    /* Grow the results array */
+    if(sr->resultsSize == sr->resultsCapacity) {
+        size_t newCapacity = (sr->resultsCapacity == 0) ? 8 : sr->resultsCapacity * 2;
+        UA_SharedEventResult *newResults = (UA_SharedEventResult*)
+            UA_realloc(sr->results, newCapacity * sizeof(UA_SharedEventResult));
+        if(!newResults)
+            return; /* The result is not shared then */
+        sr->results = newResults;
+        sr->resultsCapacity = newCapacity;
+    }
+
+    UA_SharedEventResult *r = &sr->results[sr->resultsSize];
+    UA_EventFieldList_init(&r->fields);
+    if(res == UA_STATUSCODE_GOOD &&
+       UA_EventFieldList_copy(fields, &r->fields) != UA_STATUSCODE_GOOD)
+        return;
+    r->program = p;
+    r->session = (ctx->sessionDependent) ? ctx->session : NULL;
+    r->res = res;
+    p->eventEpoch = sr->epoch;
+    p->eventSlot = sr->resultsSize;
+    sr->resultsSize++;
+}
+
+static void
+UA_SharedEventResults_clear(UA_SharedEventResults *sr) {
+    for(size_t i = 0; i < sr->resultsSize; i++)
+        UA_EventFieldList_clear(&sr->results[i].fields);
+    UA_free(sr->results);
+    memset(sr, 0, sizeof(UA_SharedEventResults));
 }
 
 /* Filters an event according to the filter specified by mon and then adds it to
- * mons notification queue */
+ * mons notification queue. If the program is shared with other MonitoredItems,
+ * the result of the evaluation is reused for them. */
 static UA_StatusCode
-UA_MonitoredItem_addEvent(UA_MonitoredItem *mon, UA_FilterEvalContext *ctx) {
-    /* Evaluate the where clause */
-    UA_StatusCode res = evaluateWhereClause(ctx);
+UA_MonitoredItem_addEvent(UA_MonitoredItem *mon, UA_FilterEvalContext *ctx,
+                          UA_SharedEventResults *sr) {
+    UA_EventFilterProgram *p = mon->eventProgram;
+    UA_Boolean shared = (p && p->refCount > 1);
+
+    UA_EventFieldList efl;
+    UA_EventFieldList_init(&efl);
+    UA_StatusCode res;
+    UA_SharedEventResult *r = (shared) ? getSharedResult(sr, p, ctx->session) : NULL;
+    if(r) {
+        /* Reuse the result */
+        res = r->res;
+        if(res == UA_STATUSCODE_GOOD)
+            res = UA_EventFieldList_copy(&r->fields, &efl);
+    } else {
+        /* Evaluate the where clause and the select clause to get the event
+         * fields */
+        ctx->program = p;
+        ctx->sessionDependent = false;
+        res = evaluateWhereClause(ctx);
+        if(res == UA_STATUSCODE_GOOD)
+            res = evaluateSelectClause(ctx, &efl);
+        if(shared)
+            addSharedResult(sr, p, ctx, res, &efl);
+        ctx->program = NULL;
+    }
+
     if(res != UA_STATUSCODE_GOOD) {
+        UA_EventFieldList_clear(&efl);
         if(res == UA_STATUSCODE_BADNOMATCH)
             res = UA_STATUSCODE_GOOD;
         return res;
@@ -1402,18 +1870,13 @@ UA_MonitoredItem_addEvent(UA_MonitoredItem *mon, UA_FilterEvalContext *ctx) {
 
     /* Allocate memory for the notification */
     UA_Notification *n = UA_Notification_new();
-    if(!n)
+    if(!n) {
+        UA_EventFieldList_clear(&efl);
         return UA_STATUSCODE_BADOUTOFMEMORY;
-
-    /* Evaluate the select clause to get the event fields */
-    res = evaluateSelectClause(ctx, &n->data.event);
-    if(res != UA_STATUSCODE_GOOD) {
-        UA_EventFieldList_clear(&n->data.event);
-        UA_free(n);
-        return res;
     }
 
     /* Finalize and enqueue the notification */
+    n->data.event = efl;
     n->data.event.clientHandle = mon->parameters.clientHandle;
     n->mon = mon;
     UA_Notification_enqueueAndTrigger(ctx->server, n);
@@ -1597,6 +2060,13 @@ createEvent(UA_Server *server, const UA_EventDescription *ed,
     /* ctx.session is set below for each MonitoredItem */
     /* ctx.filter is set below for each MonitoredItem */
 
+    /* Results of the filter evaluation shared between MonitoredItems with an
+     * identical filter. The unique epoch identifies the results for this
+     * event in the programs. */
+    UA_SharedEventResults sr;
+    memset(&sr, 0, sizeof(UA_SharedEventResults));
+    sr.epoch = ++server->eventEpoch;
+
     /* Create / resolve the EventId and copy into outEventId */
     if(outEventId) {
         ctx.session = &server->adminSession;
@@ -1662,7 +2132,7 @@ createEvent(UA_Server *server, const UA_EventDescription *ed,
             ctx.session = (sub->session) ? sub->session : &server->adminSession;
 
             /* Evaluate the where-clause and create a notification */
-            res = UA_MonitoredItem_addEvent(mon, &ctx);
+            res = UA_MonitoredItem_addEvent(mon, &ctx, &sr);
             UA_FilterEvalContext_reset(&ctx);
             if(res != UA_STATUSCODE_GOOD) {
                 UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
@@ -1682,6 +2152,7 @@ createEvent(UA_Server *server, const UA_EventDescription *ed,
     }
 
     /* Clean up and return */
+    UA_SharedEventResults_clear(&sr);
     if(outEventId && res != UA_STATUSCODE_GOOD)
         UA_ByteString_clear(outEventId);
     UA_Array_delete(emitNodes, emitNodesSize, &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
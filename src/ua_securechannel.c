@@ -97,11 +97,78 @@ UA_SecureChannel_isConnected(UA_SecureChannel *channel) {
             channel->state < UA_SECURECHANNELSTATE_CLOSING);
 }
 
+/* Hand the queued chunks to the ConnectionManager. The buffers are released in
+ * the ConnectionManager, also if sending fails. The chunks are dropped if the
+ * channel is no longer connected. With keepLast, the last chunk remains in the
+ * queue and all others are sent with "more". So the final send of a corked
+ * burst is never empty and always goes out without "more". */
+static UA_StatusCode
+flushSendQueue(UA_SecureChannel *channel, UA_Boolean keepLast) {
+    size_t queued = channel->sendQueueSize;
+    if(keepLast && queued > 0)
+        queued--;
+    if(queued == 0)
+        return UA_STATUSCODE_GOOD;
+
+    UA_ConnectionManager *cm = channel->connectionManager;
+    if(!UA_SecureChannel_isConnected(channel)) {
+        for(size_t i = 0; i < channel->sendQueueSize; i++)
+            cm->freeNetworkBuffer(cm, channel->connectionId, &channel->sendQueue[i]);
+        channel->sendQueueSize = 0;
+        return UA_STATUSCODE_BADCONNECTIONCLOSED;
+    }
+    channel->sendQueueSize -= queued;
+
+    /* Signal that more data follows right away if the channel is corked or a
+     * chunk is kept (or for all but the last chunk if they are sent
+     * individually) */
+    UA_Boolean more = true;
+    UA_KeyValuePair moreParam;
+    moreParam.key = UA_QUALIFIEDNAME(0, "more");
+    UA_Variant_setScalar(&moreParam.value, &more, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    UA_KeyValueMap moreParams = {1, &moreParam};
+
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    if(cm->sendWithConnectionVec) {
+        res = cm->sendWithConnectionVec(cm, channel->connectionId,
+                                        (channel->corked > 0 || keepLast) ?
+                                        &moreParams : &UA_KEYVALUEMAP_NULL,
+                                        channel->sendQueue, queued);
+    } else {
+        for(size_t i = 0; i < queued; i++) {
+            if(res != UA_STATUSCODE_GOOD) {
+                cm->freeNetworkBuffer(cm, channel->connectionId,
+                                      &channel->sendQueue[i]);
+                continue;
+            }
+            UA_Boolean last = (i + 1 == queued && channel->corked == 0 && !keepLast);
+            res = cm->sendWithConnection(cm, channel->connectionId,
+                                         (last) ? &UA_KEYVALUEMAP_NULL : &moreParams,
+                                         &channel->sendQueue[i]);
+        }
+    }
+
+    /* If sending goes wrong, the connection is removed in the next iteration
+     * of the SecureChannel. Set the SecureChannel to closing already. */
+    if(res != UA_STATUSCODE_GOOD && UA_SecureChannel_isConnected(channel))
+        channel->state = UA_SECURECHANNELSTATE_CLOSING;
+
+    /* Move the kept chunk to the front */
+    if(keepLast)
+        channel->sendQueue[0] = channel->sendQueue[queued];
+    return res;
+}
+
 void
 UA_SecureChannel_sendError(UA_SecureChannel *channel, UA_TcpErrorMessage *error) {
     if(!UA_SecureChannel_isConnected(channel))
         return;
 
+    /* Send queued chunks first to keep the order */
+    flushSendQueue(channel, false);
+    if(!UA_SecureChannel_isConnected(channel))
+        return;
+
     hideErrors(error);
 
     UA_TcpMessageHeader header;
@@ -131,19 +198,13 @@ UA_SecureChannel_sendError(UA_SecureChannel *channel, UA_TcpErrorMessage *error)
     cm->sendWithConnection(cm, channel->connectionId, &UA_KEYVALUEMAP_NULL, &msg);
 }
 
-static void
-UA_Chunk_delete(UA_Chunk *chunk) {
-    if(chunk->copied)
-        UA_ByteString_clear(&chunk->bytes);
-    UA_free(chunk);
-}
-
 static void
 deleteChunks(UA_SecureChannel *channel) {
-    UA_Chunk *chunk, *chunk_tmp;
-    TAILQ_FOREACH_SAFE(chunk, &channel->chunks, pointers, chunk_tmp) {
-        TAILQ_REMOVE(&channel->chunks, chunk, pointers);
-        UA_Chunk_delete(chunk);
+    UA_ChunkedMessage *cm, *cm_tmp;
+    TAILQ_FOREACH_SAFE(cm, &channel->chunks, pointers, cm_tmp) {
+        TAILQ_REMOVE(&channel->chunks, cm, pointers);
+        UA_free(cm->bytes.data);
+        UA_free(cm);
     }
     channel->chunksCount = 0;
     channel->chunksLength = 0;
@@ -166,6 +227,9 @@ UA_SecureChannel_shutdown(UA_SecureChannel *channel,
     /* Set the shutdown event for diagnostics */
     channel->shutdownReason= shutdownReason;
 
+    /* Send out queued chunks before the connection closes */
+    flushSendQueue(channel, false);
+
     /* Trigger the async closing of the connection */
     UA_ConnectionManager *cm = channel->connectionManager;
     cm->closeConnection(cm, channel->connectionId);
@@ -191,6 +255,14 @@ UA_SecureChannel_clear(UA_SecureChannel *channel) {
         el->removeDelayedCallback(el, &channel->unprocessedDelayed);
     }
 
+    /* Drop chunks that were not sent */
+    if(channel->connectionManager) {
+        UA_ConnectionManager *cm = channel->connectionManager;
+        for(size_t i = 0; i < channel->sendQueueSize; i++)
+            cm->freeNetworkBuffer(cm, channel->connectionId, &channel->sendQueue[i]);
+    }
+    channel->sendQueueSize = 0;
+
     /* The EventLoop connection is no longer valid */
     channel->connectionId = 0;
     channel->connectionManager = NULL;
@@ -211,6 +283,9 @@ UA_SecureChannel_clear(UA_SecureChannel *channel) {
     /* Delete remaining chunks */
     UA_SecureChannel_deleteBuffered(channel);
 
+    /* Free the request decoding arena */
+    UA_Arena_clear(&channel->requestArena);
+
     /* Clean up namespace mapping */
     UA_NamespaceMapping_delete(channel->namespaceMapping);
     channel->namespaceMapping = NULL;
@@ -272,10 +347,14 @@ UA_SecureChannel_sendAsymmetricOPNMessage(UA_SecureChannel *channel,
     const UA_SecurityPolicy *sp = channel->securityPolicy;
     UA_CHECK_MEM(sp, return UA_STATUSCODE_BADINTERNALERROR);
 
+    /* Send queued chunks first to keep the order */
+    UA_StatusCode res = flushSendQueue(channel, false);
+    UA_CHECK_STATUS(res, return res);
+
     /* Allocate the message buffer */
     UA_ByteString buf = UA_BYTESTRING_NULL;
-    UA_StatusCode res = cm->allocNetworkBuffer(cm, channel->connectionId, &buf,
-                                               channel->config.sendBufferSize);
+    res = cm->allocNetworkBuffer(cm, channel->connectionId, &buf,
+                                 channel->config.sendBufferSize);
     UA_CHECK_STATUS(res, return res);
 
     /* Restrict buffer to the available space for the payload */
@@ -445,22 +524,51 @@ sendSymmetricChunk(UA_MessageContext *mc) {
     res = signAndEncryptSym(mc, pre_sig_length, total_length);
     UA_CHECK_STATUS(res, goto error);
 
-    /* Send the chunk. The buffer is freed in the network layer. If sending goes
-     * wrong, the connection is removed in the next iteration of the
-     * SecureChannel. Set the SecureChannel to closing already. */
-    res = cm->sendWithConnection(cm, channel->connectionId,
-                                 &UA_KEYVALUEMAP_NULL, &mc->messageBuffer);
-    if(res != UA_STATUSCODE_GOOD && UA_SecureChannel_isConnected(channel))
-        channel->state = UA_SECURECHANNELSTATE_CLOSING;
-    return res;
+    /* Queue the chunk. The queue is sent out after the final chunk (unless the
+     * channel is corked). A full queue is sent out except for the last chunk.
+     * More data follows in that case. */
+    UA_assert(channel->sendQueueSize < UA_SECURECHANNEL_SENDQUEUE_SIZE);
+    channel->sendQueue[channel->sendQueueSize++] = mc->messageBuffer;
+    mc->messageBuffer = UA_BYTESTRING_NULL;
+    UA_Boolean hold = (!mc->final || channel->corked > 0);
+    if(channel->sendQueueSize < UA_SECURECHANNEL_SENDQUEUE_SIZE && hold)
+        return UA_STATUSCODE_GOOD;
+    return flushSendQueue(channel, hold);
 
  error:
     /* Free the unused message buffer */
     cm->freeNetworkBuffer(cm, channel->connectionId, &mc->messageBuffer);
+
+    /* Send out the chunks of the message that are already queued */
+    if(channel->corked == 0)
+        flushSendQueue(channel, false);
     return res;
 }
 
-/* Callback from the encoding layer. Send the chunk and replace the buffer. */
+/* Allocate the network buffer for the next chunk. With a statically allocated
+ * send buffer in the ConnectionManager, the same memory can be handed out
+ * again while it is still queued. Then the queue is sent out first. */
+static UA_StatusCode
+allocChunkBuffer(UA_MessageContext *mc) {
+    UA_SecureChannel *channel = mc->channel;
+    UA_ConnectionManager *cm = channel->connectionManager;
+    UA_StatusCode res =
+        cm->allocNetworkBuffer(cm, channel->connectionId, &mc->messageBuffer,
+                               channel->config.sendBufferSize);
+    UA_CHECK_STATUS(res, return res);
+
+    for(size_t i = 0; i < channel->sendQueueSize; i++) {
+        if(channel->sendQueue[i].data != mc->messageBuffer.data)
+            continue;
+        res = flushSendQueue(channel, false);
+        if(res != UA_STATUSCODE_GOOD)
+            cm->freeNetworkBuffer(cm, channel->connectionId, &mc->messageBuffer);
+        break;
+    }
+    return res;
+}
+
+/* Callback from the encoding layer. Queue the chunk and replace the buffer. */
 static UA_StatusCode
 sendSymmetricEncodingCallback(void *data, UA_Byte **buf_pos,
                               const UA_Byte **buf_end) {
@@ -474,13 +582,10 @@ sendSymmetricEncodingCallback(void *data, UA_Byte **buf_pos,
     UA_CHECK_STATUS(res, return res);
 
     /* Set a new buffer for the next chunk */
-    UA_ConnectionManager *cm = mc->channel->connectionManager;
     if(!UA_SecureChannel_isConnected(mc->channel))
         return UA_STATUSCODE_BADCONNECTIONCLOSED;
 
-    res = cm->allocNetworkBuffer(cm, mc->channel->connectionId,
-                                 &mc->messageBuffer,
-                                 mc->channel->config.sendBufferSize);
+    res = allocChunkBuffer(mc);
     UA_CHECK_STATUS(res, return res);
 
     /* Hide bytes for header, padding and signature */
@@ -496,7 +601,6 @@ UA_MessageContext_begin(UA_MessageContext *mc, UA_SecureChannel *channel,
     UA_CHECK(messageType == UA_MESSAGETYPE_MSG || messageType == UA_MESSAGETYPE_CLO,
              return UA_STATUSCODE_BADINTERNALERROR);
 
-    UA_ConnectionManager *cm = channel->connectionManager;
     if(!UA_SecureChannel_isConnected(channel))
         return UA_STATUSCODE_BADCONNECTIONCLOSED;
 
@@ -510,10 +614,7 @@ UA_MessageContext_begin(UA_MessageContext *mc, UA_SecureChannel *channel,
     mc->messageType = messageType;
 
     /* Allocate the message buffer */
-    UA_StatusCode res =
-        cm->allocNetworkBuffer(cm, channel->connectionId,
-                               &mc->messageBuffer,
-                               channel->config.sendBufferSize);
+    UA_StatusCode res = allocChunkBuffer(mc);
     UA_CHECK_STATUS(res, return res);
 
     /* Hide bytes for header, padding and signature */
@@ -549,6 +650,23 @@ UA_MessageContext_abort(UA_MessageContext *mc) {
     cm->freeNetworkBuffer(cm, mc->channel->connectionId, &mc->messageBuffer);
 }
 
+void
+UA_SecureChannel_cork(UA_SecureChannel *channel) {
+    if(channel)
+        channel->corked++;
+}
+
+UA_StatusCode
+UA_SecureChannel_uncork(UA_SecureChannel *channel) {
+    if(!channel)
+        return UA_STATUSCODE_GOOD;
+    UA_assert(channel->corked > 0);
+    channel->corked--;
+    if(channel->corked > 0)
+        return UA_STATUSCODE_GOOD;
+    return flushSendQueue(channel, false);
+}
+
 UA_StatusCode
 UA_SecureChannel_sendSymmetricMessage(UA_SecureChannel *channel, UA_UInt32 requestId,
                                       UA_MessageType messageType, void *payload,
@@ -833,12 +951,44 @@ UA_SecureChannel_loadBuffer(UA_SecureChannel *channel, const UA_ByteString buffe
     return UA_STATUSCODE_GOOD;
 }
 
+/* Append the chunk payload to the assembled message. The buffer (at least)
+ * doubles when it needs to grow. The final chunk is appended without leaving
+ * spare capacity. */
+static UA_StatusCode
+appendChunk(UA_SecureChannel *channel, UA_ChunkedMessage *cm,
+            const UA_ByteString *payload, UA_Boolean final) {
+    size_t needed = cm->bytes.length + payload->length;
+    if(needed > cm->capacity) {
+        size_t newCapacity = needed;
+        if(!final) {
+            newCapacity = cm->capacity << 1;
+            if(newCapacity < (needed << 1))
+                newCapacity = needed << 1;
+            /* The size was validated against the maximum before */
+            size_t maxSize = channel->config.localMaxMessageSize;
+            if(maxSize != 0 && newCapacity > maxSize)
+                newCapacity = maxSize;
+        }
+        UA_Byte *data = (UA_Byte*)UA_realloc(cm->bytes.data, newCapacity);
+        if(!data)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        cm->bytes.data = data;
+        cm->capacity = newCapacity;
+    }
+    if(payload->length > 0)
+        memcpy(cm->bytes.data + cm->bytes.length, payload->data, payload->length);
+    cm->bytes.length = needed;
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_StatusCode
 UA_SecureChannel_getCompleteMessage(UA_SecureChannel *channel,
                                     UA_MessageType *messageType, UA_UInt32 *requestId,
                                     UA_ByteString *payload, UA_Boolean *copied,
                                     UA_DateTime nowMonotonic) {
-    UA_Chunk chunk, *pchunk;
+    UA_Chunk chunk;
+    UA_ChunkedMessage *cm;
+    size_t assembled;
     UA_StatusCode res = UA_STATUSCODE_GOOD;
 
  extract_chunk:
@@ -848,148 +998,96 @@ UA_SecureChannel_getCompleteMessage(UA_SecureChannel *channel,
     if(chunk.bytes.length == 0 || res != UA_STATUSCODE_GOOD)
         return res; /* Error or no complete chunk could be extracted */
 
-    /* Process the chunk */
-    switch(chunk.chunkType) {
-    case UA_CHUNKTYPE_ABORT:
-        /* Remove all chunks received so far. Then continue extracting chunks. */
+    /* Remove all chunks received so far. Then continue extracting chunks. */
+    if(chunk.chunkType == UA_CHUNKTYPE_ABORT) {
         deleteChunks(channel);
         if(chunk.copied)
             UA_ByteString_clear(&chunk.bytes);
         goto extract_chunk;
+    }
 
-    case UA_CHUNKTYPE_INTERMEDIATE:
-        /* Validate the resource limits */
-        if((channel->config.localMaxChunkCount != 0 &&
-            channel->chunksCount >= channel->config.localMaxChunkCount) ||
-           (channel->config.localMaxMessageSize != 0 &&
-            channel->chunksLength + chunk.bytes.length > channel->config.localMaxMessageSize)) {
-            if(chunk.copied)
-                UA_ByteString_clear(&chunk.bytes);
-            return UA_STATUSCODE_BADTCPMESSAGETOOLARGE;
-        }
-
-        /* Add the chunk to the queue. Then continue extracting more chunks. */
-        pchunk = (UA_Chunk*)UA_malloc(sizeof(UA_Chunk));
-        if(!pchunk) {
-            if(chunk.copied)
-                UA_ByteString_clear(&chunk.bytes);
-            return UA_STATUSCODE_BADOUTOFMEMORY;
-        }
-        *pchunk = chunk;
-        TAILQ_INSERT_TAIL(&channel->chunks, pchunk, pointers);
-        channel->chunksCount++;
-        channel->chunksLength += pchunk->bytes.length;
-        goto extract_chunk;
+    /* Was checked before */
+    UA_assert(chunk.chunkType == UA_CHUNKTYPE_FINAL ||
+              chunk.chunkType == UA_CHUNKTYPE_INTERMEDIATE);
+    UA_Boolean final = (chunk.chunkType == UA_CHUNKTYPE_FINAL);
 
-    case UA_CHUNKTYPE_FINAL:
-    default:
-        UA_assert(chunk.chunkType == UA_CHUNKTYPE_FINAL); /* Was checked before */
-        break; /* A final chunk was received -- assemble the message */
+    /* Find the message assembled from the previous chunks */
+    TAILQ_FOREACH(cm, &channel->chunks, pointers) {
+        if(cm->requestId == chunk.requestId)
+            break;
     }
 
-    /* Compute the message size */
-    size_t messageSize = chunk.bytes.length;
-    UA_Chunk *first = NULL;
-    TAILQ_FOREACH(pchunk, &channel->chunks, pointers) {
-        if(chunk.requestId != pchunk->requestId)
-            continue;
-        if(chunk.messageType != pchunk->messageType) {
-            if(chunk.copied)
-                UA_ByteString_clear(&chunk.bytes);
-            return UA_STATUSCODE_BADTCPMESSAGETYPEINVALID;
-        }
-        if(!first)
-            first = pchunk;
-        messageSize += pchunk->bytes.length;
-    }
+    /* Single-chunk message. Return the chunk without copying. */
+    if(!cm && final)
+        goto done;
 
-    /* Validate the assembled message size */
-    if(channel->config.localMaxMessageSize != 0 &&
-       channel->chunksLength > channel->config.localMaxMessageSize) {
-        if(chunk.copied)
-            UA_ByteString_clear(&chunk.bytes);
-        return UA_STATUSCODE_BADTCPMESSAGETOOLARGE;
+    /* Validate the message type and the resource limits */
+    if(cm && cm->messageType != chunk.messageType) {
+        res = UA_STATUSCODE_BADTCPMESSAGETYPEINVALID;
+        goto cleanup;
+    }
+    if((!final && channel->config.localMaxChunkCount != 0 &&
+        channel->chunksCount >= channel->config.localMaxChunkCount) ||
+       (channel->config.localMaxMessageSize != 0 &&
+        channel->chunksLength + chunk.bytes.length > channel->config.localMaxMessageSize)) {
+        res = UA_STATUSCODE_BADTCPMESSAGETOOLARGE;
+        goto cleanup;
     }
 
-    /* Assemble the full payload and store it in chunk.bytes */
-    if(messageSize > chunk.bytes.length) {
-        UA_assert(first != NULL);
-
-        /* Allocate the full memory and initialize with the first chunk content.
-         * Use realloc to speed up. */
-        UA_ByteString message;
-        if(first->copied) {
-            message.data = (UA_Byte*)UA_realloc(first->bytes.data, messageSize);
-        } else {
-            message.data = (UA_Byte*)UA_malloc(messageSize);
-            if(message.data)
-                memcpy(message.data, first->bytes.data, first->bytes.length);
-        }
-        if(!message.data) {
-            if(chunk.copied)
-                UA_ByteString_clear(&chunk.bytes);
-            return UA_STATUSCODE_BADOUTOFMEMORY;
-        }
-        message.length = first->bytes.length;
-
-        /* Remove the the first chunk */
-        pchunk = TAILQ_NEXT(first, pointers);
-        first->copied = false;
-        channel->chunksCount--;
-        channel->chunksLength -= first->bytes.length;
-        TAILQ_REMOVE(&channel->chunks, first, pointers);
-        UA_Chunk_delete(first);
-
-        /* Copy over the content from the remaining intermediate chunks.
-         * And remove them right away. */
-        UA_Chunk *next;
-        for(; pchunk; pchunk = next) {
-            next = TAILQ_NEXT(pchunk, pointers);
-            if(chunk.requestId != pchunk->requestId)
-                continue;
-            memcpy(message.data + message.length, pchunk->bytes.data, pchunk->bytes.length);
-            message.length += pchunk->bytes.length;
-            channel->chunksCount--;
-            channel->chunksLength -= pchunk->bytes.length;
-            TAILQ_REMOVE(&channel->chunks, pchunk, pointers);
-            UA_Chunk_delete(pchunk);
+    /* First intermediate chunk of the message */
+    if(!cm) {
+        cm = (UA_ChunkedMessage*)UA_calloc(1, sizeof(UA_ChunkedMessage));
+        if(!cm) {
+            res = UA_STATUSCODE_BADOUTOFMEMORY;
+            goto cleanup;
         }
+        cm->messageType = chunk.messageType;
+        cm->requestId = chunk.requestId;
+        TAILQ_INSERT_TAIL(&channel->chunks, cm, pointers);
+    }
 
-        /* Copy over the content from the final chunk */
-        memcpy(message.data + message.length, chunk.bytes.data, chunk.bytes.length);
-        message.length += chunk.bytes.length;
-        UA_assert(message.length == messageSize);
+    /* Append the payload. The chunk is no longer needed afterwards. */
+    assembled = cm->bytes.length;
+    res = appendChunk(channel, cm, &chunk.bytes, final);
+    if(chunk.copied)
+        UA_ByteString_clear(&chunk.bytes);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
 
-        /* Set assembled message as the content of the final chunk */
-        if(chunk.copied)
-            UA_ByteString_clear(&chunk.bytes);
-        chunk.bytes = message;
-        chunk.copied = true;
+    /* Continue extracting more chunks */
+    if(!final) {
+        cm->chunksCount++;
+        channel->chunksCount++;
+        channel->chunksLength += cm->bytes.length - assembled;
+        goto extract_chunk;
     }
 
+    /* The message is complete. Take the buffer and remove the entry. */
+    channel->chunksCount -= cm->chunksCount;
+    channel->chunksLength -= assembled;
+    TAILQ_REMOVE(&channel->chunks, cm, pointers);
+    chunk.bytes = cm->bytes;
+    chunk.copied = true;
+    UA_free(cm);
+
+ done:
     /* Return the assembled message */
     *requestId = chunk.requestId;
     *messageType = chunk.messageType;
     *payload = chunk.bytes;
     *copied = chunk.copied;
     return UA_STATUSCODE_GOOD;
+
+ cleanup:
+    if(chunk.copied)
+        UA_ByteString_clear(&chunk.bytes);
+    return res;
 }
 
 UA_StatusCode
 UA_SecureChannel_persistBuffer(UA_SecureChannel *channel) {
     UA_StatusCode res = UA_STATUSCODE_GOOD;
 
-    /* Persist the chunks */
-    UA_Chunk *chunk;
-    TAILQ_FOREACH(chunk, &channel->chunks, pointers) {
-        if(chunk->copied)
-            continue;
-        UA_ByteString tmp = UA_BYTESTRING_NULL;
-        res |= UA_ByteString_copy(&chunk->bytes, &tmp);
-        chunk->bytes = tmp;
-        chunk->copied = true;
-    }
-
     /* No unprocessed bytes remaining */
     UA_assert(channel->unprocessed.length >= channel->unprocessedOffset);
     if(channel->unprocessed.length == channel->unprocessedOffset) {
@@ -60,9 +60,12 @@ typedef struct UA_Session UA_Session;
 /* Minimum length of a valid message (ERR message with an empty reason) */
 #define UA_SECURECHANNEL_MESSAGE_MIN_LENGTH 16
 
+/* Maximum number of encoded chunks that are queued before they are handed to
+ * the ConnectionManager in one batch */
+#define UA_SECURECHANNEL_SENDQUEUE_SIZE 16
+
 /* For chunked requests */
 typedef struct UA_Chunk {
-    TAILQ_ENTRY(UA_Chunk) pointers;
     UA_ByteString bytes;
     UA_MessageType messageType;
     UA_ChunkType chunkType;
@@ -71,7 +74,20 @@ typedef struct UA_Chunk {
                         * memory allocated for the chunk separately */
 } UA_Chunk;
 
-typedef TAILQ_HEAD(UA_ChunkQueue, UA_Chunk) UA_ChunkQueue;
+/* Message that is assembled from the intermediate chunks with the same
+ * RequestId. The chunk payloads are appended to the buffer as they arrive. The
+ * buffer grows geometrically, so that every payload byte is copied once from
+ * the network buffer (plus amortized reallocations). */
+typedef struct UA_ChunkedMessage {
+    TAILQ_ENTRY(UA_ChunkedMessage) pointers;
+    UA_ByteString bytes; /* The length is the used part of the buffer */
+    size_t capacity;
+    size_t chunksCount;
+    UA_MessageType messageType;
+    UA_UInt32 requestId;
+} UA_ChunkedMessage;
+
+typedef TAILQ_HEAD(UA_ChunkedMessageQueue, UA_ChunkedMessage) UA_ChunkedMessageQueue;
 
 typedef enum {
     UA_SECURECHANNELRENEWSTATE_NORMAL,
@@ -148,11 +164,26 @@ struct UA_SecureChannel {
      * used in the server) */
     UA_Session *sessions;
 
-    /* (Decrypted) chunks waiting to be processed */
-    UA_ChunkQueue chunks;
+    /* Messages assembled from the (decrypted) intermediate chunks received so
+     * far. The count and length are summed up over all messages. */
+    UA_ChunkedMessageQueue chunks;
     size_t chunksCount;
     size_t chunksLength;
 
+    /* Arena for decoding requests. Reset after each request (only used in
+     * the server). */
+    UA_Arena requestArena;
+
+    /* Encoded symmetric chunks that have not been sent yet. They are sent
+     * together with a single vectored send (if the ConnectionManager supports
+     * it) when the message is finished or the queue is full. A full queue
+     * keeps its last chunk, so the final send of a message or corked burst is
+     * never empty. While the channel is corked, finished messages also remain
+     * in the queue. */
+    UA_ByteString sendQueue[UA_SECURECHANNEL_SENDQUEUE_SIZE];
+    size_t sendQueueSize;
+    size_t corked;
+
     /* Received buffer from which no chunks have been extracted so far */
     UA_ByteString unprocessed;
     size_t unprocessedOffset;
@@ -232,9 +263,20 @@ UA_SecureChannel_sendSymmetricMessage(UA_SecureChannel *channel, UA_UInt32 reque
                                       UA_MessageType messageType, void *payload,
                                       const UA_DataType *payloadType);
 
-/* The MessageContext is forwarded into the encoding layer so that we can send
- * chunks before continuing to encode. This lets us reuse a fixed chunk-sized
- * messages buffer. */
+/* Hold back the symmetric messages until the matching _uncork. A burst of
+ * messages (e.g. several PublishResponses) is then sent in batches of chunks
+ * instead of one send per message. Calls can be nested. Both methods accept a
+ * NULL channel and do nothing then. */
+void
+UA_SecureChannel_cork(UA_SecureChannel *channel);
+
+/* Send the held-back messages after the outermost _uncork */
+UA_StatusCode
+UA_SecureChannel_uncork(UA_SecureChannel *channel);
+
+/* The MessageContext is forwarded into the encoding layer so that we can queue
+ * chunks for sending before continuing to encode. Every chunk is encoded into
+ * a fresh network buffer of the chunk size. */
 typedef struct {
     UA_SecureChannel *channel;
     UA_UInt32 requestId;
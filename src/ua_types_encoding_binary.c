@@ -1478,6 +1478,28 @@ FUNC_DECODE_BINARY(DiagnosticInfo) {
 /* Structured Types */
 /********************/
 
+/* A run of overlayable scalar members without padding in between has the
+ * identical layout in memory and on the binary stream. Such runs are
+ * en/decoded with a single memcpy instead of dispatching every member through
+ * the jump table. Returns the memory size of the run starting at member *i and
+ * moves *i to the last member of the run. Returns zero if the run has less
+ * than two members. Single members are faster with their typed encoding. */
+static size_t
+overlayableRun(const UA_DataType *type, size_t *i) {
+    size_t j = *i;
+    size_t size = type->members[j].memberType->memSize;
+    for(; j + 1 < type->membersSize; j++) {
+        const UA_DataTypeMember *m = &type->members[j + 1];
+        if(m->isArray || m->padding != 0 || !m->memberType->overlayable)
+            break;
+        size += m->memberType->memSize;
+    }
+    if(j == *i)
+        return 0;
+    *i = j;
+    return size;
+}
+
 static status
 encodeBinaryStruct(Ctx *ctx, const void *src, const UA_DataType *type) {
     /* Check the recursion limit */
@@ -1503,6 +1525,18 @@ encodeBinaryStruct(Ctx *ctx, const void *src, const UA_DataType *type) {
             continue;
         }
 
+        /* Run of overlayable scalars. Buffer-exchange is done inside
+         * Array_encodeBinaryOverlayable if required. */
+        if(mt->overlayable) {
+            size_t runSize = overlayableRun(type, &i);
+            if(runSize > 0) {
+                ret = Array_encodeBinaryOverlayable(ctx, ptr, runSize);
+                UA_assert(ret != UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED);
+                ptr += runSize;
+                continue;
+            }
+        }
+
         /* Scalar */
         ret = encodeWithExchangeBuffer(ctx, (const void*)ptr, mt);
         UA_assert(ret != UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED);
@@ -1757,6 +1791,21 @@ decodeBinaryStructure(Ctx *ctx, void *dst, const UA_DataType *type) {
             continue;
         }
 
+        /* Run of overlayable scalars */
+        if(mt->overlayable) {
+            size_t runSize = overlayableRun(type, &i);
+            if(runSize > 0) {
+                if(ctx->pos + runSize > ctx->end) {
+                    ret = UA_STATUSCODE_BADDECODINGERROR;
+                    break;
+                }
+                memcpy((void*)ptr, ctx->pos, runSize);
+                ctx->pos += runSize;
+                ptr += runSize;
+                continue;
+            }
+        }
+
         /* Scalar */
         ret = decodeBinaryJumpTable[mt->typeKind](ctx, (void *UA_RESTRICT)ptr, mt);
         ptr += mt->memSize;
@@ -1559,3 +1559,106 @@ UA_TrustListDataType_getSize(const UA_TrustListDataType *trustList) {
     }
     return size;
 }
+
+/*********/
+/* Arena */
+/*********/
+
+#define UA_ARENA_ALIGN 8
+#define UA_ARENA_ALIGNED(x) \
+    (((x) + (UA_ARENA_ALIGN - 1)) & ~(size_t)(UA_ARENA_ALIGN - 1))
+#define UA_ARENA_HEADER UA_ARENA_ALIGNED(sizeof(UA_ArenaBlock))
+
+void
+UA_Arena_init(UA_Arena *arena, size_t blockSize, size_t maxBlockSize) {
+    memset(arena, 0, sizeof(UA_Arena));
+    arena->blockSize = UA_ARENA_ALIGNED(blockSize);
+    arena->maxBlockSize = (maxBlockSize > arena->blockSize) ?
+        maxBlockSize : arena->blockSize;
+}
+
+static UA_ArenaBlock *
+UA_Arena_addBlock(UA_Arena *arena, size_t minSize) {
+    size_t size = (minSize > arena->blockSize) ? minSize : arena->blockSize;
+    UA_ArenaBlock *block = (UA_ArenaBlock*)UA_malloc(UA_ARENA_HEADER + size);
+    if(!block)
+        return NULL;
+    block->size = size;
+    block->used = 0;
+    arena->blockCount++;
+
+    /* Oversized blocks are added behind the current block. So the remaining
+     * space of the current block can still be used. */
+    if(size > arena->blockSize && arena->blocks) {
+        block->next = arena->blocks->next;
+        arena->blocks->next = block;
+    } else {
+        block->next = arena->blocks;
+        arena->blocks = block;
+    }
+    return block;
+}
+
+void *
+UA_Arena_calloc(void *context, size_t nelem, size_t elsize) {
+    UA_Arena *arena = (UA_Arena*)context;
+    if(elsize > 0 && nelem > (SIZE_MAX - UA_ARENA_HEADER - UA_ARENA_ALIGN) / elsize)
+        return NULL;
+    size_t size = UA_ARENA_ALIGNED(nelem * elsize);
+    if(size == 0)
+        size = UA_ARENA_ALIGN; /* Never return NULL for empty allocations */
+
+    UA_ArenaBlock *block = arena->blocks;
+    if(!block || block->size - block->used < size) {
+        block = UA_Arena_addBlock(arena, size);
+        if(!block)
+            return NULL;
+    }
+
+    void *p = (UA_Byte*)block + UA_ARENA_HEADER + block->used;
+    block->used += size;
+    arena->used += size;
+    arena->allocCount++;
+    memset(p, 0, size);
+    return p;
+}
+
+static void
+UA_Arena_freeBlocks(UA_Arena *arena) {
+    UA_ArenaBlock *block = arena->blocks;
+    while(block) {
+        UA_ArenaBlock *next = block->next;
+        UA_free(block);
+        block = next;
+    }
+    arena->blocks = NULL;
+}
+
+void
+UA_Arena_reset(UA_Arena *arena) {
+    UA_ArenaBlock *block = arena->blocks;
+    if(block && !block->next && block->size <= arena->maxBlockSize) {
+        /* Keep the single block */
+        block->used = 0;
+    } else if(block) {
+        /* Several blocks were required. Grow the block size (within the limit)
+         * so that the next use of the same size fits into a single block. */
+        size_t grow = UA_ARENA_ALIGNED(arena->used);
+        if(grow > arena->maxBlockSize)
+            grow = arena->maxBlockSize;
+        if(grow > arena->blockSize)
+            arena->blockSize = grow;
+        UA_Arena_freeBlocks(arena);
+    }
+    arena->used = 0;
+    arena->allocCount = 0;
+    arena->blockCount = 0;
+}
+
+void
+UA_Arena_clear(UA_Arena *arena) {
+    UA_Arena_freeBlocks(arena);
+    arena->used = 0;
+    arena->allocCount = 0;
+    arena->blockCount = 0;
+}
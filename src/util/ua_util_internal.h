@@ -278,6 +278,43 @@ UA_dump_hex_pkg(UA_Byte* buffer, size_t bufferLen);
  * certificates */
 UA_ByteString getLeafCertificate(UA_ByteString chain);
 
+/* Bump allocator with a calloc signature that can be used for
+ * UA_DecodeBinaryOptions. Memory is not freed individually. Instead, all
+ * allocations are released at once with UA_Arena_reset. The arena keeps one
+ * block between resets. If a previous use overflowed into additional blocks,
+ * the kept block is grown up to maxBlockSize. */
+typedef struct UA_ArenaBlock {
+    struct UA_ArenaBlock *next;
+    size_t size; /* Usable bytes after the (aligned) header */
+    size_t used;
+} UA_ArenaBlock;
+
+typedef struct {
+    UA_ArenaBlock *blocks; /* The current block first */
+    size_t blockSize;      /* Size of the next block */
+    size_t maxBlockSize;   /* Upper limit for growing the kept block */
+
+    /* Statistics since the last reset */
+    size_t used;           /* Bytes served from the arena */
+    size_t allocCount;     /* Allocations served from the arena */
+    size_t blockCount;     /* Blocks allocated from the heap */
+} UA_Arena;
+
+void
+UA_Arena_init(UA_Arena *arena, size_t blockSize, size_t maxBlockSize);
+
+/* The first argument is the UA_Arena. Returns zeroed-out memory. */
+void *
+UA_Arena_calloc(void *arena, size_t nelem, size_t elsize);
+
+/* Release all allocations. The memory of the first block is kept. */
+void
+UA_Arena_reset(UA_Arena *arena);
+
+/* Free all blocks */
+void
+UA_Arena_clear(UA_Arena *arena);
+
 /* Unions that represent any of the supported request or response message */
 typedef union {
     UA_RequestHeader requestHeader;
@@ -3,10 +3,14 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include <open62541/types.h>
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/plugin/securitypolicy_default.h>
+#include <open62541/server_config_default.h>
 
 #include "ua_securechannel.h"
 #include "ua_types_encoding_binary.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <check.h>
 
@@ -151,6 +155,228 @@ START_TEST(encodeTwoStringsIntoTenChunksShallWork) {
     UA_String_clear(&string);
 } END_TEST
 
+/* Decoding of chunked messages */
+
+#define MSG_CHUNK_HEADER_LENGTH 24
+
+static UA_SecureChannel channel;
+static UA_SecurityPolicy policy;
+static UA_UInt32 sequenceNumber;
+
+static void
+setupChannel(void) {
+    UA_SecurityPolicy_None(&policy, UA_BYTESTRING_NULL, UA_Log_Stdout);
+    UA_SecureChannel_init(&channel);
+    channel.config = UA_ConnectionConfig_default;
+    UA_ByteString remoteCertificate = UA_BYTESTRING_NULL;
+    UA_SecureChannel_setSecurityPolicy(&channel, &policy, &remoteCertificate);
+    channel.securityMode = UA_MESSAGESECURITYMODE_NONE;
+    channel.securityToken.channelId = 1;
+    channel.securityToken.tokenId = 1;
+    channel.securityToken.revisedLifetime = UA_UINT32_MAX;
+    channel.state = UA_SECURECHANNELSTATE_OPEN;
+    sequenceNumber = 0;
+}
+
+static void
+teardownChannel(void) {
+    UA_SecureChannel_clear(&channel);
+    policy.clear(&policy);
+}
+
+/* Encode a MSG chunk with the None SecurityPolicy. Returns the chunk length. */
+static size_t
+encodeChunk(UA_Byte *buf, UA_Byte chunkType, UA_UInt32 requestId,
+            const UA_Byte *payload, size_t payloadLength) {
+    UA_UInt32 header[5];
+    header[0] = (UA_UInt32)(MSG_CHUNK_HEADER_LENGTH + payloadLength);
+    header[1] = channel.securityToken.channelId;
+    header[2] = channel.securityToken.tokenId;
+    header[3] = ++sequenceNumber;
+    header[4] = requestId;
+    buf[0] = 'M'; buf[1] = 'S'; buf[2] = 'G'; buf[3] = chunkType;
+    UA_Byte *pos = &buf[4];
+    const UA_Byte *end = &buf[MSG_CHUNK_HEADER_LENGTH];
+    for(size_t i = 0; i < 5; i++) {
+        UA_StatusCode res = UA_encodeBinaryInternal(&header[i], &UA_TYPES[UA_TYPES_UINT32],
+                                                    &pos, &end, NULL, NULL, NULL);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+    if(payloadLength > 0)
+        memcpy(pos, payload, payloadLength);
+    return MSG_CHUNK_HEADER_LENGTH + payloadLength;
+}
+
+/* Load the buffer like the network layer would do. The buffer is invalidated
+ * afterwards. Returns the number of complete messages. The last message is
+ * returned in the output. */
+static size_t
+processBuffer(UA_ByteString buffer, UA_StatusCode *res, UA_UInt32 *requestId,
+              UA_ByteString *message) {
+    size_t messages = 0;
+    *res = UA_SecureChannel_loadBuffer(&channel, buffer);
+    while(*res == UA_STATUSCODE_GOOD) {
+        UA_MessageType messageType;
+        UA_ByteString payload = UA_BYTESTRING_NULL;
+        UA_Boolean copied = false;
+        *res = UA_SecureChannel_getCompleteMessage(&channel, &messageType, requestId,
+                                                   &payload, &copied, 0);
+        if(*res != UA_STATUSCODE_GOOD || payload.length == 0)
+            break;
+        ck_assert_int_eq(messageType, UA_MESSAGETYPE_MSG);
+        messages++;
+        UA_ByteString_clear(message);
+        *res = UA_ByteString_copy(&payload, message);
+        if(copied)
+            UA_ByteString_clear(&payload);
+    }
+    *res |= UA_SecureChannel_persistBuffer(&channel);
+    memset(buffer.data, 0, buffer.length);
+    return messages;
+}
+
+START_TEST(decodeMessageFromChunksShallWork) {
+    size_t payloadLength = 100000;
+    size_t chunkPayload = 8192;
+    UA_Byte *payload = (UA_Byte*)UA_malloc(payloadLength);
+    for(size_t i = 0; i < payloadLength; i++)
+        payload[i] = (UA_Byte)i;
+
+    /* Every chunk arrives in its own network buffer */
+    UA_ByteString buffer;
+    UA_ByteString_allocBuffer(&buffer, MSG_CHUNK_HEADER_LENGTH + chunkPayload);
+    UA_ByteString message = UA_BYTESTRING_NULL;
+    UA_StatusCode res;
+    UA_UInt32 requestId = 0;
+    size_t messages = 0;
+    for(size_t pos = 0; pos < payloadLength; pos += chunkPayload) {
+        size_t len = payloadLength - pos;
+        UA_Byte chunkType = 'F';
+        if(len > chunkPayload) {
+            len = chunkPayload;
+            chunkType = 'C';
+        }
+        UA_ByteString chunk = {encodeChunk(buffer.data, chunkType, 7,
+                                           &payload[pos], len), buffer.data};
+        messages += processBuffer(chunk, &res, &requestId, &message);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+    ck_assert_uint_eq(messages, 1);
+    ck_assert_uint_eq(requestId, 7);
+    ck_assert_uint_eq(message.length, payloadLength);
+    ck_assert(memcmp(message.data, payload, payloadLength) == 0);
+    ck_assert_uint_eq(channel.chunksCount, 0);
+    ck_assert_uint_eq(channel.chunksLength, 0);
+
+    UA_ByteString_clear(&message);
+    UA_ByteString_clear(&buffer);
+    UA_free(payload);
+} END_TEST
+
+START_TEST(decodeInterleavedAndAbortedChunksShallWork) {
+    UA_Byte a[4] = {1, 2, 3, 4};
+    UA_Byte b[4] = {5, 6, 7, 8};
+    UA_ByteString buffer;
+    UA_ByteString_allocBuffer(&buffer, 8 * (MSG_CHUNK_HEADER_LENGTH + 4));
+
+    /* Intermediate chunks for two requests. The third request is aborted. */
+    size_t len = 0;
+    len += encodeChunk(&buffer.data[len], 'C', 1, a, 2);
+    len += encodeChunk(&buffer.data[len], 'C', 2, b, 2);
+    len += encodeChunk(&buffer.data[len], 'F', 1, &a[2], 2);
+    UA_ByteString chunks = {len, buffer.data};
+    UA_ByteString message = UA_BYTESTRING_NULL;
+    UA_StatusCode res;
+    UA_UInt32 requestId = 0;
+    size_t messages = processBuffer(chunks, &res, &requestId, &message);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(messages, 1);
+    ck_assert_uint_eq(requestId, 1);
+    ck_assert_uint_eq(message.length, 4);
+    ck_assert(memcmp(message.data, a, 4) == 0);
+    ck_assert_uint_eq(channel.chunksCount, 1);
+    ck_assert_uint_eq(channel.chunksLength, 2);
+
+    len = 0;
+    len += encodeChunk(&buffer.data[len], 'F', 2, &b[2], 2);
+    len += encodeChunk(&buffer.data[len], 'C', 3, a, 4);
+    len += encodeChunk(&buffer.data[len], 'A', 3, b, 4); /* Error + Reason */
+    len += encodeChunk(&buffer.data[len], 'F', 4, b, 4);
+    chunks.length = len;
+    messages = processBuffer(chunks, &res, &requestId, &message);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(messages, 2);
+    ck_assert_uint_eq(requestId, 4);
+    ck_assert_uint_eq(message.length, 4);
+    ck_assert(memcmp(message.data, b, 4) == 0);
+    ck_assert_uint_eq(channel.chunksCount, 0);
+    ck_assert_uint_eq(channel.chunksLength, 0);
+
+    UA_ByteString_clear(&message);
+    UA_ByteString_clear(&buffer);
+} END_TEST
+
+START_TEST(decodeTooManyChunksShallFail) {
+    channel.config.localMaxChunkCount = 2;
+    UA_Byte a[4] = {1, 2, 3, 4};
+    UA_ByteString buffer;
+    UA_ByteString_allocBuffer(&buffer, 3 * (MSG_CHUNK_HEADER_LENGTH + 4));
+    size_t len = 0;
+    for(size_t i = 0; i < 3; i++)
+        len += encodeChunk(&buffer.data[len], 'C', 1, a, 4);
+    UA_ByteString chunks = {len, buffer.data};
+    UA_ByteString message = UA_BYTESTRING_NULL;
+    UA_StatusCode res;
+    UA_UInt32 requestId = 0;
+    size_t messages = processBuffer(chunks, &res, &requestId, &message);
+    ck_assert_uint_eq(messages, 0);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADTCPMESSAGETOOLARGE);
+    UA_ByteString_clear(&buffer);
+} END_TEST
+
+/* Reassemble a 16MB message from 64kB chunks */
+START_TEST(benchmarkDecodeChunks) {
+    size_t payloadLength = 16 * 1024 * 1024;
+    size_t chunkPayload = channel.config.recvBufferSize - MSG_CHUNK_HEADER_LENGTH;
+    size_t rounds = 10;
+    UA_Byte *payload = (UA_Byte*)UA_calloc(payloadLength, 1);
+    UA_ByteString buffer;
+    UA_ByteString_allocBuffer(&buffer, channel.config.recvBufferSize);
+    UA_ByteString message = UA_BYTESTRING_NULL;
+    UA_StatusCode res;
+    UA_UInt32 requestId = 0;
+
+    UA_DateTime begin = UA_DateTime_nowMonotonic();
+    for(size_t r = 0; r < rounds; r++) {
+        size_t messages = 0;
+        for(size_t pos = 0; pos < payloadLength; pos += chunkPayload) {
+            size_t len = payloadLength - pos;
+            UA_Byte chunkType = 'F';
+            if(len > chunkPayload) {
+                len = chunkPayload;
+                chunkType = 'C';
+            }
+            UA_ByteString chunk = {encodeChunk(buffer.data, chunkType, 1,
+                                               &payload[pos], len), buffer.data};
+            messages += processBuffer(chunk, &res, &requestId, &message);
+            ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        }
+        ck_assert_uint_eq(messages, 1);
+        ck_assert_uint_eq(message.length, payloadLength);
+    }
+    UA_DateTime end = UA_DateTime_nowMonotonic();
+
+    double duration = (double)(end - begin) / UA_DATETIME_SEC;
+    double megabytes = (double)(rounds * payloadLength) / (1024.0 * 1024.0);
+    printf("Reassembled %lu messages of 16MB in %.3f s (%.0f MB/s, "
+           "including the encoding of the chunks)\n",
+           (unsigned long)rounds, duration, megabytes / duration);
+
+    UA_ByteString_clear(&message);
+    UA_ByteString_clear(&buffer);
+    UA_free(payload);
+} END_TEST
+
 int main(void) {
     Suite *s = suite_create("Chunked encoding");
     TCase *tc_message = tcase_create("encode chunking");
@@ -159,6 +385,14 @@ int main(void) {
     tcase_add_test(tc_message,encodeTwoStringsIntoTenChunksShallWork);
     suite_add_tcase(s, tc_message);
 
+    TCase *tc_decode = tcase_create("decode chunking");
+    tcase_add_checked_fixture(tc_decode, setupChannel, teardownChannel);
+    tcase_add_test(tc_decode, decodeMessageFromChunksShallWork);
+    tcase_add_test(tc_decode, decodeInterleavedAndAbortedChunksShallWork);
+    tcase_add_test(tc_decode, decodeTooManyChunksShallFail);
+    tcase_add_test(tc_decode, benchmarkDecodeChunks);
+    suite_add_tcase(s, tc_decode);
+
     SRunner *sr = srunner_create(s);
     srunner_set_fork_status(sr, CK_NOFORK);
     srunner_run_all(sr, CK_NORMAL);
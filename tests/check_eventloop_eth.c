@@ -16,6 +16,8 @@ static UA_EventLoop *el;
 static char *testMsg = "open62541";
 static uintptr_t clientId;
 static UA_Boolean received;
+static size_t receivedCount;
+static size_t mappedCount;
 
 #define ETHERNET_INTERFACE "lo" /* use the loopback interface for testing */
 #define MULTICAST_MAC_ADDRESS "00-00-00-00-00-00"
@@ -47,13 +49,14 @@ connectionCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
         ctx->connCount++;
         clientId = connectionId;
 
-        /* The remote-hostname is set during the first callback */
-        if(params->mapSize> 0) {
-            const void *hn =
-                UA_KeyValueMap_getScalar(params, UA_QUALIFIEDNAME(0, "remote-hostname"),
-                                         &UA_TYPES[UA_TYPES_STRING]);
-            ck_assert(hn != NULL);
-        }
+        /* Whether a PACKET_MMAP ring is used is reported in the first
+         * callback */
+        const UA_Boolean *mmapped = (const UA_Boolean*)
+            UA_KeyValueMap_getScalar(params, UA_QUALIFIEDNAME(0, "packet-mmap"),
+                                     &UA_TYPES[UA_TYPES_BOOLEAN]);
+        ck_assert(mmapped != NULL);
+        if(*mmapped)
+            mappedCount++;
     }
 
     if(status == UA_CONNECTIONSTATE_CLOSING)
@@ -63,6 +66,7 @@ connectionCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
         UA_ByteString rcv = UA_BYTESTRING(testMsg);
         ck_assert(UA_String_equal(&msg, &rcv));
         received = true;
+        receivedCount++;
     }
 }
 
@@ -197,11 +201,140 @@ START_TEST(connectETH) {
     el = NULL;
 } END_TEST
 
+/* Send and receive through the PACKET_MMAP rings. Frames sent with the "more"
+ * parameter are flushed together. Replace the interface with one end of a veth
+ * pair to test against a real driver. */
+START_TEST(connectETHPacketMmap) {
+    UA_ConnectionManager *cm = UA_ConnectionManager_new_POSIX_Ethernet(UA_STRING("ethCM"));
+    el = UA_EventLoop_new_POSIX(UA_Log_Stdout);
+    el->registerEventSource(el, &cm->eventSource);
+    el->start(el);
+
+    UA_String interface = UA_STRING(ETHERNET_INTERFACE);
+    UA_String address = UA_STRING(MULTICAST_MAC_ADDRESS);
+    UA_Boolean listen = true;
+    UA_Boolean packetMmap = true;
+    UA_UInt32 frames = 8;
+    UA_UInt16 etherType = 0xb62c; /* OPC UA PubSub EtherType */
+
+    UA_KeyValuePair params[6];
+    params[0].key = UA_QUALIFIEDNAME(0, "address");
+    UA_Variant_setScalar(&params[0].value, &address, &UA_TYPES[UA_TYPES_STRING]);
+    params[1].key = UA_QUALIFIEDNAME(0, "packet-mmap-frames");
+    UA_Variant_setScalar(&params[1].value, &frames, &UA_TYPES[UA_TYPES_UINT32]);
+    params[2].key = UA_QUALIFIEDNAME(0, "interface");
+    UA_Variant_setScalar(&params[2].value, &interface, &UA_TYPES[UA_TYPES_STRING]);
+    params[3].key = UA_QUALIFIEDNAME(0, "ethertype");
+    UA_Variant_setScalar(&params[3].value, &etherType, &UA_TYPES[UA_TYPES_UINT16]);
+    params[4].key = UA_QUALIFIEDNAME(0, "packet-mmap");
+    UA_Variant_setScalar(&params[4].value, &packetMmap, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    params[5].key = UA_QUALIFIEDNAME(0, "listen");
+    UA_Variant_setScalar(&params[5].value, &listen, &UA_TYPES[UA_TYPES_BOOLEAN]);
+
+    TestContext testContext;
+    testContext.connCount = 0;
+    mappedCount = 0;
+
+    /* Don't use the address parameter for listening. The RX ring has the
+     * default size. */
+    UA_KeyValueMap kvm = {4, &params[2]};
+    UA_StatusCode retval =
+        cm->openConnection(cm, &kvm, NULL, &testContext, connectionCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* The frames must not silently fall back to recv/sendto */
+    ck_assert_uint_eq(mappedCount, 1);
+
+    size_t listenSockets = testContext.connCount;
+
+    /* Open a client connection with a small TX ring. Don't use the listen
+     * parameter. */
+    kvm.map = params;
+    kvm.mapSize = 5;
+    clientId = 0;
+    retval = cm->openConnection(cm, &kvm, NULL, &testContext, connectionCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < 2; i++) {
+        UA_DateTime next = el->run(el, 1);
+        UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+    }
+    ck_assert(clientId != 0);
+    ck_assert_uint_eq(testContext.connCount, listenSockets + 1);
+    ck_assert_uint_eq(mappedCount, 2);
+
+    /* Send more frames than the TX ring has slots. All but the last one with
+     * the "more" parameter. */
+    UA_Boolean more = true;
+    UA_KeyValuePair moreParam;
+    moreParam.key = UA_QUALIFIEDNAME(0, "more");
+    UA_Variant_setScalar(&moreParam.value, &more, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    UA_KeyValueMap moreMap = {1, &moreParam};
+    received = false;
+    receivedCount = 0;
+    const size_t sendCount = 20;
+    for(size_t i = 0; i < sendCount; i++) {
+        UA_ByteString snd;
+        retval = cm->allocNetworkBuffer(cm, clientId, &snd, strlen(testMsg));
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        memcpy(snd.data, testMsg, strlen(testMsg));
+        retval = cm->sendWithConnection(cm, clientId,
+                                        (i + 1 < sendCount) ? &moreMap : NULL, &snd);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+
+    /* The listen socket also sees the outgoing frames on the loopback
+     * interface. Wait until (at least) every frame was received once. */
+    for(size_t i = 0; i < 100 && receivedCount < sendCount; i++) {
+        UA_DateTime next = el->run(el, 10);
+        UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+    }
+    ck_assert(received);
+    ck_assert_uint_ge(receivedCount, sendCount);
+
+    /* A frame sent with "more" only is flushed in the next EventLoop iteration */
+    receivedCount = 0;
+    UA_ByteString snd;
+    retval = cm->allocNetworkBuffer(cm, clientId, &snd, strlen(testMsg));
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    memcpy(snd.data, testMsg, strlen(testMsg));
+    retval = cm->sendWithConnection(cm, clientId, &moreMap, &snd);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < 100 && receivedCount == 0; i++) {
+        UA_DateTime next = el->run(el, 10);
+        UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+    }
+    ck_assert_uint_gt(receivedCount, 0);
+
+    /* Close the connection */
+    retval = cm->closeConnection(cm, clientId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < 2; i++) {
+        UA_DateTime next = el->run(el, 1);
+        UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+    }
+    ck_assert_uint_eq(testContext.connCount, listenSockets);
+
+    /* Stop the EventLoop */
+    int max_stop_iteration_count = 10;
+    int iteration = 0;
+    el->stop(el);
+    while(el->state != UA_EVENTLOOPSTATE_STOPPED &&
+          iteration < max_stop_iteration_count) {
+        UA_DateTime next = el->run(el, 1);
+        UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+        iteration++;
+    }
+    ck_assert(el->state == UA_EVENTLOOPSTATE_STOPPED);
+    el->free(el);
+    el = NULL;
+} END_TEST
+
 int main(void) {
     Suite *s  = suite_create("Test ETH EventLoop");
     TCase *tc = tcase_create("test cases");
     tcase_add_test(tc, listenETH);
     tcase_add_test(tc, connectETH);
+    tcase_add_test(tc, connectETHPacketMmap);
     suite_add_tcase(s, tc);
 
     SRunner *sr = srunner_create(s);
@@ -12,6 +12,14 @@
 #include <stdlib.h>
 #include <check.h>
 
+#ifdef __linux__
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
 static UA_EventLoop *el;
 static UA_ConnectionManager *cm;
 static unsigned connCount;
@@ -19,12 +27,18 @@ static char *testMsg = "open62541";
 static uintptr_t clientId;
 static UA_Boolean received;
 
-static void setupEL(void) {
+static void setupEL(UA_Boolean uring) {
+    (void)uring;
 #if defined(UA_ARCHITECTURE_LWIP)
     el = UA_EventLoop_new_LWIP(UA_Log_Stdout, NULL);
     cm = UA_ConnectionManager_new_LWIP_TCP(UA_STRING("tcpCM"));
     el->registerEventSource(el, &cm->eventSource);
 #elif defined(UA_ARCHITECTURE_POSIX) || defined(UA_ARCHITECTURE_WIN32)
+#ifdef __linux__
+    if(uring)
+        el = UA_EventLoop_new_POSIX_IOURING(UA_Log_Stdout);
+    else
+#endif
     el = UA_EventLoop_new_POSIX(UA_Log_Stdout);
     cm = UA_ConnectionManager_new_POSIX_TCP(UA_STRING("tcpCM"));
     /* Set up the TCP EventLoop parameters */
@@ -72,7 +86,7 @@ connectionCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
 }
 
 START_TEST(listenTCP) {
-    setupEL();
+    setupEL(_i);
     el->start(el);
 
     UA_UInt16 port = 4840;
@@ -125,7 +139,7 @@ START_TEST(listenTCP) {
 } END_TEST
 
 START_TEST(connectTCP) {
-    setupEL();
+    setupEL(_i);
     el->start(el);
 
     UA_UInt16 port = 4840;
@@ -189,6 +203,27 @@ START_TEST(connectTCP) {
     }
     ck_assert(received);
 
+    /* Send the message in several parts with a single vectored send */
+    if(cm->sendWithConnectionVec) {
+        received = false;
+        UA_ByteString parts[3];
+        size_t partLengths[3] = {4, 0, strlen(testMsg) - 4};
+        size_t offset = 0;
+        for(size_t i = 0; i < 3; i++) {
+            retval = cm->allocNetworkBuffer(cm, clientId, &parts[i], partLengths[i]);
+            ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+            memcpy(parts[i].data, testMsg + offset, partLengths[i]);
+            offset += partLengths[i];
+        }
+        retval = cm->sendWithConnectionVec(cm, clientId, NULL, parts, 3);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        for(size_t i = 0; i < 2; i++) {
+            UA_DateTime next = el->run(el, 1);
+            UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+        }
+        ck_assert(received);
+    }
+
 #if !defined(UA_ARCHITECTURE_LWIP)
     /* Open a second client connection.
      * This should fail because the maximum number of sockets has been reached */
@@ -225,11 +260,261 @@ START_TEST(connectTCP) {
     el = NULL;
 } END_TEST
 
+/* Large messages arrive in several chunks. The receiving side checks the
+ * byte pattern continuously across the chunks. */
+#define LARGE_MSG_SIZE (64 * 1024 + 123)
+static size_t largeReceived;
+
+static void
+largeMessageCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
+                     void *application, void **connectionContext,
+                     UA_ConnectionState status,
+                     const UA_KeyValueMap *params,
+                     UA_ByteString msg) {
+    if(*connectionContext != NULL)
+        clientId = connectionId;
+    if(msg.length == 0 && status == UA_CONNECTIONSTATE_ESTABLISHED)
+        connCount++;
+    if(status == UA_CONNECTIONSTATE_CLOSING)
+        connCount--;
+
+    /* Only the server side receives */
+    ck_assert(msg.length == 0 || *connectionContext == NULL);
+    for(size_t i = 0; i < msg.length; i++) {
+        ck_assert_uint_eq(msg.data[i], (UA_Byte)((largeReceived % LARGE_MSG_SIZE) % 251));
+        largeReceived++;
+    }
+}
+
+static void
+sendLargeMessage(void) {
+    UA_ByteString parts[4];
+    size_t offset = 0;
+    for(size_t i = 0; i < 4; i++) {
+        size_t len = (i < 3) ? LARGE_MSG_SIZE / 4 : LARGE_MSG_SIZE - offset;
+        UA_StatusCode res = cm->allocNetworkBuffer(cm, clientId, &parts[i], len);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        for(size_t j = 0; j < len; j++)
+            parts[i].data[j] = (UA_Byte)((offset + j) % 251);
+        offset += len;
+        if(!cm->sendWithConnectionVec) {
+            res = cm->sendWithConnection(cm, clientId, NULL, &parts[i]);
+            ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        }
+    }
+    if(cm->sendWithConnectionVec) {
+        UA_StatusCode res = cm->sendWithConnectionVec(cm, clientId, NULL, parts, 4);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+}
+
+START_TEST(sendLargeTCP) {
+    setupEL(_i);
+    el->start(el);
+
+    UA_UInt16 port = 4840;
+    UA_Boolean listen = true;
+    UA_String host = UA_STRING("localhost");
+    UA_Boolean reuseaddr = true;
+
+    UA_KeyValuePair params[4];
+    params[0].key = UA_QUALIFIEDNAME(0, "port");
+    UA_Variant_setScalar(&params[0].value, &port, &UA_TYPES[UA_TYPES_UINT16]);
+    params[1].key = UA_QUALIFIEDNAME(0, "listen");
+    UA_Variant_setScalar(&params[1].value, &listen, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    params[2].key = UA_QUALIFIEDNAME(0, "address");
+    UA_Variant_setScalar(&params[2].value, &host, &UA_TYPES[UA_TYPES_STRING]);
+    params[3].key = UA_QUALIFIEDNAME(0, "reuse");
+    UA_Variant_setScalar(&params[3].value, &reuseaddr, &UA_TYPES[UA_TYPES_BOOLEAN]);
+
+    UA_KeyValueMap paramsMap;
+    paramsMap.map = params;
+    paramsMap.mapSize = 4;
+
+    connCount = 0;
+    cm->openConnection(cm, &paramsMap, NULL, NULL, largeMessageCallback);
+    size_t listenSockets = connCount;
+
+#if !defined(UA_ARCHITECTURE_LWIP)
+    UA_UInt32 maxSockets = (UA_UInt32)(listenSockets + 1);
+    UA_KeyValueMap_setScalar(&cm->eventSource.params, UA_QUALIFIEDNAME(0, "max-connections"),
+                             (void *)&maxSockets, &UA_TYPES[UA_TYPES_UINT32]);
+#endif
+
+    /* Open a client connection */
+    clientId = 0;
+    listen = false;
+    UA_StatusCode retval =
+        cm->openConnection(cm, &paramsMap, NULL, (void*)0x01, largeMessageCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < 2; i++) {
+        UA_DateTime next = el->run(el, 1);
+        UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+    }
+    ck_assert(clientId != 0);
+    ck_assert_uint_eq(connCount, listenSockets + 2);
+
+    /* The message is larger than a single receive buffer */
+    largeReceived = 0;
+    sendLargeMessage();
+    for(size_t i = 0; i < 1000 && largeReceived < LARGE_MSG_SIZE; i++) {
+        UA_DateTime next = el->run(el, 1);
+        UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+    }
+    ck_assert_uint_eq(largeReceived, LARGE_MSG_SIZE);
+
+    /* Data sent right before closing the connection is still delivered */
+    sendLargeMessage();
+    retval = cm->closeConnection(cm, clientId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < 1000 && connCount > listenSockets; i++) {
+        UA_DateTime next = el->run(el, 1);
+        UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+    }
+    ck_assert_uint_eq(largeReceived, 2 * LARGE_MSG_SIZE);
+    ck_assert_uint_eq(connCount, listenSockets);
+
+    /* Stop the EventLoop */
+    int max_stop_iteration_count = 10;
+    int iteration = 0;
+    el->stop(el);
+    while(el->state != UA_EVENTLOOPSTATE_STOPPED &&
+          iteration < max_stop_iteration_count) {
+        UA_DateTime next = el->run(el, 1);
+        UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+        iteration++;
+    }
+    ck_assert(el->state == UA_EVENTLOOPSTATE_STOPPED);
+    el->free(el);
+    el = NULL;
+} END_TEST
+
+#ifdef __linux__
+static unsigned stalledCount;
+static uintptr_t stalledId;
+
+static void
+stalledCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
+                void *application, void **connectionContext,
+                UA_ConnectionState status,
+                const UA_KeyValueMap *params,
+                UA_ByteString msg) {
+    if(msg.length == 0 && status == UA_CONNECTIONSTATE_ESTABLISHED) {
+        stalledCount++;
+        stalledId = connectionId;
+    }
+    if(status == UA_CONNECTIONSTATE_CLOSING)
+        stalledCount--;
+}
+
+/* The peer does not read. The sends that are still pending when the
+ * connection is closed must not keep the socket open forever. */
+START_TEST(closeStalledPeerTCP) {
+    setupEL(true);
+    el->dateTime_nowMonotonic = UA_DateTime_now_fake;
+    el->start(el);
+
+    UA_UInt16 port = 4840;
+    UA_Boolean listen = true;
+    UA_String host = UA_STRING("127.0.0.1");
+    UA_Boolean reuseaddr = true;
+
+    UA_KeyValuePair params[4];
+    params[0].key = UA_QUALIFIEDNAME(0, "port");
+    UA_Variant_setScalar(&params[0].value, &port, &UA_TYPES[UA_TYPES_UINT16]);
+    params[1].key = UA_QUALIFIEDNAME(0, "listen");
+    UA_Variant_setScalar(&params[1].value, &listen, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    params[2].key = UA_QUALIFIEDNAME(0, "address");
+    UA_Variant_setScalar(&params[2].value, &host, &UA_TYPES[UA_TYPES_STRING]);
+    params[3].key = UA_QUALIFIEDNAME(0, "reuse");
+    UA_Variant_setScalar(&params[3].value, &reuseaddr, &UA_TYPES[UA_TYPES_BOOLEAN]);
+
+    UA_KeyValueMap paramsMap;
+    paramsMap.map = params;
+    paramsMap.mapSize = 4;
+
+    stalledCount = 0;
+    cm->openConnection(cm, &paramsMap, NULL, NULL, stalledCallback);
+    size_t listenSockets = stalledCount;
+    ck_assert_uint_gt(listenSockets, 0);
+
+    UA_UInt32 maxSockets = (UA_UInt32)(listenSockets + 1);
+    UA_KeyValueMap_setScalar(&cm->eventSource.params, UA_QUALIFIEDNAME(0, "max-connections"),
+                             (void *)&maxSockets, &UA_TYPES[UA_TYPES_UINT32]);
+
+    /* Connect a peer with a small receive buffer that never reads */
+    int peer = socket(AF_INET, SOCK_STREAM, 0);
+    ck_assert_int_ge(peer, 0);
+    int rcvbuf = 4096;
+    setsockopt(peer, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(int));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(struct sockaddr_in));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ck_assert_int_eq(connect(peer, (struct sockaddr*)&addr, sizeof(addr)), 0);
+    for(size_t i = 0; i < 100 && stalledCount == listenSockets; i++)
+        el->run(el, 1);
+    ck_assert_uint_eq(stalledCount, listenSockets + 1);
+
+    /* Send more than the socket buffers can hold */
+    clientId = stalledId;
+    for(size_t i = 0; i < 256; i++)
+        sendLargeMessage();
+    for(size_t i = 0; i < 10; i++)
+        el->run(el, 1);
+
+    /* Close with the sends still pending */
+    UA_StatusCode retval = cm->closeConnection(cm, stalledId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < 100 && stalledCount > listenSockets; i++)
+        el->run(el, 1);
+    ck_assert_uint_eq(stalledCount, listenSockets);
+
+    /* After the linger time the connection is aborted */
+    for(size_t i = 0; i < 100; i++) {
+        el->run(el, 1);
+        UA_fakeSleep(100);
+    }
+    char buf[4096];
+    ssize_t received = 0;
+    ssize_t res;
+    do {
+        struct pollfd pfd = {peer, POLLIN, 0};
+        ck_assert_int_eq(poll(&pfd, 1, 1000), 1);
+        res = recv(peer, buf, sizeof(buf), 0);
+        if(res > 0)
+            received += res;
+    } while(res > 0);
+    ck_assert(res == 0 || errno == ECONNRESET);
+    ck_assert_int_lt(received, 256 * LARGE_MSG_SIZE);
+    close(peer);
+
+    /* Stop the EventLoop */
+    int max_stop_iteration_count = 10;
+    int iteration = 0;
+    el->stop(el);
+    while(el->state != UA_EVENTLOOPSTATE_STOPPED &&
+          iteration < max_stop_iteration_count) {
+        el->run(el, 1);
+        iteration++;
+    }
+    ck_assert(el->state == UA_EVENTLOOPSTATE_STOPPED);
+    el->free(el);
+    el = NULL;
+} END_TEST
+#endif
+
 int main(void) {
     Suite *s  = suite_create("Test TCP EventLoop");
     TCase *tc = tcase_create("test cases");
-    tcase_add_test(tc, listenTCP);
-    tcase_add_test(tc, connectTCP);
+    /* The second iteration uses io_uring on Linux */
+    tcase_add_loop_test(tc, listenTCP, 0, 2);
+    tcase_add_loop_test(tc, connectTCP, 0, 2);
+    tcase_add_loop_test(tc, sendLargeTCP, 0, 2);
+#ifdef __linux__
+    tcase_add_test(tc, closeStalledPeerTCP);
+#endif
     suite_add_tcase(s, tc);
 
     SRunner *sr = srunner_create(s);
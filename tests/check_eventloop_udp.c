@@ -8,6 +8,9 @@
 #include "open62541/types_generated.h"
 
 #include "testing_clock.h"
+#if defined(__linux__) && !defined(UA_ARCHITECTURE_LWIP)
+#include "../arch/posix/eventloop_posix.h"
+#endif
 #include <time.h>
 #include <stdlib.h>
 #include <check.h>
@@ -21,6 +24,7 @@ static UA_ConnectionManager *cmTalker;
 static char *testMsg = "open62541";
 static uintptr_t clientId;
 static UA_Boolean received;
+static unsigned receivedCount;
 
 typedef struct TestContext {
     unsigned connCount;
@@ -103,6 +107,7 @@ connectionCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
         UA_ByteString rcv = UA_BYTESTRING(testMsg);
         ck_assert(UA_String_equal(&msg, &rcv));
         received = true;
+        receivedCount++;
     }
 }
 
@@ -421,6 +426,100 @@ START_TEST(udpTalkerAndListener) {
     ck_assert_uint_eq(testContext.connCount, 0);
 } END_TEST
 
+#if defined(__linux__) && !defined(UA_ARCHITECTURE_LWIP)
+/* Datagrams sent with the "more" flag are queued and sent with a single
+ * sendmmsg. The listener drains them with a single recvmmsg. */
+START_TEST(udpBatchedTalkerAndListener) {
+    setupELTalkerAndListener();
+    elListener->start(elListener);
+    elTalker->start(elTalker);
+
+    UA_UInt16 port = 30000;
+    UA_Boolean listen = true;
+    UA_String targetHost = UA_STRING("127.0.0.1");
+
+    UA_KeyValuePair params[3];
+    UA_KeyValueMap paramsMap = {3, params};
+    params[0].key = UA_QUALIFIEDNAME(0, "port");
+    UA_Variant_setScalar(&params[0].value, &port, &UA_TYPES[UA_TYPES_UINT16]);
+    params[1].key = UA_QUALIFIEDNAME(0, "listen");
+    UA_Variant_setScalar(&params[1].value, &listen, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    params[2].key = UA_QUALIFIEDNAME(0, "address");
+    UA_Variant_setScalar(&params[2].value, &targetHost, &UA_TYPES[UA_TYPES_STRING]);
+
+    TestContext testContext;
+    testContext.connCount = 0;
+    UA_StatusCode retval =
+        cmListener->openConnection(cmListener, &paramsMap, NULL, &testContext,
+                                   connectionCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    clientId = 0;
+    listen = false;
+    retval = cmTalker->openConnection(cmTalker, &paramsMap, NULL, &testContext,
+                                      connectionCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_ne(clientId, 0);
+
+    /* Queue three datagrams and flush with the fourth */
+    UA_Boolean more = true;
+    UA_KeyValuePair moreParam;
+    moreParam.key = UA_QUALIFIEDNAME(0, "more");
+    UA_Variant_setScalar(&moreParam.value, &more, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    UA_KeyValueMap moreMap = {1, &moreParam};
+    for(size_t i = 0; i < 4; i++) {
+        UA_ByteString snd;
+        retval = cmTalker->allocNetworkBuffer(cmTalker, clientId, &snd, strlen(testMsg));
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        memcpy(snd.data, testMsg, strlen(testMsg));
+        retval = cmTalker->sendWithConnection(cmTalker, clientId,
+                                              (i < 3) ? &moreMap : &UA_KEYVALUEMAP_NULL,
+                                              &snd);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    UA_POSIXUDPConnectionManager *talker = (UA_POSIXUDPConnectionManager*)cmTalker;
+    ck_assert_uint_eq(talker->sendCalls, 1);
+    ck_assert_uint_eq(talker->sendDatagrams, 4);
+
+    receivedCount = 0;
+    elListener->run(elListener, 1);
+    ck_assert_uint_eq(receivedCount, 4);
+    UA_POSIXUDPConnectionManager *listener = (UA_POSIXUDPConnectionManager*)cmListener;
+    ck_assert_uint_eq(listener->recvCalls, 1);
+    ck_assert_uint_eq(listener->recvDatagrams, 4);
+
+    /* Queued datagrams are sent in the next EventLoop iteration at the latest */
+    UA_ByteString snd;
+    retval = cmTalker->allocNetworkBuffer(cmTalker, clientId, &snd, strlen(testMsg));
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    memcpy(snd.data, testMsg, strlen(testMsg));
+    retval = cmTalker->sendWithConnection(cmTalker, clientId, &moreMap, &snd);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(talker->sendDatagrams, 4);
+    elTalker->run(elTalker, 1);
+    ck_assert_uint_eq(talker->sendDatagrams, 5);
+    elListener->run(elListener, 1);
+    ck_assert_uint_eq(receivedCount, 5);
+
+    /* Stop the EventLoops */
+    elTalker->stop(elTalker);
+    for(size_t i = 0; i < 10 && elTalker->state != UA_EVENTLOOPSTATE_STOPPED; i++)
+        elTalker->run(elTalker, 1);
+    ck_assert_int_eq(elTalker->state, UA_EVENTLOOPSTATE_STOPPED);
+    elTalker->free(elTalker);
+    elTalker = NULL;
+
+    elListener->stop(elListener);
+    for(size_t i = 0; i < 10 && elListener->state != UA_EVENTLOOPSTATE_STOPPED; i++)
+        elListener->run(elListener, 1);
+    ck_assert_int_eq(elListener->state, UA_EVENTLOOPSTATE_STOPPED);
+    elListener->free(elListener);
+    elListener = NULL;
+
+    ck_assert_uint_eq(testContext.connCount, 0);
+} END_TEST
+#endif
+
 START_TEST(udpTalkerAndListenerDifferentDestination) {
     /* create listener eventloop */
     setupELTalkerAndListener();
@@ -547,6 +646,9 @@ int main(void) {
     tcase_add_test(tc, connectUDPValidationSucceeds);
     tcase_add_test(tc, udpTalkerAndListener);
     tcase_add_test(tc, udpTalkerAndListenerDifferentDestination);
+#if defined(__linux__) && !defined(UA_ARCHITECTURE_LWIP)
+    tcase_add_test(tc, udpBatchedTalkerAndListener);
+#endif
     suite_add_tcase(s, tc);
 
     SRunner *sr = srunner_create(s);
@@ -526,6 +526,369 @@ START_TEST(SecureChannel_assemblePartialChunks) {
 } END_TEST
 
 
+/* ConnectionManager that records the buffers handed over for sending. Every
+ * send call stores the number of buffers and the "more" parameter. The other
+ * methods are taken from the testing ConnectionManager. */
+#define RECORD_MAX_SENDS 64
+#define RECORD_MAX_CHUNKS 128
+#define RECORD_BUFFER_SIZE 1024
+
+typedef struct {
+    size_t firstChunk;
+    size_t chunks;
+    UA_Boolean more;
+} RecordedSend;
+
+static UA_ConnectionManager recordingCM;
+static RecordedSend recordedSends[RECORD_MAX_SENDS];
+static size_t recordedSendsSize;
+static UA_ByteString recordedChunks[RECORD_MAX_CHUNKS];
+static size_t recordedChunksSize;
+static size_t openBuffers; /* Allocated but neither sent nor freed */
+
+/* Hand out the same memory for every buffer like a ConnectionManager with a
+ * static send buffer that does not track its use */
+static UA_Boolean useStaticBuffer;
+static UA_Byte staticBuffer[RECORD_BUFFER_SIZE];
+
+static UA_StatusCode
+recordAllocNetworkBuffer(UA_ConnectionManager *cm, uintptr_t connectionId,
+                         UA_ByteString *buf, size_t bufSize) {
+    openBuffers++;
+    if(!useStaticBuffer)
+        return UA_ByteString_allocBuffer(buf, bufSize);
+    ck_assert_uint_le(bufSize, RECORD_BUFFER_SIZE);
+    buf->data = staticBuffer;
+    buf->length = bufSize;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+recordFreeNetworkBuffer(UA_ConnectionManager *cm, uintptr_t connectionId,
+                        UA_ByteString *buf) {
+    if(!buf->data)
+        return;
+    ck_assert_uint_gt(openBuffers, 0);
+    openBuffers--;
+    if(buf->data == staticBuffer)
+        UA_ByteString_init(buf);
+    else
+        UA_ByteString_clear(buf);
+}
+
+static void
+recordSend(const UA_KeyValueMap *params, UA_ByteString *bufs, size_t bufsSize) {
+    ck_assert_uint_lt(recordedSendsSize, RECORD_MAX_SENDS);
+    ck_assert_uint_le(recordedChunksSize + bufsSize, RECORD_MAX_CHUNKS);
+    const UA_Boolean *more = (const UA_Boolean*)
+        UA_KeyValueMap_getScalar(params, UA_QUALIFIEDNAME(0, "more"),
+                                 &UA_TYPES[UA_TYPES_BOOLEAN]);
+    RecordedSend *rs = &recordedSends[recordedSendsSize++];
+    rs->firstChunk = recordedChunksSize;
+    rs->chunks = bufsSize;
+    rs->more = (more && *more);
+    for(size_t i = 0; i < bufsSize; i++) {
+        ck_assert_uint_gt(openBuffers, 0);
+        openBuffers--;
+        if(bufs[i].data == staticBuffer) {
+            UA_ByteString_copy(&bufs[i], &recordedChunks[recordedChunksSize++]);
+            UA_ByteString_init(&bufs[i]);
+        } else {
+            recordedChunks[recordedChunksSize++] = bufs[i];
+            UA_ByteString_init(&bufs[i]);
+        }
+    }
+}
+
+static UA_StatusCode
+recordSendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
+                         const UA_KeyValueMap *params, UA_ByteString *buf) {
+    recordSend(params, buf, 1);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+recordSendWithConnectionVec(UA_ConnectionManager *cm, uintptr_t connectionId,
+                            const UA_KeyValueMap *params,
+                            UA_ByteString *bufs, size_t bufsSize) {
+    recordSend(params, bufs, bufsSize);
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+setup_recordingCM(UA_Boolean vectored) {
+    recordingCM = testConnectionManagerTCP;
+    recordingCM.sendWithConnection = recordSendWithConnection;
+    recordingCM.sendWithConnectionVec = (vectored) ? recordSendWithConnectionVec : NULL;
+    recordingCM.allocNetworkBuffer = recordAllocNetworkBuffer;
+    recordingCM.freeNetworkBuffer = recordFreeNetworkBuffer;
+    recordedSendsSize = 0;
+    recordedChunksSize = 0;
+    openBuffers = 0;
+    useStaticBuffer = false;
+
+    testChannel.connectionManager = &recordingCM;
+    testChannel.securityMode = UA_MESSAGESECURITYMODE_NONE;
+    testChannel.config.sendBufferSize = RECORD_BUFFER_SIZE;
+}
+
+static void
+teardown_recordingCM(void) {
+    UA_SecureChannel_clear(&testChannel);
+    for(size_t i = 0; i < recordedChunksSize; i++)
+        UA_ByteString_clear(&recordedChunks[i]);
+    recordedChunksSize = 0;
+    ck_assert_uint_eq(openBuffers, 0);
+}
+
+/* Send a ByteString payload that is split into several chunks */
+static size_t
+sendLargeMessage(UA_UInt32 requestId, size_t payloadSize) {
+    UA_ByteString payload;
+    UA_StatusCode res = UA_ByteString_allocBuffer(&payload, payloadSize);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    memset(payload.data, 'x', payloadSize);
+    size_t before = recordedChunksSize;
+    res = UA_SecureChannel_sendSymmetricMessage(&testChannel, requestId,
+                                                UA_MESSAGETYPE_MSG, &payload,
+                                                &UA_TYPES[UA_TYPES_BYTESTRING]);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_ByteString_clear(&payload);
+    /* Number of chunks that were sent out right away */
+    return recordedChunksSize - before;
+}
+
+/* Check that the chunks of a symmetric message are recorded in order */
+static void
+checkMessageChunks(size_t firstChunk, size_t chunks, UA_UInt32 requestId) {
+    UA_UInt32 firstSequenceNumber = 0;
+    for(size_t i = 0; i < chunks; i++) {
+        const UA_ByteString *chunk = &recordedChunks[firstChunk + i];
+        ck_assert_uint_ge(chunk->length, 24);
+        const char *type = (i + 1 < chunks) ? "MSGC" : "MSGF";
+        ck_assert(memcmp(chunk->data, type, 4) == 0);
+
+        size_t offset = 16;
+        UA_SequenceHeader seqHeader;
+        UA_StatusCode res =
+            UA_decodeBinaryInternal(chunk, &offset, &seqHeader,
+                                    &UA_TRANSPORT[UA_TRANSPORT_SEQUENCEHEADER], NULL);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(seqHeader.requestId, requestId);
+        if(i == 0)
+            firstSequenceNumber = seqHeader.sequenceNumber;
+        ck_assert_uint_eq(seqHeader.sequenceNumber, firstSequenceNumber + i);
+    }
+}
+
+/* Check the batching of the recorded sends. With a vectored send, a full queue
+ * is sent except for its last chunk and marked with "more". The remaining
+ * chunks follow in the final batch without "more". Otherwise every chunk is
+ * sent on its own and all but the last are marked with "more". */
+static void
+checkBatches(size_t chunks, UA_Boolean vectored) {
+    size_t send = 0;
+    size_t chunk = 0;
+    while(chunk < chunks) {
+        size_t expected = 1;
+        if(vectored) {
+            expected = chunks - chunk;
+            if(expected > UA_SECURECHANNEL_SENDQUEUE_SIZE)
+                expected = UA_SECURECHANNEL_SENDQUEUE_SIZE - 1;
+        }
+        ck_assert_uint_lt(send, recordedSendsSize);
+        ck_assert_uint_eq(recordedSends[send].chunks, expected);
+        chunk += expected;
+        ck_assert_uint_eq(recordedSends[send].more, chunk < chunks);
+        send++;
+    }
+    ck_assert_uint_eq(send, recordedSendsSize);
+}
+
+START_TEST(SecureChannel_sendQueue_multiChunk) {
+    setup_recordingCM(_i);
+
+    /* All chunks of the message are sent once it is complete */
+    size_t chunks = sendLargeMessage(42, 5000);
+    ck_assert_uint_gt(chunks, 1);
+    ck_assert_uint_lt(chunks, UA_SECURECHANNEL_SENDQUEUE_SIZE);
+    checkMessageChunks(0, chunks, 42);
+    checkBatches(chunks, _i);
+    ck_assert_uint_eq(openBuffers, 0);
+
+    teardown_recordingCM();
+} END_TEST
+
+START_TEST(SecureChannel_sendQueue_cork) {
+    setup_recordingCM(_i);
+
+    /* Nested cork. Nothing is sent before the outermost uncork. */
+    UA_SecureChannel_cork(&testChannel);
+    UA_SecureChannel_cork(&testChannel);
+    ck_assert_uint_eq(sendLargeMessage(1, 2000), 0);
+    ck_assert_uint_eq(sendLargeMessage(2, 2000), 0);
+    UA_StatusCode res = UA_SecureChannel_uncork(&testChannel);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(recordedSendsSize, 0);
+    size_t queued = testChannel.sendQueueSize;
+    ck_assert_uint_gt(queued, 2);
+    ck_assert_uint_lt(queued, UA_SECURECHANNEL_SENDQUEUE_SIZE);
+    res = UA_SecureChannel_uncork(&testChannel);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(testChannel.sendQueueSize, 0);
+
+    /* Both messages leave in order, in one batch if possible */
+    ck_assert_uint_eq(recordedChunksSize, queued);
+    size_t firstChunks = 0;
+    while(memcmp(recordedChunks[firstChunks].data, "MSGF", 4) != 0)
+        firstChunks++;
+    firstChunks++;
+    checkMessageChunks(0, firstChunks, 1);
+    checkMessageChunks(firstChunks, queued - firstChunks, 2);
+    checkBatches(queued, _i);
+
+    /* Without cork the next message is sent right away */
+    ck_assert_uint_gt(sendLargeMessage(3, 2000), 0);
+
+    teardown_recordingCM();
+} END_TEST
+
+START_TEST(SecureChannel_sendQueue_full) {
+    setup_recordingCM(true);
+
+    /* The queue is sent whenever it is full */
+    size_t chunks = sendLargeMessage(42, 40000);
+    ck_assert_uint_gt(chunks, 2 * UA_SECURECHANNEL_SENDQUEUE_SIZE);
+    checkMessageChunks(0, chunks, 42);
+    checkBatches(chunks, true);
+
+    /* Also while corked. Then more data follows after every batch. */
+    recordedSendsSize = 0;
+    for(size_t i = 0; i < recordedChunksSize; i++)
+        UA_ByteString_clear(&recordedChunks[i]);
+    recordedChunksSize = 0;
+    UA_SecureChannel_cork(&testChannel);
+    chunks = sendLargeMessage(43, 40000);
+    ck_assert_uint_gt(chunks, 0);
+    for(size_t i = 0; i < recordedSendsSize; i++) {
+        ck_assert_uint_eq(recordedSends[i].chunks, UA_SECURECHANNEL_SENDQUEUE_SIZE - 1);
+        ck_assert(recordedSends[i].more);
+    }
+    UA_StatusCode res = UA_SecureChannel_uncork(&testChannel);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    checkMessageChunks(0, recordedChunksSize, 43);
+    checkBatches(recordedChunksSize, true);
+
+    teardown_recordingCM();
+} END_TEST
+
+/* A corked burst that fills the queue exactly. The final send after the uncork
+ * must not be empty and must not be marked with "more". Otherwise the tail of
+ * the burst is held back in the kernel. */
+START_TEST(SecureChannel_sendQueue_corkFullBoundary) {
+    setup_recordingCM(_i);
+
+    size_t messages = 2 * UA_SECURECHANNEL_SENDQUEUE_SIZE;
+    UA_SecureChannel_cork(&testChannel);
+    for(size_t i = 0; i < messages; i++)
+        sendLargeMessage((UA_UInt32)i + 1, 100);
+    ck_assert_uint_gt(testChannel.sendQueueSize, 0);
+    UA_StatusCode res = UA_SecureChannel_uncork(&testChannel);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(testChannel.sendQueueSize, 0);
+
+    /* One chunk per message, in order */
+    ck_assert_uint_eq(recordedChunksSize, messages);
+    for(size_t i = 0; i < messages; i++)
+        checkMessageChunks(i, 1, (UA_UInt32)i + 1);
+    checkBatches(messages, _i);
+    ck_assert_uint_gt(recordedSends[recordedSendsSize-1].chunks, 0);
+    ck_assert(!recordedSends[recordedSendsSize-1].more);
+
+    teardown_recordingCM();
+} END_TEST
+
+START_TEST(SecureChannel_sendQueue_staticBuffer) {
+    setup_recordingCM(true);
+    useStaticBuffer = true;
+
+    /* The memory of the queued chunk is handed out again for the next chunk.
+     * So the queue has to be sent out before every new chunk. */
+    size_t chunks = sendLargeMessage(42, 5000);
+    ck_assert_uint_gt(chunks, 1);
+    checkMessageChunks(0, chunks, 42);
+    ck_assert_uint_eq(recordedSendsSize, chunks);
+    for(size_t i = 0; i < recordedSendsSize; i++)
+        ck_assert_uint_eq(recordedSends[i].chunks, 1);
+
+    teardown_recordingCM();
+} END_TEST
+
+START_TEST(SecureChannel_sendQueue_flushBeforeOPN) {
+    setup_recordingCM(_i);
+
+    /* The queued message is sent before the OPN message */
+    UA_SecureChannel_cork(&testChannel);
+    ck_assert_uint_eq(sendLargeMessage(1, 2000), 0);
+    size_t queued = testChannel.sendQueueSize;
+
+    UA_OpenSecureChannelResponse dummyResponse;
+    createDummyResponse(&dummyResponse);
+    UA_StatusCode res =
+        UA_SecureChannel_sendAsymmetricOPNMessage(&testChannel, 2, &dummyResponse,
+                                                  &UA_TYPES[UA_TYPES_OPENSECURECHANNELRESPONSE]);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(testChannel.sendQueueSize, 0);
+    ck_assert_uint_eq(recordedChunksSize, queued + 1);
+    checkMessageChunks(0, queued, 1);
+    ck_assert(memcmp(recordedChunks[queued].data, "OPNF", 4) == 0);
+
+    /* Nothing left to send */
+    res = UA_SecureChannel_uncork(&testChannel);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(recordedChunksSize, queued + 1);
+
+    teardown_recordingCM();
+} END_TEST
+
+START_TEST(SecureChannel_sendQueue_flushBeforeERR) {
+    setup_recordingCM(_i);
+
+    /* The queued message is sent before the ERR message */
+    UA_SecureChannel_cork(&testChannel);
+    ck_assert_uint_eq(sendLargeMessage(1, 2000), 0);
+    size_t queued = testChannel.sendQueueSize;
+
+    UA_TcpErrorMessage error;
+    error.error = UA_STATUSCODE_BADINTERNALERROR;
+    error.reason = UA_STRING_NULL;
+    UA_SecureChannel_sendError(&testChannel, &error);
+    ck_assert_uint_eq(testChannel.sendQueueSize, 0);
+    ck_assert_uint_eq(recordedChunksSize, queued + 1);
+    checkMessageChunks(0, queued, 1);
+    ck_assert(memcmp(recordedChunks[queued].data, "ERRF", 4) == 0);
+
+    UA_SecureChannel_uncork(&testChannel);
+    teardown_recordingCM();
+} END_TEST
+
+START_TEST(SecureChannel_sendQueue_clear) {
+    setup_recordingCM(_i);
+
+    /* Queued chunks are dropped (and their buffers freed) when the
+     * SecureChannel is cleaned up */
+    UA_SecureChannel_cork(&testChannel);
+    ck_assert_uint_eq(sendLargeMessage(1, 2000), 0);
+    ck_assert_uint_gt(testChannel.sendQueueSize, 0);
+    ck_assert_uint_eq(openBuffers, testChannel.sendQueueSize);
+    UA_SecureChannel_clear(&testChannel);
+    ck_assert_uint_eq(testChannel.sendQueueSize, 0);
+    ck_assert_uint_eq(recordedSendsSize, 0);
+    ck_assert_uint_eq(openBuffers, 0);
+
+    teardown_recordingCM();
+} END_TEST
+
 static Suite *
 testSuite_SecureChannel(void) {
     Suite *s = suite_create("SecureChannel");
@@ -568,6 +931,21 @@ testSuite_SecureChannel(void) {
     tcase_add_test(tc_processBuffer, SecureChannel_assemblePartialChunks);
     suite_add_tcase(s, tc_processBuffer);
 
+    /* The loop tests run with individual (0) and vectored (1) sends */
+    TCase *tc_sendQueue = tcase_create("Test the send queue");
+    tcase_add_checked_fixture(tc_sendQueue, setup_funcs_called, teardown_funcs_called);
+    tcase_add_checked_fixture(tc_sendQueue, setup_key_sizes, teardown_key_sizes);
+    tcase_add_checked_fixture(tc_sendQueue, setup_secureChannel, teardown_secureChannel);
+    tcase_add_loop_test(tc_sendQueue, SecureChannel_sendQueue_multiChunk, 0, 2);
+    tcase_add_loop_test(tc_sendQueue, SecureChannel_sendQueue_cork, 0, 2);
+    tcase_add_test(tc_sendQueue, SecureChannel_sendQueue_full);
+    tcase_add_loop_test(tc_sendQueue, SecureChannel_sendQueue_corkFullBoundary, 0, 2);
+    tcase_add_test(tc_sendQueue, SecureChannel_sendQueue_staticBuffer);
+    tcase_add_loop_test(tc_sendQueue, SecureChannel_sendQueue_flushBeforeOPN, 0, 2);
+    tcase_add_loop_test(tc_sendQueue, SecureChannel_sendQueue_flushBeforeERR, 0, 2);
+    tcase_add_loop_test(tc_sendQueue, SecureChannel_sendQueue_clear, 0, 2);
+    suite_add_tcase(s, tc_sendQueue);
+
     return s;
 }
 
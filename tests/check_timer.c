@@ -10,6 +10,8 @@
 #include <stdio.h>
 
 #define N_EVENTS 10000
+#define N_CHURN 200000
+#define N_REFERENCE 2000
 
 static size_t count = 0;
 
@@ -53,10 +55,223 @@ START_TEST(benchmarkTimer) {
     UA_Timer_clear(&timer);
 } END_TEST
 
+/* Add, modify and remove many timers as done for the sampling and keep-alive
+ * timers of a large server */
+START_TEST(benchmarkTimerChurn) {
+    UA_Timer timer;
+    UA_Timer_init(&timer);
+    UA_UInt64 *ids = (UA_UInt64*)UA_malloc(sizeof(UA_UInt64) * N_CHURN);
+    ck_assert(ids != NULL);
+    count = 0;
+
+    clock_t begin = clock();
+    UA_DateTime now = 0;
+    for(size_t i = 0; i < N_CHURN; i++) {
+        UA_Double interval = (UA_Double)(100 + (i % 50) * 100);
+        UA_StatusCode retval =
+            UA_Timer_add(&timer, timerCallback, NULL, NULL, interval, now, NULL,
+                         UA_TIMERPOLICY_CURRENTTIME, &ids[i]);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    clock_t added = clock();
+
+    for(size_t i = 0; i < N_CHURN; i += 2) {
+        UA_StatusCode retval =
+            UA_Timer_modify(&timer, ids[i], 1000.0, now, NULL,
+                            UA_TIMERPOLICY_CURRENTTIME);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    clock_t modified = clock();
+
+    for(size_t i = 0; i < 100; i++) {
+        now += UA_DATETIME_MSEC * 100;
+        UA_Timer_process(&timer, now);
+    }
+    clock_t processed = clock();
+
+    for(size_t i = 0; i < N_CHURN; i++)
+        UA_Timer_remove(&timer, ids[i]);
+    clock_t removed = clock();
+
+    ck_assert_uint_eq(timer.entriesSize, 0);
+    ck_assert(UA_Timer_next(&timer) == UA_INT64_MAX);
+
+    printf("add %f s, modify %f s, process %f s (%lu callbacks), remove %f s\n",
+           (double)(added - begin) / CLOCKS_PER_SEC,
+           (double)(modified - added) / CLOCKS_PER_SEC,
+           (double)(processed - modified) / CLOCKS_PER_SEC, (unsigned long)count,
+           (double)(removed - processed) / CLOCKS_PER_SEC);
+
+    UA_free(ids);
+    UA_Timer_clear(&timer);
+} END_TEST
+
+/* Reference model of the timer semantics with a linear search */
+typedef struct {
+    UA_UInt64 id;
+    UA_DateTime nextTime;
+    UA_DateTime interval;
+    UA_TimerPolicy policy;
+    UA_Boolean active;
+    UA_Boolean fired;
+} RefEntry;
+
+static RefEntry refEntries[N_REFERENCE];
+static size_t refEntriesSize;
+static UA_DateTime lastFired;
+
+static void
+refCallback(void *application, void *data) {
+    RefEntry *re = (RefEntry*)data;
+    ck_assert(re->active);
+    ck_assert(!re->fired);
+    /* Executed in the order of the nextTime */
+    ck_assert(re->nextTime >= lastFired);
+    lastFired = re->nextTime;
+    re->fired = true;
+}
+
+static UA_DateTime
+refNext(void) {
+    UA_DateTime next = UA_INT64_MAX;
+    for(size_t i = 0; i < refEntriesSize; i++) {
+        if(refEntries[i].active && refEntries[i].nextTime < next)
+            next = refEntries[i].nextTime;
+    }
+    return next;
+}
+
+static void
+refAdd(UA_Timer *t, UA_DateTime now, UA_UInt32 r) {
+    RefEntry *re = &refEntries[refEntriesSize++];
+    /* Intervals from sub-tick up to days to cover all wheel levels */
+    static const UA_Double intervals[] =
+        {0.05, 0.1, 1.0, 7.3, 50.0, 1000.0, 60000.0, 3600000.0, 86400000.0 * 7};
+    UA_Double interval_ms = intervals[r % (sizeof(intervals) / sizeof(UA_Double))];
+    re->policy = ((r >> 8) % 3 == 0) ? UA_TIMERPOLICY_ONCE : UA_TIMERPOLICY_BASETIME;
+    re->interval = (UA_DateTime)(interval_ms * UA_DATETIME_MSEC);
+    re->nextTime = now + re->interval;
+    re->active = true;
+    UA_StatusCode retval =
+        UA_Timer_add(t, refCallback, NULL, re, interval_ms, now, NULL,
+                     re->policy, &re->id);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+START_TEST(timerMatchesReference) {
+    UA_Timer timer;
+    UA_Timer_init(&timer);
+    refEntriesSize = 0;
+    srand(1);
+
+    /* Start in the present to have large tick values */
+    UA_DateTime now = UA_DATETIME_UNIX_EPOCH + (UA_DateTime)1700000000 * UA_DATETIME_SEC;
+    for(size_t i = 0; i < N_REFERENCE / 2; i++)
+        refAdd(&timer, now, (UA_UInt32)rand());
+
+    for(size_t round = 0; round < 3000; round++) {
+        ck_assert(UA_Timer_next(&timer) == refNext());
+
+        /* Advance by small steps, to the next deadline or by large jumps */
+        UA_UInt32 r = (UA_UInt32)rand();
+        switch(r % 4) {
+        case 0: now += (UA_DateTime)(r % 2000); break;
+        case 1: now += (UA_DateTime)(r % (UA_DATETIME_MSEC * 100)); break;
+        case 2: if(refNext() != UA_INT64_MAX) now = refNext(); break;
+        default: now += (UA_DateTime)(r % (UA_DATETIME_SEC * 3600)); break;
+        }
+
+        /* Process and compare the executed callbacks */
+        for(size_t i = 0; i < refEntriesSize; i++)
+            refEntries[i].fired = false;
+        lastFired = UA_INT64_MIN;
+        UA_DateTime next = UA_Timer_process(&timer, now);
+        for(size_t i = 0; i < refEntriesSize; i++) {
+            RefEntry *re = &refEntries[i];
+            if(!re->active)
+                continue;
+            ck_assert(re->fired == (re->nextTime <= now));
+            if(!re->fired)
+                continue;
+            if(re->policy == UA_TIMERPOLICY_ONCE) {
+                re->active = false;
+                continue;
+            }
+            re->nextTime += re->interval;
+            if(re->nextTime < now) {
+                UA_DateTime delay = (now - re->nextTime) % re->interval;
+                re->nextTime = now + re->interval - delay;
+            }
+        }
+        ck_assert(next == refNext());
+
+        /* Modify, remove or add some entries */
+        for(size_t j = 0; j < 5; j++) {
+            r = (UA_UInt32)rand();
+            RefEntry *re = &refEntries[r % refEntriesSize];
+            if(r % 3 == 0 && re->active) {
+                UA_Timer_remove(&timer, re->id);
+                re->active = false;
+            } else if(r % 3 == 1 && re->active) {
+                /* Multiples of 0.5ms have an exact floating point value */
+                UA_Double interval_ms = (UA_Double)((r >> 4) % 1000 + 1) * 0.5;
+                re->interval = (UA_DateTime)(interval_ms * UA_DATETIME_MSEC);
+                re->nextTime = now + re->interval;
+                UA_StatusCode retval =
+                    UA_Timer_modify(&timer, re->id, interval_ms, now, NULL, re->policy);
+                ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+            } else if(refEntriesSize < N_REFERENCE) {
+                refAdd(&timer, now, r);
+            }
+        }
+    }
+
+    /* Removed entries are not found. The ids are not reused. */
+    for(size_t i = 0; i < refEntriesSize; i++) {
+        if(refEntries[i].active)
+            continue;
+        UA_StatusCode retval =
+            UA_Timer_modify(&timer, refEntries[i].id, 1.0, now, NULL,
+                            UA_TIMERPOLICY_BASETIME);
+        ck_assert_int_eq(retval, UA_STATUSCODE_BADNOTFOUND);
+    }
+
+    UA_Timer_clear(&timer);
+} END_TEST
+
+/* Cyclic callbacks with the same interval are aligned and executed together
+ * if they are added within 1/4 of the interval */
+START_TEST(batchEqualIntervals) {
+    UA_Timer timer;
+    UA_Timer_init(&timer);
+    count = 0;
+
+    UA_DateTime now = 0;
+    for(size_t i = 0; i < 100; i++) {
+        now += UA_DATETIME_MSEC / 5;
+        UA_StatusCode retval =
+            UA_Timer_add(&timer, timerCallback, NULL, NULL, 100.0, now, NULL,
+                         UA_TIMERPOLICY_CURRENTTIME, NULL);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    }
+
+    /* All 100 callbacks execute at the same time and stay aligned */
+    for(size_t i = 1; i <= 3; i++) {
+        UA_DateTime next = UA_Timer_next(&timer);
+        UA_Timer_process(&timer, next);
+        ck_assert_uint_eq(count, 100 * i);
+    }
+
+    UA_Timer_clear(&timer);
+} END_TEST
+
 int main(void) {
     Suite *s  = suite_create("Test Event Timer");
     TCase *tc = tcase_create("test cases");
     tcase_add_test(tc, benchmarkTimer);
+    tcase_add_test(tc, benchmarkTimerChurn);
+    tcase_add_test(tc, timerMatchesReference);
+    tcase_add_test(tc, batchEqualIntervals);
     suite_add_tcase(s, tc);
 
     SRunner *sr = srunner_create(s);
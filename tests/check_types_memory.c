@@ -11,6 +11,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 
 #include "check.h"
 
@@ -225,6 +226,103 @@ START_TEST(calcSizeBinaryShallBeCorrect) {
 }
 END_TEST
 
+#define BENCH_ROUNDS 2000
+
+typedef struct {
+    size_t bytes;
+    clock_t encode;
+    clock_t decode;
+} CodecBenchmark;
+
+static void
+benchmarkType(const void *p, const UA_DataType *type,
+              UA_ByteString *buf, CodecBenchmark *bench) {
+    UA_ByteString msg = *buf;
+    UA_StatusCode retval = UA_encodeBinary(p, type, &msg, NULL);
+    if(retval != UA_STATUSCODE_GOOD)
+        return;
+
+    clock_t begin = clock();
+    for(size_t i = 0; i < BENCH_ROUNDS; i++) {
+        UA_ByteString out = *buf;
+        retval = UA_encodeBinary(p, type, &out, NULL);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    clock_t encoded = clock();
+
+    void *obj = UA_new(type);
+    for(size_t i = 0; i < BENCH_ROUNDS; i++) {
+        retval = UA_decodeBinary(&msg, obj, type, NULL);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        UA_clear(obj, type);
+    }
+    clock_t decoded = clock();
+    UA_delete(obj, type);
+
+    bench->bytes += msg.length * BENCH_ROUNDS;
+    bench->encode += encoded - begin;
+    bench->decode += decoded - encoded;
+}
+
+/* Encode and decode every ns0 type (default-initialized) and a populated
+ * ReadRequest/ReadResponse pair. Prints the throughput. */
+START_TEST(benchmarkBinaryCodec) {
+    UA_ByteString buf;
+    UA_StatusCode retval = UA_ByteString_allocBuffer(&buf, 1 << 16);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    CodecBenchmark types;
+    memset(&types, 0, sizeof(CodecBenchmark));
+    for(size_t i = UA_TYPES_BOOLEAN; i < UA_TYPES_COUNT; i++) {
+        void *obj = UA_new(&UA_TYPES[i]);
+        benchmarkType(obj, &UA_TYPES[i], &buf, &types);
+        UA_delete(obj, &UA_TYPES[i]);
+    }
+
+    UA_ReadValueId rvi[100];
+    UA_DataValue results[100];
+    UA_UInt32 value = 42;
+    for(size_t i = 0; i < 100; i++) {
+        UA_ReadValueId_init(&rvi[i]);
+        rvi[i].nodeId = UA_NODEID_NUMERIC(1, (UA_UInt32)i);
+        rvi[i].attributeId = UA_ATTRIBUTEID_VALUE;
+        UA_DataValue_init(&results[i]);
+        UA_Variant_setScalar(&results[i].value, &value, &UA_TYPES[UA_TYPES_UINT32]);
+        results[i].hasValue = true;
+        results[i].sourceTimestamp = (UA_DateTime)i;
+        results[i].hasSourceTimestamp = true;
+    }
+    UA_ReadRequest req;
+    UA_ReadRequest_init(&req);
+    req.requestHeader.timestamp = 1;
+    req.requestHeader.requestHandle = 2;
+    req.requestHeader.timeoutHint = 3;
+    req.nodesToRead = rvi;
+    req.nodesToReadSize = 100;
+    UA_ReadResponse resp;
+    UA_ReadResponse_init(&resp);
+    resp.responseHeader.timestamp = 1;
+    resp.responseHeader.requestHandle = 2;
+    resp.results = results;
+    resp.resultsSize = 100;
+
+    CodecBenchmark read;
+    memset(&read, 0, sizeof(CodecBenchmark));
+    benchmarkType(&req, &UA_TYPES[UA_TYPES_READREQUEST], &buf, &read);
+    benchmarkType(&resp, &UA_TYPES[UA_TYPES_READRESPONSE], &buf, &read);
+
+    printf("Binary codec, %u ns0 types: encode %.1f MB/s, decode %.1f MB/s\n",
+           (unsigned)UA_TYPES_COUNT,
+           (double)types.bytes / 1e6 / ((double)types.encode / CLOCKS_PER_SEC),
+           (double)types.bytes / 1e6 / ((double)types.decode / CLOCKS_PER_SEC));
+    printf("Binary codec, Read request/response: encode %.1f MB/s, decode %.1f MB/s\n",
+           (double)read.bytes / 1e6 / ((double)read.encode / CLOCKS_PER_SEC),
+           (double)read.bytes / 1e6 / ((double)read.decode / CLOCKS_PER_SEC));
+
+    UA_ByteString_clear(&buf);
+}
+END_TEST
+
 int main(void) {
     int number_failed = 0;
     SRunner *sr;
@@ -251,6 +349,10 @@ int main(void) {
     tcase_add_loop_test(tc, calcSizeBinaryShallBeCorrect, UA_TYPES_BOOLEAN, UA_TYPES_COUNT - 1);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("Benchmark");
+    tcase_add_test(tc, benchmarkBinaryCodec);
+    suite_add_tcase(s, tc);
+
     sr = srunner_create(s);
     srunner_set_fork_status(sr, CK_NOFORK);
     srunner_run_all (sr, CK_NORMAL);
@@ -780,6 +780,86 @@ START_TEST(format_string) {
     ck_assert_uint_ne(res, UA_STATUSCODE_GOOD);
 } END_TEST
 
+START_TEST(arenaAllocReset) {
+    UA_Arena arena;
+    UA_Arena_init(&arena, 256, 1024);
+
+    /* Zeroed and aligned memory */
+    UA_Byte *b = (UA_Byte*)UA_Arena_calloc(&arena, 3, 1);
+    ck_assert_ptr_ne(b, NULL);
+    ck_assert_uint_eq(b[0] | b[1] | b[2], 0);
+    UA_Double *d = (UA_Double*)UA_Arena_calloc(&arena, 2, sizeof(UA_Double));
+    ck_assert_ptr_ne(d, NULL);
+    ck_assert_uint_eq((uintptr_t)d % sizeof(UA_Double), 0);
+    ck_assert(d[0] == 0.0 && d[1] == 0.0);
+    ck_assert_ptr_ne(UA_Arena_calloc(&arena, 0, 8), NULL);
+    ck_assert_uint_eq(arena.allocCount, 3);
+    ck_assert_uint_eq(arena.blockCount, 1);
+
+    /* Oversized allocation */
+    void *large = UA_Arena_calloc(&arena, 1, 4096);
+    ck_assert_ptr_ne(large, NULL);
+    ck_assert_uint_eq(arena.blockCount, 2);
+
+    /* Overflow */
+    ck_assert_ptr_eq(UA_Arena_calloc(&arena, SIZE_MAX / 2, 4), NULL);
+
+    /* The arena grows to the maximum block size */
+    UA_Arena_reset(&arena);
+    ck_assert_uint_eq(arena.used, 0);
+    ck_assert_uint_eq(arena.blockSize, 1024);
+    for(size_t i = 0; i < 64; i++)
+        ck_assert_ptr_ne(UA_Arena_calloc(&arena, 1, 16), NULL);
+    ck_assert_uint_eq(arena.blockCount, 1);
+
+    /* The single block is kept */
+    UA_Arena_reset(&arena);
+    ck_assert_ptr_ne(UA_Arena_calloc(&arena, 1, 16), NULL);
+    ck_assert_uint_eq(arena.blockCount, 0);
+
+    UA_Arena_clear(&arena);
+} END_TEST
+
+START_TEST(arenaDecode) {
+    /* Encode a ReadRequest */
+    UA_ReadValueId rvi[32];
+    for(size_t i = 0; i < 32; i++) {
+        UA_ReadValueId_init(&rvi[i]);
+        rvi[i].nodeId = UA_NODEID_STRING(1, "my.variable");
+        rvi[i].attributeId = UA_ATTRIBUTEID_VALUE;
+    }
+    UA_ReadRequest req;
+    UA_ReadRequest_init(&req);
+    req.nodesToRead = rvi;
+    req.nodesToReadSize = 32;
+    UA_ByteString buf = UA_BYTESTRING_NULL;
+    UA_StatusCode res = UA_encodeBinary(&req, &UA_TYPES[UA_TYPES_READREQUEST], &buf, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    /* Decode into the arena */
+    UA_Arena arena;
+    UA_Arena_init(&arena, 128, 128);
+    UA_DecodeBinaryOptions opt;
+    memset(&opt, 0, sizeof(UA_DecodeBinaryOptions));
+    opt.callocContext = &arena;
+    opt.calloc = UA_Arena_calloc;
+    UA_ReadRequest req2;
+    res = UA_decodeBinary(&buf, &req2, &UA_TYPES[UA_TYPES_READREQUEST], &opt);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_order(&req, &req2, &UA_TYPES[UA_TYPES_READREQUEST]) == UA_ORDER_EQ);
+    ck_assert_uint_eq(arena.allocCount, 33); /* Array + 32 strings */
+    UA_Arena_reset(&arena);
+
+    /* Decoding fails in the middle */
+    buf.length -= 4;
+    res = UA_decodeBinary(&buf, &req2, &UA_TYPES[UA_TYPES_READREQUEST], &opt);
+    ck_assert_uint_ne(res, UA_STATUSCODE_GOOD);
+    UA_Arena_clear(&arena);
+
+    buf.length += 4;
+    UA_ByteString_clear(&buf);
+} END_TEST
+
 static Suite* testSuite_Utils(void) {
     Suite *s = suite_create("Utils");
     TCase *tc_endpointUrl_split = tcase_create("EndpointUrl_split");
@@ -831,6 +911,11 @@ static Suite* testSuite_Utils(void) {
     tcase_add_test(tc6, format_string);
     suite_add_tcase(s, tc6);
 
+    TCase *tc7 = tcase_create("test arena");
+    tcase_add_test(tc7, arenaAllocReset);
+    tcase_add_test(tc7, arenaDecode);
+    suite_add_tcase(s, tc7);
+
     return s;
 }
 
@@ -190,6 +190,12 @@ START_TEST(Client_read) {
     for(size_t i = 0; i < VARLENGTH; i++)
         ck_assert_uint_eq((size_t)var[i], i);
 
+    /* The requests were decoded into the SecureChannel arena */
+    UA_ServerStatistics stat = UA_Server_getStatistics(server);
+    ck_assert_uint_gt(stat.ras.requestCount, 0);
+    ck_assert_uint_gt(stat.ras.allocCount, 0);
+    ck_assert_uint_gt(stat.ras.maxRequestBytes, 0);
+
     UA_Variant_clear(&val);
     UA_Client_disconnect(client);
     UA_Client_delete(client);
@@ -0,0 +1,362 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/plugin/nodestore.h>
+#include <open62541/plugin/nodestore_default.h>
+#include <open62541/server_config_default.h>
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel.h>
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+#include "thread_wrapper.h"
+
+#define MAX_WORKERS 16
+#define NUMBER_OF_CLIENTS 8
+#define ITERATIONS_PER_CLIENT 50
+#define BENCHMARK_READS_PER_CLIENT 500
+
+typedef struct {
+    THREAD_HANDLE handle;
+    size_t index;
+    size_t iterations;
+    UA_Boolean readOnly;
+    UA_StatusCode result;
+} WorkerContext;
+
+static UA_Server *server;
+static volatile UA_Boolean running;
+static THREAD_HANDLE server_thread;
+static WorkerContext workers[MAX_WORKERS];
+static size_t workersSize;
+static WorkerContext clients[NUMBER_OF_CLIENTS];
+static UA_Boolean useNotificationCallback;
+
+THREAD_CALLBACK(serverloop) {
+    while(running)
+        UA_Server_run_iterate(server, true);
+    return 0;
+}
+
+THREAD_CALLBACK_PARAM(workerloop, param) {
+    WorkerContext *wc = (WorkerContext*)param;
+    wc->result = UA_Server_runServiceWorker(server, wc->index);
+    return 0;
+}
+
+static void
+addClientVariable(size_t index) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Int32 value = 0;
+    UA_Variant_setScalar(&attr.value, &value, &UA_TYPES[UA_TYPES_INT32]);
+    attr.displayName = UA_LOCALIZEDTEXT("en-US", "ClientVariable");
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    UA_StatusCode res =
+        UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, 5000 + (UA_UInt32)index),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "ClientVariable"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+/* Takes the server lock from a timer in the server main loop */
+static void
+lockingTimer(UA_Server *s, void *data) {
+    UA_Variant var;
+    UA_StatusCode res = UA_Server_readValue(s, UA_NODEID_NUMERIC(1, 5000), &var);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_Variant_clear(&var);
+}
+
+/* The onRead notification calls the public API that takes the timer lock of
+ * the EventLoop. The EventLoop holds it while the lockingTimer waits for the
+ * server lock. So the Read must not be processed with the shared lock. */
+static void
+onReadCallbackVariable(UA_Server *s, const UA_NodeId *sessionId,
+                       void *sessionContext, const UA_NodeId *nodeid,
+                       void *nodeContext, const UA_NumericRange *range,
+                       const UA_DataValue *value) {
+    UA_UInt64 callbackId = 0;
+    UA_StatusCode res =
+        UA_Server_addTimedCallback(s, lockingTimer, NULL,
+                                   UA_DateTime_now() + UA_DATETIME_SEC, &callbackId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_Server_removeCallback(s, callbackId);
+}
+
+/* The service notification calls the public API like the onRead notification
+ * above. So no service must be processed with the shared lock. */
+static void
+serviceNotificationCallback(UA_Server *s, UA_ApplicationNotificationType type,
+                            const UA_KeyValueMap payload) {
+    UA_UInt64 callbackId = 0;
+    UA_StatusCode res =
+        UA_Server_addTimedCallback(s, lockingTimer, NULL,
+                                   UA_DateTime_now() + UA_DATETIME_SEC, &callbackId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_Server_removeCallback(s, callbackId);
+}
+
+static void
+addCallbackVariable(void) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Int32 value = 42;
+    UA_Variant_setScalar(&attr.value, &value, &UA_TYPES[UA_TYPES_INT32]);
+    attr.displayName = UA_LOCALIZEDTEXT("en-US", "CallbackVariable");
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ;
+    UA_NodeId nodeId = UA_NODEID_NUMERIC(1, 6000);
+    UA_StatusCode res =
+        UA_Server_addVariableNode(server, nodeId,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "CallbackVariable"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_ValueSourceNotifications notifications;
+    memset(&notifications, 0, sizeof(notifications));
+    notifications.onRead = onReadCallbackVariable;
+    res = UA_Server_setVariableNode_internalValueSource(server, nodeId, NULL,
+                                                        &notifications);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+/* Start a server with the concurrent nodestore and the given number of service
+ * workers. The first runWorkers workers are executed in their own thread. */
+static void
+startServer(size_t serviceWorkers, size_t runWorkers) {
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    config.nodestore = UA_Nodestore_RCU();
+    config.logging = UA_Log_Stdout_new(UA_LOGLEVEL_WARNING);
+    UA_ServerConfig_setDefault(&config);
+    config.tcpReuseAddr = true;
+    config.serviceWorkers = serviceWorkers;
+    if(useNotificationCallback)
+        config.serviceNotificationCallback = serviceNotificationCallback;
+    server = UA_Server_newWithConfig(&config);
+    ck_assert(server != NULL);
+    ck_assert(UA_Server_getConfig(server)->nodestore->concurrentAccess);
+    UA_StatusCode res;
+
+    for(size_t i = 0; i < NUMBER_OF_CLIENTS; i++)
+        addClientVariable(i);
+    addCallbackVariable();
+    res = UA_Server_addRepeatedCallback(server, lockingTimer, NULL, 1, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    res = UA_Server_run_startup(server);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    running = true;
+    THREAD_CREATE(server_thread, serverloop);
+
+    workersSize = runWorkers;
+    for(size_t i = 0; i < workersSize; i++) {
+        workers[i].index = i;
+        THREAD_CREATE_PARAM(workers[i].handle, workerloop, workers[i]);
+    }
+}
+
+static void
+stopServer(void) {
+    running = false;
+    THREAD_JOIN(server_thread);
+    UA_Server_run_shutdown(server);
+    for(size_t i = 0; i < workersSize; i++) {
+        THREAD_JOIN(workers[i].handle);
+        ck_assert_uint_eq(workers[i].result, UA_STATUSCODE_GOOD);
+    }
+    UA_Server_delete(server);
+    server = NULL;
+}
+
+static UA_Client *
+connectClient(void) {
+    UA_Client *client = UA_Client_newForUnitTest();
+    UA_StatusCode res = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    return client;
+}
+
+static void
+checkReadBrowseWrite(UA_Client *client, const UA_NodeId nodeId, UA_Int32 value) {
+    UA_Variant var;
+    UA_Variant_setScalar(&var, &value, &UA_TYPES[UA_TYPES_INT32]);
+    UA_StatusCode res = UA_Client_writeValueAttribute(client, nodeId, &var);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    res = UA_Client_readValueAttribute(client, nodeId, &var);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(var.type == &UA_TYPES[UA_TYPES_INT32]);
+    ck_assert_int_eq(*(UA_Int32*)var.data, value);
+    UA_Variant_clear(&var);
+
+    UA_BrowseRequest bReq;
+    UA_BrowseRequest_init(&bReq);
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    bd.resultMask = UA_BROWSERESULTMASK_NONE;
+    bd.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+    bReq.nodesToBrowse = &bd;
+    bReq.nodesToBrowseSize = 1;
+    UA_BrowseResponse bResp = UA_Client_Service_browse(client, bReq);
+    ck_assert_uint_eq(bResp.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(bResp.resultsSize, 1);
+    ck_assert_uint_ge(bResp.results[0].referencesSize, NUMBER_OF_CLIENTS);
+    UA_BrowseResponse_clear(&bResp);
+
+    /* Browse with a continuation point */
+    bReq.requestedMaxReferencesPerNode = 1;
+    bResp = UA_Client_Service_browse(client, bReq);
+    ck_assert_uint_eq(bResp.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(bResp.resultsSize, 1);
+    ck_assert_uint_eq(bResp.results[0].referencesSize, 1);
+    ck_assert_uint_gt(bResp.results[0].continuationPoint.length, 0);
+    UA_BrowseNextRequest bnReq;
+    UA_BrowseNextRequest_init(&bnReq);
+    bnReq.continuationPoints = &bResp.results[0].continuationPoint;
+    bnReq.continuationPointsSize = 1;
+    UA_BrowseNextResponse bnResp = UA_Client_Service_browseNext(client, bnReq);
+    ck_assert_uint_eq(bnResp.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(bnResp.resultsSize, 1);
+    ck_assert_uint_eq(bnResp.results[0].referencesSize, 1);
+    UA_BrowseNextResponse_clear(&bnResp);
+    bnReq.releaseContinuationPoints = true;
+    bnResp = UA_Client_Service_browseNext(client, bnReq);
+    ck_assert_uint_eq(bnResp.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    UA_BrowseNextResponse_clear(&bnResp);
+    UA_BrowseResponse_clear(&bResp);
+
+    /* Translate the BrowsePath to the variable of the client */
+    UA_RelativePathElement rpe;
+    UA_RelativePathElement_init(&rpe);
+    rpe.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES);
+    rpe.targetName = UA_QUALIFIEDNAME(1, "ClientVariable");
+    UA_BrowsePath bp;
+    UA_BrowsePath_init(&bp);
+    bp.startingNode = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    bp.relativePath.elements = &rpe;
+    bp.relativePath.elementsSize = 1;
+    UA_TranslateBrowsePathsToNodeIdsRequest tReq;
+    UA_TranslateBrowsePathsToNodeIdsRequest_init(&tReq);
+    tReq.browsePaths = &bp;
+    tReq.browsePathsSize = 1;
+    UA_TranslateBrowsePathsToNodeIdsResponse tResp =
+        UA_Client_Service_translateBrowsePathsToNodeIds(client, tReq);
+    ck_assert_uint_eq(tResp.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(tResp.resultsSize, 1);
+    ck_assert_uint_eq(tResp.results[0].targetsSize, NUMBER_OF_CLIENTS);
+    UA_TranslateBrowsePathsToNodeIdsResponse_clear(&tResp);
+
+    /* The onRead notification calls the public API */
+    res = UA_Client_readValueAttribute(client, UA_NODEID_NUMERIC(1, 6000), &var);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(*(UA_Int32*)var.data, 42);
+    UA_Variant_clear(&var);
+}
+
+/* Every client works on its own variable. The value written by a client must
+ * be visible to its next read. */
+THREAD_CALLBACK_PARAM(clientloop, param) {
+    WorkerContext *cc = (WorkerContext*)param;
+    UA_NodeId nodeId = UA_NODEID_NUMERIC(1, 5000 + (UA_UInt32)cc->index);
+    UA_Client *client = connectClient();
+    for(size_t i = 0; i < cc->iterations; i++) {
+        if(!cc->readOnly) {
+            checkReadBrowseWrite(client, nodeId, (UA_Int32)i);
+            continue;
+        }
+        UA_Variant var;
+        UA_StatusCode res = UA_Client_readValueAttribute(client, nodeId, &var);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        UA_Variant_clear(&var);
+    }
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+    return 0;
+}
+
+static void
+runClients(size_t iterations, UA_Boolean readOnly) {
+    for(size_t i = 0; i < NUMBER_OF_CLIENTS; i++) {
+        clients[i].index = i;
+        clients[i].iterations = iterations;
+        clients[i].readOnly = readOnly;
+        THREAD_CREATE_PARAM(clients[i].handle, clientloop, clients[i]);
+    }
+    for(size_t i = 0; i < NUMBER_OF_CLIENTS; i++)
+        THREAD_JOIN(clients[i].handle);
+}
+
+START_TEST(readBrowseWrite) {
+    startServer(4, 4);
+    runClients(ITERATIONS_PER_CLIENT, false);
+    stopServer();
+} END_TEST
+
+/* The requests for a worker that is not running are processed in the server
+ * main loop */
+START_TEST(workerNotRunning) {
+    startServer(2, 1);
+    ck_assert_uint_eq(UA_Server_runServiceWorker(server, 2),
+                      UA_STATUSCODE_BADINVALIDARGUMENT);
+    runClients(ITERATIONS_PER_CLIENT, false);
+    stopServer();
+} END_TEST
+
+START_TEST(notificationCallback) {
+    useNotificationCallback = true;
+    startServer(4, 4);
+    runClients(ITERATIONS_PER_CLIENT, true);
+    stopServer();
+    useNotificationCallback = false;
+} END_TEST
+
+/* Throughput of Read requests from parallel clients with an increasing number
+ * of service workers. Zero workers processes all requests in the server main
+ * loop. */
+START_TEST(benchmarkServiceWorkers) {
+    size_t workerCounts[] = {0, 1, 2, 4, 8, 16};
+    for(size_t i = 0; i < sizeof(workerCounts) / sizeof(size_t); i++) {
+        startServer(workerCounts[i], workerCounts[i]);
+        UA_DateTime begin = UA_DateTime_nowMonotonic();
+        runClients(BENCHMARK_READS_PER_CLIENT, true);
+        UA_DateTime end = UA_DateTime_nowMonotonic();
+        stopServer();
+
+        double duration = (double)(end - begin) / UA_DATETIME_SEC;
+        size_t reads = NUMBER_OF_CLIENTS * BENCHMARK_READS_PER_CLIENT;
+        printf("%2lu service workers: %lu reads in %.3f s (%.0f reads/s)\n",
+               (unsigned long)workerCounts[i], (unsigned long)reads,
+               duration, (double)reads / duration);
+    }
+} END_TEST
+
+static Suite* testSuite_serviceWorkers(void) {
+    Suite *s = suite_create("Service Workers");
+    TCase *tc = tcase_create("Service Workers");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, readBrowseWrite);
+    tcase_add_test(tc, workerNotRunning);
+    tcase_add_test(tc, notificationCallback);
+    tcase_add_test(tc, benchmarkServiceWorkers);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_serviceWorkers();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -347,7 +347,7 @@ START_TEST(DecodeAndVerifyEncryptedNetworkMessage) {
 
     UA_ReaderGroup *rg = UA_ReaderGroup_find(psm, readerGroupId);
 
-    UA_StatusCode rv = UA_ReaderGroup_decodeNetworkMessage(psm, rg, buffer, &msg);
+    UA_StatusCode rv = UA_ReaderGroup_decodeNetworkMessage(psm, rg, buffer, &msg, NULL);
     ck_assert(rv == UA_STATUSCODE_GOOD);
 
     const char *msg_dec_exp = MSG_HEADER MSG_PAYLOAD_DEC;
@@ -385,7 +385,7 @@ START_TEST(InvalidSignature) {
 
     UA_ReaderGroup *rg = UA_ReaderGroup_find(psm, readerGroupId);
 
-    UA_StatusCode rv = UA_ReaderGroup_decodeNetworkMessage(psm, rg, buffer, &msg);
+    UA_StatusCode rv = UA_ReaderGroup_decodeNetworkMessage(psm, rg, buffer, &msg, NULL);
     ck_assert(rv == UA_STATUSCODE_BADSECURITYCHECKSFAILED);
 
     UA_NetworkMessage_clear(&msg);
@@ -416,7 +416,7 @@ START_TEST(InvalidSecurityModeInsufficientSig) {
 
     UA_ReaderGroup *rg = UA_ReaderGroup_find(psm, readerGroupId);
 
-    UA_StatusCode rv = UA_ReaderGroup_decodeNetworkMessage(psm, rg, buffer, &msg);
+    UA_StatusCode rv = UA_ReaderGroup_decodeNetworkMessage(psm, rg, buffer, &msg, NULL);
     ck_assert(rv == UA_STATUSCODE_BADSECURITYMODEINSUFFICIENT);
 
     UA_NetworkMessage_clear(&msg);
@@ -447,7 +447,7 @@ START_TEST(InvalidSecurityModeRejectedSig) {
 
     UA_ReaderGroup *rg = UA_ReaderGroup_find(psm, readerGroupId);
 
-    UA_StatusCode rv = UA_ReaderGroup_decodeNetworkMessage(psm, rg, buffer, &msg);
+    UA_StatusCode rv = UA_ReaderGroup_decodeNetworkMessage(psm, rg, buffer, &msg, NULL);
     ck_assert(rv == UA_STATUSCODE_BADSECURITYMODEREJECTED);
 
     UA_NetworkMessage_clear(&msg);
@@ -219,6 +219,78 @@ START_TEST(UA_PubSub_EnDecode) {
 END_TEST
 
 
+START_TEST(UA_PubSub_EnDecode_DeltaFrame) {
+    UA_UInt16 dsWriter1 = 4;
+
+    /* Set up the metadata for decoding. The fields of the DeltaFrame are
+     * identified by their name. */
+    UA_NetworkMessage_EncodingOptions eo = {0};
+    UA_DataSetMessage_EncodingMetaData emd[1] = {0};
+    UA_FieldMetaData fmd[3] = {0};
+    fmd[0].name = UA_STRING("Field1");
+    fmd[1].name = UA_STRING("Field2");
+    fmd[2].name = UA_STRING("Field3");
+    emd[0].fields = fmd;
+    emd[0].fieldsSize = 3;
+    emd[0].dataSetWriterId = dsWriter1;
+    eo.metaData = emd;
+    eo.metaDataSize = 1;
+
+    UA_NetworkMessage m;
+    memset(&m, 0, sizeof(UA_NetworkMessage));
+    m.version = 1;
+    m.networkMessageType = UA_NETWORKMESSAGE_DATASET;
+    m.payloadHeaderEnabled = true;
+    m.payload.dataSetMessages = (UA_DataSetMessage*)
+        UA_calloc(1, sizeof(UA_DataSetMessage));
+    m.messageCount = 1;
+    m.dataSetWriterIds[0] = dsWriter1;
+
+    /* Only the third field has changed */
+    UA_DataSetMessage *dsm = m.payload.dataSetMessages;
+    dsm->header.dataSetMessageValid = true;
+    dsm->header.fieldEncoding = UA_FIELDENCODING_VARIANT;
+    dsm->header.dataSetMessageType = UA_DATASETMESSAGE_DATADELTAFRAME;
+    dsm->header.dataSetMessageSequenceNrEnabled = true;
+    dsm->header.dataSetMessageSequenceNr = 4712;
+    dsm->fieldCount = 1;
+    dsm->data.deltaFrameFields = (UA_DataSetMessage_DeltaFrameField*)
+        UA_calloc(1, sizeof(UA_DataSetMessage_DeltaFrameField));
+    dsm->data.deltaFrameFields[0].index = 2;
+    UA_Int32 iv = -12;
+    UA_Variant_setScalarCopy(&dsm->data.deltaFrameFields[0].value.value,
+                             &iv, &UA_TYPES[UA_TYPES_INT32]);
+    dsm->data.deltaFrameFields[0].value.hasValue = true;
+
+    UA_ByteString buffer = UA_BYTESTRING_NULL;
+    UA_StatusCode rv = UA_NetworkMessage_encodeJson(&m, &buffer, &eo, NULL);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+
+    const char *result = "{\"MessageId\":null,\"MessageType\":\"ua-data\",\"Messages\":[{\"DataSetWriterId\":4,\"SequenceNumber\":4712,\"MessageType\":\"ua-deltaframe\",\"Payload\":{\"Field3\":{\"UaType\":6,\"Value\":-12}}}]}";
+    ck_assert_uint_eq(buffer.length, strlen(result));
+    ck_assert(memcmp(result, buffer.data, buffer.length) == 0);
+
+    UA_NetworkMessage m2;
+    memset(&m2, 0, sizeof(UA_NetworkMessage));
+    rv = UA_NetworkMessage_decodeJson(&buffer, &m2, &eo, NULL);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(m2.messageCount, 1);
+    UA_DataSetMessage *dsm2 = m2.payload.dataSetMessages;
+    ck_assert(dsm2->header.dataSetMessageType == UA_DATASETMESSAGE_DATADELTAFRAME);
+    ck_assert_uint_eq(dsm2->header.dataSetMessageSequenceNr, 4712);
+    ck_assert_uint_eq(dsm2->fieldCount, 1);
+    ck_assert_uint_eq(dsm2->data.deltaFrameFields[0].index, 2);
+    ck_assert(dsm2->data.deltaFrameFields[0].value.hasValue);
+    ck_assert_ptr_eq(dsm2->data.deltaFrameFields[0].value.value.type,
+                     &UA_TYPES[UA_TYPES_INT32]);
+    ck_assert_int_eq(*(UA_Int32*)dsm2->data.deltaFrameFields[0].value.value.data, iv);
+
+    UA_ByteString_clear(&buffer);
+    UA_NetworkMessage_clear(&m);
+    UA_NetworkMessage_clear(&m2);
+}
+END_TEST
+
 START_TEST(UA_NetworkMessage_oneMessage_twoFields_json_decode) {
     /* Set up the metadata for decoding */
     UA_NetworkMessage_EncodingOptions eo = {0};
@@ -386,6 +458,7 @@ static Suite *testSuite_networkmessage(void) {
 
     tcase_add_test(tc_json_networkmessage, UA_PubSub_EncodeAllOptionalFields);
     tcase_add_test(tc_json_networkmessage, UA_PubSub_EnDecode);
+    tcase_add_test(tc_json_networkmessage, UA_PubSub_EnDecode_DeltaFrame);
     tcase_add_test(tc_json_networkmessage, UA_NetworkMessage_oneMessage_twoFields_json_decode);
     tcase_add_test(tc_json_networkmessage, UA_NetworkMessage_json_decode);
     tcase_add_test(tc_json_networkmessage, UA_NetworkMessage_json_decode_messageObject);
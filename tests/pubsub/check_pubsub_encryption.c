@@ -15,6 +15,7 @@
 
 #include <check.h>
 #include <stdlib.h>
+#include <time.h>
 
 #define UA_AES128CTR_SIGNING_KEY_LENGTH 32
 #define UA_AES128CTR_KEY_LENGTH 16
@@ -128,10 +129,88 @@ START_TEST(SinglePublishDataSetField) {
     ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
 } END_TEST
 
+/* Sign and encrypt a message with the channel context. The key schedule is
+ * cached in the context and has to follow the key rollover. */
+static void
+signAndEncrypt(UA_PubSubSecurityPolicy *sp, void *ctx, UA_Byte *msg, size_t len,
+               UA_Byte *signature) {
+    UA_Byte nonceData[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    UA_ByteString nonce = {8, nonceData};
+    UA_ByteString data = {len, msg};
+    UA_ByteString sig = {32, signature};
+    ck_assert_int_eq(sp->setMessageNonce(ctx, &nonce), UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(sp->symmetricModule.cryptoModule.encryptionAlgorithm.
+                     encrypt(ctx, &data), UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(sp->symmetricModule.cryptoModule.signatureAlgorithm.
+                     sign(ctx, &data, &sig), UA_STATUSCODE_GOOD);
+}
+
+START_TEST(CachedKeyScheduleFollowsKeyRollover) {
+    UA_PubSubSecurityPolicy *sp = &UA_Server_getConfig(server)->pubSubConfig.securityPolicies[0];
+    UA_Byte sk2Data[UA_AES128CTR_SIGNING_KEY_LENGTH];
+    UA_Byte ek2Data[UA_AES128CTR_KEY_LENGTH];
+    memset(sk2Data, 0x5a, sizeof(sk2Data));
+    memset(ek2Data, 0xa5, sizeof(ek2Data));
+    UA_ByteString sk = {UA_AES128CTR_SIGNING_KEY_LENGTH, signingKey};
+    UA_ByteString ek = {UA_AES128CTR_KEY_LENGTH, encryptingKey};
+    UA_ByteString kn = {UA_AES128CTR_KEYNONCE_LENGTH, keyNonce};
+    UA_ByteString sk2 = {UA_AES128CTR_SIGNING_KEY_LENGTH, sk2Data};
+    UA_ByteString ek2 = {UA_AES128CTR_KEY_LENGTH, ek2Data};
+
+    void *ctx = NULL, *ctx2 = NULL;
+    ck_assert_int_eq(sp->newContext(sp->policyContext, &sk, &ek, &kn, &ctx),
+                     UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(sp->newContext(sp->policyContext, &sk2, &ek2, &kn, &ctx2),
+                     UA_STATUSCODE_GOOD);
+
+    UA_Byte plain[100];
+    for(size_t i = 0; i < sizeof(plain); i++)
+        plain[i] = (UA_Byte)i;
+    UA_Byte msg1[100], msg2[100], msg3[100];
+    UA_Byte sig1[32], sig2[32], sig3[32];
+    memcpy(msg1, plain, sizeof(plain));
+    memcpy(msg2, plain, sizeof(plain));
+    memcpy(msg3, plain, sizeof(plain));
+
+    /* Roll over to the second keys */
+    signAndEncrypt(sp, ctx, msg1, sizeof(msg1), sig1);
+    ck_assert_int_eq(sp->setSecurityKeys(ctx, &sk2, &ek2, &kn), UA_STATUSCODE_GOOD);
+    signAndEncrypt(sp, ctx, msg2, sizeof(msg2), sig2);
+    ck_assert(memcmp(msg1, msg2, sizeof(msg1)) != 0);
+    ck_assert(memcmp(sig1, sig2, sizeof(sig1)) != 0);
+
+    /* Same result as a context created with the second keys */
+    signAndEncrypt(sp, ctx2, msg3, sizeof(msg3), sig3);
+    ck_assert(memcmp(msg2, msg3, sizeof(msg2)) == 0);
+    ck_assert(memcmp(sig2, sig3, sizeof(sig2)) == 0);
+
+    /* Verify and decrypt in place */
+    UA_ByteString data = {sizeof(msg2), msg2};
+    UA_ByteString sig = {sizeof(sig2), sig2};
+    ck_assert_int_eq(sp->symmetricModule.cryptoModule.signatureAlgorithm.
+                     verify(ctx2, &data, &sig), UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(sp->symmetricModule.cryptoModule.encryptionAlgorithm.
+                     decrypt(ctx2, &data), UA_STATUSCODE_GOOD);
+    ck_assert(memcmp(msg2, plain, sizeof(plain)) == 0);
+
+    /* Throughput of the sign-and-encrypt step for small NetworkMessages */
+    UA_Byte bench[256];
+    memset(bench, 0, sizeof(bench));
+    clock_t begin = clock();
+    for(size_t i = 0; i < 100000; i++)
+        signAndEncrypt(sp, ctx, bench, sizeof(bench), sig1);
+    double time_spent = (double)(clock() - begin) / CLOCKS_PER_SEC;
+    printf("signed and encrypted 100000 messages of 256 bytes in %f s\n", time_spent);
+
+    sp->deleteContext(ctx);
+    sp->deleteContext(ctx2);
+} END_TEST
+
 int main(void) {
     TCase *tc_pubsub_publish = tcase_create("PubSub publish DataSetFields");
     tcase_add_checked_fixture(tc_pubsub_publish, setup, teardown);
     tcase_add_test(tc_pubsub_publish, SinglePublishDataSetField);
+    tcase_add_test(tc_pubsub_publish, CachedKeyScheduleFollowsKeyRollover);
 
     Suite *s = suite_create("PubSub WriterGroups/Writer/Fields handling and publishing");
     suite_add_tcase(s, tc_pubsub_publish);
@@ -334,6 +334,41 @@ START_TEST(ReadPublishIntervalAndCompareWithInternalValue){
     UA_Variant_clear(&value);
     } END_TEST
 
+START_TEST(ReadGroupTimingVariables){
+    setupBasicPubSubConfiguration();
+    UA_NodeId timingId = findSingleChildNode(server, UA_QUALIFIEDNAME(1, "Timing"),
+                                             UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT), writerGroup1);
+    ck_assert(!UA_NodeId_isNull(&timingId));
+    UA_NodeId encodeTimeId = findSingleChildNode(server, UA_QUALIFIEDNAME(1, "EncodeTime"),
+                                                 UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT), timingId);
+    UA_Variant value;
+    UA_Variant_init(&value);
+    ck_assert_int_eq(UA_Server_readValue(server, encodeTimeId, &value), UA_STATUSCODE_GOOD);
+    ck_assert(value.type == &UA_TYPES[UA_TYPES_UINT64]);
+    ck_assert_uint_eq(value.arrayLength, UA_PUBSUB_TIMINGBUCKETS);
+    UA_Variant_clear(&value);
+    UA_NodeId missedCyclesId = findSingleChildNode(server, UA_QUALIFIEDNAME(1, "MissedCycles"),
+                                                   UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT), timingId);
+    ck_assert_int_eq(UA_Server_readValue(server, missedCyclesId, &value), UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_UINT64]));
+    UA_Variant_clear(&value);
+
+    timingId = findSingleChildNode(server, UA_QUALIFIEDNAME(1, "Timing"),
+                                   UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT), readerGroup1);
+    ck_assert(!UA_NodeId_isNull(&timingId));
+    UA_NodeId receiveToApplyId = findSingleChildNode(server, UA_QUALIFIEDNAME(1, "ReceiveToApply"),
+                                                     UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT), timingId);
+    ck_assert_int_eq(UA_Server_readValue(server, receiveToApplyId, &value), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(value.arrayLength, UA_PUBSUB_TIMINGBUCKETS);
+    UA_Variant_clear(&value);
+
+    /* The node contexts of the timing variables are released with the group */
+    ck_assert_int_eq(UA_Server_removeWriterGroup(server, writerGroup1), UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(UA_Server_removeReaderGroup(server, readerGroup1), UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(UA_Server_readValue(server, encodeTimeId, &value),
+                     UA_STATUSCODE_BADNODEIDUNKNOWN);
+    } END_TEST
+
 START_TEST(WritePublishIntervalAndCompareWithInternalValue){
         setupBasicPubSubConfiguration();
         UA_NodeId publishIntervalId = findSingleChildNode(server, UA_QUALIFIEDNAME(0, "PublishingInterval"),
@@ -526,6 +561,7 @@ int main(void) {
     tcase_add_checked_fixture(tc_add_pubsub_writergroupelements, setup, teardown);
     tcase_add_test(tc_add_pubsub_writergroupelements, ReadPublishIntervalAndCompareWithInternalValue);
     tcase_add_test(tc_add_pubsub_writergroupelements, WritePublishIntervalAndCompareWithInternalValue);
+    tcase_add_test(tc_add_pubsub_writergroupelements, ReadGroupTimingVariables);
 
     TCase *tc_add_pubsub_pubsubconnectionelements = tcase_create("PubSub Connection check properties");
     tcase_add_checked_fixture(tc_add_pubsub_pubsubconnectionelements, setup, teardown);
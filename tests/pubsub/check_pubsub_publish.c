@@ -5,10 +5,12 @@
  * Copyright (c) 2017 - 2018 Fraunhofer IOSB (Author: Andreas Ebner)
  */
 
+#include <open62541/plugin/log_stdout.h>
 #include <open62541/server_config_default.h>
 #include <open62541/server_pubsub.h>
 
 #include "test_helpers.h"
+#include "thread_wrapper.h"
 #include "ua_pubsub_internal.h"
 #include "ua_server_internal.h"
 
@@ -557,6 +559,177 @@ START_TEST(PublishDataSetFieldAsDeltaFrame){
         ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
     } END_TEST
 
+static UA_UInt64
+sumBuckets(const UA_PubSubTimingHistogram *h) {
+    UA_UInt64 sum = 0;
+    for(size_t i = 0; i < UA_PUBSUB_TIMINGBUCKETS; i++)
+        sum += h->buckets[i];
+    return sum;
+}
+
+START_TEST(PublishCycleTiming){
+        setupPublishedDataSetTestEnvironment();
+        UA_DataSetFieldConfig dataSetFieldConfig;
+        UA_StatusCode retVal = UA_STATUSCODE_GOOD;
+        memset(&dataSetFieldConfig, 0, sizeof(UA_DataSetFieldConfig));
+        dataSetFieldConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+        dataSetFieldConfig.field.variable.fieldNameAlias = UA_STRING("Server localtime");
+        dataSetFieldConfig.field.variable.promotedField = UA_FALSE;
+        dataSetFieldConfig.field.variable.publishParameters.publishedVariable = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME);
+        dataSetFieldConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+        retVal |= UA_Server_addDataSetField(server, publishedDataSet1, &dataSetFieldConfig, NULL).result;
+        setupDataSetFieldTestEnvironment();
+        retVal |= UA_Server_enableAllPubSubComponents(server);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        /* The statistics are reset when the WriterGroup is enabled */
+        UA_WriterGroupTiming timing;
+        retVal = UA_Server_getWriterGroupTiming(server, writerGroup1, &timing);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(timing.encodeTime.count, 0);
+
+        UA_PubSubManager *psm = getPSM(server);
+        UA_WriterGroup *wg = UA_WriterGroup_find(psm, writerGroup1);
+        for(size_t i = 0; i < 5; i++)
+            UA_WriterGroup_publishCallback(psm, wg);
+
+        retVal = UA_Server_getWriterGroupTiming(server, writerGroup1, &timing);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        /* The wakeup latency is measured from the second cycle on */
+        ck_assert_uint_eq(timing.wakeupLatency.count, 4);
+        ck_assert_uint_eq(timing.encodeTime.count, 5);
+        ck_assert_uint_eq(timing.sendTime.count, 5);
+        ck_assert_uint_eq(timing.signTime.count, 0); /* No security configured */
+        ck_assert_uint_eq(sumBuckets(&timing.wakeupLatency), 4);
+        ck_assert_uint_eq(sumBuckets(&timing.encodeTime), 5);
+        ck_assert_uint_eq(sumBuckets(&timing.sendTime), 5);
+        ck_assert_uint_le(timing.encodeTime.min, timing.encodeTime.max);
+
+        /* Re-enabling restarts the statistics */
+        retVal = UA_Server_disableWriterGroup(server, writerGroup1);
+        retVal |= UA_Server_enableWriterGroup(server, writerGroup1);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        retVal = UA_Server_getWriterGroupTiming(server, writerGroup1, &timing);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(timing.encodeTime.count, 0);
+
+        retVal = UA_Server_getWriterGroupTiming(server, UA_NODEID_NUMERIC(0, UA_UINT32_MAX), &timing);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_BADNOTFOUND);
+    } END_TEST
+
+#if UA_MULTITHREADING >= 100
+static UA_EventLoop *publishEL;
+static volatile UA_Boolean publishELRunning;
+
+THREAD_CALLBACK(publishLoop) {
+    while(publishELRunning)
+        publishEL->run(publishEL, 10);
+    return 0;
+}
+
+START_TEST(PublishFromDedicatedEventLoop) {
+        UA_PublishedDataSetConfig pdsConfig;
+        UA_StatusCode retVal = UA_STATUSCODE_GOOD;
+        memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+        pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+        pdsConfig.name = UA_STRING(publishedDataSet1Name);
+        retVal |= UA_Server_addPublishedDataSet(server, &pdsConfig, &publishedDataSet1).addResult;
+
+        UA_DataSetFieldConfig dataSetFieldConfig;
+        memset(&dataSetFieldConfig, 0, sizeof(UA_DataSetFieldConfig));
+        dataSetFieldConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+        dataSetFieldConfig.field.variable.fieldNameAlias = UA_STRING("Server localtime");
+        dataSetFieldConfig.field.variable.publishParameters.publishedVariable =
+            UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME);
+        dataSetFieldConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+        retVal |= UA_Server_addDataSetField(server, publishedDataSet1, &dataSetFieldConfig, NULL).result;
+
+        /* The WriterGroup publishes from its own EventLoop */
+        publishEL = UA_EventLoop_new_POSIX(UA_Log_Stdout);
+        retVal |= publishEL->start(publishEL);
+
+        UA_WriterGroupConfig writerGroupConfig;
+        memset(&writerGroupConfig, 0, sizeof(writerGroupConfig));
+        writerGroupConfig.name = UA_STRING("WriterGroup 1");
+        writerGroupConfig.publishingInterval = 10;
+        writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+        writerGroupConfig.eventLoop = publishEL;
+        retVal |= UA_Server_addWriterGroup(server, connection1, &writerGroupConfig, &writerGroup1);
+
+        UA_DataSetWriterConfig dataSetWriterConfig;
+        memset(&dataSetWriterConfig, 0, sizeof(dataSetWriterConfig));
+        dataSetWriterConfig.name = UA_STRING("DataSetWriter 1");
+        retVal |= UA_Server_addDataSetWriter(server, writerGroup1, publishedDataSet1,
+                                             &dataSetWriterConfig, &dataSetWriter1);
+        retVal |= UA_Server_enableAllPubSubComponents(server);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        /* The publish timer is registered in the dedicated EventLoop */
+        lockServer(server);
+        UA_WriterGroup *wg = UA_WriterGroup_find(getPSM(server), writerGroup1);
+        ck_assert_uint_ne(wg->publishCallbackId, 0);
+        UA_UInt16 seq = wg->sequenceNumber;
+        unlockServer(server);
+
+        /* Publish without iterating the server. The sequence number is
+         * increased with every sent NetworkMessage. */
+        UA_DateTime deadline = UA_DateTime_nowMonotonic() + 5 * UA_DATETIME_SEC;
+        UA_UInt16 first = seq;
+        while(first == seq && UA_DateTime_nowMonotonic() < deadline) {
+            publishEL->run(publishEL, 10);
+            lockServer(server);
+            first = wg->sequenceNumber;
+            unlockServer(server);
+        }
+        ck_assert_uint_ne(first, seq);
+
+        /* Publish from a dedicated thread while the server is iterated */
+        THREAD_HANDLE publishThread;
+        publishELRunning = true;
+        THREAD_CREATE(publishThread, publishLoop);
+        UA_UInt16 last = first;
+        while(last == first && UA_DateTime_nowMonotonic() < deadline) {
+            UA_Server_run_iterate(server, true);
+            lockServer(server);
+            last = wg->sequenceNumber;
+            unlockServer(server);
+        }
+        ck_assert_uint_ne(last, first);
+        ck_assert_int_eq(wg->head.state, UA_PUBSUBSTATE_OPERATIONAL);
+
+        /* Disabling from the server thread while the publish thread is running
+         * does not move the WriterGroup or the connection into an error */
+        for(size_t i = 0; i < 20; i++) {
+            retVal = UA_Server_disableWriterGroup(server, writerGroup1);
+            retVal |= UA_Server_enableWriterGroup(server, writerGroup1);
+            ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+            UA_Server_run_iterate(server, false);
+        }
+        retVal = UA_Server_disableWriterGroup(server, writerGroup1);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        for(size_t i = 0; i < 10; i++)
+            UA_Server_run_iterate(server, false);
+        lockServer(server);
+        ck_assert_int_eq(wg->head.state, UA_PUBSUBSTATE_DISABLED);
+        ck_assert_int_eq(wg->linkedConnection->head.state, UA_PUBSUBSTATE_OPERATIONAL);
+        unlockServer(server);
+
+        /* Removing the WriterGroup from the server thread while the publish
+         * thread is running */
+        retVal = UA_Server_removeWriterGroup(server, writerGroup1);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        for(size_t i = 0; i < 10; i++)
+            UA_Server_run_iterate(server, false);
+
+        publishELRunning = false;
+        THREAD_JOIN(publishThread);
+        publishEL->stop(publishEL);
+        while(publishEL->state != UA_EVENTLOOPSTATE_STOPPED)
+            publishEL->run(publishEL, 10);
+        publishEL->free(publishEL);
+    } END_TEST
+#endif
+
 int main(void) {
     TCase *tc_add_pubsub_writergroup = tcase_create("PubSub WriterGroup items handling");
     tcase_add_checked_fixture(tc_add_pubsub_writergroup, setup, teardown);
@@ -589,6 +762,10 @@ int main(void) {
     tcase_add_checked_fixture(tc_pubsub_publish, setup, teardown);
     tcase_add_test(tc_pubsub_publish, SinglePublishDataSetFieldAndPublishTimestampTest);
     tcase_add_test(tc_pubsub_publish, PublishDataSetFieldAsDeltaFrame);
+    tcase_add_test(tc_pubsub_publish, PublishCycleTiming);
+#if UA_MULTITHREADING >= 100
+    tcase_add_test(tc_pubsub_publish, PublishFromDedicatedEventLoop);
+#endif
 
     Suite *s = suite_create("PubSub WriterGroups/Writer/Fields handling and publishing");
     suite_add_tcase(s, tc_add_pubsub_writergroup);
@@ -88,10 +88,125 @@ START_TEST(PublishSpeedTest) {
 
 } END_TEST
 
+#define DELTA_FIELDS 16
+#define DELTA_CYCLES 8000
+
+/* Encoded size of a NetworkMessage with a single DataSetMessage */
+static size_t
+dataSetMessageSize(UA_DataSetMessage *dsm, UA_UInt16 dataSetWriterId) {
+    UA_NetworkMessage nm;
+    memset(&nm, 0, sizeof(UA_NetworkMessage));
+    nm.version = 1;
+    nm.networkMessageType = UA_NETWORKMESSAGE_DATASET;
+    nm.payloadHeaderEnabled = true;
+    nm.messageCount = 1;
+    nm.dataSetWriterIds[0] = dataSetWriterId;
+    nm.payload.dataSetMessages = dsm;
+    return UA_NetworkMessage_calcSizeBinary(&nm, NULL);
+}
+
+/* Compare KeyFrames against DeltaFrames with a deadband for a slowly changing
+ * DataSet. Every cycle one field changes by one. With an absolute deadband of
+ * two, only every third change of a field is sent. */
+START_TEST(DeltaFrameSpeedTest) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    UA_NodeId fieldNodes[DELTA_FIELDS];
+    UA_Int32 fieldValues[DELTA_FIELDS];
+    for(size_t i = 0; i < DELTA_FIELDS; i++) {
+        fieldValues[i] = 0;
+        UA_VariableAttributes attr = UA_VariableAttributes_default;
+        attr.displayName = UA_LOCALIZEDTEXT("en-US", "Int32 Field");
+        attr.dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+        UA_Variant_setScalar(&attr.value, &fieldValues[i], &UA_TYPES[UA_TYPES_INT32]);
+        retval = UA_Server_addVariableNode(server, UA_NODEID_NULL,
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                           UA_QUALIFIEDNAME(1, "Int32 Field"),
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                           attr, NULL, &fieldNodes[i]);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+        UA_DataSetFieldConfig dataSetFieldConfig;
+        memset(&dataSetFieldConfig, 0, sizeof(UA_DataSetFieldConfig));
+        dataSetFieldConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+        dataSetFieldConfig.field.variable.fieldNameAlias = UA_STRING("Int32 Field");
+        dataSetFieldConfig.field.variable.publishParameters.publishedVariable = fieldNodes[i];
+        dataSetFieldConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+        dataSetFieldConfig.field.variable.publishParameters.deadbandType = UA_DEADBANDTYPE_ABSOLUTE;
+        dataSetFieldConfig.field.variable.publishParameters.deadbandValue = 2.0;
+        retval = UA_Server_addDataSetField(server, publishedDataSet1,
+                                           &dataSetFieldConfig, NULL).result;
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    }
+
+    /* One writer sends only KeyFrames, the other a KeyFrame every ten
+     * messages. The messages are generated directly, the WriterGroup does not
+     * publish. */
+    retval = UA_Server_disableWriterGroup(server, writerGroup1);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_NodeId keyWriterId, deltaWriterId;
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("KeyFrame Writer");
+    dataSetWriterConfig.dataSetWriterId = 1;
+    dataSetWriterConfig.keyFrameCount = 1;
+    retval = UA_Server_addDataSetWriter(server, writerGroup1, publishedDataSet1,
+                                        &dataSetWriterConfig, &keyWriterId);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    dataSetWriterConfig.name = UA_STRING("DeltaFrame Writer");
+    dataSetWriterConfig.dataSetWriterId = 2;
+    dataSetWriterConfig.keyFrameCount = 10;
+    retval = UA_Server_addDataSetWriter(server, writerGroup1, publishedDataSet1,
+                                        &dataSetWriterConfig, &deltaWriterId);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_PubSubManager *psm = getPSM(server);
+    size_t keyBytes = 0, deltaBytes = 0;
+    clock_t keyTime = 0, deltaTime = 0;
+    for(size_t i = 0; i < DELTA_CYCLES; i++) {
+        UA_Int32 *v = &fieldValues[i % DELTA_FIELDS];
+        (*v)++;
+        UA_Variant value;
+        UA_Variant_setScalar(&value, v, &UA_TYPES[UA_TYPES_INT32]);
+        retval = UA_Server_writeValue(server, fieldNodes[i % DELTA_FIELDS], value);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+        lockServer(server);
+        UA_DataSetMessage dsm;
+        clock_t begin = clock();
+        UA_DataSetWriter *dsw = UA_DataSetWriter_find(psm, keyWriterId);
+        retval = UA_DataSetWriter_generateDataSetMessage(psm, dsw, &dsm);
+        keyTime += clock() - begin;
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+        ck_assert(dsm.header.dataSetMessageType == UA_DATASETMESSAGE_DATAKEYFRAME);
+        keyBytes += dataSetMessageSize(&dsm, 1);
+        UA_DataSetMessage_clear(&dsm);
+
+        begin = clock();
+        dsw = UA_DataSetWriter_find(psm, deltaWriterId);
+        retval = UA_DataSetWriter_generateDataSetMessage(psm, dsw, &dsm);
+        deltaTime += clock() - begin;
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+        if(dsm.header.dataSetMessageType == UA_DATASETMESSAGE_DATADELTAFRAME)
+            ck_assert_uint_le(dsm.fieldCount, 1);
+        deltaBytes += dataSetMessageSize(&dsm, 2);
+        UA_DataSetMessage_clear(&dsm);
+        unlockServer(server);
+    }
+
+    printf("%u cycles with %u fields\n", DELTA_CYCLES, DELTA_FIELDS);
+    printf("KeyFrames:   %lu bytes, %f s\n", (unsigned long)keyBytes,
+           (double)keyTime / CLOCKS_PER_SEC);
+    printf("DeltaFrames: %lu bytes, %f s\n", (unsigned long)deltaBytes,
+           (double)deltaTime / CLOCKS_PER_SEC);
+    ck_assert_uint_lt(deltaBytes, keyBytes);
+} END_TEST
+
 int main(void) {
     TCase *tc_publishspeed = tcase_create("Speed of the publisher");
     tcase_add_checked_fixture(tc_publishspeed, setup, teardown);
     tcase_add_test(tc_publishspeed, PublishSpeedTest);
+    tcase_add_test(tc_publishspeed, DeltaFrameSpeedTest);
 
     Suite *s = suite_create("PubSub Speed Test");
     suite_add_tcase(s, tc_publishspeed);
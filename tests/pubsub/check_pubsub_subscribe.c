@@ -913,6 +913,654 @@ START_TEST(SinglePublishSubscribeInt32) {
         checkReceived();
 } END_TEST
 
+static size_t targetWrites = 0;
+
+static void
+countTargetWrites(UA_Server *s, const UA_NodeId *sessionId,
+                  void *sessionContext, const UA_NodeId *nodeId,
+                  void *nodeContext, const UA_NumericRange *range,
+                  const UA_DataValue *data) {
+    targetWrites++;
+}
+
+START_TEST(SinglePublishSubscribeBoundTarget) {
+        /* To check status after running both publisher and subscriber */
+        UA_StatusCode retVal = UA_STATUSCODE_GOOD;
+        UA_PublishedDataSetConfig pdsConfig;
+        UA_NodeId dataSetWriter;
+        UA_NodeId readerIdentifier;
+        UA_NodeId writerGroup;
+        UA_DataSetReaderConfig readerConfig;
+
+        /* Published DataSet */
+        memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+        pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+        pdsConfig.name = UA_STRING("PublishedDataSet Test");
+        retVal = UA_Server_addPublishedDataSet(server, &pdsConfig, &publishedDataSetId).addResult;
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        /* Create variable to publish integer data */
+        UA_NodeId publisherNode;
+        UA_VariableAttributes attr = UA_VariableAttributes_default;
+        attr.description           = UA_LOCALIZEDTEXT("en-US","Published Int32");
+        attr.displayName           = UA_LOCALIZEDTEXT("en-US","Published Int32");
+        attr.dataType              = UA_TYPES[UA_TYPES_INT32].typeId;
+        UA_Int32 publisherData     = 42;
+        UA_Variant_setScalar(&attr.value, &publisherData, &UA_TYPES[UA_TYPES_INT32]);
+        retVal = UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, PUBLISHVARIABLE_NODEID),
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                           UA_QUALIFIEDNAME(1, "Published Int32"),
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                           attr, NULL, &publisherNode);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        /* Data Set Field */
+        UA_NodeId dataSetFieldIdent;
+        UA_DataSetFieldConfig dataSetFieldConfig;
+        memset(&dataSetFieldConfig, 0, sizeof(UA_DataSetFieldConfig));
+        dataSetFieldConfig.dataSetFieldType              = UA_PUBSUB_DATASETFIELD_VARIABLE;
+        dataSetFieldConfig.field.variable.fieldNameAlias = UA_STRING("Published Int32");
+        dataSetFieldConfig.field.variable.promotedField  = UA_FALSE;
+        dataSetFieldConfig.field.variable.publishParameters.publishedVariable = publisherNode;
+        dataSetFieldConfig.field.variable.publishParameters.attributeId       = UA_ATTRIBUTEID_VALUE;
+        retVal = UA_Server_addDataSetField (server, publishedDataSetId, &dataSetFieldConfig, &dataSetFieldIdent).result;
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        /* Writer group */
+        UA_WriterGroupConfig writerGroupConfig;
+        memset(&writerGroupConfig, 0, sizeof(writerGroupConfig));
+        writerGroupConfig.name               = UA_STRING("WriterGroup Test");
+        writerGroupConfig.publishingInterval = PUBLISH_INTERVAL;
+        writerGroupConfig.writerGroupId      = WRITER_GROUP_ID;
+        writerGroupConfig.encodingMimeType   = UA_PUBSUB_ENCODING_UADP;
+        /* Message settings in WriterGroup to include necessary headers */
+        writerGroupConfig.messageSettings.encoding             = UA_EXTENSIONOBJECT_DECODED;
+        writerGroupConfig.messageSettings.content.decoded.type = &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+        UA_UadpWriterGroupMessageDataType *writerGroupMessage  = UA_UadpWriterGroupMessageDataType_new();
+        writerGroupMessage->networkMessageContentMask =
+            (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+            (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+            (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+            (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER;
+        writerGroupConfig.messageSettings.content.decoded.data = writerGroupMessage;
+        retVal |= UA_Server_addWriterGroup(server, connectionId, &writerGroupConfig, &writerGroup);
+        UA_UadpWriterGroupMessageDataType_delete(writerGroupMessage);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        /* DataSetWriter */
+        UA_DataSetWriterConfig dataSetWriterConfig;
+        memset(&dataSetWriterConfig, 0, sizeof(dataSetWriterConfig));
+        dataSetWriterConfig.name            = UA_STRING("DataSetWriter Test");
+        dataSetWriterConfig.dataSetWriterId = DATASET_WRITER_ID;
+        dataSetWriterConfig.keyFrameCount   = 10;
+        retVal |= UA_Server_addDataSetWriter(server, writerGroup, publishedDataSetId,
+                                             &dataSetWriterConfig, &dataSetWriter);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        /* Reader Group */
+        UA_ReaderGroupConfig readerGroupConfig;
+        memset (&readerGroupConfig, 0, sizeof (UA_ReaderGroupConfig));
+        readerGroupConfig.name = UA_STRING ("ReaderGroup Test");
+        retVal |=  UA_Server_addReaderGroup(server, connectionId, &readerGroupConfig, &readerGroupId);
+        /* Data Set Reader */
+        /* Parameters to filter received NetworkMessage */
+        memset (&readerConfig, 0, sizeof (UA_DataSetReaderConfig));
+        readerConfig.name             = UA_STRING ("DataSetReader Test");
+        UA_UInt16 publisherIdentifier = PUBLISHER_ID;
+        readerConfig.publisherId.idType = UA_PUBLISHERIDTYPE_UINT16;
+        readerConfig.publisherId.id.uint16 = publisherIdentifier;
+        readerConfig.writerGroupId    = WRITER_GROUP_ID;
+        readerConfig.dataSetWriterId  = DATASET_WRITER_ID;
+        readerConfig.bindTargetVariables = true;
+        /* Setting up Meta data configuration in DataSetReader */
+        UA_DataSetMetaDataType *pMetaData = &readerConfig.dataSetMetaData;
+        /* FilltestMetadata function in subscriber implementation */
+        UA_DataSetMetaDataType_init (pMetaData);
+        pMetaData->name       = UA_STRING ("DataSet Test");
+        /* Static definition of number of fields size to 1 to create one
+           targetVariable */
+        pMetaData->fieldsSize = 1;
+        pMetaData->fields     = (UA_FieldMetaData*)
+            UA_Array_new(pMetaData->fieldsSize, &UA_TYPES[UA_TYPES_FIELDMETADATA]);
+        /* Unsigned Integer DataType */
+        UA_FieldMetaData_init (&pMetaData->fields[0]);
+        UA_NodeId_copy (&UA_TYPES[UA_TYPES_INT32].typeId,
+                        &pMetaData->fields[0].dataType);
+        pMetaData->fields[0].builtInType = UA_NS0ID_INT32;
+        pMetaData->fields[0].valueRank   = -1; /* scalar */
+        retVal |= UA_Server_addDataSetReader(server, readerGroupId, &readerConfig,
+                                             &readerIdentifier);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        /* Add Subscribed Variables */
+        /* Variable to subscribe data */
+        UA_NodeId newnodeId;
+        UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+        vAttr.description = UA_LOCALIZEDTEXT ("en-US", "Subscribed Int32");
+        vAttr.displayName = UA_LOCALIZEDTEXT ("en-US", "Subscribed Int32");
+        vAttr.dataType    = UA_TYPES[UA_TYPES_INT32].typeId;
+        retVal = UA_Server_addVariableNode(
+            server, UA_NODEID_NUMERIC(1, SUBSCRIBEVARIABLE_NODEID), folderId,
+            UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+            UA_QUALIFIEDNAME(1, "Subscribed Int32"),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+            vAttr, NULL, &newnodeId);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        /* Count the writes into the target variable */
+        UA_ValueSourceNotifications notifications;
+        memset(&notifications, 0, sizeof(UA_ValueSourceNotifications));
+        notifications.onWrite = countTargetWrites;
+        retVal = UA_Server_setVariableNode_internalValueSource(server, newnodeId,
+                                                               NULL, &notifications);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        UA_FieldTargetDataType targetVar;
+        UA_FieldTargetDataType_init(&targetVar);
+        targetVar.attributeId  = UA_ATTRIBUTEID_VALUE;
+        targetVar.targetNodeId = newnodeId;
+        retVal |= UA_Server_DataSetReader_createTargetVariables(server, readerIdentifier,
+                                                                1, &targetVar);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        UA_free(pMetaData->fields);
+
+        /* run server - publisher and subscriber */
+        ck_assert_int_eq(UA_STATUSCODE_GOOD, UA_Server_enableAllPubSubComponents(server));
+        
+        UA_fakeSleep(50 + 1);
+        UA_Server_run_iterate(server,true);
+        UA_fakeSleep(PUBLISH_INTERVAL + 1);
+        UA_Server_run_iterate(server,true);
+        UA_fakeSleep(PUBLISH_INTERVAL + 1);
+        UA_Server_run_iterate(server,true);
+        checkReceived();
+
+        /* The field was written into the bound variable */
+        UA_DataSetReaderTargetStatistics stats;
+        retVal = UA_Server_getDataSetReaderTargetStatistics(server, readerIdentifier, &stats);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(stats.boundTargets, 1);
+        ck_assert_uint_gt(stats.fieldsBound, 0);
+        ck_assert_uint_eq(stats.fieldsWritten, 0);
+        ck_assert_uint_eq(stats.fieldsFailed, 0);
+        ck_assert(stats.fieldsPerSecond > 0.0);
+        ck_assert_uint_eq(targetWrites, stats.fieldsBound);
+
+        /* Changed values arrive via the binding */
+        for(UA_Int32 i = 0; i < 3; i++) {
+            UA_Variant value;
+            UA_Variant_setScalar(&value, &i, &UA_TYPES[UA_TYPES_INT32]);
+            retVal = UA_Server_writeValue(server, publisherNode, value);
+            ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+            checkReceived();
+        }
+
+        /* Disabling the reader releases the binding */
+        retVal = UA_Server_disableDataSetReader(server, readerIdentifier);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        retVal = UA_Server_getDataSetReaderTargetStatistics(server, readerIdentifier, &stats);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(stats.boundTargets, 0);
+        ck_assert_uint_eq(targetWrites, stats.fieldsBound);
+} END_TEST
+
+/* Process a DataSetMessage with Int32 fields directly in the reader. For a
+ * DeltaFrame, the fields are written at the given indices. */
+static void
+processInt32Message(const UA_NodeId readerId, UA_DataSetMessageType type,
+                    UA_UInt16 sequenceNr, size_t fieldCount,
+                    const UA_UInt16 *indices, const UA_Int32 *values) {
+    UA_DataSetMessage dsm;
+    memset(&dsm, 0, sizeof(UA_DataSetMessage));
+    dsm.header.dataSetMessageValid = true;
+    dsm.header.fieldEncoding = UA_FIELDENCODING_VARIANT;
+    dsm.header.dataSetMessageType = type;
+    dsm.header.dataSetMessageSequenceNrEnabled = true;
+    dsm.header.dataSetMessageSequenceNr = sequenceNr;
+    dsm.fieldCount = (UA_UInt16)fieldCount;
+    if(type == UA_DATASETMESSAGE_DATAKEYFRAME) {
+        dsm.data.keyFrameFields = (UA_DataValue*)
+            UA_Array_new(fieldCount, &UA_TYPES[UA_TYPES_DATAVALUE]);
+        for(size_t i = 0; i < fieldCount; i++) {
+            UA_Variant_setScalarCopy(&dsm.data.keyFrameFields[i].value,
+                                     &values[i], &UA_TYPES[UA_TYPES_INT32]);
+            dsm.data.keyFrameFields[i].hasValue = true;
+        }
+    } else {
+        dsm.data.deltaFrameFields = (UA_DataSetMessage_DeltaFrameField*)
+            UA_calloc(fieldCount, sizeof(UA_DataSetMessage_DeltaFrameField));
+        for(size_t i = 0; i < fieldCount; i++) {
+            dsm.data.deltaFrameFields[i].index = indices[i];
+            UA_Variant_setScalarCopy(&dsm.data.deltaFrameFields[i].value.value,
+                                     &values[i], &UA_TYPES[UA_TYPES_INT32]);
+            dsm.data.deltaFrameFields[i].value.hasValue = true;
+        }
+    }
+
+    lockServer(server);
+    UA_PubSubManager *psm = getPSM(server);
+    UA_DataSetReader_process(psm, UA_DataSetReader_find(psm, readerId), &dsm);
+    unlockServer(server);
+    UA_DataSetMessage_clear(&dsm);
+}
+
+static void
+checkInt32Targets(UA_Int32 expected0, UA_Int32 expected1) {
+    UA_Variant value;
+    UA_StatusCode retVal =
+        UA_Server_readValue(server, UA_NODEID_NUMERIC(1, SUBSCRIBEVARIABLE_NODEID), &value);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_INT32]));
+    ck_assert_int_eq(*(UA_Int32*)value.data, expected0);
+    UA_Variant_clear(&value);
+    retVal = UA_Server_readValue(server, UA_NODEID_NUMERIC(1, SUBSCRIBEVARIABLE2_NODEID), &value);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_INT32]));
+    ck_assert_int_eq(*(UA_Int32*)value.data, expected1);
+    UA_Variant_clear(&value);
+}
+
+START_TEST(SubscribeDeltaFrames) {
+        UA_StatusCode retVal = UA_STATUSCODE_GOOD;
+        UA_NodeId readerIdentifier;
+        UA_DataSetReaderConfig readerConfig;
+
+        /* Reader Group */
+        UA_ReaderGroupConfig readerGroupConfig;
+        memset(&readerGroupConfig, 0, sizeof(UA_ReaderGroupConfig));
+        readerGroupConfig.name = UA_STRING("ReaderGroup Test");
+        retVal |= UA_Server_addReaderGroup(server, connectionId, &readerGroupConfig, &readerGroupId);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        /* Data Set Reader with two Int32 fields. A KeyFrame is followed by at
+         * most two DeltaFrames. */
+        memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+        readerConfig.name = UA_STRING("DataSetReader Test");
+        readerConfig.publisherId.idType = UA_PUBLISHERIDTYPE_UINT16;
+        readerConfig.publisherId.id.uint16 = PUBLISHER_ID;
+        readerConfig.writerGroupId = WRITER_GROUP_ID;
+        readerConfig.dataSetWriterId = DATASET_WRITER_ID;
+        readerConfig.keyFrameCount = 3;
+        UA_DataSetMetaDataType *pMetaData = &readerConfig.dataSetMetaData;
+        UA_DataSetMetaDataType_init(pMetaData);
+        pMetaData->name = UA_STRING("DataSet Test");
+        pMetaData->fieldsSize = 2;
+        pMetaData->fields = (UA_FieldMetaData*)
+            UA_Array_new(pMetaData->fieldsSize, &UA_TYPES[UA_TYPES_FIELDMETADATA]);
+        for(size_t i = 0; i < pMetaData->fieldsSize; i++) {
+            UA_FieldMetaData_init(&pMetaData->fields[i]);
+            UA_NodeId_copy(&UA_TYPES[UA_TYPES_INT32].typeId,
+                           &pMetaData->fields[i].dataType);
+            pMetaData->fields[i].builtInType = UA_NS0ID_INT32;
+            pMetaData->fields[i].valueRank = -1; /* scalar */
+        }
+        retVal |= UA_Server_addDataSetReader(server, readerGroupId, &readerConfig,
+                                             &readerIdentifier);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        UA_Array_delete(pMetaData->fields, pMetaData->fieldsSize,
+                        &UA_TYPES[UA_TYPES_FIELDMETADATA]);
+
+        /* Target variables */
+        UA_FieldTargetDataType targetVars[2];
+        UA_UInt32 targetIds[2] = {SUBSCRIBEVARIABLE_NODEID, SUBSCRIBEVARIABLE2_NODEID};
+        for(size_t i = 0; i < 2; i++) {
+            UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+            vAttr.displayName = UA_LOCALIZEDTEXT("en-US", "Subscribed Int32");
+            vAttr.dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+            retVal = UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, targetIds[i]),
+                                               folderId, UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                               UA_QUALIFIEDNAME(1, "Subscribed Int32"),
+                                               UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                               vAttr, NULL, NULL);
+            ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+            UA_FieldTargetDataType_init(&targetVars[i]);
+            targetVars[i].attributeId = UA_ATTRIBUTEID_VALUE;
+            targetVars[i].targetNodeId = UA_NODEID_NUMERIC(1, targetIds[i]);
+        }
+        retVal = UA_Server_DataSetReader_createTargetVariables(server, readerIdentifier,
+                                                               2, targetVars);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        ck_assert_int_eq(UA_STATUSCODE_GOOD, UA_Server_enableAllPubSubComponents(server));
+
+        UA_UInt16 idx0 = 0;
+        UA_UInt16 idx1 = 1;
+        UA_Int32 keyValues[2] = {10, 20};
+        UA_Int32 deltaValue = 5;
+
+        /* DeltaFrame before the first KeyFrame is discarded */
+        processInt32Message(readerIdentifier, UA_DATASETMESSAGE_DATADELTAFRAME,
+                            1, 1, &idx0, &deltaValue);
+
+        /* KeyFrame writes all fields */
+        processInt32Message(readerIdentifier, UA_DATASETMESSAGE_DATAKEYFRAME,
+                            2, 2, NULL, keyValues);
+        checkInt32Targets(10, 20);
+
+        /* DeltaFrame only changes the second field */
+        deltaValue = 21;
+        processInt32Message(readerIdentifier, UA_DATASETMESSAGE_DATADELTAFRAME,
+                            3, 1, &idx1, &deltaValue);
+        checkInt32Targets(10, 21);
+
+        /* Sequence number 4 was lost. Discard until the next KeyFrame. */
+        deltaValue = 11;
+        processInt32Message(readerIdentifier, UA_DATASETMESSAGE_DATADELTAFRAME,
+                            5, 1, &idx0, &deltaValue);
+        checkInt32Targets(10, 21);
+
+        /* The KeyFrame resynchronizes */
+        keyValues[0] = 12;
+        keyValues[1] = 22;
+        processInt32Message(readerIdentifier, UA_DATASETMESSAGE_DATAKEYFRAME,
+                            6, 2, NULL, keyValues);
+        deltaValue = 13;
+        processInt32Message(readerIdentifier, UA_DATASETMESSAGE_DATADELTAFRAME,
+                            7, 1, &idx0, &deltaValue);
+        deltaValue = 23;
+        processInt32Message(readerIdentifier, UA_DATASETMESSAGE_DATADELTAFRAME,
+                            8, 1, &idx1, &deltaValue);
+        checkInt32Targets(13, 23);
+
+        /* A third DeltaFrame means that the KeyFrame was lost */
+        deltaValue = 14;
+        processInt32Message(readerIdentifier, UA_DATASETMESSAGE_DATADELTAFRAME,
+                            9, 1, &idx0, &deltaValue);
+        checkInt32Targets(13, 23);
+
+        UA_DataSetReaderTargetStatistics stats;
+        retVal = UA_Server_getDataSetReaderTargetStatistics(server, readerIdentifier, &stats);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(stats.deltaFramesApplied, 3);
+        ck_assert_uint_eq(stats.deltaFramesDropped, 3);
+        ck_assert_uint_eq(stats.sequenceGaps, 1);
+        ck_assert_uint_eq(stats.fieldsWritten, 7);
+} END_TEST
+
+START_TEST(DecodeNetworkMessageIntoArena) {
+        UA_StatusCode retVal = UA_STATUSCODE_GOOD;
+        UA_NodeId readerIdentifier;
+        UA_DataSetReaderConfig readerConfig;
+
+        /* Reader Group */
+        UA_ReaderGroupConfig readerGroupConfig;
+        memset(&readerGroupConfig, 0, sizeof(UA_ReaderGroupConfig));
+        readerGroupConfig.name = UA_STRING("ReaderGroup Test");
+        retVal |= UA_Server_addReaderGroup(server, connectionId, &readerGroupConfig, &readerGroupId);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        /* Data Set Reader with two Int32 fields */
+        memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+        readerConfig.name = UA_STRING("DataSetReader Test");
+        readerConfig.publisherId.idType = UA_PUBLISHERIDTYPE_UINT16;
+        readerConfig.publisherId.id.uint16 = PUBLISHER_ID;
+        readerConfig.writerGroupId = WRITER_GROUP_ID;
+        readerConfig.dataSetWriterId = DATASET_WRITER_ID;
+        UA_DataSetMetaDataType *pMetaData = &readerConfig.dataSetMetaData;
+        UA_DataSetMetaDataType_init(pMetaData);
+        pMetaData->name = UA_STRING("DataSet Test");
+        pMetaData->fieldsSize = 2;
+        pMetaData->fields = (UA_FieldMetaData*)
+            UA_Array_new(pMetaData->fieldsSize, &UA_TYPES[UA_TYPES_FIELDMETADATA]);
+        for(size_t i = 0; i < pMetaData->fieldsSize; i++) {
+            UA_FieldMetaData_init(&pMetaData->fields[i]);
+            UA_NodeId_copy(&UA_TYPES[UA_TYPES_INT32].typeId,
+                           &pMetaData->fields[i].dataType);
+            pMetaData->fields[i].builtInType = UA_NS0ID_INT32;
+            pMetaData->fields[i].valueRank = -1; /* scalar */
+        }
+        retVal |= UA_Server_addDataSetReader(server, readerGroupId, &readerConfig,
+                                             &readerIdentifier);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        UA_Array_delete(pMetaData->fields, pMetaData->fieldsSize,
+                        &UA_TYPES[UA_TYPES_FIELDMETADATA]);
+
+        /* Encode a NetworkMessage for the reader */
+        UA_Int32 values[2] = {42, -42};
+        UA_DataValue fields[2];
+        UA_DataSetMessage dsm;
+        memset(&dsm, 0, sizeof(UA_DataSetMessage));
+        dsm.header.dataSetMessageValid = true;
+        dsm.header.fieldEncoding = UA_FIELDENCODING_VARIANT;
+        dsm.header.dataSetMessageType = UA_DATASETMESSAGE_DATAKEYFRAME;
+        dsm.fieldCount = 2;
+        dsm.data.keyFrameFields = fields;
+        for(size_t i = 0; i < 2; i++) {
+            UA_DataValue_init(&fields[i]);
+            UA_Variant_setScalar(&fields[i].value, &values[i], &UA_TYPES[UA_TYPES_INT32]);
+            fields[i].hasValue = true;
+        }
+        UA_NetworkMessage nm;
+        memset(&nm, 0, sizeof(UA_NetworkMessage));
+        nm.version = 1;
+        nm.networkMessageType = UA_NETWORKMESSAGE_DATASET;
+        nm.publisherIdEnabled = true;
+        nm.publisherId.idType = UA_PUBLISHERIDTYPE_UINT16;
+        nm.publisherId.id.uint16 = PUBLISHER_ID;
+        nm.groupHeaderEnabled = true;
+        nm.groupHeader.writerGroupIdEnabled = true;
+        nm.groupHeader.writerGroupId = WRITER_GROUP_ID;
+        nm.payloadHeaderEnabled = true;
+        nm.messageCount = 1;
+        nm.dataSetWriterIds[0] = DATASET_WRITER_ID;
+        nm.payload.dataSetMessages = &dsm;
+        UA_ByteString buffer = UA_BYTESTRING_NULL;
+        retVal = UA_NetworkMessage_encodeBinary(&nm, &buffer, NULL);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        lockServer(server);
+        UA_PubSubManager *psm = getPSM(server);
+        UA_ReaderGroup *rg = UA_ReaderGroup_find(psm, readerGroupId);
+        ck_assert_ptr_ne(rg, NULL);
+
+        /* The connection takes the arena size from the config */
+        UA_PubSubConnection *c = UA_PubSubConnection_find(psm, connectionId);
+        ck_assert_uint_eq(c->decodeArena.blockSize,
+                          config->pubSubConfig.decodeArenaSize);
+
+        /* Only the first message allocates an arena block. Later messages
+         * reuse the block and do not allocate. */
+        UA_Arena *arena = &c->decodeArena;
+        UA_ArenaBlock *block = NULL;
+        for(size_t i = 0; i < 10; i++) {
+            UA_NetworkMessage out;
+            memset(&out, 0, sizeof(UA_NetworkMessage));
+            retVal = UA_ReaderGroup_decodeNetworkMessage(psm, rg, buffer, &out, arena);
+            ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+            ck_assert_uint_eq(out.messageCount, 1);
+            ck_assert_uint_eq(out.payload.dataSetMessages[0].fieldCount, 2);
+            UA_DataValue *dv = out.payload.dataSetMessages[0].data.keyFrameFields;
+            ck_assert_int_eq(*(UA_Int32*)dv[0].value.data, 42);
+            ck_assert_int_eq(*(UA_Int32*)dv[1].value.data, -42);
+            ck_assert_uint_gt(arena->allocCount, 0);
+            if(i == 0) {
+                ck_assert_uint_eq(arena->blockCount, 1);
+                block = arena->blocks;
+            } else {
+                ck_assert_uint_eq(arena->blockCount, 0);
+                ck_assert_ptr_eq(arena->blocks, block);
+            }
+            UA_ReaderGroup_releaseNetworkMessage(&out, arena);
+            ck_assert_uint_eq(arena->used, 0);
+        }
+
+        /* Decoding a truncated message fails and resets the arena */
+        UA_ByteString truncated = buffer;
+        truncated.length -= 4;
+        UA_NetworkMessage out;
+        memset(&out, 0, sizeof(UA_NetworkMessage));
+        retVal = UA_ReaderGroup_decodeNetworkMessage(psm, rg, truncated, &out, arena);
+        ck_assert_int_ne(retVal, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(arena->used, 0);
+        ck_assert_ptr_eq(arena->blocks, block);
+        unlockServer(server);
+
+        UA_ByteString_clear(&buffer);
+} END_TEST
+
+START_TEST(SinglePublishSubscribeFrozenLayout) {
+        UA_StatusCode retVal = UA_STATUSCODE_GOOD;
+        UA_PublishedDataSetConfig pdsConfig;
+        UA_NodeId dataSetWriter;
+        UA_NodeId readerIdentifier;
+        UA_NodeId writerGroup;
+        UA_DataSetReaderConfig readerConfig;
+
+        /* Published DataSet */
+        memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+        pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+        pdsConfig.name = UA_STRING("PublishedDataSet Test");
+        retVal = UA_Server_addPublishedDataSet(server, &pdsConfig, &publishedDataSetId).addResult;
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        /* Create variable to publish integer data */
+        UA_NodeId publisherNode;
+        UA_VariableAttributes attr = UA_VariableAttributes_default;
+        attr.description           = UA_LOCALIZEDTEXT("en-US","Published Int32");
+        attr.displayName           = UA_LOCALIZEDTEXT("en-US","Published Int32");
+        attr.dataType              = UA_TYPES[UA_TYPES_INT32].typeId;
+        UA_Int32 publisherData     = 42;
+        UA_Variant_setScalar(&attr.value, &publisherData, &UA_TYPES[UA_TYPES_INT32]);
+        retVal = UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, PUBLISHVARIABLE_NODEID),
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                           UA_QUALIFIEDNAME(1, "Published Int32"),
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                           attr, NULL, &publisherNode);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        /* Data Set Field */
+        UA_NodeId dataSetFieldIdent;
+        UA_DataSetFieldConfig dataSetFieldConfig;
+        memset(&dataSetFieldConfig, 0, sizeof(UA_DataSetFieldConfig));
+        dataSetFieldConfig.dataSetFieldType              = UA_PUBSUB_DATASETFIELD_VARIABLE;
+        dataSetFieldConfig.field.variable.fieldNameAlias = UA_STRING("Published Int32");
+        dataSetFieldConfig.field.variable.promotedField  = UA_FALSE;
+        dataSetFieldConfig.field.variable.publishParameters.publishedVariable = publisherNode;
+        dataSetFieldConfig.field.variable.publishParameters.attributeId       = UA_ATTRIBUTEID_VALUE;
+        retVal = UA_Server_addDataSetField (server, publishedDataSetId, &dataSetFieldConfig, &dataSetFieldIdent).result;
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        /* Writer group with the NetworkMessage sequence number */
+        UA_WriterGroupConfig writerGroupConfig;
+        memset(&writerGroupConfig, 0, sizeof(writerGroupConfig));
+        writerGroupConfig.name               = UA_STRING("WriterGroup Test");
+        writerGroupConfig.publishingInterval = PUBLISH_INTERVAL;
+        writerGroupConfig.writerGroupId      = WRITER_GROUP_ID;
+        writerGroupConfig.encodingMimeType   = UA_PUBSUB_ENCODING_UADP;
+        writerGroupConfig.messageSettings.encoding             = UA_EXTENSIONOBJECT_DECODED;
+        writerGroupConfig.messageSettings.content.decoded.type = &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+        UA_UadpWriterGroupMessageDataType *writerGroupMessage  = UA_UadpWriterGroupMessageDataType_new();
+        writerGroupMessage->networkMessageContentMask =
+            (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+            (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+            (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+            (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_SEQUENCENUMBER |
+            (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER;
+        writerGroupConfig.messageSettings.content.decoded.data = writerGroupMessage;
+        retVal |= UA_Server_addWriterGroup(server, connectionId, &writerGroupConfig, &writerGroup);
+        UA_UadpWriterGroupMessageDataType_delete(writerGroupMessage);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        /* DataSetWriter with DataSetMessage sequence number and timestamp */
+        UA_DataSetWriterConfig dataSetWriterConfig;
+        memset(&dataSetWriterConfig, 0, sizeof(dataSetWriterConfig));
+        dataSetWriterConfig.name            = UA_STRING("DataSetWriter Test");
+        dataSetWriterConfig.dataSetWriterId = DATASET_WRITER_ID;
+        dataSetWriterConfig.keyFrameCount   = 10;
+        UA_UadpDataSetWriterMessageDataType uadpDataSetWriterMessage;
+        UA_UadpDataSetWriterMessageDataType_init(&uadpDataSetWriterMessage);
+        uadpDataSetWriterMessage.dataSetMessageContentMask = (UA_UadpDataSetMessageContentMask)
+            (UA_UADPDATASETMESSAGECONTENTMASK_SEQUENCENUMBER |
+             UA_UADPDATASETMESSAGECONTENTMASK_TIMESTAMP);
+        UA_ExtensionObject_setValue(&dataSetWriterConfig.messageSettings,
+                                    &uadpDataSetWriterMessage,
+                                    &UA_TYPES[UA_TYPES_UADPDATASETWRITERMESSAGEDATATYPE]);
+        retVal |= UA_Server_addDataSetWriter(server, writerGroup, publishedDataSetId,
+                                             &dataSetWriterConfig, &dataSetWriter);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        /* Reader Group */
+        UA_ReaderGroupConfig readerGroupConfig;
+        memset (&readerGroupConfig, 0, sizeof (UA_ReaderGroupConfig));
+        readerGroupConfig.name = UA_STRING ("ReaderGroup Test");
+        retVal |=  UA_Server_addReaderGroup(server, connectionId, &readerGroupConfig, &readerGroupId);
+
+        /* Data Set Reader */
+        memset (&readerConfig, 0, sizeof (UA_DataSetReaderConfig));
+        readerConfig.name             = UA_STRING ("DataSetReader Test");
+        readerConfig.publisherId.idType = UA_PUBLISHERIDTYPE_UINT16;
+        readerConfig.publisherId.id.uint16 = PUBLISHER_ID;
+        readerConfig.writerGroupId    = WRITER_GROUP_ID;
+        readerConfig.dataSetWriterId  = DATASET_WRITER_ID;
+        UA_DataSetMetaDataType *pMetaData = &readerConfig.dataSetMetaData;
+        UA_DataSetMetaDataType_init (pMetaData);
+        pMetaData->name       = UA_STRING ("DataSet Test");
+        pMetaData->fieldsSize = 1;
+        pMetaData->fields     = (UA_FieldMetaData*)
+            UA_Array_new(pMetaData->fieldsSize, &UA_TYPES[UA_TYPES_FIELDMETADATA]);
+        UA_FieldMetaData_init (&pMetaData->fields[0]);
+        UA_NodeId_copy (&UA_TYPES[UA_TYPES_INT32].typeId,
+                        &pMetaData->fields[0].dataType);
+        pMetaData->fields[0].builtInType = UA_NS0ID_INT32;
+        pMetaData->fields[0].valueRank   = -1; /* scalar */
+        retVal |= UA_Server_addDataSetReader(server, readerGroupId, &readerConfig,
+                                             &readerIdentifier);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        /* Variable to subscribe data */
+        UA_NodeId newnodeId;
+        UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+        vAttr.description = UA_LOCALIZEDTEXT ("en-US", "Subscribed Int32");
+        vAttr.displayName = UA_LOCALIZEDTEXT ("en-US", "Subscribed Int32");
+        vAttr.dataType    = UA_TYPES[UA_TYPES_INT32].typeId;
+        retVal = UA_Server_addVariableNode(
+            server, UA_NODEID_NUMERIC(1, SUBSCRIBEVARIABLE_NODEID), folderId,
+            UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+            UA_QUALIFIEDNAME(1, "Subscribed Int32"),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+            vAttr, NULL, &newnodeId);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        UA_FieldTargetDataType targetVar;
+        UA_FieldTargetDataType_init(&targetVar);
+        targetVar.attributeId  = UA_ATTRIBUTEID_VALUE;
+        targetVar.targetNodeId = newnodeId;
+        retVal |= UA_Server_DataSetReader_createTargetVariables(server, readerIdentifier,
+                                                                1, &targetVar);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        UA_free(pMetaData->fields);
+
+        /* run server - publisher and subscriber */
+        ck_assert_int_eq(UA_STATUSCODE_GOOD, UA_Server_enableAllPubSubComponents(server));
+        checkReceived();
+
+        /* The layout is frozen after the first publish cycle */
+        UA_WriterGroup *wg = UA_WriterGroup_find(getPSM(server), writerGroup);
+        UA_DataSetWriter *dsw = UA_DataSetWriter_find(getPSM(server), dataSetWriter);
+        ck_assert(wg != NULL && dsw != NULL);
+        ck_assert_uint_gt(wg->frozen.networkMessage.length, 0);
+
+        /* Changed values are patched into the frozen NetworkMessage */
+        for(UA_Int32 i = 0; i < 5; i++) {
+            UA_UInt16 wgSequenceNumber = wg->sequenceNumber;
+            UA_UInt16 dswSequenceNumber = dsw->actualDataSetMessageSequenceCount;
+            UA_Variant value;
+            UA_Variant_setScalar(&value, &i, &UA_TYPES[UA_TYPES_INT32]);
+            retVal = UA_Server_writeValue(server, publisherNode, value);
+            ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+            checkReceived();
+            ck_assert_uint_gt(wg->frozen.networkMessage.length, 0);
+            ck_assert_uint_ne(wg->sequenceNumber, wgSequenceNumber);
+            ck_assert_uint_ne(dsw->actualDataSetMessageSequenceCount, dswSequenceNumber);
+        }
+
+        /* State changes unfreeze the layout */
+        retVal = UA_Server_disableDataSetWriter(server, dataSetWriter);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(wg->frozen.networkMessage.length, 0);
+} END_TEST
+
 START_TEST(SinglePublishSubscribeInt32StatusCode) {
         /* To check status after running both publisher and subscriber */
         UA_StatusCode retVal = UA_STATUSCODE_GOOD;
@@ -1929,6 +2577,210 @@ START_TEST(MultiPublishSubscribeInt32) {
     UA_Variant_clear(&publishedNodeData);
 } END_TEST
 
+
+START_TEST(ManyReadersDispatchInt32) {
+    UA_StatusCode retVal = UA_STATUSCODE_GOOD;
+    UA_PublishedDataSetConfig pdsConfig;
+    UA_NodeId dataSetWriter;
+    UA_NodeId readerIdentifier;
+    UA_NodeId writerGroup;
+
+    /* Published DataSet */
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    pdsConfig.name = UA_STRING("PublishedDataSet Test");
+    retVal = UA_Server_addPublishedDataSet(server, &pdsConfig, &publishedDataSetId).addResult;
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* Create variable to publish integer data */
+    UA_NodeId publisherNode;
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    attr.description           = UA_LOCALIZEDTEXT("en-US","Published Int32");
+    attr.displayName           = UA_LOCALIZEDTEXT("en-US","Published Int32");
+    attr.dataType              = UA_TYPES[UA_TYPES_INT32].typeId;
+    UA_Int32 publisherData     = 42;
+    UA_Variant_setScalar(&attr.value, &publisherData, &UA_TYPES[UA_TYPES_INT32]);
+    retVal = UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, PUBLISHVARIABLE_NODEID),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                       UA_QUALIFIEDNAME(1, "Published Int32"),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                       attr, NULL, &publisherNode);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* Data Set Field */
+    UA_NodeId dataSetFieldIdent;
+    UA_DataSetFieldConfig dataSetFieldConfig;
+    memset(&dataSetFieldConfig, 0, sizeof(UA_DataSetFieldConfig));
+    dataSetFieldConfig.dataSetFieldType              = UA_PUBSUB_DATASETFIELD_VARIABLE;
+    dataSetFieldConfig.field.variable.fieldNameAlias = UA_STRING("Published Int32");
+    dataSetFieldConfig.field.variable.promotedField  = UA_FALSE;
+    dataSetFieldConfig.field.variable.publishParameters.publishedVariable = publisherNode;
+    dataSetFieldConfig.field.variable.publishParameters.attributeId       = UA_ATTRIBUTEID_VALUE;
+    UA_DataSetFieldResult retval =
+        UA_Server_addDataSetField(server, publishedDataSetId,
+                                  &dataSetFieldConfig, &dataSetFieldIdent);
+    ck_assert_int_eq(retval.result, UA_STATUSCODE_GOOD);
+
+    /* Writer group */
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(writerGroupConfig));
+    writerGroupConfig.name               = UA_STRING("WriterGroup Test");
+    writerGroupConfig.publishingInterval = PUBLISH_INTERVAL;
+    writerGroupConfig.writerGroupId      = WRITER_GROUP_ID;
+    writerGroupConfig.encodingMimeType   = UA_PUBSUB_ENCODING_UADP;
+    writerGroupConfig.messageSettings.encoding             = UA_EXTENSIONOBJECT_DECODED;
+    writerGroupConfig.messageSettings.content.decoded.type = &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+    UA_UadpWriterGroupMessageDataType *writerGroupMessage  = UA_UadpWriterGroupMessageDataType_new();
+    writerGroupMessage->networkMessageContentMask =
+        (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+        (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+        (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+        (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER;
+    writerGroupConfig.messageSettings.content.decoded.data = writerGroupMessage;
+    retVal |= UA_Server_addWriterGroup(server, connectionId, &writerGroupConfig, &writerGroup);
+    UA_UadpWriterGroupMessageDataType_delete(writerGroupMessage);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* DataSetWriter */
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(dataSetWriterConfig));
+    dataSetWriterConfig.name            = UA_STRING("DataSetWriter Test");
+    dataSetWriterConfig.dataSetWriterId = DATASET_WRITER_ID;
+    dataSetWriterConfig.keyFrameCount   = 10;
+    retVal |= UA_Server_addDataSetWriter(server, writerGroup, publishedDataSetId,
+                                         &dataSetWriterConfig, &dataSetWriter);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* Reader Group */
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(UA_ReaderGroupConfig));
+    readerGroupConfig.name = UA_STRING("ReaderGroup Test");
+    retVal |= UA_Server_addReaderGroup(server, connectionId, &readerGroupConfig, &readerGroupId);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* Data Set Reader */
+    UA_DataSetReaderConfig readerConfig;
+    memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+    readerConfig.name = UA_STRING("DataSetReader Test");
+    readerConfig.publisherId.idType = UA_PUBLISHERIDTYPE_UINT16;
+    readerConfig.publisherId.id.uint16 = PUBLISHER_ID;
+    readerConfig.writerGroupId = WRITER_GROUP_ID;
+    UA_DataSetMetaDataType *pMetaData = &readerConfig.dataSetMetaData;
+    UA_DataSetMetaDataType_init(pMetaData);
+    pMetaData->name = UA_STRING("DataSet Test");
+    pMetaData->fieldsSize = 1;
+    pMetaData->fields = (UA_FieldMetaData*)
+        UA_Array_new(pMetaData->fieldsSize, &UA_TYPES[UA_TYPES_FIELDMETADATA]);
+    UA_FieldMetaData_init(&pMetaData->fields[0]);
+    UA_NodeId_copy(&UA_TYPES[UA_TYPES_INT32].typeId, &pMetaData->fields[0].dataType);
+    pMetaData->fields[0].builtInType = UA_NS0ID_INT32;
+    pMetaData->fields[0].valueRank   = -1; /* scalar */
+
+    /* Readers for other DataSetWriters of the same publisher */
+    UA_NodeId otherReader;
+    for(UA_UInt16 i = 1; i <= 64; i++) {
+        readerConfig.dataSetWriterId = (UA_UInt16)(DATASET_WRITER_ID + i);
+        retVal = UA_Server_addDataSetReader(server, readerGroupId,
+                                            &readerConfig, &otherReader);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    }
+
+    /* Reader for the same DataSetWriterId from a different publisher */
+    UA_NodeId foreignReader;
+    readerConfig.dataSetWriterId = DATASET_WRITER_ID;
+    readerConfig.publisherId.id.uint16 = PUBLISHER_ID + 1;
+    retVal = UA_Server_addDataSetReader(server, readerGroupId,
+                                        &readerConfig, &foreignReader);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* The matching reader */
+    readerConfig.publisherId.id.uint16 = PUBLISHER_ID;
+    retVal = UA_Server_addDataSetReader(server, readerGroupId,
+                                        &readerConfig, &readerIdentifier);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    UA_free(pMetaData->fields);
+
+    /* Target variables for the matching and the foreign reader */
+    UA_NodeId newnodeId;
+    UA_NodeId newnodeId2;
+    UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+    vAttr.description = UA_LOCALIZEDTEXT("en-US", "Subscribed Int32");
+    vAttr.displayName = UA_LOCALIZEDTEXT("en-US", "Subscribed Int32");
+    vAttr.dataType    = UA_TYPES[UA_TYPES_INT32].typeId;
+    retVal = UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, SUBSCRIBEVARIABLE_NODEID), folderId,
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                       UA_QUALIFIEDNAME(1, "Subscribed Int32"),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                       vAttr, NULL, &newnodeId);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    retVal = UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, SUBSCRIBEVARIABLE2_NODEID), folderId,
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                       UA_QUALIFIEDNAME(1, "Subscribed Int32 - 2"),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                       vAttr, NULL, &newnodeId2);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_FieldTargetDataType targetVar;
+    UA_FieldTargetDataType_init(&targetVar);
+    targetVar.attributeId  = UA_ATTRIBUTEID_VALUE;
+    targetVar.targetNodeId = newnodeId;
+    retVal = UA_Server_DataSetReader_createTargetVariables(server, readerIdentifier,
+                                                           1, &targetVar);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    targetVar.targetNodeId = newnodeId2;
+    retVal = UA_Server_DataSetReader_createTargetVariables(server, foreignReader,
+                                                           1, &targetVar);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* run server - publisher and subscriber */
+    ck_assert_int_eq(UA_STATUSCODE_GOOD, UA_Server_enableAllPubSubComponents(server));
+    checkReceived();
+
+    /* The readers were matched via the dispatch index */
+    UA_ReaderGroup *rg = UA_ReaderGroup_find(getPSM(server), readerGroupId);
+    ck_assert(rg != NULL);
+    ck_assert(rg->dispatch != NULL);
+    ck_assert_uint_ge(rg->dispatchSize, 2 * rg->readersCount);
+
+    /* The reader for the other publisher did not receive anything */
+    UA_Variant subscribedNodeData;
+    UA_Variant_init(&subscribedNodeData);
+    retVal = UA_Server_readValue(server, newnodeId2, &subscribedNodeData);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    ck_assert(subscribedNodeData.type == &UA_TYPES[UA_TYPES_INT32]);
+    ck_assert_int_eq(*(UA_Int32*)subscribedNodeData.data, 0);
+    UA_Variant_clear(&subscribedNodeData);
+
+    /* Changing the reader config drops the index */
+    retVal = UA_Server_disableDataSetReader(server, foreignReader);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    UA_DataSetReaderConfig foreignConfig;
+    retVal = UA_Server_getDataSetReaderConfig(server, foreignReader, &foreignConfig);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    foreignConfig.publisherId.id.uint16 = PUBLISHER_ID;
+    retVal = UA_Server_updateDataSetReaderConfig(server, foreignReader, &foreignConfig);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    UA_DataSetReaderConfig_clear(&foreignConfig);
+    ck_assert(rg->dispatch == NULL);
+
+    /* Now both readers receive the value */
+    retVal = UA_Server_enableDataSetReader(server, foreignReader);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    UA_Int32 received = 0;
+    for(size_t i = 0; i < 10 && received != publisherData; i++) {
+        UA_fakeSleep(50);
+        UA_Server_run_iterate(server, false);
+        retVal = UA_Server_readValue(server, newnodeId2, &subscribedNodeData);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        ck_assert(subscribedNodeData.type == &UA_TYPES[UA_TYPES_INT32]);
+        received = *(UA_Int32*)subscribedNodeData.data;
+        UA_Variant_clear(&subscribedNodeData);
+    }
+    ck_assert_int_eq(received, publisherData);
+    ck_assert(rg->dispatch != NULL);
+} END_TEST
+
 static void
 addTargetVariable(void) {
     UA_StatusCode retVal = UA_STATUSCODE_GOOD;
@@ -2538,6 +3390,10 @@ int main(void) {
     tcase_add_test(tc_pubsub_publish_subscribe, SinglePublishSubscribeDateTime);
     tcase_add_test(tc_pubsub_publish_subscribe, SinglePublishSubscribeDateTimeRaw);
     tcase_add_test(tc_pubsub_publish_subscribe, SinglePublishSubscribeInt32);
+    tcase_add_test(tc_pubsub_publish_subscribe, SinglePublishSubscribeBoundTarget);
+    tcase_add_test(tc_pubsub_publish_subscribe, SubscribeDeltaFrames);
+    tcase_add_test(tc_pubsub_publish_subscribe, DecodeNetworkMessageIntoArena);
+    tcase_add_test(tc_pubsub_publish_subscribe, SinglePublishSubscribeFrozenLayout);
     tcase_add_test(tc_pubsub_publish_subscribe, SinglePublishSubscribeInt32StatusCode);
     tcase_add_test(tc_pubsub_publish_subscribe, SinglePublishSubscribeInt64);
     tcase_add_test(tc_pubsub_publish_subscribe, SinglePublishSubscribeBool);
@@ -2545,6 +3401,7 @@ int main(void) {
     tcase_add_test(tc_pubsub_publish_subscribe, SinglePublishSubscribeHeartbeat);
     tcase_add_test(tc_pubsub_publish_subscribe, SinglePublishSubscribeWithoutPayloadHeader);
     tcase_add_test(tc_pubsub_publish_subscribe, MultiPublishSubscribeInt32);
+    tcase_add_test(tc_pubsub_publish_subscribe, ManyReadersDispatchInt32);
     tcase_add_test(tc_pubsub_publish_subscribe, SinglePublishOnDemand);
 
     /*Test cases for the subscribed datasets */
@@ -13,7 +13,7 @@
 #include <time.h>
 #include "check.h"
 
-#if UA_MULTITHREADING >= 200
+#if UA_MULTITHREADING >= 100
 #include <pthread.h>
 #endif
 
@@ -23,6 +23,14 @@ static void setupZipTree(void) {
     ns = UA_Nodestore_ZipTree();
 }
 
+static void setupHashMap(void) {
+    ns = UA_Nodestore_HashMap();
+}
+
+static void setupRCU(void) {
+    ns = UA_Nodestore_RCU();
+}
+
 static void teardown(void) {
     ns->free(ns);
 }
@@ -185,6 +193,200 @@ START_TEST(failToFindNonExistentNodeInUA_NodeStoreWithSeveralEntries) {
 }
 END_TEST
 
+START_TEST(removeAndReinsertNodes) {
+    /* Enough nodes to resize the HashMap several times */
+    for(UA_UInt32 i = 0; i < 1000; i++) {
+        UA_Node* n = createNode(0,i+1);
+        ck_assert_uint_eq(ns->insertNode(ns, n, NULL), UA_STATUSCODE_GOOD);
+    }
+
+    /* Remove every second node */
+    for(UA_UInt32 i = 0; i < 1000; i += 2) {
+        UA_NodeId id = UA_NODEID_NUMERIC(0, i+1);
+        ck_assert_uint_eq(ns->removeNode(ns, &id), UA_STATUSCODE_GOOD);
+    }
+
+    /* Reinsert the removed nodes */
+    for(UA_UInt32 i = 0; i < 1000; i += 2) {
+        UA_Node* n = createNode(0,i+1);
+        ck_assert_uint_eq(ns->insertNode(ns, n, NULL), UA_STATUSCODE_GOOD);
+    }
+
+    /* Inserting an existing NodeId fails */
+    UA_Node* n = createNode(0,1);
+    ck_assert_uint_eq(ns->insertNode(ns, n, NULL), UA_STATUSCODE_BADNODEIDEXISTS);
+
+    for(UA_UInt32 i = 0; i < 1000; i++) {
+        UA_NodeId id = UA_NODEID_NUMERIC(0, i+1);
+        const UA_Node* nr = ns->getNode(ns, &id, ~(UA_UInt32)0,
+                                        UA_REFERENCETYPESET_ALL, UA_BROWSEDIRECTION_BOTH);
+        ck_assert_ptr_ne(nr, NULL);
+        ck_assert_uint_eq(nr->head.nodeId.identifier.numeric, i+1);
+        ns->releaseNode(ns, nr);
+    }
+
+    zeroCnt = 0;
+    visitCnt = 0;
+    ns->iterate(ns, checkZeroVisitor, NULL);
+    ck_assert_int_eq(zeroCnt, 0);
+    ck_assert_int_eq(visitCnt, 1000);
+}
+END_TEST
+
+START_TEST(removeNodeInUse) {
+    UA_Node* n1 = createNode(0,2253);
+    ns->insertNode(ns, n1, NULL);
+    UA_NodeId in1 = UA_NODEID_NUMERIC(0,2253);
+    const UA_Node* nr = ns->getNode(ns, &in1, ~(UA_UInt32)0,
+                                    UA_REFERENCETYPESET_ALL, UA_BROWSEDIRECTION_BOTH);
+    ck_assert_ptr_ne(nr, NULL);
+
+    /* The node is no longer found. But the pointer remains valid until it is
+     * released. */
+    UA_StatusCode retval = ns->removeNode(ns, &in1);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_ptr_eq(ns->getNode(ns, &in1, ~(UA_UInt32)0,
+                                 UA_REFERENCETYPESET_ALL, UA_BROWSEDIRECTION_BOTH), NULL);
+    ck_assert_uint_eq(nr->head.nodeId.identifier.numeric, 2253);
+    ns->releaseNode(ns, nr);
+}
+END_TEST
+
+START_TEST(editNodeIsVisibleAfterRelease) {
+    UA_Node* n1 = createNode(0,2253);
+    ns->insertNode(ns, n1, NULL);
+    UA_NodeId in1 = UA_NODEID_NUMERIC(0,2253);
+
+    const UA_Node* before = ns->getNode(ns, &in1, ~(UA_UInt32)0,
+                                        UA_REFERENCETYPESET_ALL, UA_BROWSEDIRECTION_BOTH);
+    UA_Node *edit = ns->getEditNode(ns, &in1, ~(UA_UInt32)0,
+                                    UA_REFERENCETYPESET_ALL, UA_BROWSEDIRECTION_BOTH);
+    ck_assert_ptr_ne(edit, NULL);
+    edit->head.writeMask = 42;
+    ns->releaseNode(ns, edit);
+
+    const UA_Node* after = ns->getNode(ns, &in1, ~(UA_UInt32)0,
+                                       UA_REFERENCETYPESET_ALL, UA_BROWSEDIRECTION_BOTH);
+    ck_assert_uint_eq(after->head.writeMask, 42);
+    ns->releaseNode(ns, after);
+    ns->releaseNode(ns, before);
+}
+END_TEST
+
+/* A nested edit of the same node (e.g. from an onWrite callback) continues the
+ * open edit. Both changes are published with the outermost release. */
+START_TEST(nestedEditsArePublishedTogether) {
+    UA_Node* n1 = createNode(0,2253);
+    ns->insertNode(ns, n1, NULL);
+    UA_NodeId in1 = UA_NODEID_NUMERIC(0,2253);
+
+    UA_Node *outer = ns->getEditNode(ns, &in1, ~(UA_UInt32)0,
+                                     UA_REFERENCETYPESET_ALL, UA_BROWSEDIRECTION_BOTH);
+    ck_assert_ptr_ne(outer, NULL);
+    outer->head.writeMask = 42;
+    UA_Node *inner = ns->getEditNode(ns, &in1, ~(UA_UInt32)0,
+                                     UA_REFERENCETYPESET_ALL, UA_BROWSEDIRECTION_BOTH);
+    ck_assert_ptr_eq(inner, outer);
+    ck_assert_uint_eq(inner->head.writeMask, 42);
+    inner->head.writeMask++;
+    ns->releaseNode(ns, inner);
+    ns->releaseNode(ns, outer);
+
+    const UA_Node* after = ns->getNode(ns, &in1, ~(UA_UInt32)0,
+                                       UA_REFERENCETYPESET_ALL, UA_BROWSEDIRECTION_BOTH);
+    ck_assert_uint_eq(after->head.writeMask, 43);
+    ns->releaseNode(ns, after);
+}
+END_TEST
+
+#if UA_MULTITHREADING >= 100
+/* Readers on several threads while the main thread replaces, edits, removes
+ * and re-inserts the nodes */
+
+#define MT_NODES 1000
+#define MT_READERS 4
+
+static void *mtRunning; /* Non-NULL while running */
+
+static void *
+mtReaderThread(void *arg) {
+    size_t *found = (size_t*)arg;
+    UA_NodeId id = UA_NODEID_NUMERIC(0, 0);
+    while(UA_atomic_load(&mtRunning)) {
+        for(UA_UInt32 i = 0; i < MT_NODES; i++) {
+            id.identifier.numeric = i+1;
+            const UA_Node *n = ns->getNode(ns, &id, ~(UA_UInt32)0,
+                                           UA_REFERENCETYPESET_ALL,
+                                           UA_BROWSEDIRECTION_BOTH);
+            if(!n)
+                continue; /* Currently removed */
+            ck_assert_uint_eq(n->head.nodeId.identifier.numeric, i+1);
+            ck_assert_uint_eq(n->head.nodeClass, UA_NODECLASS_VARIABLE);
+            (*found)++;
+            ns->releaseNode(ns, n);
+        }
+    }
+    return NULL;
+}
+
+START_TEST(concurrentReadersAndWriter) {
+    for(UA_UInt32 i = 0; i < MT_NODES; i++) {
+        UA_Node* n = createNode(0,i+1);
+        ck_assert_uint_eq(ns->insertNode(ns, n, NULL), UA_STATUSCODE_GOOD);
+    }
+
+    UA_atomic_xchg(&mtRunning, (void*)0x01);
+    pthread_t t[MT_READERS];
+    size_t found[MT_READERS];
+    for(size_t i = 0; i < MT_READERS; i++) {
+        found[i] = 0;
+        pthread_create(&t[i], NULL, mtReaderThread, &found[i]);
+    }
+
+    for(UA_UInt32 round = 0; round < 20; round++) {
+        for(UA_UInt32 i = 0; i < MT_NODES; i++) {
+            UA_NodeId id = UA_NODEID_NUMERIC(0, i+1);
+            switch((i + round) % 3) {
+            case 0: {
+                UA_Node *copy = NULL;
+                ck_assert_uint_eq(ns->getNodeCopy(ns, &id, &copy), UA_STATUSCODE_GOOD);
+                copy->head.writeMask = round;
+                ck_assert_uint_eq(ns->replaceNode(ns, copy), UA_STATUSCODE_GOOD);
+                break;
+            }
+            case 1: {
+                UA_Node *edit = ns->getEditNode(ns, &id, ~(UA_UInt32)0,
+                                                UA_REFERENCETYPESET_ALL,
+                                                UA_BROWSEDIRECTION_BOTH);
+                ck_assert_ptr_ne(edit, NULL);
+                edit->head.writeMask = round;
+                ns->releaseNode(ns, edit);
+                break;
+            }
+            default: {
+                ck_assert_uint_eq(ns->removeNode(ns, &id), UA_STATUSCODE_GOOD);
+                UA_Node* n = createNode(0,i+1);
+                ck_assert_uint_eq(ns->insertNode(ns, n, NULL), UA_STATUSCODE_GOOD);
+                break;
+            }
+            }
+        }
+    }
+
+    UA_atomic_xchg(&mtRunning, NULL);
+    for(size_t i = 0; i < MT_READERS; i++) {
+        pthread_join(t[i], NULL);
+        ck_assert_uint_gt(found[i], 0);
+    }
+
+    zeroCnt = 0;
+    visitCnt = 0;
+    ns->iterate(ns, checkZeroVisitor, NULL);
+    ck_assert_int_eq(visitCnt, MT_NODES);
+}
+END_TEST
+#endif
+
 /************************************/
 /* Performance Profiling Test Cases */
 /************************************/
@@ -251,6 +453,59 @@ START_TEST(profileGetDelete) {
 }
 END_TEST
 
+/* Compare the Nodestore implementations for insert, get and iterate */
+
+#define BENCH_N 100000
+
+static void countVisitor(void *context, const UA_Node* node) {
+    (*(size_t*)context)++;
+}
+
+static void
+benchmarkNodestore(const char *name, UA_Nodestore *store) {
+    clock_t begin = clock();
+    for(UA_UInt32 i = 0; i < BENCH_N; i++) {
+        UA_Node *n = store->newNode(store, UA_NODECLASS_VARIABLE);
+        n->head.nodeId = UA_NODEID_NUMERIC(1, i+1);
+        ck_assert_uint_eq(store->insertNode(store, n, NULL), UA_STATUSCODE_GOOD);
+    }
+    clock_t inserted = clock();
+
+    UA_NodeId id = UA_NODEID_NUMERIC(1, 0);
+    for(size_t round = 0; round < 10; round++) {
+        for(UA_UInt32 i = 0; i < BENCH_N; i++) {
+            /* Spread the lookups over the id range */
+            id.identifier.numeric = ((i * 7919) % BENCH_N) + 1;
+            const UA_Node *node =
+                store->getNode(store, &id, ~(UA_UInt32)0,
+                               UA_REFERENCETYPESET_ALL, UA_BROWSEDIRECTION_BOTH);
+            ck_assert_ptr_ne(node, NULL);
+            store->releaseNode(store, node);
+        }
+    }
+    clock_t got = clock();
+
+    size_t visited = 0;
+    for(size_t round = 0; round < 10; round++)
+        store->iterate(store, countVisitor, &visited);
+    clock_t iterated = clock();
+    ck_assert_uint_eq(visited, 10 * BENCH_N);
+
+    printf("%s Nodestore with %d nodes: insert %fs, 10x get %fs, 10x iterate %fs\n",
+           name, BENCH_N,
+           (double)(inserted - begin) / CLOCKS_PER_SEC,
+           (double)(got - inserted) / CLOCKS_PER_SEC,
+           (double)(iterated - got) / CLOCKS_PER_SEC);
+    store->free(store);
+}
+
+START_TEST(benchmarkNodestores) {
+    benchmarkNodestore("ZipTree", UA_Nodestore_ZipTree());
+    benchmarkNodestore("HashMap", UA_Nodestore_HashMap());
+    benchmarkNodestore("RCU", UA_Nodestore_RCU());
+}
+END_TEST
+
 static Suite * namespace_suite (void) {
     Suite *s = suite_create ("UA_NodeStore");
 
@@ -267,6 +522,7 @@ static Suite * namespace_suite (void) {
     tcase_add_checked_fixture(tc_replace, setupZipTree, teardown);
     tcase_add_test (tc_replace, replaceExistingNode);
     tcase_add_test (tc_replace, replaceOldNode);
+    tcase_add_test (tc_replace, editNodeIsVisibleAfterRelease);
     suite_add_tcase (s, tc_replace);
 
     TCase* tc_iterate = tcase_create ("Iterate-ZipTree");
@@ -275,11 +531,91 @@ static Suite * namespace_suite (void) {
     tcase_add_test (tc_iterate, iterateOverExpandedNamespaceShallNotVisitEmptyNodes);
     suite_add_tcase (s, tc_iterate);
 
+    TCase* tc_remove = tcase_create ("Remove-ZipTree");
+    tcase_add_checked_fixture(tc_remove, setupZipTree, teardown);
+    tcase_add_test (tc_remove, removeAndReinsertNodes);
+    tcase_add_test (tc_remove, removeNodeInUse);
+    suite_add_tcase (s, tc_remove);
+
     TCase* tc_profile = tcase_create ("Profile-ZipTree");
     tcase_add_checked_fixture(tc_profile, setupZipTree, teardown);
     tcase_add_test (tc_profile, profileGetDelete);
     suite_add_tcase (s, tc_profile);
 
+    TCase* tc_find_hm = tcase_create ("Find-HashMap");
+    tcase_add_checked_fixture(tc_find_hm, setupHashMap, teardown);
+    tcase_add_test (tc_find_hm, findNodeInUA_NodeStoreWithSingleEntry);
+    tcase_add_test (tc_find_hm, findNodeInUA_NodeStoreWithSeveralEntries);
+    tcase_add_test (tc_find_hm, findNodeInExpandedNamespace);
+    tcase_add_test (tc_find_hm, failToFindNonExistentNodeInUA_NodeStoreWithSeveralEntries);
+    tcase_add_test (tc_find_hm, failToFindNodeInOtherUA_NodeStore);
+    suite_add_tcase (s, tc_find_hm);
+
+    TCase *tc_replace_hm = tcase_create("Replace-HashMap");
+    tcase_add_checked_fixture(tc_replace_hm, setupHashMap, teardown);
+    tcase_add_test (tc_replace_hm, replaceExistingNode);
+    tcase_add_test (tc_replace_hm, replaceOldNode);
+    tcase_add_test (tc_replace_hm, editNodeIsVisibleAfterRelease);
+    suite_add_tcase (s, tc_replace_hm);
+
+    TCase* tc_iterate_hm = tcase_create ("Iterate-HashMap");
+    tcase_add_checked_fixture(tc_iterate_hm, setupHashMap, teardown);
+    tcase_add_test (tc_iterate_hm, iterateOverUA_NodeStoreShallNotVisitEmptyNodes);
+    tcase_add_test (tc_iterate_hm, iterateOverExpandedNamespaceShallNotVisitEmptyNodes);
+    suite_add_tcase (s, tc_iterate_hm);
+
+    TCase* tc_remove_hm = tcase_create ("Remove-HashMap");
+    tcase_add_checked_fixture(tc_remove_hm, setupHashMap, teardown);
+    tcase_add_test (tc_remove_hm, removeAndReinsertNodes);
+    tcase_add_test (tc_remove_hm, removeNodeInUse);
+    suite_add_tcase (s, tc_remove_hm);
+
+    TCase* tc_profile_hm = tcase_create ("Profile-HashMap");
+    tcase_add_checked_fixture(tc_profile_hm, setupHashMap, teardown);
+    tcase_add_test (tc_profile_hm, profileGetDelete);
+    suite_add_tcase (s, tc_profile_hm);
+
+    TCase* tc_find_rcu = tcase_create ("Find-RCU");
+    tcase_add_checked_fixture(tc_find_rcu, setupRCU, teardown);
+    tcase_add_test (tc_find_rcu, findNodeInUA_NodeStoreWithSingleEntry);
+    tcase_add_test (tc_find_rcu, findNodeInUA_NodeStoreWithSeveralEntries);
+    tcase_add_test (tc_find_rcu, findNodeInExpandedNamespace);
+    tcase_add_test (tc_find_rcu, failToFindNonExistentNodeInUA_NodeStoreWithSeveralEntries);
+    tcase_add_test (tc_find_rcu, failToFindNodeInOtherUA_NodeStore);
+    suite_add_tcase (s, tc_find_rcu);
+
+    TCase *tc_replace_rcu = tcase_create("Replace-RCU");
+    tcase_add_checked_fixture(tc_replace_rcu, setupRCU, teardown);
+    tcase_add_test (tc_replace_rcu, replaceExistingNode);
+    tcase_add_test (tc_replace_rcu, replaceOldNode);
+    tcase_add_test (tc_replace_rcu, editNodeIsVisibleAfterRelease);
+    tcase_add_test (tc_replace_rcu, nestedEditsArePublishedTogether);
+    suite_add_tcase (s, tc_replace_rcu);
+
+    TCase* tc_iterate_rcu = tcase_create ("Iterate-RCU");
+    tcase_add_checked_fixture(tc_iterate_rcu, setupRCU, teardown);
+    tcase_add_test (tc_iterate_rcu, iterateOverUA_NodeStoreShallNotVisitEmptyNodes);
+    tcase_add_test (tc_iterate_rcu, iterateOverExpandedNamespaceShallNotVisitEmptyNodes);
+    suite_add_tcase (s, tc_iterate_rcu);
+
+    TCase* tc_remove_rcu = tcase_create ("Remove-RCU");
+    tcase_add_checked_fixture(tc_remove_rcu, setupRCU, teardown);
+    tcase_add_test (tc_remove_rcu, removeAndReinsertNodes);
+    tcase_add_test (tc_remove_rcu, removeNodeInUse);
+#if UA_MULTITHREADING >= 100
+    tcase_add_test (tc_remove_rcu, concurrentReadersAndWriter);
+#endif
+    suite_add_tcase (s, tc_remove_rcu);
+
+    TCase* tc_profile_rcu = tcase_create ("Profile-RCU");
+    tcase_add_checked_fixture(tc_profile_rcu, setupRCU, teardown);
+    tcase_add_test (tc_profile_rcu, profileGetDelete);
+    suite_add_tcase (s, tc_profile_rcu);
+
+    TCase* tc_bench = tcase_create ("Benchmark");
+    tcase_add_test (tc_bench, benchmarkNodestores);
+    suite_add_tcase (s, tc_bench);
+
     return s;
 }
 
@@ -28,6 +28,12 @@
 #include "historical_read_test_data.h"
 #include "randomindextest_backend.h"
 
+#ifdef UA_ARCHITECTURE_POSIX
+#include <open62541/plugin/historydata/history_data_backend_file.h>
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
 static UA_Server *server;
 static UA_HistoryDataGathering *gathering;
 static UA_Boolean running;
@@ -203,9 +209,9 @@ resultIsEqual(const UA_DataValue * result, const testTuple * tuple, size_t index
 }
 
 static UA_Boolean
-fillHistoricalDataBackend(UA_HistoryDataBackend backend) {
+fillHistoricalDataBackend(UA_HistoryDataBackend backend, const UA_DateTime *data) {
     int i = 0;
-    UA_DateTime currentDateTime = testData[i];
+    UA_DateTime currentDateTime = data[i];
     fprintf(stderr, "Adding to historical data backend: ");
     while (currentDateTime) {
         fprintf(stderr, "%lld, ", currentDateTime / UA_DATETIME_SEC);
@@ -225,7 +231,7 @@ fillHistoricalDataBackend(UA_HistoryDataBackend backend) {
             return false;
         }
         UA_DataValue_clear(&value);
-        currentDateTime = testData[++i];
+        currentDateTime = data[++i];
     }
     fprintf(stderr, "\n");
     return true;
@@ -560,9 +566,25 @@ testResult(UA_DateTime *resultData, UA_HistoryData * historyData) {
     UA_HistoryReadResponse_clear(&localResponse);
 }
 
+/* The memory backends under test, selected by the loop test index */
+static UA_HistoryDataBackend
+newMemoryBackend(int variant) {
+    if(variant == 1)
+        return UA_HistoryDataBackend_Memory_Indexed(1, 1, 0);
+    return UA_HistoryDataBackend_Memory(1, 1);
+}
+
+static void
+clearMemoryBackend(int variant, UA_HistoryDataBackend *backend) {
+    if(variant == 1)
+        UA_HistoryDataBackend_Memory_Indexed_clear(backend);
+    else
+        UA_HistoryDataBackend_Memory_clear(backend);
+}
+
 START_TEST(Server_HistorizingUpdateDelete)
 {
-    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory(1, 1);
+    UA_HistoryDataBackend backend = newMemoryBackend(_i);
     UA_HistorizingNodeIdSettings setting;
     setting.historizingBackend = backend;
     setting.maxHistoryDataResponseSize = 1000;
@@ -571,7 +593,7 @@ START_TEST(Server_HistorizingUpdateDelete)
     ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
 
     // fill backend
-    ck_assert_uint_eq(fillHistoricalDataBackend(backend), true);
+    ck_assert_uint_eq(fillHistoricalDataBackend(backend, testData), true);
 
     // delete some values
     ck_assert_str_eq(UA_StatusCode_name(deleteHistory(DELETE_START_TIME, DELETE_STOP_TIME)),
@@ -579,13 +601,13 @@ START_TEST(Server_HistorizingUpdateDelete)
 
     testResult(testDataAfterDelete, NULL);
 
-    UA_HistoryDataBackend_Memory_clear(&setting.historizingBackend);
+    clearMemoryBackend(_i, &setting.historizingBackend);
 }
 END_TEST
 
 START_TEST(Server_HistorizingUpdateInsert)
 {
-    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory(1, 1);
+    UA_HistoryDataBackend backend = newMemoryBackend(_i);
     UA_HistorizingNodeIdSettings setting;
     setting.historizingBackend = backend;
     setting.maxHistoryDataResponseSize = 1000;
@@ -609,13 +631,13 @@ START_TEST(Server_HistorizingUpdateInsert)
     }
 
     UA_HistoryData_clear(&data);
-    UA_HistoryDataBackend_Memory_clear(&setting.historizingBackend);
+    clearMemoryBackend(_i, &setting.historizingBackend);
 }
 END_TEST
 
 START_TEST(Server_HistorizingUpdateReplace)
 {
-    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory(1, 1);
+    UA_HistoryDataBackend backend = newMemoryBackend(_i);
     UA_HistorizingNodeIdSettings setting;
     setting.historizingBackend = backend;
     setting.maxHistoryDataResponseSize = 1000;
@@ -643,13 +665,13 @@ START_TEST(Server_HistorizingUpdateReplace)
     }
 
     UA_HistoryData_clear(&data);
-    UA_HistoryDataBackend_Memory_clear(&setting.historizingBackend);
+    clearMemoryBackend(_i, &setting.historizingBackend);
 }
 END_TEST
 
 START_TEST(Server_HistorizingUpdateUpdate)
 {
-    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory(1, 1);
+    UA_HistoryDataBackend backend = newMemoryBackend(_i);
     UA_HistorizingNodeIdSettings setting;
     setting.historizingBackend = backend;
     setting.maxHistoryDataResponseSize = 1000;
@@ -692,7 +714,7 @@ START_TEST(Server_HistorizingUpdateUpdate)
     }
 
     UA_HistoryData_clear(&data);
-    UA_HistoryDataBackend_Memory_clear(&setting.historizingBackend);
+    clearMemoryBackend(_i, &setting.historizingBackend);
 }
 END_TEST
 
@@ -892,7 +914,7 @@ END_TEST
 
 START_TEST(Server_HistorizingBackendMemory)
 {
-    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory(1, 1);
+    UA_HistoryDataBackend backend = newMemoryBackend(_i);
     UA_HistorizingNodeIdSettings setting;
     setting.historizingBackend = backend;
     setting.maxHistoryDataResponseSize = 1000;
@@ -905,7 +927,7 @@ START_TEST(Server_HistorizingBackendMemory)
     fprintf(stderr, "%x tests expected failed.\n", retval);
 
     // fill backend
-    ck_assert_uint_eq(fillHistoricalDataBackend(backend), true);
+    ck_assert_uint_eq(fillHistoricalDataBackend(backend, testData), true);
 
     // read all in one
     retval = testHistoricalDataBackend(100);
@@ -921,7 +943,7 @@ START_TEST(Server_HistorizingBackendMemory)
     retval = testHistoricalDataBackend(2);
     fprintf(stderr, "%x tests failed.\n", retval);
     ck_assert_uint_eq(retval, 0);
-    UA_HistoryDataBackend_Memory_clear(&setting.historizingBackend);
+    clearMemoryBackend(_i, &setting.historizingBackend);
 }
 END_TEST
 
@@ -953,6 +975,190 @@ START_TEST(Server_HistorizingRandomIndexBackend)
 }
 END_TEST
 
+static void
+setSample(UA_DataValue *value, UA_Int64 seconds) {
+    UA_DataValue_init(value);
+    value->hasValue = true;
+    UA_Variant_setScalarCopy(&value->value, &seconds, &UA_TYPES[UA_TYPES_INT64]);
+    value->hasSourceTimestamp = true;
+    value->sourceTimestamp = seconds * UA_DATETIME_SEC;
+}
+
+static void
+checkSamples(UA_HistoryDataBackend *backend, const UA_Int64 *expected,
+             size_t expectedSize) {
+    size_t end = backend->getEnd(server, backend->context, NULL, NULL, &outNodeId);
+    ck_assert_uint_eq(end, expectedSize);
+    for(size_t i = 0; i < expectedSize; i++) {
+        const UA_DataValue *value =
+            backend->getDataValue(server, backend->context, NULL, NULL, &outNodeId, i);
+        ck_assert_int_eq(value->sourceTimestamp, expected[i] * UA_DATETIME_SEC);
+        ck_assert_int_eq(*(UA_Int64*)value->value.data, expected[i]);
+    }
+}
+
+#ifdef UA_ARCHITECTURE_POSIX
+/* Remove the store directory and the node subdirectories */
+static void
+removeStore(const char *path) {
+    DIR *dir = opendir(path);
+    if(!dir)
+        return;
+    struct dirent *entry;
+    while((entry = readdir(dir)) != NULL) {
+        if(entry->d_name[0] == '.')
+            continue;
+        char sub[512];
+        snprintf(sub, sizeof(sub), "%s/%s", path, entry->d_name);
+        if(unlink(sub) != 0)
+            removeStore(sub);
+    }
+    closedir(dir);
+    rmdir(path);
+}
+
+START_TEST(Server_HistorizingBackendFile)
+{
+    char dir[] = "/tmp/open62541-history-XXXXXX";
+    ck_assert(mkdtemp(dir) != NULL);
+
+    /* Small segments to span several segment files. Sync after every value. */
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_File(dir, 128, 0);
+    ck_assert(backend.context != NULL);
+    ck_assert_uint_eq(fillHistoricalDataBackend(backend, testDataSorted), true);
+
+    /* The store is append-only */
+    UA_DataValue value;
+    UA_DataValue_init(&value);
+    value.hasSourceTimestamp = true;
+    value.sourceTimestamp = TIMESTAMP_4_48;
+    ck_assert_uint_eq(backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                                   &outNodeId, false, &value),
+                      UA_STATUSCODE_BADHISTORYOPERATIONUNSUPPORTED);
+    UA_HistoryDataBackend_File_clear(&backend);
+
+    /* Reopen the store and read the persisted history */
+    backend = UA_HistoryDataBackend_File(dir, 128, 1000);
+    ck_assert(backend.context != NULL);
+    UA_HistorizingNodeIdSettings setting;
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 1000;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    UA_StatusCode ret = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    UA_UInt32 retval = testHistoricalDataBackend(100);
+    ck_assert_uint_eq(retval, 0);
+    retval = testHistoricalDataBackend(1);
+    ck_assert_uint_eq(retval, 0);
+    retval = testHistoricalDataBackend(2);
+    ck_assert_uint_eq(retval, 0);
+
+    /* Append more values than fit into one sparse index stride. Every value
+     * is found by its timestamp. */
+    UA_NodeId otherNodeId = UA_NODEID_NUMERIC(1, 4242);
+    for(UA_Int64 i = 0; i < 1000; i++) {
+        UA_DataValue_init(&value);
+        UA_Variant_setScalar(&value.value, &i, &UA_TYPES[UA_TYPES_INT64]);
+        value.hasValue = true;
+        value.hasSourceTimestamp = true;
+        value.sourceTimestamp = (i + 1) * UA_DATETIME_SEC;
+        ret = backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                           &otherNodeId, false, &value);
+        ck_assert_uint_eq(ret, UA_STATUSCODE_GOOD);
+    }
+    ck_assert_uint_eq(backend.getEnd(server, backend.context, NULL, NULL, &otherNodeId), 1000);
+    ck_assert_uint_eq(UA_HistoryDataBackend_File_sync(&backend), UA_STATUSCODE_GOOD);
+
+    /* The values span many more segments than stay mapped for reading */
+    for(size_t i = 0; i < 1000; i++) {
+        UA_DateTime ts = (UA_DateTime)(i + 1) * UA_DATETIME_SEC;
+        ck_assert_uint_eq(backend.getDateTimeMatch(server, backend.context, NULL, NULL,
+                                                   &otherNodeId, ts, MATCH_EQUAL), i);
+        ck_assert_uint_eq(backend.getDateTimeMatch(server, backend.context, NULL, NULL,
+                                                   &otherNodeId, ts - 1, MATCH_AFTER), i);
+        const UA_DataValue *dv =
+            backend.getDataValue(server, backend.context, NULL, NULL, &otherNodeId, i);
+        ck_assert_int_eq(*(UA_Int64*)dv->value.data, (UA_Int64)i);
+    }
+
+    UA_HistoryDataBackend_File_clear(&setting.historizingBackend);
+    removeStore(dir);
+}
+END_TEST
+#endif
+
+START_TEST(Server_HistorizingBackendMemoryIndexedRing)
+{
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory_Indexed(1, 2, 4);
+
+    /* Bulk insert. Only the newest four values are retained. */
+    UA_DataValue values[10];
+    for(size_t i = 0; i < 10; i++)
+        setSample(&values[i], (UA_Int64)i + 1);
+    UA_StatusCode ret =
+        UA_HistoryDataBackend_Memory_Indexed_insertValues(&backend, &outNodeId,
+                                                          10, values);
+    ck_assert_uint_eq(ret, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < 10; i++)
+        UA_DataValue_clear(&values[i]);
+    UA_Int64 afterBulk[4] = {7, 8, 9, 10};
+    checkSamples(&backend, afterBulk, 4);
+
+    /* Insert out of order into the wrapped ring. The oldest value is dropped. */
+    UA_DataValue value;
+    setSample(&value, 9);
+    value.sourceTimestamp -= UA_DATETIME_SEC / 2;
+    ret = backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                       &outNodeId, false, &value);
+    ck_assert_uint_eq(ret, UA_STATUSCODE_GOOD);
+    UA_DataValue_clear(&value);
+    size_t end = backend.getEnd(server, backend.context, NULL, NULL, &outNodeId);
+    ck_assert_uint_eq(end, 4);
+    const UA_DataValue *inserted =
+        backend.getDataValue(server, backend.context, NULL, NULL, &outNodeId, 1);
+    ck_assert_int_eq(inserted->sourceTimestamp, 9 * UA_DATETIME_SEC - UA_DATETIME_SEC / 2);
+
+    /* Values older than the retained window are discarded */
+    setSample(&value, 1);
+    ret = backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                       &outNodeId, false, &value);
+    ck_assert_uint_eq(ret, UA_STATUSCODE_GOOD);
+    UA_DataValue_clear(&value);
+    ck_assert_int_eq(backend.getDataValue(server, backend.context, NULL, NULL,
+                                          &outNodeId, 0)->sourceTimestamp,
+                     8 * UA_DATETIME_SEC);
+
+    /* Remove across the wrap-around */
+    ret = backend.removeDataValue(server, backend.context, NULL, NULL, &outNodeId,
+                                  9 * UA_DATETIME_SEC - UA_DATETIME_SEC / 2,
+                                  10 * UA_DATETIME_SEC);
+    ck_assert_uint_eq(ret, UA_STATUSCODE_GOOD);
+    UA_Int64 afterRemove[2] = {8, 10};
+    checkSamples(&backend, afterRemove, 2);
+
+    /* Time-range lookup */
+    ck_assert_uint_eq(backend.getDateTimeMatch(server, backend.context, NULL, NULL,
+                                               &outNodeId, 9 * UA_DATETIME_SEC,
+                                               MATCH_EQUAL), 2);
+    ck_assert_uint_eq(backend.getDateTimeMatch(server, backend.context, NULL, NULL,
+                                               &outNodeId, 9 * UA_DATETIME_SEC,
+                                               MATCH_AFTER), 1);
+    ck_assert_uint_eq(backend.getDateTimeMatch(server, backend.context, NULL, NULL,
+                                               &outNodeId, 8 * UA_DATETIME_SEC,
+                                               MATCH_EQUAL_OR_BEFORE), 0);
+    ck_assert_uint_eq(backend.getDateTimeMatch(server, backend.context, NULL, NULL,
+                                               &outNodeId, 8 * UA_DATETIME_SEC,
+                                               MATCH_BEFORE), 2);
+
+    /* Unknown nodes have no history */
+    UA_NodeId unknown = UA_NODEID_NUMERIC(1, 4242);
+    ck_assert_uint_eq(backend.getEnd(server, backend.context, NULL, NULL, &unknown), 0);
+
+    UA_HistoryDataBackend_Memory_Indexed_clear(&backend);
+}
+END_TEST
+
 static Suite *
 testSuite_Client(void) {
     Suite *s = suite_create("Server Historical Data");
@@ -961,12 +1167,16 @@ testSuite_Client(void) {
     tcase_add_test(tc_server, Server_HistorizingStrategyPoll);
     tcase_add_test(tc_server, Server_HistorizingStrategyUser);
     tcase_add_test(tc_server, Server_HistorizingStrategyValueSet);
-    tcase_add_test(tc_server, Server_HistorizingBackendMemory);
+    tcase_add_loop_test(tc_server, Server_HistorizingBackendMemory, 0, 2);
     tcase_add_test(tc_server, Server_HistorizingRandomIndexBackend);
-    tcase_add_test(tc_server, Server_HistorizingUpdateDelete);
-    tcase_add_test(tc_server, Server_HistorizingUpdateInsert);
-    tcase_add_test(tc_server, Server_HistorizingUpdateReplace);
-    tcase_add_test(tc_server, Server_HistorizingUpdateUpdate);
+    tcase_add_test(tc_server, Server_HistorizingBackendMemoryIndexedRing);
+#ifdef UA_ARCHITECTURE_POSIX
+    tcase_add_test(tc_server, Server_HistorizingBackendFile);
+#endif
+    tcase_add_loop_test(tc_server, Server_HistorizingUpdateDelete, 0, 2);
+    tcase_add_loop_test(tc_server, Server_HistorizingUpdateInsert, 0, 2);
+    tcase_add_loop_test(tc_server, Server_HistorizingUpdateReplace, 0, 2);
+    tcase_add_loop_test(tc_server, Server_HistorizingUpdateUpdate, 0, 2);
     suite_add_tcase(s, tc_server);
 
     return s;
@@ -862,6 +862,169 @@ START_TEST(Server_negativeSamplingInterval) {
 }
 END_TEST
 
+static const UA_NodeId currentTimeId =
+    {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME}};
+
+static UA_UInt32
+createSampledMonitoredItem(UA_NodeId nodeId, UA_Double samplingInterval) {
+    UA_MonitoredItemCreateRequest item;
+    UA_MonitoredItemCreateRequest_init(&item);
+    item.itemToMonitor.nodeId = nodeId;
+    item.itemToMonitor.attributeId = UA_ATTRIBUTEID_VALUE;
+    item.monitoringMode = UA_MONITORINGMODE_REPORTING;
+    item.requestedParameters.samplingInterval = samplingInterval;
+    item.requestedParameters.queueSize = 1;
+
+    UA_CreateMonitoredItemsRequest request;
+    UA_CreateMonitoredItemsRequest_init(&request);
+    request.subscriptionId = subscriptionId;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_SERVER;
+    request.itemsToCreateSize = 1;
+    request.itemsToCreate = &item;
+
+    UA_CreateMonitoredItemsResponse response;
+    UA_CreateMonitoredItemsResponse_init(&response);
+    lockServer(server);
+    Service_CreateMonitoredItems(server, session, &request, &response);
+    unlockServer(server);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.resultsSize, 1);
+    ck_assert_uint_eq(response.results[0].statusCode, UA_STATUSCODE_GOOD);
+    ck_assert(response.results[0].revisedSamplingInterval == samplingInterval);
+    UA_UInt32 id = response.results[0].monitoredItemId;
+    UA_CreateMonitoredItemsResponse_clear(&response);
+    return id;
+}
+
+static UA_SamplingGroup *
+getSamplingGroup(UA_Double samplingInterval) {
+    UA_SamplingGroup *sg;
+    LIST_FOREACH(sg, &server->samplingGroups, listEntry) {
+        if(sg->samplingInterval == samplingInterval)
+            return sg;
+    }
+    return NULL;
+}
+
+START_TEST(Server_samplingGroups) {
+    createSubscription();
+
+    /* Three MonitoredItems share one SamplingGroup, one is in its own group */
+    UA_UInt32 ids[4];
+    ids[0] = createSampledMonitoredItem(currentTimeId, 250.0);
+    ids[1] = createSampledMonitoredItem(currentTimeId, 250.0);
+    ids[2] = createSampledMonitoredItem(currentTimeId, 250.0);
+    ids[3] = createSampledMonitoredItem(currentTimeId, 500.0);
+
+    UA_SamplingGroup *sg250 = getSamplingGroup(250.0);
+    UA_SamplingGroup *sg500 = getSamplingGroup(500.0);
+    ck_assert_ptr_ne(sg250, NULL);
+    ck_assert_ptr_ne(sg500, NULL);
+    ck_assert_uint_eq(sg250->monitoredItemsSize, 3);
+    ck_assert_uint_eq(sg500->monitoredItemsSize, 1);
+
+    /* All MonitoredItems of a group are sampled in the same cycle */
+    UA_fakeSleep(251);
+    UA_Server_run_iterate(server, false);
+    ck_assert_uint_eq(sg250->samplingCycles, 1);
+    ck_assert_uint_eq(sg250->samplesCount, 3);
+    ck_assert_uint_eq(sg500->samplingCycles, 0);
+
+#ifdef UA_ENABLE_DIAGNOSTICS
+    UA_Variant diag;
+    UA_StatusCode res = UA_Server_readValue(server,
+        UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SAMPLINGINTERVALDIAGNOSTICSARRAY),
+        &diag);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(diag.arrayLength, 2);
+    ck_assert(diag.type == &UA_TYPES[UA_TYPES_SAMPLINGINTERVALDIAGNOSTICSDATATYPE]);
+    UA_Variant_clear(&diag);
+#endif
+
+    /* Delete two MonitoredItems */
+    UA_DeleteMonitoredItemsRequest request;
+    UA_DeleteMonitoredItemsRequest_init(&request);
+    request.subscriptionId = subscriptionId;
+    request.monitoredItemIdsSize = 2;
+    request.monitoredItemIds = &ids[2];
+
+    UA_DeleteMonitoredItemsResponse response;
+    UA_DeleteMonitoredItemsResponse_init(&response);
+    lockServer(server);
+    Service_DeleteMonitoredItems(server, session, &request, &response);
+    unlockServer(server);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    UA_DeleteMonitoredItemsResponse_clear(&response);
+
+    /* The group without MonitoredItems is removed */
+    ck_assert_ptr_eq(getSamplingGroup(500.0), NULL);
+    sg250 = getSamplingGroup(250.0);
+    ck_assert_ptr_ne(sg250, NULL);
+    ck_assert_uint_eq(sg250->monitoredItemsSize, 2);
+    ck_assert_uint_eq(sg250->maxMonitoredItemsSize, 3);
+}
+END_TEST
+
+START_TEST(Server_samplingGroupsSharedNode) {
+    /* Add a variable with an internal value source */
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Int32 value = 42;
+    UA_Variant_setScalar(&attr.value, &value, &UA_TYPES[UA_TYPES_INT32]);
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    UA_NodeId varId = UA_NODEID_STRING(1, "the.answer");
+    UA_StatusCode res =
+        UA_Server_addVariableNode(server, varId,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "the answer"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    createSubscription();
+
+    /* The MonitoredItems for the variable are interleaved with a MonitoredItem
+     * on the CurrentTime (callback value source) */
+    createSampledMonitoredItem(varId, 250.0);
+    createSampledMonitoredItem(currentTimeId, 250.0);
+    createSampledMonitoredItem(varId, 250.0);
+    createSampledMonitoredItem(varId, 250.0);
+
+    /* The MonitoredItems on the same node share one node lookup */
+    UA_SamplingGroup *sg = getSamplingGroup(250.0);
+    ck_assert_ptr_ne(sg, NULL);
+    ck_assert_uint_eq(sg->monitoredItemsSize, 4);
+    UA_fakeSleep(251);
+    UA_Server_run_iterate(server, false);
+    ck_assert_uint_eq(sg->samplesCount, 4);
+    ck_assert_uint_eq(sg->nodeLookups, 2);
+
+    /* The node is not pinned beyond the sampling cycle. Written values are
+     * picked up in the next cycle. */
+    value = 43;
+    UA_Variant v;
+    UA_Variant_setScalar(&v, &value, &UA_TYPES[UA_TYPES_INT32]);
+    res = UA_Server_writeValue(server, varId, v);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_fakeSleep(251);
+    UA_Server_run_iterate(server, false);
+    ck_assert_uint_eq(sg->samplesCount, 8);
+    ck_assert_uint_eq(sg->nodeLookups, 4);
+
+    UA_MonitoredItem *mon;
+    size_t checked = 0;
+    LIST_FOREACH(mon, &sg->monitoredItems, sampling.cyclic.groupEntry) {
+        if(!UA_NodeId_equal(&mon->itemToMonitor.nodeId, &varId))
+            continue;
+        ck_assert(mon->lastValue.hasValue);
+        ck_assert(mon->lastValue.value.type == &UA_TYPES[UA_TYPES_INT32]);
+        ck_assert_int_eq(*(UA_Int32*)mon->lastValue.value.data, 43);
+        checked++;
+    }
+    ck_assert_uint_eq(checked, 3);
+}
+END_TEST
+
 #endif /* UA_ENABLE_SUBSCRIPTIONS */
 
 static Suite* testSuite_Client(void) {
@@ -884,6 +1047,8 @@ static Suite* testSuite_Client(void) {
     tcase_add_test(tc_server, Server_publishCallback);
     tcase_add_test(tc_server, Server_lifeTimeCount);
     tcase_add_test(tc_server, Server_invalidPublishingInterval);
+    tcase_add_test(tc_server, Server_samplingGroups);
+    tcase_add_test(tc_server, Server_samplingGroupsSharedNode);
 #endif /* UA_ENABLE_SUBSCRIPTIONS */
     suite_add_tcase(s, tc_server);
 
@@ -8,9 +8,11 @@
 #include <open62541/server_config_default.h>
 #include <open62541/types.h>
 
+#include "server/ua_server_internal.h"
 #include "server/ua_services.h"
 #include "client/ua_client_internal.h"
 #include "test_helpers.h"
+#include "testing_clock.h"
 
 #include <check.h>
 #include <stdlib.h>
@@ -114,6 +116,70 @@ START_TEST(Session_updateLifetime_ShallWork) {
 }
 END_TEST
 
+#define INDEX_SESSIONS 1000
+
+/* Lookup by AuthenticationToken and SessionId and the timeout handling with
+ * more sessions than the initial size of the session index */
+START_TEST(Session_index_ShallWork) {
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    config->maxSessions = INDEX_SESSIONS;
+
+    UA_CreateSessionRequest request;
+    UA_CreateSessionRequest_init(&request);
+    request.requestedSessionTimeout = 10000.0;
+
+    UA_Session *sessions[INDEX_SESSIONS];
+    UA_NodeId tokens[INDEX_SESSIONS];
+    UA_NodeId ids[INDEX_SESSIONS];
+
+    lockServer(server);
+    for(size_t i = 0; i < INDEX_SESSIONS; i++) {
+        UA_StatusCode res = UA_Session_create(server, NULL, &request, &sessions[i]);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        tokens[i] = sessions[i]->authenticationToken; /* Guid NodeIds */
+        ids[i] = sessions[i]->sessionId;
+    }
+    ck_assert_uint_eq(server->sessionCount, INDEX_SESSIONS);
+
+    for(size_t i = 0; i < INDEX_SESSIONS; i++) {
+        ck_assert_ptr_eq(getSessionByToken(server, &tokens[i]), sessions[i]);
+        ck_assert_ptr_eq(getSessionById(server, &ids[i]), sessions[i]);
+    }
+
+    /* Remove every second session */
+    for(size_t i = 0; i < INDEX_SESSIONS; i += 2)
+        UA_Session_remove(server, sessions[i], UA_SHUTDOWNREASON_CLOSE);
+    ck_assert_uint_eq(server->sessionCount, INDEX_SESSIONS / 2);
+    for(size_t i = 0; i < INDEX_SESSIONS; i++) {
+        UA_Session *expected = (i % 2 == 0) ? NULL : sessions[i];
+        ck_assert_ptr_eq(getSessionByToken(server, &tokens[i]), expected);
+        ck_assert_ptr_eq(getSessionById(server, &ids[i]), expected);
+    }
+
+    /* Extend the lifetime of every fourth session. Then let the others time
+     * out. */
+    UA_fakeSleep(5000);
+    UA_EventLoop *el = config->eventLoop;
+    for(size_t i = 1; i < INDEX_SESSIONS; i += 4)
+        UA_Session_updateLifetime(sessions[i], el->dateTime_now(el),
+                                  el->dateTime_nowMonotonic(el));
+    UA_fakeSleep(6000);
+    cleanupSessions(server, el->dateTime_nowMonotonic(el));
+    ck_assert_uint_eq(server->sessionCount, INDEX_SESSIONS / 4);
+    for(size_t i = 1; i < INDEX_SESSIONS; i += 2) {
+        UA_Session *expected = (i % 4 == 1) ? sessions[i] : NULL;
+        ck_assert_ptr_eq(getSessionByToken(server, &tokens[i]), expected);
+        ck_assert_ptr_eq(getSessionById(server, &ids[i]), expected);
+    }
+
+    /* The extended sessions time out as well */
+    UA_fakeSleep(5000);
+    cleanupSessions(server, el->dateTime_nowMonotonic(el));
+    ck_assert_uint_eq(server->sessionCount, 0);
+    unlockServer(server);
+}
+END_TEST
+
 /* Check that the service-notification-callback is correctly set */
 static void
 serverNotificationCallback(UA_Server *server, UA_ApplicationNotificationType type,
@@ -193,6 +259,7 @@ static Suite* testSuite_Session(void) {
     tcase_add_test(tc_session, Session_close_before_activate);
     tcase_add_test(tc_session, Session_init_ShallWork);
     tcase_add_test(tc_session, Session_updateLifetime_ShallWork);
+    tcase_add_test(tc_session, Session_index_ShallWork);
     tcase_add_test(tc_session, Session_notificationCallback);
     tcase_add_test(tc_session, Session_setSessionAttribute_ShallWork);
     suite_add_tcase(s,tc_session);
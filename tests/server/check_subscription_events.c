@@ -667,6 +667,133 @@ START_TEST(evaluateFilterWhereClause) {
 }
 END_TEST
 
+#define SHARED_FILTER_ITEMS 5
+
+static size_t sharedNotifications[SHARED_FILTER_ITEMS + 1];
+
+static void
+handler_events_shared(UA_Client *lclient, UA_UInt32 subId, void *subContext,
+                      UA_UInt32 monId, void *monContext,
+                      const UA_KeyValueMap eventFields) {
+    ck_assert_uint_eq(eventFields.mapSize, nSelectClauses);
+    ck_assert(UA_Variant_hasScalarType(&eventFields.map[0].value,
+                                       &UA_TYPES[UA_TYPES_UINT16]));
+    ck_assert_uint_eq(*(UA_UInt16*)eventFields.map[0].value.data, 100);
+    ck_assert(UA_Variant_hasScalarType(&eventFields.map[2].value,
+                                       &UA_TYPES[UA_TYPES_NODEID]));
+    ck_assert(UA_NodeId_equal((UA_NodeId*)eventFields.map[2].value.data, &eventType));
+    (*(size_t*)monContext)++;
+}
+
+static UA_EventFilterProgram *
+getEventFilterProgram(UA_UInt32 monId) {
+    lockServer(server);
+    UA_Subscription *sub = getSubscriptionById(server, subscriptionId);
+    ck_assert(sub != NULL);
+    UA_MonitoredItem *mon = UA_Subscription_getMonitoredItem(sub, monId);
+    ck_assert(mon != NULL);
+    UA_EventFilterProgram *p = mon->eventProgram;
+    unlockServer(server);
+    ck_assert(p != NULL);
+    return p;
+}
+
+/* MonitoredItems with an identical filter share the compiled program. The
+ * event is evaluated once for them and every MonitoredItem receives it. */
+START_TEST(sharedFilterProgram) {
+    /* Where-clause: OfType(eventType) */
+    UA_LiteralOperand lo;
+    UA_LiteralOperand_init(&lo);
+    UA_Variant_setScalar(&lo.value, &eventType, &UA_TYPES[UA_TYPES_NODEID]);
+    UA_ContentFilterElement elm;
+    UA_ContentFilterElement_init(&elm);
+    elm.filterOperator = UA_FILTEROPERATOR_OFTYPE;
+    elm.filterOperandsSize = 1;
+    elm.filterOperands = UA_ExtensionObject_new();
+    UA_ExtensionObject_setValueNoDelete(elm.filterOperands, &lo,
+                                        &UA_TYPES[UA_TYPES_LITERALOPERAND]);
+
+    UA_EventFilter filter;
+    UA_EventFilter_init(&filter);
+    filter.selectClauses = selectClauses;
+    filter.selectClausesSize = nSelectClauses;
+    filter.whereClause.elements = &elm;
+    filter.whereClause.elementsSize = 1;
+
+    UA_MonitoredItemCreateRequest item;
+    UA_MonitoredItemCreateRequest_init(&item);
+    item.itemToMonitor.nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER);
+    item.itemToMonitor.attributeId = UA_ATTRIBUTEID_EVENTNOTIFIER;
+    item.monitoringMode = UA_MONITORINGMODE_REPORTING;
+    item.requestedParameters.queueSize = 1;
+    item.requestedParameters.discardOldest = true;
+    UA_ExtensionObject_setValue(&item.requestedParameters.filter, &filter,
+                                &UA_TYPES[UA_TYPES_EVENTFILTER]);
+
+    UA_UInt32 monIds[SHARED_FILTER_ITEMS + 1];
+    memset(sharedNotifications, 0, sizeof(sharedNotifications));
+    for(size_t i = 0; i < SHARED_FILTER_ITEMS; i++) {
+        UA_MonitoredItemCreateResult result =
+            UA_Client_MonitoredItems_createEvent(client, subscriptionId,
+                                                 UA_TIMESTAMPSTORETURN_BOTH, item,
+                                                 &sharedNotifications[i],
+                                                 handler_events_shared, NULL);
+        ck_assert_uint_eq(result.statusCode, UA_STATUSCODE_GOOD);
+        monIds[i] = result.monitoredItemId;
+    }
+    UA_EventFilterProgram *program = getEventFilterProgram(monIds[0]);
+    for(size_t i = 1; i < SHARED_FILTER_ITEMS; i++)
+        ck_assert_ptr_eq(getEventFilterProgram(monIds[i]), program);
+
+    /* A different filter that does not match the event */
+    UA_NodeId otherType = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEMODELCHANGEEVENTTYPE);
+    UA_Variant_setScalar(&lo.value, &otherType, &UA_TYPES[UA_TYPES_NODEID]);
+    UA_MonitoredItemCreateResult result =
+        UA_Client_MonitoredItems_createEvent(client, subscriptionId,
+                                             UA_TIMESTAMPSTORETURN_BOTH, item,
+                                             &sharedNotifications[SHARED_FILTER_ITEMS],
+                                             handler_events_shared, NULL);
+    ck_assert_uint_eq(result.statusCode, UA_STATUSCODE_GOOD);
+    monIds[SHARED_FILTER_ITEMS] = result.monitoredItemId;
+    ck_assert_ptr_ne(getEventFilterProgram(monIds[SHARED_FILTER_ITEMS]), program);
+
+    UA_StatusCode retval =
+        UA_Server_createEvent(server, UA_NS0ID(SERVER), eventType, 100,
+                              message, NULL, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Every MonitoredItem with the shared filter receives the event */
+    joinServer();
+    for(size_t i = 0; i < 20; i++) {
+        UA_fakeSleep(500);
+        UA_Server_run_iterate(server, false);
+        retval = UA_Client_run_iterate(client, 0);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        size_t received = 0;
+        for(size_t j = 0; j < SHARED_FILTER_ITEMS; j++)
+            received += (sharedNotifications[j] > 0) ? 1 : 0;
+        if(received == SHARED_FILTER_ITEMS)
+            break;
+    }
+    forkServer();
+    for(size_t i = 0; i < SHARED_FILTER_ITEMS; i++)
+        ck_assert_uint_eq(sharedNotifications[i], 1);
+    ck_assert_uint_eq(sharedNotifications[SHARED_FILTER_ITEMS], 0);
+
+    UA_DeleteMonitoredItemsRequest deleteRequest;
+    UA_DeleteMonitoredItemsRequest_init(&deleteRequest);
+    deleteRequest.subscriptionId = subscriptionId;
+    deleteRequest.monitoredItemIds = monIds;
+    deleteRequest.monitoredItemIdsSize = SHARED_FILTER_ITEMS + 1;
+    UA_DeleteMonitoredItemsResponse deleteResponse =
+        UA_Client_MonitoredItems_delete(client, deleteRequest);
+    ck_assert_uint_eq(deleteResponse.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(deleteResponse.resultsSize, SHARED_FILTER_ITEMS + 1);
+    UA_DeleteMonitoredItemsResponse_clear(&deleteResponse);
+
+    UA_ExtensionObject_delete(elm.filterOperands);
+} END_TEST
+
 // Create an audit event that shall be delivered *only* to the AdminSession
 START_TEST(auditEvent) {
     UA_NodeId adminSessionId = UA_NODEID("g=00000001-0000-0000-0000-000000000000");
@@ -700,6 +827,7 @@ static Suite *testSuite_Client(void) {
     tcase_add_test(tc_server, discardNewestOverflow);
     tcase_add_test(tc_server, eventStressing);
     tcase_add_test(tc_server, evaluateFilterWhereClause);
+    tcase_add_test(tc_server, sharedFilterProgram);
     tcase_add_test(tc_server, auditEvent);
 #endif /* UA_ENABLE_SUBSCRIPTIONS_EVENTS */
     suite_add_tcase(s, tc_server);